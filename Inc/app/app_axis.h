@@ -0,0 +1,100 @@
+#ifndef APP_APP_AXIS_H
+#define APP_APP_AXIS_H
+/**
+ * @file app_axis.h
+ * @brief Axis runtime state machine: startup alignment, speed control and FOC actuation.
+ *
+ * Responsibilities:
+ * - take one axis from the alignment hold (or a stored calibration) into closed loop
+ * - run the post-alignment calibration runs (autotune, lead angle, linearization) before the reference
+ * - run the speed step (trajectory, position loop, speed PI, field weakening, lead angle, cogging)
+ * - apply FOC or 6-step in the superloop, the PWM fast loop or the current loop
+ * - run the per-step control-path fault checks and the observer takeover
+ *
+ * @note The fast-loop and current-loop callbacks run in ISR context; they only
+ *       raise faults, the main loop does the report and trap.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app/app_context.h"
+
+/**
+ * @brief Latch a fault on large steady-state speed error.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+void app_axis_check_speed_error_fault(app_axis_t *axis);
+
+/**
+ * @brief Read the latest published angle of the selected source without consuming it (ISR safe).
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param published_sample Pointer to one published sample.
+ * @return true if at least one angle has been published, false otherwise.
+ */
+bool app_axis_get_latest_angle_sample(const app_axis_t *axis,
+									  as5600_analog_published_sample_t *published_sample);
+
+/**
+ * @brief Install the calibrated linearization table and hand over to the speed profile.
+ *
+ * The table moves the sensor angle at the alignment position by its local
+ * correction, so the electrical offset is shifted by pole_pairs times that
+ * correction to keep the same rotor reference. The profile then starts from
+ * the calibration speed.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+void app_axis_finish_angle_linearization(app_axis_t *axis);
+
+/**
+ * @brief Run one speed-controller update (released once per speed-PI period).
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+void app_axis_update_speed_controller(app_axis_t *axis);
+
+/**
+ * @brief PWM-synchronous fast loop, called from the TIM1 update interrupt.
+ *
+ * Reads the latest published angle without consuming it, runs the per-step
+ * fault checks, refreshes the electrical angle and applies FOC with the
+ * latest speed-PI output. Faults shut the stage down through the TIM1 break
+ * and latch; the main loop does the report and trap. A step that runs into
+ * the next update event latches a deadline fault. The primary axis then
+ * takes the telemetry snapshot requested by the actuation task.
+ *
+ * @param callback_arg Pointer to axis runtime context.
+ */
+void app_axis_fast_loop_callback(void *callback_arg);
+
+/**
+ * @brief Current-mode FOC loop, called from the ADC2 injected end-of-sequence interrupt.
+ *
+ * Runs once per PWM period on the shunt samples taken at the counter peak:
+ * Clarke, electrical-angle refresh, Park, d/q current PI with decoupling and
+ * inverse Park through the voltage FOC kernel, with the optional flux observer
+ * on either side of it. The speed PI supplies the Iq
+ * reference, Id is held at zero. Faults shut the stage down through the
+ * TIM1 break and latch; the main loop does the report and trap. A loop that
+ * is still running when the next sequence completes latches a deadline fault.
+ * The loop ends with the telemetry snapshot requested by the actuation task.
+ *
+ * @param callback_arg Pointer to axis runtime context.
+ * @param samples Raw shunt samples in phase order.
+ * @param sample_count Number of raw samples.
+ */
+void app_axis_current_loop_callback(void *callback_arg, const uint16_t *samples, uint8_t sample_count);
+
+/**
+ * @brief Advance startup alignment and post-alignment closed-loop actuation.
+ *
+ * Released once per actuation period, after the speed controller of the same step.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param now_ms Current time in milliseconds.
+ */
+void app_axis_update_runtime_actuation(app_axis_t *axis, uint32_t now_ms);
+
+#endif /* APP_APP_AXIS_H */
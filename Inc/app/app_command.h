@@ -0,0 +1,101 @@
+#ifndef APP_APP_COMMAND_H
+#define APP_APP_COMMAND_H
+/**
+ * @file app_command.h
+ * @brief Host command handling and double-buffered runtime parameters.
+ *
+ * Responsibilities:
+ * - decode the USART2 command frames and acknowledge each one
+ * - stage SET_PARAM values in the shadow parameter block after a range check
+ * - commit the shadow block at a speed-control step boundary
+ * - queue streamed reference points and plan host position moves
+ *
+ * @note Commands only ever write the shadow block; control and telemetry
+ *       read the active one, switched by one index write.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app/app_context.h"
+
+/**
+ * @brief Load the configuration defaults into both parameter blocks and build the boot profile.
+ *
+ * Runs before the axis configurations are built: the boot tables back the
+ * trajectory cfg of every axis.
+ *
+ * @param app Pointer to application runtime context.
+ */
+void app_command_init(app_context_t *app);
+
+/**
+ * @brief Return the active parameter block (read side of the double buffer).
+ *
+ * @param app Pointer to application runtime context.
+ * @return Pointer to the active parameters.
+ */
+const app_param_block_t *app_command_get_active_params(const app_context_t *app);
+
+/**
+ * @brief Build the trajectory profile of one parameter block into the applied segment tables.
+ *
+ * Setpoint mode is one non-cyclic ramp to the setpoint and position mode
+ * one ramp to standstill (moves replace it with their own table); profile
+ * and stream mode use the default shape 0 -> +peak -> 0 -> -peak -> 0
+ * (repeat), each target held before the next ramp.
+ *
+ * @param app Pointer to application runtime context.
+ * @param params Pointer to parameter block.
+ * @return Profile referencing the application segment tables.
+ */
+motor_trajectory_profile_t app_command_build_reference_profile(app_context_t *app, const app_param_block_t *params);
+
+/**
+ * @brief Swap in the committed shadow parameters at a speed-control step boundary.
+ *
+ * Runs before the axis updates of one step, so every axis and the telemetry
+ * of that step see one complete block. Deferred while an identification run
+ * owns the speed loop. Only the groups that differ are pushed into the
+ * modules: the gains as a one-point gain schedule (replaces an autotuned
+ * one), the LPF tau, the position-loop gain and speed limit, and the
+ * reference profile (restarted from the current reference, so the reference
+ * speed has no step).
+ *
+ * @param app Pointer to application runtime context.
+ */
+void app_command_apply_pending_params(app_context_t *app);
+
+/**
+ * @brief Take the streamed reference point of this speed-control step.
+ *
+ * On underrun the last speed is held at zero acceleration.
+ *
+ * @param app Pointer to application runtime context.
+ */
+void app_command_reference_stream_next(app_context_t *app);
+
+/**
+ * @brief Plan the pending host move on every axis and hand its table to the trajectory.
+ *
+ * Waits until every axis has anchored its position reference (first
+ * position-mode step after entering the mode). A relative move is added to
+ * the current target of each axis.
+ *
+ * @param app Pointer to application runtime context.
+ */
+void app_command_start_position_move(app_context_t *app);
+
+/**
+ * @brief Task: decode and acknowledge host commands from USART2 RX.
+ *
+ * Background task (every pass, or on APP_EVENT_COMMAND_RX in event idle): a
+ * bounded number of frames per pass, so a command burst cannot delay the next
+ * control release. In event idle a pass that hit the bound posts the event
+ * again for the frames left in the RX ring.
+ *
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+void app_command_task(void *arg, uint64_t now_us);
+
+#endif /* APP_APP_COMMAND_H */
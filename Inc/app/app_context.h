@@ -0,0 +1,476 @@
+#ifndef APP_APP_CONTEXT_H
+#define APP_APP_CONTEXT_H
+/**
+ * @file app_context.h
+ * @brief Application runtime context shared by main.c and the app modules.
+ *
+ * Responsibilities:
+ * - define the axis and application runtime contexts
+ * - define the double-buffered runtime parameter block and the reference stream
+ * - resolve the build-time feature selections of app_motor_test_config.h
+ * - declare the application services implemented in main.c (fatal stop, scope, calibration record)
+ *
+ * @note main.c owns the single app_context_t instance; the app modules only
+ *       work on the context pointer they are handed.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config/app_motor_test_config.h"
+#include "config/project_config.h"
+#include "drivers/as5600_analog.h"
+#include "drivers/as5600_i2c.h"
+#include "drivers/adc.h"
+#include "drivers/calibration_store.h"
+#include "drivers/command.h"
+#include "drivers/gpio.h"
+#include "drivers/pwm_tim1.h"
+#include "drivers/scheduler.h"
+#include "drivers/telemetry.h"
+#include "drivers/telemetry_stream.h"
+#include "drivers/timing_monitor.h"
+#include "motor/motor.h"
+#include "motor/motor_3pwm.h"
+#include "motor/motor_6step_com.h"
+#include "motor/motor_angle_linearization.h"
+#include "motor/motor_cogging_compensation.h"
+#include "motor/motor_current_pi.h"
+#include "motor/motor_current_sense.h"
+#include "motor/motor_electrical_angle.h"
+#include "motor/motor_fault.h"
+#include "motor/motor_field_weakening.h"
+#include "motor/motor_flux_observer.h"
+#include "motor/motor_foc_voltage.h"
+#include "motor/motor_lead_angle.h"
+#include "motor/motor_openloop.h"
+#include "motor/motor_position_control.h"
+#include "motor/motor_scope.h"
+#include "motor/motor_speed_autotune.h"
+#include "motor/motor_speed_feedback.h"
+#include "motor/motor_speed_pi.h"
+#include "motor/motor_speed_reference_estimator.h"
+#include "motor/motor_trajectory.h"
+
+/* Default trajectory table: 0 -> +peak -> 0 -> -peak -> 0 (repeat). */
+#define APP_SPEED_PROFILE_SEGMENT_COUNT           5u
+
+/* Telemetry-stream registry order (mask bit = id, payload order; names in tools/telemetry_decode.py). */
+typedef enum app_telemetry_channel_id_t {
+	APP_TELEMETRY_CHANNEL_ANGLE = 0,          /* u16 mechanical angle of the primary axis */
+	APP_TELEMETRY_CHANNEL_FILTERED_SPEED,     /* i32 mrpm */
+	APP_TELEMETRY_CHANNEL_REFERENCE_SPEED,    /* i32 mrpm */
+	APP_TELEMETRY_CHANNEL_UQ_COMMAND,         /* i16 permyriad */
+	APP_TELEMETRY_CHANNEL_TRAJECTORY_STEP,    /* u8 segment index */
+	APP_TELEMETRY_CHANNEL_SEGMENT_TARGET,     /* i32 mrpm */
+	APP_TELEMETRY_CHANNEL_SPEED_ERROR,        /* i32 mrpm */
+	APP_TELEMETRY_CHANNEL_RAW_SPEED,          /* i32 mrpm */
+	APP_TELEMETRY_CHANNEL_SPEED_INTEGRATOR,   /* i32 speed PI integrator */
+	APP_TELEMETRY_CHANNEL_SPEED_FEEDFORWARD,  /* i32 speed feedforward */
+	APP_TELEMETRY_CHANNEL_ID,                 /* i32 mA */
+	APP_TELEMETRY_CHANNEL_IQ,                 /* i32 mA */
+	APP_TELEMETRY_CHANNEL_ELECTRICAL_ANGLE,   /* u16 */
+	APP_TELEMETRY_CHANNEL_COUNT,
+} app_telemetry_channel_id_t;
+
+#define APP_TELEMETRY_CHANNEL_MASK_ALL            ((uint16_t)((1u << APP_TELEMETRY_CHANNEL_COUNT) - 1u))
+
+/* Scheduler event bits posted from ISRs (event idle: the only releases of the background tasks). */
+#define APP_EVENT_ANGLE_SAMPLE                    (1u << 0)   /* AS5600 sample published (ADC / DMA ISR) */
+#define APP_EVENT_COMMAND_RX                      (1u << 1)   /* USART2 RX byte stored */
+
+/* Source of the speed reference. */
+typedef enum app_reference_mode_t {
+	APP_REFERENCE_MODE_PROFILE = 0,           /* cyclic default table built from the profile parameters */
+	APP_REFERENCE_MODE_SETPOINT,              /* one ramp to the host setpoint, then hold */
+	APP_REFERENCE_MODE_STREAM,                /* host points, one per speed-control step */
+	APP_REFERENCE_MODE_POSITION,              /* position loop: stop and hold, host moves plan the trajectory */
+	APP_REFERENCE_MODE_COUNT,
+} app_reference_mode_t;
+
+/* Runtime parameters; the boot values are the app_motor_test_config.h defaults. */
+typedef struct app_param_block_t {
+	int32_t speed_pi_kp_q15;
+	int32_t speed_pi_ki_per_s_q15;
+	uint16_t speed_feedback_filter_time_constant_ms;
+	uint16_t telemetry_channel_mask;          /* Bit = app_telemetry_channel_id_t. */
+	uint16_t telemetry_decimation[APP_TELEMETRY_CHANNEL_COUNT];
+	uint8_t reference_mode;                   /* app_reference_mode_t */
+	int32_t speed_setpoint_mrpm;
+	int32_t profile_peak_speed_mrpm;
+	uint32_t profile_peak_hold_ms;
+	uint32_t profile_zero_hold_ms;
+	uint32_t profile_acceleration_mrpm_per_s;
+	uint32_t profile_jerk_mrpm_per_s2;
+	int32_t position_kp_q15;
+	int32_t position_max_speed_mrpm;
+} app_param_block_t;
+
+/* One streamed reference point. */
+typedef struct app_reference_point_t {
+	int32_t speed_mrpm;
+	int32_t acceleration_mrpm_per_s;
+} app_reference_point_t;
+
+/* Host position move, taken by the next position-mode speed-control step. */
+typedef struct app_position_move_t {
+	int32_t value_counts;                     /* Target, or delta to the current target. */
+	bool is_relative;
+	bool is_pending;
+} app_position_move_t;
+
+/* Streamed reference FIFO (filled by the command task, drained by the speed-control step). */
+typedef struct app_reference_stream_t {
+	app_reference_point_t points[APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY];
+	uint16_t head;                            /* Next write position. */
+	uint16_t count;
+	app_reference_point_t current;            /* Point of the running step, held (at zero acceleration) on underrun. */
+	uint32_t underrun_cnt;
+	bool is_underrun;
+} app_reference_stream_t;
+
+struct app_context_t;
+
+/* One motor pipeline: power stage, angle source and control chain of one axis. */
+typedef struct app_axis_t {
+	struct app_context_t *app;
+	uint8_t index;                            /* 0 = primary axis (scope, telemetry, calibration store). */
+	pwm_tim1_handle_t *pwm_h;
+	const gpio_pin_cfg_t *enable_pin_cfg;
+	adc_handle_t *angle_adc_h;
+	motor_handle_t motor_h;
+	motor_3pwm_handle_t motor_3pwm_h;
+	motor_openloop_handle_t motor_openloop_h;
+	motor_foc_voltage_handle_t motor_foc_voltage_h;
+	motor_electrical_angle_handle_t motor_electrical_angle_h;
+	motor_speed_feedback_handle_t motor_speed_feedback_h;
+	motor_speed_pi_handle_t motor_speed_pi_h;
+	motor_field_weakening_handle_t motor_field_weakening_h;
+	motor_lead_angle_handle_t motor_lead_angle_h;
+	motor_cogging_compensation_handle_t motor_cogging_compensation_h;
+	motor_flux_observer_handle_t motor_flux_observer_h;
+	motor_speed_autotune_handle_t motor_speed_autotune_h;
+	motor_angle_linearization_handle_t motor_angle_linearization_h;
+	motor_speed_reference_estimator_handle_t motor_speed_reference_estimator_h;
+	motor_trajectory_handle_t motor_trajectory_h;
+	motor_position_control_handle_t motor_position_control_h;
+	motor_current_sense_handle_t motor_current_sense_h;
+	motor_current_pi_handle_t motor_current_pi_h;
+	motor_fault_handle_t motor_fault_h;
+	motor_6step_com_handle_t motor_6step_com_h;
+	as5600_analog_handle_t as5600_analog_h;
+	as5600_i2c_handle_t as5600_i2c_h;
+	calibration_data_t calibration_data;      /* Loaded record, or the one stored after alignment. */
+	bool has_stored_calibration;              /* Valid record for this build: alignment hold is skipped. */
+	bool cogging_table_saved;                 /* Learned cogging table stored once this boot. */
+	bool observer_divergence_reported;        /* Divergence above the limit logged, re-armed below half of it. */
+	uint8_t angle_fallback_fault_code;        /* Sensor fault the observer took over from (motor_fault_code_t). */
+	uint32_t angle_fallback_fault_detail;
+	uint16_t alignment_mechanical_angle_u16;  /* Sensor angle the electrical offset was measured at. */
+	uint32_t alignment_start_ms;
+	int16_t applied_uq_command_permyriad;
+	uint16_t latest_logged_mechanical_angle_u16;
+	bool latest_sample_valid;
+	uint16_t angle_publish_window_samples;    /* Last requested AS5600 publish window. */
+	volatile bool alignment_done; /* Read by the PWM-synchronous fast loop. */
+	volatile bool angle_fallback_active; /* Set by the current loop: observer angle and speed replace the sensor. */
+} app_axis_t;
+
+typedef struct app_context_t {
+	app_axis_t axis[MOTOR_AXIS_COUNT];
+	motor_scope_handle_t motor_scope_h;       /* Records the primary axis. */
+	telemetry_handle_t telemetry_h;
+	telemetry_stream_handle_t telemetry_stream_h;  /* Channels of the primary axis. */
+	/* Set by the actuation task, taken by the control ISR that samples the stream (ISR actuation modes). */
+	volatile bool telemetry_sample_pending;
+	scheduler_handle_t scheduler_h;
+	timing_monitor_handle_t timing_monitor_h;  /* Latency channel follows the primary axis. */
+	calibration_store_handle_t calibration_store_h; /* Primary axis record. */
+	uint16_t scope_dump_index; /* Next scope row to send while a capture is complete. */
+	int32_t speed_control_target_mechanical_speed_mrpm;
+	command_handle_t command_h;
+	/* Double-buffered parameters: commands write the shadow copy, control and telemetry read the active one. */
+	app_param_block_t param_blocks[2];
+	volatile uint8_t active_param_index;
+	bool param_apply_pending;                 /* Shadow committed by the host, swapped at the next control step. */
+	app_reference_stream_t reference_stream;
+	app_position_move_t position_move;
+	/* Segment tables referenced by the trajectories, rewritten only when a block is swapped in. */
+	motor_trajectory_segment_t speed_profile_segments[APP_SPEED_PROFILE_SEGMENT_COUNT];
+	motor_trajectory_segment_t setpoint_segment;
+	motor_trajectory_segment_t position_hold_segment;
+} app_context_t;
+
+/* Build-time feature selections (app_motor_test_config.h), folded by the compiler. */
+
+/**
+ * @brief Return whether the RAM scope records control signals.
+ *
+ * @return true if the scope is enabled, false otherwise.
+ */
+static inline bool app_scope_enabled(void)
+{
+	return (APP_MOTOR_TEST_SCOPE_MODE == APP_MOTOR_TEST_SCOPE_MODE_ON);
+}
+
+/**
+ * @brief Return whether the speed PI drives an Iq reference for the current loop.
+ *
+ * @return true for current-mode FOC, false for voltage-mode Uq actuation.
+ */
+static inline bool app_torque_control_uses_current_loop(void)
+{
+	return (APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT);
+}
+
+/**
+ * @brief Return whether the alignment calibration is kept in FLASH.
+ *
+ * @return true if the calibration store is used, false otherwise.
+ */
+static inline bool app_calibration_store_enabled(void)
+{
+	return (APP_MOTOR_TEST_CALIBRATION_STORE_MODE == APP_MOTOR_TEST_CALIBRATION_STORE_MODE_ON);
+}
+
+/**
+ * @brief Return whether this axis keeps its alignment in the calibration store.
+ *
+ * The store holds one record; further axes align on every boot.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true for the primary axis with the store enabled, false otherwise.
+ */
+static inline bool app_axis_uses_calibration_store(const app_axis_t *axis)
+{
+	return (app_calibration_store_enabled()) && (axis->index == 0u);
+}
+
+/**
+ * @brief Return whether the speed-PI gains are identified on target after alignment.
+ *
+ * @return true if autotune runs before the speed profile, false otherwise.
+ */
+static inline bool app_speed_pi_autotune_enabled(void)
+{
+	return (APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE == APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_ON);
+}
+
+/**
+ * @brief Return whether the autotune experiment currently owns the speed-loop command.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true while the experiment runs, false otherwise.
+ */
+static inline bool app_speed_pi_autotune_is_running(const app_axis_t *axis)
+{
+	return (app_speed_pi_autotune_enabled()) &&
+		   (axis->motor_speed_autotune_h.state == MOTOR_SPEED_AUTOTUNE_STATE_RUNNING);
+}
+
+/**
+ * @brief Return whether a negative Ud extends the speed range above base speed.
+ *
+ * @return true if field weakening runs in the speed step, false otherwise.
+ */
+static inline bool app_field_weakening_enabled(void)
+{
+	return (APP_MOTOR_TEST_FIELD_WEAKENING_MODE == APP_MOTOR_TEST_FIELD_WEAKENING_MODE_ON);
+}
+
+/**
+ * @brief Return whether the FOC angle is advanced with the speed.
+ *
+ * @return true if the lead-angle module runs in the speed step, false otherwise.
+ */
+static inline bool app_lead_angle_enabled(void)
+{
+	return (APP_MOTOR_TEST_LEAD_ANGLE_MODE != APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF);
+}
+
+/**
+ * @brief Return whether the learned cogging Uq feedforward is used.
+ *
+ * @return true if the table is learned in the speed step and applied in the FOC step, false otherwise.
+ */
+static inline bool app_cogging_compensation_enabled(void)
+{
+	return (APP_MOTOR_TEST_COGGING_COMPENSATION_MODE == APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_ON);
+}
+
+/**
+ * @brief Return whether the flux observer runs next to the AS5600 angle.
+ *
+ * @return true in the cross-check and fallback modes, false otherwise.
+ */
+static inline bool app_flux_observer_enabled(void)
+{
+	return (APP_MOTOR_TEST_FLUX_OBSERVER_MODE != APP_MOTOR_TEST_FLUX_OBSERVER_MODE_OFF);
+}
+
+/**
+ * @brief Return whether the flux observer may take over from a failed angle sample.
+ *
+ * @return true in the fallback mode, false otherwise.
+ */
+static inline bool app_flux_observer_fallback_enabled(void)
+{
+	return (APP_MOTOR_TEST_FLUX_OBSERVER_MODE == APP_MOTOR_TEST_FLUX_OBSERVER_MODE_FALLBACK);
+}
+
+/**
+ * @brief Return whether the constant-speed lead-angle sweep owns the speed reference.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true while the sweep settles or averages, false otherwise.
+ */
+static inline bool app_lead_angle_calibration_is_running(const app_axis_t *axis)
+{
+	return (APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE == APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_ON) &&
+		   ((axis->motor_lead_angle_h.calibration_state == MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING) ||
+			(axis->motor_lead_angle_h.calibration_state == MOTOR_LEAD_ANGLE_CALIBRATION_STATE_AVERAGING));
+}
+
+/**
+ * @brief Return whether the AS5600 angle linearization table is used.
+ *
+ * @return true if a stored table is applied or calibrated after alignment, false otherwise.
+ */
+static inline bool app_angle_linearization_enabled(void)
+{
+	return (APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE == APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_ON);
+}
+
+/**
+ * @brief Return whether the constant-speed linearization run owns the speed reference.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true while the run settles or records, false otherwise.
+ */
+static inline bool app_angle_linearization_is_running(const app_axis_t *axis)
+{
+	return (app_angle_linearization_enabled()) &&
+		   ((axis->motor_angle_linearization_h.state == MOTOR_ANGLE_LINEARIZATION_STATE_SETTLING) ||
+			(axis->motor_angle_linearization_h.state == MOTOR_ANGLE_LINEARIZATION_STATE_RECORDING));
+}
+
+/**
+ * @brief Return whether FOC actuation runs in the PWM-synchronous TIM1 update ISR.
+ *
+ * @return true for PWM ISR mode, false for superloop mode.
+ */
+static inline bool app_control_loop_uses_pwm_isr(void)
+{
+	return (APP_MOTOR_TEST_CONTROL_LOOP_MODE == APP_MOTOR_TEST_CONTROL_LOOP_MODE_PWM_ISR);
+}
+
+/**
+ * @brief Return whether the hardware-timed 6-step drive replaces FOC after alignment.
+ *
+ * @return true for 6-step on TIM1 COM events, false for FOC.
+ */
+static inline bool app_drive_uses_6step_com(void)
+{
+	return (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM);
+}
+
+/**
+ * @brief Return whether the actuation path extrapolates the electrical angle.
+ *
+ * @return true if angle prediction is enabled, false otherwise.
+ */
+static inline bool app_angle_prediction_enabled(void)
+{
+	return (APP_MOTOR_TEST_ANGLE_PREDICTION_MODE == APP_MOTOR_TEST_ANGLE_PREDICTION_MODE_ON);
+}
+
+/**
+ * @brief Return whether host commands are read from USART2 RX.
+ *
+ * @return true if the command channel is enabled, false otherwise.
+ */
+static inline bool app_command_enabled(void)
+{
+	return (APP_MOTOR_TEST_COMMAND_MODE == APP_MOTOR_TEST_COMMAND_MODE_ON);
+}
+
+/**
+ * @brief Return whether the background tasks run only on posted events (WFI otherwise).
+ *
+ * @return true if the scheduler idles in event mode, false otherwise.
+ */
+static inline bool app_scheduler_event_driven(void)
+{
+	return (APP_MOTOR_TEST_SCHEDULER_IDLE_MODE == APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_EVENT);
+}
+
+/**
+ * @brief Return whether the control-loop timing health is monitored.
+ *
+ * @return true if the timing monitor is enabled, false otherwise.
+ */
+static inline bool app_timing_monitor_enabled(void)
+{
+	return (APP_MOTOR_TEST_TIMING_MONITOR_MODE == APP_MOTOR_TEST_TIMING_MONITOR_MODE_ON);
+}
+
+/**
+ * @brief Return whether the mechanical angle comes from the AS5600 I2C interface.
+ *
+ * @return true for the digital I2C source, false for the analog output on ADC1.
+ */
+static inline bool app_angle_sensor_uses_i2c(void)
+{
+	return (APP_MOTOR_TEST_ANGLE_SENSOR_MODE == APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C);
+}
+
+/**
+ * @brief Return absolute value of one signed 32-bit value.
+ *
+ * @param value Signed value.
+ * @return Absolute value.
+ */
+static inline int32_t app_abs_i32(int32_t value)
+{
+	if (value < 0)
+	{
+		return -value;
+	}
+
+	return value;
+}
+
+/* Application services implemented in main.c. */
+
+/**
+ * @brief Stop the powered test path and trap on one fatal runtime error.
+ *
+ * @param app Pointer to application runtime context.
+ * @param tag Log tag.
+ * @param msg Log message.
+ */
+void app_fatal_stop(app_context_t *app, const char *tag, const char *msg);
+
+/**
+ * @brief Record one scope sample of the primary axis (other axes are not recorded).
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true if recorded or not recorded for this axis, false if the scope rejected the sample.
+ */
+bool app_scope_record(app_axis_t *axis);
+
+/**
+ * @brief Store the alignment result for the next boots.
+ *
+ * Runs once after a fresh alignment while the power stage holds the
+ * alignment vector, and again after a linearization run or a learned
+ * cogging table; FLASH programming stalls the CPU for well below 1 ms.
+ * The full-sector erase (about 1 s) never runs here with the bridge
+ * switching: boot reserves one blank slot per save of the boot, a save
+ * without a blank slot is skipped.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param electrical_offset_u16 Offset from the alignment sample.
+ */
+void app_save_calibration(app_axis_t *axis, uint16_t electrical_offset_u16);
+
+#endif /* APP_APP_CONTEXT_H */
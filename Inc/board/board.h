@@ -19,7 +19,7 @@
 void toggle_led();
 
 /**
- * @brief Initialize board peripherals (GPIO, EXTI, ADC, USART2, TIM1 PWM).
+ * @brief Initialize the clock tree and board peripherals (GPIO, EXTI, ADC, USART2, TIM1 PWM).
  */
 void board_init();
 
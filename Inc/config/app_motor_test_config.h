@@ -19,35 +19,410 @@
 #define APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN                       (-1)
 #define APP_MOTOR_TEST_ALIGNMENT_AMPLITUDE_PERMYRIAD                1500u
 #define APP_MOTOR_TEST_MAX_AMPLITUDE_PERMYRIAD                      10000u
+/* FOC modulation stage: sine, SVPWM midpoint centring or DPWM (10000 = linear limit in SVPWM/DPWM, 1.155x sine). */
+#define APP_MOTOR_TEST_PWM_MODULATION_SINE                          0u
+#define APP_MOTOR_TEST_PWM_MODULATION_SVPWM                         1u
+#define APP_MOTOR_TEST_PWM_MODULATION_DPWM                          2u
+#define APP_MOTOR_TEST_PWM_MODULATION                               APP_MOTOR_TEST_PWM_MODULATION_SINE
+/* Dead-time compensation: polarity from the phase command or the measured phase currents (current mode). */
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_OFF                      0u
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_COMMAND                  1u
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_CURRENT                  2u
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_MODE                          APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_OFF
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_NS                            0u      /* 0 = TIM1 dead time (PWM_DEAD_TIME_NS) */
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_COMMAND_BAND_PERMYRIAD        50
+#define APP_MOTOR_TEST_DEAD_TIME_COMP_CURRENT_BAND_MA               100
 #define APP_MOTOR_TEST_UPDATE_PERIOD_MS                             1u
 #define APP_MOTOR_TEST_STARTUP_OPENLOOP_PHASE_INCREMENT_RAMP_STEP_U32 1u
 #define APP_MOTOR_TEST_ALIGNMENT_DURATION_MS                        400u
 #define APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16               0u
+/* FLASH calibration record: a valid record for this build skips the alignment hold, a new alignment is stored. */
+#define APP_MOTOR_TEST_CALIBRATION_STORE_MODE_OFF                   0u
+#define APP_MOTOR_TEST_CALIBRATION_STORE_MODE_ON                    1u
+#define APP_MOTOR_TEST_CALIBRATION_STORE_MODE                       APP_MOTOR_TEST_CALIBRATION_STORE_MODE_ON
+/* Sector of the linker CALIB region (0x08060000, 128 KB). */
+#define APP_MOTOR_TEST_CALIBRATION_STORE_FLASH_SECTOR               7u
+/* AS5600 linearization: apply the stored correction table; without one, a constant-speed run after
+ * alignment records angle vs. time, builds the table and stores it with the calibration record. */
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_OFF                 0u
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_ON                  1u
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE                     APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_OFF
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_POINT_COUNT              32u
+/* Low constant speed: 60 rpm gives ~62 published samples per table point and turn. */
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_SPEED_MRPM               60000
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_REVOLUTION_COUNT         8u
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_SETTLE_TIME_MS           2000u
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_TIMEOUT_MS               30000u
+#define APP_MOTOR_TEST_ANGLE_LINEARIZATION_MIN_SAMPLES_PER_POINT    50u
 #define APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US                   100u
 #define APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT               5u
+/* Publish window: fixed RAW_SAMPLE_COUNT, or the longest window (MIN..16 samples) whose angle travel at the
+ * measured speed stays within TRAVEL_COUNTS (timer DMA: multiples of RAW_SAMPLE_COUNT). */
+#define APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE_FIXED              0u
+#define APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE_ADAPTIVE           1u
+#define APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE                    APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE_FIXED
+#define APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MIN_SAMPLES             2u
+/* 2 deg per window: 16 samples up to ~200 rpm, 6 at the 500 rpm profile peak. */
+#define APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_TRAVEL_COUNTS           ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 2u) / 360u)
+/* AS5600 raw-sample acquisition: SysTick-scheduled SWSTART or TIM1-synchronous trigger with DMA2 windows. */
+#define APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_SOFTWARE              0u
+#define APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_TIMER_DMA             1u
+#define APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE                       APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_SOFTWARE
+/* AS5600 angle source: analog output on ADC1 or the digital ANGLE register over I2C1 + DMA (PB8/PB9). */
+#define APP_MOTOR_TEST_ANGLE_SENSOR_MODE_ANALOG                     0u
+#define APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C                        1u
+#define APP_MOTOR_TEST_ANGLE_SENSOR_MODE                            APP_MOTOR_TEST_ANGLE_SENSOR_MODE_ANALOG
+/* I2C reads every publish period; the ~150 us transaction completes ~50 us before the 1 ms control tick. */
+#define APP_MOTOR_TEST_ANGLE_I2C_SAMPLE_PHASE_US                    300u
 /* Lightweight UART telemetry output interval for runtime tuning logs. */
 #define APP_MOTOR_TEST_TELEMETRY_PERIOD_MS                          20u
+/* Runtime telemetry format: printf S-lines or binary frames (decode with tools/telemetry_decode.py). */
+#define APP_MOTOR_TEST_TELEMETRY_FORMAT_TEXT                        0u
+#define APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY                      1u
+#define APP_MOTOR_TEST_TELEMETRY_FORMAT                             APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY
+/* Binary encoder interval: one stream frame per speed-step snapshot with the channels due in it. */
+#define APP_MOTOR_TEST_BINARY_TELEMETRY_PERIOD_MS                   1u
+/* Telemetry channels (registry in main.c, mask bit = channel id): boot mask and decimation in speed steps.
+ * Default: angle, filtered and reference speed, Uq and trajectory step (ids 0..4) with angle and Uq at
+ * half rate, ~21 bytes per ms (~92% of 230400 baud). Both can be changed with SET_PARAM. */
+#define APP_MOTOR_TEST_TELEMETRY_CHANNEL_MASK                       0x001Fu
+#define APP_MOTOR_TEST_TELEMETRY_CHANNEL_DECIMATION                 {2u, 1u, 1u, 2u, 10u, 10u, 1u, 1u, 10u, 10u, 1u, 1u, 2u}
+/* Host command channel on USART2 RX (encode with tools/command_send.py); parameters apply between speed steps. */
+#define APP_MOTOR_TEST_COMMAND_MODE_OFF                             0u
+#define APP_MOTOR_TEST_COMMAND_MODE_ON                              1u
+#define APP_MOTOR_TEST_COMMAND_MODE                                 APP_MOTOR_TEST_COMMAND_MODE_ON
+/* Command frames decoded per scheduler pass (bounds the background task run time). */
+#define APP_MOTOR_TEST_COMMAND_FRAMES_PER_PASS                      4u
+/* Streamed reference points, one consumed per speed-control step (64 = 64 ms lead at 1 kHz). */
+#define APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY                    64u
+/* Profiler dump interval (P-lines or 26-byte frames, one per active probe). */
+#define APP_MOTOR_TEST_PROFILE_DUMP_PERIOD_MS                       1000u
 #define APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS                       65536u
 /* Half-turn threshold used for one wrap correction in corrected-delta conversion. */
 #define APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS                       (APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS / 2u)
 /* Maximum plausible mechanical step per 500 us publish interval (~8 mechanical degrees). */
 #define APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 8u) / 360u)
 #define APP_MOTOR_TEST_FAULT_TRIGGER_ABS_SPEED_ERROR_MRPM          100000
+/* Per-step fault checks in the FOC context (fast loop, current loop or superloop); 0 disables a check. */
+/* Starvation: ten 500 us publish intervals without a new angle sample. */
+#define APP_MOTOR_TEST_FAULT_MAX_SAMPLE_AGE_US                     5000u
+/* Over-speed limit (1.6x the profile peak); also bounds the plausible angle step between two samples. */
+#define APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM                    800000
+/* Sensor noise allowance on top of the speed-bounded step (~4 mechanical degrees). */
+#define APP_MOTOR_TEST_FAULT_ANGLE_STEP_MARGIN_COUNTS              ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 4u) / 360u)
+/* F-line fault record repeat interval while trapped. */
+#define APP_MOTOR_TEST_FAULT_RECORD_PERIOD_MS                      1000u
 /* Speed-feedback LPF time constant tau (larger tau => smoother, smaller tau => faster). */
 #define APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS       30u
+/* Speed-feedback mode: angle difference + LPF (validated) or PLL tracking observer. */
+#define APP_MOTOR_TEST_SPEED_FEEDBACK_MODE_LPF                      0u
+#define APP_MOTOR_TEST_SPEED_FEEDBACK_MODE_PLL                      1u
+#define APP_MOTOR_TEST_SPEED_FEEDBACK_MODE                          APP_MOTOR_TEST_SPEED_FEEDBACK_MODE_LPF
+/* PLL observer natural frequency (critically damped); must stay below ~150 Hz at the 500 us publish rate. */
+#define APP_MOTOR_TEST_SPEED_FEEDBACK_PLL_BANDWIDTH_HZ              40u
 /* Speed PI gains use Q15 fixed-point on mrpm input and permyriad output. */
 #define APP_MOTOR_TEST_SPEED_PI_KP_Q15                              2700u
-/* Ki is zero temporarily so the first closed-loop test runs in P-only mode. */
+/* Fixed gains, used until a gain schedule is loaded (autotune below). */
 #define APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15                        6000u
 #define APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD              6000u
 #define APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS                    1u
-/* First tuning profile: bidirectional trapezoid 0 -> +peak -> 0 -> -peak -> 0 (repeat). */
+/* Reference feedforward (0 = off). Identify Ke as peak-hold integrator / peak speed, J from the ramp integrator offset. */
+#define APP_MOTOR_TEST_SPEED_PI_FF_SPEED_Q15                        0
+#define APP_MOTOR_TEST_SPEED_PI_FF_ACCELERATION_Q15                 0
+#define APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_PERMYRIAD               0u
+#define APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_DEADBAND_MRPM           5000u
+/* Feedforward budget inside APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD, the rest stays for P + I. */
+#define APP_MOTOR_TEST_SPEED_PI_FF_LIMIT_PERMYRIAD                  4000u
+/* Speed-PI autotune: after alignment a Uq staircase identifies K / (tau s + 1) per step and loads a gain schedule. */
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_OFF                   0u
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_ON                    1u
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE                       APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_OFF
+/* Staircase up to step_count * step_uq (keep below the output limit and the safe test speed). */
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_STEP_COUNT                 4u
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_STEP_UQ_PERMYRIAD          1000u
+/* Hold per step: at least 5 open-loop time constants. */
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_SETTLE_TIME_MS             1500u
+/* Closed-loop time constant = plant tau / speedup. */
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_CLOSED_LOOP_SPEEDUP        3u
+#define APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MIN_DELTA_SPEED_MRPM       20000u
+/* Field weakening (voltage mode): negative Ud holds |(Ud, Uq)| at the target above base speed, Uq gets the rest of the circle. */
+#define APP_MOTOR_TEST_FIELD_WEAKENING_MODE_OFF                     0u
+#define APP_MOTOR_TEST_FIELD_WEAKENING_MODE_ON                      1u
+#define APP_MOTOR_TEST_FIELD_WEAKENING_MODE                         APP_MOTOR_TEST_FIELD_WEAKENING_MODE_OFF
+/* Circle radius = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD; the target leaves headroom for speed corrections. */
+#define APP_MOTOR_TEST_FIELD_WEAKENING_VOLTAGE_TARGET_PERCENT       95u
+#define APP_MOTOR_TEST_FIELD_WEAKENING_MAX_UD_PERMYRIAD             4000u
+/* 10 * 32768: 300 permyriad above target moves Ud by 3000 permyriad/s. */
+#define APP_MOTOR_TEST_FIELD_WEAKENING_KI_PER_S_Q15                 327680
+#define APP_MOTOR_TEST_FIELD_WEAKENING_MIN_SPEED_MRPM               100000u
+/* Phase advance (voltage mode): electrical lead added to the FOC angle, from a table or atan(omega_e * L / R). */
+#define APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF                          0u
+#define APP_MOTOR_TEST_LEAD_ANGLE_MODE_TABLE                        1u
+#define APP_MOTOR_TEST_LEAD_ANGLE_MODE_MODEL                        2u
+#define APP_MOTOR_TEST_LEAD_ANGLE_MODE                              APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF
+/* Table points at k * spacing of |mechanical speed| (0..700 rpm), electrical counts (182 = 1 deg). */
+#define APP_MOTOR_TEST_LEAD_ANGLE_POINT_COUNT                       8u
+#define APP_MOTOR_TEST_LEAD_ANGLE_POINT_SPACING_MRPM                100000u
+#define APP_MOTOR_TEST_LEAD_ANGLE_TABLE                             {0u, 728u, 1456u, 2184u, 2730u, 3276u, 3640u, 4004u}
+#define APP_MOTOR_TEST_LEAD_ANGLE_MAX_ADVANCE_COUNTS                ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 30u) / 360u)
+/* Calibration after alignment: hold SPEED, step the advance by STEP_COUNTS, keep the lowest mean |Uq|, refill from tau. */
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_OFF              0u
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_ON               1u
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE                  APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_OFF
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_MRPM            400000
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS           ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 1u) / 360u)
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNT            30u
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SETTLE_TIME_MS        300u
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_AVERAGE_TIME_MS       200u
+#define APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_TOLERANCE_MRPM  30000u
+
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_OFF                0u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_ON                 1u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_MODE                    APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_OFF
+/* Equidistant Uq table over one mechanical turn, learned at held speed and stored with the calibration. */
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT             64u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_GAIN_Q15       2048
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_DELAY_US       12000u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_CORRECTION_PERMYRIAD 1000u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_DELTA_COUNTS        8192u
+#define APP_MOTOR_TEST_COGGING_COMPENSATION_SAVE_REVOLUTION_COUNT   50u
+/* Default trajectory table (app_command.c): S-curve ramps 0 -> +peak -> 0 -> -peak -> 0 (repeat). */
 #define APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM     500000
 /* Conservative symmetric ramp magnitude used for both positive and negative ramps. */
-#define APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S        300000
+#define APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S        300000u
+/* Jerk limit (0 = trapezoid); 3e6 rounds each acceleration edge over 100 ms. */
+#define APP_MOTOR_TEST_SPEED_PROFILE_JERK_MRPM_PER_S2               3000000u
 #define APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS                   500u
 #define APP_MOTOR_TEST_SPEED_PROFILE_PEAK_HOLD_MS                   1000u
+/* Position mode (app_axis.c): P(I) on the multi-turn angle around the speed PI, trajectory speed as feedforward.
+ * Kp in Q15 mrpm per count: 600000 ~ 18.3 mrpm/count ~ 20 rad/s position-loop bandwidth. Moves use the profile limits. */
+#define APP_MOTOR_TEST_POSITION_KP_Q15                              600000
+#define APP_MOTOR_TEST_POSITION_KI_PER_S_Q15                        0
+/* Move cruise speed and speed-command clamp. */
+#define APP_MOTOR_TEST_POSITION_MAX_SPEED_MRPM                      300000
+/* In position: move finished and |reference - measured| within the window (182 counts ~ 1 deg) for the settle time. */
+#define APP_MOTOR_TEST_POSITION_IN_POSITION_WINDOW_COUNTS           182u
+#define APP_MOTOR_TEST_POSITION_IN_POSITION_SETTLE_MS               50u
 #define APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT 50u
 #define APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE                        4095u
+/* Control-loop execution modes: 1 ms superloop actuation or PWM-synchronous TIM1 update ISR. */
+#define APP_MOTOR_TEST_CONTROL_LOOP_MODE_SUPERLOOP                  0u
+#define APP_MOTOR_TEST_CONTROL_LOOP_MODE_PWM_ISR                    1u
+#define APP_MOTOR_TEST_CONTROL_LOOP_MODE                            APP_MOTOR_TEST_CONTROL_LOOP_MODE_SUPERLOOP
+/* Fast-loop rate divider in PWM periods (20 kHz / 4 = 5 kHz, 200 us = 36000 cycles at 180 MHz SYSCLK). */
+#define APP_MOTOR_TEST_FAST_LOOP_PWM_DIVIDER                        4u
+/* Electrical-angle prediction: extrapolate theta_e from the sample capture instant to the actuation midpoint. */
+#define APP_MOTOR_TEST_ANGLE_PREDICTION_MODE_OFF                    0u
+#define APP_MOTOR_TEST_ANGLE_PREDICTION_MODE_ON                     1u
+#define APP_MOTOR_TEST_ANGLE_PREDICTION_MODE                        APP_MOTOR_TEST_ANGLE_PREDICTION_MODE_OFF
+/* Control step -> middle of the interval its duties are active (CCR preload: next update event, then one interval).
+ * Current loop and PWM ISR: 1.5 loop periods of 50 us PWM periods; superloop: ~25 us to the next update + half of 1 ms. */
+#define APP_MOTOR_TEST_ANGLE_PREDICTION_ACTUATION_DELAY_US          ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) ? 75u : \
+                                                                     (APP_MOTOR_TEST_CONTROL_LOOP_MODE == APP_MOTOR_TEST_CONTROL_LOOP_MODE_PWM_ISR) ? \
+                                                                     (APP_MOTOR_TEST_FAST_LOOP_PWM_DIVIDER * 75u) : 525u)
+/* Prediction horizon clamp: stale samples must not spin the vector. */
+#define APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US              2000u
+/* Torque control: speed PI drives Uq directly (validated) or an Iq reference for the PWM-synchronous current loop.
+ * Current mode needs phase-shunt amplifiers on ADC2 (PA1/PA4/PC1); the SimpleFOC Mini board has none. */
+#define APP_MOTOR_TEST_TORQUE_CONTROL_MODE_VOLTAGE                  0u
+#define APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT                  1u
+#define APP_MOTOR_TEST_TORQUE_CONTROL_MODE                          APP_MOTOR_TEST_TORQUE_CONTROL_MODE_VOLTAGE
+/* Drive after alignment: sensored FOC or hardware-timed 6-step (TIM1 COM events, speed-PI Uq as signed duty). */
+#define APP_MOTOR_TEST_DRIVE_MODE_FOC                               0u
+#define APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM                         1u
+#define APP_MOTOR_TEST_DRIVE_MODE                                   APP_MOTOR_TEST_DRIVE_MODE_FOC
+/* 6-step commutation instant: Hall edges (EXTI, PC6/PC7/PC8) or a TIM5 compare computed from the AS5600 angle. */
+#define APP_MOTOR_TEST_6STEP_COM_TRIGGER_HALL                       0u
+#define APP_MOTOR_TEST_6STEP_COM_TRIGGER_ANGLE                      1u
+#define APP_MOTOR_TEST_6STEP_COM_TRIGGER                            APP_MOTOR_TEST_6STEP_COM_TRIGGER_ANGLE
+/* Hall code (A = bit 0) -> pattern for positive torque; 0 and 7 are invalid. Check on the bench per motor. */
+#define APP_MOTOR_TEST_6STEP_COM_HALL_TO_PATTERN                    {0xFFu, 5u, 3u, 4u, 1u, 0u, 2u, 0xFFu}
+/* ANGLE trigger: slower or older samples fall back to 1 ms sector tracking in the main loop. */
+#define APP_MOTOR_TEST_6STEP_COM_MIN_MECHANICAL_SPEED_MRPM          300000
+#define APP_MOTOR_TEST_6STEP_COM_MAX_SAMPLE_AGE_US                  2000u
+/* Boundary closer than this when the COM is armed: commit at once instead of a TIM5 compare. */
+#define APP_MOTOR_TEST_6STEP_COM_MIN_LEAD_US                        5u
+/* Iq reference at a 10000 permyriad speed-PI command (speed PI limit 6000 => 60% of this). */
+#define APP_MOTOR_TEST_CURRENT_LIMIT_MA                             2000
+/* Shunt chain gain: 10 mOhm x 50 V/V into 3.3 V / 4096 counts => 1.611 mA per count (Q16). */
+#define APP_MOTOR_TEST_CURRENT_SENSE_MA_PER_COUNT_Q16               105600
+#define APP_MOTOR_TEST_CURRENT_SENSE_SIGN                           1
+/* Offset calibration with the stage disabled: 1024 PWM periods (~51 ms), mid-rail +/- 200 counts. */
+#define APP_MOTOR_TEST_CURRENT_SENSE_CALIBRATION_SAMPLE_COUNT       1024u
+#define APP_MOTOR_TEST_CURRENT_SENSE_NOMINAL_OFFSET_COUNTS          2048u
+#define APP_MOTOR_TEST_CURRENT_SENSE_MAX_OFFSET_DEVIATION_COUNTS    200u
+#define APP_MOTOR_TEST_CURRENT_SENSE_CALIBRATION_TIMEOUT_MS         200u
+/* Current PI at the 20 kHz PWM rate: Kp = L*wc, Ki = R*wc for wc = 2*pi*500 rad/s (L = 1 mH, R = 1 Ohm, 12 V bus). */
+#define APP_MOTOR_TEST_CURRENT_PI_KP_Q15                            171000
+#define APP_MOTOR_TEST_CURRENT_PI_KI_PER_S_Q15                      171000000
+#define APP_MOTOR_TEST_CURRENT_PI_UPDATE_PERIOD_US                  50u
+#define APP_MOTOR_TEST_CURRENT_PI_OUTPUT_LIMIT_PERMYRIAD            8000u
+#define APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH                    1000u
+#define APP_MOTOR_TEST_MOTOR_PHASE_RESISTANCE_MOHM                  1000u
+#define APP_MOTOR_TEST_BUS_VOLTAGE_MV                               12000u
+/* Flux observer (current mode): back-EMF angle and speed next to the AS5600 path.
+ * CROSSCHECK reports the divergence; FALLBACK also takes over the angle when a sample fails the fault gate. */
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MODE_OFF                       0u
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MODE_CROSSCHECK                1u
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MODE_FALLBACK                  2u
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MODE                           APP_MOTOR_TEST_FLUX_OBSERVER_MODE_OFF
+/* Peak phase magnet flux linkage: back-EMF constant in V s/rad (electrical), e.g. Ke[Vpk/krpm_e] / 104.7. */
+#define APP_MOTOR_TEST_MOTOR_FLUX_LINKAGE_UWB                       5000u
+/* Phase voltage per alpha/beta permyriad: bus / 20000, x 2/sqrt(3) for SVPWM and DPWM (Q16). */
+#define APP_MOTOR_TEST_FLUX_OBSERVER_VOLTAGE_MV_PER_PERMYRIAD_Q16   ((APP_MOTOR_TEST_PWM_MODULATION == APP_MOTOR_TEST_PWM_MODULATION_SINE) ? \
+                                                                     (int32_t)((APP_MOTOR_TEST_BUS_VOLTAGE_MV * 65536u) / 20000u) : \
+                                                                     (int32_t)((APP_MOTOR_TEST_BUS_VOLTAGE_MV * 75674u) / 20000u))
+#define APP_MOTOR_TEST_FLUX_OBSERVER_GAIN_PER_S                     1000u
+#define APP_MOTOR_TEST_FLUX_OBSERVER_PLL_BANDWIDTH_HZ               150u
+/* Valid above 100 rpm with the filtered PLL error below 5 deg electrical. */
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MIN_SPEED_MRPM                 100000u
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MAX_PLL_ERROR_COUNTS           ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 5u) / 360u)
+/* |observer - sensor| electrical angle above this (while valid) is logged once per excursion. */
+#define APP_MOTOR_TEST_FLUX_OBSERVER_MAX_DIVERGENCE_COUNTS          ((APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS * 20u) / 360u)
+
+/* RAM scope: full-rate capture at the 1 ms speed-loop step, dumped over USART2 after the trigger
+ * (regular telemetry pauses during the dump; 4 ch x 512 samples = 8 KiB static RAM). */
+#define APP_MOTOR_TEST_SCOPE_MODE_OFF                               0u
+#define APP_MOTOR_TEST_SCOPE_MODE_ON                                1u
+#define APP_MOTOR_TEST_SCOPE_MODE                                   APP_MOTOR_TEST_SCOPE_MODE_OFF
+#define APP_MOTOR_TEST_SCOPE_SAMPLE_COUNT                           512u
+#define APP_MOTOR_TEST_SCOPE_PRE_TRIGGER_SAMPLES                    128u
+#define APP_MOTOR_TEST_SCOPE_DECIMATION                             1u
+/* Scope channels (motor_scope_channel_t names), up to four. */
+#define APP_MOTOR_TEST_SCOPE_CHANNEL_0                              MOTOR_SCOPE_CHANNEL_FILTERED_SPEED
+#define APP_MOTOR_TEST_SCOPE_CHANNEL_1                              MOTOR_SCOPE_CHANNEL_SPEED_ERROR
+#define APP_MOTOR_TEST_SCOPE_CHANNEL_2                              MOTOR_SCOPE_CHANNEL_SPEED_INTEGRATOR
+#define APP_MOTOR_TEST_SCOPE_CHANNEL_3                              MOTOR_SCOPE_CHANNEL_UQ_COMMAND
+/* Scope trigger: speed-profile phase change, |speed error| level or fault only; every fault also freezes and dumps. */
+#define APP_MOTOR_TEST_SCOPE_TRIGGER_PROFILE_PHASE                  0u
+#define APP_MOTOR_TEST_SCOPE_TRIGGER_SPEED_ERROR                    1u
+#define APP_MOTOR_TEST_SCOPE_TRIGGER_FAULT                          2u
+#define APP_MOTOR_TEST_SCOPE_TRIGGER                                APP_MOTOR_TEST_SCOPE_TRIGGER_PROFILE_PHASE
+/* Level trigger on scope channel 1 (speed error). */
+#define APP_MOTOR_TEST_SCOPE_LEVEL_CHANNEL_INDEX                    1u
+#define APP_MOTOR_TEST_SCOPE_SPEED_ERROR_TRIGGER_MRPM               50000
+
+/* Deferred log drain: records queued with LOG_POSTn() are expanded in the background. */
+#define APP_MOTOR_TEST_LOG_DRAIN_PERIOD_MS                          10u
+#define APP_MOTOR_TEST_LOG_DRAIN_RECORDS_PER_RELEASE                4u
+
+/* Main-loop task scheduler: release offsets inside the 1 ms grid (speed PI, fault check and
+ * actuation share one slot in that priority order) and optional WFI sleep between releases.
+ * Event idle also runs the angle and command tasks only when their ISR posted an event
+ * (AS5600 publish, USART2 RX byte) instead of on every pass. */
+#define APP_MOTOR_TEST_SCHEDULER_CONTROL_PHASE_US                   0u
+#define APP_MOTOR_TEST_SCHEDULER_CONTROL_DEADLINE_US                500u
+#define APP_MOTOR_TEST_SCHEDULER_TELEMETRY_PHASE_US                 500u
+#define APP_MOTOR_TEST_SCHEDULER_REPORT_PHASE_US                    700u
+#define APP_MOTOR_TEST_SCHEDULER_LOG_DRAIN_PHASE_US                 300u
+#define APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_BUSY                     0u
+#define APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_WFI                      1u
+#define APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_EVENT                    2u
+#define APP_MOTOR_TEST_SCHEDULER_IDLE_MODE                          APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_BUSY
+
+/* Timing-health monitor: speed / actuation period jitter and angle capture -> CCR write latency histograms
+ * (6 bins, the last one open-ended), sent with the report; consecutive late samples latch a deadline fault (0 = report only). */
+#define APP_MOTOR_TEST_TIMING_MONITOR_MODE_OFF                      0u
+#define APP_MOTOR_TEST_TIMING_MONITOR_MODE_ON                       1u
+#define APP_MOTOR_TEST_TIMING_MONITOR_MODE                          APP_MOTOR_TEST_TIMING_MONITOR_MODE_ON
+#define APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_BIN_US                 50u
+#define APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_LATE_US                APP_MOTOR_TEST_SCHEDULER_CONTROL_DEADLINE_US
+#define APP_MOTOR_TEST_TIMING_MONITOR_LATENCY_BIN_US                250u
+/* Beyond the prediction clamp the actuation angle is no longer carried over the sample age. */
+#define APP_MOTOR_TEST_TIMING_MONITOR_LATENCY_LATE_US               APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US
+#define APP_MOTOR_TEST_TIMING_MONITOR_FAULT_LATE_COUNT              5u
+
+#if (APP_MOTOR_TEST_SCHEDULER_IDLE_MODE != APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_BUSY) && \
+    (APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE == APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_SOFTWARE)
+#error "WFI idle would stall the polled 100 us AS5600 starts; select timer DMA acquisition"
+#endif
+
+#if (APP_MOTOR_TEST_SCHEDULER_IDLE_MODE == APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_EVENT) && \
+    (APP_MOTOR_TEST_ANGLE_SENSOR_MODE == APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C)
+#error "Event idle wakes the angle task on analog publishes only; the I2C reader is polled"
+#endif
+
+#if (APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE == APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_ON) && \
+    (APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE == APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_ON)
+#error "Autotune and the linearization run both own the speed loop after alignment; enable one at a time"
+#endif
+
+#if (APP_MOTOR_TEST_ANGLE_SENSOR_MODE == APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C) && \
+    (APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE == APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_ON)
+#error "The linearization table corrects the analog output path; disable it for the I2C angle source"
+#endif
+
+#if (APP_MOTOR_TEST_ANGLE_SENSOR_MODE == APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C) && \
+    (APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE == APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE_ADAPTIVE)
+#error "The adaptive publish window belongs to the analog oversampling path; select the fixed window for I2C"
+#endif
+
+#if (APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) && \
+    (APP_MOTOR_TEST_CONTROL_LOOP_MODE == APP_MOTOR_TEST_CONTROL_LOOP_MODE_PWM_ISR)
+#error "Current mode runs its own PWM-synchronous loop; select the superloop control-loop mode"
+#endif
+
+#if (APP_MOTOR_TEST_DEAD_TIME_COMP_MODE == APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_CURRENT) && \
+    (APP_MOTOR_TEST_TORQUE_CONTROL_MODE != APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT)
+#error "Current-polarity dead-time compensation needs the phase currents; select current mode or the command polarity"
+#endif
+
+#if (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM) && \
+    ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+     (APP_MOTOR_TEST_CONTROL_LOOP_MODE == APP_MOTOR_TEST_CONTROL_LOOP_MODE_PWM_ISR))
+#error "6-step applies the speed-PI Uq as duty from the superloop; select voltage torque control and the superloop"
+#endif
+
+#if (APP_MOTOR_TEST_FIELD_WEAKENING_MODE == APP_MOTOR_TEST_FIELD_WEAKENING_MODE_ON) && \
+    ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+     (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM))
+#error "Field weakening regulates the voltage-mode FOC Ud; select voltage torque control and the FOC drive"
+#endif
+
+#if (APP_MOTOR_TEST_FIELD_WEAKENING_MODE == APP_MOTOR_TEST_FIELD_WEAKENING_MODE_ON) && \
+    ((APP_MOTOR_TEST_FIELD_WEAKENING_MAX_UD_PERMYRIAD >= APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD) || \
+     (APP_MOTOR_TEST_FIELD_WEAKENING_VOLTAGE_TARGET_PERCENT >= 100u))
+#error "Field-weakening Ud depth and voltage target must stay inside the speed-PI output limit"
+#endif
+
+#if (APP_MOTOR_TEST_LEAD_ANGLE_MODE != APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF) && \
+    ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+     (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM))
+#error "The phase advance turns the voltage-mode FOC vector; select voltage torque control and the FOC drive"
+#endif
+
+#if (APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE == APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_ON) && \
+    ((APP_MOTOR_TEST_LEAD_ANGLE_MODE == APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF) || \
+     (APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE == APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MODE_ON) || \
+     (APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE == APP_MOTOR_TEST_ANGLE_LINEARIZATION_MODE_ON))
+#error "The lead-angle calibration needs a lead-angle mode and owns the speed loop alone after alignment"
+#endif
+
+#if ((APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNT - 1u) * APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS) > \
+    APP_MOTOR_TEST_LEAD_ANGLE_MAX_ADVANCE_COUNTS
+#error "The lead-angle calibration sweep must stay within the advance clamp"
+#endif
+
+#if (APP_MOTOR_TEST_COGGING_COMPENSATION_MODE == APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_ON) && \
+    ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+     (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM))
+#error "The cogging table feeds forward into the voltage-mode FOC Uq; select voltage torque control and the FOC drive"
+#endif
+
+#if ((APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT & (APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT - 1u)) != 0u) || \
+    (APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_CORRECTION_PERMYRIAD >= APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD)
+#error "The cogging table needs a power-of-two point count and a correction clamp inside the speed-PI output limit"
+#endif
+
+#if (APP_MOTOR_TEST_FLUX_OBSERVER_MODE != APP_MOTOR_TEST_FLUX_OBSERVER_MODE_OFF) && \
+    ((APP_MOTOR_TEST_TORQUE_CONTROL_MODE != APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+     (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM))
+#error "The flux observer integrates the measured phase currents; select current torque control and the FOC drive"
+#endif
+
+#if (APP_MOTOR_TEST_POSITION_MAX_SPEED_MRPM <= 0) || \
+    (APP_MOTOR_TEST_POSITION_MAX_SPEED_MRPM > APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM)
+#error "The position-mode speed limit must be positive and inside the speed fault limit"
+#endif
 
 #endif /* CONFIG_APP_MOTOR_TEST_CONFIG_H */
@@ -0,0 +1,32 @@
+#ifndef CONFIG_BENCH_CONFIG_H
+#define CONFIG_BENCH_CONFIG_H
+
+/**
+ * @file bench_config.h
+ * @brief Kernel microbenchmark firmware configuration (Bench build).
+ *
+ * Module configurations (gains, sample periods, window lengths) follow
+ * app_motor_test_config.h, so the kernels run the same code paths as the
+ * motor test; only the run length and the reporting are set here.
+ */
+
+/* Timed calls per kernel; min / avg / max are taken over these. */
+#define BENCH_ITERATIONS                        1000u
+/* Untimed calls per kernel before the timed ones (filters settle, windows fill, caches warm). */
+#define BENCH_WARMUP_ITERATIONS                 100u
+/* Software-started AS5600 conversions timed through the ADC EOC probe. */
+#define BENCH_ADC_SAMPLE_COUNT                  1000u
+/* Abort the ADC case if the conversions stop completing. */
+#define BENCH_ADC_TIMEOUT_MS                    1000u
+/* Mechanical speed of the synthetic angle ramp fed to the angle based kernels. */
+#define BENCH_MECHANICAL_SPEED_MRPM             600000
+/* Angle noise amplitude added to the ramp (AS5600 ADC noise order). */
+#define BENCH_ANGLE_NOISE_COUNTS                24u
+/* Pause between report passes; 0 runs one pass and stops. */
+#define BENCH_REPEAT_PERIOD_MS                  5000u
+
+#if (BENCH_ITERATIONS == 0u) || (BENCH_ADC_SAMPLE_COUNT == 0u)
+#error "Every kernel needs at least one timed call"
+#endif
+
+#endif /* CONFIG_BENCH_CONFIG_H */
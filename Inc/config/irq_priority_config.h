@@ -0,0 +1,50 @@
+#ifndef CONFIG_IRQ_PRIORITY_CONFIG_H
+#define CONFIG_IRQ_PRIORITY_CONFIG_H
+
+/**
+ * @file irq_priority_config.h
+ * @brief Central NVIC priority plan and critical-section lock levels.
+ *
+ * Single source for every interrupt priority in project_config.c. Lower
+ * value = more urgent. All 4 implemented priority bits are preemption bits
+ * (no subpriority), so each level below preempts every level above it.
+ *
+ * Rules:
+ * - level 0 is reserved for the PWM break / fault path; BASEPRI cannot mask
+ *   it, so no critical section ever delays it
+ * - a lock level is the priority of the most urgent context that touches the
+ *   protected data (irq_lock_raise()); it must stay >= 1
+ * - keep control ISRs numerically below telemetry and logging users
+ */
+
+/* NVIC_SetPriorityGrouping() value: PRIGROUP 3 = 4 preemption bits, 0 subpriority bits */
+#define IRQ_PRIORITY_GROUPING			3u
+
+/* Interrupt priorities */
+#define IRQ_PRIORITY_FAULT				0u		// TIM1 break / fault path, never masked
+#define IRQ_PRIORITY_COMMUTATION		3u		// TIM1 COM and Hall EXTI: 6-step pattern preload
+#define IRQ_PRIORITY_PWM_UPDATE			4u		// TIM1 update: PWM-synchronous current loop
+#define IRQ_PRIORITY_ADC				5u		// ADC1 EOC (AS5600 analog) and ADC2 injected
+#define IRQ_PRIORITY_ANGLE_DMA			5u		// DMA2 Stream0: ADC1 angle sample windows
+#define IRQ_PRIORITY_I2C				5u		// I2C1 event/error and its RX DMA stream
+#define IRQ_PRIORITY_BUTTON				6u		// EXTI13 user button
+#define IRQ_PRIORITY_USART				7u		// USART2 and its TX DMA stream
+#define IRQ_PRIORITY_TIMEBASE			8u		// TIM5 overflow and SysTick
+
+/* Critical-section lock levels */
+#define IRQ_LOCK_PRIORITY_TIMESTAMP		IRQ_PRIORITY_PWM_UPDATE	// most urgent reader of the 64-bit timestamp
+#define IRQ_LOCK_PRIORITY_PROFILER		IRQ_PRIORITY_PWM_UPDATE	// most urgent ISR with a profiler probe
+#define IRQ_LOCK_PRIORITY_TIMING_MONITOR	IRQ_PRIORITY_PWM_UPDATE	// most urgent ISR with a timing-monitor channel
+#define IRQ_LOCK_PRIORITY_COMMUTATION	IRQ_PRIORITY_COMMUTATION	// 6-step pending pattern / schedule state
+#define IRQ_LOCK_PRIORITY_PWM_START		1u							// back-to-back counter enables of the staggered start
+#define IRQ_LOCK_PRIORITY_PWM_DUTY		1u							// UDIS window of the grouped CCR1..4 write
+
+_Static_assert(IRQ_LOCK_PRIORITY_TIMESTAMP >= 1u, "IRQ_LOCK_PRIORITY_TIMESTAMP must not mask the fault level");
+_Static_assert(IRQ_LOCK_PRIORITY_PROFILER >= 1u, "IRQ_LOCK_PRIORITY_PROFILER must not mask the fault level");
+_Static_assert(IRQ_LOCK_PRIORITY_TIMING_MONITOR >= 1u, "IRQ_LOCK_PRIORITY_TIMING_MONITOR must not mask the fault level");
+_Static_assert(IRQ_LOCK_PRIORITY_COMMUTATION >= 1u, "IRQ_LOCK_PRIORITY_COMMUTATION must not mask the fault level");
+_Static_assert(IRQ_LOCK_PRIORITY_PWM_START >= 1u, "IRQ_LOCK_PRIORITY_PWM_START must not mask the fault level");
+_Static_assert(IRQ_LOCK_PRIORITY_PWM_DUTY >= 1u, "IRQ_LOCK_PRIORITY_PWM_DUTY must not mask the fault level");
+_Static_assert(IRQ_PRIORITY_PWM_UPDATE > IRQ_PRIORITY_FAULT, "PWM update must stay below the fault level");
+
+#endif /* CONFIG_IRQ_PRIORITY_CONFIG_H */
@@ -0,0 +1,40 @@
+#ifndef CONFIG_LOG_MESSAGES_H
+#define CONFIG_LOG_MESSAGES_H
+
+/**
+ * @file log_messages.h
+ * @brief Deferred log message table (message ID -> level, tag, format).
+ *
+ * Single source for the firmware message IDs and the host expansion
+ * (tools/log_decode.py parses the X(...) rows of this file).
+ *
+ * Rules:
+ * - append new rows only, the row index is the message ID on the wire
+ * - one row per line, string literals without embedded quotes
+ * - at most LOG_DEFERRED_MAX_ARGS conversions, each %ld, %lu or %lx
+ */
+
+#define LOG_MESSAGE_TABLE(X) \
+	X(LOG_MSG_LOG_DROPPED,            LOG_LEVEL_WARN,  "LOG",   "dropped=%lu") \
+	X(LOG_MSG_APP_ALIGNMENT_DONE,     LOG_LEVEL_INFO,  "APP",   "alignment done offset=%lu raw=%lu") \
+	X(LOG_MSG_APP_PROFILE_PHASE,      LOG_LEVEL_INFO,  "PROF",  "phase=%ld reference_mrpm=%ld filtered_mrpm=%ld") \
+	X(LOG_MSG_MCUR_CALIBRATED,        LOG_LEVEL_INFO,  "MCUR",  "offsets=%lu,%lu,%lu") \
+	X(LOG_MSG_MFOC_FAST_LOOP_FAULT,   LOG_LEVEL_ERROR, "MFOC",  "fast loop fault angle=%lu uq=%ld") \
+	X(LOG_MSG_MCPI_CURRENT_LOOP_FAULT, LOG_LEVEL_ERROR, "MCPI", "current loop fault id_ma=%ld iq_ma=%ld") \
+	X(LOG_MSG_MSAT_GAIN_POINT,        LOG_LEVEL_INFO,  "MSAT",  "gain point speed_mrpm=%lu kp_q15=%ld ki_q15=%ld") \
+	X(LOG_MSG_MSAT_PLANT_MODEL,       LOG_LEVEL_INFO,  "MSAT",  "plant point=%lu gain_q8=%ld tau_us=%lu") \
+	X(LOG_MSG_CAL_LOADED,             LOG_LEVEL_INFO,  "CAL",   "loaded offset=%lu sequence=%lu") \
+	X(LOG_MSG_CAL_SAVED,              LOG_LEVEL_INFO,  "CAL",   "saved offset=%lu sequence=%lu") \
+	X(LOG_MSG_CAL_SAVE_FAILED,        LOG_LEVEL_WARN,  "CAL",   "save failed offset=%lu") \
+	X(LOG_MSG_ALIN_DONE,              LOG_LEVEL_INFO,  "ALIN",  "linearized p2p_counts=%lu samples=%lu offset=%lu") \
+	X(LOG_MSG_CMD_PARAMS_APPLIED,     LOG_LEVEL_INFO,  "CMD",   "params applied mode=%lu kp_q15=%ld ki_q15=%ld") \
+	X(LOG_MSG_CMD_STREAM_UNDERRUN,    LOG_LEVEL_WARN,  "CMD",   "stream underrun count=%lu") \
+	X(LOG_MSG_MLEAD_CALIBRATED,       LOG_LEVEL_INFO,  "MLEAD", "calibrated advance_counts=%lu tau_us=%lu uq_saved=%lu") \
+	X(LOG_MSG_MCOG_LEARNED,           LOG_LEVEL_INFO,  "MCOG",  "learned revolutions=%lu peak_permyriad=%lu") \
+	X(LOG_MSG_MOBS_DIVERGENCE,        LOG_LEVEL_WARN,  "MOBS",  "divergence counts=%ld speed_mrpm=%ld") \
+	X(LOG_MSG_MOBS_TAKEOVER,          LOG_LEVEL_WARN,  "MOBS",  "takeover fault=%lu detail=%lu speed_mrpm=%ld") \
+	X(LOG_MSG_TMON_LATE,              LOG_LEVEL_ERROR, "TMON",  "late run channel=%lu value_us=%lu") \
+	X(LOG_MSG_APP_IN_POSITION,        LOG_LEVEL_INFO,  "POS",   "in position axis=%lu target_counts=%ld error_counts=%ld") \
+	X(LOG_MSG_CAL_SAVE_SKIPPED,       LOG_LEVEL_WARN,  "CAL",   "save skipped offset=%lu sector full")
+
+#endif /* CONFIG_LOG_MESSAGES_H */
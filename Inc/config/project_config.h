@@ -12,31 +12,105 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "stm32f4xx.h"
+#include "config/irq_priority_config.h"
+#include "drivers/clock.h"
 #include "drivers/gpio.h"
 #include "drivers/exti.h"
 #include "drivers/adc.h"
+#include "drivers/dma.h"
+#include "drivers/tim2_trigger.h"
+#include "drivers/tim5_timebase.h"
 #include "drivers/usart2.h"
+#include "drivers/i2c1.h"
 #include "drivers/pwm_tim1.h"
 #include "drivers/systick.h"
 #include "motor/motor_6step.h"
 #include "motor/motor_driver.h"
 
+/* Clock profile (applied by clock_init() in board_init(), see CLOCK_CFG) */
+#define CLOCK_PROFILE_HSI_16MHZ			0u				// HSI direct, no PLL
+#define CLOCK_PROFILE_HSI_PLL_180MHZ	1u				// HSI -> PLL, over-drive
+#define CLOCK_PROFILE_HSE_PLL_180MHZ	2u				// 8 MHz ST-LINK MCO (HSE bypass) -> PLL, over-drive
+#define CLOCK_PROFILE					CLOCK_PROFILE_HSI_PLL_180MHZ
+
+#if (CLOCK_PROFILE == CLOCK_PROFILE_HSI_16MHZ)
 #define SYSCLK_HZ				16000000u
-#define APB1_CLK_HZ				16000000U				// Adjust based on clock configuration
+#define APB1_CLK_DIV			1u
+#define APB2_CLK_DIV			1u
+#elif (CLOCK_PROFILE == CLOCK_PROFILE_HSI_PLL_180MHZ) || (CLOCK_PROFILE == CLOCK_PROFILE_HSE_PLL_180MHZ)
+#define SYSCLK_HZ				180000000u
+#define APB1_CLK_DIV			4u						// 45 MHz (max)
+#define APB2_CLK_DIV			2u						// 90 MHz (max)
+#else
+#error "Unsupported CLOCK_PROFILE"
+#endif
+
+/* Bus and kernel clocks derived from the profile (AHB = SYSCLK) */
+#define HCLK_HZ					SYSCLK_HZ
+#define APB1_CLK_HZ				(HCLK_HZ / APB1_CLK_DIV)
+#define APB2_CLK_HZ				(HCLK_HZ / APB2_CLK_DIV)
+#define APB1_TIM_CLK_HZ			((APB1_CLK_DIV == 1u) ? APB1_CLK_HZ : (2u * APB1_CLK_HZ))
+#define APB2_TIM_CLK_HZ			((APB2_CLK_DIV == 1u) ? APB2_CLK_HZ : (2u * APB2_CLK_HZ))
+#define ADC_CLK_PRESCALER		((APB2_CLK_HZ > 72000000u) ? ADC_CLK_PCLK2_DIV4 : ADC_CLK_PCLK2_DIV2)	// ADC clock <= 36 MHz
 #define BAUDRATE				230400U
 #define SYSTICK_PERIOD_US		1000
+#define CURRENT_SENSE_SHUNT_COUNT	3u						// phase shunts on ADC2 (2: A/B, 3: A/B/C)
+
+/* TIM1 power stage: 3-PWM driver board (own dead time, MOTOR_EN) or discrete 6-PWM gate driver */
+#define PWM_OUTPUT_STAGE_3PWM			0u				// CH1..CH3 (PA8 / PA9 / PA10), e.g. SimpleFOC Mini
+#define PWM_OUTPUT_STAGE_6PWM			1u				// + CH1N..CH3N (PB13 / PB14 / PB15), TIM1 dead time
+#define PWM_OUTPUT_STAGE				PWM_OUTPUT_STAGE_3PWM
+#define PWM_DEAD_TIME_NS				500u			// 6-PWM only, rounded up to the DTG grid
+
+/* Motor axes: 2 adds a second 3-PWM stage on TIM8 CH1..CH3 (PC6 / PC7 / PC8, shared with the
+ * Hall inputs), its AS5600 analog output on ADC3_IN10 (PC0) and its enable on PB2 */
+#define MOTOR_AXIS_COUNT				1u
+
+#if (MOTOR_AXIS_COUNT != 1u) && (MOTOR_AXIS_COUNT != 2u)
+#error "MOTOR_AXIS_COUNT must be 1 or 2"
+#endif
 
+extern const clock_cfg_t CLOCK_CFG;				// System clock tree for CLOCK_PROFILE
+extern clock_handle_t CLOCK_H;
 extern const gpio_pin_cfg_t LED_OUTPUT;			// User LED (PA5)
 extern const gpio_pin_cfg_t PUSH_BUTTON;		// User Push-button (PC13)
 extern const gpio_pin_cfg_t MOTOR_EN;			// SimpleFOC Mini enable output
 extern const exti_cfg_t USER_BUTTON_EXTI;
+extern const gpio_pin_cfg_t HALL_A;				// Hall sensor inputs for 6-step commutation (PC6 / PC7 / PC8)
+extern const gpio_pin_cfg_t HALL_B;
+extern const gpio_pin_cfg_t HALL_C;
+extern const exti_cfg_t HALL_A_EXTI;			// both edges, commutation priority (EXTI9_5)
+extern const exti_cfg_t HALL_B_EXTI;
+extern const exti_cfg_t HALL_C_EXTI;
 extern const adc_cfg_t ADC1_IN0_CFG;			// Analog input (PA0)
 extern adc_handle_t ADC1_IN0_H;
+extern const adc_cfg_t CURRENT_SENSE_ADC2_CFG;	// Phase-current ADC (PA1 / PA4 / PC1)
+extern adc_handle_t CURRENT_SENSE_ADC2_H;
+extern const adc_injected_cfg_t CURRENT_SENSE_INJECTED_CFG;	// TIM1-triggered shunt sequence
+extern const dma_cfg_t ADC1_DMA_CFG;			// DMA2 Stream0 for ADC1 regular results
+extern dma_handle_t ADC1_DMA_H;
+extern const dma_cfg_t USART2_TX_DMA_CFG;		// DMA1 Stream6 for USART2 TX
+extern dma_handle_t USART2_TX_DMA_H;
+extern const dma_cfg_t I2C1_RX_DMA_CFG;		// DMA1 Stream0 for I2C1 RX (AS5600 digital angle)
+extern dma_handle_t I2C1_RX_DMA_H;
+extern const tim2_trigger_cfg_t ADC_TRIGGER_TIM2_CFG;	// TIM1 TRGO -> ADC trigger divider
+extern tim2_trigger_handle_t ADC_TRIGGER_TIM2_H;
+extern const tim5_timebase_cfg_t TIMEBASE_TIM5_CFG;	// 1 MHz free-running us timebase
+extern tim5_timebase_handle_t TIMEBASE_TIM5_H;
 extern volatile bool user_button_on;			// Flag for user-button
 extern const usart2_cfg_t USART2_CFG;			// USART2 config for PC logging (ST-LINK VCP)
 extern usart2_handle_t USART2_H;
-extern const pwm_tim1_cfg_t PWM_CFG;			// TIM1 3-channel PWM configuration
+extern const i2c1_cfg_t I2C1_CFG;				// I2C1 fast mode on PB8 (SCL) / PB9 (SDA)
+extern i2c1_handle_t I2C1_H;
+extern const pwm_tim1_cfg_t PWM_CFG;			// TIM1 3-channel PWM configuration (PWM_OUTPUT_STAGE)
 extern pwm_tim1_handle_t PWM_H;
+#if (MOTOR_AXIS_COUNT > 1u)
+extern const gpio_pin_cfg_t MOTOR2_EN;			// Second-axis driver enable output (PB2)
+extern const adc_cfg_t ADC3_IN10_CFG;			// Second-axis AS5600 analog input (PC0)
+extern adc_handle_t ADC3_IN10_H;
+extern const pwm_tim1_cfg_t PWM_TIM8_CFG;		// Second-axis TIM8 3-channel PWM configuration (3-PWM stage)
+extern pwm_tim1_handle_t PWM_TIM8_H;
+#endif
 extern const systick_cfg_t SYSTICK_CFG;
 extern systick_handle_t SYSTICK_H;
 extern const motor_6step_cfg_t MOTOR_6STEP_CFG;	// 6-step motor commutation configuration
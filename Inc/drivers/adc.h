@@ -11,15 +11,23 @@
  * - Configure ADC instance (resolution, sampling time, channel sequence length = 1)
  * - Start conversion
  * - Read last conversion result
- * - Handle EOC interrupt via adc_irq_handler() (called from ADC_IRQHandler)
+ * - Handle EOC interrupt via adc_irq_handler() with an optional per-handle EOC callback
+ * - Shared-vector dispatch: ADC1..3 raise one ADC_IRQHandler, adc_shared_irq_handler()
+ *   services every initialized handle (regular EOC and injected JEOC)
+ * - Optional timer-triggered acquisition into a circular DMA buffer
+ * - Optional timer-triggered injected sequence (1..4 channels) with one JEOC callback
  *
- * @note This driver configures a single regular channel only (no scan, no injected channels)
+ * @note This driver configures a single regular channel only; the injected
+ *       group runs beside it and preempts a regular conversion in progress.
  */
 
 #include "stm32f4xx.h"
 #include "drivers/gpio.h"
+#include "drivers/dma.h"
 
 #define ADC_CHANNEL_MAX 18U		/**< Max regular channel index (0..18) for STM32F446RE */
+#define ADC_INJECTED_CHANNEL_MAX 4U	/**< Injected sequence length (JL + 1) */
+#define ADC_INSTANCE_COUNT 3U		/**< ADC1..ADC3 share ADC_IRQHandler */
 
 /**
  * @brief identifiers for ADC conversion modes in ADC_CR2
@@ -57,6 +65,94 @@ typedef enum {
 } adc_sample_t;
 
 
+/**
+ * @brief identifiers for ADC kernel clock prescaler in ADC_CCR (ADCPRE, common to all ADCs)
+ *
+ * @note ADC clock must not exceed 36 MHz.
+ */
+typedef enum {
+	ADC_CLK_PCLK2_DIV2 = 0x00,
+	ADC_CLK_PCLK2_DIV4 = 0x01,
+	ADC_CLK_PCLK2_DIV6 = 0x02,
+	ADC_CLK_PCLK2_DIV8 = 0x03,
+} adc_clk_prescaler_t;
+
+/**
+ * @brief identifiers for regular-group external trigger sources in ADC_CR2 (EXTSEL)
+ *
+ */
+typedef enum {
+	ADC_EXT_TRIGGER_TIM1_CC1 = 0x00,  /**< TIM1 CC1 event */
+	ADC_EXT_TRIGGER_TIM1_CC2 = 0x01,  /**< TIM1 CC2 event */
+	ADC_EXT_TRIGGER_TIM1_CC3 = 0x02,  /**< TIM1 CC3 event */
+	ADC_EXT_TRIGGER_TIM2_CC2 = 0x03,  /**< TIM2 CC2 event */
+	ADC_EXT_TRIGGER_TIM2_CC3 = 0x04,  /**< TIM2 CC3 event */
+	ADC_EXT_TRIGGER_TIM2_CC4 = 0x05,  /**< TIM2 CC4 event */
+	ADC_EXT_TRIGGER_TIM2_TRGO = 0x06, /**< TIM2 TRGO event */
+	ADC_EXT_TRIGGER_TIM3_CC1 = 0x07,  /**< TIM3 CC1 event */
+	ADC_EXT_TRIGGER_TIM3_TRGO = 0x08, /**< TIM3 TRGO event */
+	ADC_EXT_TRIGGER_TIM4_CC4 = 0x09,  /**< TIM4 CC4 event */
+	ADC_EXT_TRIGGER_TIM5_CC1 = 0x0A,  /**< TIM5 CC1 event */
+	ADC_EXT_TRIGGER_TIM5_CC2 = 0x0B,  /**< TIM5 CC2 event */
+	ADC_EXT_TRIGGER_TIM5_CC3 = 0x0C,  /**< TIM5 CC3 event */
+	ADC_EXT_TRIGGER_TIM8_CC1 = 0x0D,  /**< TIM8 CC1 event */
+	ADC_EXT_TRIGGER_TIM8_TRGO = 0x0E, /**< TIM8 TRGO event */
+	ADC_EXT_TRIGGER_EXTI11 = 0x0F,    /**< EXTI line 11 */
+} adc_ext_trigger_t;
+
+/**
+ * @brief identifiers for injected-group external trigger sources in ADC_CR2 (JEXTSEL)
+ *
+ */
+typedef enum {
+	ADC_JEXT_TRIGGER_TIM1_CC4 = 0x00,  /**< TIM1 CC4 event */
+	ADC_JEXT_TRIGGER_TIM1_TRGO = 0x01, /**< TIM1 TRGO event */
+	ADC_JEXT_TRIGGER_TIM2_CC1 = 0x02,  /**< TIM2 CC1 event */
+	ADC_JEXT_TRIGGER_TIM2_TRGO = 0x03, /**< TIM2 TRGO event */
+	ADC_JEXT_TRIGGER_TIM3_CC2 = 0x04,  /**< TIM3 CC2 event */
+	ADC_JEXT_TRIGGER_TIM3_CC4 = 0x05,  /**< TIM3 CC4 event */
+	ADC_JEXT_TRIGGER_TIM4_CC1 = 0x06,  /**< TIM4 CC1 event */
+	ADC_JEXT_TRIGGER_TIM4_CC2 = 0x07,  /**< TIM4 CC2 event */
+	ADC_JEXT_TRIGGER_TIM4_CC3 = 0x08,  /**< TIM4 CC3 event */
+	ADC_JEXT_TRIGGER_TIM4_TRGO = 0x09, /**< TIM4 TRGO event */
+	ADC_JEXT_TRIGGER_TIM5_CC4 = 0x0A,  /**< TIM5 CC4 event */
+	ADC_JEXT_TRIGGER_TIM5_TRGO = 0x0B, /**< TIM5 TRGO event */
+	ADC_JEXT_TRIGGER_TIM8_CC2 = 0x0C,  /**< TIM8 CC2 event */
+	ADC_JEXT_TRIGGER_TIM8_CC3 = 0x0D,  /**< TIM8 CC3 event */
+	ADC_JEXT_TRIGGER_TIM8_CC4 = 0x0E,  /**< TIM8 CC4 event */
+	ADC_JEXT_TRIGGER_EXTI15 = 0x0F,    /**< EXTI line 15 */
+} adc_injected_trigger_t;
+
+/**
+ * @brief Injected-group callback, runs in ADC_IRQHandler after the whole sequence converted.
+ *
+ * @param callback_arg User argument.
+ * @param samples Raw results in sequence order (JDR1..).
+ * @param sample_count Number of results.
+ */
+typedef void (*adc_injected_callback_t)(void *callback_arg, const uint16_t *samples, uint8_t sample_count);
+
+/**
+ * @brief Regular-group EOC callback, runs in ADC_IRQHandler after a result was latched (adc_read() returns it).
+ *
+ * @param callback_arg User argument.
+ */
+typedef void (*adc_callback_t)(void *callback_arg);
+
+/**
+ * @brief Injected-group configuration (hardware-triggered sequence).
+ *
+ * @pre pin_cfgs must be configured as analog inputs (GPIO_MODE_ANALOG).
+ *
+ */
+typedef struct {
+	uint8_t channel_count;									// 1..ADC_INJECTED_CHANNEL_MAX
+	uint8_t channels[ADC_INJECTED_CHANNEL_MAX];				// converted in this order
+	const gpio_pin_cfg_t *pin_cfgs[ADC_INJECTED_CHANNEL_MAX];
+	adc_sample_t sample_time;
+	adc_injected_trigger_t trigger;							// rising edge
+} adc_injected_cfg_t;
+
 /**
  * @brief ADC configuration (single-channel, regular group).
  *
@@ -79,6 +175,8 @@ typedef struct {
 	const gpio_pin_cfg_t *pin_cfg;
 	// ADC resolution
 	adc_resolution_t resolution;
+	// ADC kernel clock prescaler (shared by all ADC instances)
+	adc_clk_prescaler_t clk_prescaler;
 } adc_cfg_t;
 
 /**
@@ -91,6 +189,13 @@ typedef struct {
 	volatile uint16_t last_reading;
 	volatile bool adc_data_ready;
 	const adc_cfg_t *cfg;
+	volatile uint32_t overrun_cnt;	// Overruns recovered in triggered DMA mode
+	const adc_injected_cfg_t *injected_cfg;
+	adc_injected_callback_t injected_callback;
+	void *injected_callback_arg;
+	volatile uint32_t injected_sequence_cnt;	// Completed injected sequences
+	adc_callback_t eoc_callback;			// Regular EOC callback, NULL if unused
+	void *eoc_callback_arg;
 
 } adc_handle_t;
 
@@ -119,12 +224,103 @@ void adc_start(adc_handle_t *adc_h);
  */
 bool adc_read(adc_handle_t *adc_h, uint16_t *value);
 
+/**
+ * @brief Switch to hardware-triggered conversions stored by DMA into a circular buffer.
+ *
+ * Each rising edge of the selected trigger starts one conversion; DMA moves
+ * the result into the buffer. The EOC interrupt is disabled in this mode,
+ * completed blocks are reported through the DMA half/full-transfer callbacks.
+ *
+ * @pre dma_h is initialized for peripheral-to-memory, 16-bit, circular transfers
+ *      on the DMA stream/channel mapped to this ADC instance.
+ *
+ * @param adc_h Pointer to ADC handle
+ * @param dma_h Pointer to DMA handle
+ * @param trigger External trigger source (rising edge)
+ * @param buffer Destination buffer for raw conversion results
+ * @param length Buffer length in samples
+ * @return true if applied, false if parameters invalid
+ */
+bool adc_start_dma_triggered(adc_handle_t *adc_h, dma_handle_t *dma_h, adc_ext_trigger_t trigger,
+							 volatile uint16_t *buffer, uint16_t length);
+
+/**
+ * @brief Configure the injected sequence on an initialized ADC (trigger stays off).
+ *
+ * Enables scan mode and the JEOC interrupt; the ADC interrupt line and
+ * priority come from the regular adc_init() configuration.
+ *
+ * @param adc_h Pointer to ADC handle (after adc_init())
+ * @param injected_cfg Pointer to injected-group configuration
+ * @return true if applied, false if parameters invalid
+ */
+bool adc_injected_init(adc_handle_t *adc_h, const adc_injected_cfg_t *injected_cfg);
+
+/**
+ * @brief Register the callback for completed injected sequences.
+ *
+ * @param adc_h Pointer to ADC handle
+ * @param callback Callback function (NULL to remove)
+ * @param callback_arg User argument passed to the callback
+ * @return true if applied, false if parameters invalid
+ */
+bool adc_injected_register_callback(adc_handle_t *adc_h, adc_injected_callback_t callback, void *callback_arg);
+
+/**
+ * @brief Enable / disable the external trigger of the injected sequence.
+ *
+ * @param adc_h Pointer to ADC handle
+ * @param enable true to convert on each trigger edge, false to stop
+ * @return true if applied, false if parameters invalid
+ */
+bool adc_injected_set_trigger(adc_handle_t *adc_h, bool enable);
+
+/**
+ * @brief Check whether the next injected sequence already completed (JEOC set again).
+ *
+ * Called at the end of the injected callback this flags a loop that overran
+ * its trigger period.
+ *
+ * @param adc_h Pointer to ADC handle
+ * @return true if a sequence is pending, false otherwise or if parameters invalid
+ */
+bool adc_injected_is_pending(const adc_handle_t *adc_h);
+
+/**
+ * @brief JEOC service for the injected sequence, call from ADC_IRQHandler
+ *
+ * @param adc_h Pointer to ADC handle
+ */
+void adc_injected_irq_handler(adc_handle_t *adc_h);
+
+/**
+ * @brief Register the callback for completed regular conversions (EOC interrupt).
+ *
+ * @param adc_h Pointer to ADC handle
+ * @param callback Callback function (NULL to remove)
+ * @param callback_arg User argument passed to the callback
+ * @return true if applied, false if parameters invalid
+ */
+bool adc_register_callback(adc_handle_t *adc_h, adc_callback_t callback, void *callback_arg);
+
 /**
  * @brief callback function for EOC-interrupt called by ADC_IRQHandler
  *
+ * Latches the result and dispatches the EOC callback. Only serves EOC while
+ * the EOC interrupt is enabled, so a DMA-driven instance on the shared
+ * vector is left to its DMA stream (overrun recovery still runs).
+ *
  * @param adc_h Pointer to ADC handle
  */
 void adc_irq_handler(adc_handle_t *adc_h);
 
+/**
+ * @brief Shared ADC_IRQHandler body: service every handle passed to adc_init().
+ *
+ * Runs adc_irq_handler() and adc_injected_irq_handler() for ADC1, ADC2 and
+ * ADC3 in instance order; instances without a handle are skipped.
+ */
+void adc_shared_irq_handler(void);
+
 
 #endif /* DRIVERS_ADC_H */
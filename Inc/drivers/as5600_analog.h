@@ -13,14 +13,49 @@
  * - first completed window: wrap-safe average bootstrap
  * - later windows: continuity-gated corrected-delta average
  * - fallback when no sample passes gate: nearest real sample
+ *
+ * Publish window (raw samples per published angle):
+ * - starts at raw_samples_per_publish, as5600_analog_set_publish_window()
+ *   changes it at run time up to AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES
+ *   (more averaging at low speed, less lag at high speed)
+ * - a new length takes effect at the next window start; the continuity gate
+ *   scales with the publish interval, so it keeps one maximum plausible speed
+ * - each published sample reports its interval to the previous one
+ *   (window-center distance) for the speed feedback
+ * - timer DMA mode: multiples of raw_samples_per_publish only (one DMA
+ *   buffer half per raw_samples_per_publish samples)
+ *
+ * Acquisition modes:
+ * - software: SysTick-scheduled SWSTART, one ADC EOC interrupt per raw sample
+ *   (the handle registers the EOC callback of its ADC, one handle per ADC)
+ * - timer DMA: timer-triggered conversions into a circular DMA buffer, one
+ *   half/full-transfer interrupt per publish window
+ *
+ * Publication (lock-free, no IRQ masking):
+ * - the ISR writes the inactive slot of a double buffer, then advances the
+ *   publish sequence; slot (sequence & 1) always holds the latest sample
+ * - readers copy that slot and retry only if the sequence moved by two or
+ *   more meanwhile, so a higher-priority reader (PWM fast loop) never waits
+ * - each sample carries its capture timestamp (publish-window center)
+ * - an optional publish callback runs in the publishing context right after
+ *   the sequence advanced (wakes an event-driven consumer)
+ *
+ * Linearization (optional):
+ * - a periodic correction table over one turn, equidistant points, applied
+ *   to every raw sample after the linear ADC mapping and the direction sign
+ * - linear interpolation between points, power-of-two point count so the
+ *   lookup is one shift and one multiply in the ADC / DMA interrupt
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 #include "drivers/adc.h"
+#include "drivers/systick.h"
 
 #define AS5600_ANALOG_MECHANICAL_ANGLE_MAX_U16  65535u
 #define AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES 16u
+#define AS5600_ANALOG_PUBLISH_READ_RETRIES      3u
+#define AS5600_ANALOG_LINEARIZATION_MAX_POINTS  32u
 
 /**
  * @brief AS5600 analog mechanical-angle direction.
@@ -31,6 +66,15 @@ typedef enum {
 	AS5600_ANALOG_DIRECTION_REVERSE = -1,
 } as5600_analog_direction_t;
 
+/**
+ * @brief AS5600 analog raw-sample acquisition mode.
+ *
+ */
+typedef enum {
+	AS5600_ANALOG_ACQUISITION_SOFTWARE = 0,	/**< SWSTART from as5600_analog_service(), EOC interrupt per sample */
+	AS5600_ANALOG_ACQUISITION_TIMER_DMA = 1,	/**< External trigger, DMA half/full transfer per publish window */
+} as5600_analog_acquisition_t;
+
 /**
  * @brief AS5600 analog configuration.
  *
@@ -39,10 +83,14 @@ typedef struct {
 	adc_handle_t *adc_h;
 	uint16_t adc_full_scale;
 	uint32_t raw_sample_period_us;      /* Time between raw ADC start requests from SysTick. */
-	uint16_t raw_samples_per_publish;   /* Publish one angle after this many raw samples. */
+	uint32_t raw_sample_phase_us;       /* Software mode: first slot delay, < raw_sample_period_us (staggers several sensors). */
+	uint16_t raw_samples_per_publish;   /* Initial publish window; timer DMA: buffer-half size. */
 	uint16_t wrap_correction_threshold_counts; /* Threshold used for one wrap correction in corrected-delta conversion. */
-	uint16_t max_plausible_delta_per_publish_counts; /* Continuity-gate threshold in corrected-delta domain. */
+	uint16_t max_plausible_delta_per_publish_counts; /* Continuity-gate threshold at the initial window. */
 	as5600_analog_direction_t mechanical_angle_direction;
+	as5600_analog_acquisition_t acquisition_mode;
+	dma_handle_t *dma_h;                /* Timer DMA mode only: initialized ADC DMA stream. */
+	adc_ext_trigger_t adc_trigger;      /* Timer DMA mode only: ADC external trigger source. */
 } as5600_analog_cfg_t;
 
 /**
@@ -51,8 +99,15 @@ typedef struct {
  */
 typedef struct {
 	uint16_t mechanical_angle_u16;
+	uint64_t capture_timestamp_us;      /* Effective sample instant: center of the publish window. */
+	uint32_t sequence;                  /* Publish counter, 0 is never published. */
+	uint32_t sample_period_us;          /* Nominal capture interval to the previous publish. */
+	uint32_t dropped_publish_count;     /* Publishes overwritten before the main loop consumed them. */
 } as5600_analog_published_sample_t;
 
+// function pointer for the publish callback (publishing ISR: ADC EOC or DMA half/full transfer)
+typedef void (*as5600_analog_callback_t)(void *callback_arg);
+
 /**
  * @brief AS5600 analog runtime handle.
  *
@@ -60,21 +115,46 @@ typedef struct {
 typedef struct {
 	const as5600_analog_cfg_t *cfg;
 	volatile uint16_t raw_sample_count; /* Number of raw ADC codes in the current publish window. */
+	volatile uint16_t requested_publish_window_samples; /* Applied at the next window start. */
+	uint16_t publish_window_samples;    /* Active window length (ISR). */
+	uint16_t previous_publish_window_samples;
+	uint16_t plausible_delta_counts;    /* Continuity gate of the active publish interval. */
+	uint32_t publish_interval_us;       /* Previous -> active window center. */
 	volatile uint16_t window_reference_mechanical_angle_u16; /* First angle sample in the current publish window. */
-	/* Ordered angle samples of the active publish window. */
-	volatile uint16_t window_angle_samples_u16[AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES];
 	volatile int32_t window_delta_sum_counts; /* Sum of wrapped signed deltas relative to the window reference. */
-	volatile uint16_t mechanical_angle_u16;
-	volatile bool has_published_angle;
+	/* Running continuity statistics against the last published angle (one update per sample). */
+	volatile int32_t window_retained_delta_sum_counts; /* Sum of gated corrected deltas. */
+	volatile uint16_t window_retained_sample_count;
+	volatile uint16_t window_nearest_mechanical_angle_u16; /* Fallback: smallest corrected delta so far. */
+	volatile int32_t window_nearest_abs_delta_counts;
+	volatile uint16_t mechanical_angle_u16; /* Last published angle, continuity anchor of the publish path. */
+	uint32_t window_center_offset_us;   /* Last raw sample -> window center, subtracted from the publish time. */
 	uint64_t next_raw_sample_time_us;
 	volatile bool raw_conversion_pending;
-	volatile bool has_new_angle_sample; /* True when one published angle sample is ready for the main loop. */
+	uint32_t stale_conversion_count;    /* Pending conversions cleared by the stale timeout (main loop). */
+	/* Double-buffered publication, written by the ISR only. */
+	volatile as5600_analog_published_sample_t published_slots[2];
+	volatile uint32_t publish_sequence;
+	/* Consumer state, main loop only. */
+	uint32_t consumed_sequence;
+	uint32_t dropped_publish_count;
+	as5600_analog_callback_t publish_callback;  /* NULL if unused. */
+	void *publish_callback_arg;
+	/* Timer DMA mode: two publish windows, DMA half/full transfer hands over one window each. */
+	volatile uint16_t dma_raw_samples[2u * AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES];
+	/* Angle correction at point k * 65536 / point_count, written by the main loop only. */
+	int16_t linearization_counts[AS5600_ANALOG_LINEARIZATION_MAX_POINTS];
+	uint8_t linearization_shift;        /* 16 - log2(point_count). */
+	volatile uint8_t linearization_point_count; /* 0 = linear mapping only; written last. */
 	bool is_initialized;
 } as5600_analog_handle_t;
 
 /**
  * @brief Initialize AS5600 analog handle.
  *
+ * In timer DMA mode this also arms the ADC external trigger and the circular
+ * DMA transfer; conversions start once the trigger timer runs.
+ *
  * @param as5600_analog_h Pointer to AS5600 analog handle.
  * @param as5600_analog_cfg Pointer to AS5600 analog configuration.
  * @return true if initialization succeeded, false otherwise.
@@ -82,11 +162,25 @@ typedef struct {
 bool as5600_analog_init(as5600_analog_handle_t *as5600_analog_h,
 						const as5600_analog_cfg_t *as5600_analog_cfg);
 
+/**
+ * @brief Assign the callback dispatched after each published sample.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle (initialized).
+ * @param callback Callback (NULL removes the callback).
+ * @param callback_arg Callback argument.
+ * @return true if applied, false if parameters invalid.
+ */
+bool as5600_analog_register_publish_callback(as5600_analog_handle_t *as5600_analog_h,
+											 as5600_analog_callback_t callback,
+											 void *callback_arg);
+
 /**
  * @brief Service SysTick-based raw ADC conversion scheduling.
  *
  * This function only checks when the next raw conversion should start.
- * The ADC IRQ path still handles completed conversions.
+ * The ADC EOC callback registered by init handles completed conversions.
+ * In timer DMA mode the hardware trigger owns scheduling and this call only
+ * validates the handle.
  *
  * @param as5600_analog_h Pointer to AS5600 analog handle.
  * @param now_us Current time in microseconds.
@@ -98,8 +192,9 @@ bool as5600_analog_service(as5600_analog_handle_t *as5600_analog_h,
 /**
  * @brief Consume one published angle sample.
  *
- * This function returns the latest published sample once and then clears
- * the ready flag.
+ * This function returns the latest published sample once; a sample is new
+ * when its sequence differs from the last consumed one. Publishes skipped in
+ * between are added to dropped_publish_count. Interrupts stay enabled.
  *
  * @param as5600_analog_h Pointer to AS5600 analog handle.
  * @param published_sample Pointer to one published sample.
@@ -109,11 +204,56 @@ bool as5600_analog_consume_published_sample(as5600_analog_handle_t *as5600_analo
 											as5600_analog_published_sample_t *published_sample);
 
 /**
- * @brief Consume one completed ADC sample for the active AS5600 analog handle.
+ * @brief Read the latest published angle sample without consuming it.
+ *
+ * Intended for the PWM-synchronous fast loop, which runs at a higher rate
+ * than the publish cadence. The consume state of the main loop is left
+ * untouched. Safe to call from an ISR that preempts the publishing ISR.
  *
- * Call this from the ADC IRQ path after adc_irq_handler() updates the ADC
- * driver state.
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param published_sample Pointer to one published sample.
+ * @return true if at least one angle has been published, false otherwise.
+ */
+bool as5600_analog_get_latest_published_sample(const as5600_analog_handle_t *as5600_analog_h,
+											   as5600_analog_published_sample_t *published_sample);
+
+/**
+ * @brief Request a new publish window length (raw samples per published angle).
+ *
+ * Safe to call at any time from the main loop; the ISR switches at the next
+ * window start, so every published angle averages one complete window.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param raw_samples 1..AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES, timer DMA mode:
+ *        a multiple of raw_samples_per_publish.
+ * @return true if the request was accepted, false otherwise.
+ */
+bool as5600_analog_set_publish_window(as5600_analog_handle_t *as5600_analog_h,
+									  uint16_t raw_samples);
+
+/**
+ * @brief Install or clear the angle linearization table.
+ *
+ * The table is disabled while it is copied, so the interrupt path never sees
+ * a half-written table; raw samples in between use the linear mapping only.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param correction_counts Correction per point in full-turn counts (corrected = angle + correction).
+ * @param point_count Power of two 2..AS5600_ANALOG_LINEARIZATION_MAX_POINTS, 0 clears the table.
+ * @return true if the table was accepted, false otherwise.
+ */
+bool as5600_analog_set_linearization(as5600_analog_handle_t *as5600_analog_h,
+									 const int16_t *correction_counts,
+									 uint8_t point_count);
+
+/**
+ * @brief Apply the installed linearization to one angle.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param mechanical_angle_u16 Angle from the linear mapping.
+ * @return Corrected angle, the input angle if no table is installed.
  */
-void as5600_analog_adc_irq_handler(void);
+uint16_t as5600_analog_linearize_angle_u16(const as5600_analog_handle_t *as5600_analog_h,
+										   uint16_t mechanical_angle_u16);
 
 #endif /* DRIVERS_AS5600_ANALOG_H */
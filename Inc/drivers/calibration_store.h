@@ -0,0 +1,149 @@
+#ifndef DRIVERS_CALIBRATION_STORE_H
+#define DRIVERS_CALIBRATION_STORE_H
+/**
+ * @file calibration_store.h
+ * @brief Wear-levelled calibration record log in one dedicated FLASH sector.
+ *
+ * Responsibilities:
+ * - keep calibration records append-only in fixed-size slots of one sector
+ * - validate records by magic, version, size and CRC-32
+ * - return the newest valid record (highest sequence number)
+ * - erase the sector only when every slot was used (wear levelling)
+ *
+ * Layout: slot k at base + k * CALIBRATION_STORE_SLOT_SIZE; a slot whose first
+ * word is 0xFFFFFFFF is blank and ends the used part of the sector.
+ *
+ * @note The sector comes from the linker script (.calibration region), so the
+ *       application image never overlaps it and reflashing keeps the record.
+ * @note A torn write (reset while programming) leaves one slot with a bad CRC,
+ *       it is skipped and the previous record stays valid.
+ * @note Power loss during the rare full-sector erase loses the stored record;
+ *       the application then falls back to its alignment procedure.
+ * @note The sector erase stalls FLASH reads for about 1 s (128 KB sector), the
+ *       caller runs it only with the power stage off (calibration_store_reserve()).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CALIBRATION_STORE_MAGIC                  0x314C4143u   /* "CAL1" little-endian */
+#define CALIBRATION_STORE_VERSION                3u
+#define CALIBRATION_STORE_SLOT_SIZE              256u
+#define CALIBRATION_STORE_LINEARIZATION_POINTS   32u
+#define CALIBRATION_STORE_COGGING_POINTS         64u
+
+/**
+ * @brief Calibration payload.
+ *
+ */
+typedef struct {
+	uint16_t electrical_offset_u16;          /* Commanded - raw electrical angle at alignment. */
+	int8_t sensor_direction;                 /* Build direction the offset belongs to (+1 / -1). */
+	int8_t phase_sequence_sign;              /* Build phase sequence the offset belongs to (+1 / -1). */
+	uint8_t pole_pairs;
+	uint8_t linearization_point_count;       /* 0 = no sensor linearization stored. */
+	uint16_t alignment_mechanical_angle_u16; /* Sensor angle the offset was measured at. */
+	int16_t linearization_counts[CALIBRATION_STORE_LINEARIZATION_POINTS]; /* Sensor correction per equidistant angle. */
+	uint8_t cogging_point_count;             /* 0 = no cogging table stored. */
+	uint8_t reserved;
+	int16_t cogging_uq_permyriad[CALIBRATION_STORE_COGGING_POINTS]; /* Uq feedforward per equidistant mechanical angle. */
+} calibration_data_t;
+
+/**
+ * @brief One stored record (CRC-32 over all fields before crc32).
+ *
+ */
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t data_size;
+	uint32_t sequence;
+	calibration_data_t data;
+	uint32_t crc32;
+} calibration_record_t;
+
+_Static_assert((sizeof(calibration_record_t) <= CALIBRATION_STORE_SLOT_SIZE) &&
+			   ((sizeof(calibration_record_t) % 4u) == 0u), "calibration record must fit one word-aligned slot");
+
+/**
+ * @brief Calibration store configuration.
+ *
+ */
+typedef struct {
+	uint32_t base_address;                   /* Sector start (linker _scalibration). */
+	uint32_t size_bytes;                     /* Sector size (linker _ecalibration - _scalibration). */
+	uint8_t sector;                          /* FLASH sector number of base_address. */
+} calibration_store_cfg_t;
+
+/**
+ * @brief Calibration store runtime handle.
+ *
+ */
+typedef struct {
+	const calibration_store_cfg_t *cfg;
+	uint32_t slot_count;
+	uint32_t next_slot;                      /* First blank slot, slot_count when full. */
+	uint32_t latest_slot;                    /* Valid only if has_record. */
+	uint32_t latest_sequence;
+	bool has_record;
+	bool is_initialized;
+} calibration_store_handle_t;
+
+/**
+ * @brief Initialize the store and scan the sector for the newest valid record.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @param calibration_store_cfg Pointer to calibration store configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool calibration_store_init(calibration_store_handle_t *calibration_store_h,
+							const calibration_store_cfg_t *calibration_store_cfg);
+
+/**
+ * @brief Copy the newest valid record.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @param data Output calibration payload.
+ * @return true if a valid record exists, false otherwise.
+ */
+bool calibration_store_load(const calibration_store_handle_t *calibration_store_h, calibration_data_t *data);
+
+/**
+ * @brief Append one record (skipped if identical to the newest one).
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @param data Calibration payload to store.
+ * @return true if the record is stored and verified, false otherwise.
+ */
+bool calibration_store_save(calibration_store_handle_t *calibration_store_h, const calibration_data_t *data);
+
+/**
+ * @brief Number of blank slots left before a save needs the sector erase.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @return Free slot count, 0 if not initialized.
+ */
+uint32_t calibration_store_get_free_slot_count(const calibration_store_handle_t *calibration_store_h);
+
+/**
+ * @brief Erase the sector ahead of time if fewer than min_free_slots are blank.
+ *
+ * The newest record is copied to RAM and written back as the first slot, so
+ * the stored calibration survives (except on power loss during the erase).
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @param min_free_slots Blank slots the caller needs until its next reserve.
+ * @return true if at least min_free_slots are blank afterwards, false otherwise.
+ */
+bool calibration_store_reserve(calibration_store_handle_t *calibration_store_h, uint32_t min_free_slots);
+
+/**
+ * @brief Erase the sector, the next boot runs the full calibration again.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @return true if erased, false otherwise.
+ */
+bool calibration_store_erase(calibration_store_handle_t *calibration_store_h);
+
+#endif /* DRIVERS_CALIBRATION_STORE_H */
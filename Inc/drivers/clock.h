@@ -0,0 +1,86 @@
+#ifndef DRIVERS_CLOCK_H
+#define DRIVERS_CLOCK_H
+/**
+ * @file clock.h
+ * @brief Minimal system clock-tree driver for STM32F446 (CMSIS only).
+ *
+ * Responsibilities:
+ * - Select HSI or HSE (crystal or bypass) as clock source, optionally through the main PLL
+ * - Set regulator voltage scaling and over-drive for frequencies above 168 MHz
+ * - Set FLASH wait states and the ART accelerator (prefetch, I-cache, D-cache)
+ * - Set AHB/APB1/APB2 prescalers and report the derived bus and timer clocks
+ *
+ * @note Must run once before any peripheral init: driver cfgs take their clocks from
+ *       the same profile (project_config.h), so a failed init leaves them inconsistent.
+ * @note PLLR/PLLSAI/I2S clocks are left at reset values.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+#define CLOCK_HSI_HZ			16000000u
+#define CLOCK_SYSCLK_MAX_HZ		180000000u
+#define CLOCK_APB1_MAX_HZ		45000000u
+#define CLOCK_APB2_MAX_HZ		90000000u
+
+/**
+ * @brief identifiers for clock source (PLL input or SYSCLK when the PLL is unused)
+ *
+ */
+typedef enum {
+	CLOCK_SOURCE_HSI = 0x00,		/**< internal 16 MHz RC */
+	CLOCK_SOURCE_HSE = 0x01,		/**< external crystal */
+	CLOCK_SOURCE_HSE_BYPASS = 0x02,	/**< external clock on OSC_IN (e.g. ST-LINK MCO 8 MHz) */
+} clock_source_t;
+
+/**
+ * @brief Clock-tree configuration.
+ *
+ * SYSCLK = source_hz / pll_m * pll_n / pll_p (or source_hz without PLL).
+ *
+ */
+typedef struct {
+	clock_source_t source;
+	uint32_t hse_hz;				// HSE frequency, ignored for HSI
+	bool use_pll;
+	uint8_t pll_m;					// 2..63, VCO input 1..2 MHz (2 MHz recommended)
+	uint16_t pll_n;					// 50..432, VCO output 100..432 MHz
+	uint8_t pll_p;					// 2, 4, 6, 8
+	uint8_t pll_q;					// 2..15
+	uint16_t ahb_div;				// 1, 2, 4, 8, 16, 64, 128, 256, 512
+	uint8_t apb1_div;				// 1, 2, 4, 8, 16
+	uint8_t apb2_div;				// 1, 2, 4, 8, 16
+	uint8_t voltage_scale;			// regulator scale 1..3 (1 = highest frequency)
+	bool overdrive;					// required above 168 MHz
+	uint8_t flash_latency;			// wait states 0..15
+	bool art_enable;				// prefetch + instruction/data caches
+} clock_cfg_t;
+
+/**
+ * @brief Handle with the derived clocks of the applied configuration.
+ *
+ */
+typedef struct {
+	const clock_cfg_t *cfg;
+	uint32_t sysclk_hz;
+	uint32_t hclk_hz;
+	uint32_t pclk1_hz;
+	uint32_t pclk2_hz;
+	uint32_t tim_apb1_hz;			// APB1 timer kernel clock (x2 if apb1_div > 1)
+	uint32_t tim_apb2_hz;			// APB2 timer kernel clock (x2 if apb2_div > 1)
+	bool is_initialized;
+} clock_handle_t;
+
+/**
+ * @brief Apply the clock configuration and switch SYSCLK.
+ *
+ * @param clock_h Pointer to clock handle.
+ * @param clock_cfg Pointer to clock configuration.
+ * @return true if applied, false if parameters invalid or an oscillator/PLL/over-drive
+ *         did not become ready (SYSCLK then stays on HSI).
+ */
+bool clock_init(clock_handle_t *clock_h, const clock_cfg_t *clock_cfg);
+
+#endif /* DRIVERS_CLOCK_H */
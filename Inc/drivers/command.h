@@ -0,0 +1,135 @@
+#ifndef DRIVERS_COMMAND_H
+#define DRIVERS_COMMAND_H
+
+/**
+ * @file command.h
+ * @brief Binary command frames from the USART2 RX ring buffer.
+ *
+ * Counterpart of telemetry.h on the receive path: bytes are pulled from the
+ * RX ring, framed and CRC-checked without stdio. Only complete, valid frames
+ * are handed to the application; a bad length or CRC drops the candidate and
+ * resynchronizes on the next sync byte.
+ *
+ * Frame layout (little-endian):
+ * [0]      sync byte (COMMAND_FRAME_SYNC)
+ * [1]      command type
+ * [2]      sequence number (echoed in the acknowledgement)
+ * [3]      payload length (0..COMMAND_FRAME_MAX_PAYLOAD)
+ * [4..n-3] payload
+ * [n-2..]  CRC-16/CCITT-FALSE over bytes [1..n-3]
+ *
+ * @note Command types and payload layouts are defined by the application and
+ *       must match the host encoder (tools/command_send.py).
+ * @note Intended for main/application context, not ISR context.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "drivers/usart2.h"
+
+#define COMMAND_FRAME_SYNC              0x5Au
+#define COMMAND_FRAME_HEADER_SIZE       4u
+#define COMMAND_FRAME_CRC_SIZE          2u
+#define COMMAND_FRAME_MAX_PAYLOAD       64u
+#define COMMAND_FRAME_MAX_SIZE          (COMMAND_FRAME_HEADER_SIZE + COMMAND_FRAME_MAX_PAYLOAD + COMMAND_FRAME_CRC_SIZE)
+#define COMMAND_RX_CHUNK_SIZE           32u
+
+/**
+ * @brief Command configuration.
+ *
+ */
+typedef struct {
+	usart2_handle_t *usart_h;
+} command_cfg_t;
+
+/**
+ * @brief One received command frame.
+ *
+ */
+typedef struct {
+	uint8_t type;
+	uint8_t sequence;
+	uint8_t payload_length;
+	uint8_t payload[COMMAND_FRAME_MAX_PAYLOAD];
+} command_frame_t;
+
+/**
+ * @brief Command runtime handle.
+ *
+ */
+typedef struct {
+	const command_cfg_t *cfg;
+	uint8_t bytes[COMMAND_FRAME_MAX_SIZE];   /* Frame candidate, starts with the sync byte. */
+	uint16_t length;                         /* Candidate bytes collected so far. */
+	uint8_t chunk[COMMAND_RX_CHUNK_SIZE];    /* Bytes read from the RX ring, not yet framed. */
+	uint8_t chunk_length;
+	uint8_t chunk_index;
+	uint32_t frames_received;
+	uint32_t crc_error_cnt;
+	uint32_t length_error_cnt;               /* Payload length above COMMAND_FRAME_MAX_PAYLOAD. */
+	bool is_initialized;
+} command_handle_t;
+
+/**
+ * @brief Initialize command handle.
+ *
+ * @param command_h Pointer to command handle.
+ * @param command_cfg Pointer to command configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool command_init(command_handle_t *command_h, const command_cfg_t *command_cfg);
+
+/**
+ * @brief Frame the received bytes until one valid command is complete.
+ *
+ * Returns at the first complete frame; remaining bytes stay buffered for the
+ * next call. Call until it returns false to drain the RX ring.
+ *
+ * @param command_h Pointer to command handle.
+ * @param frame Output frame.
+ * @return true if one valid frame was decoded, false if no complete frame is available.
+ */
+bool command_poll(command_handle_t *command_h, command_frame_t *frame);
+
+/**
+ * @brief Read one unsigned 8-bit payload field.
+ *
+ * @param frame Pointer to received frame.
+ * @param offset Payload byte offset.
+ * @param value Output value.
+ * @return true if the field lies inside the payload, false otherwise.
+ */
+bool command_frame_get_u8(const command_frame_t *frame, uint8_t offset, uint8_t *value);
+
+/**
+ * @brief Read one unsigned 16-bit payload field.
+ *
+ * @param frame Pointer to received frame.
+ * @param offset Payload byte offset.
+ * @param value Output value.
+ * @return true if the field lies inside the payload, false otherwise.
+ */
+bool command_frame_get_u16(const command_frame_t *frame, uint8_t offset, uint16_t *value);
+
+/**
+ * @brief Read one unsigned 32-bit payload field.
+ *
+ * @param frame Pointer to received frame.
+ * @param offset Payload byte offset.
+ * @param value Output value.
+ * @return true if the field lies inside the payload, false otherwise.
+ */
+bool command_frame_get_u32(const command_frame_t *frame, uint8_t offset, uint32_t *value);
+
+/**
+ * @brief Read one signed 32-bit payload field.
+ *
+ * @param frame Pointer to received frame.
+ * @param offset Payload byte offset.
+ * @param value Output value.
+ * @return true if the field lies inside the payload, false otherwise.
+ */
+bool command_frame_get_i32(const command_frame_t *frame, uint8_t offset, int32_t *value);
+
+#endif /* DRIVERS_COMMAND_H */
@@ -0,0 +1,150 @@
+#ifndef DRIVERS_DMA_H
+#define DRIVERS_DMA_H
+/**
+ * @file dma.h
+ * @brief Minimal DMA stream driver for STM32F4 (CMSIS only).
+ *
+ * Supports one peripheral <-> memory transfer per stream in direct mode
+ * (no FIFO, no double-buffer, no burst).
+ *
+ * Responsibilities:
+ * - Configure one DMA stream (channel, direction, data size, circular mode)
+ * - Start / stop transfers
+ * - Dispatch half-transfer and transfer-complete callbacks via dma_irq_handler()
+ *   (called from DMAx_Streamy_IRQHandler)
+ *
+ * @note Transfer errors are counted in the handle; the stream is disabled by hardware and
+ *       the optional error callback lets the owner release or restart the transfer.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+#define DMA_STREAM_INDEX_MAX	7U		/**< Streams 0..7 per DMA controller */
+#define DMA_CHANNEL_MAX			7U		/**< Channel request selection 0..7 */
+
+// function pointer for DMA transfer callbacks (called from the stream IRQ handler)
+typedef void (*dma_callback_t)(void *callback_arg);
+
+/**
+ * @brief identifiers for DMA transfer direction in DMA_SxCR
+ *
+ */
+typedef enum {
+	DMA_DIR_PERIPH_TO_MEM = 0x00,	/**< Peripheral-to-memory */
+	DMA_DIR_MEM_TO_PERIPH = 0x01,	/**< Memory-to-peripheral */
+} dma_direction_t;
+
+/**
+ * @brief identifiers for DMA data size (same size on peripheral and memory side)
+ *
+ */
+typedef enum {
+	DMA_DATA_SIZE_8_BIT = 0x00,		/**< byte */
+	DMA_DATA_SIZE_16_BIT = 0x01,	/**< half-word */
+	DMA_DATA_SIZE_32_BIT = 0x02,	/**< word */
+} dma_data_size_t;
+
+/**
+ * @brief DMA stream configuration.
+ *
+ */
+typedef struct {
+	DMA_TypeDef *inst;				// DMA1, DMA2
+	DMA_Stream_TypeDef *stream;		// DMAx_Stream0..7, must belong to inst
+	uint8_t stream_index;			// 0..7, selects the LISR/HISR flag group
+	uint8_t channel;				// request channel (CHSEL)
+	dma_direction_t direction;
+	dma_data_size_t data_size;
+	bool memory_increment;
+	bool circular;
+	uint8_t stream_priority;		// 0 (low) .. 3 (very high)
+	// Interrupt handle
+	IRQn_Type irqn;
+	// Interrupt priority
+	uint8_t irq_priority;
+} dma_cfg_t;
+
+/**
+ * @brief Handle for one DMA stream.
+ *
+ */
+typedef struct {
+	const dma_cfg_t *cfg;
+	dma_callback_t half_transfer_callback;		// NULL disables the half-transfer interrupt
+	dma_callback_t transfer_complete_callback;	// NULL disables the transfer-complete interrupt
+	dma_callback_t transfer_error_callback;		// NULL: errors are only counted
+	void *callback_arg;
+	volatile uint32_t transfer_error_cnt;
+	bool is_initialized;
+} dma_handle_t;
+
+/**
+ * @brief Configure one DMA stream according to the given configuration.
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @param dma_cfg Pointer to DMA configuration.
+ * @return true if applied, false if parameters invalid.
+ */
+bool dma_init(dma_handle_t *dma_h, const dma_cfg_t *dma_cfg);
+
+/**
+ * @brief Assign the transfer callbacks of one stream.
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @param half_transfer_callbk Half-transfer callback (NULL if unused).
+ * @param transfer_complete_callbk Transfer-complete callback (NULL if unused).
+ * @param callbk_arg a Pointer to callback_arguments.
+ * @return true if applied, false if parameters invalid.
+ */
+bool dma_register_callbacks(dma_handle_t *dma_h,
+							dma_callback_t half_transfer_callbk,
+							dma_callback_t transfer_complete_callbk,
+							void *callbk_arg);
+
+/**
+ * @brief Assign the transfer-error callback of one stream (same callback argument).
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @param transfer_error_callbk Transfer-error callback (NULL: count only).
+ * @return true if applied, false if parameters invalid.
+ */
+bool dma_register_error_callback(dma_handle_t *dma_h, dma_callback_t transfer_error_callbk);
+
+/**
+ * @brief Start one transfer (or a circular sequence) on the stream.
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @param periph_addr Peripheral data register address.
+ * @param mem_addr Memory buffer address.
+ * @param count Number of data items (1..65535).
+ * @return true if started, false if parameters invalid or the stream is still busy.
+ */
+bool dma_start(dma_handle_t *dma_h, uint32_t periph_addr, const volatile void *mem_addr, uint16_t count);
+
+/**
+ * @brief Stop the stream and clear its flags.
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @return true if applied, false if parameters invalid.
+ */
+bool dma_stop(dma_handle_t *dma_h);
+
+/**
+ * @brief check if the stream is still enabled (transfer in progress).
+ *
+ * @param dma_h Pointer to DMA handle.
+ * @return true if busy, false otherwise.
+ */
+bool dma_is_busy(const dma_handle_t *dma_h);
+
+/**
+ * @brief callback function for stream interrupts called by DMAx_Streamy_IRQHandler
+ *
+ * @param dma_h Pointer to DMA handle.
+ */
+void dma_irq_handler(dma_handle_t *dma_h);
+
+#endif /* DRIVERS_DMA_H */
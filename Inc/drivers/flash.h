@@ -0,0 +1,45 @@
+#ifndef DRIVERS_FLASH_H
+#define DRIVERS_FLASH_H
+/**
+ * @file flash.h
+ * @brief Minimal internal FLASH erase/program driver for STM32F446 (CMSIS only).
+ *
+ * Responsibilities:
+ * - Unlock / lock the FLASH control register
+ * - Erase one sector
+ * - Program 32-bit words (PSIZE x32, needs VDD 2.7 V .. 3.6 V)
+ * - Map error flags of a finished operation to a failed return
+ *
+ * @note The bank is single: instruction fetches from FLASH stall while an
+ *       operation runs (erase of a 128 KB sector: about 1 s, up to 2 s).
+ *       Interrupts are delayed, not lost; call only while the control loop
+ *       does not depend on them.
+ * @note Programming can only clear bits; program erased (0xFFFFFFFF) words only.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+#define FLASH_SECTOR_COUNT      8u
+
+/**
+ * @brief Erase one FLASH sector (unlocks and locks around the operation).
+ *
+ * @param sector Sector number 0..FLASH_SECTOR_COUNT-1.
+ * @return true if the erase completed without error flags, false otherwise.
+ */
+bool flash_erase_sector(uint8_t sector);
+
+/**
+ * @brief Program a word-aligned block (unlocks and locks around the operation).
+ *
+ * @param address Destination, 4-byte aligned, inside main FLASH.
+ * @param data Source words.
+ * @param word_count Number of 32-bit words.
+ * @return true if every word programmed and reads back, false otherwise.
+ */
+bool flash_program_words(uint32_t address, const uint32_t *data, size_t word_count);
+
+#endif /* DRIVERS_FLASH_H */
@@ -0,0 +1,169 @@
+#ifndef DRIVERS_I2C1_H
+#define DRIVERS_I2C1_H
+/**
+ * @file i2c1.h
+ * @brief Interrupt/DMA-driven I2C1 master for STM32F4 (CMSIS only).
+ *
+ * One register transaction at a time, never blocking the caller:
+ * - register read: START, address+W, register, repeated START, address+R,
+ *   data bytes by DMA (LAST bit NACKs the final byte), STOP
+ * - register write: START, address+W, register, data bytes, STOP
+ *
+ * Responsibilities:
+ * - Configure I2C1 timing (standard / fast mode) and the SCL/SDA pins
+ * - Run the transaction state machine in the event interrupt
+ * - Hand the read data phase to one DMA stream (I2C1_RX)
+ * - Report completion or failure through one callback (interrupt context)
+ * - Count NACK, bus error and arbitration-lost events
+ *
+ * @note Reads need at least 2 data bytes (DMA + LAST mode of the F4 I2C).
+ * @note A transaction that never completes (stuck bus) is left to the caller's
+ *       timeout, which calls i2c1_abort() to reset the peripheral.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "drivers/gpio.h"
+#include "drivers/dma.h"
+
+#define I2C1_MAX_WRITE_BYTES        2u
+
+// function pointer for transaction completion (called from the I2C1 or DMA interrupt)
+typedef void (*i2c1_callback_t)(void *callback_arg, bool success);
+
+/**
+ * @brief I2C1 transaction state.
+ *
+ */
+typedef enum {
+	I2C1_STATE_IDLE = 0,
+	I2C1_STATE_ADDRESS_WRITE,       /**< START sent, waiting for SB to send address+W */
+	I2C1_STATE_REGISTER,            /**< address+W sent, waiting for ADDR to send the register */
+	I2C1_STATE_TRANSMIT,            /**< register / data byte in flight, waiting for BTF */
+	I2C1_STATE_ADDRESS_READ,        /**< repeated START sent, waiting for SB to send address+R */
+	I2C1_STATE_RECEIVE,             /**< DMA receives the data bytes */
+} i2c1_state_t;
+
+/**
+ * @brief I2C1 configuration.
+ *
+ */
+typedef struct {
+	const gpio_pin_cfg_t *pin_cfg_scl;  // AF4, open drain
+	const gpio_pin_cfg_t *pin_cfg_sda;  // AF4, open drain
+	uint32_t pclk_hz;                   // APB1 clock, 2..50 MHz
+	uint32_t bus_hz;                    // <= 100 kHz standard mode, <= 400 kHz fast mode
+	dma_handle_t *rx_dma_h;             // initialized I2C1_RX stream (peripheral-to-memory, 8 bit)
+	IRQn_Type ev_irqn;
+	IRQn_Type er_irqn;
+	uint8_t irq_priority;               // event and error interrupt
+} i2c1_cfg_t;
+
+/**
+ * @brief Handle for I2C1.
+ *
+ */
+typedef struct {
+	const i2c1_cfg_t *cfg;
+	volatile i2c1_state_t state;
+	uint8_t device_address;             // 7-bit address
+	uint8_t register_address;
+	bool is_read;
+	uint8_t tx_data[I2C1_MAX_WRITE_BYTES];
+	uint8_t tx_length;
+	uint8_t tx_index;
+	volatile uint8_t *rx_buffer;
+	uint16_t rx_length;
+	i2c1_callback_t callback;
+	void *callback_arg;
+	volatile uint32_t nack_cnt;
+	volatile uint32_t bus_error_cnt;
+	volatile uint32_t arbitration_lost_cnt;
+	uint32_t abort_cnt;
+	bool is_initialized;
+} i2c1_handle_t;
+
+/**
+ * @brief Configure I2C1, its pins and interrupts (the RX DMA stream must be initialized).
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ * @param i2c1_cfg Pointer to I2C1 configuration.
+ * @return true if applied, false if parameters invalid.
+ */
+bool i2c1_init(i2c1_handle_t *i2c1_h, const i2c1_cfg_t *i2c1_cfg);
+
+/**
+ * @brief Start one register read (returns immediately).
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ * @param device_address 7-bit device address.
+ * @param register_address First register.
+ * @param buffer Destination, valid until the callback.
+ * @param length Number of bytes (>= 2).
+ * @param callback Completion callback (NULL if polled with i2c1_is_busy()).
+ * @param callback_arg Callback argument.
+ * @return true if started, false if busy or parameters invalid.
+ */
+bool i2c1_start_read_register(i2c1_handle_t *i2c1_h,
+							  uint8_t device_address,
+							  uint8_t register_address,
+							  volatile uint8_t *buffer,
+							  uint16_t length,
+							  i2c1_callback_t callback,
+							  void *callback_arg);
+
+/**
+ * @brief Start one register write (returns immediately, data is copied).
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ * @param device_address 7-bit device address.
+ * @param register_address First register.
+ * @param data Source bytes.
+ * @param length Number of bytes (1..I2C1_MAX_WRITE_BYTES).
+ * @param callback Completion callback (NULL if polled with i2c1_is_busy()).
+ * @param callback_arg Callback argument.
+ * @return true if started, false if busy or parameters invalid.
+ */
+bool i2c1_start_write_register(i2c1_handle_t *i2c1_h,
+							   uint8_t device_address,
+							   uint8_t register_address,
+							   const uint8_t *data,
+							   uint8_t length,
+							   i2c1_callback_t callback,
+							   void *callback_arg);
+
+/**
+ * @brief Check if a transaction is in progress.
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ * @return true while a transaction runs, false otherwise.
+ */
+bool i2c1_is_busy(const i2c1_handle_t *i2c1_h);
+
+/**
+ * @brief Drop the running transaction and software-reset the peripheral.
+ *
+ * The callback of the dropped transaction is not called.
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ * @return true if applied, false if parameters invalid.
+ */
+bool i2c1_abort(i2c1_handle_t *i2c1_h);
+
+/**
+ * @brief Event interrupt handler (call from I2C1_EV_IRQHandler).
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ */
+void i2c1_ev_irq_handler(i2c1_handle_t *i2c1_h);
+
+/**
+ * @brief Error interrupt handler (call from I2C1_ER_IRQHandler).
+ *
+ * @param i2c1_h Pointer to I2C1 handle.
+ */
+void i2c1_er_irq_handler(i2c1_handle_t *i2c1_h);
+
+#endif /* DRIVERS_I2C1_H */
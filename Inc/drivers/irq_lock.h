@@ -0,0 +1,59 @@
+#ifndef DRIVERS_IRQ_LOCK_H
+#define DRIVERS_IRQ_LOCK_H
+/**
+ * @file irq_lock.h
+ * @brief Priority-masked critical sections on BASEPRI (Cortex-M4, CMSIS only).
+ *
+ * A section masks only the interrupts at or below one NVIC priority: the
+ * priority of the most urgent context that touches the protected data.
+ * Everything more urgent (PWM break / fault path, control ISRs above the
+ * data owner) keeps running, so its latency does not depend on the
+ * lengths of lower-level sections.
+ *
+ * Usage:
+ *   uint32_t lock = irq_lock_raise(IRQ_LOCK_PRIORITY_TIMESTAMP);
+ *   ... short access ...
+ *   irq_lock_restore(lock);
+ *
+ * @note Priority 0 cannot be masked by BASEPRI (0 disables masking); lock
+ *       levels are 1..15 and level 0 stays reserved for the fault path.
+ * @note Sections nest: raising never lowers an already higher mask
+ *       (BASEPRI_MAX), restore returns the previous level.
+ * @note Cortex-M4 r0p1 erratum 837070 (STM32F446): a BASEPRI raise may let one
+ *       more interrupt in; the write is wrapped in one PRIMASK instruction pair.
+ */
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+/**
+ * @brief Mask all interrupts with NVIC priority >= priority (numerically).
+ *
+ * @param priority Preemption priority of the data owner, 1..(2^__NVIC_PRIO_BITS - 1).
+ * @return Previous BASEPRI, pass to irq_lock_restore().
+ */
+static inline uint32_t irq_lock_raise(uint32_t priority)
+{
+	uint32_t basepri = __get_BASEPRI();
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	__set_BASEPRI_MAX(priority << (8u - __NVIC_PRIO_BITS));
+	__DSB();
+	__ISB();
+	if ((primask & 1u) == 0u) __enable_irq();
+
+	return basepri;
+}
+
+/**
+ * @brief Leave one section entered with irq_lock_raise().
+ *
+ * @param basepri Value returned by the matching irq_lock_raise().
+ */
+static inline void irq_lock_restore(uint32_t basepri)
+{
+	__set_BASEPRI(basepri);
+}
+
+#endif /* DRIVERS_IRQ_LOCK_H */
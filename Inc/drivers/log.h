@@ -10,14 +10,33 @@
  * Responsibilities:
  * - format log lines with timestamp, level and tag.
  * - send each line as one chunk via uart2 driver.
+ * - deferred mode: queue message ID + raw arguments from any context and
+ *   expand them later from a background task.
  *
- * @note Intended for main/application context, not ISR context.
+ * Deferred usage:
+ *   LOG_POST2(LOG_MSG_APP_ALIGNMENT_DONE, offset, raw);   (ISR-safe, no stdio)
+ *   log_drain(n);                                          (main loop only)
+ *
+ * @note log_write/log_printf/log_data_u32 are intended for main/application
+ *       context, not ISR context.
+ * @note Message IDs, levels, tags and formats live in config/log_messages.h.
  */
 
 #include <stdint.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include "drivers/usart2.h"
+#include "config/log_messages.h"
+
+#ifndef LOG_DEFERRED_RING_SIZE
+#define LOG_DEFERRED_RING_SIZE          32u     // Records, must be a power of 2
+#endif
+#define LOG_DEFERRED_MAX_ARGS           3u
+
+/* 1: drain expands to L-lines on target, 0: drain sends T-lines for tools/log_decode.py. */
+#ifndef LOG_DEFERRED_EXPAND_ON_TARGET
+#define LOG_DEFERRED_EXPAND_ON_TARGET   1u
+#endif
 
 /**
  * @brief Log severity level.
@@ -29,6 +48,17 @@ typedef enum {
 	LOG_LEVEL_ERROR = 2
 } log_level_t;
 
+#define LOG_MESSAGE_ENUM_ENTRY(id, level, tag, fmt) id,
+
+/**
+ * @brief Deferred message identifiers (row order of LOG_MESSAGE_TABLE).
+ *
+ */
+typedef enum {
+	LOG_MESSAGE_TABLE(LOG_MESSAGE_ENUM_ENTRY)
+	LOG_MSG_COUNT
+} log_msg_id_t;
+
 /**
  * @brief Initialize logger with uart handle.
  *
@@ -85,6 +115,44 @@ void log_printf(log_level_t level, const char *tag, const char *fmt, ...);
 void log_data_u32(uint32_t sample_id, uint32_t v0, uint32_t v1,
 				  uint32_t v2, uint32_t v3);
 
+/**
+ * @brief Queue one deferred log record (lock-free, callable from any context).
+ *
+ * Stores the message ID, the 64-bit SYSTICK_GetTimeUs() timestamp (the time
+ * base of the log_printf lines) and the raw arguments; no formatting happens
+ * here. A full ring drops the record and counts it, the next drain reports
+ * the loss.
+ *
+ * @param msg_id Message identifier from config/log_messages.h.
+ * @param arg_count Number of valid arguments (0..LOG_DEFERRED_MAX_ARGS).
+ * @param a0 Argument 0.
+ * @param a1 Argument 1.
+ * @param a2 Argument 2.
+ * @return true if queued, false if dropped or invalid.
+ */
+bool log_post(log_msg_id_t msg_id, uint32_t arg_count, int32_t a0, int32_t a1, int32_t a2);
+
+/**
+ * @brief Send queued deferred records in post order.
+ *
+ * With LOG_DEFERRED_EXPAND_ON_TARGET the line format is the log_printf one
+ * (time taken from the record timestamp), otherwise:
+ * T,<time_us>,<msg_id>,<arg0>,...
+ *
+ * Stops early while the USART2 TX ring has no room for one line.
+ *
+ * @param max_records Maximum number of records sent by this call.
+ * @return true if committed records are still pending, false otherwise.
+ */
+bool log_drain(uint32_t max_records);
+
+/**
+ * @brief Return the number of records dropped on a full ring since boot.
+ *
+ * @return Dropped record count.
+ */
+uint32_t log_get_dropped_count(void);
+
 /**
  * @brief Write info log line.
  *
@@ -109,6 +177,15 @@ void log_data_u32(uint32_t sample_id, uint32_t v0, uint32_t v1,
  */
 #define LOGE(tag, msg) log_write(LOG_LEVEL_ERROR, (tag), (msg))
 
+/**
+ * @brief Queue deferred log records with 0..3 raw 32-bit arguments.
+ *
+ */
+#define LOG_POST0(id)             (void)log_post((id), 0u, 0, 0, 0)
+#define LOG_POST1(id, a0)         (void)log_post((id), 1u, (int32_t)(a0), 0, 0)
+#define LOG_POST2(id, a0, a1)     (void)log_post((id), 2u, (int32_t)(a0), (int32_t)(a1), 0)
+#define LOG_POST3(id, a0, a1, a2) (void)log_post((id), 3u, (int32_t)(a0), (int32_t)(a1), (int32_t)(a2))
+
 /**
  * @brief Write formatted info log line.
  *
@@ -0,0 +1,34 @@
+#ifndef DRIVERS_MEMORY_SECTION_H
+#define DRIVERS_MEMORY_SECTION_H
+/**
+ * @file memory_section.h
+ * @brief SRAM placement of the control fast path (.ramfunc / .fastdata).
+ *
+ * FLASH runs with wait states (5 at 180 MHz); the ART accelerator hides them
+ * only on cache hits, so ISR and kernel run times depend on what ran before.
+ * Code and tables tagged here are linked to SRAM, copied from FLASH by
+ * Reset_Handler before main() and execute without wait states. The vector
+ * table is copied to SRAM as well (SCB->VTOR), so exception entry does not
+ * fetch the handler address from FLASH either.
+ *
+ * Usage:
+ *   MEMORY_SECTION_RAMFUNC bool kernel_update(...) { ... }
+ *   MEMORY_SECTION_FASTCONST static const int16_t kernel_lut[] = { ... };
+ *
+ * @note Tag the static helpers of a tagged function too: a helper the
+ *       compiler does not inline stays in FLASH.
+ * @note FLASH and SRAM are out of BL range of each other; the linker inserts
+ *       a long-branch veneer for each call that crosses them.
+ * @note Const and non-const objects use separate macros: GCC rejects both in
+ *       one section of one translation unit.
+ * @note Nothing tagged may run before the copy (SystemInit()).
+ */
+
+/* Code executed from SRAM (linker section .ramfunc) */
+#define MEMORY_SECTION_RAMFUNC			__attribute__((section(".ramfunc")))
+/* Initialized data in SRAM next to the fast-path code (linker section .fastdata) */
+#define MEMORY_SECTION_FASTDATA			__attribute__((section(".fastdata")))
+/* Read-only tables copied to SRAM (linker section .fastdata.const) */
+#define MEMORY_SECTION_FASTCONST		__attribute__((section(".fastdata.const")))
+
+#endif /* DRIVERS_MEMORY_SECTION_H */
@@ -0,0 +1,124 @@
+#ifndef DRIVERS_PROFILER_H
+#define DRIVERS_PROFILER_H
+
+/**
+ * @file profiler.h
+ * @brief Cycle-accurate profiling probes on DWT->CYCCNT (Cortex-M4, CMSIS only).
+ *
+ * Responsibilities:
+ * - Enable the DWT cycle counter
+ * - Scoped begin/end markers that record one duration per probe
+ * - Per-probe min/max/mean/count, also usable for latency samples
+ *
+ * Usage:
+ *   PROFILER_SCOPE_BEGIN(PROFILER_PROBE_SPEED_PI);
+ *   ... measured code ...
+ *   PROFILER_SCOPE_END(PROFILER_PROBE_SPEED_PI);
+ *
+ * @note Compile-time switch: PROFILER_ENABLE = 0 removes the probes, the table
+ *       and the DWT setup completely (markers expand to nothing).
+ * @note Each probe must be recorded from one context only (one ISR or main loop).
+ * @note CYCCNT wraps every 2^32 cycles (23.8 s at 180 MHz); scopes must be shorter.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE		1u
+#endif
+
+/**
+ * @brief Probe identifiers (project-wide list, order is the dump order).
+ *
+ */
+typedef enum {
+	PROFILER_PROBE_AS5600_ADC_ISR = 0,		/**< AS5600 analog ADC EOC callback */
+	PROFILER_PROBE_AS5600_DMA_ISR,			/**< ADC1 DMA window processing */
+	PROFILER_PROBE_REFERENCE_ESTIMATOR,		/**< motor_speed_reference_estimator_update() */
+	PROFILER_PROBE_SPEED_PI,				/**< motor_speed_pi_update() */
+	PROFILER_PROBE_FOC_APPLY_DQ,			/**< motor_foc_voltage_apply_dq() */
+	PROFILER_PROBE_FAST_LOOP_ISR,			/**< PWM-synchronous fast loop callback */
+	PROFILER_PROBE_FAST_LOOP_LATENCY,		/**< TIM1 update event -> fast loop entry (latency sample) */
+	PROFILER_PROBE_TELEMETRY,				/**< runtime telemetry emit */
+	PROFILER_PROBE_CURRENT_LOOP,			/**< current-mode FOC loop in the ADC2 JEOC interrupt */
+	PROFILER_PROBE_COUNT,
+} profiler_probe_id_t;
+
+/**
+ * @brief Statistics of one probe in CPU cycles.
+ *
+ */
+typedef struct {
+	uint32_t count;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t sum_cycles;
+} profiler_probe_stats_t;
+
+#if (PROFILER_ENABLE != 0u)
+
+/**
+ * @brief Read the free-running cycle counter.
+ *
+ * @return Current DWT->CYCCNT value.
+ */
+static inline uint32_t profiler_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief Enable the DWT cycle counter and clear all probes.
+ *
+ * @return true if the cycle counter runs, false if DWT is not available.
+ */
+bool profiler_init(void);
+
+/**
+ * @brief Clear all probe statistics.
+ */
+void profiler_reset(void);
+
+/**
+ * @brief Record one sample (duration or latency) in cycles.
+ *
+ * @param probe_id Probe identifier.
+ * @param cycles Sample value in CPU cycles.
+ */
+void profiler_record(profiler_probe_id_t probe_id, uint32_t cycles);
+
+/**
+ * @brief Copy the statistics of one probe (consistent snapshot).
+ *
+ * @param probe_id Probe identifier.
+ * @param stats Pointer to output statistics.
+ * @return true if copied, false if parameters invalid.
+ */
+bool profiler_get_stats(profiler_probe_id_t probe_id, profiler_probe_stats_t *stats);
+
+/* Scoped markers: BEGIN declares the start timestamp in the current block. */
+#define PROFILER_SCOPE_BEGIN(probe_id)	const uint32_t profiler_start_##probe_id = profiler_cycles()
+#define PROFILER_SCOPE_END(probe_id)	profiler_record((probe_id), profiler_cycles() - profiler_start_##probe_id)
+#define PROFILER_RECORD(probe_id, cycles)	profiler_record((probe_id), (cycles))
+
+#else
+
+static inline bool profiler_init(void) { return true; }
+static inline void profiler_reset(void) {}
+static inline bool profiler_get_stats(profiler_probe_id_t probe_id, profiler_probe_stats_t *stats)
+{
+	(void)probe_id;
+	(void)stats;
+	return false;
+}
+
+#define PROFILER_SCOPE_BEGIN(probe_id)
+#define PROFILER_SCOPE_END(probe_id)
+#define PROFILER_RECORD(probe_id, cycles)
+
+#endif /* PROFILER_ENABLE */
+
+#endif /* DRIVERS_PROFILER_H */
@@ -5,16 +5,29 @@
  * @file pwm_tim1.h
  * @brief Minimal PWM module for STM32F4 (CMSIS only).
  *
- * Provides register-level configuration.
- * Assumes TIM1 outputs are configured in PWM mode 1.
- * This driver outputs 3 independent PWM signals intended for 3-PWM mode on the power stage.
- * No complementary/dead-time generation is used.
+ * Provides register-level configuration of one advanced-control timer
+ * (TIM1 or TIM8, cfg->inst); one handle per timer, so two power stages can
+ * run side by side. Assumes the outputs are configured in PWM mode 1.
+ * 3-PWM stage: CH1..CH3 only, the driver board generates its own dead time.
+ * 6-PWM stage: CH1N..CH3N pins configured as well, complementary low-side
+ * outputs with hardware dead time (BDTR DTG) inserted on every edge.
  *
  * Responsibilities:
- * - Configure TIM1 registers
- * - Set PWM duty-cycles
+ * - Configure TIM1 / TIM8 registers
+ * - Set PWM duty-cycles (single channel, or all three phases + CH4 trigger in one update period)
+ * - Optional PWM-synchronous update interrupt (TIM1_UP) with callback dispatch
+ * - Optional complementary outputs (CHxN) with dead-time generation
+ * - Optional commutation mode: preloaded channel patterns committed by a COM
+ *   event (software COMG or a TRGI rising edge from another timer)
+ * - Optional TRGO output from internal CH4 compare for synchronized ADC triggering
+ * - Break shutdown (BDTR): BKIN pin and software break clear MOE in hardware,
+ *   the break interrupt (TIM1_BRK / TIM8_BRK) dispatches one callback
+ * - Staggered start of several timers: equal periods, counter phases spread
+ *   so their update interrupts and peak triggers do not coincide
  *
  * @note Current limitation: center-aligned mode only (CMS=1..3). Edge-aligned support may be added later.
+ * @note A break stays latched (MOE = 0, AOE = 0) until pwm_tim1_init() runs again;
+ *       pwm_tim1_start() refuses to re-enable the outputs after it.
  */
 #include <stdint.h>
 #include <stdbool.h>
@@ -33,32 +46,118 @@ typedef enum {
 } pwm_align_t;
 
 /**
- * @brief TIM1 configuration (PWM mode)
+ * @brief Active level of the TIM1_BKIN pin (maps to BDTR BKP).
+ */
+typedef enum {
+	PWM_BREAK_ACTIVE_LOW = 0,
+	PWM_BREAK_ACTIVE_HIGH = 1,
+} pwm_break_polarity_t;
+
+/**
+ * @brief Output pattern of one channel in commutation mode.
+ */
+typedef enum {
+	PWM_TIM1_CHANNEL_PWM = 0,	/**< PWM mode 1 on CHx (CHxN complementary) */
+	PWM_TIM1_CHANNEL_LOW = 1,	/**< forced inactive: CHx low, CHxN high (low side on) */
+	PWM_TIM1_CHANNEL_OFF = 2,	/**< CHx and CHxN disabled, off-state level (both switches off in 6-PWM) */
+} pwm_tim1_channel_mode_t;
+
+/**
+ * @brief COM event source in commutation mode (TRGI maps to SMCR TS).
+ */
+typedef enum {
+	PWM_TIM1_COM_TRIGGER_SOFTWARE = 0,	/**< COMG only, pwm_tim1_generate_com() */
+	PWM_TIM1_COM_TRIGGER_ITR0 = 1,		/**< + TRGI rising edge from TIM5 TRGO (TIM8: TIM1 TRGO) */
+	PWM_TIM1_COM_TRIGGER_ITR1 = 2,		/**< + TRGI rising edge from TIM2 TRGO (TIM8: TIM2 TRGO) */
+	PWM_TIM1_COM_TRIGGER_ITR2 = 3,		/**< + TRGI rising edge from TIM3 TRGO (TIM8: TIM4 TRGO) */
+	PWM_TIM1_COM_TRIGGER_ITR3 = 4,		/**< + TRGI rising edge from TIM4 TRGO (TIM8: TIM5 TRGO) */
+} pwm_tim1_com_trigger_t;
+
+#define PWM_TIM1_INSTANCE_COUNT			2u		/**< TIM1 and TIM8 */
+#define PWM_TIM1_MAX_PERIODS_PER_UPDATE	128u	/**< RCR is 8-bit; center-aligned counts two events per period */
+#define PWM_TIM1_IDLE_HIGH_CH1			(1u << 0)	/**< idle_high_mask bits: channel idles high when MOE = 0 */
+#define PWM_TIM1_IDLE_HIGH_CH2			(1u << 1)
+#define PWM_TIM1_IDLE_HIGH_CH3			(1u << 2)
+#define PWM_TIM1_IDLE_HIGH_CH1N			(1u << 3)	/**< complementary outputs (6-PWM), OISxN */
+#define PWM_TIM1_IDLE_HIGH_CH2N			(1u << 4)
+#define PWM_TIM1_IDLE_HIGH_CH3N			(1u << 5)
+#define PWM_TIM1_MAX_DEAD_TIME_TICKS	1008u	/**< DTG range in timer clocks (tDTS = timer clock, CKD = 0) */
+
+// function pointer for the PWM update callback (called from TIM1_UP_TIM10_IRQHandler / TIM8_UP_TIM13_IRQHandler)
+typedef void (*pwm_tim1_callback_t)(void *callback_arg);
+
+/**
+ * @brief TIM1 / TIM8 configuration (PWM mode)
  *
- * @pre pin_ch1,2,3 must describe correct AF mapping. Driver will call gpio_init_pin.
+ * @pre pin_ch1,2,3 must describe correct AF mapping (TIM1: AF1, TIM8: AF3). Driver will call gpio_init_pin.
  * Each pin pointer may be NULL to disable the corresponding channel.
+ * pin_chxn requires pin_chx; all three NULL selects the 3-PWM stage.
  * The pointed-to configs must remain valid for the lifetime of the driver.
  */
 typedef struct {
-	uint32_t tim_clk_hz;	// actual TIM1 counter clock
+	TIM_TypeDef *inst;		// TIM1 or TIM8
+	uint32_t tim_clk_hz;	// actual timer counter clock
 	uint32_t pwm_hz;
 	pwm_align_t align;
 
 	const gpio_pin_cfg_t* pin_ch1;
 	const gpio_pin_cfg_t* pin_ch2;
 	const gpio_pin_cfg_t* pin_ch3;
+
+	// Complementary outputs (TIM1: PB13 / PB14 / PB15 or PA7 / PB0 / PB1, AF1), NULL = 3-PWM stage
+	const gpio_pin_cfg_t* pin_ch1n;
+	const gpio_pin_cfg_t* pin_ch2n;
+	const gpio_pin_cfg_t* pin_ch3n;
+	uint32_t dead_time_ns;			// inserted on every CHx / CHxN edge, rounded up to the DTG grid
+
+	// Update interrupt handle and priority (used only when the update IRQ is enabled)
+	IRQn_Type update_irqn;
+	uint8_t update_irq_priority;
+
+	// Break: optional BKIN pin (TIM1: PA6 / PB12, AF1; TIM8: PA6, AF3), NULL = software break only
+	const gpio_pin_cfg_t* pin_bkin;
+	pwm_break_polarity_t break_polarity;
+	bool idle_off_state_driven;		// OSSI: MOE = 0 drives the idle level (true) or releases the pins (false)
+	bool run_off_state_driven;		// OSSR: MOE = 1, CCxE = 0 drives the inactive level (true) or releases the pins
+	uint8_t idle_high_mask;			// OISx: PWM_TIM1_IDLE_HIGH_CHx bits, cleared bits idle low
+	IRQn_Type break_irqn;
+	uint8_t break_irq_priority;		// keep above every other IRQ (fault path)
+
+	// Commutation interrupt (used only in commutation mode)
+	IRQn_Type com_irqn;
+	uint8_t com_irq_priority;
+
+	// irq_lock level held across the grouped compare write (>= 1), keeps the UDIS window a few bus writes long
+	uint8_t duty_lock_priority;
 } pwm_tim1_cfg_t;
 
 /**
- * @brief Handle for TIM1 (PWM mode).
+ * @brief Handle for TIM1 / TIM8 (PWM mode).
  *
  */
 typedef struct {
+	TIM_TypeDef *inst;	// Timer instance, NULL until pwm_tim1_init()
 	uint16_t arr;		// Auto-reload value
+	uint16_t psc;		// Prescaler (counter clock = tim_clk_hz / (psc + 1))
+	uint32_t dead_time_ns;	// Programmed dead time after DTG rounding, 0 without complementary outputs
+	const pwm_tim1_cfg_t *cfg;
+	pwm_tim1_callback_t update_callback;	// PWM-synchronous callback, NULL if unused
+	void *update_callback_arg;
+	volatile uint32_t update_event_cnt;		// Number of dispatched update events
+	pwm_tim1_callback_t break_callback;		// Break callback (BKIN or software break), NULL if unused
+	void *break_callback_arg;
+	volatile bool break_latched;			// Outputs shut down by a break until the next init
+	pwm_tim1_callback_t com_callback;		// COM callback (commutation mode), NULL if unused
+	void *com_callback_arg;
+	volatile uint32_t com_event_cnt;		// Number of dispatched COM events
+	bool is_commutation_enabled;
 } pwm_tim1_handle_t;
 
 /**
- * @brief Configure TIM1 registers according to the given configuration instance.
+ * @brief Configure the timer registers according to the given configuration instance.
+ *
+ * With complementary outputs the dead time must fit the DTG range
+ * (PWM_TIM1_MAX_DEAD_TIME_TICKS timer clocks, 5.6 us at 180 MHz).
  *
  * @param pwm_cfg Pointer to the TIM1 configuration instance (PWM mode).
  * @param pwm_h	Pointer to the TIM1 handle instance (PWM mode).
@@ -82,6 +181,22 @@ bool pwm_tim1_start(pwm_tim1_handle_t* pwm_h);
  */
 bool pwm_tim1_stop(pwm_tim1_handle_t* pwm_h);
 
+/**
+ * @brief Start several stopped timers with staggered counter phases.
+ *
+ * Timer i starts i / count of a half PWM period behind timer 0, so with two
+ * stages the update events and CH4 peak triggers sit a quarter period
+ * apart. All timers need the same ARR and PSC. The counter enables are
+ * written back to back inside one lock_prio section; the phase error is a
+ * few timer clocks.
+ *
+ * @param pwm_hs Handles in phase order (distinct instances).
+ * @param count Number of handles (1..PWM_TIM1_INSTANCE_COUNT).
+ * @param lock_prio irq_lock level held across the counter enables (>= 1).
+ * @return true if started, false if parameters invalid, a counter runs or a break is latched.
+ */
+bool pwm_tim1_start_staggered(pwm_tim1_handle_t* const pwm_hs[], uint8_t count, uint32_t lock_prio);
+
 /**
  * @brief Load TIM1_CCRx according to the channel number and duty value.
  *
@@ -92,4 +207,211 @@ bool pwm_tim1_stop(pwm_tim1_handle_t* pwm_h);
  */
 bool pwm_tim1_set_duty(pwm_tim1_handle_t* pwm_h, uint8_t ch, uint16_t duty);
 
+/**
+ * @brief Load TIM1_CCR1..3 together: the next update event transfers all three or none.
+ *
+ * The writes are bracketed by CR1 UDIS (preload transfer held) inside one
+ * cfg->duty_lock_priority section, so no PWM period runs with a mix of old
+ * and new compare values. An update event that falls inside the window (a
+ * few bus writes) is suppressed: the previous set stays one more period and
+ * that update interrupt does not fire. Called from the update callback the
+ * window is far from the next event.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param duty_a CH1 compare value in timer ticks (saturated to 0..ARR).
+ * @param duty_b CH2 compare value in timer ticks (saturated to 0..ARR).
+ * @param duty_c CH3 compare value in timer ticks (saturated to 0..ARR).
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_set_duty_abc(pwm_tim1_handle_t* pwm_h, uint16_t duty_a, uint16_t duty_b, uint16_t duty_c);
+
+/**
+ * @brief Load TIM1_CCR1..3 and the CH4 ADC trigger compare in one update period.
+ *
+ * Same grouping as pwm_tim1_set_duty_abc(); the trigger point moves with the
+ * duties it samples (pwm_tim1_enable_adc_trigger() must have configured CH4).
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param duty_a CH1 compare value in timer ticks (saturated to 0..ARR).
+ * @param duty_b CH2 compare value in timer ticks (saturated to 0..ARR).
+ * @param duty_c CH3 compare value in timer ticks (saturated to 0..ARR).
+ * @param trigger_ticks CH4 compare value for the trigger point (0..ARR).
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_set_duty_abc_trigger(pwm_tim1_handle_t* pwm_h,
+								   uint16_t duty_a,
+								   uint16_t duty_b,
+								   uint16_t duty_c,
+								   uint16_t trigger_ticks);
+
+/**
+ * @brief Assign the callback function dispatched on each TIM1 update interrupt.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param callbk handler of a callback function (NULL removes the callback).
+ * @param callbk_arg a Pointer to callback_arguments.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_register_update_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg);
+
+/**
+ * @brief Assign the callback function dispatched on the TIM1 break interrupt.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param callbk handler of a callback function (NULL removes the callback).
+ * @param callbk_arg a Pointer to callback_arguments.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_register_break_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg);
+
+/**
+ * @brief Software break: clear MOE in hardware and raise the break interrupt.
+ *
+ * Same shutdown path as the BKIN pin (outputs go to the OSSI / OISx state
+ * within one timer clock). Safe from any context.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_trigger_break(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief Check whether the next update event already occurred (UIF set again).
+ *
+ * Called at the end of the update callback this flags a control step that
+ * overran its update interval.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return true if an update event is pending, false otherwise or if pointer invalid.
+ */
+bool pwm_tim1_is_update_pending(const pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief Enter commutation mode: CCxE / CCxNE / OCxM become preloaded (CR2 CCPC).
+ *
+ * Pattern writes from pwm_tim1_preload_channel_modes() take effect together on
+ * the next COM event, independent of the PWM period. The COM interrupt
+ * dispatches the COM callback after each event (preload the next pattern there).
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param trigger COM source in addition to COMG.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_enable_commutation(pwm_tim1_handle_t* pwm_h, pwm_tim1_com_trigger_t trigger);
+
+/**
+ * @brief Leave commutation mode and restore PWM mode 1 on every configured channel.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_disable_commutation(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief Preload the channel pattern committed by the next COM event.
+ *
+ * Channels without a configured pin stay disabled.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param ch1_mode CH1 / CH1N pattern.
+ * @param ch2_mode CH2 / CH2N pattern.
+ * @param ch3_mode CH3 / CH3N pattern.
+ * @return true if applied, false if parameters invalid or commutation mode off.
+ */
+bool pwm_tim1_preload_channel_modes(pwm_tim1_handle_t* pwm_h,
+									pwm_tim1_channel_mode_t ch1_mode,
+									pwm_tim1_channel_mode_t ch2_mode,
+									pwm_tim1_channel_mode_t ch3_mode);
+
+/**
+ * @brief Software COM event (EGR COMG): commit the preloaded pattern now.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return true if applied, false if parameters invalid or commutation mode off.
+ */
+bool pwm_tim1_generate_com(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief Assign the callback function dispatched on each TIM1 COM interrupt.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param callbk handler of a callback function (NULL removes the callback).
+ * @param callbk_arg a Pointer to callback_arguments.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_register_com_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg);
+
+/**
+ * @brief Enable the TIM1 update interrupt once every given number of PWM periods.
+ *
+ * In center-aligned mode the repetition counter decrements on both overflow
+ * and underflow, so RCR = 2 * pwm_periods_per_update - 1. With an odd RCR the
+ * update event lands on the same counter extreme every time.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param pwm_periods_per_update PWM periods per update event (1..PWM_TIM1_MAX_PERIODS_PER_UPDATE).
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_enable_update_irq(pwm_tim1_handle_t* pwm_h, uint16_t pwm_periods_per_update);
+
+/**
+ * @brief Disable the TIM1 update interrupt.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_disable_update_irq(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief Drive TIM1 TRGO from the internal CH4 compare (OC4REF) once per PWM period.
+ *
+ * CH4 runs in PWM mode 2 without an output pin, so OC4REF rises when the
+ * up-counting phase reaches trigger_ticks. trigger_ticks = arr places the
+ * trigger at the counter peak, where all high-side switches are off and no
+ * phase is switching. Independent of the RCR update divider.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @param trigger_ticks Compare value for the trigger point (0..arr).
+ * @return true if applied, false if parameters invalid.
+ */
+bool pwm_tim1_enable_adc_trigger(pwm_tim1_handle_t* pwm_h, uint16_t trigger_ticks);
+
+/**
+ * @brief Timer ticks elapsed since the last counter extreme (underflow or overflow).
+ *
+ * Called at update ISR entry this is the interrupt latency in TIM1 ticks;
+ * valid while less than half a PWM period has passed.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ * @return Elapsed ticks (0 if pointer invalid).
+ */
+uint16_t pwm_tim1_get_ticks_since_update(const pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief callback function for the update interrupt, must be called from TIM1_UP_TIM10_IRQHandler
+ *        (TIM8: TIM8_UP_TIM13_IRQHandler).
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ */
+void pwm_tim1_update_irq_handler(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief callback function for the break interrupt, must be called from TIM1_BRK_TIM9_IRQHandler
+ *        (TIM8: TIM8_BRK_TIM12_IRQHandler).
+ *
+ * Latches the break, masks the (level-sensitive) break interrupt and
+ * dispatches the break callback once.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ */
+void pwm_tim1_break_irq_handler(pwm_tim1_handle_t* pwm_h);
+
+/**
+ * @brief callback function for the COM interrupt, must be called from TIM1_TRG_COM_TIM11_IRQHandler
+ *        (TIM8: TIM8_TRG_COM_TIM14_IRQHandler).
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance.
+ */
+void pwm_tim1_com_irq_handler(pwm_tim1_handle_t* pwm_h);
+
 #endif /* DRIVERS_PWM_TIM1_H_ */
@@ -0,0 +1,188 @@
+#ifndef DRIVERS_SCHEDULER_H
+#define DRIVERS_SCHEDULER_H
+
+/**
+ * @file scheduler.h
+ * @brief Static task-table cooperative scheduler for the main loop.
+ *
+ * Responsibilities:
+ * - release periodic tasks on a fixed grid (start + phase + k * period)
+ * - run due tasks in priority order, background tasks (period 0) every pass
+ *   or only when an interrupt posted one of their event bits
+ * - measure execution time and count deadline overruns per task
+ * - handle missed releases by skipping them or catching up a bounded number
+ * - optionally sleep with WFI when no task was released and no event is pending
+ * - account idle time (empty passes including the WFI sleep) for a CPU-load figure
+ *
+ * Usage:
+ *   scheduler_init(&h, &cfg);  scheduler_start(&h, now_us);
+ *   while (1) { scheduler_run_pass(&h); }
+ *
+ * @note Tasks run to completion in main context; ISRs are unaffected.
+ * @note The release grid never drifts: a late run does not shift later releases.
+ * @note With WFI idle every background task must be woken by an interrupt
+ *       (DMA, ADC, timer), a polled one would stall until the next IRQ.
+ * @note The pending-event check and WFI run with PRIMASK set: an event posted
+ *       just before the sleep still wakes the core, and the wake time is read
+ *       before the waking ISR runs, so idle time excludes ISR time.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHEDULER_MAX_TASKS                 8u
+/* Upper bound of back-to-back catch-up runs, older missed releases are skipped. */
+#define SCHEDULER_MAX_CATCH_UP_RELEASES     4u
+
+/**
+ * @brief Task entry point.
+ *
+ * @param arg User argument from the task configuration.
+ * @param now_us Time at the start of the scheduler pass in microseconds.
+ */
+typedef void (*scheduler_task_fn_t)(void *arg, uint64_t now_us);
+
+/**
+ * @brief Handling of releases that passed before the task could run.
+ *
+ */
+typedef enum {
+	SCHEDULER_MISS_SKIP = 0,        /* Run once, drop the missed releases (control tasks). */
+	SCHEDULER_MISS_CATCH_UP,        /* Run once per missed release on the following passes. */
+} scheduler_miss_policy_t;
+
+/**
+ * @brief Static configuration of one task.
+ *
+ */
+typedef struct {
+	scheduler_task_fn_t fn;
+	void *arg;
+	uint32_t period_us;                 /* 0 = background task, runs every pass. */
+	uint32_t phase_us;                  /* First release after scheduler_start(). */
+	uint32_t deadline_us;               /* Release -> completion limit, 0 = period. */
+	uint8_t priority;                   /* 0 = highest; equal priorities keep table order. */
+	scheduler_miss_policy_t miss_policy;
+	uint32_t event_mask;                /* Background task: run only on these posted events, 0 = every pass. */
+} scheduler_task_cfg_t;
+
+/**
+ * @brief Runtime statistics of one task.
+ *
+ */
+typedef struct {
+	uint32_t run_count;
+	uint32_t last_exec_us;
+	uint32_t max_exec_us;
+	uint32_t overrun_count;             /* Runs that completed after their deadline. */
+	uint32_t skip_count;                /* Releases dropped without a run. */
+	uint32_t catch_up_count;            /* Runs made for an already missed release. */
+} scheduler_task_stats_t;
+
+/**
+ * @brief CPU load over one window (between two scheduler_get_load() calls).
+ *
+ */
+typedef struct {
+	uint32_t window_us;
+	uint32_t idle_us;                   /* Empty passes, including the WFI sleep. */
+	uint16_t load_permyriad;            /* (window - idle) / window */
+	uint32_t pass_count;
+	uint32_t sleep_count;               /* WFI entries. */
+} scheduler_load_t;
+
+/**
+ * @brief Scheduler configuration.
+ *
+ */
+typedef struct {
+	const scheduler_task_cfg_t *tasks;
+	uint8_t task_count;                 /* 1..SCHEDULER_MAX_TASKS */
+	uint64_t (*get_time_us)(void);      /* Monotonic microsecond time source. */
+	bool idle_wfi;                      /* Sleep when no periodic task was due in one pass. */
+} scheduler_cfg_t;
+
+/**
+ * @brief Scheduler runtime handle.
+ *
+ */
+typedef struct {
+	const scheduler_cfg_t *cfg;
+	uint8_t run_order[SCHEDULER_MAX_TASKS];         /* Task indices sorted by priority. */
+	uint64_t next_release_us[SCHEDULER_MAX_TASKS];
+	scheduler_task_stats_t stats[SCHEDULER_MAX_TASKS];
+	uint32_t pass_count;
+	uint32_t idle_count;                            /* Passes without a periodic release or event. */
+	volatile uint32_t pending_events;               /* Posted by ISRs, taken once per pass. */
+	/* Idle accounting, main context only. */
+	uint64_t idle_us;
+	uint32_t sleep_count;
+	uint64_t load_window_start_us;
+	uint64_t load_window_idle_us;
+	uint32_t load_window_pass_count;
+	uint32_t load_window_sleep_count;
+	bool is_started;
+	bool is_initialized;
+} scheduler_handle_t;
+
+/**
+ * @brief Initialize scheduler handle and sort tasks by priority.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param scheduler_cfg Pointer to scheduler configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool scheduler_init(scheduler_handle_t *scheduler_h, const scheduler_cfg_t *scheduler_cfg);
+
+/**
+ * @brief Clear the statistics and place the first releases at start + phase.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param start_us Release grid origin in microseconds.
+ * @return true if started, false otherwise.
+ */
+bool scheduler_start(scheduler_handle_t *scheduler_h, uint64_t start_us);
+
+/**
+ * @brief Run every due task once in priority order, then idle if configured.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @return true if the pass ran, false if not started.
+ */
+bool scheduler_run_pass(scheduler_handle_t *scheduler_h);
+
+/**
+ * @brief Post event bits that release the background tasks waiting on them.
+ *
+ * Safe from any ISR (exclusive-access OR).
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param events Event bits.
+ * @return true if posted, false otherwise.
+ */
+bool scheduler_post_event(scheduler_handle_t *scheduler_h, uint32_t events);
+
+/**
+ * @brief Report the CPU load since the previous call and start the next window.
+ *
+ * Main context only (same context as scheduler_run_pass()).
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param load Output load of the finished window.
+ * @return true if reported, false if not started or the window is empty.
+ */
+bool scheduler_get_load(scheduler_handle_t *scheduler_h, scheduler_load_t *load);
+
+/**
+ * @brief Copy the statistics of one task.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param task_index Index in the configuration table.
+ * @param stats Output statistics.
+ * @return true if copied, false otherwise.
+ */
+bool scheduler_get_task_stats(const scheduler_handle_t *scheduler_h,
+							  uint8_t task_index,
+							  scheduler_task_stats_t *stats);
+
+#endif /* DRIVERS_SCHEDULER_H */
@@ -12,12 +12,19 @@
  * - Configure SysTick registers.
  * - Compute Elapsed time in ms and us (Approximately).
  * - implement SysTick interrupts.
+ *
+ * With a 1 MHz TIM5 timebase attached (cfg timebase_h) SYSTICK_GetTimeUs() is a
+ * facade over tim5_timebase_now64(): a few register reads instead of VAL
+ * interpolation with a 64-bit divide. Milliseconds keep following the tick counter.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include "stm32f4xx.h"
+#include "drivers/tim5_timebase.h"
+
+#define SYSTICK_TIMEBASE_TICK_HZ   1000000u   // Required rate of an attached timebase
 /**
  * @brief SysTick configuration.
  *
@@ -26,6 +33,7 @@ typedef struct {
   uint32_t sysclk_hz;   	 // Core clock used by SysTick (CPU clock source)
   uint32_t tick_period_us;   // SysTick interrupt period in microseconds
   uint32_t irq_prio;         // SysTick IRQ priority
+  const tim5_timebase_handle_t *timebase_h; // Optional initialized 1 MHz timebase for us timestamps (NULL: SysTick VAL)
 } systick_cfg_t;
 
 /**
@@ -0,0 +1,142 @@
+#ifndef DRIVERS_TELEMETRY_H
+#define DRIVERS_TELEMETRY_H
+
+/**
+ * @file telemetry.h
+ * @brief Compact binary telemetry frames over USART2.
+ *
+ * Frames are built without stdio and handed to the USART2 TX ring buffer
+ * in one block. A frame is only queued when it fits completely, so the
+ * byte stream never carries partial frames.
+ *
+ * Frame layout (little-endian):
+ * [0]      sync byte (TELEMETRY_FRAME_SYNC)
+ * [1]      frame type (channel set identifier)
+ * [2]      sequence number (wraps at 255, gaps reveal dropped frames)
+ * [3..6]   timestamp in microseconds (uint32, wraps)
+ * [7..n-3] packed payload channels (int16/int32/...)
+ * [n-2..]  CRC-16/CCITT-FALSE over bytes [1..n-3]
+ *
+ * @note Payload layout is defined per frame type by the application and
+ *       must match the host decoder (tools/telemetry_decode.py).
+ * @note Intended for main/application context, not ISR context.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "drivers/usart2.h"
+
+#define TELEMETRY_FRAME_SYNC            0xA5u
+#define TELEMETRY_FRAME_HEADER_SIZE     7u
+#define TELEMETRY_FRAME_CRC_SIZE        2u
+#define TELEMETRY_FRAME_MAX_PAYLOAD     48u
+#define TELEMETRY_FRAME_MAX_SIZE        (TELEMETRY_FRAME_HEADER_SIZE + TELEMETRY_FRAME_MAX_PAYLOAD + TELEMETRY_FRAME_CRC_SIZE)
+
+/**
+ * @brief Telemetry configuration.
+ *
+ */
+typedef struct {
+	usart2_handle_t *usart_h;
+} telemetry_cfg_t;
+
+/**
+ * @brief Telemetry runtime handle.
+ *
+ */
+typedef struct {
+	const telemetry_cfg_t *cfg;
+	uint8_t sequence;          /* Sequence number of the next frame. */
+	uint32_t frames_sent;
+	uint32_t frames_dropped;   /* Frames rejected because the TX ring had no room. */
+	bool is_initialized;
+} telemetry_handle_t;
+
+/**
+ * @brief One frame under construction.
+ *
+ */
+typedef struct {
+	uint8_t bytes[TELEMETRY_FRAME_MAX_SIZE];
+	uint16_t length;           /* Header + payload bytes written so far. */
+	bool overflow;             /* Set when a put exceeded TELEMETRY_FRAME_MAX_PAYLOAD. */
+} telemetry_frame_t;
+
+/**
+ * @brief Initialize telemetry handle.
+ *
+ * @param telemetry_h Pointer to telemetry handle.
+ * @param telemetry_cfg Pointer to telemetry configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool telemetry_init(telemetry_handle_t *telemetry_h, const telemetry_cfg_t *telemetry_cfg);
+
+/**
+ * @brief Start one frame with header fields.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param frame_type Channel set identifier.
+ * @param timestamp_us Sample timestamp in microseconds.
+ */
+void telemetry_frame_begin(telemetry_frame_t *frame, uint8_t frame_type, uint32_t timestamp_us);
+
+/**
+ * @brief Append one unsigned 8-bit channel.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Channel value.
+ */
+void telemetry_frame_put_u8(telemetry_frame_t *frame, uint8_t value);
+
+/**
+ * @brief Append one unsigned 16-bit channel.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Channel value.
+ */
+void telemetry_frame_put_u16(telemetry_frame_t *frame, uint16_t value);
+
+/**
+ * @brief Append one signed 16-bit channel.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Channel value.
+ */
+void telemetry_frame_put_i16(telemetry_frame_t *frame, int16_t value);
+
+/**
+ * @brief Append one unsigned 32-bit channel.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Channel value.
+ */
+void telemetry_frame_put_u32(telemetry_frame_t *frame, uint32_t value);
+
+/**
+ * @brief Append one signed 32-bit channel.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Channel value.
+ */
+void telemetry_frame_put_i32(telemetry_frame_t *frame, int32_t value);
+
+/**
+ * @brief Stamp sequence number and CRC, then queue the frame as one block.
+ *
+ * @param telemetry_h Pointer to telemetry handle.
+ * @param frame Pointer to frame buffer.
+ * @return true if the whole frame was queued, false if dropped or invalid.
+ */
+bool telemetry_send(telemetry_handle_t *telemetry_h, telemetry_frame_t *frame);
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+ *
+ * @param data Pointer to input bytes.
+ * @param len Number of input bytes.
+ * @return CRC value.
+ */
+uint16_t telemetry_crc16(const uint8_t *data, size_t len);
+
+#endif /* DRIVERS_TELEMETRY_H */
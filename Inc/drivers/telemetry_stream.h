@@ -0,0 +1,162 @@
+#ifndef DRIVERS_TELEMETRY_STREAM_H
+#define DRIVERS_TELEMETRY_STREAM_H
+
+/**
+ * @file telemetry_stream.h
+ * @brief Multi-rate telemetry channels: coherent snapshots and one frame per snapshot.
+ *
+ * The application registers its signals once (name, pointer, type, scale).
+ * The control context samples all of them together at the end of each
+ * control cycle into a double-buffered snapshot; a background encoder
+ * serializes the latest snapshot into one telemetry frame with only the
+ * channels that are selected and due in that cycle.
+ *
+ * Responsibilities:
+ * - read every registered signal in one pass (one coherent control cycle)
+ * - per-channel decimation: a channel is due every Nth sample
+ * - runtime channel mask (bit = registry index)
+ * - lock-free handover from the sampling context to the encoder, counting
+ *   snapshots that were replaced before they were encoded
+ *
+ * Frame payload: u16 mask of the channels it carries, then their values in
+ * registry order, each in the wire width of its type (little-endian).
+ *
+ * Usage:
+ *   control step end:  telemetry_stream_sample(&h, now_us)
+ *   telemetry task:    if (telemetry_stream_encode(&h, &frame)) telemetry_send(&tlm_h, &frame)
+ *
+ * @note sample() must run in one context; encode() / get_snapshot() in one other or the same.
+ * @note The registry must fit one frame: 2 + sum of wire widths <= TELEMETRY_FRAME_MAX_PAYLOAD.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "drivers/telemetry.h"
+
+#define TELEMETRY_STREAM_MAX_CHANNELS       16u
+#define TELEMETRY_STREAM_MASK_SIZE          2u
+#define TELEMETRY_STREAM_SCALE_UNITY_Q16    65536
+
+/**
+ * @brief Source and wire type of one channel.
+ *
+ */
+typedef enum {
+	TELEMETRY_STREAM_TYPE_U8 = 0,
+	TELEMETRY_STREAM_TYPE_U16,
+	TELEMETRY_STREAM_TYPE_I16,
+	TELEMETRY_STREAM_TYPE_I32,
+} telemetry_stream_type_t;
+
+/**
+ * @brief One registered signal.
+ *
+ */
+typedef struct {
+	const char *name;                   /* Host column name (README, tools/telemetry_decode.py). */
+	const volatile void *source;        /* Read once per sample, naturally aligned for its type. */
+	telemetry_stream_type_t type;
+	int32_t scale_q16;                  /* Sent value = source x scale / 2^16, saturated to the type. */
+} telemetry_stream_channel_t;
+
+/**
+ * @brief Telemetry-stream configuration.
+ *
+ */
+typedef struct {
+	const telemetry_stream_channel_t *channels;
+	uint8_t channel_count;              /* 1..TELEMETRY_STREAM_MAX_CHANNELS */
+	uint8_t frame_type;
+} telemetry_stream_cfg_t;
+
+/**
+ * @brief Values of every channel from one sample call.
+ *
+ */
+typedef struct {
+	uint32_t timestamp_us;
+	uint32_t sample_index;
+	uint16_t due_mask;                  /* Selected channels due in this sample. */
+	int32_t values[TELEMETRY_STREAM_MAX_CHANNELS];  /* All channels, scaled and saturated. */
+} telemetry_stream_snapshot_t;
+
+/**
+ * @brief Telemetry-stream runtime handle.
+ *
+ */
+typedef struct {
+	const telemetry_stream_cfg_t *cfg;
+	volatile uint16_t channel_mask;
+	volatile uint16_t decimation[TELEMETRY_STREAM_MAX_CHANNELS];
+	/* Sampling context only. */
+	uint16_t decimation_count[TELEMETRY_STREAM_MAX_CHANNELS];
+	uint32_t sample_count;
+	/* Double-buffered publication, written by the sampling context only. */
+	volatile telemetry_stream_snapshot_t snapshots[2];
+	volatile uint32_t publish_sequence;
+	/* Encoder state. */
+	uint32_t encoded_sample_count;      /* sample_index + 1 of the last encoded snapshot, 0 = none. */
+	uint32_t replaced_count;            /* Snapshots replaced before encode() read them. */
+	bool is_initialized;
+} telemetry_stream_handle_t;
+
+/**
+ * @brief Initialize telemetry-stream handle: all channels selected, decimation 1.
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param telemetry_stream_cfg Pointer to telemetry-stream configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool telemetry_stream_init(telemetry_stream_handle_t *telemetry_stream_h,
+						   const telemetry_stream_cfg_t *telemetry_stream_cfg);
+
+/**
+ * @brief Select the channels that are serialized (bit = registry index).
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param channel_mask Channel mask, bits beyond channel_count must be clear.
+ * @return true if set, false otherwise.
+ */
+bool telemetry_stream_set_mask(telemetry_stream_handle_t *telemetry_stream_h, uint16_t channel_mask);
+
+/**
+ * @brief Set how often one channel is due (every Nth sample).
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param channel_index Registry index.
+ * @param decimation Sample interval, >= 1.
+ * @return true if set, false otherwise.
+ */
+bool telemetry_stream_set_decimation(telemetry_stream_handle_t *telemetry_stream_h,
+									 uint8_t channel_index,
+									 uint16_t decimation);
+
+/**
+ * @brief Read every channel into the next snapshot and publish it.
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param timestamp_us Time of this control cycle (frame timestamp).
+ * @return true if sampled, false otherwise.
+ */
+bool telemetry_stream_sample(telemetry_stream_handle_t *telemetry_stream_h, uint32_t timestamp_us);
+
+/**
+ * @brief Copy the latest published snapshot (consistent).
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param snapshot Output snapshot.
+ * @return true if copied, false if nothing was published yet or the copy kept tearing.
+ */
+bool telemetry_stream_get_snapshot(const telemetry_stream_handle_t *telemetry_stream_h,
+								   telemetry_stream_snapshot_t *snapshot);
+
+/**
+ * @brief Serialize the latest snapshot once into one frame.
+ *
+ * @param telemetry_stream_h Pointer to telemetry-stream handle.
+ * @param frame Output frame (begun with the configured type and the snapshot time).
+ * @return true if a new snapshot with due channels was encoded, false otherwise.
+ */
+bool telemetry_stream_encode(telemetry_stream_handle_t *telemetry_stream_h, telemetry_frame_t *frame);
+
+#endif /* DRIVERS_TELEMETRY_STREAM_H */
@@ -0,0 +1,77 @@
+#ifndef DRIVERS_TIM2_TRIGGER_H
+#define DRIVERS_TIM2_TRIGGER_H
+/**
+ * @file tim2_trigger.h
+ * @brief TIM2 trigger divider for STM32F4 (CMSIS only).
+ *
+ * TIM2 counts rising edges of one internal trigger input (ITRx, e.g. TIM1 TRGO)
+ * in external clock mode 1 and emits TRGO on each overflow. This turns a
+ * per-PWM-period trigger into one ADC trigger every N PWM periods.
+ *
+ * Responsibilities:
+ * - Configure TIM2 slave mode, auto-reload and master output
+ * - Start / stop the divider
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+/**
+ * @brief identifiers for TIM2 internal trigger inputs in TIM2_SMCR (TS)
+ *
+ */
+typedef enum {
+	TIM2_TRIGGER_ITR0_TIM1_TRGO = 0x00,	/**< ITR0: TIM1 TRGO */
+	TIM2_TRIGGER_ITR1_TIM8_TRGO = 0x01,	/**< ITR1: TIM8 TRGO (default remap) */
+	TIM2_TRIGGER_ITR2_TIM3_TRGO = 0x02,	/**< ITR2: TIM3 TRGO */
+	TIM2_TRIGGER_ITR3_TIM4_TRGO = 0x03,	/**< ITR3: TIM4 TRGO */
+} tim2_trigger_input_t;
+
+/**
+ * @brief TIM2 trigger divider configuration.
+ *
+ */
+typedef struct {
+	tim2_trigger_input_t input;
+	uint32_t events_per_trigger;	// Input edges per TRGO pulse (>= 1)
+} tim2_trigger_cfg_t;
+
+/**
+ * @brief Handle for the TIM2 trigger divider.
+ *
+ */
+typedef struct {
+	const tim2_trigger_cfg_t *cfg;
+	bool is_initialized;
+} tim2_trigger_handle_t;
+
+/**
+ * @brief Configure TIM2 as trigger divider (counter stays stopped).
+ *
+ * @note Issues one UG event, which also pulses TRGO; call before the consumer trigger is armed.
+ *
+ * @param tim2_trigger_h Pointer to the TIM2 trigger handle.
+ * @param tim2_trigger_cfg Pointer to the TIM2 trigger configuration.
+ * @return true if applied, false if parameters invalid.
+ */
+bool tim2_trigger_init(tim2_trigger_handle_t *tim2_trigger_h, const tim2_trigger_cfg_t *tim2_trigger_cfg);
+
+/**
+ * @brief Start counting input edges.
+ *
+ * @param tim2_trigger_h Pointer to the TIM2 trigger handle.
+ * @return true if applied, false if parameters invalid.
+ */
+bool tim2_trigger_start(tim2_trigger_handle_t *tim2_trigger_h);
+
+/**
+ * @brief Stop counting input edges.
+ *
+ * @param tim2_trigger_h Pointer to the TIM2 trigger handle.
+ * @return true if applied, false if parameters invalid.
+ */
+bool tim2_trigger_stop(tim2_trigger_handle_t *tim2_trigger_h);
+
+#endif /* DRIVERS_TIM2_TRIGGER_H */
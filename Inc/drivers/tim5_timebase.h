@@ -0,0 +1,145 @@
+#ifndef DRIVERS_TIM5_TIMEBASE_H
+#define DRIVERS_TIM5_TIMEBASE_H
+/**
+ * @file tim5_timebase.h
+ * @brief Free-running 32-bit microsecond timebase on TIM5 (STM32F4, CMSIS only).
+ *
+ * TIM5 counts up at tick_hz over the full 32-bit range. The counter is the
+ * timestamp: one register read for 32 bits, the overflow interrupt extends
+ * it to 64 bits.
+ *
+ * Responsibilities:
+ * - Configure the TIM5 prescaler for the requested tick rate, ARR = 0xFFFFFFFF
+ * - Count counter overflows in the update interrupt
+ * - Inline 32-bit and 64-bit timestamp reads
+ * - Optional CH1 compare on TRGO (MMS compare pulse), internal trigger ITR0 of TIM1
+ *
+ * @note At 1 MHz the 32-bit counter wraps every 71.6 min; 32-bit differences stay
+ *       valid across one wrap.
+ * @note TIM5_IRQHandler() must call tim5_timebase_irq_handler().
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "drivers/irq_lock.h"
+
+/**
+ * @brief TIM5 timebase configuration.
+ *
+ */
+typedef struct {
+	uint32_t tim_clk_hz;			// TIM5 kernel clock (APB1 timer clock)
+	uint32_t tick_hz;				// Counter rate, tim_clk_hz / 65536 .. tim_clk_hz (1 MHz for microseconds)
+	uint32_t irq_prio;				// Overflow IRQ priority
+	uint32_t lock_prio;				// Priority of the most urgent timestamp reader (overflow update masks up to it)
+} tim5_timebase_cfg_t;
+
+/**
+ * @brief Handle for the TIM5 timebase.
+ *
+ */
+typedef struct {
+	const tim5_timebase_cfg_t *cfg;
+	volatile uint32_t overflow_count;	// Upper 32 bits of the 64-bit timestamp
+	bool is_initialized;
+} tim5_timebase_handle_t;
+
+/**
+ * @brief Configure and start TIM5 as free-running timebase (counter starts at 0).
+ *
+ * @param tim5_timebase_h Pointer to the TIM5 timebase handle.
+ * @param tim5_timebase_cfg Pointer to the TIM5 timebase configuration.
+ * @return true if applied, false if parameters invalid or tick_hz not reachable by an integer prescaler.
+ */
+bool tim5_timebase_init(tim5_timebase_handle_t *tim5_timebase_h, const tim5_timebase_cfg_t *tim5_timebase_cfg);
+
+/**
+ * @brief Overflow interrupt service, call from TIM5_IRQHandler().
+ *
+ * @param tim5_timebase_h Pointer to the TIM5 timebase handle.
+ */
+void tim5_timebase_irq_handler(tim5_timebase_handle_t *tim5_timebase_h);
+
+/**
+ * @brief Read the 32-bit timestamp (single register read).
+ *
+ * @return Counter value in ticks.
+ */
+static inline uint32_t tim5_timebase_now32(void)
+{
+	return TIM5->CNT;
+}
+
+/**
+ * @brief Read the 64-bit timestamp.
+ *
+ * A pending overflow that is not counted yet (caller preempts TIM5_IRQHandler()
+ * or runs with IRQs masked) is added from UIF, so the value stays monotonic in
+ * any context. Retries only if the overflow handler ran during the read.
+ *
+ * @param tim5_timebase_h Pointer to the TIM5 timebase handle.
+ * @return Timestamp in ticks.
+ */
+static inline uint64_t tim5_timebase_now64(const tim5_timebase_handle_t *tim5_timebase_h)
+{
+	uint32_t high = 0u;
+	uint32_t count = 0u;
+	uint32_t pending = 0u;
+
+	do
+	{
+		high = tim5_timebase_h->overflow_count;
+		count = TIM5->CNT;
+		// a set UIF with a small count belongs to the wrap just before this read
+		pending = (((TIM5->SR & TIM_SR_UIF) != 0u) && (count < 0x80000000u)) ? 1u : 0u;
+	} while (high != tim5_timebase_h->overflow_count);
+
+	return ((uint64_t)(high + pending) << 32) | (uint64_t)count;
+}
+
+/**
+ * @brief Route the CH1 compare match to TRGO (TIM1 ITR0); the compare starts disarmed.
+ *
+ * CH1 stays frozen (no pin, no interrupt). A match pulses TRGO and sets CC1IF.
+ *
+ * @param tim5_timebase_h Pointer to the TIM5 timebase handle.
+ * @return true if applied, false if parameters invalid or timebase not initialized.
+ */
+bool tim5_timebase_enable_trigger_output(tim5_timebase_handle_t *tim5_timebase_h);
+
+/**
+ * @brief Arm one TRGO pulse at an absolute 32-bit timestamp.
+ *
+ * CC1IF is cleared first, so tim5_timebase_is_trigger_fired() tells a
+ * target that already passed before the write (no match) from one that fired.
+ *
+ * @param at_ticks Match time (tim5_timebase_now32() units).
+ */
+static inline void tim5_timebase_arm_trigger(uint32_t at_ticks)
+{
+	TIM5->SR = ~TIM_SR_CC1IF;		// rc_w0: write 0 clears only CC1IF
+	TIM5->CCR1 = at_ticks;
+}
+
+/**
+ * @brief Move the compare one full wrap away (no TRGO pulse for ~71 min at 1 MHz).
+ *
+ */
+static inline void tim5_timebase_disarm_trigger(void)
+{
+	TIM5->CCR1 = TIM5->CNT - 1u;
+}
+
+/**
+ * @brief Check whether the compare matched since the last tim5_timebase_arm_trigger().
+ *
+ * @return true if CC1IF is set.
+ */
+static inline bool tim5_timebase_is_trigger_fired(void)
+{
+	return ((TIM5->SR & TIM_SR_CC1IF) != 0u);
+}
+
+#endif /* DRIVERS_TIM5_TIMEBASE_H */
@@ -0,0 +1,165 @@
+#ifndef DRIVERS_TIMING_MONITOR_H
+#define DRIVERS_TIMING_MONITOR_H
+
+/**
+ * @file timing_monitor.h
+ * @brief Control-loop timing health: period jitter and latency histograms with a late limit.
+ *
+ * Responsibilities:
+ * - period channels: record the start of every run, histogram |interval - nominal|,
+ *   count missed releases (interval of two or more periods) and catch-up runs
+ *   (interval below half a period)
+ * - latency channels: histogram one measured delay per sample (e.g. angle
+ *   capture -> CCR write)
+ * - count samples above the late limit and latch a violation after a
+ *   configured number of consecutive late samples
+ * - keep a caller-supplied count of samples that never reached the channel
+ *   (stale or overwritten conversions)
+ *
+ * Usage:
+ *   timing_monitor_record_period(&h, TIMING_MONITOR_CHANNEL_SPEED_PERIOD, now_us);
+ *   timing_monitor_record_latency(&h, TIMING_MONITOR_CHANNEL_SAMPLE_TO_ACTUATION, latency_us);
+ *   if (timing_monitor_get_violation(&h, &channel, &value_us)) { ... raise fault ... }
+ *
+ * @note Each channel must be recorded from one context only (one ISR or main loop).
+ * @note Bins are bin_width_us wide, the last bin also takes every larger sample.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMING_MONITOR_BIN_COUNT        6u
+
+/**
+ * @brief Channel identifiers (project-wide list, order is the report order).
+ *
+ */
+typedef enum {
+	TIMING_MONITOR_CHANNEL_SPEED_PERIOD = 0,        /**< speed-control task start-to-start (period) */
+	TIMING_MONITOR_CHANNEL_ACTUATION_PERIOD,        /**< runtime-actuation task start-to-start (period) */
+	TIMING_MONITOR_CHANNEL_SAMPLE_TO_ACTUATION,     /**< angle capture -> CCR write of the primary axis (latency) */
+	TIMING_MONITOR_CHANNEL_COUNT,
+} timing_monitor_channel_t;
+
+/**
+ * @brief Static configuration of one channel.
+ *
+ */
+typedef struct {
+	uint32_t nominal_period_us;         /* Period channel: nominal interval; 0 = latency channel. */
+	uint32_t bin_width_us;              /* Histogram bin width, > 0. */
+	uint32_t late_limit_us;             /* Sample above => late (jitter for periods, delay for latencies). */
+	uint16_t fault_late_count;          /* Consecutive late samples that latch a violation, 0 = never. */
+} timing_monitor_channel_cfg_t;
+
+/**
+ * @brief Timing-monitor configuration.
+ *
+ */
+typedef struct {
+	timing_monitor_channel_cfg_t channels[TIMING_MONITOR_CHANNEL_COUNT];
+} timing_monitor_cfg_t;
+
+/**
+ * @brief Statistics of one channel.
+ *
+ */
+typedef struct {
+	uint32_t bins[TIMING_MONITOR_BIN_COUNT];
+	uint32_t sample_count;
+	uint32_t max_us;
+	uint32_t late_count;                /* Samples above late_limit_us. */
+	uint32_t missed_count;              /* Period channels: releases without a run. */
+	uint32_t catch_up_count;            /* Period channels: runs less than half a period after the previous. */
+	uint32_t dropped_count;             /* Caller-supplied samples that never reached this channel. */
+} timing_monitor_channel_stats_t;
+
+/**
+ * @brief Timing-monitor runtime handle.
+ *
+ */
+typedef struct {
+	const timing_monitor_cfg_t *cfg;
+	timing_monitor_channel_stats_t stats[TIMING_MONITOR_CHANNEL_COUNT];
+	uint64_t previous_start_us[TIMING_MONITOR_CHANNEL_COUNT];
+	bool has_previous_start[TIMING_MONITOR_CHANNEL_COUNT];
+	uint16_t consecutive_late_count[TIMING_MONITOR_CHANNEL_COUNT];
+	/* First violation, written once by the recording context. */
+	volatile bool is_violated;
+	volatile uint8_t violation_channel;
+	volatile uint32_t violation_value_us;
+	bool is_initialized;
+} timing_monitor_handle_t;
+
+/**
+ * @brief Initialize timing-monitor handle with cleared statistics.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param timing_monitor_cfg Pointer to timing-monitor configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool timing_monitor_init(timing_monitor_handle_t *timing_monitor_h, const timing_monitor_cfg_t *timing_monitor_cfg);
+
+/**
+ * @brief Record the start of one run of a period channel.
+ *
+ * The first run after init only sets the reference.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Period channel.
+ * @param start_us Start time of this run in microseconds.
+ * @return true if recorded, false otherwise.
+ */
+bool timing_monitor_record_period(timing_monitor_handle_t *timing_monitor_h,
+								  timing_monitor_channel_t channel,
+								  uint64_t start_us);
+
+/**
+ * @brief Record one sample of a latency channel.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Latency channel.
+ * @param latency_us Measured delay in microseconds.
+ * @return true if recorded, false otherwise.
+ */
+bool timing_monitor_record_latency(timing_monitor_handle_t *timing_monitor_h,
+								   timing_monitor_channel_t channel,
+								   uint32_t latency_us);
+
+/**
+ * @brief Set the number of samples lost before they reached one channel.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Channel identifier.
+ * @param dropped_count Total since init (from the source counters).
+ * @return true if set, false otherwise.
+ */
+bool timing_monitor_set_dropped_count(timing_monitor_handle_t *timing_monitor_h,
+									  timing_monitor_channel_t channel,
+									  uint32_t dropped_count);
+
+/**
+ * @brief Copy the statistics of one channel (consistent snapshot).
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Channel identifier.
+ * @param stats Output statistics.
+ * @return true if copied, false otherwise.
+ */
+bool timing_monitor_get_stats(const timing_monitor_handle_t *timing_monitor_h,
+							  timing_monitor_channel_t channel,
+							  timing_monitor_channel_stats_t *stats);
+
+/**
+ * @brief Report the first latched violation.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Output channel that ran late (may be NULL).
+ * @param value_us Output sample that completed the late run (may be NULL).
+ * @return true if a violation is latched, false otherwise.
+ */
+bool timing_monitor_get_violation(const timing_monitor_handle_t *timing_monitor_h,
+								  timing_monitor_channel_t *channel,
+								  uint32_t *value_us);
+
+#endif /* DRIVERS_TIMING_MONITOR_H */
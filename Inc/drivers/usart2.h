@@ -13,8 +13,12 @@
  * - Receive and transmit data.
  * - utilize ring buffer to store data.
  * - implement interrupts (RXNE & TXE).
+ * - optional RX callback after each byte stored (wakes an event-driven consumer).
+ * - optional DMA TX: contiguous ring chunks are sent by one DMA stream,
+ *   the next chunk is started from the transfer-complete interrupt.
  *
  * @note GPIO pins must be configured via GPIO driver.
+ * @note In DMA TX mode the DMA stream must be initialized before usart2_init().
  */
 
 #include <stdint.h>
@@ -22,10 +26,15 @@
 #include <stddef.h>
 #include "stm32f4xx.h"
 #include "drivers/gpio.h"
+#include "drivers/dma.h"
 
 // Configuration Constants
 #define UART_BUFFER_SIZE  256U	     // Must be a power of 2
 #define BUFFER_MASK       (UART_BUFFER_SIZE - 1)
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE  4096U	 // Must be a power of 2, max 32768
+#endif
+#define TX_BUFFER_MASK    (UART_TX_BUFFER_SIZE - 1)
 
 /**
  * @brief Stores incoming/outgoing bytes to decouple ISR from application and reduce data loss.
@@ -38,6 +47,30 @@ typedef struct {
     volatile uint16_t drop_cnt;
 } ring_buffer_t;
 
+/**
+ * @brief TX ring buffer, sized separately so telemetry bursts can be absorbed.
+ *
+ */
+typedef struct {
+    uint8_t buffer_array[UART_TX_BUFFER_SIZE];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint16_t drop_cnt;
+    volatile uint16_t dma_len;		// bytes owned by the running DMA transfer (0 = idle)
+} tx_ring_buffer_t;
+
+/**
+ * @brief identifiers for the USART2 transmit path
+ *
+ */
+typedef enum {
+	USART2_TX_MODE_IRQ = 0x00,		/**< one byte per TXE interrupt */
+	USART2_TX_MODE_DMA = 0x01,		/**< ring chunks via DMA, one interrupt per chunk */
+} usart2_tx_mode_t;
+
+// function pointer for the RX callback (called from USART2_IRQHandler after a byte is stored)
+typedef void (*usart2_rx_callback_t)(void *callback_arg);
+
 /**
  * @brief USART2 configuration.
  *
@@ -51,6 +84,8 @@ typedef struct {
 	uint32_t irq_priority;
 	const gpio_pin_cfg_t *pin_cfg_rx;
 	const gpio_pin_cfg_t *pin_cfg_tx;
+	usart2_tx_mode_t tx_mode;
+	dma_handle_t *tx_dma_h;			// USART2_TX stream (DMA1 Stream6, channel 4), used in DMA mode only
 }usart2_cfg_t;
 
 /**
@@ -59,13 +94,16 @@ typedef struct {
  */
 typedef struct {
 
+	const usart2_cfg_t *cfg;
 	ring_buffer_t* rx_buffer;
-	ring_buffer_t* tx_buffer;
+	tx_ring_buffer_t* tx_buffer;
 	// USART error counters
     volatile uint32_t err_ore_cnt;
     volatile uint32_t err_fe_cnt;
     volatile uint32_t err_ne_cnt;
     volatile uint32_t err_pe_cnt;
+    usart2_rx_callback_t rx_callback;		// NULL if unused
+    void *rx_callback_arg;
 }usart2_handle_t;
 
 /**
@@ -78,7 +116,8 @@ typedef struct {
 bool  usart2_init(const usart2_cfg_t *usart_cfg, usart2_handle_t *usart_h);
 
 /**
- * @brief Write a chunk of data in the ring buffer and set TXEIE flag.
+ * @brief Copy a chunk of data in the ring buffer (block copy) and start transmission
+ * (TXEIE in IRQ mode, DMA chunk if the stream is idle in DMA mode).
  * If buffer is full, bytes are dropped and drop_cnt increments.
  *
  * @param usart_h Pointer to the USART handle instance.
@@ -88,6 +127,14 @@ bool  usart2_init(const usart2_cfg_t *usart_cfg, usart2_handle_t *usart_h);
  */
 size_t usart2_write(usart2_handle_t *usart_h, const uint8_t* data, const size_t len);
 
+/**
+ * @brief Number of bytes that can currently be queued without dropping.
+ *
+ * @param usart_h Pointer to the USART handle instance.
+ * @return Free space in the TX ring buffer in Bytes (0 if pointers invalid).
+ */
+size_t usart2_tx_free_space(const usart2_handle_t *usart_h);
+
 /**
  * @brief Read a chunk of data from the ring buffer.
  * Returns immediately with how many bytes were actually processed (0 if buffer is empty).
@@ -99,6 +146,16 @@ size_t usart2_write(usart2_handle_t *usart_h, const uint8_t* data, const size_t
  */
 size_t usart2_read(usart2_handle_t *usart_h, uint8_t* output, const size_t max_len);
 
+/**
+ * @brief Assign the callback dispatched after each received byte is stored in the RX ring.
+ *
+ * @param usart_h Pointer to the USART handle instance.
+ * @param callbk handler of a callback function (NULL removes the callback).
+ * @param callbk_arg a Pointer to callback_arguments.
+ * @return true if applied, false if parameters invalid.
+ */
+bool usart2_register_rx_callback(usart2_handle_t *usart_h, usart2_rx_callback_t callbk, void *callbk_arg);
+
 /**
  * @brief callback function, must be called from USART2_IRQHand.
  *
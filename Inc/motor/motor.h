@@ -18,14 +18,16 @@
  * @note Mechanical speed uses signed milli-rpm units for measurements,
  *       targets and limits.
  * @note Amplitude uses permyriad units (0..10000).
+ * @note Phase currents use signed milliampere units.
+ * @note motor_handle_t keeps the state read by the PWM-rate and angle ISR
+ *       paths first (measurements to trajectory); sample histories live in
+ *       module storage outside the handle (e.g. the reference-estimator
+ *       history) so the handle stays compact.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 
-#define MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES   64u
-#define MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE   (MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES + 1u)
-
 /**
  * @brief Motor operating mode within the current project scope.
  *
@@ -97,6 +99,8 @@ typedef struct {
 typedef struct {
 	int32_t raw_mechanical_speed_mrpm;
 	int32_t filtered_mechanical_speed_mrpm;
+	uint16_t observer_mechanical_angle_u16; /* PLL mode: smoothed angle at the latest sample instant. */
+	int32_t observer_angle_error_counts;    /* PLL mode: latest wrapped measured - predicted angle. */
 } motor_speed_feedback_state_t;
 
 /**
@@ -106,24 +110,118 @@ typedef struct {
 typedef struct {
 	int32_t speed_error_mrpm;
 	int32_t integrator_term_permyriad;
+	int32_t feedforward_term_permyriad;    /* Speed + acceleration + friction feedforward after its own limit. */
 	int32_t speed_control_uq_command_permyriad;
+	int32_t speed_control_iq_reference_ma; /* Current mode: command scaled onto the configured current limit. */
 } motor_speed_pi_state_t;
 
+/**
+ * @brief Measured phase-current state (current-mode FOC).
+ *
+ */
+typedef struct {
+	int32_t phase_a_ma;
+	int32_t phase_b_ma;
+	int32_t phase_c_ma;
+	int32_t alpha_ma;
+	int32_t beta_ma;
+	int32_t id_ma;
+	int32_t iq_ma;
+} motor_current_state_t;
+
+/**
+ * @brief Closed-loop d/q current PI runtime state.
+ *
+ */
+typedef struct {
+	int32_t id_reference_ma;
+	int32_t iq_reference_ma;
+	int32_t ud_command_permyriad;
+	int32_t uq_command_permyriad;
+} motor_current_pi_state_t;
+
+/**
+ * @brief Field-weakening runtime state (voltage mode).
+ *
+ */
+typedef struct {
+	int32_t ud_command_permyriad;          /* Negative Ud request, 0 below base speed. */
+	int32_t uq_limit_permyriad;            /* Uq left on the voltage circle at this Ud. */
+	int32_t voltage_magnitude_permyriad;   /* |(Ud, Uq)| of the latest speed step. */
+} motor_field_weakening_state_t;
+
+/**
+ * @brief Phase-advance runtime state (voltage mode).
+ *
+ */
+typedef struct {
+	int32_t advance_counts;                /* Electrical lead added to the FOC angle, signed with rotation. */
+} motor_lead_angle_state_t;
+
+/**
+ * @brief Cogging-compensation runtime state (voltage mode).
+ *
+ */
+typedef struct {
+	int32_t uq_correction_permyriad;       /* Uq feedforward at the latest actuation angle. */
+} motor_cogging_state_t;
+
+/**
+ * @brief Flux-observer runtime state (current mode).
+ *
+ */
+typedef struct {
+	uint16_t electrical_angle_u16;         /* Estimated rotor d-axis angle of the latest current sample. */
+	int32_t mechanical_speed_mrpm;         /* Estimated speed, control-positive like measured_mechanical_speed_mrpm. */
+	int32_t sensor_divergence_counts;      /* Estimated - measured electrical angle, wrapped to +-half turn. */
+	bool is_valid;                         /* Above the minimum speed with the angle PLL locked. */
+} motor_flux_observer_state_t;
+
+/**
+ * @brief Speed-trajectory reference state.
+ *
+ */
+typedef struct {
+	int32_t reference_mechanical_speed_mrpm;
+	int32_t reference_mechanical_acceleration_mrpm_per_s; /* Feedforward input for the speed loop. */
+	int32_t segment_target_mechanical_speed_mrpm;
+	uint8_t step_index;                                    /* 2 * segment + (holding ? 1 : 0), 0xFF = external points */
+	bool is_holding;                                       /* Reference settled on the segment target. */
+} motor_trajectory_state_t;
+
+/**
+ * @brief Position-loop runtime state.
+ *
+ */
+typedef struct {
+	int32_t target_position_counts;        /* Move end point, control-positive wrapping counts. */
+	int32_t reference_position_counts;     /* Integrated trajectory speed, snapped to the target at the end. */
+	int32_t measured_position_counts;
+	int32_t position_error_counts;         /* Reference - measured. */
+	int32_t speed_command_mrpm;            /* Speed-loop reference: trajectory speed + P + I, limited. */
+	bool is_in_position;                   /* Move finished, error inside the window for the settle time. */
+} motor_position_control_state_t;
+
 /**
  * @brief Reference speed-estimator runtime state.
  *
  */
 typedef struct {
-	uint64_t sample_timestamp_history_us[MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE];
-	int64_t cumulative_unwrapped_angle_history_counts[MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE];
 	uint16_t history_write_index;     /* Next write position; when full this also marks the oldest sample. */
 	uint16_t history_valid_count;     /* Number of valid samples currently stored in the ring buffer. */
 	uint16_t last_window_point_count;
 	uint16_t previous_raw_mechanical_angle_u16;
 	bool has_previous_raw_mechanical_angle;
 	int32_t last_mechanical_angle_delta_counts; /* Latest wrapped angle step between adjacent raw samples. */
-	uint64_t last_elapsed_time_us;
-	int64_t cumulative_unwrapped_mechanical_angle_counts;
+	uint32_t last_elapsed_time_us;
+	uint32_t cumulative_unwrapped_mechanical_angle_counts; /* Wrapping 32-bit count; only window differences are used. */
+	/* Incremental regression sums relative to the oldest retained sample (exact integer arithmetic). */
+	uint16_t regression_origin_index; /* History index of the oldest retained sample (x = 0, y = 0). */
+	uint16_t regression_point_count;
+	int64_t regression_sum_x_us;
+	int64_t regression_sum_y_counts;
+	int64_t regression_sum_xx_us2;
+	int64_t regression_sum_xy_us_counts;
 } motor_speed_reference_estimator_state_t;
 
 /**
@@ -131,13 +229,23 @@ typedef struct {
  *
  */
 typedef struct {
+	/* Hot: PWM-rate current loop / FOC apply and the 1 ms speed step. */
 	motor_measurements_t measurements;
-	motor_targets_t targets;
-	motor_limits_t limits;
 	motor_status_t status;
-	motor_openloop_state_t openloop;
-	motor_speed_feedback_state_t speed_feedback;
+	motor_limits_t limits;
+	motor_current_state_t current;
+	motor_current_pi_state_t current_pi;
 	motor_speed_pi_state_t speed_pi;
+	motor_field_weakening_state_t field_weakening;
+	motor_lead_angle_state_t lead_angle;
+	motor_cogging_state_t cogging;
+	motor_flux_observer_state_t flux_observer;
+	motor_speed_feedback_state_t speed_feedback;
+	motor_trajectory_state_t trajectory;
+	motor_position_control_state_t position_control;
+	/* Cold: startup, open loop and the diagnostic reference estimator. */
+	motor_targets_t targets;
+	motor_openloop_state_t openloop;
 	motor_speed_reference_estimator_state_t speed_reference_estimator;
 } motor_handle_t;
 
@@ -13,6 +13,20 @@
  * - start and stop the PWM output stage
  * - apply per-phase PWM duty values
  * - store the last applied duty values
+ * - select the zero-sequence modulation stage (sine, SVPWM, DPWM)
+ * - compensate the dead-time voltage error per phase
+ *
+ * The same compare values drive a 3-PWM board and a 6-PWM stage (TIM1
+ * complementary outputs); in 6-PWM 0% duty keeps the low side on.
+ *
+ * Dead-time compensation: for a phase current flowing out of the phase the
+ * dead time clamps the phase to the low rail, into it to the high rail. One
+ * dead time per PWM period is added back as dead_time / 2 compare ticks in
+ * the direction of the current, after the modulation stage. Phases at 0 or
+ * ARR do not switch and are not compensated.
+ *
+ * All three compare values go out in one grouped write (pwm_tim1_set_duty_abc()),
+ * so an update event never splits one duty vector across two PWM periods.
  *
  * @note Duty inputs use permyriad units (0..10000).
  */
@@ -21,12 +35,36 @@
 #include <stdbool.h>
 #include "drivers/pwm_tim1.h"
 
+/**
+ * @brief Zero-sequence modulation applied between inverse Clarke and duty synthesis.
+ *
+ */
+typedef enum {
+	MOTOR_3PWM_MODULATION_SINE = 0,		/**< pure sinusoidal phases, linear up to 86.6% of the bus line-to-line */
+	MOTOR_3PWM_MODULATION_SVPWM,		/**< min-max midpoint centring, linear up to 100% line-to-line */
+	MOTOR_3PWM_MODULATION_DPWM,			/**< largest-magnitude phase clamped to its rail (no switching for 120 deg per period) */
+} motor_3pwm_modulation_t;
+
+/**
+ * @brief Source of the per-phase current polarity used by dead-time compensation.
+ *
+ */
+typedef enum {
+	MOTOR_3PWM_DEAD_TIME_COMP_OFF = 0,
+	MOTOR_3PWM_DEAD_TIME_COMP_COMMAND,	/**< sign of the phase voltage command (no current feedback, lags the current at speed) */
+	MOTOR_3PWM_DEAD_TIME_COMP_CURRENT,	/**< sign of the measured phase currents (current-mode FOC) */
+} motor_3pwm_dead_time_comp_t;
+
 /**
  * @brief 3-PWM motor stage configuration.
  *
  */
 typedef struct {
 	pwm_tim1_handle_t *pwm_h;
+	motor_3pwm_modulation_t modulation;
+	motor_3pwm_dead_time_comp_t dead_time_comp;
+	uint32_t dead_time_comp_ns;			// 0 = TIM1 programmed dead time; set higher to cover driver switching delays
+	int32_t dead_time_comp_band;		// zero-crossing band without compensation (mA for CURRENT, permyriad for COMMAND)
 } motor_3pwm_cfg_t;
 
 /**
@@ -38,6 +76,14 @@ typedef struct {
 	uint16_t phase_a_duty_permyriad;
 	uint16_t phase_b_duty_permyriad;
 	uint16_t phase_c_duty_permyriad;
+	uint16_t phase_a_duty_ticks;		// last applied compare values (both duty paths)
+	uint16_t phase_b_duty_ticks;
+	uint16_t phase_c_duty_ticks;
+	uint16_t dead_time_comp_ticks;		// compare offset per phase (dead time / 2 in counter ticks)
+	uint64_t ticks_per_permyriad_q32;	// ARR / 10000 in Q32, rounded up: floor-exact for 0..10000
+	int8_t phase_a_polarity;			// -1 / 0 / +1, set by motor_3pwm_set_dead_time_polarity()
+	int8_t phase_b_polarity;
+	int8_t phase_c_polarity;
 	bool is_initialized;
 	bool is_started;
 } motor_3pwm_handle_t;
@@ -45,6 +91,8 @@ typedef struct {
 /**
  * @brief Initialize 3-PWM motor stage handle.
  *
+ * @pre TIM1 must be initialized (ARR, prescaler and dead time are read here).
+ *
  * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
  * @param motor_3pwm_cfg Pointer to 3-PWM motor stage configuration.
  * @return true if initialization succeeded, false otherwise.
@@ -60,6 +108,19 @@ bool motor_3pwm_init(motor_3pwm_handle_t *motor_3pwm_h,
  */
 bool motor_3pwm_start(motor_3pwm_handle_t *motor_3pwm_h);
 
+/**
+ * @brief Start several PWM output stages with staggered carriers.
+ *
+ * Stage i starts i/count of a half PWM period late (pwm_tim1_start_staggered()),
+ * so the switching edges of the stages do not coincide.
+ *
+ * @param motor_3pwm_hs Stage handles (not started, same PWM frequency).
+ * @param count Number of stages (1..PWM_TIM1_INSTANCE_COUNT).
+ * @param lock_prio BASEPRI level held across the counter enables.
+ * @return true if all stages started, false otherwise.
+ */
+bool motor_3pwm_start_staggered(motor_3pwm_handle_t *const motor_3pwm_hs[], uint8_t count, uint32_t lock_prio);
+
 /**
  * @brief Stop PWM output stage and clear phase duties.
  *
@@ -82,10 +143,63 @@ bool motor_3pwm_set_duty_abc(motor_3pwm_handle_t *motor_3pwm_h,
 							 uint16_t phase_b_duty_permyriad,
 							 uint16_t phase_c_duty_permyriad);
 
+/**
+ * @brief Apply per-phase duty values in timer ticks (direct TIM1 compare values).
+ *
+ * Used by the division-free FOC path; permyriad duty fields are left unchanged.
+ *
+ * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
+ * @param phase_a_duty_ticks Phase A duty in ticks (0..ARR).
+ * @param phase_b_duty_ticks Phase B duty in ticks (0..ARR).
+ * @param phase_c_duty_ticks Phase C duty in ticks (0..ARR).
+ * @return true if duty update succeeded, false otherwise.
+ */
+bool motor_3pwm_set_duty_ticks_abc(motor_3pwm_handle_t *motor_3pwm_h,
+								   uint16_t phase_a_duty_ticks,
+								   uint16_t phase_b_duty_ticks,
+								   uint16_t phase_c_duty_ticks);
+
+/**
+ * @brief Update the per-phase current polarity used by dead-time compensation.
+ *
+ * Values inside +/-cfg->dead_time_comp_band count as zero (no compensation),
+ * so measurement noise around a zero crossing does not toggle the offset.
+ * Applied by the next duty update. No effect with MOTOR_3PWM_DEAD_TIME_COMP_OFF.
+ *
+ * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
+ * @param phase_a Phase A polarity source (mA or permyriad, see cfg->dead_time_comp).
+ * @param phase_b Phase B polarity source.
+ * @param phase_c Phase C polarity source.
+ * @return true if applied, false if parameters invalid.
+ */
+bool motor_3pwm_set_dead_time_polarity(motor_3pwm_handle_t *motor_3pwm_h,
+									   int32_t phase_a,
+									   int32_t phase_b,
+									   int32_t phase_c);
+
+/**
+ * @brief Add the configured zero-sequence offset to three signed phase commands.
+ *
+ * Line-to-line voltages are unchanged. SINE leaves the phases untouched.
+ * Phases are in any signed scale where +/-rail maps to 100%/0% duty.
+ *
+ * @param modulation Modulation mode.
+ * @param rail Positive full-scale phase command.
+ * @param phase_a Pointer to phase A command (updated in place).
+ * @param phase_b Pointer to phase B command (updated in place).
+ * @param phase_c Pointer to phase C command (updated in place).
+ * @return true if applied, false if parameters invalid.
+ */
+bool motor_3pwm_apply_zero_sequence(motor_3pwm_modulation_t modulation,
+									int32_t rail,
+									int32_t *phase_a,
+									int32_t *phase_b,
+									int32_t *phase_c);
+
 /**
  * @brief Apply neutral output state to all three phases.
  *
- * Neutral is represented as 0% duty on phases A, B and C.
+ * Neutral is represented as 0% duty on phases A, B and C (no dead-time offset).
  *
  * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
  * @return true if neutral state update succeeded, false otherwise.
@@ -6,13 +6,15 @@
  * @brief Basic 6-step commutation state machine.
  *
  * This module provides a software-only 6-step sequence.
- * It does not drive PWM outputs yet.
+ * It does not drive PWM outputs yet; the hardware-timed mode (TIM1 COM
+ * events) lives in motor_6step_com and reuses the phase tables.
  *
  * Responsibilities:
  * - store 6-step state machine configuration
  * - track current commutation step
  * - advance step based on elapsed time
  * - provide current phase commutation map
+ * - provide the phase map of any step (shared commutation tables)
  */
 
 #include <stdint.h>
@@ -141,4 +143,13 @@ motor_6step_state_t motor_6step_get_state(const motor_6step_handle_t *motor_h);
  */
 motor_6step_phase_map_t motor_6step_get_phase_map(const motor_6step_handle_t *motor_h);
 
+/**
+ * @brief Get the phase commutation state of one step.
+ *
+ * @param step Commutation step (MOTOR_6STEP_STEP_1..6).
+ * @param dir Table direction.
+ * @return Phase map of the step. Invalid step returns all phases FLOAT.
+ */
+motor_6step_phase_map_t motor_6step_get_step_phase_map(motor_6step_step_t step, motor_6step_dir_t dir);
+
 #endif /* MOTOR_MOTOR_6STEP_H */
@@ -0,0 +1,160 @@
+#ifndef MOTOR_MOTOR_6STEP_COM_H
+#define MOTOR_MOTOR_6STEP_COM_H
+
+/**
+ * @file motor_6step_com.h
+ * @brief Hardware-timed 6-step commutation on TIM1 COM events.
+ *
+ * This module drives the trapezoidal sequence of motor_6step with the TIM1
+ * commutation mechanism: the next phase pattern (OCxM / CCxE / CCxNE) is
+ * preloaded and committed to all three channels at once by a COM event, so
+ * the switch instant no longer depends on main-loop timing.
+ *
+ * Responsibilities:
+ * - map rotor position to one of the six motor_6step CW patterns
+ * - preload the next pattern and commit it on a COM event
+ * - HALL trigger: Hall edge (EXTI) -> preload -> COMG
+ * - ANGLE trigger: extrapolate the angle sensor to the next sector boundary and
+ *   fire COM in hardware from a TIM5 compare (TRGO -> TIM1 ITR0)
+ * - low-speed / stale-sample fallback: sector tracking in motor_6step_com_service()
+ * - apply one signed duty command to the PWM phase of the pattern
+ *
+ * Pattern frame: pattern i drives the voltage vector at 120 deg - i * 60 deg
+ * in the project electrical frame (phase a = sin(theta)); it is selected while
+ * the torque vector (theta + 90 deg for a positive command, - 90 deg for a
+ * negative one) lies within +/-30 deg of it.
+ *
+ * Phase mapping: HIGH -> PWM mode 1 at the command duty, LOW -> forced
+ * inactive (low side on), FLOAT -> both outputs off. A real floating phase
+ * needs the 6-PWM output stage; on a 3-PWM stage FLOAT drives the input low
+ * (OSSR off-state), like LOW.
+ *
+ * @note The COM ISR, the Hall EXTI lines and cfg->lock_prio share one NVIC priority.
+ * @note The motor_3pwm stage must be started; this module only writes its duties.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "drivers/pwm_tim1.h"
+#include "drivers/tim5_timebase.h"
+#include "drivers/exti.h"
+#include "motor/motor_3pwm.h"
+
+#define MOTOR_6STEP_COM_PATTERN_COUNT		6u
+#define MOTOR_6STEP_COM_PATTERN_NONE		0xFFu	/* no valid pattern (invalid Hall code, not synchronised) */
+#define MOTOR_6STEP_COM_MAX_COMMAND_PERMYRIAD	10000
+
+/**
+ * @brief Source of the commutation instant.
+ *
+ */
+typedef enum {
+	MOTOR_6STEP_COM_TRIGGER_HALL = 0,	/**< Hall edge on EXTI, COM from software (COMG) in the EXTI ISR */
+	MOTOR_6STEP_COM_TRIGGER_ANGLE,		/**< computed TIM5 compare from the angle sensor, COM from TRGO in hardware */
+} motor_6step_com_trigger_t;
+
+/**
+ * @brief Rotor state for the ANGLE trigger.
+ *
+ */
+typedef struct {
+	uint16_t electrical_angle_u16;		// at capture
+	uint32_t capture_timestamp_us;		// tim5_timebase_now32() units
+	int32_t electrical_speed_cps;		// signed, full-turn uint16 counts per second
+} motor_6step_com_rotor_state_t;
+
+/**
+ * @brief Rotor state source (called from the COM ISR and the service).
+ *
+ * @return true if the state is valid.
+ */
+typedef bool (*motor_6step_com_get_rotor_state_t)(void *arg, motor_6step_com_rotor_state_t *rotor_state);
+
+/**
+ * @brief Hardware-timed 6-step configuration.
+ *
+ */
+typedef struct {
+	pwm_tim1_handle_t *pwm_h;
+	motor_3pwm_handle_t *motor_3pwm_h;
+	tim5_timebase_handle_t *timebase_h;			// ANGLE: compare source of the COM trigger
+	motor_6step_com_trigger_t trigger;
+	uint32_t lock_prio;							// COM ISR / Hall EXTI priority
+	/* HALL */
+	const exti_cfg_t *hall_exti_cfg[3];			// Hall A/B/C inputs (bit 0/1/2 of the Hall code)
+	uint8_t hall_to_pattern[8];					// Hall code -> pattern for a positive command (PATTERN_NONE if invalid)
+	/* ANGLE */
+	motor_6step_com_get_rotor_state_t get_rotor_state;
+	void *rotor_state_arg;
+	int32_t min_electrical_speed_cps;			// below: no compare schedule, service tracks the sector
+	uint32_t max_sample_age_us;					// sample older than this: no compare schedule
+	uint32_t min_lead_us;						// boundary closer than this: commit at once
+} motor_6step_com_cfg_t;
+
+/**
+ * @brief Hardware-timed 6-step runtime handle.
+ *
+ */
+typedef struct {
+	const motor_6step_com_cfg_t *cfg;
+	volatile int16_t command_permyriad;			// signed duty command
+	volatile uint8_t pending_pattern;			// preloaded, committed by the next COM event
+	volatile uint8_t active_pattern;			// committed by the last COM event
+	volatile bool is_schedule_armed;			// ANGLE: TIM5 compare armed for the pending pattern
+	volatile uint32_t scheduled_com_cnt;		// ANGLE: COM events armed on the TIM5 compare
+	volatile uint32_t late_com_cnt;				// ANGLE: boundary inside min_lead_us or compare missed, COMG instead
+	volatile uint32_t resync_com_cnt;			// pattern corrected by software (start, service, sign change)
+	volatile uint32_t hall_invalid_cnt;			// Hall codes without a pattern
+	bool is_initialized;
+	volatile bool is_running;
+} motor_6step_com_handle_t;
+
+/**
+ * @brief Initialize handle and, for the HALL trigger, the Hall EXTI lines.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @param motor_6step_com_cfg Pointer to 6-step COM configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_6step_com_init(motor_6step_com_handle_t *motor_6step_com_h,
+						  const motor_6step_com_cfg_t *motor_6step_com_cfg);
+
+/**
+ * @brief Enter TIM1 commutation mode and commit the pattern of the current rotor position.
+ *
+ * @pre motor_3pwm stage started.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @return true if started, false if parameters invalid or the rotor position is unknown.
+ */
+bool motor_6step_com_start(motor_6step_com_handle_t *motor_6step_com_h);
+
+/**
+ * @brief Leave commutation mode (PWM mode 1 on all channels) and apply neutral duties.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @return true if stopped, false if parameters invalid.
+ */
+bool motor_6step_com_stop(motor_6step_com_handle_t *motor_6step_com_h);
+
+/**
+ * @brief Set the signed duty command; the sign selects the torque direction.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @param command_permyriad Duty command (-10000..10000, clamped).
+ * @return true if applied, false if parameters invalid.
+ */
+bool motor_6step_com_set_command(motor_6step_com_handle_t *motor_6step_com_h, int16_t command_permyriad);
+
+/**
+ * @brief Main-loop sector check: commit the pattern of the current position if it differs.
+ *
+ * Covers start-up and low speed (ANGLE below min speed or stale sample), lost
+ * Hall edges and command sign changes. At speed the COM events already match.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @return true if serviced, false if parameters invalid or not running.
+ */
+bool motor_6step_com_service(motor_6step_com_handle_t *motor_6step_com_h);
+
+#endif /* MOTOR_MOTOR_6STEP_COM_H */
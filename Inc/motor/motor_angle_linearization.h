@@ -0,0 +1,119 @@
+#ifndef MOTOR_MOTOR_ANGLE_LINEARIZATION_H
+#define MOTOR_MOTOR_ANGLE_LINEARIZATION_H
+
+/**
+ * @file motor_angle_linearization.h
+ * @brief Constant-speed calibration of the periodic angle-sensor error.
+ *
+ * This module records sensor angle versus time while the speed loop holds
+ * a constant speed and builds one equidistant correction table over one
+ * mechanical turn (sensor nonlinearity, ADC gain / offset, magnet eccentricity).
+ *
+ * Responsibilities:
+ * - unwrap the published angle and wait for settle_time_ms of steady running
+ * - bin every sample by its measured angle around the nearest table point
+ * - after revolution_count turns, take the ideal angle as the straight line
+ *   from the first to the last sample: the two ends sit at the same measured
+ *   angle, so their periodic errors cancel in the slope
+ * - correction per point = -(mean error of its bin - mean over all bins)
+ *
+ * Per bin only three sums are kept (count, sum of unwrapped angle, sum of
+ * elapsed time), the ideal line is applied once at the end:
+ *   error_k = (sum_angle_k - sum_time_k * angle_end / time_end) / count_k
+ *
+ * Usage:
+ *   motor_angle_linearization_start(&h);
+ *   each consumed angle sample: motor_angle_linearization_update(&h, angle, capture_us);
+ *   when DONE: as5600_analog_set_linearization(&sensor_h, h.correction_counts, cfg.point_count);
+ *
+ * @note Real speed ripple (cogging, load) at the turn frequency is not
+ *       separable from sensor error; use a low-ripple speed and enough inertia.
+ * @note The table is zero-mean: it does not move the average angle, the
+ *       electrical offset only shifts by the correction at the alignment angle.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_ANGLE_LINEARIZATION_MAX_POINTS    32u
+
+/**
+ * @brief Calibration state.
+ *
+ */
+typedef enum {
+	MOTOR_ANGLE_LINEARIZATION_STATE_IDLE = 0,
+	MOTOR_ANGLE_LINEARIZATION_STATE_SETTLING,
+	MOTOR_ANGLE_LINEARIZATION_STATE_RECORDING,
+	MOTOR_ANGLE_LINEARIZATION_STATE_DONE,
+	MOTOR_ANGLE_LINEARIZATION_STATE_FAILED,  /* Timeout, too few samples in a bin or a sample jump. */
+} motor_angle_linearization_state_t;
+
+/**
+ * @brief Calibration configuration.
+ *
+ */
+typedef struct {
+	uint8_t point_count;                     /* Power of two 2..MOTOR_ANGLE_LINEARIZATION_MAX_POINTS. */
+	uint8_t revolution_count;                /* Recorded mechanical turns. */
+	uint16_t settle_time_ms;                 /* Ignored running time after start. */
+	uint32_t timeout_ms;                     /* Recording longer than this => FAILED (stalled motor). */
+	uint16_t min_samples_per_point;          /* Fewer samples in any bin => FAILED. */
+	uint16_t max_delta_per_sample_counts;    /* Larger jump between two samples => FAILED. */
+} motor_angle_linearization_cfg_t;
+
+/**
+ * @brief Calibration runtime handle.
+ *
+ */
+typedef struct {
+	const motor_angle_linearization_cfg_t *cfg;
+	motor_angle_linearization_state_t state;
+	uint8_t point_shift;                     /* 16 - log2(point_count). */
+	uint64_t start_timestamp_us;             /* Start of settling, then of recording. */
+	uint16_t last_angle_u16;
+	int32_t unwrapped_angle_counts;          /* Relative to the first recorded sample. */
+	/* Per-bin sums, bin k collects measured angles within half a segment of point k. */
+	uint32_t bin_sample_count[MOTOR_ANGLE_LINEARIZATION_MAX_POINTS];
+	int64_t bin_angle_sum_counts[MOTOR_ANGLE_LINEARIZATION_MAX_POINTS];
+	int64_t bin_elapsed_sum_us[MOTOR_ANGLE_LINEARIZATION_MAX_POINTS];
+	/* Result, valid once DONE. */
+	int16_t correction_counts[MOTOR_ANGLE_LINEARIZATION_MAX_POINTS];
+	uint16_t peak_to_peak_error_counts;      /* Removed error, before correction. */
+	uint32_t recorded_sample_count;
+	bool is_initialized;
+} motor_angle_linearization_handle_t;
+
+/**
+ * @brief Initialize calibration handle.
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param motor_angle_linearization_cfg Pointer to calibration configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_angle_linearization_init(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									const motor_angle_linearization_cfg_t *motor_angle_linearization_cfg);
+
+/**
+ * @brief Start settling; recording begins with the first sample after settle_time_ms.
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param now_us Current time in microseconds.
+ * @return true if started, false otherwise.
+ */
+bool motor_angle_linearization_start(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									 uint64_t now_us);
+
+/**
+ * @brief Add one published angle sample (uncorrected sensor angle).
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param mechanical_angle_u16 Published mechanical angle.
+ * @param capture_timestamp_us Sample capture instant.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_angle_linearization_update(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									  uint16_t mechanical_angle_u16,
+									  uint64_t capture_timestamp_us);
+
+#endif /* MOTOR_MOTOR_ANGLE_LINEARIZATION_H */
@@ -0,0 +1,140 @@
+#ifndef MOTOR_MOTOR_COGGING_COMPENSATION_H
+#define MOTOR_MOTOR_COGGING_COMPENSATION_H
+
+/**
+ * @file motor_cogging_compensation.h
+ * @brief Angle-indexed Uq feedforward against cogging torque, learned online (voltage-mode FOC).
+ *
+ * Cogging torque repeats with the mechanical angle, so at a held speed the
+ * speed PI output carries the same ripple every revolution. This module
+ * learns that ripple into one equidistant table over one mechanical turn
+ * and adds it to the applied Uq, so the PI no longer has to chase it.
+ *
+ * Responsibilities:
+ * - learn while the caller reports steady speed (one call per speed step):
+ *   residual = PI command - its mean over the previous full turn,
+ *   table[bin(angle - delay)] += learning_gain * residual
+ * - keep the table zero-mean once per turn (the PI keeps the average torque)
+ * - interpolate the correction at the actuation angle and publish it
+ * - load / export the table in permyriad (calibration record)
+ *
+ * The PI output reacts to a cogging step after the closed-loop delay, so the
+ * residual is credited to the angle the rotor had learning_delay_us earlier
+ * (taken from the angle step per speed step, no direction setting needed).
+ *
+ * Usage:
+ *   speed step, steady:     motor_cogging_compensation_learn(&h, angle, Uq)
+ *   speed step, not steady: motor_cogging_compensation_learn_stop(&h)
+ *   actuation:              motor_cogging_compensation_apply(&h, angle)
+ *                           Uq applied = Uq + motor_h->cogging.uq_correction_permyriad
+ *
+ * @note Angles use full-turn uint16 mechanical counts (sensor angle).
+ * @note The learned table is internal Q8 permyriad; the export rounds to permyriad.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+#define MOTOR_COGGING_COMPENSATION_MAX_POINTS     64u
+
+/**
+ * @brief Cogging-compensation configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint8_t point_count;                    /* Power of two 2..MOTOR_COGGING_COMPENSATION_MAX_POINTS. */
+	uint16_t update_period_ms;              /* Speed-step period the learning runs at. */
+	int32_t learning_gain_q15;              /* Share of the residual added to its bin per sample, 0 < gain <= 1.0. */
+	uint32_t learning_delay_us;             /* Speed-loop delay between the cogging torque and the PI reaction. */
+	uint16_t max_correction_permyriad;      /* Clamp of every table entry. */
+	uint16_t max_delta_per_step_counts;     /* Larger angle step per speed step => learning restarts its turn. */
+} motor_cogging_compensation_cfg_t;
+
+/**
+ * @brief Cogging-compensation runtime handle.
+ *
+ */
+typedef struct {
+	const motor_cogging_compensation_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	uint8_t point_shift;                    /* 16 - log2(point_count). */
+	int32_t correction_q8[MOTOR_COGGING_COMPENSATION_MAX_POINTS]; /* Uq correction per point, permyriad Q8. */
+	/* Learning over full turns. */
+	bool has_previous_angle;
+	uint16_t previous_angle_u16;
+	uint32_t turn_travel_counts;            /* |angle travelled| in the current turn. */
+	int64_t turn_uq_sum_permyriad;
+	uint32_t turn_sample_count;
+	bool has_turn_mean;
+	int32_t turn_mean_uq_permyriad;         /* Mean PI command of the previous full turn. */
+	uint32_t learned_revolution_count;      /* Turns with table updates since init / set_table. */
+	bool is_initialized;
+} motor_cogging_compensation_handle_t;
+
+/**
+ * @brief Initialize cogging-compensation handle with an empty table.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param motor_cogging_compensation_cfg Pointer to cogging-compensation configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_cogging_compensation_init(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									 const motor_cogging_compensation_cfg_t *motor_cogging_compensation_cfg);
+
+/**
+ * @brief Run one learning step at steady speed.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param mechanical_angle_u16 Mechanical angle of this speed step.
+ * @param uq_command_permyriad Speed-PI command of this speed step (without the correction).
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_cogging_compensation_learn(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									  uint16_t mechanical_angle_u16,
+									  int32_t uq_command_permyriad);
+
+/**
+ * @brief End the current learning turn (speed not steady); the table is kept.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @return true if stopped, false otherwise.
+ */
+bool motor_cogging_compensation_learn_stop(motor_cogging_compensation_handle_t *motor_cogging_compensation_h);
+
+/**
+ * @brief Publish the interpolated correction at one mechanical angle.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param mechanical_angle_u16 Mechanical angle of the actuation.
+ * @return true if published, false otherwise.
+ */
+bool motor_cogging_compensation_apply(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									  uint16_t mechanical_angle_u16);
+
+/**
+ * @brief Load one table in permyriad (stored calibration); learning continues from it.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param correction_permyriad Correction per equidistant point.
+ * @param point_count Number of points, must equal the configured point_count.
+ * @return true if loaded, false otherwise.
+ */
+bool motor_cogging_compensation_set_table(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+										  const int16_t *correction_permyriad,
+										  uint8_t point_count);
+
+/**
+ * @brief Export the learned table in permyriad.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param correction_permyriad Output correction per point (point_count entries).
+ * @param capacity Number of entries correction_permyriad can hold.
+ * @return true if exported, false otherwise.
+ */
+bool motor_cogging_compensation_get_table(const motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+										  int16_t *correction_permyriad,
+										  uint8_t capacity);
+
+#endif /* MOTOR_MOTOR_COGGING_COMPENSATION_H */
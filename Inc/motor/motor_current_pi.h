@@ -0,0 +1,88 @@
+#ifndef MOTOR_MOTOR_CURRENT_PI_H
+#define MOTOR_MOTOR_CURRENT_PI_H
+
+/**
+ * @file motor_current_pi.h
+ * @brief Digital d/q current PI controllers with cross-coupling decoupling.
+ *
+ * This module computes rotor-frame voltage requests (Ud, Uq) from d/q current
+ * references and the measured d/q currents for current-mode FOC.
+ *
+ * Responsibilities:
+ * - store PI configuration and runtime state for both axes
+ * - compute one discrete PI update per current-sample sequence
+ * - add the speed-dependent decoupling terms -we*L*iq and +we*L*id
+ * - apply output saturation and conditional-integration anti-windup
+ * - publish Ud/Uq commands for motor_foc_voltage_apply_dq()
+ *
+ * @note Currents use signed mA units, voltage commands signed permyriad of half bus.
+ * @note Integrators keep Q15 permyriad resolution so small errors still integrate
+ *       at the PWM rate.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+/**
+ * @brief Current PI configuration (same gains on both axes).
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	int32_t kp_q15;                    /* Proportional gain in Q15 (permyriad per mA). */
+	int32_t ki_per_s_q15;              /* Integral gain in Q15 per second (permyriad per mA per second). */
+	uint16_t update_period_us;
+	uint16_t output_limit_permyriad;   /* Per-axis Ud/Uq limit. */
+	uint32_t phase_inductance_uh;      /* Ld = Lq per phase, 0 disables decoupling. */
+	uint32_t bus_voltage_mv;           /* 10000 permyriad = bus_voltage_mv / 2 phase peak. */
+	int8_t speed_direction_sign;       /* Maps measured speed onto the d/q frame rate (q leading d). */
+} motor_current_pi_cfg_t;
+
+/**
+ * @brief Current PI runtime handle.
+ *
+ */
+typedef struct {
+	const motor_current_pi_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	int32_t ki_dt_q15;
+	int64_t decoupling_scale_q48;      /* pole_pairs * L / Vbus in permyriad per (mrpm * mA), Q48. */
+	int32_t id_integrator_q15;         /* Integrator in permyriad, Q15. */
+	int32_t iq_integrator_q15;
+	bool is_initialized;
+} motor_current_pi_handle_t;
+
+/**
+ * @brief Initialize current PI handle.
+ *
+ * @param motor_current_pi_h Pointer to current PI handle.
+ * @param motor_current_pi_cfg Pointer to current PI configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_current_pi_init(motor_current_pi_handle_t *motor_current_pi_h,
+						   const motor_current_pi_cfg_t *motor_current_pi_cfg);
+
+/**
+ * @brief Reset current PI integrators and output state.
+ *
+ * @param motor_current_pi_h Pointer to current PI handle.
+ * @return true if reset succeeded, false otherwise.
+ */
+bool motor_current_pi_reset(motor_current_pi_handle_t *motor_current_pi_h);
+
+/**
+ * @brief Run one discrete d/q current PI update on the published d/q currents.
+ *
+ * The decoupling terms use the measured mechanical speed when it is valid.
+ *
+ * @param motor_current_pi_h Pointer to current PI handle.
+ * @param id_reference_ma D-axis current reference in mA.
+ * @param iq_reference_ma Q-axis current reference in mA.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_current_pi_update(motor_current_pi_handle_t *motor_current_pi_h,
+							 int32_t id_reference_ma,
+							 int32_t iq_reference_ma);
+
+#endif /* MOTOR_MOTOR_CURRENT_PI_H */
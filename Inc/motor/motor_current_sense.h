@@ -0,0 +1,108 @@
+#ifndef MOTOR_MOTOR_CURRENT_SENSE_H
+#define MOTOR_MOTOR_CURRENT_SENSE_H
+
+/**
+ * @file motor_current_sense.h
+ * @brief Phase-current reconstruction from low-side shunt samples.
+ *
+ * This module turns one injected ADC sequence (two or three shunt channels,
+ * sampled at the PWM counter peak) into rotor-frame d/q currents.
+ *
+ * Responsibilities:
+ * - calibrate per-channel zero-current offsets with the power stage disabled
+ * - convert raw samples into signed phase currents
+ * - apply the Clarke transform (two- or three-shunt form)
+ * - apply the Park transform on the measured electrical angle
+ * - publish phase, alpha/beta and d/q currents into shared motor state
+ *
+ * @note Currents use signed milliampere units, positive into the motor phase.
+ * @note The d/q basis matches motor_foc_voltage_apply_dq() (same sin/cos basis
+ *       and phase-sequence sign), so a positive Uq drives a positive Iq.
+ * @note process() runs in the ADC interrupt; calibration is driven from the same path.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+#define MOTOR_CURRENT_SENSE_MAX_SHUNTS   3u
+
+/**
+ * @brief Current-sense configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint8_t shunt_count;                       /* 2 => phases A/B (C = -A-B), 3 => phases A/B/C. */
+	int32_t ma_per_count_q16;                  /* Shunt + amplifier + ADC gain in mA per count, Q16. */
+	int8_t current_sign;                       /* +1 if a higher ADC reading means current into the phase. */
+	int8_t phase_sequence_sign;                /* Same sign as motor_foc_voltage_cfg_t::phase_sequence_sign. */
+	uint16_t calibration_sample_count;         /* Sequences averaged per offset calibration. */
+	uint16_t nominal_offset_counts;            /* Expected zero-current reading (amplifier mid-rail). */
+	uint16_t max_offset_deviation_counts;      /* Calibration fails outside nominal +/- this window. */
+} motor_current_sense_cfg_t;
+
+/**
+ * @brief Current-sense runtime handle.
+ *
+ */
+typedef struct {
+	const motor_current_sense_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	uint16_t offset_counts[MOTOR_CURRENT_SENSE_MAX_SHUNTS];
+	uint32_t calibration_sum_counts[MOTOR_CURRENT_SENSE_MAX_SHUNTS];
+	volatile uint16_t calibration_remaining; /* Sequences still to average, 0 when idle. */
+	volatile bool is_calibrated;
+	volatile bool calibration_failed;
+	bool is_initialized;
+} motor_current_sense_handle_t;
+
+/**
+ * @brief Initialize current-sense handle.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @param motor_current_sense_cfg Pointer to current-sense configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_current_sense_init(motor_current_sense_handle_t *motor_current_sense_h,
+							  const motor_current_sense_cfg_t *motor_current_sense_cfg);
+
+/**
+ * @brief Start one offset calibration over the next calibration_sample_count sequences.
+ *
+ * @pre The power stage must be disabled (no phase current) while calibrating.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @return true if calibration was started, false otherwise.
+ */
+bool motor_current_sense_start_calibration(motor_current_sense_handle_t *motor_current_sense_h);
+
+/**
+ * @brief Return whether valid offsets are available.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @return true after one successful calibration, false otherwise.
+ */
+bool motor_current_sense_is_calibrated(const motor_current_sense_handle_t *motor_current_sense_h);
+
+/**
+ * @brief Process one injected sequence: calibrate, or publish phase and alpha/beta currents.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @param samples Raw ADC results in phase order A, B(, C).
+ * @param sample_count Number of raw results (must equal shunt_count).
+ * @return true if currents were published, false while calibrating or on invalid input.
+ */
+bool motor_current_sense_process(motor_current_sense_handle_t *motor_current_sense_h,
+								 const uint16_t *samples,
+								 uint8_t sample_count);
+
+/**
+ * @brief Rotate the latest alpha/beta currents into d/q on the measured electrical angle.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @return true if d/q currents were published, false otherwise.
+ */
+bool motor_current_sense_update_dq(motor_current_sense_handle_t *motor_current_sense_h);
+
+#endif /* MOTOR_MOTOR_CURRENT_SENSE_H */
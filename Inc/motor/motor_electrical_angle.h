@@ -13,8 +13,13 @@
  * - connect to shared motor-domain state
  * - convert measured mechanical angle into measured electrical angle
  * - apply one configurable electrical offset
+ * - optionally extrapolate the angle over a prediction horizon with measured speed
  * - update shared measured electrical-angle state
  *
+ * Prediction: the horizon is the time from the sample capture instant to
+ * the middle of the PWM interval in which the resulting duties are active
+ * (sample age + actuation delay). theta_e += speed * pole_pairs * horizon.
+ *
  * @note Mechanical and electrical angles use full-turn uint16 units.
  */
 
@@ -29,6 +34,8 @@
 typedef struct {
 	motor_handle_t *motor_h;
 	uint16_t electrical_offset_u16;
+	int8_t speed_direction_sign;        /* Maps measured_mechanical_speed_mrpm onto the sensor angle direction (+1 or -1). */
+	uint32_t max_prediction_horizon_us; /* Prediction horizon clamp (0 disables extrapolation). */
 } motor_electrical_angle_cfg_t;
 
 /**
@@ -39,6 +46,8 @@ typedef struct {
 	const motor_electrical_angle_cfg_t *cfg;
 	motor_handle_t *motor_h;
 	uint16_t electrical_offset_u16;
+	uint32_t electrical_counts_per_mrpm_us_q32; /* pole_pairs * 65536 / 60e9, Q32 */
+	int32_t last_prediction_counts;     /* Electrical advance applied by the latest predicted update. */
 	bool is_initialized;
 } motor_electrical_angle_handle_t;
 
@@ -62,6 +71,21 @@ bool motor_electrical_angle_init(motor_electrical_angle_handle_t *motor_electric
 bool motor_electrical_angle_update(motor_electrical_angle_handle_t *motor_electrical_angle_h,
 								   uint16_t mechanical_angle_u16);
 
+/**
+ * @brief Update measured electrical angle extrapolated over one prediction horizon.
+ *
+ * Uses the shared measured mechanical speed; without valid speed the
+ * angle is published unextrapolated.
+ *
+ * @param motor_electrical_angle_h Pointer to electrical-angle handle.
+ * @param mechanical_angle_u16 Measured mechanical angle in full-turn uint16 units.
+ * @param prediction_horizon_us Sample capture instant -> target instant, clamped to max_prediction_horizon_us.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_electrical_angle_update_predicted(motor_electrical_angle_handle_t *motor_electrical_angle_h,
+											 uint16_t mechanical_angle_u16,
+											 uint32_t prediction_horizon_us);
+
 /**
  * @brief Compute raw electrical angle from one measured mechanical angle sample.
  *
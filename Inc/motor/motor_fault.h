@@ -0,0 +1,196 @@
+#ifndef MOTOR_MOTOR_FAULT_H
+#define MOTOR_MOTOR_FAULT_H
+
+/**
+ * @file motor_fault.h
+ * @brief Latched motor fault with hardware shutdown and one snapshot record.
+ *
+ * This module turns control-path checks into one latched fault code. The
+ * first fault wins: it drops the gate-driver enable, triggers a TIM1 break
+ * (MOE cleared in hardware, outputs go to their configured off state) and
+ * records a snapshot of the shared motor state for later readout.
+ *
+ * Responsibilities:
+ * - latch the first fault code from any context (ISR or main loop)
+ * - shut the power stage down through the TIM1 break path
+ * - latch BKIN breaks (external comparator / driver nFAULT) as faults
+ * - check angle plausibility, sample starvation and over-speed per control step
+ * - keep one snapshot record of the state at the fault instant
+ *
+ * Usage:
+ *   motor_fault_check_angle_sample() / motor_fault_check_speed() in the control loop,
+ *   motor_fault_raise() for other detected faults, motor_fault_is_latched() in the
+ *   main loop, then motor_fault_get_snapshot() for the report.
+ *
+ * @note The check functions keep state and must run in one context (the control loop).
+ * @note motor_fault_raise() is ISR-safe; the snapshot is taken by the context that
+ *       latched the fault and may mix values of two control steps.
+ * @note This module registers the break callback of cfg->pwm_h.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+#include "drivers/pwm_tim1.h"
+#include "drivers/gpio.h"
+
+/**
+ * @brief Fault code (values are sent in the fault record).
+ *
+ */
+typedef enum {
+	MOTOR_FAULT_CODE_NONE = 0,
+	MOTOR_FAULT_CODE_BREAK_INPUT,        /* TIM1 BKIN asserted, detail 0. */
+	MOTOR_FAULT_CODE_ANGLE_IMPLAUSIBLE,  /* detail = |step| counts between two samples. */
+	MOTOR_FAULT_CODE_SAMPLE_STARVATION,  /* detail = age of the latest sample in us. */
+	MOTOR_FAULT_CODE_OVER_SPEED,         /* detail = |filtered speed| mrpm. */
+	MOTOR_FAULT_CODE_DEADLINE_MISSED,    /* detail = caller-defined overrun measure. */
+	MOTOR_FAULT_CODE_CONTROL_LOOP,       /* A control kernel rejected its inputs, detail caller-defined. */
+	MOTOR_FAULT_CODE_SPEED_ERROR,        /* detail = |speed error| mrpm. */
+	MOTOR_FAULT_CODE_COUNT,
+} motor_fault_code_t;
+
+/**
+ * @brief State captured when the fault latched.
+ *
+ */
+typedef struct {
+	motor_fault_code_t code;
+	uint32_t detail;
+	uint64_t timestamp_us;
+	uint16_t mechanical_angle_u16;
+	uint16_t electrical_angle_u16;
+	int32_t filtered_mechanical_speed_mrpm;
+	int32_t uq_command_permyriad;
+	int32_t id_ma;
+	int32_t iq_ma;
+} motor_fault_snapshot_t;
+
+/**
+ * @brief Fault configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;                   /* Snapshot source. */
+	pwm_tim1_handle_t *pwm_h;                  /* Stage shut down with a TIM1 break. */
+	const gpio_pin_cfg_t *enable_pin_cfg;      /* Gate-driver enable, driven low on a fault (NULL if none). */
+	uint64_t (*get_time_us)(void);             /* Snapshot timestamp source. */
+	uint32_t max_sample_age_us;                /* Starvation limit for the latest angle sample, 0 disables. */
+	int32_t max_abs_mechanical_speed_mrpm;     /* Over-speed limit, also bounds the plausible angle step; 0 disables. */
+	uint16_t angle_step_margin_counts;         /* Sensor noise allowance on top of the speed-bounded step. */
+} motor_fault_cfg_t;
+
+/**
+ * @brief Fault runtime handle.
+ *
+ */
+typedef struct {
+	const motor_fault_cfg_t *cfg;
+	volatile uint32_t latched_code;            /* motor_fault_code_t, NONE until the first fault. */
+	volatile bool snapshot_valid;              /* Set after the winner wrote the snapshot. */
+	motor_fault_snapshot_t snapshot;
+	uint32_t max_step_counts_per_us_q16;       /* Angle step bound per us of sample spacing. */
+	volatile bool angle_history_reset_request; /* Next sample starts a new plausibility history. */
+	bool has_angle_history;
+	uint16_t last_mechanical_angle_u16;
+	uint64_t last_capture_timestamp_us;
+	bool is_initialized;
+} motor_fault_handle_t;
+
+/**
+ * @brief Initialize fault handle and hook the TIM1 break callback.
+ *
+ * A break that already latched before init is taken over as BREAK_INPUT.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param motor_fault_cfg Pointer to fault configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_fault_init(motor_fault_handle_t *motor_fault_h, const motor_fault_cfg_t *motor_fault_cfg);
+
+/**
+ * @brief Latch one fault and shut the power stage down (first fault wins).
+ *
+ * Safe from any interrupt priority. Later faults only keep the stage off.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param code Fault code (not NONE).
+ * @param detail Code-specific value stored in the snapshot.
+ */
+void motor_fault_raise(motor_fault_handle_t *motor_fault_h, motor_fault_code_t code, uint32_t detail);
+
+/**
+ * @brief Classify one angle sample without raising (e.g. to hand over to a fallback angle).
+ *
+ * Same checks as motor_fault_check_angle_sample(); a plausible new sample
+ * enters the step history, an implausible one does not.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param mechanical_angle_u16 Sample angle.
+ * @param capture_timestamp_us Sample instant.
+ * @param now_us Current time.
+ * @param code Output fault code the sample would raise (MOTOR_FAULT_CODE_NONE if plausible).
+ * @param detail Output fault detail.
+ * @return true if the sample is plausible, false otherwise or if parameters invalid.
+ */
+bool motor_fault_classify_angle_sample(motor_fault_handle_t *motor_fault_h,
+									   uint16_t mechanical_angle_u16,
+									   uint64_t capture_timestamp_us,
+									   uint64_t now_us,
+									   motor_fault_code_t *code,
+									   uint32_t *detail);
+
+/**
+ * @brief Check one angle sample for plausibility and starvation.
+ *
+ * A new sample (capture time moved) must not step further than the
+ * over-speed limit allows over the sample spacing plus the noise margin;
+ * the latest sample must not be older than max_sample_age_us.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param mechanical_angle_u16 Sample angle.
+ * @param capture_timestamp_us Sample instant.
+ * @param now_us Current time.
+ * @return true if no fault is latched, false otherwise.
+ */
+bool motor_fault_check_angle_sample(motor_fault_handle_t *motor_fault_h,
+									uint16_t mechanical_angle_u16,
+									uint64_t capture_timestamp_us,
+									uint64_t now_us);
+
+/**
+ * @brief Check the filtered speed against the over-speed limit.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @return true if no fault is latched, false otherwise.
+ */
+bool motor_fault_check_speed(motor_fault_handle_t *motor_fault_h);
+
+/**
+ * @brief Restart the angle plausibility history (sensor remapped, e.g. new linearization table).
+ *
+ * Safe from any context; applied by the next motor_fault_check_angle_sample().
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @return true if applied, false if parameters invalid.
+ */
+bool motor_fault_reset_angle_history(motor_fault_handle_t *motor_fault_h);
+
+/**
+ * @brief Check whether a fault is latched.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @return true if latched, false otherwise or if parameters invalid.
+ */
+bool motor_fault_is_latched(const motor_fault_handle_t *motor_fault_h);
+
+/**
+ * @brief Copy the snapshot record of the latched fault.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param snapshot Pointer to output record.
+ * @return true if a complete record was copied, false otherwise.
+ */
+bool motor_fault_get_snapshot(const motor_fault_handle_t *motor_fault_h, motor_fault_snapshot_t *snapshot);
+
+#endif /* MOTOR_MOTOR_FAULT_H */
@@ -0,0 +1,89 @@
+#ifndef MOTOR_MOTOR_FIELD_WEAKENING_H
+#define MOTOR_MOTOR_FIELD_WEAKENING_H
+
+/**
+ * @file motor_field_weakening.h
+ * @brief Voltage-magnitude field weakening with a negative Ud reference (voltage-mode FOC).
+ *
+ * Above base speed the back-EMF uses up the voltage the speed PI can apply,
+ * the Uq command saturates and the speed stops rising. This module regulates
+ * a negative Ud that keeps the voltage vector |(Ud, Uq)| at a target just
+ * inside the modulation limit, and hands the speed PI the Uq left on the
+ * circle at that Ud.
+ *
+ * Responsibilities:
+ * - measure |(Ud, Uq)| of the latest command each speed step
+ * - integrate (target - |U|) into Ud, clamped to [-max_ud, 0]
+ * - relax Ud back to 0 below the minimum speed (no weakening in low-speed transients)
+ * - publish Ud and the remaining Uq limit sqrt(limit^2 - Ud^2)
+ *
+ * Speed PI interplay (one speed step):
+ *   motor_speed_pi_update()  -> Uq within the active limit
+ *   motor_field_weakening_update(Uq)  -> Ud, Uq limit
+ *   motor_speed_pi_set_output_limit(Uq limit)  -> integrator clamped, next step sees the circle
+ *
+ * @note Voltages are signed permyriad of half bus, like motor_foc_voltage_apply_dq().
+ * @note The Ud integrator keeps Q15 permyriad resolution so small errors still integrate at 1 ms.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+/**
+ * @brief Field-weakening configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint16_t update_period_ms;          /* Speed-step period the regulator runs at. */
+	uint16_t voltage_limit_permyriad;   /* Voltage circle radius: |(Ud, Uq)| bound. */
+	uint16_t voltage_target_permyriad;  /* Regulated |(Ud, Uq)|, < limit (headroom for the speed loop). */
+	uint16_t max_ud_permyriad;          /* Deepest negative Ud, < limit. */
+	int32_t ki_per_s_q15;               /* Ud permyriad per permyriad of voltage error per second, Q15. */
+	uint32_t min_speed_mrpm;            /* |speed| below this => Ud relaxes to 0. */
+} motor_field_weakening_cfg_t;
+
+/**
+ * @brief Field-weakening runtime handle.
+ *
+ */
+typedef struct {
+	const motor_field_weakening_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	int32_t ki_dt_q15;
+	int32_t ud_integrator_q15;          /* Ud in permyriad, Q15, <= 0. */
+	bool is_initialized;
+} motor_field_weakening_handle_t;
+
+/**
+ * @brief Initialize field-weakening handle.
+ *
+ * @param motor_field_weakening_h Pointer to field-weakening handle.
+ * @param motor_field_weakening_cfg Pointer to field-weakening configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_field_weakening_init(motor_field_weakening_handle_t *motor_field_weakening_h,
+								const motor_field_weakening_cfg_t *motor_field_weakening_cfg);
+
+/**
+ * @brief Reset Ud to 0 and the Uq limit to the full circle.
+ *
+ * @param motor_field_weakening_h Pointer to field-weakening handle.
+ * @return true if reset succeeded, false otherwise.
+ */
+bool motor_field_weakening_reset(motor_field_weakening_handle_t *motor_field_weakening_h);
+
+/**
+ * @brief Run one regulator step on the latest speed-PI command.
+ *
+ * @param motor_field_weakening_h Pointer to field-weakening handle.
+ * @param uq_command_permyriad Uq command of this speed step.
+ * @param measured_mechanical_speed_mrpm Measured mechanical speed in mrpm.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_field_weakening_update(motor_field_weakening_handle_t *motor_field_weakening_h,
+								  int32_t uq_command_permyriad,
+								  int32_t measured_mechanical_speed_mrpm);
+
+#endif /* MOTOR_MOTOR_FIELD_WEAKENING_H */
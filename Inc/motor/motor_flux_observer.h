@@ -0,0 +1,136 @@
+#ifndef MOTOR_MOTOR_FLUX_OBSERVER_H
+#define MOTOR_MOTOR_FLUX_OBSERVER_H
+
+/**
+ * @file motor_flux_observer.h
+ * @brief Sensorless rotor-angle and speed estimate from the phase voltages and currents (current mode).
+ *
+ * Nonlinear flux observer: the stator flux is the integral of the back-EMF
+ * v - R i in the stationary frame, the rotor magnet flux is that minus L i,
+ * and its length is pulled towards the known magnet flux linkage lambda so
+ * the open integrator neither drifts nor needs a high-pass filter:
+ *
+ *   dx/dt = v - R i + k (lambda^2 - |eta|^2) / lambda^2 * eta,  eta = x - L i
+ *   theta = angle of eta (d axis),  PLL on theta -> smoothed angle and speed
+ *
+ * Responsibilities:
+ * - rebuild the applied alpha/beta voltage from the d/q command and angle of
+ *   the last actuation (same basis as motor_foc_voltage_apply_dq())
+ * - integrate the flux once per current sample and publish the PLL angle,
+ *   the control-positive mechanical speed and the divergence from the
+ *   measured electrical angle
+ * - flag the estimate valid above min_speed_mrpm once the PLL is locked
+ *
+ * Usage (current-loop ISR):
+ *   motor_flux_observer_update(&h)                       after the current sample
+ *   motor_flux_observer_set_voltage(&h, ud, uq, angle)   after the actuation
+ *
+ * @note Below a few percent of rated speed the back-EMF sinks into the R and
+ *       voltage errors: the estimate is only used above min_speed_mrpm.
+ * @note The applied voltage is the command (dead time and bus ripple are not
+ *       measured); the divergence shows the resulting angle error.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+/**
+ * @brief Flux-observer configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint16_t update_period_us;                 /* Current-sample period, one update per sample. */
+	uint32_t phase_resistance_mohm;
+	uint32_t phase_inductance_uh;
+	uint32_t flux_linkage_uwb;                 /* Peak phase magnet flux linkage lambda. */
+	int32_t voltage_mv_per_permyriad_q16;      /* Phase voltage per alpha/beta permyriad (bus / 20000, x 2/sqrt(3) in SVPWM). */
+	int8_t phase_sequence_sign;                /* Same sign as motor_foc_voltage_cfg_t::phase_sequence_sign. */
+	int8_t speed_direction_sign;               /* Control-positive speed = sign x d(theta_e)/dt / pole_pairs. */
+	uint32_t flux_gain_per_s;                  /* Convergence rate k of the flux length. */
+	uint16_t pll_bandwidth_hz;                 /* Angle PLL natural frequency (critically damped). */
+	uint32_t min_speed_mrpm;                   /* |speed| below => estimate not valid. */
+	uint16_t max_pll_error_counts;             /* Filtered |flux angle - PLL angle| above => not locked. */
+} motor_flux_observer_cfg_t;
+
+/**
+ * @brief Flux-observer runtime handle.
+ *
+ */
+typedef struct {
+	const motor_flux_observer_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	/* Stator flux x in pWb (int64: lambda alone is a few 1e9 pWb). */
+	int64_t flux_alpha_pwb;
+	int64_t flux_beta_pwb;
+	/* Voltage applied since the previous sample, in uV. */
+	int32_t voltage_alpha_uv;
+	int32_t voltage_beta_uv;
+	/* Derived at init. */
+	int64_t flux_linkage_sq;                   /* lambda^2 in (2^18 pWb)^2. */
+	int64_t flux_linkage_sq_recip_q46;         /* 2^46 / lambda^2. */
+	int32_t flux_gain_q15;                     /* k * update period. */
+	int32_t pll_kp_q24;                        /* 2 wn dt. */
+	int32_t pll_ki_q24;                        /* (wn dt)^2. */
+	int64_t speed_mrpm_per_step_q32;           /* mrpm of one 2^-32 turn per step (mechanical). */
+	/* Angle PLL, 2^32 per electrical turn. */
+	uint32_t pll_angle_u32;
+	int32_t pll_speed_per_step;
+	uint32_t pll_error_filtered_q8;            /* |flux - PLL| in counts Q8, first-order filter. */
+	bool is_initialized;
+} motor_flux_observer_handle_t;
+
+/**
+ * @brief Initialize flux-observer handle (estimate not valid until reset and lock).
+ *
+ * @param motor_flux_observer_h Pointer to flux-observer handle.
+ * @param motor_flux_observer_cfg Pointer to flux-observer configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_flux_observer_init(motor_flux_observer_handle_t *motor_flux_observer_h,
+							  const motor_flux_observer_cfg_t *motor_flux_observer_cfg);
+
+/**
+ * @brief Restart the observer on one known electrical angle with zero voltage and speed.
+ *
+ * @param motor_flux_observer_h Pointer to flux-observer handle.
+ * @param electrical_angle_u16 Rotor d-axis angle (e.g. the alignment angle).
+ * @return true if reset, false otherwise.
+ */
+bool motor_flux_observer_reset(motor_flux_observer_handle_t *motor_flux_observer_h,
+							   uint16_t electrical_angle_u16);
+
+/**
+ * @brief Latch the voltage of the actuation that was just applied.
+ *
+ * @param motor_flux_observer_h Pointer to flux-observer handle.
+ * @param ud_permyriad D-axis command passed to the FOC kernel.
+ * @param uq_permyriad Q-axis command passed to the FOC kernel (before the phase-sequence sign).
+ * @param applied_electrical_angle_u16 Angle the kernel rotated the command with (including the advance).
+ * @return true if latched, false otherwise.
+ */
+bool motor_flux_observer_set_voltage(motor_flux_observer_handle_t *motor_flux_observer_h,
+									 int32_t ud_permyriad,
+									 int32_t uq_permyriad,
+									 uint16_t applied_electrical_angle_u16);
+
+/**
+ * @brief Integrate one current sample (motor_h->current alpha/beta) and publish the estimate.
+ *
+ * @param motor_flux_observer_h Pointer to flux-observer handle.
+ * @return true if updated, false otherwise.
+ */
+bool motor_flux_observer_update(motor_flux_observer_handle_t *motor_flux_observer_h);
+
+/**
+ * @brief Extrapolate the PLL angle over one horizon at the estimated speed.
+ *
+ * @param motor_flux_observer_h Pointer to flux-observer handle.
+ * @param horizon_us Time after the latest current sample.
+ * @return Electrical angle in full-turn counts.
+ */
+uint16_t motor_flux_observer_predict_angle(const motor_flux_observer_handle_t *motor_flux_observer_h,
+										   uint32_t horizon_us);
+
+#endif /* MOTOR_MOTOR_FLUX_OBSERVER_H */
@@ -10,6 +10,7 @@
  * Responsibilities:
  * - bind shared motor-domain and 3-PWM handles
  * - read measured electrical angle from shared motor measurements
+ * - add the published phase advance (motor_lead_angle.c) to that angle
  * - apply d/q voltage requests in permyriad units
  *
  * @note Electrical angle uses full-turn uint16 units.
@@ -20,6 +21,7 @@
 #include <stdbool.h>
 #include "motor/motor.h"
 #include "motor/motor_3pwm.h"
+#include "motor/motor_kernel.h"
 
 /**
  * @brief FOC voltage helper configuration.
@@ -39,12 +41,20 @@ typedef struct {
 	const motor_foc_voltage_cfg_t *cfg;
 	motor_handle_t *motor_h;
 	motor_3pwm_handle_t *motor_3pwm_h;
+	uint16_t duty_arr;			/* TIM1 ARR captured at init (full-scale duty ticks). */
+	int32_t duty_tick_scale;	/* arr * 2^40 / (2 * 10000 * 32767), see motor_foc_voltage_apply_dq(). */
+#if (MOTOR_FOC_VOLTAGE_KERNEL == MOTOR_KERNEL_FLOAT32)
+	float duty_center_ticks_f32;	/* arr / 2 */
+	float duty_ticks_per_permyriad_f32;	/* arr / 20000 */
+#endif
 	bool is_initialized;
 } motor_foc_voltage_handle_t;
 
 /**
  * @brief Initialize FOC voltage helper.
  *
+ * @pre The 3-PWM stage must be initialized (TIM1 ARR is captured here).
+ *
  * @param motor_foc_voltage_h Pointer to FOC voltage handle.
  * @param motor_foc_voltage_cfg Pointer to FOC voltage configuration.
  * @return true if initialization succeeded, false otherwise.
@@ -59,6 +69,16 @@ bool motor_foc_voltage_init(motor_foc_voltage_handle_t *motor_foc_voltage_h,
  * voltage request (Ud, Uq) into the equivalent stationary-frame actuation.
  * The configured phase-sequence sign still controls q-axis handedness.
  *
+ * The transform runs division-free: SIMD dual MACs for inverse Park, one Q31
+ * multiply for inverse Clarke and a precomputed ARR scale to CCR ticks.
+ * Result stays within +/-1 tick of the previous permyriad/Q15 pipeline.
+ * MOTOR_FOC_VOLTAGE_KERNEL = MOTOR_KERNEL_FLOAT32 runs the same steps in
+ * single-precision float in permyriad units (same LUT, same tick range).
+ *
+ * With SVPWM/DPWM selected on the 3-PWM stage, 10000 permyriad is the linear
+ * modulation limit (phase peak 2/sqrt(3) x half bus, about 15% above sine),
+ * so the same Ud/Uq request produces 1.155x the sine-mode voltage.
+ *
  * @param motor_foc_voltage_h Pointer to FOC voltage handle.
  * @param ud_permyriad D-axis voltage request in permyriad units.
  * @param uq_permyriad Q-axis voltage request in permyriad units.
@@ -0,0 +1,61 @@
+#ifndef MOTOR_MOTOR_KERNEL_H
+#define MOTOR_MOTOR_KERNEL_H
+
+/**
+ * @file motor_kernel.h
+ * @brief Build-time arithmetic variant of the control kernels.
+ *
+ * Each kernel below has one fixed-point implementation (the reference the
+ * golden vectors were recorded with) and one single-precision float
+ * implementation for the Cortex-M4F FPU. The handle APIs, the integer state
+ * and the published outputs are the same; the float variant replaces the
+ * int64 multiply/divide chains and may differ from the fixed one by float
+ * rounding (a few LSB, see README, "Float32 Kernels").
+ *
+ * Selection (per module, e.g. -DMOTOR_SPEED_PI_KERNEL=MOTOR_KERNEL_FLOAT32):
+ * - MOTOR_FOC_VOLTAGE_KERNEL                  inverse Park / Clarke, zero sequence, CCR ticks
+ * - MOTOR_SPEED_PI_KERNEL                     P / I / FF terms, gain interpolation, Iq reference
+ * - MOTOR_SPEED_FEEDBACK_KERNEL               raw speed conversion and LPF (the PLL stays Q32)
+ * - MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL    final regression slope conversion
+ *
+ * @note The float variants need the FPU enabled (SystemInit) and lazy FP
+ *       context stacking for the ISRs that run them (see system_init.c).
+ */
+
+#define MOTOR_KERNEL_FIXED      0u
+#define MOTOR_KERNEL_FLOAT32    1u
+
+#ifndef MOTOR_FOC_VOLTAGE_KERNEL
+#define MOTOR_FOC_VOLTAGE_KERNEL                MOTOR_KERNEL_FIXED
+#endif
+
+#ifndef MOTOR_SPEED_PI_KERNEL
+#define MOTOR_SPEED_PI_KERNEL                   MOTOR_KERNEL_FIXED
+#endif
+
+#ifndef MOTOR_SPEED_FEEDBACK_KERNEL
+#define MOTOR_SPEED_FEEDBACK_KERNEL             MOTOR_KERNEL_FIXED
+#endif
+
+#ifndef MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL
+#define MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL  MOTOR_KERNEL_FIXED
+#endif
+
+#if (MOTOR_FOC_VOLTAGE_KERNEL != MOTOR_KERNEL_FIXED) && (MOTOR_FOC_VOLTAGE_KERNEL != MOTOR_KERNEL_FLOAT32)
+#error "MOTOR_FOC_VOLTAGE_KERNEL must be MOTOR_KERNEL_FIXED or MOTOR_KERNEL_FLOAT32"
+#endif
+
+#if (MOTOR_SPEED_PI_KERNEL != MOTOR_KERNEL_FIXED) && (MOTOR_SPEED_PI_KERNEL != MOTOR_KERNEL_FLOAT32)
+#error "MOTOR_SPEED_PI_KERNEL must be MOTOR_KERNEL_FIXED or MOTOR_KERNEL_FLOAT32"
+#endif
+
+#if (MOTOR_SPEED_FEEDBACK_KERNEL != MOTOR_KERNEL_FIXED) && (MOTOR_SPEED_FEEDBACK_KERNEL != MOTOR_KERNEL_FLOAT32)
+#error "MOTOR_SPEED_FEEDBACK_KERNEL must be MOTOR_KERNEL_FIXED or MOTOR_KERNEL_FLOAT32"
+#endif
+
+#if (MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL != MOTOR_KERNEL_FIXED) && \
+	(MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL != MOTOR_KERNEL_FLOAT32)
+#error "MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL must be MOTOR_KERNEL_FIXED or MOTOR_KERNEL_FLOAT32"
+#endif
+
+#endif /* MOTOR_MOTOR_KERNEL_H */
@@ -0,0 +1,161 @@
+#ifndef MOTOR_MOTOR_LEAD_ANGLE_H
+#define MOTOR_MOTOR_LEAD_ANGLE_H
+
+/**
+ * @file motor_lead_angle.h
+ * @brief Speed-dependent phase advance of the voltage vector (voltage-mode FOC).
+ *
+ * With Ud = 0 the phase current lags the applied voltage by an angle that
+ * grows with electrical speed (winding inductance), so torque per volt
+ * falls at high speed. This module publishes one electrical lead that the
+ * FOC stage adds to the measured angle before the inverse Park transform.
+ *
+ * Responsibilities:
+ * - hold one advance table over |mechanical speed| (equidistant points from 0)
+ * - fill that table from a configured table or from the L / R model
+ *   advance = atan(omega_e * tau), tau = L / R, omega_e = pole_pairs * omega_m
+ * - interpolate the advance each speed step and sign it with the rotation
+ * - calibrate: hold one constant speed, step the advance and keep the one
+ *   with the lowest mean |Uq| (same speed, least voltage = best torque per volt)
+ *
+ * A finished calibration converts the best advance into tau at the
+ * calibration speed (tau = tan(advance) / omega_e) and refills the table
+ * from the model, so the identified time constant covers every speed.
+ *
+ * Usage (one speed step):
+ *   motor_speed_pi_update()  -> Uq
+ *   motor_lead_angle_update(&h, speed)  or, while calibrating,
+ *   motor_lead_angle_calibration_update(&h, Uq, speed)
+ *   motor_foc_voltage_apply_dq()  -> angle + motor_h->lead_angle.advance_counts
+ *
+ * @note Angles use full-turn uint16 electrical counts (65536 = 360 deg).
+ * @note The L / R model is the current lag of the winding alone. The minimum-|Uq|
+ *       advance also weakens the field (negative Id) and usually lies above it;
+ *       max_advance_counts bounds both.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+#define MOTOR_LEAD_ANGLE_MAX_POINTS             16u
+
+/**
+ * @brief Advance-table source.
+ *
+ */
+typedef enum {
+	MOTOR_LEAD_ANGLE_MODE_TABLE = 0,        /* table_advance_counts as configured. */
+	MOTOR_LEAD_ANGLE_MODE_MODEL,            /* atan(omega_e * electrical_time_constant_us). */
+} motor_lead_angle_mode_t;
+
+/**
+ * @brief Calibration state.
+ *
+ */
+typedef enum {
+	MOTOR_LEAD_ANGLE_CALIBRATION_STATE_IDLE = 0,
+	MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING,
+	MOTOR_LEAD_ANGLE_CALIBRATION_STATE_AVERAGING,
+	MOTOR_LEAD_ANGLE_CALIBRATION_STATE_DONE,
+	MOTOR_LEAD_ANGLE_CALIBRATION_STATE_FAILED,  /* Speed not held within tolerance while averaging. */
+} motor_lead_angle_calibration_state_t;
+
+/**
+ * @brief Lead-angle configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	motor_lead_angle_mode_t mode;
+	int8_t speed_direction_sign;            /* Maps measured_mechanical_speed_mrpm onto the electrical angle direction (+1 or -1). */
+	uint8_t point_count;                    /* 2..MOTOR_LEAD_ANGLE_MAX_POINTS, point k at k * point_spacing_mrpm. */
+	uint32_t point_spacing_mrpm;
+	uint16_t table_advance_counts[MOTOR_LEAD_ANGLE_MAX_POINTS]; /* TABLE: first point_count entries (ignored in MODEL). */
+	uint32_t electrical_time_constant_us;   /* MODEL: L / R. */
+	uint16_t max_advance_counts;            /* Clamp of every table entry, < quarter turn. */
+	uint16_t update_period_ms;              /* Speed-step period the calibration counts in. */
+	/* Calibration: advance k * calibration_step_counts for k = 0..calibration_step_count - 1. */
+	int32_t calibration_speed_mrpm;
+	uint16_t calibration_step_counts;
+	uint8_t calibration_step_count;
+	uint16_t calibration_settle_ms;         /* Speed loop settles after each advance step. */
+	uint16_t calibration_average_ms;        /* Mean |Uq| window per step. */
+	uint32_t calibration_speed_tolerance_mrpm;
+} motor_lead_angle_cfg_t;
+
+/**
+ * @brief Lead-angle runtime handle.
+ *
+ */
+typedef struct {
+	const motor_lead_angle_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	uint16_t advance_counts[MOTOR_LEAD_ANGLE_MAX_POINTS];   /* Active table, |advance| per point. */
+	uint32_t electrical_time_constant_us;   /* Model tau of the active table (0 for a configured table). */
+	/* Calibration. */
+	motor_lead_angle_calibration_state_t calibration_state;
+	uint8_t calibration_step_index;
+	uint16_t calibration_elapsed_ms;        /* In the current settle or averaging window. */
+	uint32_t calibration_sample_count;
+	uint64_t calibration_abs_uq_sum;
+	uint8_t calibration_best_step_index;
+	uint32_t calibration_best_mean_uq_permyriad;
+	uint32_t calibration_zero_mean_uq_permyriad; /* Mean |Uq| without advance, for the report. */
+	bool is_initialized;
+} motor_lead_angle_handle_t;
+
+/**
+ * @brief Initialize lead-angle handle and fill the active table.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param motor_lead_angle_cfg Pointer to lead-angle configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_lead_angle_init(motor_lead_angle_handle_t *motor_lead_angle_h,
+						   const motor_lead_angle_cfg_t *motor_lead_angle_cfg);
+
+/**
+ * @brief Publish the advance for one measured speed (no advance without valid speed).
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param measured_mechanical_speed_mrpm Measured mechanical speed in mrpm.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_lead_angle_update(motor_lead_angle_handle_t *motor_lead_angle_h,
+							 int32_t measured_mechanical_speed_mrpm);
+
+/**
+ * @brief Refill the active table from the L / R model at one time constant.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param electrical_time_constant_us Electrical time constant L / R in microseconds.
+ * @return true if the table was refilled, false otherwise.
+ */
+bool motor_lead_angle_set_time_constant(motor_lead_angle_handle_t *motor_lead_angle_h,
+										uint32_t electrical_time_constant_us);
+
+/**
+ * @brief Start the advance sweep; the caller holds calibration_speed_mrpm meanwhile.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @return true if started, false otherwise.
+ */
+bool motor_lead_angle_calibration_start(motor_lead_angle_handle_t *motor_lead_angle_h);
+
+/**
+ * @brief Run one calibration step: accumulate |Uq|, step the advance, pick the minimum.
+ *
+ * On DONE the table is refilled from the identified time constant and the
+ * regular advance for the measured speed is published.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param uq_command_permyriad Uq command of this speed step.
+ * @param measured_mechanical_speed_mrpm Measured mechanical speed in mrpm.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_lead_angle_calibration_update(motor_lead_angle_handle_t *motor_lead_angle_h,
+										 int32_t uq_command_permyriad,
+										 int32_t measured_mechanical_speed_mrpm);
+
+#endif /* MOTOR_MOTOR_LEAD_ANGLE_H */
@@ -0,0 +1,162 @@
+#ifndef MOTOR_MOTOR_POSITION_CONTROL_H
+#define MOTOR_MOTOR_POSITION_CONTROL_H
+
+/**
+ * @file motor_position_control.h
+ * @brief Cascaded position loop on the multi-turn mechanical angle.
+ *
+ * This module closes a position loop around the speed PI: it produces the
+ * speed reference from the position error plus the speed of a planned
+ * trajectory (velocity feedforward).
+ *
+ * Responsibilities:
+ * - plan a point-to-point move as a two-segment S-curve table for
+ *   motor_trajectory (ramp to a cruise speed, hold, ramp to zero) whose
+ *   distance matches the move
+ * - integrate the trajectory speed into the position reference
+ * - run one P(I) update on reference - measured position, add the
+ *   trajectory speed and limit the speed command
+ * - report in-position once the move is finished and the error stayed in
+ *   the window for the settle time
+ *
+ * Cascade per speed-control step:
+ *   motor_trajectory_update()           -> reference speed (feedforward)
+ *   motor_position_control_update()     -> speed_command_mrpm
+ *   motor_speed_pi_update(speed_command_mrpm, reference acceleration, ...)
+ *
+ * @note Position uses wrapping 32-bit counts, 65536 per mechanical turn,
+ *       control-positive like the measured speed; differences are exact
+ *       within +/-32768 turns.
+ * @note The position planner uses the ramp times of motor_trajectory, so the
+ *       table lands within a few counts; the residual is snapped into the
+ *       reference when the table finishes and closed by the P term.
+ * @note The integrator is stored in output units (mrpm), so gain changes are bumpless.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+#include "motor/motor_trajectory.h"
+
+#define MOTOR_POSITION_CONTROL_MOVE_SEGMENT_COUNT    2u
+
+/**
+ * @brief Position-control configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint16_t update_period_ms;             /* Speed-control period (trajectory and speed PI cadence). */
+	int8_t control_direction_sign;         /* Control-positive position sign (+1 or -1), as the speed feedback. */
+	int32_t kp_q15;                        /* Proportional gain in Q15 (mrpm per count). */
+	int32_t ki_per_s_q15;                  /* Integral gain in Q15 per second (mrpm per count per second). */
+	int32_t max_speed_mrpm;                /* Speed-command limit and move cruise speed, > 0. */
+	uint32_t in_position_window_counts;    /* |error| within this => in the window. */
+	uint16_t in_position_settle_ms;        /* Time inside the window before in-position is reported. */
+} motor_position_control_cfg_t;
+
+/**
+ * @brief Position-control runtime handle.
+ *
+ */
+typedef struct {
+	const motor_position_control_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	int32_t kp_q15;                        /* Active gains and limit (cfg values until changed). */
+	int32_t ki_dt_q15;
+	int32_t max_speed_mrpm;
+	int32_t integrator_term_mrpm;
+	int64_t reference_remainder;           /* Sub-count part of the integrated reference speed. */
+	uint16_t settle_count;                 /* Consecutive updates inside the window. */
+	uint16_t settle_update_count;          /* Updates needed for in_position_settle_ms. */
+	bool is_referenced;                    /* Reference anchored at a measured position. */
+	bool is_move_active;                   /* Move table planned and not yet finished. */
+	motor_trajectory_segment_t move_segments[MOTOR_POSITION_CONTROL_MOVE_SEGMENT_COUNT];
+	bool is_initialized;
+} motor_position_control_handle_t;
+
+/**
+ * @brief Initialize position-control handle (not referenced).
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @param motor_position_control_cfg Pointer to position-control configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_position_control_init(motor_position_control_handle_t *motor_position_control_h,
+								 const motor_position_control_cfg_t *motor_position_control_cfg);
+
+/**
+ * @brief Drop the reference, the move and the integrator.
+ *
+ * The next motor_position_control_update() anchors reference and target at
+ * the measured position, so the axis holds where it is.
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @return true if reset succeeded, false otherwise.
+ */
+bool motor_position_control_reset(motor_position_control_handle_t *motor_position_control_h);
+
+/**
+ * @brief Plan a move to one target position.
+ *
+ * Fills profile with a non-cyclic table (cruise speed + hold, then zero)
+ * that starts from the current reference speed; the caller hands it to
+ * motor_trajectory_set_profile() before the next trajectory update. The
+ * cruise speed is the highest one up to the speed limit whose ramps fit the
+ * distance. The table referenced by profile lives in the handle.
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @param target_position_counts Target in control-positive counts.
+ * @param reference_speed_mrpm Trajectory reference speed published last.
+ * @param max_acceleration_mrpm_per_s Trajectory acceleration limit (> 0).
+ * @param max_jerk_mrpm_per_s2 Trajectory jerk limit, 0 = trapezoid.
+ * @param profile Output trajectory profile.
+ * @return true if planned, false if not referenced yet or the limits are invalid.
+ */
+bool motor_position_control_move_to(motor_position_control_handle_t *motor_position_control_h,
+									int32_t target_position_counts,
+									int32_t reference_speed_mrpm,
+									uint32_t max_acceleration_mrpm_per_s,
+									uint32_t max_jerk_mrpm_per_s2,
+									motor_trajectory_profile_t *profile);
+
+/**
+ * @brief Run one position-loop update (once per speed-control step, after the trajectory).
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @param reference_speed_mrpm Trajectory reference speed of this step (feedforward).
+ * @param is_reference_finished Trajectory table finished (motor_trajectory is_finished).
+ * @param measured_position_counts Multi-turn angle in sensor direction
+ *        (motor_speed_reference_estimator_get_position()).
+ * @param in_position_reached Output true on the update that reports in-position (may be NULL).
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_position_control_update(motor_position_control_handle_t *motor_position_control_h,
+								   int32_t reference_speed_mrpm,
+								   bool is_reference_finished,
+								   int32_t measured_position_counts,
+								   bool *in_position_reached);
+
+/**
+ * @brief Set the active gains.
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @param kp_q15 Proportional gain in Q15 (mrpm per count), >= 0.
+ * @param ki_per_s_q15 Integral gain in Q15 per second, >= 0.
+ * @return true if applied, false otherwise.
+ */
+bool motor_position_control_set_gains(motor_position_control_handle_t *motor_position_control_h,
+									  int32_t kp_q15,
+									  int32_t ki_per_s_q15);
+
+/**
+ * @brief Set the active speed limit (command clamp and cruise speed of the next move).
+ *
+ * @param motor_position_control_h Pointer to position-control handle.
+ * @param max_speed_mrpm New limit, > 0.
+ * @return true if applied, false otherwise.
+ */
+bool motor_position_control_set_max_speed(motor_position_control_handle_t *motor_position_control_h,
+										  int32_t max_speed_mrpm);
+
+#endif /* MOTOR_MOTOR_POSITION_CONTROL_H */
@@ -0,0 +1,178 @@
+#ifndef MOTOR_MOTOR_SCOPE_H
+#define MOTOR_MOTOR_SCOPE_H
+
+/**
+ * @file motor_scope.h
+ * @brief Triggered in-RAM capture of motor control signals.
+ *
+ * This module records selected shared motor-state signals into a static RAM
+ * ring at the control-loop rate and freezes it around one trigger event, so
+ * a full-rate trace can be read out afterwards over a slow link.
+ *
+ * Responsibilities:
+ * - sample up to MOTOR_SCOPE_MAX_CHANNELS selected signals per record call
+ * - keep a configurable number of pre-trigger samples in the ring
+ * - trigger externally (application events) or on an absolute channel level
+ * - freeze after the post-trigger samples and expose the capture in time order
+ *
+ * Usage:
+ *   motor_scope_arm();  ... motor_scope_record() once per control step ...
+ *   motor_scope_trigger() on an event, read with motor_scope_get_sample()
+ *   once motor_scope_is_complete(), then re-arm.
+ *
+ * @note record/trigger/arm must run in one context (the control loop).
+ * @note The sample buffer is owned by the caller (static storage), row-major
+ *       sample_capacity x channel_count int32 values.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+#include "motor/motor_3pwm.h"
+
+#define MOTOR_SCOPE_MAX_CHANNELS    4u
+
+/**
+ * @brief Selectable signals (values are sent as channel identifiers).
+ *
+ */
+typedef enum {
+	MOTOR_SCOPE_CHANNEL_MECHANICAL_ANGLE = 0,   /**< measurements.mechanical_angle_u16 */
+	MOTOR_SCOPE_CHANNEL_ELECTRICAL_ANGLE,       /**< measurements.electrical_angle_u16 */
+	MOTOR_SCOPE_CHANNEL_RAW_SPEED,              /**< speed_feedback.raw_mechanical_speed_mrpm */
+	MOTOR_SCOPE_CHANNEL_FILTERED_SPEED,         /**< speed_feedback.filtered_mechanical_speed_mrpm */
+	MOTOR_SCOPE_CHANNEL_TARGET_SPEED,           /**< targets.target_mechanical_speed_mrpm */
+	MOTOR_SCOPE_CHANNEL_SPEED_ERROR,            /**< speed_pi.speed_error_mrpm */
+	MOTOR_SCOPE_CHANNEL_SPEED_INTEGRATOR,       /**< speed_pi.integrator_term_permyriad */
+	MOTOR_SCOPE_CHANNEL_UQ_COMMAND,             /**< speed_pi.speed_control_uq_command_permyriad */
+	MOTOR_SCOPE_CHANNEL_ID,                     /**< current.id_ma */
+	MOTOR_SCOPE_CHANNEL_IQ,                     /**< current.iq_ma */
+	MOTOR_SCOPE_CHANNEL_DUTY_A,                 /**< motor_3pwm phase_a_duty_ticks */
+	MOTOR_SCOPE_CHANNEL_DUTY_B,                 /**< motor_3pwm phase_b_duty_ticks */
+	MOTOR_SCOPE_CHANNEL_DUTY_C,                 /**< motor_3pwm phase_c_duty_ticks */
+	MOTOR_SCOPE_CHANNEL_REFERENCE_SPEED,        /**< trajectory.reference_mechanical_speed_mrpm */
+	MOTOR_SCOPE_CHANNEL_REFERENCE_ACCELERATION, /**< trajectory.reference_mechanical_acceleration_mrpm_per_s */
+	MOTOR_SCOPE_CHANNEL_SPEED_FEEDFORWARD,      /**< speed_pi.feedforward_term_permyriad */
+	MOTOR_SCOPE_CHANNEL_COUNT,
+} motor_scope_channel_t;
+
+/**
+ * @brief Trigger source.
+ *
+ */
+typedef enum {
+	MOTOR_SCOPE_TRIGGER_EXTERNAL = 0,   /* motor_scope_trigger() only (phase change, fault, ...). */
+	MOTOR_SCOPE_TRIGGER_ABS_LEVEL,      /* |trigger channel| >= trigger_level, or motor_scope_trigger(). */
+} motor_scope_trigger_mode_t;
+
+/**
+ * @brief Capture state.
+ *
+ */
+typedef enum {
+	MOTOR_SCOPE_STATE_IDLE = 0,
+	MOTOR_SCOPE_STATE_ARMED,        /* Recording, waiting for the trigger. */
+	MOTOR_SCOPE_STATE_TRIGGERED,    /* Recording the post-trigger samples. */
+	MOTOR_SCOPE_STATE_COMPLETE,     /* Frozen, ready for readout. */
+} motor_scope_state_t;
+
+/**
+ * @brief Scope configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	const motor_3pwm_handle_t *motor_3pwm_h;            /* Needed only for the duty channels. */
+	int32_t *sample_buffer;                             /* sample_capacity x channel_count values. */
+	uint16_t sample_capacity;                           /* Power of two. */
+	uint16_t pre_trigger_samples;                       /* < sample_capacity. */
+	uint16_t decimation;                                /* Record every Nth call (1 = every call). */
+	uint8_t channel_count;                              /* 1..MOTOR_SCOPE_MAX_CHANNELS */
+	motor_scope_channel_t channels[MOTOR_SCOPE_MAX_CHANNELS];
+	motor_scope_trigger_mode_t trigger_mode;
+	uint8_t trigger_channel_index;                      /* Index into channels[] for level triggering. */
+	int32_t trigger_level;                              /* Positive absolute level. */
+} motor_scope_cfg_t;
+
+/**
+ * @brief Scope runtime handle.
+ *
+ */
+typedef struct {
+	const motor_scope_cfg_t *cfg;
+	motor_scope_state_t state;
+	uint32_t recorded_count;        /* Samples recorded since arm (ring position = count & mask). */
+	uint32_t trigger_sample;        /* recorded_count at the trigger, first post-trigger sample. */
+	uint16_t post_trigger_remaining;
+	uint16_t decimation_count;
+	uint16_t captured_count;        /* Valid samples after completion. */
+	uint16_t trigger_offset;        /* Position of the trigger sample within the capture. */
+	bool is_initialized;
+} motor_scope_handle_t;
+
+/**
+ * @brief Initialize scope handle (state IDLE).
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @param motor_scope_cfg Pointer to scope configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_scope_init(motor_scope_handle_t *motor_scope_h, const motor_scope_cfg_t *motor_scope_cfg);
+
+/**
+ * @brief Discard any capture and start recording towards a new trigger.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @return true if armed, false otherwise.
+ */
+bool motor_scope_arm(motor_scope_handle_t *motor_scope_h);
+
+/**
+ * @brief Record one sample of all channels and evaluate the level trigger.
+ *
+ * No-op in IDLE and COMPLETE state.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @return true if recorded or skipped by state/decimation, false if invalid.
+ */
+bool motor_scope_record(motor_scope_handle_t *motor_scope_h);
+
+/**
+ * @brief Trigger the capture; the next recorded sample is the trigger sample.
+ *
+ * Ignored unless ARMED.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @return true if the capture was triggered by this call, false otherwise.
+ */
+bool motor_scope_trigger(motor_scope_handle_t *motor_scope_h);
+
+/**
+ * @brief Freeze the capture immediately (fault path, no post-trigger samples).
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @return true if a capture is available afterwards, false otherwise.
+ */
+bool motor_scope_freeze(motor_scope_handle_t *motor_scope_h);
+
+/**
+ * @brief Return whether a frozen capture is ready for readout.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @return true in COMPLETE state, false otherwise.
+ */
+bool motor_scope_is_complete(const motor_scope_handle_t *motor_scope_h);
+
+/**
+ * @brief Copy one captured sample in time order.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @param sample_index 0 = oldest, captured_count - 1 = newest.
+ * @param values Output array with channel_count entries.
+ * @return true if copied, false if not complete or index out of range.
+ */
+bool motor_scope_get_sample(const motor_scope_handle_t *motor_scope_h,
+							uint16_t sample_index,
+							int32_t *values);
+
+#endif /* MOTOR_MOTOR_SCOPE_H */
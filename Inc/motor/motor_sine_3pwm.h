@@ -9,6 +9,9 @@
  * electrical angle and one amplitude request into three sine phase duties and
  * applies them through the 3-PWM stage.
  *
+ * With dead-time compensation enabled the phase command signs set the
+ * compensation polarity (no current feedback on these paths).
+ *
  * @note Electrical angle uses full-turn uint16 units.
  * @note Amplitude uses permyriad units (0..10000).
  */
@@ -0,0 +1,116 @@
+#ifndef MOTOR_MOTOR_SPEED_AUTOTUNE_H
+#define MOTOR_MOTOR_SPEED_AUTOTUNE_H
+
+/**
+ * @file motor_speed_autotune.h
+ * @brief On-target step identification of the speed plant and PI gain synthesis.
+ *
+ * This module drives the speed-loop command with a staircase of open-loop
+ * steps, identifies one first-order model K / (tau s + 1) per step and turns
+ * each model into one speed-PI gain-schedule point.
+ *
+ * Responsibilities:
+ * - command step k * step_uq_permyriad for settle_time_ms, k = 1..step_count
+ * - estimate K from the settled speed change and tau with the area method:
+ *   tau = integral(v_final - v) dt / (v_final - v_start)
+ * - synthesize PI gains by pole cancellation with lambda = tau / speedup:
+ *   Kp = speedup / K, Ki = Kp / tau
+ * - publish the points as a motor_speed_pi gain table
+ *
+ * Usage:
+ *   motor_speed_autotune_start(&h);
+ *   each speed-PI period: motor_speed_autotune_update(&h, measured, &uq);
+ *                         motor_speed_pi_set_manual_output(&pi_h, uq);
+ *   when DONE: motor_speed_pi_set_gain_table(&pi_h, h.points, h.point_count);
+ *
+ * @note The area method integrates the whole response, so it tolerates
+ *       speed-measurement noise far better than a 63 % crossing time.
+ * @note Each settled window average is the next step's start speed.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+#include "motor/motor_speed_pi.h"
+
+/**
+ * @brief Autotune state.
+ *
+ */
+typedef enum {
+	MOTOR_SPEED_AUTOTUNE_STATE_IDLE = 0,
+	MOTOR_SPEED_AUTOTUNE_STATE_RUNNING,
+	MOTOR_SPEED_AUTOTUNE_STATE_DONE,
+	MOTOR_SPEED_AUTOTUNE_STATE_FAILED,       /* A step moved the speed less than min_delta_speed_mrpm. */
+} motor_speed_autotune_state_t;
+
+/**
+ * @brief Autotune configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	uint16_t update_period_ms;               /* Same cadence as the speed PI. */
+	uint8_t step_count;                      /* 1..MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS */
+	uint16_t step_uq_permyriad;              /* Command increment per step. */
+	uint16_t settle_time_ms;                 /* Hold per step, several open-loop tau. */
+	uint8_t closed_loop_speedup;             /* Closed loop this many times faster than the plant. */
+	uint32_t min_delta_speed_mrpm;           /* Smaller speed change per step => FAILED. */
+} motor_speed_autotune_cfg_t;
+
+/**
+ * @brief Autotune runtime handle.
+ *
+ */
+typedef struct {
+	const motor_speed_autotune_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	motor_speed_autotune_state_t state;
+	uint8_t step_index;                      /* 0-based running step. */
+	uint32_t step_tick;                      /* Updates since the step started. */
+	uint32_t settle_ticks;
+	int32_t step_start_speed_mrpm;
+	int64_t speed_sum_mrpm;                  /* Sum of v over the step (area method). */
+	int64_t tail_speed_sum_mrpm;             /* Sum of v over the last quarter (settled value). */
+	uint32_t tail_tick_count;
+	/* Identified models and synthesized gain points, valid up to point_count. */
+	int32_t plant_gain_mrpm_per_permyriad_q8[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	uint32_t plant_time_constant_us[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	motor_speed_pi_gain_point_t points[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	uint8_t point_count;
+	bool is_initialized;
+} motor_speed_autotune_handle_t;
+
+/**
+ * @brief Initialize autotune handle.
+ *
+ * @param motor_speed_autotune_h Pointer to autotune handle.
+ * @param motor_speed_autotune_cfg Pointer to autotune configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_speed_autotune_init(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+							   const motor_speed_autotune_cfg_t *motor_speed_autotune_cfg);
+
+/**
+ * @brief Start the experiment from the current measured speed.
+ *
+ * @param motor_speed_autotune_h Pointer to autotune handle.
+ * @param measured_mechanical_speed_mrpm Start speed (the motor should be at rest).
+ * @return true if started, false otherwise.
+ */
+bool motor_speed_autotune_start(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+								int32_t measured_mechanical_speed_mrpm);
+
+/**
+ * @brief Run one experiment step and return the command to apply.
+ *
+ * @param motor_speed_autotune_h Pointer to autotune handle.
+ * @param measured_mechanical_speed_mrpm Measured speed in mrpm.
+ * @param uq_command_permyriad Output command, 0 once DONE or FAILED.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_speed_autotune_update(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+								 int32_t measured_mechanical_speed_mrpm,
+								 int32_t *uq_command_permyriad);
+
+#endif /* MOTOR_MOTOR_SPEED_AUTOTUNE_H */
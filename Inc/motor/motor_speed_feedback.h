@@ -6,23 +6,45 @@
  * @brief Low-latency mechanical speed feedback helper.
  *
  * This module converts fixed-period mechanical angle samples into signed
- * mechanical speed and applies a first-order low-pass filter.
+ * mechanical speed, either by differentiation plus a first-order low-pass
+ * filter or by a second-order PLL tracking observer.
  *
  * Responsibilities:
  * - store fixed-period speed-feedback configuration
  * - connect to shared motor-domain state
  * - compute wrap-safe angle delta between adjacent samples
- * - convert delta and fixed dt into raw signed mechanical speed
+ * - convert delta and dt into raw signed mechanical speed (dt can follow a
+ *   variable sensor publish interval, see motor_speed_feedback_set_sample_period())
  * - apply a first-order low-pass filter with time-constant tuning
+ * - or track angle and speed with a type-2 PLL (angle error -> PI -> speed -> angle)
  * - publish filtered speed for the active speed-control path
  *
+ * PLL observer (critically damped, wn = 2*pi*bandwidth, per sample dt):
+ *   e = wrap(theta_meas - theta_est)
+ *   w_int += wn^2 * dt^2 * e,  w = w_int + 2 * wn * dt * e,  theta_est += w
+ * The speed output has no extra filter lag on a constant-speed ramp; the
+ * smoothed angle and the angle error are published for diagnostics.
+ *
  * @note Mechanical angle uses full-turn uint16 units.
  * @note Mechanical speed uses signed milli-rpm units.
+ * @note MOTOR_SPEED_FEEDBACK_KERNEL = MOTOR_KERNEL_FLOAT32 runs the raw speed
+ *       conversion and the LPF step in float; the PLL keeps its Q32 angle
+ *       (a float mantissa cannot hold one full turn at 2^-32 resolution).
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 #include "motor/motor.h"
+#include "motor/motor_kernel.h"
+
+/**
+ * @brief Speed-feedback estimation mode.
+ *
+ */
+typedef enum {
+	MOTOR_SPEED_FEEDBACK_MODE_LPF = 0,	/**< Angle difference + first-order LPF (filter_time_constant_ms). */
+	MOTOR_SPEED_FEEDBACK_MODE_PLL = 1,	/**< PLL tracking observer (pll_bandwidth_hz). */
+} motor_speed_feedback_mode_t;
 
 /**
  * @brief Speed-feedback configuration.
@@ -30,9 +52,11 @@
  */
 typedef struct {
 	motor_handle_t *motor_h;
-	uint32_t sample_period_us;
+	uint32_t sample_period_us;        /* Initial sample period. */
 	uint16_t filter_time_constant_ms; /* First-order LPF time constant tau. */
 	int8_t control_direction_sign;    /* Control-positive mechanical speed sign (+1 or -1). */
+	motor_speed_feedback_mode_t mode;
+	uint16_t pll_bandwidth_hz;        /* PLL mode only: natural frequency, 4*pi*bw*dt must stay below 1. */
 } motor_speed_feedback_cfg_t;
 
 /**
@@ -42,9 +66,23 @@ typedef struct {
 typedef struct {
 	const motor_speed_feedback_cfg_t *cfg;
 	motor_handle_t *motor_h;
+	uint32_t sample_period_us;        /* Active sample period, the gains below belong to it. */
+	uint16_t filter_time_constant_ms; /* Active LPF tau (cfg value until changed at runtime). */
 	uint16_t filter_coeff_q15;
 	uint16_t previous_mechanical_angle_u16;
 	bool has_previous_mechanical_angle;
+	/* PLL observer: angle in full-turn Q32, speed as angle step per sample. */
+	uint32_t pll_kp_q32;              /* 2 * wn * dt */
+	uint32_t pll_ki_q32;              /* (wn * dt)^2 */
+	uint32_t pll_mrpm_scale_q32;      /* mrpm per (2^-32 turn per sample), Q32 */
+	uint32_t pll_angle_q32;           /* Predicted angle for the next sample. */
+	uint32_t pll_sample_angle_q32;    /* Observer angle at the latest sample instant. */
+	int32_t pll_speed_integrator_q32;
+	int32_t pll_speed_q32;
+#if (MOTOR_SPEED_FEEDBACK_KERNEL == MOTOR_KERNEL_FLOAT32)
+	float raw_mrpm_per_count_f32;     /* 60e9 / (65536 * sample_period_us) */
+	float filter_coeff_f32;           /* filter_coeff_q15 / 2^15 */
+#endif
 	bool is_initialized;
 } motor_speed_feedback_handle_t;
 
@@ -58,6 +96,33 @@ typedef struct {
 bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedback_h,
 							   const motor_speed_feedback_cfg_t *motor_speed_feedback_cfg);
 
+/**
+ * @brief Change the sample period of the following updates.
+ *
+ * Rederives the LPF coefficient and PLL gains (same time constant and
+ * bandwidth) and rescales the PLL speed state. Call before the update of
+ * the first sample at the new period; no-op if the period is unchanged.
+ *
+ * @param motor_speed_feedback_h Pointer to speed-feedback handle.
+ * @param sample_period_us Time since the previous sample.
+ * @return true if applied, false if invalid (the previous period is kept).
+ */
+bool motor_speed_feedback_set_sample_period(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+											uint32_t sample_period_us);
+
+/**
+ * @brief Change the LPF time constant of the following updates.
+ *
+ * Rederives the LPF coefficient at the active sample period; the filtered
+ * speed is kept, so the output has no step. No effect on the PLL gains.
+ *
+ * @param motor_speed_feedback_h Pointer to speed-feedback handle.
+ * @param filter_time_constant_ms First-order LPF time constant tau (0 = no filtering).
+ * @return true if applied, false if invalid (the previous tau is kept).
+ */
+bool motor_speed_feedback_set_filter_time_constant(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+													uint16_t filter_time_constant_ms);
+
 /**
  * @brief Update speed feedback from one measured mechanical angle sample.
  *
@@ -11,17 +11,37 @@
  * Responsibilities:
  * - store PI configuration and runtime state
  * - compute one discrete PI update at fixed cadence
+ * - optionally schedule Kp / Ki on |measured speed| from a gain table
+ * - add optional reference feedforward (speed, acceleration, static friction)
  * - apply output saturation and simple anti-windup
  * - publish one speed-control q-axis command
+ * - publish the same command as q-axis current reference for current-mode FOC
  *
  * @note Speed uses signed milli-rpm units.
  * @note q-axis command uses signed permyriad units.
+ * @note q-axis current reference uses signed mA: command permyriad of current_limit_ma.
+ * @note The integrator is stored in output units, so gain changes are bumpless.
+ * @note Feedforward acts on the reference, not the measurement, so it adds no
+ *       measurement noise. In voltage mode the speed term covers back-EMF
+ *       (Ke * omega); in current mode it acts as viscous-friction torque.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 #include "motor/motor.h"
 
+#define MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS    8u
+
+/**
+ * @brief One gain-schedule breakpoint.
+ *
+ */
+typedef struct {
+	uint32_t speed_mrpm;               /* |measured speed| of this point, ascending over the table. */
+	int32_t kp_q15;
+	int32_t ki_per_s_q15;
+} motor_speed_pi_gain_point_t;
+
 /**
  * @brief Speed PI configuration.
  *
@@ -32,6 +52,16 @@ typedef struct {
 	int32_t ki_per_s_q15;              /* Integral gain in Q15 per second (permyriad per mrpm per second). */
 	uint16_t update_period_ms;
 	uint16_t output_limit_permyriad;
+	int32_t current_limit_ma;          /* Iq reference at 10000 permyriad command, 0 => voltage mode only. */
+	/* Feedforward, all terms 0 => pure PI. */
+	int32_t ff_speed_q15;              /* Q15 permyriad per mrpm of reference speed (Ke * omega). */
+	int32_t ff_acceleration_q15;       /* Q15 permyriad per mrpm/s of reference acceleration (J * alpha). */
+	uint16_t ff_friction_permyriad;    /* Static friction, applied with the sign of the reference speed. */
+	uint16_t ff_friction_deadband_mrpm; /* |reference| below this => no friction term (no chatter at zero). */
+	uint16_t ff_limit_permyriad;       /* Feedforward budget, <= output_limit_permyriad. */
+	/* Gain schedule, count 0 => fixed kp_q15 / ki_per_s_q15. Linear between points, held beyond the ends. */
+	const motor_speed_pi_gain_point_t *gain_table;
+	uint8_t gain_table_count;
 } motor_speed_pi_cfg_t;
 
 /**
@@ -43,6 +73,12 @@ typedef struct {
 	motor_handle_t *motor_h;
 	int32_t ki_dt_q15;
 	int32_t integrator_term_permyriad;
+	uint16_t output_limit_permyriad;   /* Active output limit, <= cfg (lowered by field weakening). */
+	/* Active gain schedule (copied from cfg or loaded at runtime), Ki already discretized. */
+	uint32_t gain_speed_mrpm[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	int32_t gain_kp_q15[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	int32_t gain_ki_dt_q15[MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS];
+	uint8_t gain_point_count;
 	bool is_initialized;
 } motor_speed_pi_handle_t;
 
@@ -69,11 +105,72 @@ bool motor_speed_pi_reset(motor_speed_pi_handle_t *motor_speed_pi_h);
  *
  * @param motor_speed_pi_h Pointer to speed PI handle.
  * @param target_mechanical_speed_mrpm Target mechanical speed in mrpm.
+ * @param target_mechanical_acceleration_mrpm_per_s Reference acceleration for feedforward in mrpm/s.
  * @param measured_mechanical_speed_mrpm Measured mechanical speed in mrpm.
  * @return true if update succeeded, false otherwise.
  */
 bool motor_speed_pi_update(motor_speed_pi_handle_t *motor_speed_pi_h,
 						   int32_t target_mechanical_speed_mrpm,
+						   int32_t target_mechanical_acceleration_mrpm_per_s,
 						   int32_t measured_mechanical_speed_mrpm);
 
+/**
+ * @brief Replace the active gain schedule.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param gain_table Breakpoints with ascending speed, NULL with count 0 => fixed cfg gains.
+ * @param gain_table_count Number of breakpoints (0..MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS).
+ * @return true if the table was accepted, false otherwise (previous table kept).
+ */
+bool motor_speed_pi_set_gain_table(motor_speed_pi_handle_t *motor_speed_pi_h,
+								   const motor_speed_pi_gain_point_t *gain_table,
+								   uint8_t gain_table_count);
+
+/**
+ * @brief Scale every breakpoint of the active gain schedule.
+ *
+ * Kp of each point becomes Kp * kp_num / kp_den, Ki likewise, so the shape
+ * of the schedule is kept. An empty schedule scales nothing.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param kp_num Kp scale numerator (>= 0).
+ * @param kp_den Kp scale denominator (> 0).
+ * @param ki_num Ki scale numerator (>= 0).
+ * @param ki_den Ki scale denominator (> 0).
+ * @return true if the schedule was scaled, false otherwise (schedule kept).
+ */
+bool motor_speed_pi_scale_gain_table(motor_speed_pi_handle_t *motor_speed_pi_h,
+									 int32_t kp_num,
+									 int32_t kp_den,
+									 int32_t ki_num,
+									 int32_t ki_den);
+
+/**
+ * @brief Publish one externally chosen command instead of the PI output.
+ *
+ * Used by identification experiments; the integrator is loaded with the
+ * command so a following motor_speed_pi_update() starts without a bump.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param uq_command_permyriad Command within +/-output_limit_permyriad.
+ * @return true if published, false otherwise.
+ */
+bool motor_speed_pi_set_manual_output(motor_speed_pi_handle_t *motor_speed_pi_h,
+									  int32_t uq_command_permyriad);
+
+/**
+ * @brief Set the active output limit (field weakening: the Uq left inside the voltage circle).
+ *
+ * The integrator is clamped into the new limit at once, so the conditional
+ * integration keeps working against the limit that actually applies. Values
+ * above the configured limit are clipped to it; motor_speed_pi_reset()
+ * restores the configured limit.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param output_limit_permyriad New limit, 1..cfg output_limit_permyriad.
+ * @return true if applied, false otherwise.
+ */
+bool motor_speed_pi_set_output_limit(motor_speed_pi_handle_t *motor_speed_pi_h,
+									 uint16_t output_limit_permyriad);
+
 #endif /* MOTOR_MOTOR_SPEED_PI_H */
@@ -27,12 +27,28 @@
 #include <stdbool.h>
 #include "motor/motor.h"
 
+#define MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES   64u
+#define MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE   (MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES + 1u)
+
+/**
+ * @brief Reference speed-estimator sample history (allocated by the application).
+ *
+ * Kept out of motor_handle_t. Both rings hold wrapping 32-bit values: the
+ * estimator only uses differences inside one window, which stay exact across
+ * the wrap (~71 min of timestamp, 32768 turns of angle).
+ */
+typedef struct {
+	uint32_t sample_timestamp_us[MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE];           /* Low 32 bits of the sample time. */
+	uint32_t cumulative_unwrapped_angle_counts[MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE];
+} motor_speed_reference_estimator_history_t;
+
 /**
  * @brief Reference speed-estimator configuration.
  *
  */
 typedef struct {
 	motor_handle_t *motor_h;
+	motor_speed_reference_estimator_history_t *history;
 	uint16_t history_sample_count;      /* Number of kept sample intervals in the sliding window. */
 } motor_speed_reference_estimator_cfg_t;
 
@@ -43,6 +59,7 @@ typedef struct {
 typedef struct {
 	const motor_speed_reference_estimator_cfg_t *cfg;
 	motor_handle_t *motor_h;
+	motor_speed_reference_estimator_history_t *history;
 	bool is_initialized;
 } motor_speed_reference_estimator_handle_t;
 
@@ -61,7 +78,10 @@ bool motor_speed_reference_estimator_init(
  * @brief Update reference mechanical speed from one angle sample.
  *
  * The reference estimator stores the sample timestamp for each angle sample
- * and recomputes one local window estimate from the retained history.
+ * and updates the least-squares window sums incrementally (O(1) per sample,
+ * integer only). Output matches a full double-precision window fit within
+ * +/-1 mrpm. Only the low 32 bits of the timestamp are kept; the window span
+ * must stay below 2^31 us.
  *
  * @param motor_speed_reference_estimator_h Pointer to reference-estimator handle.
  * @param mechanical_angle_u16 Mechanical angle in full-turn uint16 units
@@ -74,4 +94,21 @@ bool motor_speed_reference_estimator_update(
 		uint16_t mechanical_angle_u16,
 		uint64_t sample_timestamp_us);
 
+/**
+ * @brief Return the multi-turn mechanical angle of the latest sample.
+ *
+ * Unwrapped from the same adjacent-sample steps as the speed window and
+ * anchored to the sensor zero of the first sample's turn (the first sample
+ * reads its own raw angle). Sensor direction, wrapping 32-bit count
+ * (65536 counts per turn).
+ *
+ * @param motor_speed_reference_estimator_h Pointer to reference-estimator handle.
+ * @param position_counts Output angle in counts.
+ * @return true if a sample was taken since init, false otherwise.
+ * @note Call from the context that runs motor_speed_reference_estimator_update().
+ */
+bool motor_speed_reference_estimator_get_position(
+		const motor_speed_reference_estimator_handle_t *motor_speed_reference_estimator_h,
+		int32_t *position_counts);
+
 #endif /* MOTOR_MOTOR_SPEED_REFERENCE_ESTIMATOR_H */
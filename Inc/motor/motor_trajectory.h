@@ -0,0 +1,174 @@
+#ifndef MOTOR_MOTOR_TRAJECTORY_H
+#define MOTOR_MOTOR_TRAJECTORY_H
+
+/**
+ * @file motor_trajectory.h
+ * @brief Jerk-limited S-curve speed trajectory from a segment table.
+ *
+ * This module turns a table of (target speed, acceleration limit, hold time)
+ * segments into a smooth speed reference and its acceleration, evaluated
+ * once per fixed control tick.
+ *
+ * Responsibilities:
+ * - plan each ramp once at segment entry (jerk, constant-acceleration and
+ *   jerk-down intervals, reduced peak acceleration for short ramps)
+ * - evaluate the closed-form profile each tick (no drift, exact landing)
+ * - hold each target for its hold time, then advance (optionally cyclic)
+ * - publish reference speed, reference acceleration and the active step
+ *
+ * Profile per ramp (s = sign of the speed step, Ap <= A, Tj = Ap / J):
+ *   0 .. Tj          a = s * J * t
+ *   Tj .. Tj + Ta    a = s * Ap
+ *   .. 2 * Tj + Ta   a = s * J * (T - t)
+ * max_jerk = 0 gives the trapezoid (acceleration steps, Tj = 0).
+ *
+ * @note Speed uses signed milli-rpm units, acceleration mrpm/s, jerk mrpm/s^2.
+ * @note Step index = 2 * segment + (holding ? 1 : 0), MOTOR_TRAJECTORY_STEP_EXTERNAL
+ *       while external reference points are followed.
+ * @note The segment table and limits can be replaced at runtime; the cfg
+ *       values are the initial profile.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor/motor.h"
+
+#define MOTOR_TRAJECTORY_STEP_EXTERNAL    0xFFu
+
+/**
+ * @brief One trajectory segment: ramp to the target, then hold it.
+ *
+ */
+typedef struct {
+	int32_t target_mechanical_speed_mrpm;
+	uint32_t max_acceleration_mrpm_per_s;  /* 0 = configuration default. */
+	uint32_t hold_ms;
+} motor_trajectory_segment_t;
+
+/**
+ * @brief Trajectory configuration.
+ *
+ */
+typedef struct {
+	motor_handle_t *motor_h;
+	const motor_trajectory_segment_t *segments;
+	uint8_t segment_count;
+	bool is_cyclic;                        /* Restart at segment 0 after the last hold. */
+	uint32_t update_period_us;
+	uint32_t max_acceleration_mrpm_per_s;
+	uint32_t max_jerk_mrpm_per_s2;         /* 0 = unlimited jerk (trapezoid). */
+} motor_trajectory_cfg_t;
+
+/**
+ * @brief Active segment table and limits.
+ *
+ */
+typedef struct {
+	const motor_trajectory_segment_t *segments;  /* Must stay valid while active. */
+	uint8_t segment_count;
+	bool is_cyclic;
+	uint32_t max_acceleration_mrpm_per_s;
+	uint32_t max_jerk_mrpm_per_s2;
+} motor_trajectory_profile_t;
+
+/**
+ * @brief Trajectory runtime handle.
+ *
+ */
+typedef struct {
+	const motor_trajectory_cfg_t *cfg;
+	motor_handle_t *motor_h;
+	motor_trajectory_profile_t profile;    /* Active profile (cfg values until replaced). */
+	uint8_t segment_index;
+	bool is_holding;
+	bool is_finished;                      /* Non-cyclic table: last hold reached. */
+	bool is_external;                      /* Last reference came from motor_trajectory_set_external_reference(). */
+	/* Ramp plan of the active segment. */
+	int32_t ramp_start_speed_mrpm;
+	int32_t ramp_sign;
+	uint32_t ramp_jerk_mrpm_per_s2;
+	uint32_t ramp_peak_acceleration_mrpm_per_s;
+	uint32_t ramp_jerk_time_us;            /* Tj */
+	uint32_t ramp_constant_time_us;        /* Ta */
+	uint32_t ramp_time_us;                 /* 2 * Tj + Ta */
+	uint32_t segment_elapsed_us;           /* Time since ramp start (ramp + hold). */
+	bool is_initialized;
+} motor_trajectory_handle_t;
+
+/**
+ * @brief Initialize trajectory handle.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param motor_trajectory_cfg Pointer to trajectory configuration.
+ * @return true if initialization succeeded, false otherwise.
+ */
+bool motor_trajectory_init(motor_trajectory_handle_t *motor_trajectory_h,
+						   const motor_trajectory_cfg_t *motor_trajectory_cfg);
+
+/**
+ * @brief Restart at segment 0 from one initial speed.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param initial_speed_mrpm Reference speed at the restart.
+ * @return true if reset succeeded, false otherwise.
+ */
+bool motor_trajectory_reset(motor_trajectory_handle_t *motor_trajectory_h, int32_t initial_speed_mrpm);
+
+/**
+ * @brief Replace the segment table and limits, restart at segment 0 from the current reference.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param profile Pointer to new profile (copied; its segment table is referenced).
+ * @return true if the profile was accepted, false otherwise (previous profile kept).
+ */
+bool motor_trajectory_set_profile(motor_trajectory_handle_t *motor_trajectory_h,
+								  const motor_trajectory_profile_t *profile);
+
+/**
+ * @brief Publish one externally chosen reference point instead of the profile.
+ *
+ * Used for streamed host trajectories; the next motor_trajectory_update()
+ * replans segment 0 from the last external speed, so the hand-back is continuous.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param reference_mechanical_speed_mrpm Reference speed in mrpm.
+ * @param reference_mechanical_acceleration_mrpm_per_s Reference acceleration in mrpm/s.
+ * @return true if published, false otherwise.
+ */
+bool motor_trajectory_set_external_reference(motor_trajectory_handle_t *motor_trajectory_h,
+											 int32_t reference_mechanical_speed_mrpm,
+											 int32_t reference_mechanical_acceleration_mrpm_per_s);
+
+/**
+ * @brief Advance the trajectory by one update period and publish the reference.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param step_changed Optional output, true if the step index changed in this update.
+ * @return true if update succeeded, false otherwise.
+ */
+bool motor_trajectory_update(motor_trajectory_handle_t *motor_trajectory_h, bool *step_changed);
+
+/**
+ * @brief Return the active step index (2 * segment + holding, or MOTOR_TRAJECTORY_STEP_EXTERNAL).
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @return Step index, 0 if the handle is invalid.
+ */
+uint8_t motor_trajectory_get_step(const motor_trajectory_handle_t *motor_trajectory_h);
+
+/**
+ * @brief Return the duration of one ramp as motor_trajectory_update() plans it.
+ *
+ * Lets a caller size a segment table (e.g. a point-to-point move) on the
+ * exact ramp times the trajectory will run.
+ *
+ * @param speed_step_mrpm |target - start| speed of the ramp.
+ * @param max_acceleration_mrpm_per_s Acceleration limit.
+ * @param max_jerk_mrpm_per_s2 Jerk limit, 0 = trapezoid.
+ * @return Ramp time 2 * Tj + Ta in microseconds, 0 if the acceleration limit is 0.
+ */
+uint32_t motor_trajectory_get_ramp_time_us(uint32_t speed_step_mrpm,
+										   uint32_t max_acceleration_mrpm_per_s,
+										   uint32_t max_jerk_mrpm_per_s2);
+
+#endif /* MOTOR_MOTOR_TRAJECTORY_H */
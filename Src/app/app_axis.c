@@ -0,0 +1,1018 @@
+/**
+ * @file app_axis.c
+ * @brief Axis runtime state machine implementation.
+ *
+ *  Notes:
+ *  - alignment_done is the only state shared with the ISR paths: the
+ *    actuation task sets it once the offset and every controller are reset.
+ *  - a run that owns the speed loop (autotune, lead-angle sweep,
+ *    linearization) restarts the speed reference when it completes.
+ */
+
+#include "app/app_axis.h"
+#include <stddef.h>
+#include "board/board.h"
+#include "drivers/log.h"
+#include "drivers/profiler.h"
+#include "drivers/systick.h"
+#include "app/app_command.h"
+
+/**
+ * @brief Record angle capture -> CCR write latency of the primary axis right after an actuation.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param angle_sample Sample the actuation angle was taken from.
+ */
+static void app_timing_record_actuation_latency(app_axis_t *axis,
+												const as5600_analog_published_sample_t *angle_sample)
+{
+	if ((app_timing_monitor_enabled() == false) || (axis->index != 0u)) return;
+
+	uint64_t now_us = SYSTICK_GetTimeUs();
+	uint64_t latency_us = (now_us > angle_sample->capture_timestamp_us) ?
+			(now_us - angle_sample->capture_timestamp_us) : 0u;
+	if (latency_us > UINT32_MAX) latency_us = UINT32_MAX;
+
+	(void)timing_monitor_record_latency(&axis->app->timing_monitor_h,
+										TIMING_MONITOR_CHANNEL_SAMPLE_TO_ACTUATION,
+										(uint32_t)latency_us);
+}
+
+/**
+ * @brief Restart the speed-reference trajectory from standstill.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_speed_profile_reset(app_axis_t *axis)
+{
+	if (axis == NULL) return;
+
+	/* Position mode restarts on the hold table: a move in flight is dropped, the loop holds where it is. */
+	if (app_command_get_active_params(axis->app)->reference_mode == (uint8_t)APP_REFERENCE_MODE_POSITION)
+	{
+		motor_trajectory_profile_t profile =
+				app_command_build_reference_profile(axis->app, app_command_get_active_params(axis->app));
+
+		if (!motor_trajectory_set_profile(&axis->motor_trajectory_h, &profile))
+		{
+			app_fatal_stop(axis->app, "MTRJ", "profile rejected");
+		}
+	}
+	if (!motor_trajectory_reset(&axis->motor_trajectory_h, 0))
+	{
+		app_fatal_stop(axis->app, "MTRJ", "reset failed");
+	}
+	if (!motor_position_control_reset(&axis->motor_position_control_h))
+	{
+		app_fatal_stop(axis->app, "MPOS", "reset failed");
+	}
+}
+
+/**
+ * @brief Advance the speed-reference trajectory by one speed-control step.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_speed_profile_update(app_axis_t *axis)
+{
+	bool step_changed = false;
+
+	if (axis == NULL) return;
+
+	if (!motor_trajectory_update(&axis->motor_trajectory_h, &step_changed))
+	{
+		app_fatal_stop(axis->app, "MTRJ", "update failed");
+	}
+	if (step_changed == false) return;
+
+	LOG_POST3(LOG_MSG_APP_PROFILE_PHASE,
+			  axis->motor_h.trajectory.step_index,
+			  axis->motor_h.trajectory.reference_mechanical_speed_mrpm,
+			  axis->motor_h.speed_feedback.filtered_mechanical_speed_mrpm);
+
+	/* Profile transitions centre the scope capture (ignored unless armed). */
+	if ((app_scope_enabled()) && (axis->index == 0u) &&
+		(APP_MOTOR_TEST_SCOPE_TRIGGER == APP_MOTOR_TEST_SCOPE_TRIGGER_PROFILE_PHASE))
+	{
+		(void)motor_scope_trigger(&axis->app->motor_scope_h);
+	}
+}
+
+/**
+ * @brief Check if the runtime speed-error fault trigger is armed.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true if speed-error fault checks are active, false otherwise.
+ */
+static bool app_speed_error_fault_is_armed(const app_axis_t *axis)
+{
+	if (axis == NULL) return false;
+	if (axis->alignment_done == false) return false;
+	if (axis->motor_h.status.has_valid_mechanical_speed == false) return false;
+	if (app_speed_pi_autotune_is_running(axis)) return false;
+	if (app_angle_linearization_is_running(axis)) return false;
+	if (app_lead_angle_calibration_is_running(axis)) return false;
+
+	/* Arm only while a non-zero segment target is held (the reference sits on the target). */
+	if (axis->motor_h.trajectory.is_holding == false) return false;
+	if (axis->motor_h.trajectory.segment_target_mechanical_speed_mrpm == 0) return false;
+
+	return true;
+}
+
+void app_axis_check_speed_error_fault(app_axis_t *axis)
+{
+	int32_t speed_error_mrpm = 0;
+
+	if (axis == NULL) return;
+	if (app_speed_error_fault_is_armed(axis) == false) return;
+
+	speed_error_mrpm = axis->motor_h.speed_pi.speed_error_mrpm;
+	if (app_abs_i32(speed_error_mrpm) > APP_MOTOR_TEST_FAULT_TRIGGER_ABS_SPEED_ERROR_MRPM)
+	{
+		motor_fault_raise(&axis->motor_fault_h,
+						  MOTOR_FAULT_CODE_SPEED_ERROR,
+						  (uint32_t)app_abs_i32(speed_error_mrpm));
+	}
+}
+
+/**
+ * @brief Per-step control-path fault checks on the latest angle sample.
+ *
+ * Runs in the context that applies FOC (fast loop, current loop or superloop
+ * actuation); a failed check has already shut the stage down.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param angle_sample Latest published AS5600 sample.
+ * @return true if no fault is latched, false otherwise.
+ */
+static bool app_check_control_faults(app_axis_t *axis,
+									 const as5600_analog_published_sample_t *angle_sample)
+{
+	return motor_fault_check_angle_sample(&axis->motor_fault_h,
+										  angle_sample->mechanical_angle_u16,
+										  angle_sample->capture_timestamp_us,
+										  SYSTICK_GetTimeUs()) &&
+		   motor_fault_check_speed(&axis->motor_fault_h);
+}
+
+/**
+ * @brief Current-loop fault checks with the optional flux-observer takeover.
+ *
+ * In the fallback mode a sample that fails the angle checks while the
+ * observer is valid hands the angle over to the observer instead of
+ * latching; the deferred sensor fault is raised if the observer drops out.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param angle_sample Latest published AS5600 sample.
+ * @return true if no fault is latched, false otherwise.
+ */
+static bool app_check_current_loop_faults(app_axis_t *axis,
+										  const as5600_analog_published_sample_t *angle_sample)
+{
+	const motor_flux_observer_state_t *observer = &axis->motor_h.flux_observer;
+
+	if (app_flux_observer_fallback_enabled() == false) return app_check_control_faults(axis, angle_sample);
+
+	if (axis->angle_fallback_active == false)
+	{
+		motor_fault_code_t code = MOTOR_FAULT_CODE_NONE;
+		uint32_t detail = 0u;
+
+		if (!motor_fault_classify_angle_sample(&axis->motor_fault_h,
+											   angle_sample->mechanical_angle_u16,
+											   angle_sample->capture_timestamp_us,
+											   SYSTICK_GetTimeUs(),
+											   &code,
+											   &detail))
+		{
+			if ((code == MOTOR_FAULT_CODE_NONE) || (observer->is_valid == false))
+			{
+				motor_fault_raise(&axis->motor_fault_h,
+								  (code == MOTOR_FAULT_CODE_NONE) ? MOTOR_FAULT_CODE_CONTROL_LOOP : code,
+								  detail);
+				return false;
+			}
+
+			axis->angle_fallback_fault_code = (uint8_t)code;
+			axis->angle_fallback_fault_detail = detail;
+			axis->angle_fallback_active = true;
+			LOG_POST3(LOG_MSG_MOBS_TAKEOVER, code, detail, observer->mechanical_speed_mrpm);
+		}
+	}
+	else if (observer->is_valid == false)
+	{
+		motor_fault_raise(&axis->motor_fault_h,
+						  (motor_fault_code_t)axis->angle_fallback_fault_code,
+						  axis->angle_fallback_fault_detail);
+		return false;
+	}
+
+	return motor_fault_check_speed(&axis->motor_fault_h);
+}
+
+bool app_axis_get_latest_angle_sample(const app_axis_t *axis,
+									  as5600_analog_published_sample_t *published_sample)
+{
+	if (app_angle_sensor_uses_i2c())
+	{
+		return as5600_i2c_get_latest_published_sample(&axis->as5600_i2c_h, published_sample);
+	}
+	return as5600_analog_get_latest_published_sample(&axis->as5600_analog_h, published_sample);
+}
+
+void app_axis_finish_angle_linearization(app_axis_t *axis)
+{
+	const motor_angle_linearization_handle_t *linearization_h = &axis->motor_angle_linearization_h;
+
+	if (linearization_h->state != MOTOR_ANGLE_LINEARIZATION_STATE_DONE)
+	{
+		app_fatal_stop(axis->app, "ALIN", "calibration failed");
+	}
+
+	if (!as5600_analog_set_linearization(&axis->as5600_analog_h,
+										 linearization_h->correction_counts,
+										 linearization_h->cfg->point_count))
+	{
+		app_fatal_stop(axis->app, "ALIN", "table rejected");
+	}
+	/* Linearized samples shift against the raw history: restart the plausibility check. */
+	(void)motor_fault_reset_angle_history(&axis->motor_fault_h);
+
+	/* offset' = offset - pole_pairs * (linearized(alignment angle) - alignment angle). */
+	uint16_t corrected_alignment_angle_u16 =
+			as5600_analog_linearize_angle_u16(&axis->as5600_analog_h, axis->alignment_mechanical_angle_u16);
+	int32_t alignment_shift_counts =
+			(int32_t)(int16_t)(uint16_t)(corrected_alignment_angle_u16 - axis->alignment_mechanical_angle_u16);
+	uint16_t electrical_offset_u16 =
+			(uint16_t)((int32_t)axis->motor_electrical_angle_h.electrical_offset_u16 -
+					   (alignment_shift_counts * (int32_t)APP_MOTOR_TEST_POLE_PAIRS));
+
+	if (!motor_electrical_angle_set_offset(&axis->motor_electrical_angle_h, electrical_offset_u16))
+	{
+		app_fatal_stop(axis->app, "MEANG", "offset set failed");
+	}
+	axis->alignment_mechanical_angle_u16 = corrected_alignment_angle_u16;
+
+	LOG_POST3(LOG_MSG_ALIN_DONE,
+			  linearization_h->peak_to_peak_error_counts,
+			  linearization_h->recorded_sample_count,
+			  electrical_offset_u16);
+
+	for (uint8_t k = 0u; k < linearization_h->cfg->point_count; k++)
+	{
+		axis->calibration_data.linearization_counts[k] = linearization_h->correction_counts[k];
+	}
+	axis->calibration_data.linearization_point_count = linearization_h->cfg->point_count;
+	if (app_axis_uses_calibration_store(axis))
+	{
+		app_save_calibration(axis, electrical_offset_u16);
+	}
+
+	/* Ramp down from the calibration speed into the first profile segment. */
+	if (!motor_trajectory_reset(&axis->motor_trajectory_h, APP_MOTOR_TEST_ANGLE_LINEARIZATION_SPEED_MRPM))
+	{
+		app_fatal_stop(axis->app, "MTRJ", "reset failed");
+	}
+}
+
+/**
+ * @brief Run one autotune step and load the identified gain schedule when it completes.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_run_speed_pi_autotune(app_axis_t *axis)
+{
+	motor_speed_autotune_handle_t *autotune_h = &axis->motor_speed_autotune_h;
+	int32_t uq_command_permyriad = 0;
+
+	if ((!motor_speed_autotune_update(autotune_h,
+									  axis->motor_h.measurements.measured_mechanical_speed_mrpm,
+									  &uq_command_permyriad)) ||
+		(!motor_speed_pi_set_manual_output(&axis->motor_speed_pi_h, uq_command_permyriad)))
+	{
+		app_fatal_stop(axis->app, "MSAT", "update failed");
+	}
+
+	if (!app_scope_record(axis))
+	{
+		app_fatal_stop(axis->app, "SCOPE", "record failed");
+	}
+
+	if (autotune_h->state == MOTOR_SPEED_AUTOTUNE_STATE_RUNNING) return;
+	if (autotune_h->state != MOTOR_SPEED_AUTOTUNE_STATE_DONE)
+	{
+		app_fatal_stop(axis->app, "MSAT", "identification failed");
+	}
+
+	for (uint8_t i = 0u; i < autotune_h->point_count; i++)
+	{
+		LOG_POST3(LOG_MSG_MSAT_PLANT_MODEL,
+				  i,
+				  autotune_h->plant_gain_mrpm_per_permyriad_q8[i],
+				  autotune_h->plant_time_constant_us[i]);
+		LOG_POST3(LOG_MSG_MSAT_GAIN_POINT,
+				  autotune_h->points[i].speed_mrpm,
+				  autotune_h->points[i].kp_q15,
+				  autotune_h->points[i].ki_per_s_q15);
+	}
+
+	/* Hand over to the scheduled PI and start the speed profile from the current state. */
+	if ((!motor_speed_pi_set_gain_table(&axis->motor_speed_pi_h, autotune_h->points, autotune_h->point_count)) ||
+		(!motor_speed_pi_reset(&axis->motor_speed_pi_h)))
+	{
+		app_fatal_stop(axis->app, "MSPI", "gain table rejected");
+	}
+	app_speed_profile_reset(axis);
+}
+
+/**
+ * @brief Run one position-loop step and return the speed reference for the speed PI.
+ *
+ * The trajectory speed is the feedforward; the position error adds the
+ * correction. After an observer takeover the sensor angle is gone, so the
+ * trajectory speed is followed without position correction.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return Speed reference in mrpm.
+ */
+static int32_t app_update_position_controller(app_axis_t *axis)
+{
+	int32_t measured_position_counts = 0;
+	bool in_position_reached = false;
+
+	if (axis->angle_fallback_active) return axis->motor_h.trajectory.reference_mechanical_speed_mrpm;
+
+	if ((!motor_speed_reference_estimator_get_position(&axis->motor_speed_reference_estimator_h,
+													   &measured_position_counts)) ||
+		(!motor_position_control_update(&axis->motor_position_control_h,
+										axis->motor_h.trajectory.reference_mechanical_speed_mrpm,
+										axis->motor_trajectory_h.is_finished,
+										measured_position_counts,
+										&in_position_reached)))
+	{
+		app_fatal_stop(axis->app, "MPOS", "update failed");
+	}
+	if (in_position_reached)
+	{
+		LOG_POST3(LOG_MSG_APP_IN_POSITION,
+				  axis->index,
+				  axis->motor_h.position_control.target_position_counts,
+				  axis->motor_h.position_control.position_error_counts);
+	}
+
+	return axis->motor_h.position_control.speed_command_mrpm;
+}
+
+/**
+ * @brief Run one lead-angle calibration step at the held speed.
+ *
+ * The speed PI holds the calibration speed while the sweep steps the
+ * advance; once the table is installed the speed profile starts from the
+ * current state.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_run_lead_angle_calibration(app_axis_t *axis)
+{
+	motor_lead_angle_handle_t *lead_angle_h = &axis->motor_lead_angle_h;
+
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_SPEED_PI);
+	bool calibration_pi_ok = motor_speed_pi_update(&axis->motor_speed_pi_h,
+												   APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_MRPM,
+												   0,
+												   axis->motor_h.measurements.measured_mechanical_speed_mrpm);
+	PROFILER_SCOPE_END(PROFILER_PROBE_SPEED_PI);
+	if (!calibration_pi_ok)
+	{
+		app_fatal_stop(axis->app, "MSPI", "update failed");
+	}
+	if (!motor_lead_angle_calibration_update(lead_angle_h,
+											 axis->motor_h.speed_pi.speed_control_uq_command_permyriad,
+											 axis->motor_h.measurements.measured_mechanical_speed_mrpm))
+	{
+		app_fatal_stop(axis->app, "MLEAD", "calibration update failed");
+	}
+	if (!app_scope_record(axis))
+	{
+		app_fatal_stop(axis->app, "SCOPE", "record failed");
+	}
+	if (app_lead_angle_calibration_is_running(axis)) return;
+
+	if (lead_angle_h->calibration_state != MOTOR_LEAD_ANGLE_CALIBRATION_STATE_DONE)
+	{
+		app_fatal_stop(axis->app, "MLEAD", "calibration failed");
+	}
+	LOG_POST3(LOG_MSG_MLEAD_CALIBRATED,
+			  (uint32_t)lead_angle_h->calibration_best_step_index * APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS,
+			  lead_angle_h->electrical_time_constant_us,
+			  lead_angle_h->calibration_zero_mean_uq_permyriad - lead_angle_h->calibration_best_mean_uq_permyriad);
+	app_speed_profile_reset(axis);
+}
+
+/**
+ * @brief Publish the observer speed after a takeover and log a sensor divergence once per excursion.
+ *
+ * The speed feedback stops with the sensor samples, so the observer speed
+ * feeds the speed PI and the over-speed check from then on.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_update_flux_observer_report(app_axis_t *axis)
+{
+	const motor_flux_observer_state_t *observer = &axis->motor_h.flux_observer;
+
+	if (axis->angle_fallback_active)
+	{
+		axis->motor_h.measurements.measured_mechanical_speed_mrpm = observer->mechanical_speed_mrpm;
+		axis->motor_h.speed_feedback.filtered_mechanical_speed_mrpm = observer->mechanical_speed_mrpm;
+		return;
+	}
+
+	uint32_t abs_divergence_counts = (uint32_t)app_abs_i32(observer->sensor_divergence_counts);
+	if ((observer->is_valid) && (axis->observer_divergence_reported == false) &&
+		(abs_divergence_counts > APP_MOTOR_TEST_FLUX_OBSERVER_MAX_DIVERGENCE_COUNTS))
+	{
+		axis->observer_divergence_reported = true;
+		LOG_POST2(LOG_MSG_MOBS_DIVERGENCE, observer->sensor_divergence_counts, observer->mechanical_speed_mrpm);
+	}
+	else if (abs_divergence_counts <= (APP_MOTOR_TEST_FLUX_OBSERVER_MAX_DIVERGENCE_COUNTS / 2u))
+	{
+		axis->observer_divergence_reported = false;
+	}
+}
+
+/**
+ * @brief Learn the cogging table from this speed step and store it once it has settled.
+ *
+ * Learns only while a non-zero target is held (the same condition that arms
+ * the speed-error fault): ramps and the calibration runs move the PI
+ * command for reasons that do not repeat with the angle.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_update_cogging_compensation(app_axis_t *axis)
+{
+	motor_cogging_compensation_handle_t *cogging_h = &axis->motor_cogging_compensation_h;
+
+	if (app_speed_error_fault_is_armed(axis) == false)
+	{
+		if (!motor_cogging_compensation_learn_stop(cogging_h))
+		{
+			app_fatal_stop(axis->app, "MCOG", "learn stop failed");
+		}
+		return;
+	}
+
+	if (!motor_cogging_compensation_learn(cogging_h,
+										  axis->motor_h.measurements.mechanical_angle_u16,
+										  axis->motor_h.speed_pi.speed_control_uq_command_permyriad))
+	{
+		app_fatal_stop(axis->app, "MCOG", "learn failed");
+	}
+
+	if ((axis->cogging_table_saved) ||
+		(cogging_h->learned_revolution_count < APP_MOTOR_TEST_COGGING_COMPENSATION_SAVE_REVOLUTION_COUNT) ||
+		(app_axis_uses_calibration_store(axis) == false))
+	{
+		return;
+	}
+
+	if (!motor_cogging_compensation_get_table(cogging_h,
+											  axis->calibration_data.cogging_uq_permyriad,
+											  CALIBRATION_STORE_COGGING_POINTS))
+	{
+		app_fatal_stop(axis->app, "MCOG", "table export failed");
+	}
+	axis->calibration_data.cogging_point_count = cogging_h->cfg->point_count;
+	axis->cogging_table_saved = true;
+
+	int32_t peak_permyriad = 0;
+	for (uint8_t k = 0u; k < cogging_h->cfg->point_count; k++)
+	{
+		int32_t value = axis->calibration_data.cogging_uq_permyriad[k];
+		if (value < 0) value = -value;
+		if (value > peak_permyriad) peak_permyriad = value;
+	}
+	LOG_POST2(LOG_MSG_MCOG_LEARNED, cogging_h->learned_revolution_count, peak_permyriad);
+
+	app_save_calibration(axis, axis->motor_electrical_angle_h.electrical_offset_u16);
+}
+
+void app_axis_update_speed_controller(app_axis_t *axis)
+{
+	if ((axis->alignment_done == false) ||
+		(axis->motor_h.status.has_valid_mechanical_speed == false))
+	{
+		return;
+	}
+
+	if (app_flux_observer_enabled())
+	{
+		app_update_flux_observer_report(axis);
+	}
+
+	/* The identification experiment drives the command until it has loaded the gain schedule. */
+	if (app_speed_pi_autotune_is_running(axis))
+	{
+		app_run_speed_pi_autotune(axis);
+		return;
+	}
+
+	/* The lead-angle sweep holds one constant speed until its table is installed. */
+	if (app_lead_angle_calibration_is_running(axis))
+	{
+		app_run_lead_angle_calibration(axis);
+		return;
+	}
+
+	/* The linearization run holds one constant speed until its table is installed. */
+	if (app_angle_linearization_is_running(axis))
+	{
+		PROFILER_SCOPE_BEGIN(PROFILER_PROBE_SPEED_PI);
+		bool linearization_pi_ok = motor_speed_pi_update(&axis->motor_speed_pi_h,
+														 APP_MOTOR_TEST_ANGLE_LINEARIZATION_SPEED_MRPM,
+														 0,
+														 axis->motor_h.measurements.measured_mechanical_speed_mrpm);
+		PROFILER_SCOPE_END(PROFILER_PROBE_SPEED_PI);
+		if (!linearization_pi_ok)
+		{
+			app_fatal_stop(axis->app, "MSPI", "update failed");
+		}
+		if (!app_scope_record(axis))
+		{
+			app_fatal_stop(axis->app, "SCOPE", "record failed");
+		}
+		return;
+	}
+
+	/* Host points replace the trajectory; otherwise S-curve ramps between held targets (profile or setpoint). */
+	if (app_command_get_active_params(axis->app)->reference_mode == (uint8_t)APP_REFERENCE_MODE_STREAM)
+	{
+		const app_reference_point_t *point = &axis->app->reference_stream.current;
+
+		if (!motor_trajectory_set_external_reference(&axis->motor_trajectory_h,
+													 point->speed_mrpm,
+													 point->acceleration_mrpm_per_s))
+		{
+			app_fatal_stop(axis->app, "MTRJ", "stream reference failed");
+		}
+	}
+	else
+	{
+		app_speed_profile_update(axis);
+	}
+
+	/* Position mode: the position loop turns the trajectory speed into the speed reference. */
+	int32_t speed_reference_mrpm = axis->motor_h.trajectory.reference_mechanical_speed_mrpm;
+	if (app_command_get_active_params(axis->app)->reference_mode == (uint8_t)APP_REFERENCE_MODE_POSITION)
+	{
+		speed_reference_mrpm = app_update_position_controller(axis);
+	}
+
+	/* Use the current profile reference for the active PI update. */
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_SPEED_PI);
+	bool speed_pi_ok = motor_speed_pi_update(&axis->motor_speed_pi_h,
+											 speed_reference_mrpm,
+											 axis->motor_h.trajectory.reference_mechanical_acceleration_mrpm_per_s,
+											 axis->motor_h.measurements.measured_mechanical_speed_mrpm);
+	PROFILER_SCOPE_END(PROFILER_PROBE_SPEED_PI);
+	if (!speed_pi_ok)
+	{
+		app_fatal_stop(axis->app, "MSPI", "update failed");
+	}
+
+	/* Ud from the voltage margin of this command; the next PI step sees the Uq left on the circle. */
+	if ((app_field_weakening_enabled()) &&
+		((!motor_field_weakening_update(&axis->motor_field_weakening_h,
+										axis->motor_h.speed_pi.speed_control_uq_command_permyriad,
+										axis->motor_h.measurements.measured_mechanical_speed_mrpm)) ||
+		 (!motor_speed_pi_set_output_limit(&axis->motor_speed_pi_h,
+										   (uint16_t)axis->motor_h.field_weakening.uq_limit_permyriad))))
+	{
+		app_fatal_stop(axis->app, "MFW", "update failed");
+	}
+
+	/* Advance for the measured speed; the FOC step adds it to the electrical angle. */
+	if ((app_lead_angle_enabled()) &&
+		(!motor_lead_angle_update(&axis->motor_lead_angle_h, axis->motor_h.measurements.measured_mechanical_speed_mrpm)))
+	{
+		app_fatal_stop(axis->app, "MLEAD", "update failed");
+	}
+
+	if (app_cogging_compensation_enabled())
+	{
+		app_update_cogging_compensation(axis);
+	}
+
+	/* One scope sample per control step (no-op unless armed or post-trigger). */
+	if (!app_scope_record(axis))
+	{
+		app_fatal_stop(axis->app, "SCOPE", "record failed");
+	}
+}
+
+/**
+ * @brief Refresh the electrical angle used by the next FOC actuation.
+ *
+ * With prediction the angle is extrapolated over the sample age plus the
+ * configured actuation delay; otherwise the sample angle is used directly.
+ * After a flux-observer takeover the observer angle replaces the sample.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param angle_sample Latest published AS5600 sample.
+ * @return true if the electrical angle was updated, false otherwise.
+ */
+static bool app_refresh_actuation_electrical_angle(app_axis_t *axis,
+												   const as5600_analog_published_sample_t *angle_sample)
+{
+	/* Fallback: observer angle of this current sample, carried over the same actuation delay. */
+	if (axis->angle_fallback_active)
+	{
+		axis->motor_h.measurements.electrical_angle_u16 =
+				motor_flux_observer_predict_angle(&axis->motor_flux_observer_h,
+												  app_angle_prediction_enabled() ?
+												  APP_MOTOR_TEST_ANGLE_PREDICTION_ACTUATION_DELAY_US : 0u);
+		return true;
+	}
+
+	if (app_angle_prediction_enabled() == false)
+	{
+		return motor_electrical_angle_update(&axis->motor_electrical_angle_h,
+											 angle_sample->mechanical_angle_u16);
+	}
+
+	/* horizon = (now - capture) + actuation delay, the capture instant is the window center. */
+	uint64_t now_us = SYSTICK_GetTimeUs();
+	uint64_t sample_age_us = (now_us > angle_sample->capture_timestamp_us) ?
+			(now_us - angle_sample->capture_timestamp_us) : 0u;
+	if (sample_age_us > APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US)
+	{
+		sample_age_us = APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US;
+	}
+
+	return motor_electrical_angle_update_predicted(&axis->motor_electrical_angle_h,
+												   angle_sample->mechanical_angle_u16,
+												   (uint32_t)sample_age_us +
+												   APP_MOTOR_TEST_ANGLE_PREDICTION_ACTUATION_DELAY_US);
+}
+
+/**
+ * @brief Apply q-only sensored voltage actuation with the latest controller Uq.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true if the FOC kernel accepted the command, false otherwise.
+ */
+static bool app_apply_foc_actuation(app_axis_t *axis)
+{
+	/* Use the current limited speed-controller output as the applied q-axis command. */
+	int32_t uq_command_permyriad = axis->motor_h.speed_pi.speed_control_uq_command_permyriad;
+
+	/* Cogging feedforward at the latest sample angle, kept inside the active speed-PI limit. */
+	if (app_cogging_compensation_enabled())
+	{
+		const int32_t limit_permyriad = (int32_t)axis->motor_speed_pi_h.output_limit_permyriad;
+
+		if (!motor_cogging_compensation_apply(&axis->motor_cogging_compensation_h,
+											  axis->motor_h.measurements.mechanical_angle_u16))
+		{
+			return false;
+		}
+		uq_command_permyriad += axis->motor_h.cogging.uq_correction_permyriad;
+		if (uq_command_permyriad > limit_permyriad) uq_command_permyriad = limit_permyriad;
+		if (uq_command_permyriad < -limit_permyriad) uq_command_permyriad = -limit_permyriad;
+	}
+	axis->applied_uq_command_permyriad = (int16_t)uq_command_permyriad;
+
+	/* Field weakening publishes a negative Ud above base speed, 0 otherwise (also when disabled). */
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_FOC_APPLY_DQ);
+	bool apply_ok = motor_foc_voltage_apply_dq(&axis->motor_foc_voltage_h,
+											   (int16_t)axis->motor_h.field_weakening.ud_command_permyriad,
+											   axis->applied_uq_command_permyriad);
+	PROFILER_SCOPE_END(PROFILER_PROBE_FOC_APPLY_DQ);
+
+	return apply_ok;
+}
+
+/**
+ * @brief Apply the speed-PI Uq as the signed 6-step duty and track the sector.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true if the command was accepted, false otherwise.
+ */
+static bool app_apply_6step_com_actuation(app_axis_t *axis)
+{
+	axis->applied_uq_command_permyriad =
+			(int16_t)axis->motor_h.speed_pi.speed_control_uq_command_permyriad;
+
+	/* Same q-axis handedness as the FOC kernel. */
+	return motor_6step_com_set_command(&axis->motor_6step_com_h,
+									   (int16_t)(axis->applied_uq_command_permyriad *
+												 APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN)) &&
+		   motor_6step_com_service(&axis->motor_6step_com_h);
+}
+
+/**
+ * @brief Take the pending telemetry snapshot at the end of one ISR control cycle.
+ *
+ * The actuation task requests one snapshot per actuation period after the
+ * speed step, so the speed-step channels are complete and uq, angle and
+ * currents all belong to the cycle that just ended.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_sample_telemetry_stream(app_axis_t *axis)
+{
+	if ((axis->index != 0u) || (axis->app->telemetry_sample_pending == false)) return;
+
+	axis->app->telemetry_sample_pending = false;
+	(void)telemetry_stream_sample(&axis->app->telemetry_stream_h, (uint32_t)SYSTICK_GetTimeUs());
+}
+
+/**
+ * @brief Run one PWM-synchronous fast-loop step.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_run_fast_loop(app_axis_t *axis)
+{
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_FAST_LOOP_ISR);
+	as5600_analog_published_sample_t latest_angle_sample = {0};
+
+	/* Update-event to callback latency: timer ticks since the counter turned, in CPU cycles. */
+	PROFILER_RECORD(PROFILER_PROBE_FAST_LOOP_LATENCY,
+					pwm_tim1_get_ticks_since_update(axis->pwm_h) * (SYSCLK_HZ / APB2_TIM_CLK_HZ));
+
+	if ((axis->alignment_done == false) || (motor_fault_is_latched(&axis->motor_fault_h))) return;
+	if (!app_axis_get_latest_angle_sample(axis, &latest_angle_sample)) return;
+	if (!app_check_control_faults(axis, &latest_angle_sample)) return;
+
+	if ((!app_refresh_actuation_electrical_angle(axis, &latest_angle_sample)) ||
+		(!app_apply_foc_actuation(axis)))
+	{
+		motor_fault_raise(&axis->motor_fault_h,
+						  MOTOR_FAULT_CODE_CONTROL_LOOP,
+						  axis->motor_h.measurements.electrical_angle_u16);
+		LOG_POST2(LOG_MSG_MFOC_FAST_LOOP_FAULT,
+				  axis->motor_h.measurements.electrical_angle_u16,
+				  axis->applied_uq_command_permyriad);
+	}
+	else
+	{
+		app_timing_record_actuation_latency(axis, &latest_angle_sample);
+	}
+
+	/* UIF set again: this step ran into the next update event (detail = ticks into it). */
+	if (pwm_tim1_is_update_pending(axis->pwm_h))
+	{
+		motor_fault_raise(&axis->motor_fault_h,
+						  MOTOR_FAULT_CODE_DEADLINE_MISSED,
+						  pwm_tim1_get_ticks_since_update(axis->pwm_h));
+	}
+
+	/* Only the full control path is recorded; early returns are idle ticks. */
+	PROFILER_SCOPE_END(PROFILER_PROBE_FAST_LOOP_ISR);
+}
+
+void app_axis_fast_loop_callback(void *callback_arg)
+{
+	app_axis_t *axis = (app_axis_t *)callback_arg;
+
+	if (axis == NULL) return;
+
+	app_run_fast_loop(axis);
+	app_sample_telemetry_stream(axis);
+}
+
+/**
+ * @brief Run one current-loop step on the shunt samples of one PWM period.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param samples Raw shunt samples in phase order.
+ * @param sample_count Number of raw samples.
+ */
+static void app_run_current_loop(app_axis_t *axis, const uint16_t *samples, uint8_t sample_count)
+{
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_CURRENT_LOOP);
+	as5600_analog_published_sample_t latest_angle_sample = {0};
+
+	/* Offset calibration consumes the sequences until it completes. */
+	if (!motor_current_sense_process(&axis->motor_current_sense_h, samples, sample_count)) return;
+	if ((axis->alignment_done == false) || (motor_fault_is_latched(&axis->motor_fault_h))) return;
+	if (!app_axis_get_latest_angle_sample(axis, &latest_angle_sample)) return;
+	/* The observer integrates the period that just ended; its validity gates the takeover below. */
+	if ((app_flux_observer_enabled()) && (!motor_flux_observer_update(&axis->motor_flux_observer_h)))
+	{
+		motor_fault_raise(&axis->motor_fault_h, MOTOR_FAULT_CODE_CONTROL_LOOP, 0u);
+		return;
+	}
+	if (!app_check_current_loop_faults(axis, &latest_angle_sample)) return;
+
+	bool loop_ok = app_refresh_actuation_electrical_angle(axis, &latest_angle_sample) &&
+				   motor_current_sense_update_dq(&axis->motor_current_sense_h) &&
+				   motor_current_pi_update(&axis->motor_current_pi_h,
+										   0,
+										   axis->motor_h.speed_pi.speed_control_iq_reference_ma);
+	if (loop_ok)
+	{
+		axis->applied_uq_command_permyriad = (int16_t)axis->motor_h.current_pi.uq_command_permyriad;
+		loop_ok = motor_foc_voltage_apply_dq(&axis->motor_foc_voltage_h,
+											 (int16_t)axis->motor_h.current_pi.ud_command_permyriad,
+											 axis->applied_uq_command_permyriad);
+	}
+	if ((loop_ok) && (app_flux_observer_enabled()))
+	{
+		loop_ok = motor_flux_observer_set_voltage(&axis->motor_flux_observer_h,
+												  (int16_t)axis->motor_h.current_pi.ud_command_permyriad,
+												  axis->applied_uq_command_permyriad,
+												  (uint16_t)((int32_t)axis->motor_h.measurements.electrical_angle_u16 +
+															 axis->motor_h.lead_angle.advance_counts));
+	}
+
+	if (!loop_ok)
+	{
+		motor_fault_raise(&axis->motor_fault_h, MOTOR_FAULT_CODE_CONTROL_LOOP, (uint32_t)axis->motor_h.current.iq_ma);
+		(void)adc_injected_set_trigger(&CURRENT_SENSE_ADC2_H, false);
+		LOG_POST2(LOG_MSG_MCPI_CURRENT_LOOP_FAULT, axis->motor_h.current.id_ma, axis->motor_h.current.iq_ma);
+	}
+	else if (axis->angle_fallback_active == false)
+	{
+		/* After a takeover the angle no longer comes from the sample. */
+		app_timing_record_actuation_latency(axis, &latest_angle_sample);
+	}
+
+	/* JEOC set again: the next shunt sequence completed while this loop was running. */
+	if (adc_injected_is_pending(&CURRENT_SENSE_ADC2_H))
+	{
+		motor_fault_raise(&axis->motor_fault_h,
+						  MOTOR_FAULT_CODE_DEADLINE_MISSED,
+						  pwm_tim1_get_ticks_since_update(axis->pwm_h));
+	}
+
+	/* Only the full control path is recorded; calibration and idle sequences are skipped. */
+	PROFILER_SCOPE_END(PROFILER_PROBE_CURRENT_LOOP);
+}
+
+void app_axis_current_loop_callback(void *callback_arg, const uint16_t *samples, uint8_t sample_count)
+{
+	app_axis_t *axis = (app_axis_t *)callback_arg;
+
+	if (axis == NULL) return;
+
+	app_run_current_loop(axis, samples, sample_count);
+	app_sample_telemetry_stream(axis);
+}
+
+void app_axis_update_runtime_actuation(app_axis_t *axis, uint32_t now_ms)
+{
+	uint16_t raw_electrical_angle_u16 = 0u;
+	uint16_t electrical_offset_u16 = 0u;
+
+	/* Hold the alignment vector before phase progression starts. */
+	if (axis->alignment_done == false)
+	{
+		/* A stored calibration needs no alignment hold, only the first valid sample. */
+		if ((axis->has_stored_calibration) ||
+			((now_ms - axis->alignment_start_ms) >= APP_MOTOR_TEST_ALIGNMENT_DURATION_MS))
+		{
+			/* Wait for one valid consumed sensor sample before alignment calibration. */
+			if (axis->latest_sample_valid == false)
+			{
+				return;
+			}
+
+			/* Convert measured mechanical angle into raw electrical angle without offset. */
+			if (!motor_electrical_angle_compute_raw(&axis->motor_electrical_angle_h,
+													axis->latest_logged_mechanical_angle_u16,
+													&raw_electrical_angle_u16))
+			{
+				app_fatal_stop(axis->app, "MEANG", "raw angle failed");
+			}
+
+			/* The offset belongs to this sensor angle (the stored one for a stored offset). */
+			axis->alignment_mechanical_angle_u16 = axis->has_stored_calibration ?
+					axis->calibration_data.alignment_mechanical_angle_u16 :
+					axis->latest_logged_mechanical_angle_u16;
+
+			/* offset = commanded_alignment_electrical - measured_raw_electrical. */
+			electrical_offset_u16 = axis->has_stored_calibration ?
+					axis->calibration_data.electrical_offset_u16 :
+					(uint16_t)(APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16 -
+							   raw_electrical_angle_u16);
+			if (!motor_electrical_angle_set_offset(&axis->motor_electrical_angle_h, electrical_offset_u16))
+			{
+				app_fatal_stop(axis->app, "MEANG", "offset set failed");
+			}
+
+			/* Publish the calibrated measured electrical angle from the same alignment sample. */
+			if (!motor_electrical_angle_update(&axis->motor_electrical_angle_h, axis->latest_logged_mechanical_angle_u16))
+			{
+				app_fatal_stop(axis->app, "MEANG", "aligned update failed");
+			}
+
+			/* Start q-only FOC runtime with zero Uq before first closed-loop update is applied. */
+			if (!motor_speed_pi_reset(&axis->motor_speed_pi_h))
+			{
+				app_fatal_stop(axis->app, "MSPI", "reset failed");
+			}
+			if ((app_field_weakening_enabled()) &&
+				(!motor_field_weakening_reset(&axis->motor_field_weakening_h)))
+			{
+				app_fatal_stop(axis->app, "MFW", "reset failed");
+			}
+			/* Current loop starts from empty integrators once alignment_done releases it. */
+			if ((app_torque_control_uses_current_loop()) &&
+				(!motor_current_pi_reset(&axis->motor_current_pi_h)))
+			{
+				app_fatal_stop(axis->app, "MCPI", "reset failed");
+			}
+			/* The observer starts on the aligned rotor; it is valid once spinning and locked. */
+			if ((app_flux_observer_enabled()) &&
+				(!motor_flux_observer_reset(&axis->motor_flux_observer_h,
+											axis->motor_h.measurements.electrical_angle_u16)))
+			{
+				app_fatal_stop(axis->app, "MOBS", "reset failed");
+			}
+			/* Start the trajectory from the first segment (zero hold in the default table). */
+			app_speed_profile_reset(axis);
+			/* Optional identification runs first and starts the profile again when it completes. */
+			if ((app_speed_pi_autotune_enabled()) &&
+				(!motor_speed_autotune_start(&axis->motor_speed_autotune_h,
+											 axis->motor_h.measurements.measured_mechanical_speed_mrpm)))
+			{
+				app_fatal_stop(axis->app, "MSAT", "start failed");
+			}
+			/* The phase-advance sweep runs at its own constant speed before the profile. */
+			if ((APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE == APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_ON) &&
+				(!motor_lead_angle_calibration_start(&axis->motor_lead_angle_h)))
+			{
+				app_fatal_stop(axis->app, "MLEAD", "calibration start failed");
+			}
+			/* Without an installed table the sensor linearization run comes first. */
+			if ((app_angle_linearization_enabled()) &&
+				(axis->as5600_analog_h.linearization_point_count == 0u) &&
+				(!motor_angle_linearization_start(&axis->motor_angle_linearization_h, SYSTICK_GetTimeUs())))
+			{
+				app_fatal_stop(axis->app, "ALIN", "start failed");
+			}
+			axis->applied_uq_command_permyriad = 0u;
+			/* 6-step takes over from the alignment vector with zero duty. */
+			if (app_drive_uses_6step_com())
+			{
+				if ((!motor_6step_com_set_command(&axis->motor_6step_com_h, 0)) ||
+					(!motor_6step_com_start(&axis->motor_6step_com_h)))
+				{
+					app_fatal_stop(axis->app, "6STEP", "start failed");
+				}
+			}
+			axis->alignment_done = true;
+			LOG_POST2(LOG_MSG_APP_ALIGNMENT_DONE, electrical_offset_u16, raw_electrical_angle_u16);
+			if ((app_axis_uses_calibration_store(axis)) && (axis->has_stored_calibration == false))
+			{
+				app_save_calibration(axis, electrical_offset_u16);
+			}
+		}
+
+		return;
+	}
+
+	/* In current mode the ADC2 interrupt applies FOC and runs the fault checks (reported by the fault task). */
+	if (app_torque_control_uses_current_loop()) return;
+
+	/* In PWM ISR mode the fast loop applies FOC and runs the fault checks. */
+	if (app_control_loop_uses_pwm_isr()) return;
+
+	/* Superloop actuation: the per-step fault checks run here on the latest sample. */
+	as5600_analog_published_sample_t latest_angle_sample = {0};
+	bool has_latest_sample = app_axis_get_latest_angle_sample(axis, &latest_angle_sample);
+
+	if (motor_fault_is_latched(&axis->motor_fault_h)) return;
+	if ((has_latest_sample) && (!app_check_control_faults(axis, &latest_angle_sample))) return;
+
+	/* 6-step: COM events commutate, the step only sets the duty and checks the sector. */
+	if (app_drive_uses_6step_com())
+	{
+		if (!app_apply_6step_com_actuation(axis))
+		{
+			app_fatal_stop(axis->app, "6STEP", "apply failed");
+		}
+		return;
+	}
+
+	/* After alignment, apply q-only sensored voltage actuation with controller-driven Uq. */
+	/* With prediction, extrapolate the latest sample to this actuation interval. */
+	if (app_angle_prediction_enabled())
+	{
+		if ((!has_latest_sample) ||
+			(!app_refresh_actuation_electrical_angle(axis, &latest_angle_sample)))
+		{
+			app_fatal_stop(axis->app, "MEANG", "predicted update failed");
+		}
+	}
+
+	if (!app_apply_foc_actuation(axis))
+	{
+		app_fatal_stop(axis->app, "MFOC", "apply failed");
+	}
+	if (has_latest_sample) app_timing_record_actuation_latency(axis, &latest_angle_sample);
+}
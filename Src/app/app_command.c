@@ -0,0 +1,647 @@
+/**
+ * @file app_command.c
+ * @brief Host command handling and runtime parameter implementation.
+ *
+ *  Notes:
+ *  - payload layouts and the parameter ids are mirrored in tools/command_send.py.
+ *  - host speeds are checked against the over-speed fault limit before they
+ *    reach a block or the stream.
+ */
+
+#include "app/app_command.h"
+#include <stdio.h>
+#include "drivers/log.h"
+
+/* Binary telemetry frame type for one host command acknowledgement. */
+#define APP_TELEMETRY_FRAME_TYPE_COMMAND_ACK      0x05u
+/* Streamed reference point on the wire: i32 speed_mrpm, i32 acceleration_mrpm_per_s. */
+#define APP_REFERENCE_POINT_SIZE                  8u
+
+/* Host command types (payload layouts in tools/command_send.py). */
+typedef enum app_command_type_t {
+	APP_COMMAND_SET_SPEED = 0x01,             /* i32 setpoint_mrpm: hold one speed, commits at once */
+	APP_COMMAND_STREAM_REFERENCE = 0x02,      /* n x (i32 speed_mrpm, i32 acceleration_mrpm_per_s) */
+	APP_COMMAND_SET_PARAM = 0x03,             /* u8 param_id, i32 value: staged in the shadow block */
+	APP_COMMAND_APPLY = 0x04,                 /* commit the shadow block at the next speed-control step */
+	APP_COMMAND_DISCARD = 0x05,               /* drop the staged changes */
+	APP_COMMAND_MOVE_TO = 0x06,               /* i32 target_counts: position move, commits at once */
+	APP_COMMAND_MOVE_RELATIVE = 0x07,         /* i32 delta_counts: added to the current target, commits at once */
+} app_command_type_t;
+
+/* Acknowledgement status (one per received command). */
+typedef enum app_command_status_t {
+	APP_COMMAND_STATUS_OK = 0,
+	APP_COMMAND_STATUS_UNKNOWN_COMMAND,
+	APP_COMMAND_STATUS_BAD_LENGTH,
+	APP_COMMAND_STATUS_UNKNOWN_PARAM,
+	APP_COMMAND_STATUS_BAD_VALUE,
+	APP_COMMAND_STATUS_STREAM_FULL,
+} app_command_status_t;
+
+/* SET_PARAM identifiers. */
+typedef enum app_param_id_t {
+	APP_PARAM_SPEED_PI_KP_Q15 = 0,
+	APP_PARAM_SPEED_PI_KI_PER_S_Q15,
+	APP_PARAM_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
+	APP_PARAM_PROFILE_PEAK_SPEED_MRPM,
+	APP_PARAM_PROFILE_PEAK_HOLD_MS,
+	APP_PARAM_PROFILE_ZERO_HOLD_MS,
+	APP_PARAM_PROFILE_ACCELERATION_MRPM_PER_S,
+	APP_PARAM_PROFILE_JERK_MRPM_PER_S2,
+	APP_PARAM_TELEMETRY_CHANNEL_MASK,
+	APP_PARAM_REFERENCE_MODE,
+	APP_PARAM_TELEMETRY_DECIMATION,           /* (channel id << 16) | decimation in control cycles */
+	APP_PARAM_POSITION_KP_Q15,
+	APP_PARAM_POSITION_MAX_SPEED_MRPM,
+	APP_PARAM_COUNT,
+} app_param_id_t;
+
+/**
+ * @brief Build the boot parameter block from the configuration defaults.
+ *
+ * @return Default runtime parameters.
+ */
+static app_param_block_t app_default_params(void)
+{
+	app_param_block_t params = {
+			.speed_pi_kp_q15 = APP_MOTOR_TEST_SPEED_PI_KP_Q15,
+			.speed_pi_ki_per_s_q15 = APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15,
+			.speed_feedback_filter_time_constant_ms = APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
+			.telemetry_channel_mask = APP_MOTOR_TEST_TELEMETRY_CHANNEL_MASK,
+			.telemetry_decimation = APP_MOTOR_TEST_TELEMETRY_CHANNEL_DECIMATION,
+			.reference_mode = (uint8_t)APP_REFERENCE_MODE_PROFILE,
+			.speed_setpoint_mrpm = 0,
+			.profile_peak_speed_mrpm = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM,
+			.profile_peak_hold_ms = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_HOLD_MS,
+			.profile_zero_hold_ms = APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS,
+			.profile_acceleration_mrpm_per_s = APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S,
+			.profile_jerk_mrpm_per_s2 = APP_MOTOR_TEST_SPEED_PROFILE_JERK_MRPM_PER_S2,
+			.position_kp_q15 = APP_MOTOR_TEST_POSITION_KP_Q15,
+			.position_max_speed_mrpm = APP_MOTOR_TEST_POSITION_MAX_SPEED_MRPM,
+	};
+
+	return params;
+}
+
+const app_param_block_t *app_command_get_active_params(const app_context_t *app)
+{
+	return &app->param_blocks[app->active_param_index];
+}
+
+/**
+ * @brief Return the shadow parameter block (write side of the double buffer).
+ *
+ * @param app Pointer to application runtime context.
+ * @return Pointer to the staged parameters.
+ */
+static app_param_block_t *app_shadow_params(app_context_t *app)
+{
+	return &app->param_blocks[app->active_param_index ^ 1u];
+}
+
+motor_trajectory_profile_t app_command_build_reference_profile(app_context_t *app, const app_param_block_t *params)
+{
+	motor_trajectory_profile_t profile = {
+			.segments = app->speed_profile_segments,
+			.segment_count = APP_SPEED_PROFILE_SEGMENT_COUNT,
+			.is_cyclic = true,
+			.max_acceleration_mrpm_per_s = params->profile_acceleration_mrpm_per_s,
+			.max_jerk_mrpm_per_s2 = params->profile_jerk_mrpm_per_s2,
+	};
+
+	if (params->reference_mode == (uint8_t)APP_REFERENCE_MODE_SETPOINT)
+	{
+		app->setpoint_segment = (motor_trajectory_segment_t){
+				.target_mechanical_speed_mrpm = params->speed_setpoint_mrpm,
+		};
+		profile.segments = &app->setpoint_segment;
+		profile.segment_count = 1u;
+		profile.is_cyclic = false;
+		return profile;
+	}
+	if (params->reference_mode == (uint8_t)APP_REFERENCE_MODE_POSITION)
+	{
+		app->position_hold_segment = (motor_trajectory_segment_t){
+				.target_mechanical_speed_mrpm = 0,
+		};
+		profile.segments = &app->position_hold_segment;
+		profile.segment_count = 1u;
+		profile.is_cyclic = false;
+		return profile;
+	}
+
+	app->speed_profile_segments[0] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = params->profile_zero_hold_ms };
+	app->speed_profile_segments[1] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = params->profile_peak_speed_mrpm, .hold_ms = params->profile_peak_hold_ms };
+	app->speed_profile_segments[2] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = params->profile_zero_hold_ms };
+	app->speed_profile_segments[3] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = -params->profile_peak_speed_mrpm, .hold_ms = params->profile_peak_hold_ms };
+	app->speed_profile_segments[4] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = params->profile_zero_hold_ms };
+
+	return profile;
+}
+
+void app_command_init(app_context_t *app)
+{
+	if (app == NULL) return;
+
+	app->param_blocks[0] = app_default_params();
+	app->param_blocks[1] = app->param_blocks[0];
+	app->active_param_index = 0u;
+	app->param_apply_pending = false;
+	app->reference_stream = (app_reference_stream_t){0};
+	app->position_move = (app_position_move_t){0};
+	/* The boot tables back the trajectory cfg of every axis. */
+	(void)app_command_build_reference_profile(app, &app->param_blocks[0]);
+}
+
+/**
+ * @brief Check whether any axis runs a multi-point (autotuned) gain schedule.
+ *
+ * @param app Pointer to application runtime context.
+ * @return true if a schedule with more than one breakpoint is installed.
+ */
+static bool app_speed_pi_schedule_is_installed(const app_context_t *app)
+{
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		if (app->axis[i].motor_speed_pi_h.gain_point_count > 1u) return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Apply one committed Kp / Ki pair to the speed PI of one axis.
+ *
+ * A multi-point schedule is scaled by committed / active so its shape is
+ * kept; otherwise the pair becomes one flat breakpoint.
+ *
+ * @param axis Pointer to axis runtime.
+ * @param active Pointer to the parameters running so far.
+ * @param committed Pointer to the parameters being committed.
+ * @return true if the gains were accepted, false otherwise.
+ */
+static bool app_apply_speed_pi_gains(app_axis_t *axis,
+									 const app_param_block_t *active,
+									 const app_param_block_t *committed)
+{
+	const motor_speed_pi_gain_point_t gain_point = {
+			.speed_mrpm = 0u,
+			.kp_q15 = committed->speed_pi_kp_q15,
+			.ki_per_s_q15 = committed->speed_pi_ki_per_s_q15,
+	};
+
+	/* An unchanged gain scales by 1 (also when it is 0). */
+	bool kp_changed = (committed->speed_pi_kp_q15 != active->speed_pi_kp_q15);
+	bool ki_changed = (committed->speed_pi_ki_per_s_q15 != active->speed_pi_ki_per_s_q15);
+
+	if (axis->motor_speed_pi_h.gain_point_count > 1u)
+	{
+		return motor_speed_pi_scale_gain_table(&axis->motor_speed_pi_h,
+											   kp_changed ? committed->speed_pi_kp_q15 : 1,
+											   kp_changed ? active->speed_pi_kp_q15 : 1,
+											   ki_changed ? committed->speed_pi_ki_per_s_q15 : 1,
+											   ki_changed ? active->speed_pi_ki_per_s_q15 : 1);
+	}
+
+	return motor_speed_pi_set_gain_table(&axis->motor_speed_pi_h, &gain_point, 1u);
+}
+
+void app_command_apply_pending_params(app_context_t *app)
+{
+	if (app->param_apply_pending == false) return;
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		if ((app_speed_pi_autotune_is_running(&app->axis[i])) ||
+			(app_angle_linearization_is_running(&app->axis[i])) ||
+			(app_lead_angle_calibration_is_running(&app->axis[i])))
+		{
+			return;
+		}
+	}
+
+	const app_param_block_t *active = app_command_get_active_params(app);
+	const app_param_block_t *committed = app_shadow_params(app);
+	bool gains_changed = (committed->speed_pi_kp_q15 != active->speed_pi_kp_q15) ||
+						 (committed->speed_pi_ki_per_s_q15 != active->speed_pi_ki_per_s_q15);
+	bool filter_changed = (committed->speed_feedback_filter_time_constant_ms !=
+						   active->speed_feedback_filter_time_constant_ms);
+	bool position_changed = (committed->position_kp_q15 != active->position_kp_q15) ||
+							(committed->position_max_speed_mrpm != active->position_max_speed_mrpm);
+	bool reference_changed = (committed->reference_mode != active->reference_mode) ||
+							 (committed->speed_setpoint_mrpm != active->speed_setpoint_mrpm) ||
+							 (committed->profile_peak_speed_mrpm != active->profile_peak_speed_mrpm) ||
+							 (committed->profile_peak_hold_ms != active->profile_peak_hold_ms) ||
+							 (committed->profile_zero_hold_ms != active->profile_zero_hold_ms) ||
+							 (committed->profile_acceleration_mrpm_per_s != active->profile_acceleration_mrpm_per_s) ||
+							 (committed->profile_jerk_mrpm_per_s2 != active->profile_jerk_mrpm_per_s2);
+	motor_trajectory_profile_t profile = {0};
+
+	if (reference_changed)
+	{
+		profile = app_command_build_reference_profile(app, committed);
+	}
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_t *axis = &app->axis[i];
+
+		if ((gains_changed) && (!app_apply_speed_pi_gains(axis, active, committed)))
+		{
+			app_fatal_stop(app, "MSPI", "gain update rejected");
+		}
+		if ((filter_changed) &&
+			(!motor_speed_feedback_set_filter_time_constant(&axis->motor_speed_feedback_h,
+															committed->speed_feedback_filter_time_constant_ms)))
+		{
+			app_fatal_stop(app, "MSPD", "filter update rejected");
+		}
+		if ((reference_changed) && (!motor_trajectory_set_profile(&axis->motor_trajectory_h, &profile)))
+		{
+			app_fatal_stop(app, "MTRJ", "profile rejected");
+		}
+		if ((position_changed) &&
+			((!motor_position_control_set_gains(&axis->motor_position_control_h,
+												committed->position_kp_q15,
+												APP_MOTOR_TEST_POSITION_KI_PER_S_Q15)) ||
+			 (!motor_position_control_set_max_speed(&axis->motor_position_control_h,
+													committed->position_max_speed_mrpm))))
+		{
+			app_fatal_stop(app, "MPOS", "update rejected");
+		}
+		/* A new position-mode table stops the axis: the loop re-anchors and holds where it comes to rest. */
+		if ((reference_changed) &&
+			(committed->reference_mode == (uint8_t)APP_REFERENCE_MODE_POSITION) &&
+			(!motor_position_control_reset(&axis->motor_position_control_h)))
+		{
+			app_fatal_stop(app, "MPOS", "reset failed");
+		}
+	}
+
+	/* A stream starts from the reference it takes over; leaving stream mode drops queued points. */
+	if (committed->telemetry_channel_mask != active->telemetry_channel_mask)
+	{
+		(void)telemetry_stream_set_mask(&app->telemetry_stream_h, committed->telemetry_channel_mask);
+	}
+	for (uint8_t i = 0u; i < (uint8_t)APP_TELEMETRY_CHANNEL_COUNT; i++)
+	{
+		if (committed->telemetry_decimation[i] != active->telemetry_decimation[i])
+		{
+			(void)telemetry_stream_set_decimation(&app->telemetry_stream_h, i, committed->telemetry_decimation[i]);
+		}
+	}
+
+	if (committed->reference_mode != active->reference_mode)
+	{
+		app->reference_stream.current = (app_reference_point_t){
+				.speed_mrpm = app->axis[0].motor_h.trajectory.reference_mechanical_speed_mrpm,
+				.acceleration_mrpm_per_s = 0,
+		};
+		app->reference_stream.is_underrun = false;
+		if (committed->reference_mode != (uint8_t)APP_REFERENCE_MODE_STREAM)
+		{
+			app->reference_stream.count = 0u;
+		}
+		if (committed->reference_mode != (uint8_t)APP_REFERENCE_MODE_POSITION)
+		{
+			app->position_move.is_pending = false;
+		}
+	}
+
+	/* One index write switches every reader; the new shadow continues from the committed values. */
+	app->active_param_index ^= 1u;
+	app->param_apply_pending = false;
+	*app_shadow_params(app) = *app_command_get_active_params(app);
+
+	LOG_POST3(LOG_MSG_CMD_PARAMS_APPLIED,
+			  app_command_get_active_params(app)->reference_mode,
+			  app_command_get_active_params(app)->speed_pi_kp_q15,
+			  app_command_get_active_params(app)->speed_pi_ki_per_s_q15);
+}
+
+void app_command_reference_stream_next(app_context_t *app)
+{
+	app_reference_stream_t *stream = &app->reference_stream;
+
+	if (stream->count == 0u)
+	{
+		stream->current.acceleration_mrpm_per_s = 0;
+		stream->underrun_cnt++;
+		if (stream->is_underrun == false)
+		{
+			stream->is_underrun = true;
+			LOG_POST1(LOG_MSG_CMD_STREAM_UNDERRUN, stream->underrun_cnt);
+		}
+		return;
+	}
+
+	uint16_t tail = (uint16_t)((stream->head + APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY - stream->count) %
+							   APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY);
+
+	stream->current = stream->points[tail];
+	stream->count--;
+	stream->is_underrun = false;
+}
+
+void app_command_start_position_move(app_context_t *app)
+{
+	const app_param_block_t *params = app_command_get_active_params(app);
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		if (app->axis[i].motor_position_control_h.is_referenced == false) return;
+	}
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_t *axis = &app->axis[i];
+		motor_trajectory_profile_t profile = {0};
+		int32_t target_counts = app->position_move.value_counts;
+
+		if (app->position_move.is_relative)
+		{
+			target_counts = (int32_t)((uint32_t)axis->motor_h.position_control.target_position_counts +
+									  (uint32_t)app->position_move.value_counts);
+		}
+		if ((!motor_position_control_move_to(&axis->motor_position_control_h,
+											 target_counts,
+											 axis->motor_h.trajectory.reference_mechanical_speed_mrpm,
+											 params->profile_acceleration_mrpm_per_s,
+											 params->profile_jerk_mrpm_per_s2,
+											 &profile)) ||
+			(!motor_trajectory_set_profile(&axis->motor_trajectory_h, &profile)))
+		{
+			app_fatal_stop(app, "MPOS", "move rejected");
+		}
+	}
+	app->position_move.is_pending = false;
+}
+
+/**
+ * @brief Stage one SET_PARAM value into the shadow block after a range check.
+ *
+ * @param params Pointer to shadow parameter block.
+ * @param param_id Parameter identifier (app_param_id_t).
+ * @param value Parameter value in the units of the matching block field.
+ * @return Acknowledgement status.
+ */
+static app_command_status_t app_stage_param(app_param_block_t *params, uint8_t param_id, int32_t value)
+{
+	/* Host speeds stay inside the over-speed fault limit. */
+	bool is_speed_in_range = (app_abs_i32(value) <= APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM);
+
+	switch ((app_param_id_t)param_id)
+	{
+	case APP_PARAM_SPEED_PI_KP_Q15:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->speed_pi_kp_q15 = value;
+		break;
+	case APP_PARAM_SPEED_PI_KI_PER_S_Q15:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->speed_pi_ki_per_s_q15 = value;
+		break;
+	case APP_PARAM_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS:
+		if ((value < 0) || (value > (int32_t)UINT16_MAX)) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->speed_feedback_filter_time_constant_ms = (uint16_t)value;
+		break;
+	case APP_PARAM_PROFILE_PEAK_SPEED_MRPM:
+		if (is_speed_in_range == false) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->profile_peak_speed_mrpm = value;
+		break;
+	case APP_PARAM_PROFILE_PEAK_HOLD_MS:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->profile_peak_hold_ms = (uint32_t)value;
+		break;
+	case APP_PARAM_PROFILE_ZERO_HOLD_MS:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->profile_zero_hold_ms = (uint32_t)value;
+		break;
+	case APP_PARAM_PROFILE_ACCELERATION_MRPM_PER_S:
+		if (value <= 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->profile_acceleration_mrpm_per_s = (uint32_t)value;
+		break;
+	case APP_PARAM_PROFILE_JERK_MRPM_PER_S2:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->profile_jerk_mrpm_per_s2 = (uint32_t)value;
+		break;
+	case APP_PARAM_TELEMETRY_CHANNEL_MASK:
+		if ((value < 0) || (value > (int32_t)APP_TELEMETRY_CHANNEL_MASK_ALL)) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->telemetry_channel_mask = (uint16_t)value;
+		break;
+	case APP_PARAM_REFERENCE_MODE:
+		if ((value < 0) || (value >= (int32_t)APP_REFERENCE_MODE_COUNT)) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->reference_mode = (uint8_t)value;
+		break;
+	case APP_PARAM_TELEMETRY_DECIMATION:
+	{
+		uint32_t channel = (uint32_t)value >> 16;
+		uint32_t decimation = (uint32_t)value & 0xFFFFu;
+
+		if ((value < 0) || (channel >= (uint32_t)APP_TELEMETRY_CHANNEL_COUNT) || (decimation == 0u))
+		{
+			return APP_COMMAND_STATUS_BAD_VALUE;
+		}
+		params->telemetry_decimation[channel] = (uint16_t)decimation;
+		break;
+	}
+	case APP_PARAM_POSITION_KP_Q15:
+		if (value < 0) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->position_kp_q15 = value;
+		break;
+	case APP_PARAM_POSITION_MAX_SPEED_MRPM:
+		if ((value <= 0) || (is_speed_in_range == false)) return APP_COMMAND_STATUS_BAD_VALUE;
+		params->position_max_speed_mrpm = value;
+		break;
+	default:
+		return APP_COMMAND_STATUS_UNKNOWN_PARAM;
+	}
+
+	return APP_COMMAND_STATUS_OK;
+}
+
+/**
+ * @brief Queue the reference points of one STREAM_REFERENCE command.
+ *
+ * All points are checked first; the command is taken whole or not at all.
+ * The first stream command switches the reference to stream mode.
+ *
+ * @param app Pointer to application runtime context.
+ * @param frame Pointer to received command.
+ * @return Acknowledgement status.
+ */
+static app_command_status_t app_queue_reference_points(app_context_t *app, const command_frame_t *frame)
+{
+	app_reference_stream_t *stream = &app->reference_stream;
+	uint8_t point_count = (uint8_t)(frame->payload_length / APP_REFERENCE_POINT_SIZE);
+	app_reference_point_t point = {0};
+
+	if ((point_count == 0u) || ((frame->payload_length % APP_REFERENCE_POINT_SIZE) != 0u))
+	{
+		return APP_COMMAND_STATUS_BAD_LENGTH;
+	}
+	if ((uint16_t)(stream->count + point_count) > APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY)
+	{
+		return APP_COMMAND_STATUS_STREAM_FULL;
+	}
+	for (uint8_t i = 0u; i < point_count; i++)
+	{
+		(void)command_frame_get_i32(frame, (uint8_t)(i * APP_REFERENCE_POINT_SIZE), &point.speed_mrpm);
+		if (app_abs_i32(point.speed_mrpm) > APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM) return APP_COMMAND_STATUS_BAD_VALUE;
+	}
+
+	for (uint8_t i = 0u; i < point_count; i++)
+	{
+		(void)command_frame_get_i32(frame, (uint8_t)(i * APP_REFERENCE_POINT_SIZE), &point.speed_mrpm);
+		(void)command_frame_get_i32(frame, (uint8_t)((i * APP_REFERENCE_POINT_SIZE) + 4u), &point.acceleration_mrpm_per_s);
+		stream->points[stream->head] = point;
+		stream->head = (uint16_t)((stream->head + 1u) % APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY);
+		stream->count++;
+	}
+
+	if (app_command_get_active_params(app)->reference_mode != (uint8_t)APP_REFERENCE_MODE_STREAM)
+	{
+		app_shadow_params(app)->reference_mode = (uint8_t)APP_REFERENCE_MODE_STREAM;
+		app->param_apply_pending = true;
+	}
+
+	return APP_COMMAND_STATUS_OK;
+}
+
+/**
+ * @brief Execute one host command.
+ *
+ * Parameters only ever change in the shadow block; APPLY (and the setpoint,
+ * stream and move commands, which commit themselves) hands the block to the
+ * next speed-control step. Changes staged before that step are committed with it.
+ *
+ * @param app Pointer to application runtime context.
+ * @param frame Pointer to received command.
+ * @return Acknowledgement status.
+ */
+static app_command_status_t app_handle_command(app_context_t *app, const command_frame_t *frame)
+{
+	app_param_block_t *shadow = app_shadow_params(app);
+	uint8_t param_id = 0u;
+	int32_t value = 0;
+	app_command_status_t status = APP_COMMAND_STATUS_OK;
+
+	switch ((app_command_type_t)frame->type)
+	{
+	case APP_COMMAND_SET_SPEED:
+		if (!command_frame_get_i32(frame, 0u, &value) || (frame->payload_length != 4u)) return APP_COMMAND_STATUS_BAD_LENGTH;
+		if (app_abs_i32(value) > APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM) return APP_COMMAND_STATUS_BAD_VALUE;
+		shadow->speed_setpoint_mrpm = value;
+		shadow->reference_mode = (uint8_t)APP_REFERENCE_MODE_SETPOINT;
+		app->param_apply_pending = true;
+		break;
+	case APP_COMMAND_STREAM_REFERENCE:
+		status = app_queue_reference_points(app, frame);
+		break;
+	case APP_COMMAND_SET_PARAM:
+		if ((frame->payload_length != 5u) ||
+			(!command_frame_get_u8(frame, 0u, &param_id)) ||
+			(!command_frame_get_i32(frame, 1u, &value)))
+		{
+			return APP_COMMAND_STATUS_BAD_LENGTH;
+		}
+		/* A schedule scales by new / old, so an active gain of 0 leaves no ratio. */
+		if ((app_speed_pi_schedule_is_installed(app)) &&
+			(((param_id == (uint8_t)APP_PARAM_SPEED_PI_KP_Q15) &&
+			  (app_command_get_active_params(app)->speed_pi_kp_q15 == 0)) ||
+			 ((param_id == (uint8_t)APP_PARAM_SPEED_PI_KI_PER_S_Q15) &&
+			  (app_command_get_active_params(app)->speed_pi_ki_per_s_q15 == 0))))
+		{
+			return APP_COMMAND_STATUS_BAD_VALUE;
+		}
+		status = app_stage_param(shadow, param_id, value);
+		break;
+	case APP_COMMAND_MOVE_TO:
+	case APP_COMMAND_MOVE_RELATIVE:
+		if (!command_frame_get_i32(frame, 0u, &value) || (frame->payload_length != 4u)) return APP_COMMAND_STATUS_BAD_LENGTH;
+		app->position_move = (app_position_move_t){
+				.value_counts = value,
+				.is_relative = (frame->type == (uint8_t)APP_COMMAND_MOVE_RELATIVE),
+				.is_pending = true,
+		};
+		if (app_command_get_active_params(app)->reference_mode != (uint8_t)APP_REFERENCE_MODE_POSITION)
+		{
+			shadow->reference_mode = (uint8_t)APP_REFERENCE_MODE_POSITION;
+			app->param_apply_pending = true;
+		}
+		break;
+	case APP_COMMAND_APPLY:
+		if (frame->payload_length != 0u) return APP_COMMAND_STATUS_BAD_LENGTH;
+		app->param_apply_pending = true;
+		break;
+	case APP_COMMAND_DISCARD:
+		if (frame->payload_length != 0u) return APP_COMMAND_STATUS_BAD_LENGTH;
+		*shadow = *app_command_get_active_params(app);
+		app->param_apply_pending = false;
+		break;
+	default:
+		status = APP_COMMAND_STATUS_UNKNOWN_COMMAND;
+		break;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Acknowledge one host command.
+ *
+ * Text A,type,sequence,status,stream_free or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_COMMAND_ACK, 5 bytes):
+ * u8 type, u8 sequence, u8 status, u16 stream_free (free reference points, for host pacing)
+ *
+ * @param app Pointer to application runtime context.
+ * @param frame Pointer to received command.
+ * @param status Acknowledgement status.
+ * @param now_us Current time in microseconds (frame timestamp).
+ */
+static void app_emit_command_ack(app_context_t *app,
+								 const command_frame_t *frame,
+								 app_command_status_t status,
+								 uint64_t now_us)
+{
+	telemetry_frame_t ack;
+	uint16_t stream_free = (uint16_t)(APP_MOTOR_TEST_REFERENCE_STREAM_CAPACITY - app->reference_stream.count);
+
+	if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
+	{
+		telemetry_frame_begin(&ack, APP_TELEMETRY_FRAME_TYPE_COMMAND_ACK, (uint32_t)now_us);
+		telemetry_frame_put_u8(&ack, frame->type);
+		telemetry_frame_put_u8(&ack, frame->sequence);
+		telemetry_frame_put_u8(&ack, (uint8_t)status);
+		telemetry_frame_put_u16(&ack, stream_free);
+		(void)telemetry_send(&app->telemetry_h, &ack);
+		return;
+	}
+
+	printf("A,%u,%u,%u,%u\n",
+		   (unsigned)frame->type,
+		   (unsigned)frame->sequence,
+		   (unsigned)status,
+		   (unsigned)stream_free);
+}
+
+void app_command_task(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
+	command_frame_t frame;
+
+	if (app_command_enabled() == false) return;
+
+	for (uint8_t i = 0u; i < APP_MOTOR_TEST_COMMAND_FRAMES_PER_PASS; i++)
+	{
+		if (!command_poll(&app->command_h, &frame)) return;
+		app_emit_command_ack(app, &frame, app_handle_command(app, &frame), now_us);
+	}
+	if (app_scheduler_event_driven())
+	{
+		(void)scheduler_post_event(&app->scheduler_h, APP_EVENT_COMMAND_RX);
+	}
+}
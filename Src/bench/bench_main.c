@@ -0,0 +1,617 @@
+/**
+ * @file bench_main.c
+ * @brief Kernel microbenchmark firmware (Bench build configuration).
+ *
+ * Replaces main.c in the Bench build: runs each control kernel
+ * BENCH_ITERATIONS times with synthetic inputs, times every call with
+ * DWT->CYCCNT and reports min/avg/max cycles per call on USART2:
+ *
+ *   BB,sysclk_hz,iterations,overhead_cycles
+ *   B,kernel,calls,min,avg,max,failed
+ *   BE,kernel_count
+ *
+ * Cycles are net of the timing overhead (empty timed region, min). Calls run
+ * with interrupts masked, except the AS5600 ADC EOC path, which is timed from
+ * the ISR by its profiler probe while real software-started conversions run.
+ * The power stage is never enabled and TIM1 is not started: the FOC kernel
+ * writes its compare registers only.
+ */
+
+#include "stm32f446xx.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "config/app_motor_test_config.h"
+#include "config/bench_config.h"
+#include "config/project_config.h"
+#include "board/board.h"
+#include "drivers/as5600_analog.h"
+#include "drivers/log.h"
+#include "drivers/profiler.h"
+#include "drivers/systick.h"
+#include "drivers/usart2.h"
+#include "motor/motor.h"
+#include "motor/motor_3pwm.h"
+#include "motor/motor_foc_voltage.h"
+#include "motor/motor_sine_3pwm.h"
+#include "motor/motor_speed_feedback.h"
+#include "motor/motor_speed_pi.h"
+#include "motor/motor_speed_reference_estimator.h"
+
+#if (PROFILER_ENABLE == 0u)
+#error "The Bench build times the kernels with the DWT cycle counter; keep PROFILER_ENABLE set"
+#endif
+
+/* Odd step through the uint16 angle range: every LUT segment is hit within a few hundred calls. */
+#define BENCH_ANGLE_SWEEP_STEP_U16		40503u
+#define BENCH_LINE_SIZE					96u
+
+/**
+ * @brief Time one call with interrupts masked and record it.
+ *
+ * @param stats Pointer to kernel statistics.
+ * @param call Expression to time.
+ */
+#define BENCH_TIME_CALL(stats, call)												\
+	do {																			\
+		__disable_irq();															\
+		const uint32_t bench_start_cycles = profiler_cycles();						\
+		call;																		\
+		const uint32_t bench_cycles = profiler_cycles() - bench_start_cycles;		\
+		__enable_irq();																\
+		bench_record((stats), bench_cycles);										\
+	} while (0)
+
+/**
+ * @brief Result of one kernel case.
+ *
+ */
+typedef struct {
+	const char *name;
+	profiler_probe_stats_t stats;
+	uint32_t failed_calls;
+} bench_case_t;
+
+static motor_handle_t bench_motor_h;
+static motor_speed_reference_estimator_history_t bench_speed_reference_estimator_history;
+static uint32_t bench_overhead_cycles;
+static uint32_t bench_noise_state = 0x12345678u;
+static uint32_t bench_case_count;
+
+/**
+ * @brief Trap on one fatal bench setup error.
+ *
+ * @param tag Log tag.
+ * @param msg Log message.
+ */
+static void bench_fatal_trap(const char *tag, const char *msg)
+{
+	LOGE(tag, msg);
+	while(1) {}
+}
+
+/**
+ * @brief Queue one report line, waiting for TX space instead of dropping it.
+ *
+ * @param line Pointer to line characters.
+ * @param len Line length in bytes.
+ */
+static void bench_write_line(const char *line, int len)
+{
+	if ((len <= 0) || ((size_t)len >= BENCH_LINE_SIZE)) return;
+
+	while (usart2_tx_free_space(&USART2_H) < (size_t)len) {}
+	usart2_write(&USART2_H, (const uint8_t *)line, (size_t)len);
+}
+
+/**
+ * @brief Wait until the TX ring has drained, so the next case is not disturbed by DMA refills.
+ */
+static void bench_wait_tx_idle(void)
+{
+	while (usart2_tx_free_space(&USART2_H) < (UART_TX_BUFFER_SIZE - 1u)) {}
+}
+
+/**
+ * @brief Clear one kernel case.
+ *
+ * @param bench_case Pointer to kernel case.
+ * @param name Kernel name reported in the B-row.
+ */
+static void bench_case_begin(bench_case_t *bench_case, const char *name)
+{
+	bench_case->name = name;
+	bench_case->stats.count = 0u;
+	bench_case->stats.min_cycles = UINT32_MAX;
+	bench_case->stats.max_cycles = 0u;
+	bench_case->stats.sum_cycles = 0u;
+	bench_case->failed_calls = 0u;
+}
+
+/**
+ * @brief Record one timed call, net of the timing overhead.
+ *
+ * @param stats Pointer to kernel statistics.
+ * @param cycles Raw cycles of the timed region.
+ */
+static void bench_record(profiler_probe_stats_t *stats, uint32_t cycles)
+{
+	uint32_t net_cycles = (cycles > bench_overhead_cycles) ? (cycles - bench_overhead_cycles) : 0u;
+
+	stats->count++;
+	stats->sum_cycles += net_cycles;
+	if (net_cycles < stats->min_cycles) stats->min_cycles = net_cycles;
+	if (net_cycles > stats->max_cycles) stats->max_cycles = net_cycles;
+}
+
+/**
+ * @brief Emit the B-row of one kernel case.
+ *
+ * @param bench_case Pointer to kernel case.
+ */
+static void bench_case_report(const bench_case_t *bench_case)
+{
+	char line[BENCH_LINE_SIZE];
+	const profiler_probe_stats_t *stats = &bench_case->stats;
+	uint32_t avg_cycles = (stats->count != 0u) ? (uint32_t)(stats->sum_cycles / stats->count) : 0u;
+	uint32_t min_cycles = (stats->count != 0u) ? stats->min_cycles : 0u;
+
+	int len = snprintf(line,
+					   sizeof(line),
+					   "B,%s,%lu,%lu,%lu,%lu,%lu\r\n",
+					   bench_case->name,
+					   (unsigned long)stats->count,
+					   (unsigned long)min_cycles,
+					   (unsigned long)avg_cycles,
+					   (unsigned long)stats->max_cycles,
+					   (unsigned long)bench_case->failed_calls);
+	bench_write_line(line, len);
+	bench_case_count++;
+}
+
+/**
+ * @brief Return the next angle noise sample (xorshift32, reproducible across runs).
+ *
+ * @return Noise in -BENCH_ANGLE_NOISE_COUNTS..+BENCH_ANGLE_NOISE_COUNTS counts.
+ */
+static int32_t bench_angle_noise_counts(void)
+{
+	bench_noise_state ^= bench_noise_state << 13;
+	bench_noise_state ^= bench_noise_state >> 17;
+	bench_noise_state ^= bench_noise_state << 5;
+
+	return (int32_t)(bench_noise_state % ((2u * BENCH_ANGLE_NOISE_COUNTS) + 1u)) - (int32_t)BENCH_ANGLE_NOISE_COUNTS;
+}
+
+/**
+ * @brief Return the noisy ramp angle of one sample at BENCH_MECHANICAL_SPEED_MRPM.
+ *
+ * @param sample_index Sample index.
+ * @param sample_period_us Sample period in microseconds.
+ * @return Mechanical angle in full-turn uint16 units.
+ */
+static uint16_t bench_ramp_angle_u16(uint32_t sample_index, uint32_t sample_period_us)
+{
+	/* counts per sample = mrpm * 65536 * period_us / (60 000 000 * 1000) */
+	int64_t angle_counts = ((int64_t)BENCH_MECHANICAL_SPEED_MRPM * 65536 * sample_index * sample_period_us) /
+						   60000000000LL;
+
+	return (uint16_t)((int32_t)angle_counts + bench_angle_noise_counts());
+}
+
+/**
+ * @brief Measure the cost of an empty timed region (subtracted from every sample).
+ */
+static void bench_calibrate_overhead(void)
+{
+	bench_case_t bench_case;
+	uint32_t i = 0u;
+
+	bench_overhead_cycles = 0u;
+	bench_case_begin(&bench_case, "overhead");
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		BENCH_TIME_CALL(&bench_case.stats, __NOP());
+	}
+	bench_overhead_cycles = bench_case.stats.min_cycles;
+}
+
+/**
+ * @brief Reset the shared motor state used by the kernel cases.
+ */
+static void bench_reset_motor_handle(void)
+{
+	bench_motor_h = (motor_handle_t){
+			.measurements = {0},
+			.limits = {
+					.pole_pairs = APP_MOTOR_TEST_POLE_PAIRS,
+					.max_target_mechanical_speed_mrpm = 0,
+					.max_amplitude_permyriad = APP_MOTOR_TEST_MAX_AMPLITUDE_PERMYRIAD,
+			},
+			.status = {
+					.mode = MOTOR_MODE_INACTIVE,
+					.is_initialized = true,
+					.is_enabled = false,
+					.has_valid_mechanical_angle = true,
+					.has_valid_electrical_angle = true,
+					.has_valid_mechanical_speed = true,
+			},
+	};
+}
+
+/**
+ * @brief Time motor_sine_3pwm_get_phase_q15() over the full angle range.
+ */
+static void bench_run_sine_phase(void)
+{
+	bench_case_t bench_case;
+	volatile int16_t phase_q15 = 0;
+	uint16_t angle_u16 = 0u;
+	uint32_t i = 0u;
+
+	bench_case_begin(&bench_case, "sine_3pwm_get_phase_q15");
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		angle_u16 = (uint16_t)(angle_u16 + BENCH_ANGLE_SWEEP_STEP_U16);
+		BENCH_TIME_CALL(&bench_case.stats, phase_q15 = motor_sine_3pwm_get_phase_q15(angle_u16));
+	}
+	(void)phase_q15;
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time motor_foc_voltage_apply_dq() with one 3-PWM modulation.
+ *
+ * Sweeps the electrical angle and Uq up to the amplitude limit, so the
+ * modulation clamps and the duty write run as in the fast loop.
+ *
+ * @param name Kernel name reported in the B-row.
+ * @param modulation 3-PWM modulation under test.
+ */
+static void bench_run_foc_apply_dq(const char *name, motor_3pwm_modulation_t modulation)
+{
+	static motor_3pwm_cfg_t motor_3pwm_cfg;
+	static motor_3pwm_handle_t motor_3pwm_h;
+	static motor_foc_voltage_cfg_t motor_foc_voltage_cfg;
+	static motor_foc_voltage_handle_t motor_foc_voltage_h;
+	bench_case_t bench_case;
+	uint16_t angle_u16 = 0u;
+	uint32_t i = 0u;
+
+	motor_3pwm_cfg = (motor_3pwm_cfg_t){
+			.pwm_h = &PWM_H,
+			.modulation = modulation,
+			.dead_time_comp = MOTOR_3PWM_DEAD_TIME_COMP_OFF,
+	};
+	motor_foc_voltage_cfg = (motor_foc_voltage_cfg_t){
+			.motor_h = &bench_motor_h,
+			.motor_3pwm_h = &motor_3pwm_h,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+	};
+	bench_reset_motor_handle();
+	if ((!motor_3pwm_init(&motor_3pwm_h, &motor_3pwm_cfg)) ||
+		(!motor_foc_voltage_init(&motor_foc_voltage_h, &motor_foc_voltage_cfg)))
+	{
+		bench_fatal_trap("BENCH", "foc init failed");
+	}
+
+	bench_case_begin(&bench_case, name);
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		bool ok = false;
+		int16_t uq_permyriad = (int16_t)((int32_t)(i % 201u) * 100 - 10000);
+
+		angle_u16 = (uint16_t)(angle_u16 + BENCH_ANGLE_SWEEP_STEP_U16);
+		bench_motor_h.measurements.electrical_angle_u16 = angle_u16;
+		BENCH_TIME_CALL(&bench_case.stats,
+						ok = motor_foc_voltage_apply_dq(&motor_foc_voltage_h, -500, uq_permyriad));
+		if (!ok) bench_case.failed_calls++;
+	}
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time motor_speed_feedback_update() in one feedback mode on the noisy angle ramp.
+ *
+ * @param name Kernel name reported in the B-row.
+ * @param mode Speed-feedback mode under test.
+ */
+static void bench_run_speed_feedback(const char *name, motor_speed_feedback_mode_t mode)
+{
+	static motor_speed_feedback_cfg_t motor_speed_feedback_cfg;
+	static motor_speed_feedback_handle_t motor_speed_feedback_h;
+	const uint32_t sample_period_us =
+			APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US * (uint32_t)APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+	bench_case_t bench_case;
+	uint32_t i = 0u;
+
+	motor_speed_feedback_cfg = (motor_speed_feedback_cfg_t){
+			.motor_h = &bench_motor_h,
+			.sample_period_us = sample_period_us,
+			.filter_time_constant_ms = APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.mode = mode,
+			.pll_bandwidth_hz = APP_MOTOR_TEST_SPEED_FEEDBACK_PLL_BANDWIDTH_HZ,
+	};
+	bench_reset_motor_handle();
+	if (!motor_speed_feedback_init(&motor_speed_feedback_h, &motor_speed_feedback_cfg))
+	{
+		bench_fatal_trap("BENCH", "speed feedback init failed");
+	}
+
+	for (i = 0u; i < BENCH_WARMUP_ITERATIONS; i++)
+	{
+		(void)motor_speed_feedback_update(&motor_speed_feedback_h, bench_ramp_angle_u16(i, sample_period_us));
+	}
+
+	bench_case_begin(&bench_case, name);
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		bool ok = false;
+		uint16_t angle_u16 = bench_ramp_angle_u16(BENCH_WARMUP_ITERATIONS + i, sample_period_us);
+
+		BENCH_TIME_CALL(&bench_case.stats,
+						ok = motor_speed_feedback_update(&motor_speed_feedback_h, angle_u16));
+		if (!ok) bench_case.failed_calls++;
+	}
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time motor_speed_pi_update() on a reference ramp with a tracking error.
+ *
+ * The error sweeps through the output limit, so both the linear and the
+ * anti-windup branch are measured.
+ */
+static void bench_run_speed_pi(void)
+{
+	static motor_speed_pi_cfg_t motor_speed_pi_cfg;
+	static motor_speed_pi_handle_t motor_speed_pi_h;
+	bench_case_t bench_case;
+	uint32_t i = 0u;
+
+	motor_speed_pi_cfg = (motor_speed_pi_cfg_t){
+			.motor_h = &bench_motor_h,
+			.kp_q15 = APP_MOTOR_TEST_SPEED_PI_KP_Q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.output_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.current_limit_ma = 0,
+			.ff_speed_q15 = APP_MOTOR_TEST_SPEED_PI_FF_SPEED_Q15,
+			.ff_acceleration_q15 = APP_MOTOR_TEST_SPEED_PI_FF_ACCELERATION_Q15,
+			.ff_friction_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_PERMYRIAD,
+			.ff_friction_deadband_mrpm = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_DEADBAND_MRPM,
+			.ff_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_LIMIT_PERMYRIAD,
+			.gain_table = NULL,
+			.gain_table_count = 0u,
+	};
+	bench_reset_motor_handle();
+	if (!motor_speed_pi_init(&motor_speed_pi_h, &motor_speed_pi_cfg))
+	{
+		bench_fatal_trap("BENCH", "speed pi init failed");
+	}
+
+	bench_case_begin(&bench_case, "speed_pi_update");
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		bool ok = false;
+		int32_t target_mrpm = (int32_t)(i % 500u) * 2000 - 500000;
+		int32_t error_mrpm = (int32_t)(i % 37u) * 4000 - 72000 + bench_angle_noise_counts() * 100;
+
+		BENCH_TIME_CALL(&bench_case.stats,
+						ok = motor_speed_pi_update(&motor_speed_pi_h, target_mrpm, 400000, target_mrpm - error_mrpm));
+		if (!ok) bench_case.failed_calls++;
+	}
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time motor_speed_reference_estimator_update() with a full window.
+ */
+static void bench_run_reference_estimator(void)
+{
+	static motor_speed_reference_estimator_cfg_t motor_speed_reference_estimator_cfg;
+	static motor_speed_reference_estimator_handle_t motor_speed_reference_estimator_h;
+	const uint32_t sample_period_us =
+			APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US * (uint32_t)APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+	bench_case_t bench_case;
+	uint32_t i = 0u;
+
+	motor_speed_reference_estimator_cfg = (motor_speed_reference_estimator_cfg_t){
+			.motor_h = &bench_motor_h,
+			.history = &bench_speed_reference_estimator_history,
+			.history_sample_count = APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT,
+	};
+	bench_reset_motor_handle();
+	if (!motor_speed_reference_estimator_init(&motor_speed_reference_estimator_h,
+											  &motor_speed_reference_estimator_cfg))
+	{
+		bench_fatal_trap("BENCH", "reference estimator init failed");
+	}
+
+	/* Fill the window first: the timed calls all take the steady-state path. */
+	for (i = 0u; i < (BENCH_WARMUP_ITERATIONS + APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT); i++)
+	{
+		(void)motor_speed_reference_estimator_update(&motor_speed_reference_estimator_h,
+													 bench_ramp_angle_u16(i, sample_period_us),
+													 (uint64_t)i * sample_period_us);
+	}
+
+	bench_case_begin(&bench_case, "reference_estimator_update");
+	for (uint32_t n = 0u; n < BENCH_ITERATIONS; n++, i++)
+	{
+		bool ok = false;
+		uint16_t angle_u16 = bench_ramp_angle_u16(i, sample_period_us);
+		uint64_t timestamp_us = (uint64_t)i * sample_period_us;
+
+		BENCH_TIME_CALL(&bench_case.stats,
+						ok = motor_speed_reference_estimator_update(&motor_speed_reference_estimator_h,
+																	angle_u16,
+																	timestamp_us));
+		if (!ok) bench_case.failed_calls++;
+	}
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time the AS5600 ADC EOC path (adc_read + sample / window processing) from the ISR.
+ *
+ * Software-started conversions on ADC1 at the configured raw sample period;
+ * the EOC callback records PROFILER_PROBE_AS5600_ADC_ISR, which is read back
+ * as the kernel statistics. The ISR is not masked, so the probe overhead is
+ * included (about the bench overhead row).
+ */
+static void bench_run_as5600_adc(void)
+{
+	static as5600_analog_cfg_t as5600_analog_cfg;
+	static as5600_analog_handle_t as5600_analog_h;
+	static bool is_initialized = false;
+	bench_case_t bench_case;
+	profiler_probe_stats_t probe_stats;
+
+	as5600_analog_cfg = (as5600_analog_cfg_t){
+			.adc_h = &ADC1_IN0_H,
+			.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
+			.raw_sample_period_us = APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US,
+			.raw_sample_phase_us = 0u,
+			.raw_samples_per_publish = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT,
+			.wrap_correction_threshold_counts = (uint16_t)APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS,
+			.max_plausible_delta_per_publish_counts =
+					(uint16_t)APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
+			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
+					AS5600_ANALOG_DIRECTION_REVERSE :
+					AS5600_ANALOG_DIRECTION_FORWARD,
+			.acquisition_mode = AS5600_ANALOG_ACQUISITION_SOFTWARE,
+			.dma_h = NULL,
+			.adc_trigger = ADC_EXT_TRIGGER_TIM2_TRGO,
+	};
+	/* The EOC callback stays registered on ADC1; initialize once across report passes. */
+	if (is_initialized == false)
+	{
+		if (!as5600_analog_init(&as5600_analog_h, &as5600_analog_cfg))
+		{
+			bench_fatal_trap("BENCH", "as5600 init failed");
+		}
+		is_initialized = true;
+	}
+
+	bench_case_begin(&bench_case, "as5600_adc_eoc_isr");
+	profiler_reset();
+
+	uint32_t start_ms = SYSTICK_GetTimeMs();
+	bool timed_out = false;
+	while (profiler_get_stats(PROFILER_PROBE_AS5600_ADC_ISR, &probe_stats) &&
+		   (probe_stats.count < BENCH_ADC_SAMPLE_COUNT))
+	{
+		(void)as5600_analog_service(&as5600_analog_h, SYSTICK_GetTimeUs());
+		if ((SYSTICK_GetTimeMs() - start_ms) > BENCH_ADC_TIMEOUT_MS)
+		{
+			timed_out = true;
+			break;
+		}
+	}
+
+	if (profiler_get_stats(PROFILER_PROBE_AS5600_ADC_ISR, &probe_stats))
+	{
+		bench_case.stats = probe_stats;
+	}
+	if (timed_out)
+	{
+		bench_case.failed_calls += BENCH_ADC_SAMPLE_COUNT - bench_case.stats.count;
+	}
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Time log_printf() with one typical formatted line (format + TX ring copy).
+ *
+ * Each call starts with a drained TX ring, so no line is dropped and the
+ * DMA refill does not overlap the timed call.
+ */
+static void bench_run_log_printf(void)
+{
+	bench_case_t bench_case;
+	uint32_t i = 0u;
+
+	bench_case_begin(&bench_case, "log_printf");
+	for (i = 0u; i < BENCH_ITERATIONS; i++)
+	{
+		bench_wait_tx_idle();
+		BENCH_TIME_CALL(&bench_case.stats,
+						log_printf(LOG_LEVEL_INFO, "BENCH", "speed=%ld uq=%d i=%lu",
+								   (long)(BENCH_MECHANICAL_SPEED_MRPM - (int32_t)i), (int)(i % 10000u),
+								   (unsigned long)i));
+	}
+	bench_wait_tx_idle();
+	bench_case_report(&bench_case);
+}
+
+/**
+ * @brief Run every kernel case once and emit one report.
+ */
+static void bench_run_pass(void)
+{
+	char line[BENCH_LINE_SIZE];
+	int len = 0;
+
+	bench_case_count = 0u;
+	bench_noise_state = 0x12345678u;
+	bench_calibrate_overhead();
+
+	len = snprintf(line,
+				   sizeof(line),
+				   "BB,%lu,%lu,%lu\r\n",
+				   (unsigned long)CLOCK_H.sysclk_hz,
+				   (unsigned long)BENCH_ITERATIONS,
+				   (unsigned long)bench_overhead_cycles);
+	bench_write_line(line, len);
+
+	bench_run_foc_apply_dq("foc_apply_dq_sine", MOTOR_3PWM_MODULATION_SINE);
+	bench_run_foc_apply_dq("foc_apply_dq_svpwm", MOTOR_3PWM_MODULATION_SVPWM);
+	bench_run_foc_apply_dq("foc_apply_dq_dpwm", MOTOR_3PWM_MODULATION_DPWM);
+	bench_run_sine_phase();
+	bench_run_speed_feedback("speed_feedback_update_lpf", MOTOR_SPEED_FEEDBACK_MODE_LPF);
+	bench_run_speed_feedback("speed_feedback_update_pll", MOTOR_SPEED_FEEDBACK_MODE_PLL);
+	bench_run_speed_pi();
+	bench_run_reference_estimator();
+	bench_run_as5600_adc();
+	/* log_printf() goes last: its lines share the TX ring with the report. */
+	bench_run_log_printf();
+
+	len = snprintf(line, sizeof(line), "BE,%lu\r\n", (unsigned long)bench_case_count);
+	bench_write_line(line, len);
+}
+
+int main(void)
+{
+	/* Same board bring-up as the motor test; the drivers stay disabled. */
+	board_init();
+	log_init(&USART2_H);
+
+	if (CLOCK_H.is_initialized == false)
+	{
+		bench_fatal_trap("CLK", "clock profile not applied");
+	}
+
+	if (TIMEBASE_TIM5_H.is_initialized == false)
+	{
+		bench_fatal_trap("TIM5", "timebase init failed");
+	}
+
+	if (!profiler_init())
+	{
+		bench_fatal_trap("PROF", "cycle counter unavailable");
+	}
+
+	while (1)
+	{
+		bench_run_pass();
+		if (BENCH_REPEAT_PERIOD_MS == 0u)
+		{
+			while (1) {}
+		}
+
+		uint32_t pass_end_ms = SYSTICK_GetTimeMs();
+		while ((SYSTICK_GetTimeMs() - pass_end_ms) < BENCH_REPEAT_PERIOD_MS) {}
+	}
+}
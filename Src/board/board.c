@@ -25,18 +25,47 @@ static void user_button_callback( )
 
 void board_init()
 {
+	/* Clock tree first: every driver cfg below is derived from CLOCK_PROFILE */
+	clock_init(&CLOCK_H, &CLOCK_CFG);
+	/* Priority plan: all NVIC bits preempt (see config/irq_priority_config.h) */
+	NVIC_SetPriorityGrouping(IRQ_PRIORITY_GROUPING);
 	/* Configure GPIO pins */
 	gpio_init_pin(&LED_OUTPUT);
 	gpio_init_pin(&PUSH_BUTTON);
 	gpio_init_pin(&MOTOR_EN);
 	gpio_write(MOTOR_EN.pin, false);
+#if (MOTOR_AXIS_COUNT > 1u)
+	gpio_init_pin(&MOTOR2_EN);
+	gpio_write(MOTOR2_EN.pin, false);
+#endif
 	/* Configure EXTI lines */
 	exti_register(13, user_button_callback, NULL);
 	exti_init(&USER_BUTTON_EXTI);
 	/* Configure ADC channels*/
 	adc_init(&ADC1_IN0_H, &ADC1_IN0_CFG);
+	dma_init(&ADC1_DMA_H, &ADC1_DMA_CFG);
+	/* Phase-current ADC: injected group stays untriggered until the application arms it */
+	adc_init(&CURRENT_SENSE_ADC2_H, &CURRENT_SENSE_ADC2_CFG);
+	adc_injected_init(&CURRENT_SENSE_ADC2_H, &CURRENT_SENSE_INJECTED_CFG);
+#if (MOTOR_AXIS_COUNT > 1u)
+	/* Second-axis angle ADC: software-triggered single conversions */
+	adc_init(&ADC3_IN10_H, &ADC3_IN10_CFG);
+#endif
+	/* USART2 TX stream before USART2 (the driver registers its callback on it) */
+	dma_init(&USART2_TX_DMA_H, &USART2_TX_DMA_CFG);
 	usart2_init(&USART2_CFG, &USART2_H);
+	/* I2C1 RX stream before I2C1 (the driver registers its callback on it); the bus stays idle until used */
+	dma_init(&I2C1_RX_DMA_H, &I2C1_RX_DMA_CFG);
+	i2c1_init(&I2C1_H, &I2C1_CFG);
 	pwm_tim1_init(&PWM_CFG, &PWM_H);
+#if (MOTOR_AXIS_COUNT > 1u)
+	/* Second-axis stage: counters stay stopped until the staggered start */
+	pwm_tim1_init(&PWM_TIM8_CFG, &PWM_TIM8_H);
+#endif
+	/* TIM2 trigger divider after TIM1 (stays stopped until the application starts it) */
+	tim2_trigger_init(&ADC_TRIGGER_TIM2_H, &ADC_TRIGGER_TIM2_CFG);
+	/* TIM5 timebase before SysTick, which serves microseconds from it */
+	tim5_timebase_init(&TIMEBASE_TIM5_H, &TIMEBASE_TIM5_CFG);
 	SYSTICK_Init(&SYSTICK_CFG, &SYSTICK_H);
 }
 
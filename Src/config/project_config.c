@@ -8,6 +8,50 @@
 
 volatile bool user_button_on = false;  // Set by EXTI callback when the user button is pressed
 
+/* System clock configuration for the selected profile */
+#if (CLOCK_PROFILE == CLOCK_PROFILE_HSI_16MHZ)
+const clock_cfg_t CLOCK_CFG = {
+		.source = CLOCK_SOURCE_HSI,
+		.use_pll = false,
+		.ahb_div = 1,
+		.apb1_div = APB1_CLK_DIV,
+		.apb2_div = APB2_CLK_DIV,
+		.voltage_scale = 3,
+		.overdrive = false,
+		.flash_latency = 0,
+		.art_enable = true,
+};
+#else
+/* 2 MHz VCO input, 360 MHz VCO, SYSCLK = 360 / 2, 5 wait states at 180 MHz / 3.3 V */
+const clock_cfg_t CLOCK_CFG = {
+#if (CLOCK_PROFILE == CLOCK_PROFILE_HSE_PLL_180MHZ)
+		.source = CLOCK_SOURCE_HSE_BYPASS,
+		.hse_hz = 8000000u,
+		.pll_m = 4,
+#else
+		.source = CLOCK_SOURCE_HSI,
+		.pll_m = 8,
+#endif
+		.use_pll = true,
+		.pll_n = 180,
+		.pll_p = 2,
+		.pll_q = 8,
+		.ahb_div = 1,
+		.apb1_div = APB1_CLK_DIV,
+		.apb2_div = APB2_CLK_DIV,
+		.voltage_scale = 1,
+		.overdrive = true,
+		.flash_latency = 5,
+		.art_enable = true,
+};
+#endif
+
+/* Clock handle (derived bus clocks after clock_init) */
+clock_handle_t CLOCK_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
 /* GPIO configuration for user LED */
 const gpio_pin_cfg_t LED_OUTPUT = {
 		.pin = {GPIOA, 5, GPIO_PORTA},
@@ -52,7 +96,54 @@ const gpio_pin_cfg_t ADC_IN0 = {
 const exti_cfg_t USER_BUTTON_EXTI = {
 		.gpio_cfg = &PUSH_BUTTON,
 		.edge = FALLING_EDGE,
-		.priority = 6,
+		.priority = IRQ_PRIORITY_BUTTON,
+};
+
+/* GPIO configuration for Hall sensor inputs (PC6 / PC7 / PC8, open-collector sensors) */
+const gpio_pin_cfg_t HALL_A = {
+		.pin = {GPIOC, 6, GPIO_PORTC},
+		.mode = GPIO_MODE_INPUT,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+const gpio_pin_cfg_t HALL_B = {
+		.pin = {GPIOC, 7, GPIO_PORTC},
+		.mode = GPIO_MODE_INPUT,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+const gpio_pin_cfg_t HALL_C = {
+		.pin = {GPIOC, 8, GPIO_PORTC},
+		.mode = GPIO_MODE_INPUT,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* EXTI configuration for the Hall inputs: every edge is a commutation */
+const exti_cfg_t HALL_A_EXTI = {
+		.gpio_cfg = &HALL_A,
+		.edge = BOTH_EDGES,
+		.priority = IRQ_PRIORITY_COMMUTATION,
+};
+
+const exti_cfg_t HALL_B_EXTI = {
+		.gpio_cfg = &HALL_B,
+		.edge = BOTH_EDGES,
+		.priority = IRQ_PRIORITY_COMMUTATION,
+};
+
+const exti_cfg_t HALL_C_EXTI = {
+		.gpio_cfg = &HALL_C,
+		.edge = BOTH_EDGES,
+		.priority = IRQ_PRIORITY_COMMUTATION,
 };
 
 /* ADC configuration for PA0 (channel 0) */
@@ -64,7 +155,8 @@ const adc_cfg_t ADC1_IN0_CFG = {
 		.resolution = ADC_12_BIT,
 		.sample_time = CYCLES_84,
 		.irqn = ADC_IRQn,
-		.irq_priority = 5,
+		.irq_priority = IRQ_PRIORITY_ADC,
+		.clk_prescaler = ADC_CLK_PRESCALER,
 };
 
 /* ADC handle for PA0 (channel 0) */
@@ -75,6 +167,156 @@ adc_handle_t ADC1_IN0_H = {
 		.last_reading = 0,
 };
 
+/* GPIO configuration for phase-A shunt amplifier (PA1 / ADC2_IN1) */
+const gpio_pin_cfg_t CURRENT_SENSE_IN_A = {
+		.pin = {GPIOA, 1, GPIO_PORTA},
+		.mode = GPIO_MODE_ANALOG,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_NONE,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* GPIO configuration for phase-B shunt amplifier (PA4 / ADC2_IN4) */
+const gpio_pin_cfg_t CURRENT_SENSE_IN_B = {
+		.pin = {GPIOA, 4, GPIO_PORTA},
+		.mode = GPIO_MODE_ANALOG,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_NONE,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* GPIO configuration for phase-C shunt amplifier (PC1 / ADC2_IN11) */
+const gpio_pin_cfg_t CURRENT_SENSE_IN_C = {
+		.pin = {GPIOC, 1, GPIO_PORTC},
+		.mode = GPIO_MODE_ANALOG,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_NONE,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* ADC2 for phase currents: the regular channel is never started, only the injected group converts */
+const adc_cfg_t CURRENT_SENSE_ADC2_CFG = {
+		.adc_channel = 1,
+		.inst = ADC2,
+		.mode = ADC_MODE_SINGLE,
+		.pin_cfg = &CURRENT_SENSE_IN_A,
+		.resolution = ADC_12_BIT,
+		.sample_time = CYCLES_15,
+		.irqn = ADC_IRQn,
+		.irq_priority = IRQ_PRIORITY_ADC,
+		.clk_prescaler = ADC_CLK_PRESCALER,
+};
+
+/* ADC2 handle for phase currents */
+adc_handle_t CURRENT_SENSE_ADC2_H = {
+		.cfg = &CURRENT_SENSE_ADC2_CFG,
+		.inst = ADC2,
+		.adc_data_ready = false,
+		.last_reading = 0,
+};
+
+/* Injected sequence A, B(, C) on the TIM1 TRGO edge at the PWM counter peak (low-side switches on) */
+const adc_injected_cfg_t CURRENT_SENSE_INJECTED_CFG = {
+		.channel_count = CURRENT_SENSE_SHUNT_COUNT,
+		.channels = {1, 4, 11},
+		.pin_cfgs = {&CURRENT_SENSE_IN_A, &CURRENT_SENSE_IN_B, &CURRENT_SENSE_IN_C},
+		.sample_time = CYCLES_15,
+		.trigger = ADC_JEXT_TRIGGER_TIM1_TRGO,
+};
+
+/* DMA configuration for ADC1 regular results (DMA2 Stream0, channel 0) */
+const dma_cfg_t ADC1_DMA_CFG = {
+		.inst = DMA2,
+		.stream = DMA2_Stream0,
+		.stream_index = 0,
+		.channel = 0,
+		.direction = DMA_DIR_PERIPH_TO_MEM,
+		.data_size = DMA_DATA_SIZE_16_BIT,
+		.memory_increment = true,
+		.circular = true,
+		.stream_priority = 2,
+		.irqn = DMA2_Stream0_IRQn,
+		.irq_priority = IRQ_PRIORITY_ANGLE_DMA,
+};
+
+/* DMA handle for ADC1 regular results */
+dma_handle_t ADC1_DMA_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
+/* DMA configuration for USART2 transmit (DMA1 Stream6, channel 4) */
+const dma_cfg_t USART2_TX_DMA_CFG = {
+		.inst = DMA1,
+		.stream = DMA1_Stream6,
+		.stream_index = 6,
+		.channel = 4,
+		.direction = DMA_DIR_MEM_TO_PERIPH,
+		.data_size = DMA_DATA_SIZE_8_BIT,
+		.memory_increment = true,
+		.circular = false,
+		.stream_priority = 0,
+		.irqn = DMA1_Stream6_IRQn,
+		.irq_priority = IRQ_PRIORITY_USART,
+};
+
+/* DMA handle for USART2 transmit */
+dma_handle_t USART2_TX_DMA_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
+/* DMA configuration for I2C1 receive (DMA1 Stream0, channel 1) */
+const dma_cfg_t I2C1_RX_DMA_CFG = {
+		.inst = DMA1,
+		.stream = DMA1_Stream0,
+		.stream_index = 0,
+		.channel = 1,
+		.direction = DMA_DIR_PERIPH_TO_MEM,
+		.data_size = DMA_DATA_SIZE_8_BIT,
+		.memory_increment = true,
+		.circular = false,
+		.stream_priority = 2,
+		.irqn = DMA1_Stream0_IRQn,
+		.irq_priority = IRQ_PRIORITY_I2C,
+};
+
+/* DMA handle for I2C1 receive */
+dma_handle_t I2C1_RX_DMA_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
+/* TIM2 divider: TIM1 TRGO (one pulse per PWM period) -> one ADC trigger per 2 periods (100 us at 20 kHz) */
+const tim2_trigger_cfg_t ADC_TRIGGER_TIM2_CFG = {
+		.input = TIM2_TRIGGER_ITR0_TIM1_TRGO,
+		.events_per_trigger = 2,
+};
+
+/* TIM2 trigger divider handle */
+tim2_trigger_handle_t ADC_TRIGGER_TIM2_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
+/* TIM5 timebase: 1 MHz from the APB1 timer clock, backs SYSTICK_GetTimeUs() */
+const tim5_timebase_cfg_t TIMEBASE_TIM5_CFG = {
+		.tim_clk_hz = APB1_TIM_CLK_HZ,
+		.tick_hz = 1000000u,
+		.irq_prio = IRQ_PRIORITY_TIMEBASE,
+		.lock_prio = IRQ_LOCK_PRIORITY_TIMESTAMP,
+};
+
+/* TIM5 timebase handle */
+tim5_timebase_handle_t TIMEBASE_TIM5_H = {
+		.cfg = NULL,
+		.overflow_count = 0u,
+		.is_initialized = false,
+};
+
 /* GPIO configuration for USART2 (PA2 as Tx) */
 const gpio_pin_cfg_t PIN_TX = {
 		.pin = {GPIOA, 2, GPIO_PORTA},
@@ -97,17 +339,19 @@ const gpio_pin_cfg_t PIN_RX = {
 
 /* USART2 configuration for PC connection (ST-LINK VCP) */
 const usart2_cfg_t USART2_CFG = {
-		.irq_priority = 7,
+		.irq_priority = IRQ_PRIORITY_USART,
 		.irqn = USART2_IRQn,
 		.pin_cfg_rx = &PIN_RX,
 		.pin_cfg_tx = &PIN_TX,
 		.usart_baud = BAUDRATE,
-		.usart_pclk_hz = APB1_CLK_HZ
+		.usart_pclk_hz = APB1_CLK_HZ,
+		.tx_mode = USART2_TX_MODE_DMA,
+		.tx_dma_h = &USART2_TX_DMA_H,
 };
 
 /* USART2 RX/TX ring buffers (storage owned by this module and referenced by USART2_H) */
 static ring_buffer_t usart2_rx_rb = {0};
-static ring_buffer_t usart2_tx_rb = {0};
+static tx_ring_buffer_t usart2_tx_rb = {0};
 
 /* USART2 Handle */
 usart2_handle_t USART2_H = {
@@ -119,6 +363,44 @@ usart2_handle_t USART2_H = {
 		.tx_buffer = &usart2_tx_rb,
 };
 
+/* GPIO configuration for I2C1 (PB8 as SCL, external 4.7k pull-up recommended) */
+const gpio_pin_cfg_t PIN_I2C1_SCL = {
+		.pin = {GPIOB, 8, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 4
+};
+
+/* GPIO configuration for I2C1 (PB9 as SDA) */
+const gpio_pin_cfg_t PIN_I2C1_SDA = {
+		.pin = {GPIOB, 9, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 4
+};
+
+/* I2C1 configuration for the AS5600 digital interface (400 kHz fast mode) */
+const i2c1_cfg_t I2C1_CFG = {
+		.pin_cfg_scl = &PIN_I2C1_SCL,
+		.pin_cfg_sda = &PIN_I2C1_SDA,
+		.pclk_hz = APB1_CLK_HZ,
+		.bus_hz = 400000u,
+		.rx_dma_h = &I2C1_RX_DMA_H,
+		.ev_irqn = I2C1_EV_IRQn,
+		.er_irqn = I2C1_ER_IRQn,
+		.irq_priority = IRQ_PRIORITY_I2C,
+};
+
+/* I2C1 handle */
+i2c1_handle_t I2C1_H = {
+		.cfg = NULL,
+		.is_initialized = false,
+};
+
 /* GPIO configuration for PWM via TIM1 (PA8 as Ch1) */
 const gpio_pin_cfg_t PWM_CH1 = {
 		.pin = {GPIOA, 8, GPIO_PORTA},
@@ -149,14 +431,78 @@ const gpio_pin_cfg_t PWM_CH3 = {
 		.af = 1
 };
 
+#if (PWM_OUTPUT_STAGE == PWM_OUTPUT_STAGE_6PWM)
+/* GPIO configuration for PWM via TIM1 (PB13 as Ch1N), low-side gate, pulled low until AF takes over */
+const gpio_pin_cfg_t PWM_CH1N = {
+		.pin = {GPIOB, 13, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 1
+};
+
+/* GPIO configuration for PWM via TIM1 (PB14 as Ch2N) */
+const gpio_pin_cfg_t PWM_CH2N = {
+		.pin = {GPIOB, 14, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 1
+};
+
+/* GPIO configuration for PWM via TIM1 (PB15 as Ch3N) */
+const gpio_pin_cfg_t PWM_CH3N = {
+		.pin = {GPIOB, 15, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 1
+};
+#endif
+
+/* GPIO configuration for the TIM1 break input (PB12 as BKIN, active low: open-drain nFAULT / comparator) */
+const gpio_pin_cfg_t PWM_BKIN = {
+		.pin = {GPIOB, 12, GPIO_PORTB},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_UP,
+		.speed = GPIO_SPEED_LOW,
+		.af = 1
+};
+
 /* TIM1 PWM configuration (frequency in Hz) */
 const pwm_tim1_cfg_t PWM_CFG = {
-  .tim_clk_hz = SYSCLK_HZ,
+  .inst       = TIM1,
+  .tim_clk_hz = APB2_TIM_CLK_HZ,
   .pwm_hz     = 20000,
   .align      = PWM_ALIGN_CENTER_1,
   .pin_ch1    = &PWM_CH1,
   .pin_ch2    = &PWM_CH2,
   .pin_ch3    = &PWM_CH3,
+#if (PWM_OUTPUT_STAGE == PWM_OUTPUT_STAGE_6PWM)
+  /* 6-PWM: complementary low sides with hardware dead time, both switches off while MOE = 0 */
+  .pin_ch1n   = &PWM_CH1N,
+  .pin_ch2n   = &PWM_CH2N,
+  .pin_ch3n   = &PWM_CH3N,
+  .dead_time_ns = PWM_DEAD_TIME_NS,
+#endif
+  .update_irqn = TIM1_UP_TIM10_IRQn,
+  .update_irq_priority = IRQ_PRIORITY_PWM_UPDATE,
+  /* Break: outputs driven low while MOE = 0 (MOTOR_EN is dropped by the fault path as well) */
+  .pin_bkin   = &PWM_BKIN,
+  .break_polarity = PWM_BREAK_ACTIVE_LOW,
+  .idle_off_state_driven = true,
+  .run_off_state_driven = true,
+  .idle_high_mask = 0u,
+  .break_irqn = TIM1_BRK_TIM9_IRQn,
+  .break_irq_priority = IRQ_PRIORITY_FAULT,
+  /* COM: 6-step pattern commit (commutation mode only) */
+  .com_irqn = TIM1_TRG_COM_TIM11_IRQn,
+  .com_irq_priority = IRQ_PRIORITY_COMMUTATION,
+  .duty_lock_priority = IRQ_LOCK_PRIORITY_PWM_DUTY,
 };
 
 /* PWM Handle via TIM1 */
@@ -164,11 +510,114 @@ pwm_tim1_handle_t PWM_H = {
 		.arr = 0,
 };
 
+#if (MOTOR_AXIS_COUNT > 1u)
+/* GPIO configuration for the second-axis driver enable (PB2) */
+const gpio_pin_cfg_t MOTOR2_EN = {
+		.pin = {GPIOB, 2, GPIO_PORTB},
+		.mode = GPIO_MODE_OUTPUT,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_NONE,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* GPIO configuration for the second-axis ADC input (PC0 / ADC3_IN10) */
+const gpio_pin_cfg_t ADC_IN10 = {
+		.pin = {GPIOC, 0, GPIO_PORTC},
+		.mode = GPIO_MODE_ANALOG,
+		.otype = GPIO_OTYPE_OPENDRAIN,
+		.pull = GPIO_PULL_NONE,
+		.speed = GPIO_SPEED_LOW,
+		.af = 0
+};
+
+/* ADC configuration for PC0 (channel 10), shares ADC_IRQn with ADC1 / ADC2 */
+const adc_cfg_t ADC3_IN10_CFG = {
+		.adc_channel = 10,
+		.inst = ADC3,
+		.mode = ADC_MODE_SINGLE,
+		.pin_cfg = &ADC_IN10,
+		.resolution = ADC_12_BIT,
+		.sample_time = CYCLES_84,
+		.irqn = ADC_IRQn,
+		.irq_priority = IRQ_PRIORITY_ADC,
+		.clk_prescaler = ADC_CLK_PRESCALER,
+};
+
+/* ADC handle for PC0 (channel 10) */
+adc_handle_t ADC3_IN10_H = {
+		.cfg = & ADC3_IN10_CFG,
+		.inst = ADC3,
+		.adc_data_ready = false,
+		.last_reading = 0,
+};
+
+/* GPIO configuration for PWM via TIM8 (PC6 as Ch1) */
+const gpio_pin_cfg_t PWM_TIM8_CH1 = {
+		.pin = {GPIOC, 6, GPIO_PORTC},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 3
+};
+
+/* GPIO configuration for PWM via TIM8 (PC7 as Ch2) */
+const gpio_pin_cfg_t PWM_TIM8_CH2 = {
+		.pin = {GPIOC, 7, GPIO_PORTC},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 3
+};
+
+/* GPIO configuration for PWM via TIM8 (PC8 as Ch3) */
+const gpio_pin_cfg_t PWM_TIM8_CH3 = {
+		.pin = {GPIOC, 8, GPIO_PORTC},
+		.mode = GPIO_MODE_AF,
+		.otype = GPIO_OTYPE_PUSHPULL,
+		.pull = GPIO_PULL_DOWN,
+		.speed = GPIO_SPEED_HIGH,
+		.af = 3
+};
+
+/* TIM8 PWM configuration: same frequency and alignment as TIM1 (required by the staggered start) */
+const pwm_tim1_cfg_t PWM_TIM8_CFG = {
+  .inst       = TIM8,
+  .tim_clk_hz = APB2_TIM_CLK_HZ,
+  .pwm_hz     = 20000,
+  .align      = PWM_ALIGN_CENTER_1,
+  .pin_ch1    = &PWM_TIM8_CH1,
+  .pin_ch2    = &PWM_TIM8_CH2,
+  .pin_ch3    = &PWM_TIM8_CH3,
+  .update_irqn = TIM8_UP_TIM13_IRQn,
+  .update_irq_priority = IRQ_PRIORITY_PWM_UPDATE,
+  /* No BKIN pin: software break from the fault path only */
+  .pin_bkin   = NULL,
+  .break_polarity = PWM_BREAK_ACTIVE_LOW,
+  .idle_off_state_driven = true,
+  .run_off_state_driven = true,
+  .idle_high_mask = 0u,
+  .break_irqn = TIM8_BRK_TIM12_IRQn,
+  .break_irq_priority = IRQ_PRIORITY_FAULT,
+  .com_irqn = TIM8_TRG_COM_TIM14_IRQn,
+  .com_irq_priority = IRQ_PRIORITY_COMMUTATION,
+  .duty_lock_priority = IRQ_LOCK_PRIORITY_PWM_DUTY,
+};
+
+/* PWM Handle via TIM8 */
+pwm_tim1_handle_t PWM_TIM8_H = {
+		.arr = 0,
+};
+#endif
+
 /* SYSTICK configuration. Only one instance can be implemented*/
 const systick_cfg_t SYSTICK_CFG = {
-  .sysclk_hz = APB1_CLK_HZ,
+  .sysclk_hz = SYSCLK_HZ,
   .tick_period_us = SYSTICK_PERIOD_US,
-  .irq_prio = 8,
+  .irq_prio = IRQ_PRIORITY_TIMEBASE,
+  .timebase_h = &TIMEBASE_TIM5_H,
 };
 
 /* SYSTICK Handle */
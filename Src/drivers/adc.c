@@ -4,10 +4,28 @@
  *
  *  Notes:
  *  - Handles EOC interrupt only (no overrun handling).
+ *  - ADC1..3 share one interrupt vector: adc_init() records the handle per
+ *    instance for adc_shared_irq_handler().
+ *  - Triggered DMA mode restarts on overrun from adc_irq_handler().
+ *  - Injected sequence: JSQR fills from JSQ4 downwards (JL = n-1 uses JSQ(4-n+1)..JSQ4),
+ *    results land in JDR1..JDRn in conversion order.
  */
 
 
 #include "drivers/adc.h"
+#include "drivers/memory_section.h"
+
+/* Handle per instance (ADC1..3) for the shared interrupt vector, written by adc_init() only. */
+static adc_handle_t *s_adc_handles[ADC_INSTANCE_COUNT] = {NULL};
+
+/* Map one instance to its slot in s_adc_handles, ADC_INSTANCE_COUNT if unknown */
+static uint32_t adc_instance_index(const ADC_TypeDef *inst)
+{
+	if(inst == ADC1) return 0U;
+	if(inst == ADC2) return 1U;
+	if(inst == ADC3) return 2U;
+	return ADC_INSTANCE_COUNT;
+}
 
 /* Configure ADC registers */
 bool adc_init(adc_handle_t *adc_h, const adc_cfg_t *adc_cfg)
@@ -19,6 +37,12 @@ bool adc_init(adc_handle_t *adc_h, const adc_cfg_t *adc_cfg)
 
 	if(adc_cfg->inst == NULL) return false; // invalid instance in adc_cfg
 
+	uint32_t instance_index = adc_instance_index(adc_cfg->inst);
+	if(instance_index >= ADC_INSTANCE_COUNT) return false; // not an ADC instance
+
+	// one handle per instance on the shared vector
+	if((s_adc_handles[instance_index] != NULL) && (s_adc_handles[instance_index] != adc_h)) return false;
+
 	if(adc_cfg->adc_channel > ADC_CHANNEL_MAX) return false; // invalid channel number
 
 	if(adc_cfg->pin_cfg->mode != GPIO_MODE_ANALOG) return false; // invalid pin mode
@@ -40,6 +64,10 @@ bool adc_init(adc_handle_t *adc_h, const adc_cfg_t *adc_cfg)
 	// Disable ADC before configuration
 	adc_cfg->inst->CR2 &= ~ ADC_CR2_ADON;
 
+	// set ADC kernel clock prescaler (common register)
+	ADC123_COMMON->CCR &= ~ADC_CCR_ADCPRE;
+	ADC123_COMMON->CCR |= ((uint32_t)adc_cfg->clk_prescaler << ADC_CCR_ADCPRE_Pos);
+
 	// set conversion resolution
 	adc_cfg->inst->CR1 &= ~(ADC_CR1_RES_0|ADC_CR1_RES_1);
 	adc_cfg->inst->CR1 |=(adc_cfg->resolution<<ADC_CR1_RES_Pos);
@@ -85,7 +113,16 @@ bool adc_init(adc_handle_t *adc_h, const adc_cfg_t *adc_cfg)
 	adc_h->inst = adc_cfg->inst;
 	adc_h->last_reading = 0;
 	adc_h->adc_data_ready = false;
+	adc_h->overrun_cnt = 0;
+	adc_h->injected_cfg = NULL;
+	adc_h->injected_callback = NULL;
+	adc_h->injected_callback_arg = NULL;
+	adc_h->injected_sequence_cnt = 0;
+	adc_h->eoc_callback = NULL;
+	adc_h->eoc_callback_arg = NULL;
 
+	// visible to the shared vector from here on
+	s_adc_handles[instance_index] = adc_h;
 
 	// Enable ADC
 	adc_cfg->inst->CR2 |= ADC_CR2_ADON;
@@ -105,6 +142,7 @@ void adc_start(adc_handle_t *adc_h)
 
 
 /* read new data when available */
+MEMORY_SECTION_RAMFUNC
 bool adc_read(adc_handle_t *adc_h, uint16_t *output)
 {
 	if((adc_h == NULL)||(output==NULL)){
@@ -122,14 +160,199 @@ bool adc_read(adc_handle_t *adc_h, uint16_t *output)
 }
 
 
+/* Route regular conversions from an external trigger into a circular DMA buffer */
+bool adc_start_dma_triggered(adc_handle_t *adc_h, dma_handle_t *dma_h, adc_ext_trigger_t trigger,
+							 volatile uint16_t *buffer, uint16_t length)
+{
+	if((adc_h == NULL)||(dma_h == NULL)||(buffer == NULL)||(length == 0U)){
+		return false;
+	}
+	if((adc_h->inst == NULL)||(adc_h->cfg==NULL)){
+		return false;
+	}
+
+	// Stop DMA requests and triggers while reconfiguring
+	adc_h->inst->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_EXTEN | ADC_CR2_EXTSEL | ADC_CR2_CONT);
+	adc_h->inst->CR1 &= ~ADC_CR1_EOCIE;
+	adc_h->inst->SR &= ~(ADC_SR_OVR | ADC_SR_EOC);
+	(void) adc_h->inst->DR;
+
+	// Destination buffer first, then DMA requests from the ADC
+	if(!dma_start(dma_h, (uint32_t)&adc_h->inst->DR, buffer, length)) return false;
+	adc_h->inst->CR2 |= (ADC_CR2_DMA | ADC_CR2_DDS);
+
+	// ADC interrupt remains enabled for overrun recovery only
+	adc_h->inst->CR1 |= ADC_CR1_OVRIE;
+
+	// One conversion per rising edge of the selected trigger
+	adc_h->inst->CR2 |= ((uint32_t)trigger << ADC_CR2_EXTSEL_Pos);
+	adc_h->inst->CR2 |= (1U << ADC_CR2_EXTEN_Pos);
+
+	adc_h->adc_data_ready = false;
+
+	return true;
+}
+
+
 /* callback function for EOC, overrun cases are not considered */
+MEMORY_SECTION_RAMFUNC
 void adc_irq_handler(adc_handle_t *adc_h)
 {
 	if((adc_h == NULL)||(adc_h->inst == NULL)||(adc_h->cfg==NULL)) return; // Do nothing if pointers invalid
 
+	// DMA mode: overrun halts DMA requests, toggle DMA to resume (buffer position continues)
+	if(adc_h->inst->SR & ADC_SR_OVR){
+		adc_h->inst->SR &= ~ADC_SR_OVR;
+		adc_h->inst->CR2 &= ~ADC_CR2_DMA;
+		adc_h->inst->CR2 |= ADC_CR2_DMA;
+		adc_h->overrun_cnt++;
+	}
+
+	// EOC interrupt off (DMA mode): the DMA stream owns DR
+	if((adc_h->inst->CR1 & ADC_CR1_EOCIE) == 0U) return;
+
 	if(adc_h->inst->SR & ADC_SR_EOC){
 		adc_h->last_reading = (uint16_t)(adc_h->inst->DR & 0xFFFFU);
 		adc_h->adc_data_ready = true;
+
+		if(adc_h->eoc_callback) adc_h->eoc_callback(adc_h->eoc_callback_arg);
+	}
+
+}
+
+
+/* Register the regular EOC callback */
+bool adc_register_callback(adc_handle_t *adc_h, adc_callback_t callback, void *callback_arg)
+{
+	if(adc_h == NULL) return false;
+
+	adc_h->eoc_callback = NULL;
+	adc_h->eoc_callback_arg = callback_arg;
+	adc_h->eoc_callback = callback;
+
+	return true;
+}
+
+
+/* One vector for ADC1..3: service each initialized instance */
+MEMORY_SECTION_RAMFUNC
+void adc_shared_irq_handler(void)
+{
+	for(uint32_t i = 0U; i < ADC_INSTANCE_COUNT; i++){
+		adc_handle_t *adc_h = s_adc_handles[i];
+
+		if(adc_h == NULL) continue;
+		adc_irq_handler(adc_h);
+		adc_injected_irq_handler(adc_h);
+	}
+}
+
+
+/* set the sample time of one channel (SMPR1 for 10..18, SMPR2 for 0..9) */
+static void adc_set_sample_time(ADC_TypeDef *inst, uint8_t channel, adc_sample_t sample_time)
+{
+	uint32_t adc_sample_shift;
+	if(channel < 10U){
+		adc_sample_shift = (uint32_t)channel*3U;
+		inst->SMPR2 &= ~(7U << adc_sample_shift);
+		inst->SMPR2 |= ((uint32_t)sample_time << adc_sample_shift);
+	}
+	else{
+		adc_sample_shift = (uint32_t)(channel - 10U)*3U;
+		inst->SMPR1 &= ~(7U << adc_sample_shift);
+		inst->SMPR1 |= ((uint32_t)sample_time << adc_sample_shift);
+	}
+}
+
+
+/* Configure the injected sequence, external trigger stays disabled */
+bool adc_injected_init(adc_handle_t *adc_h, const adc_injected_cfg_t *injected_cfg)
+{
+	if((adc_h == NULL)||(injected_cfg == NULL)) return false;
+	if((adc_h->inst == NULL)||(adc_h->cfg == NULL)) return false;
+	if((injected_cfg->channel_count == 0U)||(injected_cfg->channel_count > ADC_INJECTED_CHANNEL_MAX)) return false;
+
+	uint32_t jsqr = ((uint32_t)(injected_cfg->channel_count - 1U) << ADC_JSQR_JL_Pos);
+	for(uint8_t i = 0U; i < injected_cfg->channel_count; i++){
+		if(injected_cfg->channels[i] > ADC_CHANNEL_MAX) return false;
+		if((injected_cfg->pin_cfgs[i] == NULL)||(injected_cfg->pin_cfgs[i]->mode != GPIO_MODE_ANALOG)) return false;
+		if(!gpio_init_pin(injected_cfg->pin_cfgs[i])) return false;
+
+		// JSQ(4-n+1+i) holds the i-th conversion
+		jsqr |= ((uint32_t)injected_cfg->channels[i] << ((4U - injected_cfg->channel_count + i)*5U));
+		adc_set_sample_time(adc_h->inst, injected_cfg->channels[i], injected_cfg->sample_time);
+	}
+
+	// trigger off while configuring
+	adc_h->inst->CR2 &= ~(ADC_CR2_JEXTEN | ADC_CR2_JEXTSEL);
+	adc_h->inst->JSQR = jsqr;
+	adc_h->inst->CR2 |= ((uint32_t)injected_cfg->trigger << ADC_CR2_JEXTSEL_Pos);
+
+	// scan mode converts the whole sequence per trigger, JEOC after its last conversion
+	adc_h->inst->CR1 &= ~ADC_CR1_JAUTO;
+	adc_h->inst->CR1 |= (ADC_CR1_SCAN | ADC_CR1_JEOCIE);
+	adc_h->inst->SR &= ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+
+	adc_h->injected_cfg = injected_cfg;
+	adc_h->injected_sequence_cnt = 0;
+
+	return true;
+}
+
+
+/* Register the injected-sequence callback */
+bool adc_injected_register_callback(adc_handle_t *adc_h, adc_injected_callback_t callback, void *callback_arg)
+{
+	if(adc_h == NULL) return false;
+
+	adc_h->injected_callback = NULL;
+	adc_h->injected_callback_arg = callback_arg;
+	adc_h->injected_callback = callback;
+
+	return true;
+}
+
+
+/* Start / stop conversions on the injected trigger */
+bool adc_injected_set_trigger(adc_handle_t *adc_h, bool enable)
+{
+	if((adc_h == NULL)||(adc_h->inst == NULL)||(adc_h->injected_cfg == NULL)) return false;
+
+	adc_h->inst->CR2 &= ~ADC_CR2_JEXTEN;
+	if(enable){
+		adc_h->inst->SR &= ~ADC_SR_JEOC;
+		adc_h->inst->CR2 |= (1U << ADC_CR2_JEXTEN_Pos);
+	}
+
+	return true;
+}
+
+
+/* JEOC set again while the previous sequence is still being processed */
+bool adc_injected_is_pending(const adc_handle_t *adc_h)
+{
+	if((adc_h == NULL)||(adc_h->inst == NULL)||(adc_h->injected_cfg == NULL)) return false;
+
+	return ((adc_h->inst->SR & ADC_SR_JEOC) != 0U);
+}
+
+
+/* JEOC: read JDR1..n and hand them to the callback */
+void adc_injected_irq_handler(adc_handle_t *adc_h)
+{
+	if((adc_h == NULL)||(adc_h->inst == NULL)||(adc_h->injected_cfg == NULL)) return;
+	if((adc_h->inst->SR & ADC_SR_JEOC) == 0U) return;
+
+	// rc_w0 flag: clear before reading so the next sequence can set it again
+	adc_h->inst->SR &= ~ADC_SR_JEOC;
+
+	uint16_t samples[ADC_INJECTED_CHANNEL_MAX];
+	volatile uint32_t *jdr = &adc_h->inst->JDR1;
+	uint8_t count = adc_h->injected_cfg->channel_count;
+	for(uint8_t i = 0U; i < count; i++){
+		samples[i] = (uint16_t)(jdr[i] & 0xFFFFU);
 	}
+	adc_h->injected_sequence_cnt++;
 
+	if(adc_h->injected_callback) adc_h->injected_callback(adc_h->injected_callback_arg, samples, count);
 }
@@ -2,42 +2,17 @@
  * @file as5600_analog.c
  * @brief Sensor-specific AS5600 analog angle acquisition helper.
  *
- * This module schedules fixed-rate raw ADC sampling, builds one published
- * mechanical-angle sample from a fixed raw window, and exposes one consumed
- * sample to the application layer.
+ * This module schedules fixed-rate raw ADC sampling (or takes timer-triggered
+ * DMA windows), builds one published mechanical-angle sample from a raw
+ * window of run-time selectable length, and exposes one consumed sample to
+ * the application layer.
  */
 
 #include "drivers/as5600_analog.h"
+#include "drivers/profiler.h"
+#include "drivers/memory_section.h"
 #include <stddef.h>
 
-/* The current IRQ integration forwards ADC samples to one active AS5600 handle. */
-static as5600_analog_handle_t *s_as5600_analog_h = NULL;
-
-/**
- * @brief Save IRQ state and enter a short critical section.
- *
- * @return Previous PRIMASK state.
- */
-static uint32_t as5600_analog_irq_save(void)
-{
-	uint32_t primask = __get_PRIMASK();
-	__disable_irq();
-	return primask;
-}
-
-/**
- * @brief Restore IRQ state saved by as5600_analog_irq_save().
- *
- * @param primask Previous PRIMASK state.
- */
-static void as5600_analog_irq_restore(uint32_t primask)
-{
-	if ((primask & 1u) == 0u)
-	{
-		__enable_irq();
-	}
-}
-
 /**
  * @brief Convert one raw ADC sample into one mechanical angle sample.
  *
@@ -46,6 +21,7 @@ static void as5600_analog_irq_restore(uint32_t primask)
  * @param direction Mechanical-angle direction for the published sample.
  * @return Mechanical angle in full-turn uint16 units.
  */
+MEMORY_SECTION_RAMFUNC
 static uint16_t as5600_analog_raw_sample_to_mechanical_angle_u16(uint16_t raw_sample,
 																  uint16_t adc_full_scale,
 																  as5600_analog_direction_t direction)
@@ -66,6 +42,32 @@ static uint16_t as5600_analog_raw_sample_to_mechanical_angle_u16(uint16_t raw_sa
 	return mechanical_angle_u16;
 }
 
+/**
+ * @brief Look up the interpolated correction of one angle.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param point_count Installed point count (non-zero).
+ * @param mechanical_angle_u16 Angle from the linear mapping.
+ * @return Corrected angle in full-turn uint16 units.
+ */
+MEMORY_SECTION_RAMFUNC
+static uint16_t as5600_analog_apply_linearization(const as5600_analog_handle_t *as5600_analog_h,
+												  uint8_t point_count,
+												  uint16_t mechanical_angle_u16)
+{
+	uint8_t shift = as5600_analog_h->linearization_shift;
+	uint32_t index = (uint32_t)mechanical_angle_u16 >> shift;
+	int32_t fraction = (int32_t)((uint32_t)mechanical_angle_u16 & ((1u << shift) - 1u));
+	int32_t correction_lo = as5600_analog_h->linearization_counts[index];
+	/* The table is periodic: the segment after the last point ends at point 0. */
+	int32_t correction_hi = as5600_analog_h->linearization_counts[(index + 1u) & ((uint32_t)point_count - 1u)];
+
+	/* correction = c[k] + (c[k+1] - c[k]) * fraction / segment, arithmetic shift keeps the sign. */
+	int32_t correction_counts = correction_lo + (((correction_hi - correction_lo) * fraction) >> shift);
+
+	return (uint16_t)((int32_t)mechanical_angle_u16 + correction_counts);
+}
+
 /**
  * @brief Compute one signed wrapped delta between two uint16 angles.
  *
@@ -73,6 +75,7 @@ static uint16_t as5600_analog_raw_sample_to_mechanical_angle_u16(uint16_t raw_sa
  * @param reference_angle_u16 Reference angle in full-turn uint16 units.
  * @return Signed shortest-path delta in angle counts.
  */
+MEMORY_SECTION_RAMFUNC
 static int32_t as5600_analog_wrapped_delta_counts(uint16_t angle_u16,
 												  uint16_t reference_angle_u16)
 {
@@ -80,23 +83,34 @@ static int32_t as5600_analog_wrapped_delta_counts(uint16_t angle_u16,
 }
 
 /**
- * @brief Divide one signed integer and round to nearest integer.
+ * @brief Divide one signed integer and round to nearest integer (half away from zero).
+ *
+ * Power-of-two denominators (full 2/4/8/16 windows) use one shift, others
+ * one 32-bit hardware divide.
  *
  * @param numerator Signed numerator.
  * @param denominator Positive denominator.
  * @return Rounded signed quotient.
  */
+MEMORY_SECTION_RAMFUNC
 static int32_t as5600_analog_divide_round_signed_i32(int32_t numerator,
 													  uint16_t denominator)
 {
-	if (numerator >= 0)
+	uint32_t magnitude = (numerator < 0) ? (0u - (uint32_t)numerator) : (uint32_t)numerator;
+	uint32_t quotient = 0u;
+
+	if ((denominator & (uint16_t)(denominator - 1u)) == 0u)
+	{
+		uint32_t shift = 31u - __CLZ((uint32_t)denominator);
+
+		quotient = (shift == 0u) ? magnitude : ((magnitude + (1u << (shift - 1u))) >> shift);
+	}
+	else
 	{
-		return (int32_t)(((int64_t)numerator + ((int64_t)denominator / 2LL)) /
-						 (int64_t)denominator);
+		quotient = (magnitude + ((uint32_t)denominator / 2u)) / (uint32_t)denominator;
 	}
 
-	return (int32_t)(((int64_t)numerator - ((int64_t)denominator / 2LL)) /
-					 (int64_t)denominator);
+	return (numerator < 0) ? -(int32_t)quotient : (int32_t)quotient;
 }
 
 /**
@@ -107,6 +121,7 @@ static int32_t as5600_analog_divide_round_signed_i32(int32_t numerator,
  * @param sample_count Number of samples in the active publish window.
  * @return Averaged mechanical angle in full-turn uint16 units.
  */
+MEMORY_SECTION_RAMFUNC
 static uint16_t as5600_analog_finalize_window_average_angle_u16(uint16_t reference_angle_u16,
 																 int32_t delta_sum_counts,
 																 uint16_t sample_count)
@@ -126,6 +141,7 @@ static uint16_t as5600_analog_finalize_window_average_angle_u16(uint16_t referen
  * @param wrap_correction_threshold_counts Wrap correction threshold in counts.
  * @return Corrected signed delta in angle counts.
  */
+MEMORY_SECTION_RAMFUNC
 static int32_t as5600_analog_compute_corrected_delta_from_last_published(uint16_t sample_angle_u16,
 																		  uint16_t last_published_angle_u16,
 																		  uint16_t wrap_correction_threshold_counts)
@@ -153,6 +169,7 @@ static int32_t as5600_analog_compute_corrected_delta_from_last_published(uint16_
  * @param value Signed value.
  * @return Absolute value.
  */
+MEMORY_SECTION_RAMFUNC
 static int32_t as5600_analog_abs_i32(int32_t value)
 {
 	return (value < 0) ? (-value) : value;
@@ -162,56 +179,339 @@ static int32_t as5600_analog_abs_i32(int32_t value)
  * @brief Wrap one signed reconstructed angle into uint16 full-turn range.
  *
  * @param signed_angle_counts Signed reconstructed angle in full-turn counts.
- * @return Wrapped angle in uint16 full-turn units.
+ * @return Wrapped angle in uint16 full-turn units (modulo 65536).
  */
+MEMORY_SECTION_RAMFUNC
 static uint16_t as5600_analog_wrap_signed_angle_to_u16(int32_t signed_angle_counts)
 {
-	const int32_t full_turn_counts = (int32_t)AS5600_ANALOG_MECHANICAL_ANGLE_MAX_U16 + 1;
-	int32_t wrapped_counts = signed_angle_counts % full_turn_counts;
+	return (uint16_t)((uint32_t)signed_angle_counts & AS5600_ANALOG_MECHANICAL_ANGLE_MAX_U16);
+}
+
+/**
+ * @brief Latch the requested window length at the start of one publish window.
+ *
+ * Derives the window-center offset, the interval to the previous window
+ * center and the continuity gate for that interval.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_begin_publish_window(as5600_analog_handle_t *as5600_analog_h)
+{
+	const as5600_analog_cfg_t *cfg = as5600_analog_h->cfg;
+	uint16_t window_samples = as5600_analog_h->requested_publish_window_samples;
+	uint32_t plausible_delta_counts = 0u;
+
+	as5600_analog_h->previous_publish_window_samples = as5600_analog_h->publish_window_samples;
+	as5600_analog_h->publish_window_samples = window_samples;
+
+	/* Window samples are evenly spaced, so the averaged angle belongs to the window center. */
+	as5600_analog_h->window_center_offset_us =
+			((uint32_t)(window_samples - 1u) * cfg->raw_sample_period_us) / 2u;
+	/* Center to center: half of each window. */
+	as5600_analog_h->publish_interval_us =
+			((uint32_t)(as5600_analog_h->previous_publish_window_samples + window_samples) *
+			 cfg->raw_sample_period_us) / 2u;
+
+	/* gate = cfg gate * interval / initial interval, i.e. one fixed plausible speed. */
+	plausible_delta_counts =
+			((uint32_t)cfg->max_plausible_delta_per_publish_counts *
+			 (uint32_t)(as5600_analog_h->previous_publish_window_samples + window_samples)) /
+			(2u * (uint32_t)cfg->raw_samples_per_publish);
+	if (plausible_delta_counts > (uint32_t)cfg->wrap_correction_threshold_counts)
+	{
+		plausible_delta_counts = cfg->wrap_correction_threshold_counts;
+	}
+	if (plausible_delta_counts == 0u)
+	{
+		plausible_delta_counts = 1u;
+	}
+	as5600_analog_h->plausible_delta_counts = (uint16_t)plausible_delta_counts;
+}
 
-	if (wrapped_counts < 0)
+/**
+ * @brief Publish one angle sample into the inactive slot of the double buffer.
+ *
+ * The sequence store is the commit point: readers only ever copy slot
+ * (sequence & 1), which the next publish does not touch.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param mechanical_angle_u16 Published mechanical angle.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_publish_sample(as5600_analog_handle_t *as5600_analog_h,
+										 uint16_t mechanical_angle_u16)
+{
+	uint32_t sequence = as5600_analog_h->publish_sequence + 1u;
+	uint64_t now_us = SYSTICK_GetTimeUs();
+	volatile as5600_analog_published_sample_t *slot = NULL;
+
+	/* Skip 0 (nothing published) and keep alternating slots across the wrap. */
+	if (sequence == 0u)
 	{
-		wrapped_counts += full_turn_counts;
+		sequence = 2u;
 	}
 
-	return (uint16_t)wrapped_counts;
+	slot = &as5600_analog_h->published_slots[sequence & 1u];
+	slot->mechanical_angle_u16 = mechanical_angle_u16;
+	slot->capture_timestamp_us = (now_us > as5600_analog_h->window_center_offset_us) ?
+			(now_us - as5600_analog_h->window_center_offset_us) : 0u;
+	slot->sequence = sequence;
+	slot->sample_period_us = as5600_analog_h->publish_interval_us;
+	slot->dropped_publish_count = 0u;
+
+	/* Slot contents must be visible before the new sequence. */
+	__DMB();
+	as5600_analog_h->publish_sequence = sequence;
+
+	if (as5600_analog_h->publish_callback != NULL)
+	{
+		as5600_analog_h->publish_callback(as5600_analog_h->publish_callback_arg);
+	}
 }
 
 /**
- * @brief Find one nearest real sample index by absolute corrected delta.
+ * @brief Copy the latest published slot without masking interrupts.
  *
- * @param corrected_deltas_counts Corrected signed deltas for each window sample.
- * @param sample_count Number of valid samples.
- * @return Earliest sample index with the smallest absolute corrected delta.
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param published_sample Pointer to output sample (dropped count not set).
+ * @return true if one consistent sample was copied, false if none published
+ *         or the writer overran the copy on every retry.
  */
-static uint16_t as5600_analog_find_nearest_sample_index(const int32_t *corrected_deltas_counts,
-														uint16_t sample_count)
+static bool as5600_analog_read_published_slot(const as5600_analog_handle_t *as5600_analog_h,
+											  as5600_analog_published_sample_t *published_sample)
 {
-	uint16_t i = 0u;
-	uint16_t nearest_index = 0u;
-	int32_t nearest_abs_delta_counts = 0;
+	uint32_t attempt = 0u;
 
-	if ((corrected_deltas_counts == NULL) || (sample_count == 0u))
+	for (attempt = 0u; attempt < AS5600_ANALOG_PUBLISH_READ_RETRIES; attempt++)
 	{
-		return 0u;
+		uint32_t sequence = as5600_analog_h->publish_sequence;
+		const volatile as5600_analog_published_sample_t *slot = NULL;
+
+		if (sequence == 0u) return false;
+
+		__DMB();
+		slot = &as5600_analog_h->published_slots[sequence & 1u];
+		published_sample->mechanical_angle_u16 = slot->mechanical_angle_u16;
+		published_sample->capture_timestamp_us = slot->capture_timestamp_us;
+		published_sample->sequence = slot->sequence;
+		published_sample->sample_period_us = slot->sample_period_us;
+		__DMB();
+
+		/* One newer publish wrote the other slot; two or more may have rewritten this one. */
+		if ((uint32_t)(as5600_analog_h->publish_sequence - sequence) < 2u)
+		{
+			return true;
+		}
 	}
 
-	nearest_abs_delta_counts = as5600_analog_abs_i32(corrected_deltas_counts[0u]);
-	nearest_index = 0u;
+	return false;
+}
+
+/**
+ * @brief Finalize the active publish window into one published angle.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param has_last_published_angle true if the continuity anchor is valid.
+ * @return Published mechanical angle in full-turn uint16 units.
+ */
+MEMORY_SECTION_RAMFUNC
+static uint16_t as5600_analog_finalize_window(const as5600_analog_handle_t *as5600_analog_h,
+											  bool has_last_published_angle)
+{
+	int32_t averaged_retained_corrected_delta_counts = 0;
+
+	if (has_last_published_angle == false)
+	{
+		/* Bootstrap publish uses wrap-safe window average because no last published anchor exists yet. */
+		return as5600_analog_finalize_window_average_angle_u16(
+				as5600_analog_h->window_reference_mechanical_angle_u16,
+				as5600_analog_h->window_delta_sum_counts,
+				as5600_analog_h->raw_sample_count);
+	}
 
-	for (i = 1u; i < sample_count; i++)
+	if (as5600_analog_h->window_retained_sample_count == 0u)
 	{
-		int32_t candidate_abs_delta_counts =
-				as5600_analog_abs_i32(corrected_deltas_counts[i]);
+		/* If no sample is plausible, publish one nearest real sample instead of holding last angle. */
+		return as5600_analog_h->window_nearest_mechanical_angle_u16;
+	}
+
+	/* Reconstruct one published angle from the retained corrected-delta average. */
+	averaged_retained_corrected_delta_counts =
+			as5600_analog_divide_round_signed_i32(as5600_analog_h->window_retained_delta_sum_counts,
+												  as5600_analog_h->window_retained_sample_count);
 
-		if (candidate_abs_delta_counts < nearest_abs_delta_counts)
+	return as5600_analog_wrap_signed_angle_to_u16((int32_t)as5600_analog_h->mechanical_angle_u16 +
+												  averaged_retained_corrected_delta_counts);
+}
+
+/**
+ * @brief Append one raw ADC sample to the publish window and publish when full.
+ *
+ * Window statistics are updated incrementally: every sample is converted
+ * and gated once, so the cost per sample does not depend on the window
+ * length and the publish step is one rounded division.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param raw_sample Raw ADC sample from AS5600 analog output.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_process_raw_sample(as5600_analog_handle_t *as5600_analog_h,
+											 uint16_t raw_sample)
+{
+	uint16_t current_sample_mechanical_angle_u16 = 0u;
+	uint16_t published_mechanical_angle_u16 = 0u;
+	bool has_last_published_angle = (as5600_analog_h->publish_sequence != 0u);
+	uint8_t linearization_point_count = as5600_analog_h->linearization_point_count;
+
+	/* Convert the new raw ADC sample into one mechanical angle sample. */
+	current_sample_mechanical_angle_u16 =
+			as5600_analog_raw_sample_to_mechanical_angle_u16(raw_sample,
+															 as5600_analog_h->cfg->adc_full_scale,
+															 as5600_analog_h->cfg->mechanical_angle_direction);
+
+	/* Remove the calibrated periodic angle error before the window statistics. */
+	if (linearization_point_count != 0u)
+	{
+		current_sample_mechanical_angle_u16 =
+				as5600_analog_apply_linearization(as5600_analog_h,
+												  linearization_point_count,
+												  current_sample_mechanical_angle_u16);
+	}
+
+	/* Close the pending raw slot. */
+	as5600_analog_h->raw_conversion_pending = false;
+
+	if (as5600_analog_h->raw_sample_count == 0u)
+	{
+		/* The first sample opens the window and defines the wrap-safe reference for bootstrap averaging. */
+		as5600_analog_begin_publish_window(as5600_analog_h);
+		as5600_analog_h->window_reference_mechanical_angle_u16 = current_sample_mechanical_angle_u16;
+		as5600_analog_h->window_delta_sum_counts = 0;
+		as5600_analog_h->window_retained_delta_sum_counts = 0;
+		as5600_analog_h->window_retained_sample_count = 0u;
+		as5600_analog_h->window_nearest_abs_delta_counts = INT32_MAX;
+	}
+	else
+	{
+		/* Accumulate wrapped signed deltas to avoid 0/360 boundary errors in bootstrap average. */
+		as5600_analog_h->window_delta_sum_counts +=
+				as5600_analog_wrapped_delta_counts(current_sample_mechanical_angle_u16,
+												   as5600_analog_h->window_reference_mechanical_angle_u16);
+	}
+
+	/* The anchor (last published angle) is fixed for the whole window: gate this sample once. */
+	if (has_last_published_angle)
+	{
+		int32_t corrected_delta_counts =
+				as5600_analog_compute_corrected_delta_from_last_published(
+						current_sample_mechanical_angle_u16,
+						as5600_analog_h->mechanical_angle_u16,
+						as5600_analog_h->cfg->wrap_correction_threshold_counts);
+		int32_t abs_corrected_delta_counts = as5600_analog_abs_i32(corrected_delta_counts);
+
+		/* Retain only samples whose corrected delta is plausible for one publish interval. */
+		if (abs_corrected_delta_counts <= (int32_t)as5600_analog_h->plausible_delta_counts)
+		{
+			as5600_analog_h->window_retained_delta_sum_counts += corrected_delta_counts;
+			as5600_analog_h->window_retained_sample_count++;
+		}
+
+		/* Fallback candidate: earliest sample with the smallest corrected delta. */
+		if (abs_corrected_delta_counts < as5600_analog_h->window_nearest_abs_delta_counts)
 		{
-			nearest_abs_delta_counts = candidate_abs_delta_counts;
-			nearest_index = i;
+			as5600_analog_h->window_nearest_abs_delta_counts = abs_corrected_delta_counts;
+			as5600_analog_h->window_nearest_mechanical_angle_u16 = current_sample_mechanical_angle_u16;
 		}
 	}
+	as5600_analog_h->raw_sample_count++;
+
+	/* Publish one mechanical angle sample after the active window length. */
+	if (as5600_analog_h->raw_sample_count >= as5600_analog_h->publish_window_samples)
+	{
+		published_mechanical_angle_u16 = as5600_analog_finalize_window(as5600_analog_h, has_last_published_angle);
+
+		/* Publish one coherent angle sample for application consume. */
+		as5600_analog_h->mechanical_angle_u16 = published_mechanical_angle_u16;
+
+		/* Start a new raw window after publishing one angle sample. */
+		as5600_analog_h->raw_sample_count = 0u;
+		as5600_analog_publish_sample(as5600_analog_h, published_mechanical_angle_u16);
+	}
+}
+
+/**
+ * @brief Process one completed DMA publish window.
+ *
+ * @param as5600_analog_h Pointer to AS5600 analog handle.
+ * @param first_sample_index First buffer index of the completed window.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_process_dma_window(as5600_analog_handle_t *as5600_analog_h,
+											 uint16_t first_sample_index)
+{
+	uint16_t i = 0u;
+
+	if (as5600_analog_h == NULL) return;
+	if (as5600_analog_h->cfg == NULL) return;
+	if (as5600_analog_h->is_initialized == false) return;
+
+	/* Windows are whole buffer halves, so only the last sample of a half can publish. */
+	for (i = 0u; i < as5600_analog_h->cfg->raw_samples_per_publish; i++)
+	{
+		as5600_analog_process_raw_sample(as5600_analog_h,
+										 as5600_analog_h->dma_raw_samples[first_sample_index + i]);
+	}
+}
+
+/**
+ * @brief DMA half-transfer callback: first buffer half holds one complete window.
+ *
+ * @param callback_arg Pointer to AS5600 analog handle.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_dma_half_transfer_callback(void *callback_arg)
+{
+	as5600_analog_process_dma_window((as5600_analog_handle_t *)callback_arg, 0u);
+}
+
+/**
+ * @brief DMA transfer-complete callback: second buffer half holds one complete window.
+ *
+ * @param callback_arg Pointer to AS5600 analog handle.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_dma_transfer_complete_callback(void *callback_arg)
+{
+	as5600_analog_handle_t *as5600_analog_h = (as5600_analog_handle_t *)callback_arg;
+
+	if ((as5600_analog_h == NULL) || (as5600_analog_h->cfg == NULL)) return;
+
+	as5600_analog_process_dma_window(as5600_analog_h,
+									 as5600_analog_h->cfg->raw_samples_per_publish);
+}
+
+/**
+ * @brief ADC EOC callback: consume one completed software-triggered conversion.
+ *
+ * @param callback_arg Pointer to AS5600 analog handle.
+ */
+MEMORY_SECTION_RAMFUNC
+static void as5600_analog_adc_callback(void *callback_arg)
+{
+	as5600_analog_handle_t *as5600_analog_h = (as5600_analog_handle_t *)callback_arg;
+	uint16_t raw_sample = 0u;
 
-	return nearest_index;
+	if (as5600_analog_h == NULL) return;
+	if (as5600_analog_h->is_initialized == false) return;
+
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_AS5600_ADC_ISR);
+	/* Read one completed ADC conversion from the driver IRQ path. */
+	if (adc_read(as5600_analog_h->cfg->adc_h, &raw_sample))
+	{
+		as5600_analog_process_raw_sample(as5600_analog_h, raw_sample);
+	}
+	PROFILER_SCOPE_END(PROFILER_PROBE_AS5600_ADC_ISR);
 }
 
 bool as5600_analog_init(as5600_analog_handle_t *as5600_analog_h,
@@ -227,7 +527,12 @@ bool as5600_analog_init(as5600_analog_handle_t *as5600_analog_h,
 	if (as5600_analog_cfg->raw_samples_per_publish > AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES) return false;
 	if (as5600_analog_cfg->wrap_correction_threshold_counts == 0u) return false;
 	if (as5600_analog_cfg->max_plausible_delta_per_publish_counts == 0u) return false;
-	if ((s_as5600_analog_h != NULL) && (s_as5600_analog_h != as5600_analog_h)) return false;
+	if (as5600_analog_cfg->raw_sample_phase_us >= as5600_analog_cfg->raw_sample_period_us) return false;
+	if ((as5600_analog_cfg->acquisition_mode == AS5600_ANALOG_ACQUISITION_TIMER_DMA) &&
+		(as5600_analog_cfg->dma_h == NULL))
+	{
+		return false;
+	}
 
 	/* Reset scheduling and publish state. */
 	as5600_analog_h->cfg = as5600_analog_cfg;
@@ -235,16 +540,89 @@ bool as5600_analog_init(as5600_analog_handle_t *as5600_analog_h,
 	as5600_analog_h->window_reference_mechanical_angle_u16 = 0u;
 	as5600_analog_h->window_delta_sum_counts = 0;
 	as5600_analog_h->mechanical_angle_u16 = 0u;
-	as5600_analog_h->has_published_angle = false;
-	for (i = 0u; i < AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES; i++)
-	{
-		as5600_analog_h->window_angle_samples_u16[i] = 0u;
-	}
+	/* The first window bootstraps at the configured length (previous = active). */
+	as5600_analog_h->requested_publish_window_samples = as5600_analog_cfg->raw_samples_per_publish;
+	as5600_analog_h->publish_window_samples = as5600_analog_cfg->raw_samples_per_publish;
+	as5600_analog_h->previous_publish_window_samples = as5600_analog_cfg->raw_samples_per_publish;
+	as5600_analog_h->plausible_delta_counts = as5600_analog_cfg->max_plausible_delta_per_publish_counts;
+	as5600_analog_h->publish_interval_us =
+			(uint32_t)as5600_analog_cfg->raw_samples_per_publish * as5600_analog_cfg->raw_sample_period_us;
+	as5600_analog_h->window_center_offset_us =
+			((uint32_t)(as5600_analog_cfg->raw_samples_per_publish - 1u) *
+			 as5600_analog_cfg->raw_sample_period_us) / 2u;
+	as5600_analog_h->window_retained_delta_sum_counts = 0;
+	as5600_analog_h->window_retained_sample_count = 0u;
+	as5600_analog_h->window_nearest_mechanical_angle_u16 = 0u;
+	as5600_analog_h->window_nearest_abs_delta_counts = INT32_MAX;
 	as5600_analog_h->next_raw_sample_time_us = 0u;
 	as5600_analog_h->raw_conversion_pending = false;
-	as5600_analog_h->has_new_angle_sample = false;
+	as5600_analog_h->stale_conversion_count = 0u;
+	for (i = 0u; i < 2u; i++)
+	{
+		as5600_analog_h->published_slots[i].mechanical_angle_u16 = 0u;
+		as5600_analog_h->published_slots[i].capture_timestamp_us = 0u;
+		as5600_analog_h->published_slots[i].sequence = 0u;
+		as5600_analog_h->published_slots[i].sample_period_us = 0u;
+		as5600_analog_h->published_slots[i].dropped_publish_count = 0u;
+	}
+	as5600_analog_h->publish_sequence = 0u;
+	as5600_analog_h->consumed_sequence = 0u;
+	as5600_analog_h->dropped_publish_count = 0u;
+	as5600_analog_h->publish_callback = NULL;
+	as5600_analog_h->publish_callback_arg = NULL;
+	for (i = 0u; i < (2u * AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES); i++)
+	{
+		as5600_analog_h->dma_raw_samples[i] = 0u;
+	}
+	as5600_analog_h->linearization_point_count = 0u;
+	as5600_analog_h->linearization_shift = 0u;
+	for (i = 0u; i < AS5600_ANALOG_LINEARIZATION_MAX_POINTS; i++)
+	{
+		as5600_analog_h->linearization_counts[i] = 0;
+	}
 	as5600_analog_h->is_initialized = true;
-	s_as5600_analog_h = as5600_analog_h;
+
+	/* Software mode: each EOC of this handle's ADC reaches this handle through the driver callback. */
+	if (as5600_analog_cfg->acquisition_mode == AS5600_ANALOG_ACQUISITION_SOFTWARE)
+	{
+		if (!adc_register_callback(as5600_analog_cfg->adc_h, as5600_analog_adc_callback, as5600_analog_h))
+		{
+			as5600_analog_h->is_initialized = false;
+			return false;
+		}
+	}
+
+	/* Timer DMA mode: hand each completed buffer half (one window) to the publish path. */
+	if (as5600_analog_cfg->acquisition_mode == AS5600_ANALOG_ACQUISITION_TIMER_DMA)
+	{
+		if ((!dma_register_callbacks(as5600_analog_cfg->dma_h,
+									 as5600_analog_dma_half_transfer_callback,
+									 as5600_analog_dma_transfer_complete_callback,
+									 as5600_analog_h)) ||
+			(!adc_start_dma_triggered(as5600_analog_cfg->adc_h,
+									  as5600_analog_cfg->dma_h,
+									  as5600_analog_cfg->adc_trigger,
+									  as5600_analog_h->dma_raw_samples,
+									  (uint16_t)(2u * as5600_analog_cfg->raw_samples_per_publish))))
+		{
+			as5600_analog_h->is_initialized = false;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool as5600_analog_register_publish_callback(as5600_analog_handle_t *as5600_analog_h,
+											 as5600_analog_callback_t callback,
+											 void *callback_arg)
+{
+	if ((as5600_analog_h == NULL) || (as5600_analog_h->is_initialized == false)) return false;
+
+	/* Clear first so the ISR never pairs the new callback with the old argument. */
+	as5600_analog_h->publish_callback = NULL;
+	as5600_analog_h->publish_callback_arg = callback_arg;
+	as5600_analog_h->publish_callback = callback;
 
 	return true;
 }
@@ -257,10 +635,13 @@ bool as5600_analog_service(as5600_analog_handle_t *as5600_analog_h,
 	if (as5600_analog_h->cfg->adc_h == NULL) return false;
 	if (as5600_analog_h->is_initialized == false) return false;
 
-	/* Set the first raw sample slot on the first service call. */
+	/* The hardware trigger schedules raw samples in timer DMA mode. */
+	if (as5600_analog_h->cfg->acquisition_mode == AS5600_ANALOG_ACQUISITION_TIMER_DMA) return true;
+
+	/* Set the first raw sample slot on the first service call, shifted by the configured phase. */
 	if (as5600_analog_h->next_raw_sample_time_us == 0u)
 	{
-		as5600_analog_h->next_raw_sample_time_us = now_us;
+		as5600_analog_h->next_raw_sample_time_us = now_us + as5600_analog_h->cfg->raw_sample_phase_us;
 	}
 
 	/* Clear one stale pending conversion so the next raw slot can recover. */
@@ -274,6 +655,7 @@ bool as5600_analog_service(as5600_analog_handle_t *as5600_analog_h,
 		if (now_us >= stale_timeout_us)
 		{
 			as5600_analog_h->raw_conversion_pending = false;
+			as5600_analog_h->stale_conversion_count++;
 		}
 	}
 
@@ -295,155 +677,109 @@ bool as5600_analog_service(as5600_analog_handle_t *as5600_analog_h,
 bool as5600_analog_consume_published_sample(as5600_analog_handle_t *as5600_analog_h,
 											as5600_analog_published_sample_t *published_sample)
 {
-	uint32_t primask = 0u;
+	as5600_analog_published_sample_t sample = {0};
 
 	if (as5600_analog_h == NULL) return false;
 	if (published_sample == NULL) return false;
 	if (as5600_analog_h->cfg == NULL) return false;
 	if (as5600_analog_h->is_initialized == false) return false;
 
-	/* Take one coherent published-sample snapshot and clear the ready flag. */
-	primask = as5600_analog_irq_save();
-	if (as5600_analog_h->has_new_angle_sample == false)
+	/* Take one lock-free snapshot; it is new only if the sequence moved since the last consume. */
+	if (!as5600_analog_read_published_slot(as5600_analog_h, &sample)) return false;
+	if (sample.sequence == as5600_analog_h->consumed_sequence) return false;
+
+	/* Count publishes that were overwritten before this consume. */
+	if (as5600_analog_h->consumed_sequence != 0u)
 	{
-		as5600_analog_irq_restore(primask);
-		return false;
+		as5600_analog_h->dropped_publish_count +=
+				(uint32_t)(sample.sequence - as5600_analog_h->consumed_sequence - 1u);
 	}
+	as5600_analog_h->consumed_sequence = sample.sequence;
 
-	published_sample->mechanical_angle_u16 = as5600_analog_h->mechanical_angle_u16;
-	as5600_analog_h->has_new_angle_sample = false;
-	as5600_analog_irq_restore(primask);
+	sample.dropped_publish_count = as5600_analog_h->dropped_publish_count;
+	*published_sample = sample;
 
 	return true;
 }
 
-void as5600_analog_adc_irq_handler(void)
+bool as5600_analog_get_latest_published_sample(const as5600_analog_handle_t *as5600_analog_h,
+											   as5600_analog_published_sample_t *published_sample)
 {
-	uint16_t window_sample_index = 0u;
-	uint16_t current_sample_mechanical_angle_u16 = 0u;
-	uint16_t published_mechanical_angle_u16 = 0u;
-	uint16_t publish_raw_sample_count = 0u;
-	bool has_last_published_angle = false;
-	int32_t corrected_deltas_counts[AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES] = {0};
-	int32_t retained_corrected_delta_sum_counts = 0;
-	uint16_t retained_sample_count = 0u;
-	int32_t averaged_retained_corrected_delta_counts = 0;
-	int32_t reconstructed_angle_counts = 0;
-	uint16_t nearest_sample_index = 0u;
-	uint16_t i = 0u;
-	uint16_t raw_sample = 0u;
+	if (as5600_analog_h == NULL) return false;
+	if (published_sample == NULL) return false;
+	if (as5600_analog_h->is_initialized == false) return false;
 
-	if (s_as5600_analog_h == NULL) return;
-	if (s_as5600_analog_h->cfg == NULL) return;
-	if (s_as5600_analog_h->cfg->adc_h == NULL) return;
-	if (s_as5600_analog_h->is_initialized == false) return;
+	/* Snapshot only; the main-loop consume state is not changed here. */
+	if (!as5600_analog_read_published_slot(as5600_analog_h, published_sample)) return false;
+	published_sample->dropped_publish_count = as5600_analog_h->dropped_publish_count;
 
-	/* Read one completed ADC conversion from the driver IRQ path. */
-	if (!adc_read(s_as5600_analog_h->cfg->adc_h, &raw_sample))
+	return true;
+}
+
+bool as5600_analog_set_publish_window(as5600_analog_handle_t *as5600_analog_h,
+									  uint16_t raw_samples)
+{
+	if (as5600_analog_h == NULL) return false;
+	if (as5600_analog_h->cfg == NULL) return false;
+	if (as5600_analog_h->is_initialized == false) return false;
+	if ((raw_samples == 0u) || (raw_samples > AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES)) return false;
+
+	/* Windows must end on a DMA buffer-half boundary, where the ISR sees the last sample. */
+	if ((as5600_analog_h->cfg->acquisition_mode == AS5600_ANALOG_ACQUISITION_TIMER_DMA) &&
+		((raw_samples % as5600_analog_h->cfg->raw_samples_per_publish) != 0u))
 	{
-		return;
+		return false;
 	}
 
-	/* Convert the new raw ADC sample into one mechanical angle sample. */
-	current_sample_mechanical_angle_u16 =
-			as5600_analog_raw_sample_to_mechanical_angle_u16(raw_sample,
-															 s_as5600_analog_h->cfg->adc_full_scale,
-															 s_as5600_analog_h->cfg->mechanical_angle_direction);
+	as5600_analog_h->requested_publish_window_samples = raw_samples;
+
+	return true;
+}
+
+bool as5600_analog_set_linearization(as5600_analog_handle_t *as5600_analog_h,
+									 const int16_t *correction_counts,
+									 uint8_t point_count)
+{
+	uint8_t shift = 16u;
+	uint8_t i = 0u;
+
+	if (as5600_analog_h == NULL) return false;
+	if (as5600_analog_h->is_initialized == false) return false;
+	if ((point_count != 0u) && (correction_counts == NULL)) return false;
+	if (point_count > AS5600_ANALOG_LINEARIZATION_MAX_POINTS) return false;
+	if ((point_count == 1u) || ((point_count & (uint8_t)(point_count - 1u)) != 0u)) return false;
 
-	/* Close the pending raw slot and append one angle sample into the current publish window. */
-	window_sample_index = s_as5600_analog_h->raw_sample_count;
-	s_as5600_analog_h->raw_conversion_pending = false;
-	s_as5600_analog_h->window_angle_samples_u16[window_sample_index] = current_sample_mechanical_angle_u16;
-	s_as5600_analog_h->raw_sample_count++;
+	/* Disable first: the interrupt path skips the table while it is rewritten. */
+	as5600_analog_h->linearization_point_count = 0u;
+	__DMB();
+	if (point_count == 0u) return true;
 
-	if (s_as5600_analog_h->raw_sample_count == 1u)
+	for (i = 0u; i < point_count; i++)
 	{
-		/* The first sample defines the wrap-safe reference for bootstrap averaging. */
-		s_as5600_analog_h->window_reference_mechanical_angle_u16 = current_sample_mechanical_angle_u16;
-		s_as5600_analog_h->window_delta_sum_counts = 0;
+		as5600_analog_h->linearization_counts[i] = correction_counts[i];
 	}
-	else
+	for (i = point_count; i > 1u; i = (uint8_t)(i >> 1))
 	{
-		/* Accumulate wrapped signed deltas to avoid 0/360 boundary errors in bootstrap average. */
-		s_as5600_analog_h->window_delta_sum_counts +=
-				as5600_analog_wrapped_delta_counts(current_sample_mechanical_angle_u16,
-												   s_as5600_analog_h->window_reference_mechanical_angle_u16);
+		shift--;
 	}
+	as5600_analog_h->linearization_shift = shift;
 
-	/* Publish one mechanical angle sample after the configured raw-sample count. */
-	if (s_as5600_analog_h->raw_sample_count >= s_as5600_analog_h->cfg->raw_samples_per_publish)
-	{
-		publish_raw_sample_count = s_as5600_analog_h->raw_sample_count;
-		has_last_published_angle = s_as5600_analog_h->has_published_angle;
+	/* Table and shift must be visible before the enabling count. */
+	__DMB();
+	as5600_analog_h->linearization_point_count = point_count;
 
-		if (has_last_published_angle == false)
-		{
-			/* Bootstrap publish uses wrap-safe window average because no last published anchor exists yet. */
-			published_mechanical_angle_u16 =
-					as5600_analog_finalize_window_average_angle_u16(
-							s_as5600_analog_h->window_reference_mechanical_angle_u16,
-							s_as5600_analog_h->window_delta_sum_counts,
-							publish_raw_sample_count);
-		}
-		else
-		{
-			/* Convert each window sample into one wrap-corrected signed delta from last published angle. */
-			retained_corrected_delta_sum_counts = 0;
-			retained_sample_count = 0u;
-			for (i = 0u; i < publish_raw_sample_count; i++)
-			{
-				corrected_deltas_counts[i] =
-						as5600_analog_compute_corrected_delta_from_last_published(
-								s_as5600_analog_h->window_angle_samples_u16[i],
-								s_as5600_analog_h->mechanical_angle_u16,
-								s_as5600_analog_h->cfg->wrap_correction_threshold_counts);
-
-				/* Retain only samples whose corrected delta is plausible for one publish interval. */
-				if (as5600_analog_abs_i32(corrected_deltas_counts[i]) <=
-					(int32_t)s_as5600_analog_h->cfg->max_plausible_delta_per_publish_counts)
-				{
-					retained_corrected_delta_sum_counts += corrected_deltas_counts[i];
-					retained_sample_count++;
-				}
-			}
-
-			if (retained_sample_count > 0u)
-			{
-				/* Reconstruct one published angle from the retained corrected-delta average. */
-				averaged_retained_corrected_delta_counts =
-						as5600_analog_divide_round_signed_i32(
-								retained_corrected_delta_sum_counts,
-								retained_sample_count);
-				reconstructed_angle_counts =
-						(int32_t)s_as5600_analog_h->mechanical_angle_u16 +
-						averaged_retained_corrected_delta_counts;
-				published_mechanical_angle_u16 =
-						as5600_analog_wrap_signed_angle_to_u16(reconstructed_angle_counts);
-			}
-			else
-			{
-				/* If no sample is plausible, publish one nearest real sample instead of holding last angle. */
-				nearest_sample_index =
-						as5600_analog_find_nearest_sample_index(
-								corrected_deltas_counts,
-								publish_raw_sample_count);
-				published_mechanical_angle_u16 =
-						s_as5600_analog_h->window_angle_samples_u16[nearest_sample_index];
-			}
-		}
+	return true;
+}
 
-		/* Publish one coherent angle sample for application consume. */
-		s_as5600_analog_h->mechanical_angle_u16 = published_mechanical_angle_u16;
-		s_as5600_analog_h->has_published_angle = true;
+uint16_t as5600_analog_linearize_angle_u16(const as5600_analog_handle_t *as5600_analog_h,
+										   uint16_t mechanical_angle_u16)
+{
+	uint8_t point_count = 0u;
 
-		/* Start a new raw window after publishing one angle sample. */
-		s_as5600_analog_h->raw_sample_count = 0u;
-		s_as5600_analog_h->window_reference_mechanical_angle_u16 = 0u;
-		s_as5600_analog_h->window_delta_sum_counts = 0;
-		for (i = 0u; i < AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES; i++)
-		{
-			s_as5600_analog_h->window_angle_samples_u16[i] = 0u;
-		}
-		s_as5600_analog_h->has_new_angle_sample = true;
-	}
+	if (as5600_analog_h == NULL) return mechanical_angle_u16;
+
+	point_count = as5600_analog_h->linearization_point_count;
+	if (point_count == 0u) return mechanical_angle_u16;
+
+	return as5600_analog_apply_linearization(as5600_analog_h, point_count, mechanical_angle_u16);
 }
@@ -0,0 +1,285 @@
+/**
+ * @file as5600_i2c.c
+ * @brief Sensor-specific AS5600 digital angle acquisition over I2C1 + DMA.
+ *
+ * This module schedules one non-blocking register read per sample slot,
+ * converts the 12-bit angle into full-turn uint16 units in the completion
+ * interrupt and publishes it with the as5600_analog double-buffer scheme.
+ */
+
+#include "drivers/as5600_i2c.h"
+#include <stddef.h>
+#include "drivers/systick.h"
+
+/**
+ * @brief Publish one angle sample into the inactive slot of the double buffer.
+ *
+ * @param as5600_i2c_h Pointer to AS5600 I2C handle.
+ * @param mechanical_angle_u16 Published mechanical angle.
+ * @param capture_timestamp_us Sample instant.
+ */
+static void as5600_i2c_publish_sample(as5600_i2c_handle_t *as5600_i2c_h,
+									  uint16_t mechanical_angle_u16,
+									  uint64_t capture_timestamp_us)
+{
+	uint32_t sequence = as5600_i2c_h->publish_sequence + 1u;
+	volatile as5600_analog_published_sample_t *slot = NULL;
+
+	/* Skip 0 (nothing published) and keep alternating slots across the wrap. */
+	if (sequence == 0u)
+	{
+		sequence = 2u;
+	}
+
+	slot = &as5600_i2c_h->published_slots[sequence & 1u];
+	slot->mechanical_angle_u16 = mechanical_angle_u16;
+	slot->capture_timestamp_us = capture_timestamp_us;
+	slot->sequence = sequence;
+	slot->sample_period_us = as5600_i2c_h->cfg->sample_period_us;
+	slot->dropped_publish_count = 0u;
+
+	/* Slot contents must be visible before the new sequence. */
+	__DMB();
+	as5600_i2c_h->publish_sequence = sequence;
+}
+
+/**
+ * @brief Copy the latest published slot without masking interrupts.
+ *
+ * @param as5600_i2c_h Pointer to AS5600 I2C handle.
+ * @param published_sample Pointer to output sample (dropped count not set).
+ * @return true if one consistent sample was copied, false otherwise.
+ */
+static bool as5600_i2c_read_published_slot(const as5600_i2c_handle_t *as5600_i2c_h,
+										   as5600_analog_published_sample_t *published_sample)
+{
+	for (uint32_t attempt = 0u; attempt < AS5600_ANALOG_PUBLISH_READ_RETRIES; attempt++)
+	{
+		uint32_t sequence = as5600_i2c_h->publish_sequence;
+		const volatile as5600_analog_published_sample_t *slot = NULL;
+
+		if (sequence == 0u) return false;
+
+		__DMB();
+		slot = &as5600_i2c_h->published_slots[sequence & 1u];
+		published_sample->mechanical_angle_u16 = slot->mechanical_angle_u16;
+		published_sample->capture_timestamp_us = slot->capture_timestamp_us;
+		published_sample->sequence = slot->sequence;
+		published_sample->sample_period_us = slot->sample_period_us;
+		__DMB();
+
+		/* One newer publish wrote the other slot; two or more may have rewritten this one. */
+		if ((uint32_t)(as5600_i2c_h->publish_sequence - sequence) < 2u)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief CONF write completion (interrupt context).
+ *
+ * @param callback_arg Pointer to AS5600 I2C handle.
+ * @param success true if the device acknowledged every byte.
+ */
+static void as5600_i2c_conf_complete_callback(void *callback_arg, bool success)
+{
+	as5600_i2c_handle_t *as5600_i2c_h = (as5600_i2c_handle_t *)callback_arg;
+
+	if (as5600_i2c_h == NULL) return;
+
+	as5600_i2c_h->transfer_pending = false;
+	if (success)
+	{
+		as5600_i2c_h->is_configured = true;
+	}
+	else
+	{
+		as5600_i2c_h->failed_transfer_count++;
+	}
+}
+
+/**
+ * @brief Angle read completion: convert and publish (interrupt context).
+ *
+ * @param callback_arg Pointer to AS5600 I2C handle.
+ * @param success true if the read completed.
+ */
+static void as5600_i2c_read_complete_callback(void *callback_arg, bool success)
+{
+	as5600_i2c_handle_t *as5600_i2c_h = (as5600_i2c_handle_t *)callback_arg;
+	uint64_t now_us = 0u;
+	uint16_t angle_12bit = 0u;
+	uint16_t mechanical_angle_u16 = 0u;
+
+	if ((as5600_i2c_h == NULL) || (as5600_i2c_h->cfg == NULL)) return;
+
+	as5600_i2c_h->transfer_pending = false;
+	if (success == false)
+	{
+		as5600_i2c_h->failed_transfer_count++;
+		return;
+	}
+
+	/* 12-bit angle, high byte first: 4096 counts per turn <=> 65536 << 4. */
+	angle_12bit = (uint16_t)((((uint16_t)as5600_i2c_h->rx_data[0] << 8) | as5600_i2c_h->rx_data[1]) &
+							 AS5600_I2C_ANGLE_MASK);
+	mechanical_angle_u16 = (uint16_t)(angle_12bit << 4);
+
+	/* Reverse sensor polarity with wrapped negation in full-turn units. */
+	if (as5600_i2c_h->cfg->mechanical_angle_direction == AS5600_ANALOG_DIRECTION_REVERSE)
+	{
+		mechanical_angle_u16 = (uint16_t)(0u - mechanical_angle_u16);
+	}
+
+	/* The register is read in the middle of the transaction. */
+	now_us = SYSTICK_GetTimeUs();
+	as5600_i2c_publish_sample(as5600_i2c_h,
+							  mechanical_angle_u16,
+							  as5600_i2c_h->transfer_start_time_us +
+							  ((now_us - as5600_i2c_h->transfer_start_time_us) / 2u));
+}
+
+bool as5600_i2c_init(as5600_i2c_handle_t *as5600_i2c_h,
+					 const as5600_i2c_cfg_t *as5600_i2c_cfg)
+{
+	if ((as5600_i2c_h == NULL) || (as5600_i2c_cfg == NULL)) return false;
+	if ((as5600_i2c_cfg->i2c_h == NULL) || (as5600_i2c_cfg->i2c_h->is_initialized == false)) return false;
+	if ((as5600_i2c_cfg->angle_register != AS5600_I2C_REGISTER_ANGLE) &&
+		(as5600_i2c_cfg->angle_register != AS5600_I2C_REGISTER_RAW_ANGLE)) return false;
+	if (as5600_i2c_cfg->sample_period_us == 0u) return false;
+
+	as5600_i2c_h->cfg = as5600_i2c_cfg;
+	as5600_i2c_h->rx_data[0] = 0u;
+	as5600_i2c_h->rx_data[1] = 0u;
+	as5600_i2c_h->conf_data[0] = (uint8_t)(as5600_i2c_cfg->conf >> 8);
+	as5600_i2c_h->conf_data[1] = (uint8_t)(as5600_i2c_cfg->conf & 0xFFu);
+	as5600_i2c_h->is_configured = false;
+	as5600_i2c_h->transfer_pending = false;
+	as5600_i2c_h->transfer_start_time_us = 0u;
+	as5600_i2c_h->next_sample_time_us = 0u;
+	as5600_i2c_h->failed_transfer_count = 0u;
+	as5600_i2c_h->timeout_count = 0u;
+	for (uint8_t i = 0u; i < 2u; i++)
+	{
+		as5600_i2c_h->published_slots[i].mechanical_angle_u16 = 0u;
+		as5600_i2c_h->published_slots[i].capture_timestamp_us = 0u;
+		as5600_i2c_h->published_slots[i].sequence = 0u;
+		as5600_i2c_h->published_slots[i].sample_period_us = 0u;
+		as5600_i2c_h->published_slots[i].dropped_publish_count = 0u;
+	}
+	as5600_i2c_h->publish_sequence = 0u;
+	as5600_i2c_h->consumed_sequence = 0u;
+	as5600_i2c_h->dropped_publish_count = 0u;
+	as5600_i2c_h->is_initialized = true;
+
+	return true;
+}
+
+bool as5600_i2c_service(as5600_i2c_handle_t *as5600_i2c_h,
+						uint64_t now_us)
+{
+	if ((as5600_i2c_h == NULL) || (as5600_i2c_h->cfg == NULL)) return false;
+	if (as5600_i2c_h->is_initialized == false) return false;
+
+	const as5600_i2c_cfg_t *cfg = as5600_i2c_h->cfg;
+
+	/* Anchor the sample grid on the first service call. */
+	if (as5600_i2c_h->next_sample_time_us == 0u)
+	{
+		as5600_i2c_h->next_sample_time_us = now_us + cfg->sample_phase_us;
+	}
+
+	/* A transaction older than one period is stuck: reset the peripheral and go on. */
+	if (as5600_i2c_h->transfer_pending)
+	{
+		if ((now_us - as5600_i2c_h->transfer_start_time_us) < cfg->sample_period_us) return true;
+
+		if (!i2c1_abort(cfg->i2c_h)) return false;
+		as5600_i2c_h->transfer_pending = false;
+		as5600_i2c_h->timeout_count++;
+	}
+
+	/* The volatile CONF register is written once before the first angle read. */
+	if (as5600_i2c_h->is_configured == false)
+	{
+		as5600_i2c_h->transfer_start_time_us = now_us;
+		as5600_i2c_h->transfer_pending = true;
+		if (!i2c1_start_write_register(cfg->i2c_h,
+									   AS5600_I2C_DEVICE_ADDRESS,
+									   AS5600_I2C_REGISTER_CONF,
+									   as5600_i2c_h->conf_data,
+									   2u,
+									   as5600_i2c_conf_complete_callback,
+									   as5600_i2c_h))
+		{
+			as5600_i2c_h->transfer_pending = false;
+		}
+		return true;
+	}
+
+	if (now_us < as5600_i2c_h->next_sample_time_us) return true;
+
+	/* Keep the grid: late service calls skip missed slots instead of bursting. */
+	do
+	{
+		as5600_i2c_h->next_sample_time_us += cfg->sample_period_us;
+	} while (as5600_i2c_h->next_sample_time_us <= now_us);
+
+	as5600_i2c_h->transfer_start_time_us = now_us;
+	as5600_i2c_h->transfer_pending = true;
+	if (!i2c1_start_read_register(cfg->i2c_h,
+								  AS5600_I2C_DEVICE_ADDRESS,
+								  cfg->angle_register,
+								  as5600_i2c_h->rx_data,
+								  2u,
+								  as5600_i2c_read_complete_callback,
+								  as5600_i2c_h))
+	{
+		/* Bus still finishing a STOP: this slot is skipped. */
+		as5600_i2c_h->transfer_pending = false;
+	}
+
+	return true;
+}
+
+bool as5600_i2c_consume_published_sample(as5600_i2c_handle_t *as5600_i2c_h,
+										 as5600_analog_published_sample_t *published_sample)
+{
+	as5600_analog_published_sample_t sample = {0};
+
+	if ((as5600_i2c_h == NULL) || (published_sample == NULL)) return false;
+	if (as5600_i2c_h->is_initialized == false) return false;
+
+	/* Take one lock-free snapshot; it is new only if the sequence moved since the last consume. */
+	if (!as5600_i2c_read_published_slot(as5600_i2c_h, &sample)) return false;
+	if (sample.sequence == as5600_i2c_h->consumed_sequence) return false;
+
+	/* Count publishes that were overwritten before this consume. */
+	if (as5600_i2c_h->consumed_sequence != 0u)
+	{
+		as5600_i2c_h->dropped_publish_count +=
+				(uint32_t)(sample.sequence - as5600_i2c_h->consumed_sequence - 1u);
+	}
+	as5600_i2c_h->consumed_sequence = sample.sequence;
+
+	sample.dropped_publish_count = as5600_i2c_h->dropped_publish_count;
+	*published_sample = sample;
+
+	return true;
+}
+
+bool as5600_i2c_get_latest_published_sample(const as5600_i2c_handle_t *as5600_i2c_h,
+											as5600_analog_published_sample_t *published_sample)
+{
+	if ((as5600_i2c_h == NULL) || (published_sample == NULL)) return false;
+	if (as5600_i2c_h->is_initialized == false) return false;
+
+	/* Snapshot only; the main-loop consume state is not changed here. */
+	if (!as5600_i2c_read_published_slot(as5600_i2c_h, published_sample)) return false;
+	published_sample->dropped_publish_count = as5600_i2c_h->dropped_publish_count;
+
+	return true;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file calibration_store.c
+ * @brief Wear-levelled calibration record log implementation.
+ *
+ *  Notes:
+ *  - CRC-32 is the reflected 0xEDB88320 polynomial (zlib/IEEE), so a host
+ *    dump of the sector can be checked with standard tools.
+ *  - records are written in one program pass; the magic word is the first
+ *    word programmed, a partly written slot therefore fails the CRC check.
+ */
+
+#include "drivers/calibration_store.h"
+#include <string.h>
+#include "drivers/flash.h"
+
+#define CALIBRATION_STORE_ERASED_WORD     0xFFFFFFFFu
+
+/**
+ * @brief Compute the CRC-32 (IEEE, reflected) of one byte block.
+ *
+ * @param data Input bytes.
+ * @param length Number of bytes.
+ * @return CRC-32 value.
+ */
+static uint32_t calibration_store_crc32(const uint8_t *data, size_t length)
+{
+	uint32_t crc = 0xFFFFFFFFu;
+
+	for (size_t i = 0u; i < length; i++)
+	{
+		crc ^= (uint32_t)data[i];
+		for (uint8_t bit = 0u; bit < 8u; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+		}
+	}
+
+	return ~crc;
+}
+
+/**
+ * @brief Return the record mapped at one slot.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ * @param slot Slot index.
+ * @return Pointer into FLASH.
+ */
+static const calibration_record_t *calibration_store_slot(const calibration_store_handle_t *calibration_store_h,
+														  uint32_t slot)
+{
+	return (const calibration_record_t *)(calibration_store_h->cfg->base_address + (slot * CALIBRATION_STORE_SLOT_SIZE));
+}
+
+/**
+ * @brief Check magic, version, size and CRC of one record.
+ *
+ * @param record Record to check.
+ * @return true if valid, false otherwise.
+ */
+static bool calibration_store_record_is_valid(const calibration_record_t *record)
+{
+	if (record->magic != CALIBRATION_STORE_MAGIC) return false;
+	if (record->version != CALIBRATION_STORE_VERSION) return false;
+	if (record->data_size != (uint16_t)sizeof(calibration_data_t)) return false;
+
+	return (record->crc32 == calibration_store_crc32((const uint8_t *)record, offsetof(calibration_record_t, crc32)));
+}
+
+/**
+ * @brief Rebuild the slot bookkeeping from the sector content.
+ *
+ * @param calibration_store_h Pointer to calibration store handle.
+ */
+static void calibration_store_scan(calibration_store_handle_t *calibration_store_h)
+{
+	calibration_store_h->has_record = false;
+	calibration_store_h->latest_sequence = 0u;
+	calibration_store_h->next_slot = calibration_store_h->slot_count;
+
+	for (uint32_t slot = 0u; slot < calibration_store_h->slot_count; slot++)
+	{
+		const calibration_record_t *record = calibration_store_slot(calibration_store_h, slot);
+
+		if (record->magic == CALIBRATION_STORE_ERASED_WORD)
+		{
+			/* Append-only: the first blank slot ends the used part. */
+			calibration_store_h->next_slot = slot;
+			break;
+		}
+		if (!calibration_store_record_is_valid(record)) continue;
+
+		if ((calibration_store_h->has_record == false) || (record->sequence > calibration_store_h->latest_sequence))
+		{
+			calibration_store_h->latest_slot = slot;
+			calibration_store_h->latest_sequence = record->sequence;
+			calibration_store_h->has_record = true;
+		}
+	}
+}
+
+bool calibration_store_init(calibration_store_handle_t *calibration_store_h,
+							const calibration_store_cfg_t *calibration_store_cfg)
+{
+	if ((calibration_store_h == NULL) || (calibration_store_cfg == NULL)) return false;
+	if ((calibration_store_cfg->base_address & (CALIBRATION_STORE_SLOT_SIZE - 1u)) != 0u) return false;
+	if (calibration_store_cfg->size_bytes < CALIBRATION_STORE_SLOT_SIZE) return false;
+	if (calibration_store_cfg->sector >= FLASH_SECTOR_COUNT) return false;
+
+	calibration_store_h->cfg = calibration_store_cfg;
+	calibration_store_h->slot_count = calibration_store_cfg->size_bytes / CALIBRATION_STORE_SLOT_SIZE;
+	calibration_store_scan(calibration_store_h);
+	calibration_store_h->is_initialized = true;
+
+	return true;
+}
+
+bool calibration_store_load(const calibration_store_handle_t *calibration_store_h, calibration_data_t *data)
+{
+	if ((calibration_store_h == NULL) || (data == NULL)) return false;
+	if ((calibration_store_h->is_initialized == false) || (calibration_store_h->has_record == false)) return false;
+
+	*data = calibration_store_slot(calibration_store_h, calibration_store_h->latest_slot)->data;
+
+	return true;
+}
+
+bool calibration_store_save(calibration_store_handle_t *calibration_store_h, const calibration_data_t *data)
+{
+	if ((calibration_store_h == NULL) || (data == NULL)) return false;
+	if (calibration_store_h->is_initialized == false) return false;
+
+	/* Unchanged calibration: no FLASH wear. */
+	if ((calibration_store_h->has_record) &&
+		(memcmp(&calibration_store_slot(calibration_store_h, calibration_store_h->latest_slot)->data,
+				data, sizeof(*data)) == 0))
+	{
+		return true;
+	}
+
+	if (calibration_store_h->next_slot >= calibration_store_h->slot_count)
+	{
+		if (!calibration_store_erase(calibration_store_h)) return false;
+	}
+
+	calibration_record_t record;
+	uint32_t record_words[sizeof(calibration_record_t) / sizeof(uint32_t)];
+	uint32_t slot = calibration_store_h->next_slot;
+
+	memset(&record, 0, sizeof(record));
+	record.magic = CALIBRATION_STORE_MAGIC;
+	record.version = CALIBRATION_STORE_VERSION;
+	record.data_size = (uint16_t)sizeof(calibration_data_t);
+	record.sequence = calibration_store_h->has_record ? (calibration_store_h->latest_sequence + 1u) : 1u;
+	record.data = *data;
+	record.crc32 = calibration_store_crc32((const uint8_t *)&record, offsetof(calibration_record_t, crc32));
+	memcpy(record_words, &record, sizeof(record));
+
+	bool programmed = flash_program_words(calibration_store_h->cfg->base_address + (slot * CALIBRATION_STORE_SLOT_SIZE),
+										  record_words,
+										  sizeof(record_words) / sizeof(record_words[0]));
+
+	/* The slot is consumed even when programming failed half-way. */
+	calibration_store_h->next_slot = slot + 1u;
+	if ((!programmed) || (!calibration_store_record_is_valid(calibration_store_slot(calibration_store_h, slot))))
+	{
+		return false;
+	}
+
+	calibration_store_h->latest_slot = slot;
+	calibration_store_h->latest_sequence = record.sequence;
+	calibration_store_h->has_record = true;
+
+	return true;
+}
+
+uint32_t calibration_store_get_free_slot_count(const calibration_store_handle_t *calibration_store_h)
+{
+	if ((calibration_store_h == NULL) || (calibration_store_h->is_initialized == false)) return 0u;
+
+	return calibration_store_h->slot_count - calibration_store_h->next_slot;
+}
+
+bool calibration_store_reserve(calibration_store_handle_t *calibration_store_h, uint32_t min_free_slots)
+{
+	if ((calibration_store_h == NULL) || (calibration_store_h->is_initialized == false)) return false;
+	if (min_free_slots >= calibration_store_h->slot_count) return false;
+
+	if (calibration_store_get_free_slot_count(calibration_store_h) >= min_free_slots) return true;
+
+	calibration_data_t data;
+	bool has_record = calibration_store_load(calibration_store_h, &data);
+
+	if (!calibration_store_erase(calibration_store_h)) return false;
+	if (has_record && !calibration_store_save(calibration_store_h, &data)) return false;
+
+	return (calibration_store_get_free_slot_count(calibration_store_h) >= min_free_slots);
+}
+
+bool calibration_store_erase(calibration_store_handle_t *calibration_store_h)
+{
+	if ((calibration_store_h == NULL) || (calibration_store_h->is_initialized == false)) return false;
+
+	bool erased = flash_erase_sector(calibration_store_h->cfg->sector);
+
+	calibration_store_scan(calibration_store_h);
+
+	return erased;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file clock.c
+ * @brief System clock-tree driver implementation (STM32F446, CMSIS only).
+ *
+ *  Sequence (RM0390 6.3, 5.1.4, 3.4):
+ *  oscillator -> voltage scale -> PLL -> over-drive -> FLASH latency/ART -> bus prescalers -> SYSCLK switch.
+ *  FLASH latency is raised before the switch, which is the safe order when starting from reset (HSI 16 MHz).
+ */
+
+#include "drivers/clock.h"
+
+#define CLOCK_READY_TIMEOUT		100000u		// polling iterations per ready flag
+
+/* Wait until (reg & mask) == expected, false on timeout */
+static bool clock_wait(volatile uint32_t *reg, uint32_t mask, uint32_t expected)
+{
+	uint32_t timeout = CLOCK_READY_TIMEOUT;
+
+	while(((*reg) & mask) != expected)
+	{
+		if(timeout-- == 0u) return false;
+	}
+	return true;
+}
+
+/* Encode AHB divider into HPRE, 0xFF if invalid */
+static uint32_t clock_hpre_bits(uint16_t div)
+{
+	switch(div)
+	{
+		case 1u:   return 0x0u;
+		case 2u:   return 0x8u;
+		case 4u:   return 0x9u;
+		case 8u:   return 0xAu;
+		case 16u:  return 0xBu;
+		case 64u:  return 0xCu;
+		case 128u: return 0xDu;
+		case 256u: return 0xEu;
+		case 512u: return 0xFu;
+		default:   return 0xFFu;
+	}
+}
+
+/* Encode APB divider into PPREx, 0xFF if invalid */
+static uint32_t clock_ppre_bits(uint8_t div)
+{
+	switch(div)
+	{
+		case 1u:  return 0x0u;
+		case 2u:  return 0x4u;
+		case 4u:  return 0x5u;
+		case 8u:  return 0x6u;
+		case 16u: return 0x7u;
+		default:  return 0xFFu;
+	}
+}
+
+/* Validate PLL factors and compute SYSCLK, 0 if invalid */
+static uint32_t clock_compute_sysclk(const clock_cfg_t *cfg)
+{
+	uint32_t source_hz = (cfg->source == CLOCK_SOURCE_HSI) ? CLOCK_HSI_HZ : cfg->hse_hz;
+	if(source_hz == 0u) return 0u;
+	if(!cfg->use_pll) return source_hz;
+
+	if((cfg->pll_m < 2u) || (cfg->pll_m > 63u)) return 0u;
+	if((cfg->pll_n < 50u) || (cfg->pll_n > 432u)) return 0u;
+	if((cfg->pll_p < 2u) || (cfg->pll_p > 8u) || ((cfg->pll_p & 1u) != 0u)) return 0u;
+	if((cfg->pll_q < 2u) || (cfg->pll_q > 15u)) return 0u;
+
+	uint32_t vco_in_hz = source_hz / cfg->pll_m;
+	if((vco_in_hz < 1000000u) || (vco_in_hz > 2000000u)) return 0u;
+
+	uint32_t vco_out_hz = vco_in_hz * cfg->pll_n;
+	if((vco_out_hz < 100000000u) || (vco_out_hz > 432000000u)) return 0u;
+
+	return vco_out_hz / cfg->pll_p;
+}
+
+bool clock_init(clock_handle_t *clock_h, const clock_cfg_t *clock_cfg)
+{
+	// Validate input pointers
+	if((clock_h == NULL) || (clock_cfg == NULL)) return false;
+
+	uint32_t hpre = clock_hpre_bits(clock_cfg->ahb_div);
+	uint32_t ppre1 = clock_ppre_bits(clock_cfg->apb1_div);
+	uint32_t ppre2 = clock_ppre_bits(clock_cfg->apb2_div);
+	if((hpre == 0xFFu) || (ppre1 == 0xFFu) || (ppre2 == 0xFFu)) return false;
+
+	if((clock_cfg->voltage_scale < 1u) || (clock_cfg->voltage_scale > 3u)) return false;
+	if(clock_cfg->flash_latency > 15u) return false;
+
+	// Check derived clocks against device limits
+	uint32_t sysclk_hz = clock_compute_sysclk(clock_cfg);
+	if((sysclk_hz == 0u) || (sysclk_hz > CLOCK_SYSCLK_MAX_HZ)) return false;
+	uint32_t hclk_hz = sysclk_hz / clock_cfg->ahb_div;
+	uint32_t pclk1_hz = hclk_hz / clock_cfg->apb1_div;
+	uint32_t pclk2_hz = hclk_hz / clock_cfg->apb2_div;
+	if((pclk1_hz > CLOCK_APB1_MAX_HZ) || (pclk2_hz > CLOCK_APB2_MAX_HZ)) return false;
+
+	/* Oscillator */
+	if(clock_cfg->source == CLOCK_SOURCE_HSI)
+	{
+		RCC->CR |= RCC_CR_HSION;
+		if(!clock_wait(&RCC->CR, RCC_CR_HSIRDY, RCC_CR_HSIRDY)) return false;
+	}
+	else
+	{
+		if(clock_cfg->source == CLOCK_SOURCE_HSE_BYPASS){
+			RCC->CR |= RCC_CR_HSEBYP;
+		}
+		else {
+			RCC->CR &= ~RCC_CR_HSEBYP;
+		}
+		RCC->CR |= RCC_CR_HSEON;
+		if(!clock_wait(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY)) return false;
+	}
+
+	/* Main PLL off: SYSCLK must not run from it, VOS can only change while it is off */
+	if((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL) return false;
+	RCC->CR &= ~RCC_CR_PLLON;
+	if(!clock_wait(&RCC->CR, RCC_CR_PLLRDY, 0u)) return false;
+
+	/* Regulator voltage scale (VOS: 01 = scale 3, 10 = scale 2, 11 = scale 1) */
+	RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+	(void)RCC->APB1ENR;
+	PWR->CR &= ~PWR_CR_VOS;
+	PWR->CR |= ((uint32_t)(4u - clock_cfg->voltage_scale) << PWR_CR_VOS_Pos);
+
+	/* Main PLL */
+	if(clock_cfg->use_pll)
+	{
+		// keep PLLR, rewrite M/N/P/Q and source
+		uint32_t pllcfgr = RCC->PLLCFGR;
+		pllcfgr &= ~(RCC_PLLCFGR_PLLM | RCC_PLLCFGR_PLLN | RCC_PLLCFGR_PLLP | RCC_PLLCFGR_PLLQ | RCC_PLLCFGR_PLLSRC);
+		pllcfgr |= ((uint32_t)clock_cfg->pll_m << RCC_PLLCFGR_PLLM_Pos);
+		pllcfgr |= ((uint32_t)clock_cfg->pll_n << RCC_PLLCFGR_PLLN_Pos);
+		pllcfgr |= ((uint32_t)((clock_cfg->pll_p >> 1u) - 1u) << RCC_PLLCFGR_PLLP_Pos);
+		pllcfgr |= ((uint32_t)clock_cfg->pll_q << RCC_PLLCFGR_PLLQ_Pos);
+		if(clock_cfg->source != CLOCK_SOURCE_HSI) pllcfgr |= RCC_PLLCFGR_PLLSRC_HSE;
+		RCC->PLLCFGR = pllcfgr;
+
+		RCC->CR |= RCC_CR_PLLON;
+		if(!clock_wait(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY)) return false;
+	}
+
+	/* Over-drive: enable after PLL lock, then switch the regulator mode */
+	if(clock_cfg->overdrive)
+	{
+		PWR->CR |= PWR_CR_ODEN;
+		if(!clock_wait(&PWR->CSR, PWR_CSR_ODRDY, PWR_CSR_ODRDY)) return false;
+		PWR->CR |= PWR_CR_ODSWEN;
+		if(!clock_wait(&PWR->CSR, PWR_CSR_ODSWRDY, PWR_CSR_ODSWRDY)) return false;
+	}
+
+	/* FLASH wait states and ART accelerator (caches are reset while disabled) */
+	FLASH->ACR &= ~(FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+	FLASH->ACR |= (FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+	FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+	FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | ((uint32_t)clock_cfg->flash_latency << FLASH_ACR_LATENCY_Pos);
+	if((FLASH->ACR & FLASH_ACR_LATENCY) != ((uint32_t)clock_cfg->flash_latency << FLASH_ACR_LATENCY_Pos)) return false;
+	if(clock_cfg->art_enable)
+	{
+		FLASH->ACR |= (FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+	}
+
+	/* Bus prescalers before the switch so APB limits hold from the first cycle */
+	uint32_t cfgr = RCC->CFGR;
+	cfgr &= ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2);
+	cfgr |= (hpre << RCC_CFGR_HPRE_Pos) | (ppre1 << RCC_CFGR_PPRE1_Pos) | (ppre2 << RCC_CFGR_PPRE2_Pos);
+	RCC->CFGR = cfgr;
+
+	/* SYSCLK switch */
+	uint32_t sw = RCC_CFGR_SW_HSI;
+	uint32_t sws = RCC_CFGR_SWS_HSI;
+	if(clock_cfg->use_pll){
+		sw = RCC_CFGR_SW_PLL;
+		sws = RCC_CFGR_SWS_PLL;
+	}
+	else if(clock_cfg->source != CLOCK_SOURCE_HSI){
+		sw = RCC_CFGR_SW_HSE;
+		sws = RCC_CFGR_SWS_HSE;
+	}
+	RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | sw;
+	if(!clock_wait(&RCC->CFGR, RCC_CFGR_SWS, sws)) return false;
+
+	// store derived clocks
+	clock_h->cfg = clock_cfg;
+	clock_h->sysclk_hz = sysclk_hz;
+	clock_h->hclk_hz = hclk_hz;
+	clock_h->pclk1_hz = pclk1_hz;
+	clock_h->pclk2_hz = pclk2_hz;
+	clock_h->tim_apb1_hz = (clock_cfg->apb1_div == 1u) ? pclk1_hz : (2u * pclk1_hz);
+	clock_h->tim_apb2_hz = (clock_cfg->apb2_div == 1u) ? pclk2_hz : (2u * pclk2_hz);
+	clock_h->is_initialized = true;
+
+	return true;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file command.c
+ * @brief Binary command frame receiver implementation.
+ *
+ * Chunked reads from the USART2 RX ring, byte-wise framing with length and
+ * CRC-16/CCITT-FALSE checks (shared with telemetry.c) and resynchronization
+ * on the next sync byte after a rejected candidate.
+ */
+
+#include "drivers/command.h"
+#include "drivers/telemetry.h"
+#include <string.h>
+
+#define COMMAND_FRAME_LENGTH_OFFSET     3u
+
+/**
+ * @brief Drop leading candidate bytes, then skip to the next sync byte.
+ *
+ * @param command_h Pointer to command handle.
+ * @param count Number of bytes to drop (<= candidate length).
+ */
+static void command_discard(command_handle_t *command_h, uint16_t count)
+{
+	uint16_t start = count;
+
+	while ((start < command_h->length) && (command_h->bytes[start] != COMMAND_FRAME_SYNC))
+	{
+		start++;
+	}
+
+	command_h->length = (uint16_t)(command_h->length - start);
+	memmove(command_h->bytes, &command_h->bytes[start], command_h->length);
+}
+
+/**
+ * @brief Check the buffered candidate, reject bad ones and extract one complete frame.
+ *
+ * @param command_h Pointer to command handle.
+ * @param frame Output frame.
+ * @return true if one valid frame was extracted, false if more bytes are needed.
+ */
+static bool command_check_candidate(command_handle_t *command_h, command_frame_t *frame)
+{
+	while (command_h->length >= COMMAND_FRAME_HEADER_SIZE)
+	{
+		uint8_t payload_length = command_h->bytes[COMMAND_FRAME_LENGTH_OFFSET];
+		uint16_t frame_size = (uint16_t)(COMMAND_FRAME_HEADER_SIZE + payload_length + COMMAND_FRAME_CRC_SIZE);
+
+		if (payload_length > COMMAND_FRAME_MAX_PAYLOAD)
+		{
+			command_h->length_error_cnt++;
+			command_discard(command_h, 1u);
+			continue;
+		}
+		if (command_h->length < frame_size) return false;
+
+		uint16_t crc = (uint16_t)command_h->bytes[frame_size - 2u] |
+					   (uint16_t)((uint16_t)command_h->bytes[frame_size - 1u] << 8);
+		if (telemetry_crc16(&command_h->bytes[1], (size_t)frame_size - 3u) != crc)
+		{
+			/* Sync byte inside noise or payload data: shift by one byte. */
+			command_h->crc_error_cnt++;
+			command_discard(command_h, 1u);
+			continue;
+		}
+
+		frame->type = command_h->bytes[1];
+		frame->sequence = command_h->bytes[2];
+		frame->payload_length = payload_length;
+		memcpy(frame->payload, &command_h->bytes[COMMAND_FRAME_HEADER_SIZE], payload_length);
+		command_h->frames_received++;
+		command_discard(command_h, frame_size);
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Read one little-endian payload field.
+ *
+ * @param frame Pointer to received frame.
+ * @param offset Payload byte offset.
+ * @param size Field size in bytes (1..4).
+ * @param value Output value bits.
+ * @return true if the field lies inside the payload, false otherwise.
+ */
+static bool command_frame_get_le(const command_frame_t *frame, uint8_t offset, uint8_t size, uint32_t *value)
+{
+	uint32_t bits = 0u;
+
+	if ((frame == NULL) || (value == NULL)) return false;
+	if (((uint16_t)offset + size) > frame->payload_length) return false;
+
+	for (uint8_t i = 0u; i < size; i++)
+	{
+		bits |= (uint32_t)frame->payload[offset + i] << (8u * i);
+	}
+	*value = bits;
+
+	return true;
+}
+
+bool command_init(command_handle_t *command_h, const command_cfg_t *command_cfg)
+{
+	if ((command_h == NULL) || (command_cfg == NULL)) return false;
+	if (command_cfg->usart_h == NULL) return false;
+
+	command_h->cfg = command_cfg;
+	command_h->length = 0u;
+	command_h->chunk_length = 0u;
+	command_h->chunk_index = 0u;
+	command_h->frames_received = 0u;
+	command_h->crc_error_cnt = 0u;
+	command_h->length_error_cnt = 0u;
+	command_h->is_initialized = true;
+
+	return true;
+}
+
+bool command_poll(command_handle_t *command_h, command_frame_t *frame)
+{
+	if ((command_h == NULL) || (frame == NULL)) return false;
+	if (command_h->is_initialized == false) return false;
+
+	while (1)
+	{
+		/* A candidate can be complete already: bytes left over after a rejected or extracted frame. */
+		if (command_check_candidate(command_h, frame)) return true;
+
+		if (command_h->chunk_index >= command_h->chunk_length)
+		{
+			command_h->chunk_length = (uint8_t)usart2_read(command_h->cfg->usart_h,
+														   command_h->chunk,
+														   COMMAND_RX_CHUNK_SIZE);
+			command_h->chunk_index = 0u;
+			if (command_h->chunk_length == 0u) return false;
+		}
+
+		uint8_t byte = command_h->chunk[command_h->chunk_index++];
+
+		if ((command_h->length == 0u) && (byte != COMMAND_FRAME_SYNC)) continue;
+		command_h->bytes[command_h->length++] = byte;
+	}
+}
+
+bool command_frame_get_u8(const command_frame_t *frame, uint8_t offset, uint8_t *value)
+{
+	uint32_t bits = 0u;
+
+	if ((value == NULL) || (!command_frame_get_le(frame, offset, 1u, &bits))) return false;
+	*value = (uint8_t)bits;
+	return true;
+}
+
+bool command_frame_get_u16(const command_frame_t *frame, uint8_t offset, uint16_t *value)
+{
+	uint32_t bits = 0u;
+
+	if ((value == NULL) || (!command_frame_get_le(frame, offset, 2u, &bits))) return false;
+	*value = (uint16_t)bits;
+	return true;
+}
+
+bool command_frame_get_u32(const command_frame_t *frame, uint8_t offset, uint32_t *value)
+{
+	return command_frame_get_le(frame, offset, 4u, value);
+}
+
+bool command_frame_get_i32(const command_frame_t *frame, uint8_t offset, int32_t *value)
+{
+	uint32_t bits = 0u;
+
+	if ((value == NULL) || (!command_frame_get_le(frame, offset, 4u, &bits))) return false;
+	*value = (int32_t)bits;
+	return true;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file dma.c
+ * @brief DMA stream driver implementation (STM32F4, CMSIS only).
+ *
+ *  Notes:
+ *  - Direct mode only (FIFO disabled), single-buffer, no burst.
+ *  - FIFO and direct-mode error flags are cleared but not reported.
+ */
+
+#include "drivers/dma.h"
+
+#define DMA_FLAG_FEIF		(1U << 0)
+#define DMA_FLAG_DMEIF		(1U << 2)
+#define DMA_FLAG_TEIF		(1U << 3)
+#define DMA_FLAG_HTIF		(1U << 4)
+#define DMA_FLAG_TCIF		(1U << 5)
+#define DMA_FLAG_ALL		(DMA_FLAG_FEIF | DMA_FLAG_DMEIF | DMA_FLAG_TEIF | DMA_FLAG_HTIF | DMA_FLAG_TCIF)
+
+/* Bit offset of one stream flag group inside LISR/HISR (streams 0/4, 1/5, 2/6, 3/7) */
+static const uint8_t dma_flag_shift[4] = {0U, 6U, 16U, 22U};
+
+/* Read the flag group of the stream, aligned to bit 0 */
+static uint32_t dma_read_flags(const dma_cfg_t *cfg)
+{
+	uint32_t isr = (cfg->stream_index < 4U) ? cfg->inst->LISR : cfg->inst->HISR;
+	return (isr >> dma_flag_shift[cfg->stream_index & 3U]) & DMA_FLAG_ALL;
+}
+
+/* Clear the given flags of the stream (write 1 to LIFCR/HIFCR) */
+static void dma_clear_flags(const dma_cfg_t *cfg, uint32_t flags)
+{
+	uint32_t mask = (flags & DMA_FLAG_ALL) << dma_flag_shift[cfg->stream_index & 3U];
+
+	if (cfg->stream_index < 4U){
+		cfg->inst->LIFCR = mask;
+	}
+	else {
+		cfg->inst->HIFCR = mask;
+	}
+}
+
+/* Configure DMA stream registers */
+bool dma_init(dma_handle_t *dma_h, const dma_cfg_t *dma_cfg)
+{
+	// Validate input pointers
+	if((dma_h == NULL) || (dma_cfg == NULL)) return false;
+
+	if((dma_cfg->inst == NULL) || (dma_cfg->stream == NULL)) return false;
+
+	if(dma_cfg->stream_index > DMA_STREAM_INDEX_MAX) return false;
+
+	if(dma_cfg->channel > DMA_CHANNEL_MAX) return false;
+
+	if(dma_cfg->stream_priority > 3U) return false;
+
+	// Enable clock source for DMA
+	if(dma_cfg->inst == DMA1){
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+	}
+	else if(dma_cfg->inst == DMA2){
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+	}
+	else {
+		return false;
+	}
+
+	// Disable stream before configuration and wait until it is released
+	dma_cfg->stream->CR &= ~DMA_SxCR_EN;
+	while(dma_cfg->stream->CR & DMA_SxCR_EN) {}
+	dma_clear_flags(dma_cfg, DMA_FLAG_ALL);
+
+	// channel, priority, data size, direction and addressing mode
+	uint32_t cr = 0U;
+	cr |= ((uint32_t)dma_cfg->channel << DMA_SxCR_CHSEL_Pos);
+	cr |= ((uint32_t)dma_cfg->stream_priority << DMA_SxCR_PL_Pos);
+	cr |= ((uint32_t)dma_cfg->data_size << DMA_SxCR_MSIZE_Pos);
+	cr |= ((uint32_t)dma_cfg->data_size << DMA_SxCR_PSIZE_Pos);
+	cr |= ((uint32_t)dma_cfg->direction << DMA_SxCR_DIR_Pos);
+	if(dma_cfg->memory_increment) cr |= DMA_SxCR_MINC;
+	if(dma_cfg->circular) cr |= DMA_SxCR_CIRC;
+	cr |= DMA_SxCR_TEIE;									// transfer errors are always counted
+	dma_cfg->stream->CR = cr;
+
+	// Direct mode (FIFO disabled)
+	dma_cfg->stream->FCR = 0U;
+
+	// Set interrupt priority for NVIC
+	NVIC_SetPriority(dma_cfg->irqn, dma_cfg->irq_priority);
+	NVIC_ClearPendingIRQ(dma_cfg->irqn);
+	NVIC_EnableIRQ(dma_cfg->irqn);
+
+	// initialize handle states
+	dma_h->cfg = dma_cfg;
+	dma_h->transfer_error_cnt = 0U;
+	dma_h->is_initialized = true;
+
+	return true;
+}
+
+bool dma_register_callbacks(dma_handle_t *dma_h,
+							dma_callback_t half_transfer_callbk,
+							dma_callback_t transfer_complete_callbk,
+							void *callbk_arg)
+{
+	if(dma_h == NULL) return false;
+
+	dma_h->half_transfer_callback = half_transfer_callbk;
+	dma_h->transfer_complete_callback = transfer_complete_callbk;
+	dma_h->callback_arg = callbk_arg;
+
+	return true;
+}
+
+bool dma_register_error_callback(dma_handle_t *dma_h, dma_callback_t transfer_error_callbk)
+{
+	if(dma_h == NULL) return false;
+
+	dma_h->transfer_error_callback = transfer_error_callbk;
+
+	return true;
+}
+
+/* Program addresses/count and enable the stream */
+bool dma_start(dma_handle_t *dma_h, uint32_t periph_addr, const volatile void *mem_addr, uint16_t count)
+{
+	if((dma_h == NULL) || (dma_h->cfg == NULL) || (dma_h->is_initialized == false)) return false;
+	if((mem_addr == NULL) || (count == 0U)) return false;
+
+	DMA_Stream_TypeDef *stream = dma_h->cfg->stream;
+	if(stream->CR & DMA_SxCR_EN) return false;				// previous transfer still running
+
+	dma_clear_flags(dma_h->cfg, DMA_FLAG_ALL);
+
+	stream->PAR = periph_addr;
+	stream->M0AR = (uint32_t)mem_addr;
+	stream->NDTR = count;
+
+	// Enable only the interrupts with a registered callback
+	stream->CR &= ~(DMA_SxCR_HTIE | DMA_SxCR_TCIE);
+	if(dma_h->half_transfer_callback != NULL) stream->CR |= DMA_SxCR_HTIE;
+	if(dma_h->transfer_complete_callback != NULL) stream->CR |= DMA_SxCR_TCIE;
+
+	stream->CR |= DMA_SxCR_EN;
+
+	return true;
+}
+
+bool dma_stop(dma_handle_t *dma_h)
+{
+	if((dma_h == NULL) || (dma_h->cfg == NULL) || (dma_h->is_initialized == false)) return false;
+
+	dma_h->cfg->stream->CR &= ~DMA_SxCR_EN;
+	while(dma_h->cfg->stream->CR & DMA_SxCR_EN) {}
+	dma_clear_flags(dma_h->cfg, DMA_FLAG_ALL);
+
+	return true;
+}
+
+bool dma_is_busy(const dma_handle_t *dma_h)
+{
+	if((dma_h == NULL) || (dma_h->cfg == NULL)) return false;
+
+	return ((dma_h->cfg->stream->CR & DMA_SxCR_EN) != 0U);
+}
+
+/* callback dispatch for HT/TC/TE, TE is always counted */
+void dma_irq_handler(dma_handle_t *dma_h)
+{
+	if((dma_h == NULL) || (dma_h->cfg == NULL)) return; // Do nothing if pointers invalid
+
+	uint32_t flags = dma_read_flags(dma_h->cfg);
+	dma_clear_flags(dma_h->cfg, flags);
+
+	if(flags & DMA_FLAG_TEIF){
+		dma_h->transfer_error_cnt++;
+		// the stream is already disabled: no TC follows, the owner must release the transfer
+		if(dma_h->transfer_error_callback != NULL){
+			dma_h->transfer_error_callback(dma_h->callback_arg);
+			return;
+		}
+	}
+
+	if((flags & DMA_FLAG_HTIF) && (dma_h->half_transfer_callback != NULL)){
+		dma_h->half_transfer_callback(dma_h->callback_arg);
+	}
+
+	if((flags & DMA_FLAG_TCIF) && (dma_h->transfer_complete_callback != NULL)){
+		dma_h->transfer_complete_callback(dma_h->callback_arg);
+	}
+}
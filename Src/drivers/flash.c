@@ -0,0 +1,118 @@
+/**
+ * @file flash.c
+ * @brief Minimal internal FLASH erase/program driver implementation (STM32F446, CMSIS only).
+ *
+ *  Sequence (RM0390 3.6): wait BSY -> unlock KEYR -> clear error flags ->
+ *  set PSIZE and PG / SER + SNB -> write / STRT -> wait BSY -> check flags -> lock.
+ */
+
+#include "drivers/flash.h"
+
+#define FLASH_DRIVER_KEY1           0x45670123u
+#define FLASH_DRIVER_KEY2           0xCDEF89ABu
+#define FLASH_DRIVER_PSIZE_X32      FLASH_CR_PSIZE_1
+#define FLASH_DRIVER_ERROR_FLAGS    (FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+									 FLASH_SR_PGPERR | FLASH_SR_PGSERR | FLASH_SR_RDERR)
+
+/**
+ * @brief Wait for the end of the ongoing operation.
+ *
+ */
+static void flash_wait_idle(void)
+{
+	while ((FLASH->SR & FLASH_SR_BSY) != 0u) {}
+}
+
+/**
+ * @brief Unlock the control register and clear stale flags.
+ *
+ * @return true if unlocked, false otherwise.
+ */
+static bool flash_unlock(void)
+{
+	flash_wait_idle();
+	if ((FLASH->CR & FLASH_CR_LOCK) != 0u)
+	{
+		FLASH->KEYR = FLASH_DRIVER_KEY1;
+		FLASH->KEYR = FLASH_DRIVER_KEY2;
+	}
+	if ((FLASH->CR & FLASH_CR_LOCK) != 0u) return false;
+
+	/* Error and EOP flags are cleared by writing 1. */
+	FLASH->SR = FLASH_DRIVER_ERROR_FLAGS | FLASH_SR_EOP;
+
+	return true;
+}
+
+/**
+ * @brief Lock the control register again.
+ *
+ */
+static void flash_lock(void)
+{
+	FLASH->CR |= FLASH_CR_LOCK;
+}
+
+/**
+ * @brief Invalidate the ART data cache after the array content changed.
+ *
+ */
+static void flash_reset_data_cache(void)
+{
+	uint32_t dcache_enabled = FLASH->ACR & FLASH_ACR_DCEN;
+
+	FLASH->ACR &= ~FLASH_ACR_DCEN;
+	FLASH->ACR |= FLASH_ACR_DCRST;
+	FLASH->ACR &= ~FLASH_ACR_DCRST;
+	FLASH->ACR |= dcache_enabled;
+}
+
+bool flash_erase_sector(uint8_t sector)
+{
+	if (sector >= FLASH_SECTOR_COUNT) return false;
+	if (!flash_unlock()) return false;
+
+	FLASH->CR = FLASH_DRIVER_PSIZE_X32 | FLASH_CR_SER | ((uint32_t)sector << FLASH_CR_SNB_Pos);
+	FLASH->CR |= FLASH_CR_STRT;
+	flash_wait_idle();
+
+	bool ok = ((FLASH->SR & FLASH_DRIVER_ERROR_FLAGS) == 0u);
+
+	FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+	flash_lock();
+	flash_reset_data_cache();
+
+	return ok;
+}
+
+bool flash_program_words(uint32_t address, const uint32_t *data, size_t word_count)
+{
+	if ((data == NULL) || ((address & 0x3u) != 0u)) return false;
+	if (!flash_unlock()) return false;
+
+	bool ok = true;
+
+	FLASH->CR = FLASH_DRIVER_PSIZE_X32 | FLASH_CR_PG;
+	for (size_t i = 0u; (i < word_count) && ok; i++)
+	{
+		volatile uint32_t *destination = (volatile uint32_t *)(address + (uint32_t)(i * sizeof(uint32_t)));
+
+		*destination = data[i];
+		__DSB();
+		flash_wait_idle();
+
+		ok = ((FLASH->SR & FLASH_DRIVER_ERROR_FLAGS) == 0u);
+	}
+
+	FLASH->CR &= ~FLASH_CR_PG;
+	flash_lock();
+	flash_reset_data_cache();
+
+	/* Verify after the cache reset, a cached erased word would hide the new content. */
+	for (size_t i = 0u; (i < word_count) && ok; i++)
+	{
+		ok = (*(const volatile uint32_t *)(address + (uint32_t)(i * sizeof(uint32_t))) == data[i]);
+	}
+
+	return ok;
+}
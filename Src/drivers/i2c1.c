@@ -0,0 +1,313 @@
+/**
+ * @file i2c1.c
+ * @brief Interrupt/DMA-driven I2C1 master implementation (STM32F4, CMSIS only).
+ *
+ *  Notes:
+ *  - only ITEVTEN / ITERREN are used (no ITBUFEN): SB, ADDR and BTF drive the
+ *    state machine, the DMA stream moves the read data.
+ *  - timing (RM0390 27.6.8): standard mode CCR = pclk / (2 * f),
+ *    TRISE = pclk_MHz + 1; fast mode (DUTY = 0) CCR = pclk / (3 * f),
+ *    TRISE = pclk_MHz * 300 ns + 1.
+ */
+
+#include "drivers/i2c1.h"
+
+#define I2C1_STANDARD_MODE_MAX_HZ   100000u
+#define I2C1_FAST_MODE_MAX_HZ       400000u
+#define I2C1_ERROR_FLAGS            (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | I2C_SR1_TIMEOUT)
+
+/* Program FREQ, CCR and TRISE and enable the peripheral with its interrupts */
+static void i2c1_configure(const i2c1_cfg_t *cfg)
+{
+	uint32_t pclk_mhz = cfg->pclk_hz / 1000000u;
+	uint32_t ccr = 0u;
+
+	I2C1->CR1 = 0u;
+	I2C1->CR2 = (pclk_mhz << I2C_CR2_FREQ_Pos) | I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+
+	if (cfg->bus_hz <= I2C1_STANDARD_MODE_MAX_HZ)
+	{
+		ccr = (cfg->pclk_hz + (2u * cfg->bus_hz) - 1u) / (2u * cfg->bus_hz);
+		if (ccr < 4u) ccr = 4u;
+		I2C1->CCR = ccr;
+		I2C1->TRISE = pclk_mhz + 1u;
+	}
+	else
+	{
+		/* Rounded up: the bus runs at or just below the requested rate */
+		ccr = (cfg->pclk_hz + (3u * cfg->bus_hz) - 1u) / (3u * cfg->bus_hz);
+		if (ccr < 1u) ccr = 1u;
+		I2C1->CCR = I2C_CCR_FS | ccr;
+		I2C1->TRISE = ((pclk_mhz * 300u) / 1000u) + 1u;
+	}
+
+	I2C1->CR1 = I2C_CR1_PE;
+}
+
+/* End the transaction and report the result to the owner */
+static void i2c1_finish(i2c1_handle_t *i2c1_h, bool success)
+{
+	i2c1_callback_t callback = i2c1_h->callback;
+
+	I2C1->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+	i2c1_h->state = I2C1_STATE_IDLE;
+
+	if (callback != NULL)
+	{
+		callback(i2c1_h->callback_arg, success);
+	}
+}
+
+/* DMA transfer complete: last byte is in memory (already NACKed), release the bus */
+static void i2c1_dma_rx_complete_callback(void *callback_arg)
+{
+	i2c1_handle_t *i2c1_h = (i2c1_handle_t *)callback_arg;
+
+	if ((i2c1_h == NULL) || (i2c1_h->state != I2C1_STATE_RECEIVE)) return;
+
+	I2C1->CR1 |= I2C_CR1_STOP;
+	i2c1_finish(i2c1_h, true);
+}
+
+/* Common start of both transaction types */
+static bool i2c1_start(i2c1_handle_t *i2c1_h, uint8_t device_address, uint8_t register_address,
+					   i2c1_callback_t callback, void *callback_arg)
+{
+	if (i2c1_h->state != I2C1_STATE_IDLE) return false;
+	/* The previous STOP may still be on the bus */
+	if ((I2C1->CR1 & I2C_CR1_STOP) != 0u) return false;
+
+	i2c1_h->device_address = device_address;
+	i2c1_h->register_address = register_address;
+	i2c1_h->callback = callback;
+	i2c1_h->callback_arg = callback_arg;
+	i2c1_h->tx_index = 0u;
+	i2c1_h->state = I2C1_STATE_ADDRESS_WRITE;
+
+	I2C1->CR1 |= I2C_CR1_ACK | I2C_CR1_START;
+
+	return true;
+}
+
+bool i2c1_init(i2c1_handle_t *i2c1_h, const i2c1_cfg_t *i2c1_cfg)
+{
+	if ((i2c1_h == NULL) || (i2c1_cfg == NULL)) return false;
+	if ((i2c1_cfg->pin_cfg_scl == NULL) || (i2c1_cfg->pin_cfg_sda == NULL)) return false;
+	if ((i2c1_cfg->rx_dma_h == NULL) || (i2c1_cfg->rx_dma_h->is_initialized == false)) return false;
+	if ((i2c1_cfg->pclk_hz < 2000000u) || (i2c1_cfg->pclk_hz > 50000000u)) return false;
+	if ((i2c1_cfg->bus_hz == 0u) || (i2c1_cfg->bus_hz > I2C1_FAST_MODE_MAX_HZ)) return false;
+
+	/* Enable clock for I2C1 and reset it (a halted previous run may leave BUSY set) */
+	RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
+	RCC->APB1RSTR |= RCC_APB1RSTR_I2C1RST;
+	RCC->APB1RSTR &= ~RCC_APB1RSTR_I2C1RST;
+
+	/* Configure SCL and SDA */
+	if (!gpio_init_pin(i2c1_cfg->pin_cfg_scl)) return false;
+	if (!gpio_init_pin(i2c1_cfg->pin_cfg_sda)) return false;
+
+	if (!dma_register_callbacks(i2c1_cfg->rx_dma_h, NULL, i2c1_dma_rx_complete_callback, i2c1_h)) return false;
+
+	i2c1_h->cfg = i2c1_cfg;
+	i2c1_h->state = I2C1_STATE_IDLE;
+	i2c1_h->callback = NULL;
+	i2c1_h->callback_arg = NULL;
+	i2c1_h->nack_cnt = 0u;
+	i2c1_h->bus_error_cnt = 0u;
+	i2c1_h->arbitration_lost_cnt = 0u;
+	i2c1_h->abort_cnt = 0u;
+
+	i2c1_configure(i2c1_cfg);
+
+	// Set interrupt priority for NVIC
+	NVIC_SetPriority(i2c1_cfg->ev_irqn, i2c1_cfg->irq_priority);
+	NVIC_SetPriority(i2c1_cfg->er_irqn, i2c1_cfg->irq_priority);
+	NVIC_ClearPendingIRQ(i2c1_cfg->ev_irqn);
+	NVIC_ClearPendingIRQ(i2c1_cfg->er_irqn);
+	NVIC_EnableIRQ(i2c1_cfg->ev_irqn);
+	NVIC_EnableIRQ(i2c1_cfg->er_irqn);
+
+	i2c1_h->is_initialized = true;
+
+	return true;
+}
+
+bool i2c1_start_read_register(i2c1_handle_t *i2c1_h,
+							  uint8_t device_address,
+							  uint8_t register_address,
+							  volatile uint8_t *buffer,
+							  uint16_t length,
+							  i2c1_callback_t callback,
+							  void *callback_arg)
+{
+	if ((i2c1_h == NULL) || (i2c1_h->is_initialized == false)) return false;
+	if ((buffer == NULL) || (length < 2u)) return false;
+	if (device_address > 0x7Fu) return false;
+
+	i2c1_h->is_read = true;
+	i2c1_h->tx_length = 0u;
+	i2c1_h->rx_buffer = buffer;
+	i2c1_h->rx_length = length;
+
+	return i2c1_start(i2c1_h, device_address, register_address, callback, callback_arg);
+}
+
+bool i2c1_start_write_register(i2c1_handle_t *i2c1_h,
+							   uint8_t device_address,
+							   uint8_t register_address,
+							   const uint8_t *data,
+							   uint8_t length,
+							   i2c1_callback_t callback,
+							   void *callback_arg)
+{
+	if ((i2c1_h == NULL) || (i2c1_h->is_initialized == false)) return false;
+	if ((data == NULL) || (length == 0u) || (length > I2C1_MAX_WRITE_BYTES)) return false;
+	if (device_address > 0x7Fu) return false;
+	if (i2c1_h->state != I2C1_STATE_IDLE) return false;
+
+	i2c1_h->is_read = false;
+	for (uint8_t i = 0u; i < length; i++)
+	{
+		i2c1_h->tx_data[i] = data[i];
+	}
+	i2c1_h->tx_length = length;
+	i2c1_h->rx_buffer = NULL;
+	i2c1_h->rx_length = 0u;
+
+	return i2c1_start(i2c1_h, device_address, register_address, callback, callback_arg);
+}
+
+bool i2c1_is_busy(const i2c1_handle_t *i2c1_h)
+{
+	if (i2c1_h == NULL) return false;
+
+	return (i2c1_h->state != I2C1_STATE_IDLE);
+}
+
+bool i2c1_abort(i2c1_handle_t *i2c1_h)
+{
+	if ((i2c1_h == NULL) || (i2c1_h->is_initialized == false)) return false;
+
+	(void)dma_stop(i2c1_h->cfg->rx_dma_h);
+
+	/* Software reset clears BUSY and every pending flag, the timing is programmed again */
+	I2C1->CR1 |= I2C_CR1_SWRST;
+	I2C1->CR1 &= ~I2C_CR1_SWRST;
+	i2c1_configure(i2c1_h->cfg);
+
+	i2c1_h->state = I2C1_STATE_IDLE;
+	i2c1_h->abort_cnt++;
+
+	return true;
+}
+
+/* SB / ADDR / BTF sequencing, one step per interrupt */
+void i2c1_ev_irq_handler(i2c1_handle_t *i2c1_h)
+{
+	if ((i2c1_h == NULL) || (i2c1_h->is_initialized == false)) return;
+
+	uint32_t sr1 = I2C1->SR1;
+
+	switch (i2c1_h->state)
+	{
+	case I2C1_STATE_ADDRESS_WRITE:
+		if ((sr1 & I2C_SR1_SB) != 0u)
+		{
+			/* SR1 read + DR write clears SB */
+			I2C1->DR = (uint32_t)i2c1_h->device_address << 1;
+			i2c1_h->state = I2C1_STATE_REGISTER;
+		}
+		break;
+
+	case I2C1_STATE_REGISTER:
+		if ((sr1 & I2C_SR1_ADDR) != 0u)
+		{
+			/* SR1 read + SR2 read clears ADDR */
+			(void)I2C1->SR2;
+			I2C1->DR = i2c1_h->register_address;
+			i2c1_h->state = I2C1_STATE_TRANSMIT;
+		}
+		break;
+
+	case I2C1_STATE_TRANSMIT:
+		if ((sr1 & I2C_SR1_BTF) != 0u)
+		{
+			if (i2c1_h->tx_index < i2c1_h->tx_length)
+			{
+				I2C1->DR = i2c1_h->tx_data[i2c1_h->tx_index];
+				i2c1_h->tx_index++;
+			}
+			else if (i2c1_h->is_read)
+			{
+				/* Register pointer set: turn the bus around for the data phase */
+				I2C1->CR1 |= I2C_CR1_START;
+				i2c1_h->state = I2C1_STATE_ADDRESS_READ;
+			}
+			else
+			{
+				/* STOP clears BTF with the pending DR byte already shifted out */
+				I2C1->CR1 |= I2C_CR1_STOP;
+				i2c1_finish(i2c1_h, true);
+			}
+		}
+		break;
+
+	case I2C1_STATE_ADDRESS_READ:
+		if ((sr1 & I2C_SR1_SB) != 0u)
+		{
+			/* DMA owns the data bytes, LAST NACKs the final one */
+			if (!dma_start(i2c1_h->cfg->rx_dma_h, (uint32_t)&I2C1->DR, i2c1_h->rx_buffer, i2c1_h->rx_length))
+			{
+				I2C1->CR1 |= I2C_CR1_STOP;
+				i2c1_finish(i2c1_h, false);
+				break;
+			}
+			I2C1->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
+			I2C1->DR = ((uint32_t)i2c1_h->device_address << 1) | 1u;
+			i2c1_h->state = I2C1_STATE_RECEIVE;
+		}
+		break;
+
+	case I2C1_STATE_RECEIVE:
+		if ((sr1 & I2C_SR1_ADDR) != 0u)
+		{
+			/* Releasing ADDR starts the data phase, the DMA transfer complete ends it */
+			(void)I2C1->SR2;
+		}
+		break;
+
+	case I2C1_STATE_IDLE:
+	default:
+		/* Stray event (e.g. after an abort): clear ADDR so the line is not held */
+		if ((sr1 & I2C_SR1_ADDR) != 0u)
+		{
+			(void)I2C1->SR2;
+		}
+		break;
+	}
+}
+
+/* NACK, bus error, arbitration lost, overrun: count, release the bus and fail the transaction */
+void i2c1_er_irq_handler(i2c1_handle_t *i2c1_h)
+{
+	if ((i2c1_h == NULL) || (i2c1_h->is_initialized == false)) return;
+
+	uint32_t sr1 = I2C1->SR1;
+
+	/* Error flags are cleared by writing 0, the other SR1 bits are read-only */
+	I2C1->SR1 = ~(sr1 & I2C1_ERROR_FLAGS) & 0xFFFFu;
+
+	if ((sr1 & I2C_SR1_AF) != 0u) i2c1_h->nack_cnt++;
+	if ((sr1 & I2C_SR1_BERR) != 0u) i2c1_h->bus_error_cnt++;
+	if ((sr1 & I2C_SR1_ARLO) != 0u) i2c1_h->arbitration_lost_cnt++;
+
+	if (i2c1_h->state == I2C1_STATE_IDLE) return;
+
+	(void)dma_stop(i2c1_h->cfg->rx_dma_h);
+	/* Arbitration lost already released the bus (slave mode), everything else needs a STOP */
+	if ((sr1 & I2C_SR1_ARLO) == 0u)
+	{
+		I2C1->CR1 |= I2C_CR1_STOP;
+	}
+	i2c1_finish(i2c1_h, false);
+}
@@ -2,14 +2,62 @@
  * @file log.c
  * @brief Minimal log output implementation.
  *
+ *  Notes:
+ *  - deferred producers reserve a ring slot with LDREX/STREX on the head
+ *    index and publish it by writing the slot sequence last, so a producer
+ *    preempted between reserve and commit only delays the drain.
+ *  - the drain is the single consumer and owns the tail index.
  */
 
 #include "drivers/log.h"
 
 #include "drivers/systick.h"
+#include "stm32f4xx.h"
 #include <stdio.h>
 
+#define LOG_DEFERRED_RING_MASK      (LOG_DEFERRED_RING_SIZE - 1u)
+#define LOG_LINE_SIZE               128u
+
+#if ((LOG_DEFERRED_RING_SIZE & LOG_DEFERRED_RING_MASK) != 0u)
+#error "LOG_DEFERRED_RING_SIZE must be a power of 2"
+#endif
+
+/**
+ * @brief One deferred log record.
+ *
+ */
+typedef struct {
+	volatile uint32_t sequence;     /* Reserved head index + 1 once the slot is complete. */
+	uint64_t timestamp_us;          /* SYSTICK_GetTimeUs(): the log_printf time base, no 32-bit wrap. */
+	uint16_t msg_id;
+	uint8_t arg_count;
+	int32_t args[LOG_DEFERRED_MAX_ARGS];
+} log_record_t;
+
 static usart2_handle_t *s_uart_h = NULL;
+static log_record_t s_log_ring[LOG_DEFERRED_RING_SIZE];
+static volatile uint32_t s_log_head = 0u;     // Next index to reserve (all producers)
+static volatile uint32_t s_log_tail = 0u;     // Next index to send (drain only)
+static volatile uint32_t s_log_dropped = 0u;
+static uint32_t s_log_dropped_reported = 0u;
+
+#if (LOG_DEFERRED_EXPAND_ON_TARGET != 0u)
+/**
+ * @brief Level, tag and format of one deferred message.
+ *
+ */
+typedef struct {
+	log_level_t level;
+	const char *tag;
+	const char *fmt;
+} log_message_desc_t;
+
+#define LOG_MESSAGE_DESC_ENTRY(id, level, tag, fmt) { (level), (tag), (fmt) },
+
+static const log_message_desc_t s_log_messages[LOG_MSG_COUNT] = {
+	LOG_MESSAGE_TABLE(LOG_MESSAGE_DESC_ENTRY)
+};
+#endif
 
 static char log_level_to_char(log_level_t level)
 {
@@ -105,3 +153,213 @@ void log_write(log_level_t level, const char *tag, const char *msg)
 	log_printf(level, tag, "%s", msg);
 }
 
+/**
+ * @brief Increment one counter shared with interrupt contexts.
+ *
+ * @param counter Pointer to counter.
+ */
+static void log_atomic_increment(volatile uint32_t *counter)
+{
+	uint32_t value;
+
+	do
+	{
+		value = __LDREXW(counter);
+	} while (__STREXW(value + 1u, counter) != 0u);
+}
+
+#if (LOG_DEFERRED_EXPAND_ON_TARGET == 0u)
+/**
+ * @brief Append one unsigned decimal value to a line buffer (no stdio).
+ *
+ * @param line Line buffer.
+ * @param offset Write position.
+ * @param value Value to append.
+ * @return New write position.
+ */
+static size_t log_append_u64(char *line, size_t offset, uint64_t value)
+{
+	char digits[20];
+	size_t count = 0u;
+
+	do
+	{
+		digits[count++] = (char)('0' + (value % 10u));
+		value /= 10u;
+	} while (value != 0u);
+
+	while (count != 0u)
+	{
+		line[offset++] = digits[--count];
+	}
+
+	return offset;
+}
+
+/**
+ * @brief Append one signed decimal value to a line buffer (no stdio).
+ *
+ * @param line Line buffer.
+ * @param offset Write position.
+ * @param value Value to append.
+ * @return New write position.
+ */
+static size_t log_append_i32(char *line, size_t offset, int32_t value)
+{
+	if (value < 0)
+	{
+		line[offset++] = '-';
+		return log_append_u64(line, offset, 0u - (uint32_t)value);
+	}
+
+	return log_append_u64(line, offset, (uint32_t)value);
+}
+#endif
+
+/**
+ * @brief Format one deferred record into one output line.
+ *
+ * @param record Record copy.
+ * @param line Output buffer of LOG_LINE_SIZE bytes.
+ * @return Line length including CR LF, 0 if the record cannot be formatted.
+ */
+static size_t log_format_record(const log_record_t *record, char *line)
+{
+#if (LOG_DEFERRED_EXPAND_ON_TARGET != 0u)
+	if (record->msg_id >= (uint16_t)LOG_MSG_COUNT) return 0u;
+
+	const log_message_desc_t *desc = &s_log_messages[record->msg_id];
+	int len = snprintf(line,
+					   LOG_LINE_SIZE,
+					   "L,%lu,%c,%s,",
+					   (unsigned long)(record->timestamp_us / 1000u),
+					   log_level_to_char(desc->level),
+					   desc->tag);
+
+	if ((len <= 0) || ((size_t)len >= LOG_LINE_SIZE)) return 0u;
+
+	// Surplus arguments are ignored by the format; all conversions take long
+	int msg_len = snprintf(&line[len],
+						   LOG_LINE_SIZE - (size_t)len,
+						   desc->fmt,
+						   (long)record->args[0],
+						   (long)record->args[1],
+						   (long)record->args[2]);
+
+	if (msg_len < 0) return 0u;
+
+	size_t used_len = (size_t)len + (size_t)msg_len;
+	if (used_len >= (LOG_LINE_SIZE - 2u))
+	{
+		used_len = LOG_LINE_SIZE - 2u;
+	}
+#else
+	// T,<time_us>,<msg_id>,<args...>: at most 2 + 21 + 6 + 3 * 12 + 2 bytes
+	size_t used_len = 0u;
+
+	line[used_len++] = 'T';
+	line[used_len++] = ',';
+	used_len = log_append_u64(line, used_len, record->timestamp_us);
+	line[used_len++] = ',';
+	used_len = log_append_u64(line, used_len, (uint32_t)record->msg_id);
+	for (uint8_t i = 0u; i < record->arg_count; i++)
+	{
+		line[used_len++] = ',';
+		used_len = log_append_i32(line, used_len, record->args[i]);
+	}
+#endif
+
+	line[used_len++] = '\r';
+	line[used_len++] = '\n';
+
+	return used_len;
+}
+
+bool log_post(log_msg_id_t msg_id, uint32_t arg_count, int32_t a0, int32_t a1, int32_t a2)
+{
+	if (((uint32_t)msg_id >= (uint32_t)LOG_MSG_COUNT) || (arg_count > LOG_DEFERRED_MAX_ARGS)) return false;
+
+	uint32_t index;
+
+	// Reserve one slot; a full ring drops the record instead of waiting
+	do
+	{
+		index = __LDREXW(&s_log_head);
+		if ((index - s_log_tail) >= LOG_DEFERRED_RING_SIZE)
+		{
+			__CLREX();
+			log_atomic_increment(&s_log_dropped);
+			return false;
+		}
+	} while (__STREXW(index + 1u, &s_log_head) != 0u);
+
+	log_record_t *record = &s_log_ring[index & LOG_DEFERRED_RING_MASK];
+	record->timestamp_us = SYSTICK_GetTimeUs();
+	record->msg_id = (uint16_t)msg_id;
+	record->arg_count = (uint8_t)arg_count;
+	record->args[0] = a0;
+	record->args[1] = a1;
+	record->args[2] = a2;
+
+	// Payload before sequence: the drain reads the slot only after the commit
+	__DMB();
+	record->sequence = index + 1u;
+
+	return true;
+}
+
+bool log_drain(uint32_t max_records)
+{
+	char line[LOG_LINE_SIZE];
+	log_record_t record;
+
+	if (s_uart_h == NULL) return false;
+
+	for (uint32_t sent = 0u; sent < max_records; sent++)
+	{
+		if (usart2_tx_free_space(s_uart_h) < LOG_LINE_SIZE) return true;
+
+		// Report ring overflow once per burst, ahead of the surviving records
+		uint32_t dropped = s_log_dropped;
+		if (dropped != s_log_dropped_reported)
+		{
+			record.timestamp_us = SYSTICK_GetTimeUs();
+			record.msg_id = (uint16_t)LOG_MSG_LOG_DROPPED;
+			record.arg_count = 1u;
+			record.args[0] = (int32_t)(dropped - s_log_dropped_reported);
+			record.args[1] = 0;
+			record.args[2] = 0;
+			s_log_dropped_reported = dropped;
+		}
+		else
+		{
+			uint32_t tail = s_log_tail;
+			const log_record_t *slot = &s_log_ring[tail & LOG_DEFERRED_RING_MASK];
+
+			// Reserved but not committed yet (producer preempted): retry next drain
+			if (slot->sequence != (tail + 1u)) return false;
+
+			__DMB();
+			record = *slot;
+			record.sequence = 0u;
+			__DMB();
+			s_log_tail = tail + 1u;
+		}
+
+		size_t len = log_format_record(&record, line);
+		if (len != 0u)
+		{
+			usart2_write(s_uart_h, (const uint8_t *)line, len);
+		}
+	}
+
+	uint32_t tail = s_log_tail;
+	return (s_log_ring[tail & LOG_DEFERRED_RING_MASK].sequence == (tail + 1u)) ||
+		   (s_log_dropped != s_log_dropped_reported);
+}
+
+uint32_t log_get_dropped_count(void)
+{
+	return s_log_dropped;
+}
+
@@ -0,0 +1,71 @@
+/**
+ * @file profiler.c
+ * @brief DWT cycle-counter profiling implementation (Cortex-M4, CMSIS only).
+ *
+ *  Notes:
+ *  - one record is two compares, a 64-bit add and an increment; the marker
+ *    overhead (two CYCCNT reads) is included in every sample.
+ *  - get_stats masks IRQs (BASEPRI, up to IRQ_LOCK_PRIORITY_PROFILER) only for
+ *    the copy of one probe.
+ */
+
+#include "drivers/profiler.h"
+#include "drivers/irq_lock.h"
+#include "config/irq_priority_config.h"
+
+#if (PROFILER_ENABLE != 0u)
+
+static profiler_probe_stats_t s_profiler_probes[PROFILER_PROBE_COUNT];
+
+bool profiler_init(void)
+{
+	// Enable trace block, then start the cycle counter from zero
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0u;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	profiler_reset();
+
+	// DWT without cycle counter (NOCYCCNT) leaves CYCCNT at zero
+	return ((DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk) == 0u);
+}
+
+void profiler_reset(void)
+{
+	uint32_t lock = irq_lock_raise(IRQ_LOCK_PRIORITY_PROFILER);
+
+	for (uint32_t i = 0u; i < (uint32_t)PROFILER_PROBE_COUNT; i++)
+	{
+		s_profiler_probes[i].count = 0u;
+		s_profiler_probes[i].min_cycles = UINT32_MAX;
+		s_profiler_probes[i].max_cycles = 0u;
+		s_profiler_probes[i].sum_cycles = 0u;
+	}
+
+	irq_lock_restore(lock);
+}
+
+void profiler_record(profiler_probe_id_t probe_id, uint32_t cycles)
+{
+	if ((uint32_t)probe_id >= (uint32_t)PROFILER_PROBE_COUNT) return;
+
+	profiler_probe_stats_t *probe = &s_profiler_probes[probe_id];
+	if (cycles < probe->min_cycles) probe->min_cycles = cycles;
+	if (cycles > probe->max_cycles) probe->max_cycles = cycles;
+	probe->sum_cycles += cycles;
+	probe->count++;
+}
+
+bool profiler_get_stats(profiler_probe_id_t probe_id, profiler_probe_stats_t *stats)
+{
+	if ((stats == NULL) || ((uint32_t)probe_id >= (uint32_t)PROFILER_PROBE_COUNT)) return false;
+
+	// copy under masked IRQs so ISR probes do not tear the 64-bit sum
+	uint32_t lock = irq_lock_raise(IRQ_LOCK_PRIORITY_PROFILER);
+	*stats = s_profiler_probes[probe_id];
+	irq_lock_restore(lock);
+
+	return true;
+}
+
+#endif /* PROFILER_ENABLE */
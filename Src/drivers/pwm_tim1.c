@@ -2,31 +2,87 @@
  * @file pwm_tim1.c
  * @brief PWM module implementation (STM32F4, CMSIS only).
  *
- * TIM1 configuration using direct register access (CMSIS).
- * Implements: mode: PWM1, center-aligned.
+ * TIM1 / TIM8 configuration using direct register access (CMSIS).
+ * Implements: mode: PWM1, center-aligned, optional update interrupt, break shutdown,
+ * optional complementary outputs with dead time, optional COM-event commutation.
  */
 
 #include "drivers/pwm_tim1.h"
+#include "drivers/irq_lock.h"
+#include "drivers/memory_section.h"
 
 /**
- * @brief Configure TIM1 registers for PWM1 mode.
+ * @brief Encode one dead time into the BDTR DTG field (tDTS = timer clock, CKD = 0).
+ *
+ * DTG[7:5] selects the step: 0xx -> 1 x tDTS (0..127), 10x -> 2 x tDTS (128..254),
+ * 110 -> 8 x tDTS (256..504), 111 -> 16 x tDTS (512..1008). Rounded up so the
+ * programmed dead time is never shorter than requested.
+ *
+ * @param tim_clk_hz Timer clock.
+ * @param dead_time_ns Requested dead time.
+ * @param dtg Pointer to output DTG value.
+ * @param dead_time_ticks Pointer to output programmed dead time in timer clocks.
+ * @return true if encodable, false if out of range.
+ */
+static bool pwm_tim1_encode_dead_time(uint32_t tim_clk_hz,
+									  uint32_t dead_time_ns,
+									  uint8_t *dtg,
+									  uint32_t *dead_time_ticks)
+{
+	uint64_t ticks = (((uint64_t)dead_time_ns * tim_clk_hz) + 999999999u) / 1000000000u;
+
+	if (ticks <= 127u)
+	{
+		*dtg = (uint8_t)ticks;
+		*dead_time_ticks = (uint32_t)ticks;
+	}
+	else if (ticks <= 254u)
+	{
+		uint32_t steps = (uint32_t)((ticks + 1u) / 2u);
+		*dtg = (uint8_t)(0x80u | (steps - 64u));
+		*dead_time_ticks = 2u * steps;
+	}
+	else if (ticks <= 504u)
+	{
+		uint32_t steps = (uint32_t)((ticks + 7u) / 8u);
+		*dtg = (uint8_t)(0xC0u | (steps - 32u));
+		*dead_time_ticks = 8u * steps;
+	}
+	else if (ticks <= PWM_TIM1_MAX_DEAD_TIME_TICKS)
+	{
+		uint32_t steps = (uint32_t)((ticks + 15u) / 16u);
+		*dtg = (uint8_t)(0xE0u | (steps - 32u));
+		*dead_time_ticks = 16u * steps;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Configure the timer channels for PWM1 mode.
  * PWM channels must be provided as gpio_pin_cfg_t pointers (NULL disables a channel).
  *
- * @param pwm_cfg Pointer to the TIM1 configuration instance.
+ * @param pwm_cfg Pointer to the timer configuration instance.
  */
 static void pwm_config_channels(const pwm_tim1_cfg_t* pwm_cfg)
 {
-	uint32_t ccer  = TIM1->CCER;
-	uint32_t ccmr1 = TIM1->CCMR1;
-	uint32_t ccmr2 = TIM1->CCMR2;
+	TIM_TypeDef *tim = pwm_cfg->inst;
+	uint32_t ccer  = tim->CCER;
+	uint32_t ccmr1 = tim->CCMR1;
+	uint32_t ccmr2 = tim->CCMR2;
 
 	/* Determine active channels */
 	bool ch1_en = (pwm_cfg->pin_ch1 != NULL);
 	bool ch2_en = (pwm_cfg->pin_ch2 != NULL);
 	bool ch3_en = (pwm_cfg->pin_ch3 != NULL);
 
-	/* Disable outputs before configuration: CCxE = 0 */
+	/* Disable outputs before configuration: CCxE = 0, CCxNE = 0 */
 	ccer &= ~(TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E);
+	ccer &= ~(TIM_CCER_CC1NE | TIM_CCER_CC2NE | TIM_CCER_CC3NE);
 
 	/* Configure CCMRx */
 
@@ -60,15 +116,20 @@ static void pwm_config_channels(const pwm_tim1_cfg_t* pwm_cfg)
 	/*  Polarity active-high (CCxP=0) and enable outputs (CCxE=1) */
 	// Clear polarity bits
 	ccer &= ~(TIM_CCER_CC1P | TIM_CCER_CC2P | TIM_CCER_CC3P);
+	ccer &= ~(TIM_CCER_CC1NP | TIM_CCER_CC2NP | TIM_CCER_CC3NP);
 	// enable outputs for active channels
 	if (ch1_en) ccer |= TIM_CCER_CC1E;
 	if (ch2_en) ccer |= TIM_CCER_CC2E;
 	if (ch3_en) ccer |= TIM_CCER_CC3E;
+	// complementary low-side outputs (active-high, inverted OCxREF plus dead time)
+	if (pwm_cfg->pin_ch1n) ccer |= TIM_CCER_CC1NE;
+	if (pwm_cfg->pin_ch2n) ccer |= TIM_CCER_CC2NE;
+	if (pwm_cfg->pin_ch3n) ccer |= TIM_CCER_CC3NE;
 
 	// Write back registers
-	TIM1->CCMR1 = ccmr1;
-	TIM1->CCMR2 = ccmr2;
-	TIM1->CCER  = ccer;
+	tim->CCMR1 = ccmr1;
+	tim->CCMR2 = ccmr2;
+	tim->CCER  = ccer;
 }
 
 bool pwm_tim1_init(const pwm_tim1_cfg_t* pwm_cfg, pwm_tim1_handle_t* pwm_h)
@@ -76,9 +137,15 @@ bool pwm_tim1_init(const pwm_tim1_cfg_t* pwm_cfg, pwm_tim1_handle_t* pwm_h)
 	/* check pointers and GPIO configurations */
 	if ((pwm_cfg == NULL)||(pwm_h == NULL)) return false;
 
+	// Advanced-control timers only (complementary outputs, break, COM)
+	if ((pwm_cfg->inst != TIM1) && (pwm_cfg->inst != TIM8)) return false;
+
 	// At least one channel must be configured
 	if (!pwm_cfg->pin_ch1 && !pwm_cfg->pin_ch2 && !pwm_cfg->pin_ch3) return false;
 
+	// The grouped compare write must not mask the fault level (BASEPRI 0 disables masking)
+	if (pwm_cfg->duty_lock_priority == 0u) return false;
+
 	// Check gpio_init
 	if(pwm_cfg->pin_ch1)
 	{
@@ -92,6 +159,27 @@ bool pwm_tim1_init(const pwm_tim1_cfg_t* pwm_cfg, pwm_tim1_handle_t* pwm_h)
 	{
 		if(!gpio_init_pin(pwm_cfg->pin_ch3)) return false;
 	}
+	// A complementary output is only generated next to its main channel
+	if ((pwm_cfg->pin_ch1n && !pwm_cfg->pin_ch1) ||
+		(pwm_cfg->pin_ch2n && !pwm_cfg->pin_ch2) ||
+		(pwm_cfg->pin_ch3n && !pwm_cfg->pin_ch3)) return false;
+	bool has_complementary = (pwm_cfg->pin_ch1n || pwm_cfg->pin_ch2n || pwm_cfg->pin_ch3n);
+	if(pwm_cfg->pin_ch1n)
+	{
+		if(!gpio_init_pin(pwm_cfg->pin_ch1n)) return false;
+	}
+	if(pwm_cfg->pin_ch2n)
+	{
+		if(!gpio_init_pin(pwm_cfg->pin_ch2n)) return false;
+	}
+	if(pwm_cfg->pin_ch3n)
+	{
+		if(!gpio_init_pin(pwm_cfg->pin_ch3n)) return false;
+	}
+	if(pwm_cfg->pin_bkin)
+	{
+		if(!gpio_init_pin(pwm_cfg->pin_bkin)) return false;
+	}
 
 	// check clock and PWM frequencies
 	if ((pwm_cfg->tim_clk_hz == 0)||(pwm_cfg->pwm_hz == 0)) return false;
@@ -99,6 +187,16 @@ bool pwm_tim1_init(const pwm_tim1_cfg_t* pwm_cfg, pwm_tim1_handle_t* pwm_h)
 	// TODO: Add configuration for Edge-aligned mode
 	if (pwm_cfg->align < 1u || pwm_cfg->align > 3u) return false;
 
+	// Dead time only exists between complementary outputs (a 3-PWM board inserts its own)
+	uint8_t dtg = 0u;
+	uint32_t dead_time_ticks = 0u;
+	if (has_complementary)
+	{
+		// both switches of a leg must never overlap: zero dead time is a configuration error
+		if (pwm_cfg->dead_time_ns == 0u) return false;
+		if (!pwm_tim1_encode_dead_time(pwm_cfg->tim_clk_hz, pwm_cfg->dead_time_ns, &dtg, &dead_time_ticks)) return false;
+	}
+
 	/* Compute PSC and ARR */
 
 	// For center-aligned, counter goes up then down, so:
@@ -118,83 +216,532 @@ bool pwm_tim1_init(const pwm_tim1_cfg_t* pwm_cfg, pwm_tim1_handle_t* pwm_h)
 	if (arr > 65535u) return false;
 
 	pwm_h->arr = (uint16_t) arr;			// store for duty computation later
-
-	/* Enable clock for TIM1 */
-	RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
-
-	/* Disable TIM1  */
-	TIM1->CR1 &= ~TIM_CR1_CEN;
+	pwm_h->psc = psc;
+	pwm_h->dead_time_ns = (uint32_t)(((uint64_t)dead_time_ticks * 1000000000u) / pwm_cfg->tim_clk_hz);
+	pwm_h->cfg = pwm_cfg;
+	pwm_h->inst = pwm_cfg->inst;
+	pwm_h->update_event_cnt = 0u;
+	pwm_h->break_latched = false;
+	pwm_h->com_event_cnt = 0u;
+	pwm_h->is_commutation_enabled = false;
+
+	/* Enable clock for the timer */
+	TIM_TypeDef *tim = pwm_cfg->inst;
+	RCC->APB2ENR |= (tim == TIM1) ? RCC_APB2ENR_TIM1EN : RCC_APB2ENR_TIM8EN;
+
+	/* Disable the counter */
+	tim->CR1 &= ~TIM_CR1_CEN;
 
 	/* Configure center-aligned mode selection */
-	TIM1->CR1 &= ~TIM_CR1_CMS;
-	TIM1->CR1 |= ((uint32_t)(pwm_cfg->align & 0x3u) << TIM_CR1_CMS_Pos);
+	tim->CR1 &= ~TIM_CR1_CMS;
+	tim->CR1 |= ((uint32_t)(pwm_cfg->align & 0x3u) << TIM_CR1_CMS_Pos);
 
 	/* Set direction to up-counting	*/
-	TIM1->CR1 &= ~TIM_CR1_DIR;
+	tim->CR1 &= ~TIM_CR1_DIR;
+
+	/* Dead-time clock tDTS = timer clock (CKD = 0) */
+	tim->CR1 &= ~TIM_CR1_CKD;
 
 	/* Configure PSC and ARR registers */
-	TIM1->PSC = psc;
-	TIM1->ARR = (uint16_t) arr;
-	TIM1->CR1 |= TIM_CR1_ARPE;
+	tim->PSC = psc;
+	tim->ARR = (uint16_t) arr;
+	tim->CR1 |= TIM_CR1_ARPE;
+
+	/* Update interrupt stays disabled until pwm_tim1_enable_update_irq() */
+	tim->DIER &= ~TIM_DIER_UIE;
+	tim->RCR = 1u;							// one update event per PWM period (center-aligned)
+	tim->CR1 |= TIM_CR1_URS;				// only counter over/underflow sets UIF, not UG
+
+	// Commutation mode stays off until pwm_tim1_enable_commutation() (direct CCMR/CCER writes)
+	tim->DIER &= ~TIM_DIER_COMIE;
+	tim->CR2 &= ~(TIM_CR2_CCPC | TIM_CR2_CCUS);
+	tim->SMCR &= ~TIM_SMCR_TS;
 
 	// PWM config for CH1/CH2/CH3 (PWM mode 1 + preload) + enable outputs
 	// (Implement with clear-then-set patterns for CCMR1/CCMR2 and CCER)
 	pwm_config_channels(pwm_cfg);   // Configure CCMR/CCER for enabled channels
 
+	// idle levels while MOE = 0 (OISx), written before the break can clear MOE
+	tim->CR2 &= ~(TIM_CR2_OIS1 | TIM_CR2_OIS2 | TIM_CR2_OIS3);
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH1) tim->CR2 |= TIM_CR2_OIS1;
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH2) tim->CR2 |= TIM_CR2_OIS2;
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH3) tim->CR2 |= TIM_CR2_OIS3;
+	tim->CR2 &= ~(TIM_CR2_OIS1N | TIM_CR2_OIS2N | TIM_CR2_OIS3N);
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH1N) tim->CR2 |= TIM_CR2_OIS1N;
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH2N) tim->CR2 |= TIM_CR2_OIS2N;
+	if (pwm_cfg->idle_high_mask & PWM_TIM1_IDLE_HIGH_CH3N) tim->CR2 |= TIM_CR2_OIS3N;
+
+	// BDTR in one write (DTG/BKE/BKP/OSSx are lockable as a group): dead time, off states, break input, AOE = 0
+	uint32_t bdtr = ((uint32_t)dtg << TIM_BDTR_DTG_Pos);
+	if (pwm_cfg->idle_off_state_driven) bdtr |= TIM_BDTR_OSSI;
+	if (pwm_cfg->run_off_state_driven) bdtr |= TIM_BDTR_OSSR;
+	if (pwm_cfg->pin_bkin)
+	{
+		bdtr |= TIM_BDTR_BKE;
+		if (pwm_cfg->break_polarity == PWM_BREAK_ACTIVE_HIGH) bdtr |= TIM_BDTR_BKP;
+	}
 	// advanced timer output enable: MOE = 1
-	TIM1->BDTR |= TIM_BDTR_MOE;
+	bdtr |= TIM_BDTR_MOE;
+	tim->BDTR = bdtr;
+
+	// break interrupt (BKIN and software break): clear stale flag, highest priority
+	tim->SR = ~TIM_SR_BIF;				// rc_w0: write 0 clears only BIF
+	NVIC_SetPriority(pwm_cfg->break_irqn, pwm_cfg->break_irq_priority);
+	NVIC_ClearPendingIRQ(pwm_cfg->break_irqn);
+	NVIC_EnableIRQ(pwm_cfg->break_irqn);
+	tim->DIER |= TIM_DIER_BIE;
 
 	// safe initial duty
-	TIM1->CCR1 = 0u;
-	TIM1->CCR2 = 0u;
-	TIM1->CCR3 = 0u;
+	tim->CCR1 = 0u;
+	tim->CCR2 = 0u;
+	tim->CCR3 = 0u;
 
 	// update event to load preloads
-	TIM1->EGR = TIM_EGR_UG;
+	tim->EGR = TIM_EGR_UG;
 
 	return true;
 
 }
 
+/**
+ * @brief Write CCR1..3 (and optionally CCR4) with the update event held off.
+ *
+ * @param pwm_h Pointer to the TIM1 handle instance (validated by the caller).
+ * @param duty_a CH1 compare value (0..ARR).
+ * @param duty_b CH2 compare value (0..ARR).
+ * @param duty_c CH3 compare value (0..ARR).
+ * @param write_trigger true to write CCR4 as well.
+ * @param trigger_ticks CH4 compare value (0..ARR).
+ */
+MEMORY_SECTION_RAMFUNC
+static void pwm_tim1_write_compares(pwm_tim1_handle_t* pwm_h,
+									uint16_t duty_a,
+									uint16_t duty_b,
+									uint16_t duty_c,
+									bool write_trigger,
+									uint16_t trigger_ticks)
+{
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	// CCRx are preloaded (OCxPE): with UDIS the shadow transfer sees all writes or none of them
+	uint32_t lock = irq_lock_raise(pwm_h->cfg->duty_lock_priority);
+	tim->CR1 |= TIM_CR1_UDIS;
+	tim->CCR1 = duty_a;
+	tim->CCR2 = duty_b;
+	tim->CCR3 = duty_c;
+	if (write_trigger) tim->CCR4 = trigger_ticks;
+	tim->CR1 &= ~TIM_CR1_UDIS;
+	irq_lock_restore(lock);
+}
+
+MEMORY_SECTION_RAMFUNC
 bool pwm_tim1_set_duty(pwm_tim1_handle_t* pwm_h, uint8_t ch, uint16_t duty)
 {
-    if (pwm_h == NULL) return false;
+    if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+    TIM_TypeDef *tim = pwm_h->inst;
 
     // saturate to [0 - ARR]
     if (duty > pwm_h->arr) duty = pwm_h->arr;
 
     switch (ch) {
-        case 1: TIM1->CCR1 = duty; break;
-        case 2: TIM1->CCR2 = duty; break;
-        case 3: TIM1->CCR3 = duty; break;
+        case 1: tim->CCR1 = duty; break;
+        case 2: tim->CCR2 = duty; break;
+        case 3: tim->CCR3 = duty; break;
         default: return false;
     }
     return true;
 }
 
+MEMORY_SECTION_RAMFUNC
+bool pwm_tim1_set_duty_abc(pwm_tim1_handle_t* pwm_h, uint16_t duty_a, uint16_t duty_b, uint16_t duty_c)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL) || (pwm_h->cfg == NULL)) return false;
+
+	// saturate to [0 - ARR]
+	if (duty_a > pwm_h->arr) duty_a = pwm_h->arr;
+	if (duty_b > pwm_h->arr) duty_b = pwm_h->arr;
+	if (duty_c > pwm_h->arr) duty_c = pwm_h->arr;
+
+	pwm_tim1_write_compares(pwm_h, duty_a, duty_b, duty_c, false, 0u);
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool pwm_tim1_set_duty_abc_trigger(pwm_tim1_handle_t* pwm_h,
+								   uint16_t duty_a,
+								   uint16_t duty_b,
+								   uint16_t duty_c,
+								   uint16_t trigger_ticks)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL) || (pwm_h->cfg == NULL)) return false;
+	if (trigger_ticks > pwm_h->arr) return false;
+
+	// saturate to [0 - ARR]
+	if (duty_a > pwm_h->arr) duty_a = pwm_h->arr;
+	if (duty_b > pwm_h->arr) duty_b = pwm_h->arr;
+	if (duty_c > pwm_h->arr) duty_c = pwm_h->arr;
+
+	pwm_tim1_write_compares(pwm_h, duty_a, duty_b, duty_c, true, trigger_ticks);
+	return true;
+}
+
 
 bool pwm_tim1_start(pwm_tim1_handle_t* pwm_h)
 {
-    if (!pwm_h) return false;
+    if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+    TIM_TypeDef *tim = pwm_h->inst;
+    // a latched break keeps the outputs off until re-init
+    if (pwm_h->break_latched) return false;
 
     // Enable output gate
-    TIM1->BDTR |= TIM_BDTR_MOE;
+    tim->BDTR |= TIM_BDTR_MOE;
 
     // Start counter
-    TIM1->CR1 |= TIM_CR1_CEN;
+    tim->CR1 |= TIM_CR1_CEN;
 
     return true;
 }
 
 bool pwm_tim1_stop(pwm_tim1_handle_t* pwm_h)
 {
-    if (!pwm_h) return false;
+    if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+    TIM_TypeDef *tim = pwm_h->inst;
 
     // Stop counter
-    TIM1->CR1 &= ~TIM_CR1_CEN;
+    tim->CR1 &= ~TIM_CR1_CEN;
 
     // Disable output gate
-    TIM1->BDTR &= ~TIM_BDTR_MOE;
+    tim->BDTR &= ~TIM_BDTR_MOE;
 
     return true;
 }
+
+bool pwm_tim1_start_staggered(pwm_tim1_handle_t* const pwm_hs[], uint8_t count, uint32_t lock_prio)
+{
+	if ((pwm_hs == NULL) || (count == 0u) || (count > PWM_TIM1_INSTANCE_COUNT)) return false;
+
+	for (uint8_t i = 0u; i < count; i++)
+	{
+		const pwm_tim1_handle_t* pwm_h = pwm_hs[i];
+
+		if ((pwm_h == NULL) || (pwm_h->inst == NULL) || (pwm_h->cfg == NULL)) return false;
+		if (pwm_h->break_latched) return false;
+		// one counter period for all, otherwise the offsets drift apart
+		if ((pwm_h->arr != pwm_hs[0]->arr) || (pwm_h->psc != pwm_hs[0]->psc)) return false;
+		// a running counter would keep its own phase
+		if (pwm_h->inst->CR1 & TIM_CR1_CEN) return false;
+		for (uint8_t j = 0u; j < i; j++)
+		{
+			if (pwm_hs[j]->inst == pwm_h->inst) return false;
+		}
+	}
+
+	// counter i starts i / count of a half period late: the counter extremes (update, peak trigger) interleave
+	for (uint8_t i = 0u; i < count; i++)
+	{
+		TIM_TypeDef *tim = pwm_hs[i]->inst;
+		uint32_t cms = tim->CR1 & TIM_CR1_CMS;
+
+		// DIR is read-only while center-aligned: clear it in edge-aligned mode (counter stopped)
+		tim->CR1 &= ~TIM_CR1_CMS;
+		tim->CR1 &= ~TIM_CR1_DIR;
+		tim->CR1 |= cms;
+		tim->CNT = ((uint32_t)pwm_hs[i]->arr * i) / count;
+
+		// Enable output gate
+		tim->BDTR |= TIM_BDTR_MOE;
+	}
+
+	// back-to-back CEN writes: the offsets hold to within a few timer clocks
+	uint32_t lock = irq_lock_raise(lock_prio);
+	for (uint8_t i = 0u; i < count; i++)
+	{
+		pwm_hs[i]->inst->CR1 |= TIM_CR1_CEN;
+	}
+	irq_lock_restore(lock);
+
+	return true;
+}
+
+bool pwm_tim1_register_update_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	// Disable the update interrupt while the callback pair changes
+	uint32_t dier = tim->DIER;
+	tim->DIER &= ~TIM_DIER_UIE;
+
+	pwm_h->update_callback = callbk;
+	pwm_h->update_callback_arg = callbk_arg;
+
+	tim->DIER = dier;
+	return true;
+}
+
+bool pwm_tim1_register_break_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	// Disable the break interrupt while the callback pair changes (the hardware shutdown stays active)
+	uint32_t dier = tim->DIER;
+	tim->DIER &= ~TIM_DIER_BIE;
+
+	pwm_h->break_callback = callbk;
+	pwm_h->break_callback_arg = callbk_arg;
+
+	tim->DIER = dier;
+	return true;
+}
+
+bool pwm_tim1_trigger_break(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	// BG: hardware clears MOE and sets BIF, as for an active BKIN edge
+	pwm_h->break_latched = true;
+	tim->EGR = TIM_EGR_BG;
+
+	return true;
+}
+
+bool pwm_tim1_enable_commutation(pwm_tim1_handle_t* pwm_h, pwm_tim1_com_trigger_t trigger)
+{
+	if ((pwm_h == NULL) || (pwm_h->cfg == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+	if (trigger > PWM_TIM1_COM_TRIGGER_ITR3) return false;
+
+	// COM source: COMG only (CCUS = 0) or COMG + TRGI rising edge (CCUS = 1, TS = ITRx, slave mode off)
+	tim->CR2 &= ~TIM_CR2_CCUS;
+	tim->SMCR &= ~TIM_SMCR_TS;
+	if (trigger != PWM_TIM1_COM_TRIGGER_SOFTWARE)
+	{
+		tim->SMCR |= ((uint32_t)(trigger - PWM_TIM1_COM_TRIGGER_ITR0) << TIM_SMCR_TS_Pos);
+		tim->CR2 |= TIM_CR2_CCUS;
+	}
+
+	// CCxE / CCxNE / OCxM preloaded from here on, committed by COM only
+	tim->CR2 |= TIM_CR2_CCPC;
+
+	// COM interrupt: clear stale flag, set priority and enable
+	tim->SR = ~TIM_SR_COMIF;			// rc_w0: write 0 clears only COMIF
+	NVIC_SetPriority(pwm_h->cfg->com_irqn, pwm_h->cfg->com_irq_priority);
+	NVIC_ClearPendingIRQ(pwm_h->cfg->com_irqn);
+	NVIC_EnableIRQ(pwm_h->cfg->com_irqn);
+	tim->DIER |= TIM_DIER_COMIE;
+
+	pwm_h->is_commutation_enabled = true;
+	return true;
+}
+
+bool pwm_tim1_disable_commutation(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->cfg == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	tim->DIER &= ~TIM_DIER_COMIE;
+	NVIC_DisableIRQ(pwm_h->cfg->com_irqn);
+	tim->SR = ~TIM_SR_COMIF;			// rc_w0: write 0 clears only COMIF
+
+	// back to direct writes, then restore PWM mode 1 on every configured channel
+	tim->CR2 &= ~(TIM_CR2_CCPC | TIM_CR2_CCUS);
+	tim->SMCR &= ~TIM_SMCR_TS;
+	pwm_config_channels(pwm_h->cfg);
+
+	pwm_h->is_commutation_enabled = false;
+	return true;
+}
+
+bool pwm_tim1_preload_channel_modes(pwm_tim1_handle_t* pwm_h,
+									pwm_tim1_channel_mode_t ch1_mode,
+									pwm_tim1_channel_mode_t ch2_mode,
+									pwm_tim1_channel_mode_t ch3_mode)
+{
+	if ((pwm_h == NULL) || (pwm_h->cfg == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+	if (pwm_h->is_commutation_enabled == false) return false;
+	if ((ch1_mode > PWM_TIM1_CHANNEL_OFF) || (ch2_mode > PWM_TIM1_CHANNEL_OFF) || (ch3_mode > PWM_TIM1_CHANNEL_OFF)) return false;
+
+	const pwm_tim1_cfg_t* pwm_cfg = pwm_h->cfg;
+	uint32_t ccmr1 = tim->CCMR1 & ~(TIM_CCMR1_OC1M | TIM_CCMR1_OC2M);
+	uint32_t ccmr2 = tim->CCMR2 & ~TIM_CCMR2_OC3M;
+	uint32_t ccer = tim->CCER & ~(TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E |
+								   TIM_CCER_CC1NE | TIM_CCER_CC2NE | TIM_CCER_CC3NE);
+
+	// OCxM: PWM1 = 110, forced inactive = 100; OFF keeps PWM1 with both outputs disabled
+	ccmr1 |= (ch1_mode == PWM_TIM1_CHANNEL_LOW) ? TIM_CCMR1_OC1M_2 : (TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2);
+	ccmr1 |= (ch2_mode == PWM_TIM1_CHANNEL_LOW) ? TIM_CCMR1_OC2M_2 : (TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_2);
+	ccmr2 |= (ch3_mode == PWM_TIM1_CHANNEL_LOW) ? TIM_CCMR2_OC3M_2 : (TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3M_2);
+
+	if (ch1_mode != PWM_TIM1_CHANNEL_OFF)
+	{
+		if (pwm_cfg->pin_ch1) ccer |= TIM_CCER_CC1E;
+		if (pwm_cfg->pin_ch1n) ccer |= TIM_CCER_CC1NE;
+	}
+	if (ch2_mode != PWM_TIM1_CHANNEL_OFF)
+	{
+		if (pwm_cfg->pin_ch2) ccer |= TIM_CCER_CC2E;
+		if (pwm_cfg->pin_ch2n) ccer |= TIM_CCER_CC2NE;
+	}
+	if (ch3_mode != PWM_TIM1_CHANNEL_OFF)
+	{
+		if (pwm_cfg->pin_ch3) ccer |= TIM_CCER_CC3E;
+		if (pwm_cfg->pin_ch3n) ccer |= TIM_CCER_CC3NE;
+	}
+
+	// CCPC = 1: these writes land in the preload registers until the next COM event
+	tim->CCMR1 = ccmr1;
+	tim->CCMR2 = ccmr2;
+	tim->CCER = ccer;
+	return true;
+}
+
+bool pwm_tim1_generate_com(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+	if (pwm_h->is_commutation_enabled == false) return false;
+
+	tim->EGR = TIM_EGR_COMG;
+	return true;
+}
+
+bool pwm_tim1_register_com_callback(pwm_tim1_handle_t* pwm_h, pwm_tim1_callback_t callbk, void *callbk_arg)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	// Disable the COM interrupt while the callback pair changes
+	uint32_t dier = tim->DIER;
+	tim->DIER &= ~TIM_DIER_COMIE;
+
+	pwm_h->com_callback = callbk;
+	pwm_h->com_callback_arg = callbk_arg;
+
+	tim->DIER = dier;
+	return true;
+}
+
+bool pwm_tim1_is_update_pending(const pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	return ((tim->SR & TIM_SR_UIF) != 0u);
+}
+
+bool pwm_tim1_enable_update_irq(pwm_tim1_handle_t* pwm_h, uint16_t pwm_periods_per_update)
+{
+	if ((pwm_h == NULL) || (pwm_h->cfg == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+	if ((pwm_periods_per_update == 0u) || (pwm_periods_per_update > PWM_TIM1_MAX_PERIODS_PER_UPDATE)) return false;
+
+	// center-aligned: RCR counts overflow and underflow, RCR = 2*N - 1 keeps one event per N periods
+	tim->RCR = (uint32_t)(2u * pwm_periods_per_update) - 1u;
+
+	// Reload RCR immediately when the counter is stopped, otherwise at the next update event
+	if ((tim->CR1 & TIM_CR1_CEN) == 0u)
+	{
+		tim->EGR = TIM_EGR_UG;
+	}
+
+	// Clear stale flag, set priority and enable update interrupt
+	tim->SR = ~TIM_SR_UIF;				// rc_w0: write 0 clears only UIF
+	NVIC_SetPriority(pwm_h->cfg->update_irqn, pwm_h->cfg->update_irq_priority);
+	NVIC_ClearPendingIRQ(pwm_h->cfg->update_irqn);
+	NVIC_EnableIRQ(pwm_h->cfg->update_irqn);
+	tim->DIER |= TIM_DIER_UIE;
+
+	return true;
+}
+
+bool pwm_tim1_disable_update_irq(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->cfg == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	tim->DIER &= ~TIM_DIER_UIE;
+	NVIC_DisableIRQ(pwm_h->cfg->update_irqn);
+	tim->SR = ~TIM_SR_UIF;				// rc_w0: write 0 clears only UIF
+
+	return true;
+}
+
+bool pwm_tim1_enable_adc_trigger(pwm_tim1_handle_t* pwm_h, uint16_t trigger_ticks)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return false;
+	TIM_TypeDef *tim = pwm_h->inst;
+	if (trigger_ticks > pwm_h->arr) return false;
+
+	// CH4: output compare, PWM mode 2 (OC4M = 111) with preload, CC4E stays 0 (no pin)
+	tim->CCMR2 &= ~(TIM_CCMR2_CC4S | TIM_CCMR2_OC4M | TIM_CCMR2_OC4PE);
+	tim->CCMR2 |= (TIM_CCMR2_OC4M_0 | TIM_CCMR2_OC4M_1 | TIM_CCMR2_OC4M_2);
+	tim->CCMR2 |= TIM_CCMR2_OC4PE;
+	tim->CCR4 = trigger_ticks;
+
+	// Master mode: OC4REF as TRGO (MMS = 111)
+	tim->CR2 &= ~TIM_CR2_MMS;
+	tim->CR2 |= (7u << TIM_CR2_MMS_Pos);
+
+	return true;
+}
+
+uint16_t pwm_tim1_get_ticks_since_update(const pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return 0u;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	uint16_t cnt = (uint16_t)tim->CNT;
+	// center-aligned: DIR = 1 while counting down from ARR (last extreme was the overflow)
+	if (tim->CR1 & TIM_CR1_DIR) return (uint16_t)(pwm_h->arr - cnt);
+	return cnt;
+}
+
+void pwm_tim1_update_irq_handler(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	if (tim->SR & TIM_SR_UIF)
+	{
+		// rc_w0 flag: write 0 to clear
+		tim->SR = ~TIM_SR_UIF;
+		pwm_h->update_event_cnt++;
+
+		// if a callback is registered for the update event, call it
+		if (pwm_h->update_callback) pwm_h->update_callback(pwm_h->update_callback_arg);
+	}
+}
+
+void pwm_tim1_break_irq_handler(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	if ((tim->SR & TIM_SR_BIF) == 0u) return;
+
+	// BIF follows the break input level: mask it, the shutdown itself is latched in MOE
+	tim->DIER &= ~TIM_DIER_BIE;
+	tim->SR = ~TIM_SR_BIF;				// rc_w0: write 0 clears only BIF
+
+	pwm_h->break_latched = true;
+	if (pwm_h->break_callback) pwm_h->break_callback(pwm_h->break_callback_arg);
+}
+
+void pwm_tim1_com_irq_handler(pwm_tim1_handle_t* pwm_h)
+{
+	if ((pwm_h == NULL) || (pwm_h->inst == NULL)) return;
+	TIM_TypeDef *tim = pwm_h->inst;
+
+	if (tim->SR & TIM_SR_COMIF)
+	{
+		// rc_w0 flag: write 0 to clear
+		tim->SR = ~TIM_SR_COMIF;
+		pwm_h->com_event_cnt++;
+
+		// the committed pattern is active: the callback preloads the next one
+		if (pwm_h->com_callback) pwm_h->com_callback(pwm_h->com_callback_arg);
+	}
+}
@@ -0,0 +1,277 @@
+/**
+ * @file scheduler.c
+ * @brief Static task-table cooperative scheduler implementation.
+ *
+ *  Notes:
+ *  - releases are absolute 64-bit microsecond times, so wrap is not a concern.
+ *  - a pass evaluates each task once; catch-up runs spread over later passes
+ *    so one late task does not starve the others.
+ *  - events are taken with one exclusive swap per pass; bits posted during the
+ *    pass are seen by the next one (the sleep check sees them too).
+ */
+
+#include "drivers/scheduler.h"
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+/**
+ * @brief Advance the release of one periodic task after a run.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param task_index Index in the configuration table.
+ * @param now_us Completion time in microseconds.
+ */
+static void scheduler_advance_release(scheduler_handle_t *scheduler_h, uint8_t task_index, uint64_t now_us)
+{
+	const scheduler_task_cfg_t *task = &scheduler_h->cfg->tasks[task_index];
+	scheduler_task_stats_t *stats = &scheduler_h->stats[task_index];
+	uint64_t period_us = (uint64_t)task->period_us;
+	uint64_t next_release_us = scheduler_h->next_release_us[task_index] + period_us;
+
+	if (next_release_us <= now_us)
+	{
+		/* Releases that already passed: keep the grid, drop what is not caught up. */
+		uint64_t pending = ((now_us - next_release_us) / period_us) + 1u;
+		uint64_t dropped = pending;
+
+		if (task->miss_policy == SCHEDULER_MISS_CATCH_UP)
+		{
+			dropped = (pending > SCHEDULER_MAX_CATCH_UP_RELEASES) ? (pending - SCHEDULER_MAX_CATCH_UP_RELEASES) : 0u;
+			/* The next run serves a release that is already due. */
+			stats->catch_up_count++;
+		}
+
+		stats->skip_count += (uint32_t)dropped;
+		next_release_us += dropped * period_us;
+	}
+
+	scheduler_h->next_release_us[task_index] = next_release_us;
+}
+
+/**
+ * @brief Run one task and update its statistics.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @param task_index Index in the configuration table.
+ * @param now_us Pass start time in microseconds.
+ */
+static void scheduler_run_task(scheduler_handle_t *scheduler_h, uint8_t task_index, uint64_t now_us)
+{
+	const scheduler_task_cfg_t *task = &scheduler_h->cfg->tasks[task_index];
+	scheduler_task_stats_t *stats = &scheduler_h->stats[task_index];
+	uint64_t start_us = scheduler_h->cfg->get_time_us();
+
+	task->fn(task->arg, now_us);
+
+	uint64_t end_us = scheduler_h->cfg->get_time_us();
+	uint32_t exec_us = (uint32_t)(end_us - start_us);
+
+	stats->run_count++;
+	stats->last_exec_us = exec_us;
+	if (exec_us > stats->max_exec_us) stats->max_exec_us = exec_us;
+
+	if (task->period_us == 0u) return;
+
+	/* Deadline is measured from the release, so queueing delay counts too. */
+	uint64_t release_us = scheduler_h->next_release_us[task_index];
+	uint32_t deadline_us = (task->deadline_us != 0u) ? task->deadline_us : task->period_us;
+
+	if ((end_us - release_us) > (uint64_t)deadline_us) stats->overrun_count++;
+
+	scheduler_advance_release(scheduler_h, task_index, end_us);
+}
+
+/**
+ * @brief Take and clear every pending event bit.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @return Event bits posted since the previous take.
+ */
+static uint32_t scheduler_take_events(scheduler_handle_t *scheduler_h)
+{
+	uint32_t events = 0u;
+
+	do
+	{
+		events = __LDREXW(&scheduler_h->pending_events);
+	} while (__STREXW(0u, &scheduler_h->pending_events) != 0u);
+
+	return events;
+}
+
+/**
+ * @brief Sleep until the next interrupt unless an event is already pending.
+ *
+ * @param scheduler_h Pointer to scheduler handle.
+ * @return Time of the wake-up (before the waking ISR ran) in microseconds.
+ */
+static uint64_t scheduler_idle_sleep(scheduler_handle_t *scheduler_h)
+{
+	const scheduler_cfg_t *cfg = scheduler_h->cfg;
+	uint64_t wake_us = 0u;
+
+	/* PRIMASK: a pending IRQ still ends WFI, its handler runs after the wake time is read. */
+	__disable_irq();
+	if (scheduler_h->pending_events == 0u)
+	{
+		__WFI();
+		scheduler_h->sleep_count++;
+	}
+	wake_us = cfg->get_time_us();
+	__enable_irq();
+
+	return wake_us;
+}
+
+bool scheduler_init(scheduler_handle_t *scheduler_h, const scheduler_cfg_t *scheduler_cfg)
+{
+	if ((scheduler_h == NULL) || (scheduler_cfg == NULL)) return false;
+	if ((scheduler_cfg->tasks == NULL) || (scheduler_cfg->get_time_us == NULL)) return false;
+	if ((scheduler_cfg->task_count == 0u) || (scheduler_cfg->task_count > SCHEDULER_MAX_TASKS)) return false;
+	for (uint8_t i = 0u; i < scheduler_cfg->task_count; i++)
+	{
+		if (scheduler_cfg->tasks[i].fn == NULL) return false;
+		if ((scheduler_cfg->tasks[i].period_us == 0u) && (scheduler_cfg->tasks[i].phase_us != 0u)) return false;
+		if ((scheduler_cfg->tasks[i].period_us != 0u) && (scheduler_cfg->tasks[i].event_mask != 0u)) return false;
+	}
+
+	/* Stable insertion sort: equal priorities keep their table order. */
+	for (uint8_t i = 0u; i < scheduler_cfg->task_count; i++)
+	{
+		uint8_t j = i;
+
+		while ((j > 0u) &&
+			   (scheduler_cfg->tasks[scheduler_h->run_order[j - 1u]].priority > scheduler_cfg->tasks[i].priority))
+		{
+			scheduler_h->run_order[j] = scheduler_h->run_order[j - 1u];
+			j--;
+		}
+		scheduler_h->run_order[j] = i;
+	}
+
+	scheduler_h->cfg = scheduler_cfg;
+	scheduler_h->is_started = false;
+	scheduler_h->is_initialized = true;
+
+	return true;
+}
+
+bool scheduler_start(scheduler_handle_t *scheduler_h, uint64_t start_us)
+{
+	if ((scheduler_h == NULL) || (scheduler_h->is_initialized == false)) return false;
+
+	for (uint8_t i = 0u; i < scheduler_h->cfg->task_count; i++)
+	{
+		scheduler_h->next_release_us[i] = start_us + (uint64_t)scheduler_h->cfg->tasks[i].phase_us;
+		scheduler_h->stats[i] = (scheduler_task_stats_t){0};
+	}
+	scheduler_h->pass_count = 0u;
+	scheduler_h->idle_count = 0u;
+	scheduler_h->pending_events = 0u;
+	scheduler_h->idle_us = 0u;
+	scheduler_h->sleep_count = 0u;
+	scheduler_h->load_window_start_us = start_us;
+	scheduler_h->load_window_idle_us = 0u;
+	scheduler_h->load_window_pass_count = 0u;
+	scheduler_h->load_window_sleep_count = 0u;
+	scheduler_h->is_started = true;
+
+	return true;
+}
+
+bool scheduler_run_pass(scheduler_handle_t *scheduler_h)
+{
+	if ((scheduler_h == NULL) || (scheduler_h->is_started == false)) return false;
+
+	const scheduler_cfg_t *cfg = scheduler_h->cfg;
+	uint64_t now_us = cfg->get_time_us();
+	uint32_t events = scheduler_take_events(scheduler_h);
+	bool released = false;
+
+	for (uint8_t order = 0u; order < cfg->task_count; order++)
+	{
+		uint8_t task_index = scheduler_h->run_order[order];
+		const scheduler_task_cfg_t *task = &cfg->tasks[task_index];
+
+		if (task->period_us != 0u)
+		{
+			if (now_us < scheduler_h->next_release_us[task_index]) continue;
+			released = true;
+		}
+		else if (task->event_mask != 0u)
+		{
+			if ((events & task->event_mask) == 0u) continue;
+			released = true;
+		}
+
+		scheduler_run_task(scheduler_h, task_index, now_us);
+	}
+
+	scheduler_h->pass_count++;
+	if (released == false)
+	{
+		/* Background tasks ran in this pass too: idle starts after them. */
+		uint64_t idle_start_us = cfg->get_time_us();
+		uint64_t end_us = 0u;
+
+		scheduler_h->idle_count++;
+		/* Any enabled interrupt (SysTick at the latest) ends the sleep. */
+		end_us = (cfg->idle_wfi) ? scheduler_idle_sleep(scheduler_h) : cfg->get_time_us();
+		scheduler_h->idle_us += end_us - idle_start_us;
+	}
+
+	return true;
+}
+
+bool scheduler_post_event(scheduler_handle_t *scheduler_h, uint32_t events)
+{
+	uint32_t pending = 0u;
+
+	if (scheduler_h == NULL) return false;
+
+	do
+	{
+		pending = __LDREXW(&scheduler_h->pending_events);
+	} while (__STREXW(pending | events, &scheduler_h->pending_events) != 0u);
+
+	return true;
+}
+
+bool scheduler_get_load(scheduler_handle_t *scheduler_h, scheduler_load_t *load)
+{
+	if ((scheduler_h == NULL) || (load == NULL)) return false;
+	if (scheduler_h->is_started == false) return false;
+
+	uint64_t now_us = scheduler_h->cfg->get_time_us();
+	uint64_t window_us = now_us - scheduler_h->load_window_start_us;
+	uint64_t idle_us = scheduler_h->idle_us - scheduler_h->load_window_idle_us;
+
+	if (window_us == 0u) return false;
+	if (idle_us > window_us) idle_us = window_us;
+
+	load->window_us = (window_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)window_us;
+	load->idle_us = (idle_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)idle_us;
+	load->load_permyriad = (uint16_t)(((window_us - idle_us) * 10000u) / window_us);
+	load->pass_count = scheduler_h->pass_count - scheduler_h->load_window_pass_count;
+	load->sleep_count = scheduler_h->sleep_count - scheduler_h->load_window_sleep_count;
+
+	scheduler_h->load_window_start_us = now_us;
+	scheduler_h->load_window_idle_us = scheduler_h->idle_us;
+	scheduler_h->load_window_pass_count = scheduler_h->pass_count;
+	scheduler_h->load_window_sleep_count = scheduler_h->sleep_count;
+
+	return true;
+}
+
+bool scheduler_get_task_stats(const scheduler_handle_t *scheduler_h,
+							  uint8_t task_index,
+							  scheduler_task_stats_t *stats)
+{
+	if ((scheduler_h == NULL) || (stats == NULL)) return false;
+	if (scheduler_h->is_initialized == false) return false;
+	if (task_index >= scheduler_h->cfg->task_count) return false;
+
+	*stats = scheduler_h->stats[task_index];
+
+	return true;
+}
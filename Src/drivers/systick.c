@@ -12,6 +12,8 @@
 static const systick_cfg_t    *s_cfg  = NULL;
 static systick_handle_t       *s_h    = NULL;
 static uint32_t               s_load = 0;
+static uint32_t               s_ms_per_tick = 0;   // 0 if tick period is not a whole number of ms
+static const tim5_timebase_handle_t *s_timebase_h = NULL;
 
 
 /**
@@ -28,10 +30,17 @@ bool SYSTICK_Init(const systick_cfg_t *systick_cfg, systick_handle_t* systick_h)
   if ((systick_cfg == NULL)||(systick_h == NULL)) return false;
   if (systick_cfg->sysclk_hz == 0u) return false;
   if (systick_cfg->tick_period_us == 0u) return false;
+  if (systick_cfg->timebase_h != NULL)
+  {
+    if (systick_cfg->timebase_h->is_initialized == false) return false;
+    if (systick_cfg->timebase_h->cfg->tick_hz != SYSTICK_TIMEBASE_TICK_HZ) return false;
+  }
 
   s_cfg = systick_cfg;
   s_h   = systick_h;
   s_h->tick_count = 0u;
+  s_timebase_h = systick_cfg->timebase_h;
+  s_ms_per_tick = ((systick_cfg->tick_period_us % 1000u) == 0u) ? (systick_cfg->tick_period_us / 1000u) : 0u;
 
   /* Compute cycles per tick (use 64-bit to avoid overflow). */
   const uint64_t cycles_per_tick = ((uint64_t)s_cfg->sysclk_hz * (uint64_t)s_cfg->tick_period_us) / 1000000ull;
@@ -94,6 +103,10 @@ uint32_t SYSTICK_GetTick(void)
 uint32_t SYSTICK_GetTimeMs(void)
 {
   if (!s_cfg || !s_h) return 0u;
+
+  /* Whole-ms tick periods (default 1 ms) need no 64-bit arithmetic */
+  if (s_ms_per_tick != 0u) return s_h->tick_count * s_ms_per_tick;
+
   const uint64_t total_us = (uint64_t)s_h->tick_count * (uint64_t)s_cfg->tick_period_us;
   return (uint32_t)(total_us / 1000ull);
 }
@@ -103,6 +116,9 @@ uint32_t SYSTICK_GetTimeMs(void)
  *
  * Combines the tick counter with the current SysTick down-counter value.
  * Uses bounded retries to reduce mixing across the tick boundary.
+ * A pending SysTick is counted, so the timestamp stays monotonic when called
+ * from interrupts that preempt SysTick_Handler().
+ * With an attached timebase this reads the 64-bit TIM5 timestamp instead.
  *
  * @return Microseconds timestamp (best-effort).
  */
@@ -110,20 +126,28 @@ uint64_t SYSTICK_GetTimeUs(void)
 {
   if (!s_cfg || !s_h) return 0ull;
 
+  /* TIM5 at 1 MHz: the counter already is the timestamp */
+  if (s_timebase_h != NULL) return tim5_timebase_now64(s_timebase_h);
+
   /* Double-sample tick counter around VAL to avoid rollover mixing with bounded retries. */
   for (uint32_t i = 0u; i < 3u; ++i)
   {
     const uint32_t t1  = s_h->tick_count;
+    const uint32_t pend1 = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
     const uint32_t val = SysTick->VAL;
+    const uint32_t pend2 = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
     const uint32_t t2  = s_h->tick_count;
 
-    if (t1 == t2)
+    if ((t1 == t2) && (pend1 == pend2))
     {
       /* Compute elapsed cycles within the current tick */
       const uint32_t elapsed_cycles = (s_load - val);
       const uint64_t us_in_tick = ((uint64_t)elapsed_cycles * 1000000ull) / (uint64_t)s_cfg->sysclk_hz;
 
-      return ((uint64_t)t1 * (uint64_t)s_cfg->tick_period_us) + us_in_tick;
+      /* Called from an ISR above SysTick priority: a pending tick is not counted yet, VAL already reloaded. */
+      const uint32_t ticks = (pend2 != 0u) ? (t1 + 1u) : t1;
+
+      return ((uint64_t)ticks * (uint64_t)s_cfg->tick_period_us) + us_in_tick;
     }
   }
 
@@ -0,0 +1,137 @@
+/**
+ * @file telemetry.c
+ * @brief Compact binary telemetry frame implementation.
+ *
+ * Little-endian packing, nibble-table CRC-16/CCITT-FALSE and whole-frame
+ * queueing into the USART2 TX ring buffer.
+ */
+
+#include "drivers/telemetry.h"
+
+#define TELEMETRY_FRAME_SEQUENCE_OFFSET 2u
+
+/* CRC-16/CCITT-FALSE nibble table: 32 bytes instead of a 512-byte byte table. */
+static const uint16_t telemetry_crc16_nibble_table[16] = {
+	0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+	0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu,
+};
+
+/**
+ * @brief Append raw bytes to the frame payload, flag overflow instead of writing past the end.
+ *
+ * @param frame Pointer to frame buffer.
+ * @param value Little-endian value bits.
+ * @param size Number of bytes to append (1..4).
+ */
+static void telemetry_frame_put_le(telemetry_frame_t *frame, uint32_t value, uint16_t size)
+{
+	uint16_t i = 0u;
+
+	if (frame == NULL) return;
+	if ((frame->length + size) > (TELEMETRY_FRAME_HEADER_SIZE + TELEMETRY_FRAME_MAX_PAYLOAD))
+	{
+		frame->overflow = true;
+		return;
+	}
+
+	for (i = 0u; i < size; i++)
+	{
+		frame->bytes[frame->length++] = (uint8_t)(value >> (8u * i));
+	}
+}
+
+bool telemetry_init(telemetry_handle_t *telemetry_h, const telemetry_cfg_t *telemetry_cfg)
+{
+	if ((telemetry_h == NULL) || (telemetry_cfg == NULL)) return false;
+	if (telemetry_cfg->usart_h == NULL) return false;
+
+	telemetry_h->cfg = telemetry_cfg;
+	telemetry_h->sequence = 0u;
+	telemetry_h->frames_sent = 0u;
+	telemetry_h->frames_dropped = 0u;
+	telemetry_h->is_initialized = true;
+
+	return true;
+}
+
+void telemetry_frame_begin(telemetry_frame_t *frame, uint8_t frame_type, uint32_t timestamp_us)
+{
+	if (frame == NULL) return;
+
+	frame->length = 0u;
+	frame->overflow = false;
+	frame->bytes[frame->length++] = TELEMETRY_FRAME_SYNC;
+	frame->bytes[frame->length++] = frame_type;
+	frame->bytes[frame->length++] = 0u;		/* Sequence number is stamped in telemetry_send(). */
+	telemetry_frame_put_le(frame, timestamp_us, 4u);
+}
+
+void telemetry_frame_put_u8(telemetry_frame_t *frame, uint8_t value)
+{
+	telemetry_frame_put_le(frame, (uint32_t)value, 1u);
+}
+
+void telemetry_frame_put_u16(telemetry_frame_t *frame, uint16_t value)
+{
+	telemetry_frame_put_le(frame, (uint32_t)value, 2u);
+}
+
+void telemetry_frame_put_i16(telemetry_frame_t *frame, int16_t value)
+{
+	telemetry_frame_put_le(frame, (uint32_t)(uint16_t)value, 2u);
+}
+
+void telemetry_frame_put_u32(telemetry_frame_t *frame, uint32_t value)
+{
+	telemetry_frame_put_le(frame, value, 4u);
+}
+
+void telemetry_frame_put_i32(telemetry_frame_t *frame, int32_t value)
+{
+	telemetry_frame_put_le(frame, (uint32_t)value, 4u);
+}
+
+bool telemetry_send(telemetry_handle_t *telemetry_h, telemetry_frame_t *frame)
+{
+	uint16_t crc = 0u;
+
+	if ((telemetry_h == NULL) || (frame == NULL)) return false;
+	if ((telemetry_h->cfg == NULL) || (telemetry_h->is_initialized == false)) return false;
+	if ((frame->overflow == true) || (frame->length < TELEMETRY_FRAME_HEADER_SIZE)) return false;
+
+	/* Queue whole frames only; a partial frame would cost more than a sequence gap. */
+	if (usart2_tx_free_space(telemetry_h->cfg->usart_h) < ((size_t)frame->length + TELEMETRY_FRAME_CRC_SIZE))
+	{
+		telemetry_h->frames_dropped++;
+		telemetry_h->sequence++;
+		return false;
+	}
+
+	/* Stamp sequence number, then protect everything after the sync byte. */
+	frame->bytes[TELEMETRY_FRAME_SEQUENCE_OFFSET] = telemetry_h->sequence++;
+	crc = telemetry_crc16(&frame->bytes[1u], (size_t)frame->length - 1u);
+	frame->bytes[frame->length++] = (uint8_t)(crc & 0xFFu);
+	frame->bytes[frame->length++] = (uint8_t)(crc >> 8u);
+
+	(void)usart2_write(telemetry_h->cfg->usart_h, frame->bytes, frame->length);
+	telemetry_h->frames_sent++;
+
+	return true;
+}
+
+uint16_t telemetry_crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFFu;
+	size_t i = 0u;
+
+	if (data == NULL) return crc;
+
+	for (i = 0u; i < len; i++)
+	{
+		/* Process high nibble first, then low nibble (MSB-first CRC). */
+		crc = (uint16_t)((crc << 4u) ^ telemetry_crc16_nibble_table[(crc >> 12u) ^ (data[i] >> 4u)]);
+		crc = (uint16_t)((crc << 4u) ^ telemetry_crc16_nibble_table[(crc >> 12u) ^ (data[i] & 0x0Fu)]);
+	}
+
+	return crc;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file telemetry_stream.c
+ * @brief Multi-rate telemetry channel snapshots and frame encoding.
+ *
+ *  Notes:
+ *  - the snapshot slots alternate with the publish sequence (as the AS5600
+ *    sample publication); a reader that sees the sequence move by two or
+ *    more during its copy retries.
+ *  - every channel is read on each sample so the snapshot stays complete for
+ *    readers that need more than the due set (text telemetry).
+ */
+
+#include "drivers/telemetry_stream.h"
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+#define TELEMETRY_STREAM_READ_RETRIES       3u
+
+/**
+ * @brief Return the wire width of one channel type in bytes.
+ *
+ * @param type Channel type.
+ * @return Width in bytes, 0 for an unknown type.
+ */
+static uint16_t telemetry_stream_type_size(telemetry_stream_type_t type)
+{
+	switch (type)
+	{
+		case TELEMETRY_STREAM_TYPE_U8:  return 1u;
+		case TELEMETRY_STREAM_TYPE_U16: return 2u;
+		case TELEMETRY_STREAM_TYPE_I16: return 2u;
+		case TELEMETRY_STREAM_TYPE_I32: return 4u;
+		default:                        return 0u;
+	}
+}
+
+/**
+ * @brief Read, scale and saturate one channel.
+ *
+ * @param channel Registered channel.
+ * @return Value in the range of the channel type.
+ */
+static int32_t telemetry_stream_read_channel(const telemetry_stream_channel_t *channel)
+{
+	int64_t value = 0;
+	int64_t min_value = INT32_MIN;
+	int64_t max_value = INT32_MAX;
+
+	switch (channel->type)
+	{
+		case TELEMETRY_STREAM_TYPE_U8:
+			value = *(const volatile uint8_t *)channel->source;
+			min_value = 0;
+			max_value = UINT8_MAX;
+			break;
+		case TELEMETRY_STREAM_TYPE_U16:
+			value = *(const volatile uint16_t *)channel->source;
+			min_value = 0;
+			max_value = UINT16_MAX;
+			break;
+		case TELEMETRY_STREAM_TYPE_I16:
+			value = *(const volatile int16_t *)channel->source;
+			min_value = INT16_MIN;
+			max_value = INT16_MAX;
+			break;
+		case TELEMETRY_STREAM_TYPE_I32:
+		default:
+			value = *(const volatile int32_t *)channel->source;
+			break;
+	}
+
+	if (channel->scale_q16 == TELEMETRY_STREAM_SCALE_UNITY_Q16) return (int32_t)value;
+
+	value = (value * channel->scale_q16) / TELEMETRY_STREAM_SCALE_UNITY_Q16;
+	if (value < min_value) value = min_value;
+	if (value > max_value) value = max_value;
+
+	return (int32_t)value;
+}
+
+bool telemetry_stream_init(telemetry_stream_handle_t *telemetry_stream_h,
+						   const telemetry_stream_cfg_t *telemetry_stream_cfg)
+{
+	uint32_t payload_size = TELEMETRY_STREAM_MASK_SIZE;
+
+	if ((telemetry_stream_h == NULL) || (telemetry_stream_cfg == NULL)) return false;
+	if (telemetry_stream_cfg->channels == NULL) return false;
+	if ((telemetry_stream_cfg->channel_count == 0u) ||
+		(telemetry_stream_cfg->channel_count > TELEMETRY_STREAM_MAX_CHANNELS))
+	{
+		return false;
+	}
+	for (uint8_t i = 0u; i < telemetry_stream_cfg->channel_count; i++)
+	{
+		const telemetry_stream_channel_t *channel = &telemetry_stream_cfg->channels[i];
+		uint16_t size = telemetry_stream_type_size(channel->type);
+
+		if ((channel->source == NULL) || (size == 0u)) return false;
+		payload_size += size;
+	}
+	/* A snapshot with every channel due must fit one frame. */
+	if (payload_size > TELEMETRY_FRAME_MAX_PAYLOAD) return false;
+
+	*telemetry_stream_h = (telemetry_stream_handle_t){0};
+	telemetry_stream_h->cfg = telemetry_stream_cfg;
+	telemetry_stream_h->channel_mask = (uint16_t)((1u << telemetry_stream_cfg->channel_count) - 1u);
+	for (uint8_t i = 0u; i < telemetry_stream_cfg->channel_count; i++)
+	{
+		telemetry_stream_h->decimation[i] = 1u;
+	}
+	telemetry_stream_h->is_initialized = true;
+
+	return true;
+}
+
+bool telemetry_stream_set_mask(telemetry_stream_handle_t *telemetry_stream_h, uint16_t channel_mask)
+{
+	if ((telemetry_stream_h == NULL) || (telemetry_stream_h->is_initialized == false)) return false;
+	if ((channel_mask >> telemetry_stream_h->cfg->channel_count) != 0u) return false;
+
+	telemetry_stream_h->channel_mask = channel_mask;
+
+	return true;
+}
+
+bool telemetry_stream_set_decimation(telemetry_stream_handle_t *telemetry_stream_h,
+									 uint8_t channel_index,
+									 uint16_t decimation)
+{
+	if ((telemetry_stream_h == NULL) || (telemetry_stream_h->is_initialized == false)) return false;
+	if (channel_index >= telemetry_stream_h->cfg->channel_count) return false;
+	if (decimation == 0u) return false;
+
+	/* The sampling context restarts the channel count on its next call (counter >= decimation). */
+	telemetry_stream_h->decimation[channel_index] = decimation;
+
+	return true;
+}
+
+bool telemetry_stream_sample(telemetry_stream_handle_t *telemetry_stream_h, uint32_t timestamp_us)
+{
+	if ((telemetry_stream_h == NULL) || (telemetry_stream_h->is_initialized == false)) return false;
+
+	const telemetry_stream_cfg_t *cfg = telemetry_stream_h->cfg;
+	uint16_t channel_mask = telemetry_stream_h->channel_mask;
+	uint32_t sequence = telemetry_stream_h->publish_sequence + 1u;
+	uint16_t due_mask = 0u;
+
+	/* Skip 0 (nothing published) and keep alternating slots across the wrap. */
+	if (sequence == 0u) sequence = 2u;
+
+	volatile telemetry_stream_snapshot_t *slot = &telemetry_stream_h->snapshots[sequence & 1u];
+	for (uint8_t i = 0u; i < cfg->channel_count; i++)
+	{
+		slot->values[i] = telemetry_stream_read_channel(&cfg->channels[i]);
+
+		/* Due on the first sample and then every decimation samples. */
+		if (telemetry_stream_h->decimation_count[i] == 0u)
+		{
+			due_mask |= (uint16_t)(1u << i);
+		}
+		if (++telemetry_stream_h->decimation_count[i] >= telemetry_stream_h->decimation[i])
+		{
+			telemetry_stream_h->decimation_count[i] = 0u;
+		}
+	}
+	slot->timestamp_us = timestamp_us;
+	slot->sample_index = telemetry_stream_h->sample_count++;
+	slot->due_mask = due_mask & channel_mask;
+
+	/* Slot contents must be visible before the new sequence. */
+	__DMB();
+	telemetry_stream_h->publish_sequence = sequence;
+
+	return true;
+}
+
+bool telemetry_stream_get_snapshot(const telemetry_stream_handle_t *telemetry_stream_h,
+								   telemetry_stream_snapshot_t *snapshot)
+{
+	if ((telemetry_stream_h == NULL) || (snapshot == NULL)) return false;
+	if (telemetry_stream_h->is_initialized == false) return false;
+
+	for (uint32_t attempt = 0u; attempt < TELEMETRY_STREAM_READ_RETRIES; attempt++)
+	{
+		uint32_t sequence = telemetry_stream_h->publish_sequence;
+
+		if (sequence == 0u) return false;
+
+		__DMB();
+		const volatile telemetry_stream_snapshot_t *slot = &telemetry_stream_h->snapshots[sequence & 1u];
+		snapshot->timestamp_us = slot->timestamp_us;
+		snapshot->sample_index = slot->sample_index;
+		snapshot->due_mask = slot->due_mask;
+		for (uint8_t i = 0u; i < telemetry_stream_h->cfg->channel_count; i++)
+		{
+			snapshot->values[i] = slot->values[i];
+		}
+		__DMB();
+
+		/* One newer publish wrote the other slot; two or more may have rewritten this one. */
+		if ((uint32_t)(telemetry_stream_h->publish_sequence - sequence) < 2u)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool telemetry_stream_encode(telemetry_stream_handle_t *telemetry_stream_h, telemetry_frame_t *frame)
+{
+	telemetry_stream_snapshot_t snapshot;
+
+	if ((telemetry_stream_h == NULL) || (frame == NULL)) return false;
+	if (!telemetry_stream_get_snapshot(telemetry_stream_h, &snapshot)) return false;
+
+	const telemetry_stream_cfg_t *cfg = telemetry_stream_h->cfg;
+	uint32_t sample_count = snapshot.sample_index + 1u;
+
+	if (sample_count == telemetry_stream_h->encoded_sample_count) return false;
+	/* Samples between the last encoded one and this one were replaced unread. */
+	if ((telemetry_stream_h->encoded_sample_count != 0u) &&
+		((sample_count - telemetry_stream_h->encoded_sample_count) > 1u))
+	{
+		telemetry_stream_h->replaced_count += sample_count - telemetry_stream_h->encoded_sample_count - 1u;
+	}
+	telemetry_stream_h->encoded_sample_count = sample_count;
+	if (snapshot.due_mask == 0u) return false;
+
+	telemetry_frame_begin(frame, cfg->frame_type, snapshot.timestamp_us);
+	telemetry_frame_put_u16(frame, snapshot.due_mask);
+	for (uint8_t i = 0u; i < cfg->channel_count; i++)
+	{
+		if ((snapshot.due_mask & (1u << i)) == 0u) continue;
+
+		switch (cfg->channels[i].type)
+		{
+			case TELEMETRY_STREAM_TYPE_U8:  telemetry_frame_put_u8(frame, (uint8_t)snapshot.values[i]); break;
+			case TELEMETRY_STREAM_TYPE_U16: telemetry_frame_put_u16(frame, (uint16_t)snapshot.values[i]); break;
+			case TELEMETRY_STREAM_TYPE_I16: telemetry_frame_put_i16(frame, (int16_t)snapshot.values[i]); break;
+			case TELEMETRY_STREAM_TYPE_I32:
+			default:                        telemetry_frame_put_i32(frame, snapshot.values[i]); break;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file tim2_trigger.c
+ * @brief TIM2 trigger divider implementation (STM32F4, CMSIS only).
+ *
+ * External clock mode 1 from ITRx, TRGO on update.
+ */
+
+#include "drivers/tim2_trigger.h"
+
+bool tim2_trigger_init(tim2_trigger_handle_t *tim2_trigger_h, const tim2_trigger_cfg_t *tim2_trigger_cfg)
+{
+	if ((tim2_trigger_h == NULL) || (tim2_trigger_cfg == NULL)) return false;
+	if (tim2_trigger_cfg->events_per_trigger == 0u) return false;
+
+	/* Enable clock for TIM2 */
+	RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+
+	/* Disable counter before configuration */
+	TIM2->CR1 &= ~TIM_CR1_CEN;
+
+	/* One count per input edge, overflow after events_per_trigger edges */
+	TIM2->PSC = 0u;
+	TIM2->ARR = tim2_trigger_cfg->events_per_trigger - 1u;
+	TIM2->CNT = 0u;
+
+	/* Slave mode: external clock mode 1 (SMS = 111) from the selected ITRx */
+	TIM2->SMCR &= ~(TIM_SMCR_SMS | TIM_SMCR_TS);
+	TIM2->SMCR |= ((uint32_t)tim2_trigger_cfg->input << TIM_SMCR_TS_Pos);
+	TIM2->SMCR |= (7u << TIM_SMCR_SMS_Pos);
+
+	/* Master mode: update event as TRGO (MMS = 010) */
+	TIM2->CR2 &= ~TIM_CR2_MMS;
+	TIM2->CR2 |= (2u << TIM_CR2_MMS_Pos);
+
+	/* Load PSC/ARR; the UG pulse also reaches TRGO, so init before arming the ADC trigger */
+	TIM2->EGR = TIM_EGR_UG;
+	TIM2->SR = 0u;
+
+	tim2_trigger_h->cfg = tim2_trigger_cfg;
+	tim2_trigger_h->is_initialized = true;
+
+	return true;
+}
+
+bool tim2_trigger_start(tim2_trigger_handle_t *tim2_trigger_h)
+{
+	if ((tim2_trigger_h == NULL) || (tim2_trigger_h->is_initialized == false)) return false;
+
+	TIM2->CR1 |= TIM_CR1_CEN;
+
+	return true;
+}
+
+bool tim2_trigger_stop(tim2_trigger_handle_t *tim2_trigger_h)
+{
+	if ((tim2_trigger_h == NULL) || (tim2_trigger_h->is_initialized == false)) return false;
+
+	TIM2->CR1 &= ~TIM_CR1_CEN;
+
+	return true;
+}
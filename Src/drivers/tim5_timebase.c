@@ -0,0 +1,82 @@
+/**
+ * @file tim5_timebase.c
+ * @brief TIM5 free-running timebase implementation (STM32F4, CMSIS only).
+ *
+ * Up-counting over the full 32-bit range, update interrupt on overflow only.
+ */
+
+#include "drivers/tim5_timebase.h"
+
+bool tim5_timebase_init(tim5_timebase_handle_t *tim5_timebase_h, const tim5_timebase_cfg_t *tim5_timebase_cfg)
+{
+	if ((tim5_timebase_h == NULL) || (tim5_timebase_cfg == NULL)) return false;
+	if ((tim5_timebase_cfg->tick_hz == 0u) || (tim5_timebase_cfg->tim_clk_hz == 0u)) return false;
+	if ((tim5_timebase_cfg->tim_clk_hz % tim5_timebase_cfg->tick_hz) != 0u) return false;
+	// 0 would leave the overflow update unmasked; a lock below the own level protects nothing
+	if ((tim5_timebase_cfg->lock_prio == 0u) || (tim5_timebase_cfg->lock_prio > tim5_timebase_cfg->irq_prio)) return false;
+
+	uint32_t psc = (tim5_timebase_cfg->tim_clk_hz / tim5_timebase_cfg->tick_hz) - 1u;
+	if (psc > 0xFFFFu) return false;
+
+	/* Enable clock for TIM5 */
+	RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;
+	(void)RCC->APB1ENR;
+
+	/* Disable counter before configuration */
+	TIM5->CR1 &= ~TIM_CR1_CEN;
+
+	/* Up-counting, full 32-bit range, update event from overflow only (URS) */
+	TIM5->CR1 &= ~(TIM_CR1_DIR | TIM_CR1_CMS);
+	TIM5->CR1 |= TIM_CR1_URS;
+	TIM5->PSC = psc;
+	TIM5->ARR = 0xFFFFFFFFu;
+
+	/* Load PSC, then clear the UG flag so it is not counted as overflow */
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = 0u;
+	TIM5->CNT = 0u;
+
+	tim5_timebase_h->overflow_count = 0u;
+	tim5_timebase_h->cfg = tim5_timebase_cfg;
+
+	/* Overflow interrupt */
+	TIM5->DIER |= TIM_DIER_UIE;
+	NVIC_SetPriority(TIM5_IRQn, tim5_timebase_cfg->irq_prio);
+	NVIC_EnableIRQ(TIM5_IRQn);
+
+	TIM5->CR1 |= TIM_CR1_CEN;
+	tim5_timebase_h->is_initialized = true;
+
+	return true;
+}
+
+bool tim5_timebase_enable_trigger_output(tim5_timebase_handle_t *tim5_timebase_h)
+{
+	if ((tim5_timebase_h == NULL) || (tim5_timebase_h->is_initialized == false)) return false;
+
+	/* CH1 output compare, frozen mode, no preload: CCR1 writes take effect at once */
+	TIM5->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE);
+	tim5_timebase_disarm_trigger();
+
+	/* MMS = 011: compare pulse on TRGO when CC1IF is set */
+	TIM5->CR2 = (TIM5->CR2 & ~TIM_CR2_MMS) | (TIM_CR2_MMS_0 | TIM_CR2_MMS_1);
+
+	return true;
+}
+
+void tim5_timebase_irq_handler(tim5_timebase_handle_t *tim5_timebase_h)
+{
+	if ((TIM5->SR & TIM_SR_UIF) == 0u) return;
+
+	if (tim5_timebase_h == NULL)
+	{
+		TIM5->SR = ~TIM_SR_UIF;
+		return;
+	}
+
+	// flag clear and count must look atomic to readers in higher-priority ISRs (up to lock_prio)
+	uint32_t lock = irq_lock_raise(tim5_timebase_h->cfg->lock_prio);
+	TIM5->SR = ~TIM_SR_UIF;
+	tim5_timebase_h->overflow_count++;
+	irq_lock_restore(lock);
+}
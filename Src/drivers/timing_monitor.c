@@ -0,0 +1,159 @@
+/**
+ * @file timing_monitor.c
+ * @brief Control-loop timing-health monitor implementation.
+ *
+ *  Notes:
+ *  - one record is a divide by the bin width, a few compares and increments.
+ *  - get_stats masks IRQs (BASEPRI, up to IRQ_LOCK_PRIORITY_TIMING_MONITOR)
+ *    only for the copy of one channel.
+ *  - the violation keeps the first late run; statistics keep counting.
+ */
+
+#include "drivers/timing_monitor.h"
+#include <stddef.h>
+#include "drivers/irq_lock.h"
+#include "config/irq_priority_config.h"
+
+/**
+ * @brief Add one sample to the histogram and the late accounting of one channel.
+ *
+ * @param timing_monitor_h Pointer to timing-monitor handle.
+ * @param channel Channel identifier.
+ * @param value_us Jitter (period channel) or delay (latency channel) in microseconds.
+ */
+static void timing_monitor_add_sample(timing_monitor_handle_t *timing_monitor_h,
+									  timing_monitor_channel_t channel,
+									  uint32_t value_us)
+{
+	const timing_monitor_channel_cfg_t *channel_cfg = &timing_monitor_h->cfg->channels[channel];
+	timing_monitor_channel_stats_t *stats = &timing_monitor_h->stats[channel];
+	uint32_t bin = value_us / channel_cfg->bin_width_us;
+
+	if (bin >= TIMING_MONITOR_BIN_COUNT) bin = TIMING_MONITOR_BIN_COUNT - 1u;
+	stats->bins[bin]++;
+	stats->sample_count++;
+	if (value_us > stats->max_us) stats->max_us = value_us;
+
+	if (value_us <= channel_cfg->late_limit_us)
+	{
+		timing_monitor_h->consecutive_late_count[channel] = 0u;
+		return;
+	}
+
+	stats->late_count++;
+	if (timing_monitor_h->consecutive_late_count[channel] < UINT16_MAX)
+	{
+		timing_monitor_h->consecutive_late_count[channel]++;
+	}
+	if ((channel_cfg->fault_late_count != 0u) &&
+		(timing_monitor_h->consecutive_late_count[channel] >= channel_cfg->fault_late_count) &&
+		(timing_monitor_h->is_violated == false))
+	{
+		timing_monitor_h->violation_channel = (uint8_t)channel;
+		timing_monitor_h->violation_value_us = value_us;
+		timing_monitor_h->is_violated = true;
+	}
+}
+
+bool timing_monitor_init(timing_monitor_handle_t *timing_monitor_h, const timing_monitor_cfg_t *timing_monitor_cfg)
+{
+	if ((timing_monitor_h == NULL) || (timing_monitor_cfg == NULL)) return false;
+	for (uint32_t i = 0u; i < (uint32_t)TIMING_MONITOR_CHANNEL_COUNT; i++)
+	{
+		if (timing_monitor_cfg->channels[i].bin_width_us == 0u) return false;
+	}
+
+	*timing_monitor_h = (timing_monitor_handle_t){0};
+	timing_monitor_h->cfg = timing_monitor_cfg;
+	timing_monitor_h->is_initialized = true;
+
+	return true;
+}
+
+bool timing_monitor_record_period(timing_monitor_handle_t *timing_monitor_h,
+								  timing_monitor_channel_t channel,
+								  uint64_t start_us)
+{
+	if ((timing_monitor_h == NULL) || (timing_monitor_h->is_initialized == false)) return false;
+	if ((uint32_t)channel >= (uint32_t)TIMING_MONITOR_CHANNEL_COUNT) return false;
+
+	const uint64_t nominal_us = (uint64_t)timing_monitor_h->cfg->channels[channel].nominal_period_us;
+	if (nominal_us == 0u) return false;
+
+	if (timing_monitor_h->has_previous_start[channel] == false)
+	{
+		timing_monitor_h->previous_start_us[channel] = start_us;
+		timing_monitor_h->has_previous_start[channel] = true;
+		return true;
+	}
+
+	uint64_t interval_us = start_us - timing_monitor_h->previous_start_us[channel];
+	timing_monitor_channel_stats_t *stats = &timing_monitor_h->stats[channel];
+
+	timing_monitor_h->previous_start_us[channel] = start_us;
+
+	/* Nearest whole number of periods: two or more means releases passed without a run. */
+	uint64_t periods = (interval_us + (nominal_us / 2u)) / nominal_us;
+	if (periods == 0u) stats->catch_up_count++;
+	if (periods >= 2u) stats->missed_count += (uint32_t)(periods - 1u);
+
+	uint64_t jitter_us = (interval_us > nominal_us) ? (interval_us - nominal_us) : (nominal_us - interval_us);
+	if (jitter_us > UINT32_MAX) jitter_us = UINT32_MAX;
+	timing_monitor_add_sample(timing_monitor_h, channel, (uint32_t)jitter_us);
+
+	return true;
+}
+
+bool timing_monitor_record_latency(timing_monitor_handle_t *timing_monitor_h,
+								   timing_monitor_channel_t channel,
+								   uint32_t latency_us)
+{
+	if ((timing_monitor_h == NULL) || (timing_monitor_h->is_initialized == false)) return false;
+	if ((uint32_t)channel >= (uint32_t)TIMING_MONITOR_CHANNEL_COUNT) return false;
+	if (timing_monitor_h->cfg->channels[channel].nominal_period_us != 0u) return false;
+
+	timing_monitor_add_sample(timing_monitor_h, channel, latency_us);
+
+	return true;
+}
+
+bool timing_monitor_set_dropped_count(timing_monitor_handle_t *timing_monitor_h,
+									  timing_monitor_channel_t channel,
+									  uint32_t dropped_count)
+{
+	if ((timing_monitor_h == NULL) || (timing_monitor_h->is_initialized == false)) return false;
+	if ((uint32_t)channel >= (uint32_t)TIMING_MONITOR_CHANNEL_COUNT) return false;
+
+	timing_monitor_h->stats[channel].dropped_count = dropped_count;
+
+	return true;
+}
+
+bool timing_monitor_get_stats(const timing_monitor_handle_t *timing_monitor_h,
+							  timing_monitor_channel_t channel,
+							  timing_monitor_channel_stats_t *stats)
+{
+	if ((timing_monitor_h == NULL) || (stats == NULL)) return false;
+	if (timing_monitor_h->is_initialized == false) return false;
+	if ((uint32_t)channel >= (uint32_t)TIMING_MONITOR_CHANNEL_COUNT) return false;
+
+	// copy under masked IRQs so an ISR channel does not tear the bins against the count
+	uint32_t lock = irq_lock_raise(IRQ_LOCK_PRIORITY_TIMING_MONITOR);
+	*stats = timing_monitor_h->stats[channel];
+	irq_lock_restore(lock);
+
+	return true;
+}
+
+bool timing_monitor_get_violation(const timing_monitor_handle_t *timing_monitor_h,
+								  timing_monitor_channel_t *channel,
+								  uint32_t *value_us)
+{
+	if ((timing_monitor_h == NULL) || (timing_monitor_h->is_initialized == false)) return false;
+	if (timing_monitor_h->is_violated == false) return false;
+
+	if (channel != NULL) *channel = (timing_monitor_channel_t)timing_monitor_h->violation_channel;
+	if (value_us != NULL) *value_us = timing_monitor_h->violation_value_us;
+
+	return true;
+}
@@ -4,10 +4,15 @@
  *
  *  Implements USART2 initialization, non-blocking TX/RX using ring buffers, and an ISR handler to be called from USART2_IRQHandler.
  *
+ *  DMA TX mode: the stream always sends the contiguous part of the ring from tail
+ *  (up to the wrap point or head). tail advances only on transfer complete, so
+ *  in-flight bytes stay accounted as used space. A transfer error drops the
+ *  failed chunk (counted in drop_cnt) and chains the next one, so TX never stalls.
  */
 
 #include <drivers/usart2.h>
 #include <string.h>
+#include "drivers/irq_lock.h"
 
 
 /**
@@ -36,6 +41,60 @@ uint32_t baud_rate_config(const usart2_cfg_t *usart_cfg)
 	return (fraction&0x0FU)|(mantissa<<4);
 }
 
+/* Enter a short critical section: mask only the USART2 and TX DMA interrupts (the TX ring owners) */
+static uint32_t usart2_irq_save(const usart2_handle_t *usart_h)
+{
+	uint32_t priority = usart_h->cfg->irq_priority;
+	if (usart_h->cfg->tx_dma_h->cfg->irq_priority < priority) priority = usart_h->cfg->tx_dma_h->cfg->irq_priority;
+	return irq_lock_raise(priority);
+}
+
+/* Leave the section entered with usart2_irq_save() */
+static void usart2_irq_restore(uint32_t lock)
+{
+	irq_lock_restore(lock);
+}
+
+/* Start the next contiguous TX chunk if the DMA stream is idle (caller masks IRQs) */
+static void usart2_tx_dma_kick(usart2_handle_t *usart_h)
+{
+	tx_ring_buffer_t *rb = usart_h->tx_buffer;
+	uint16_t head = rb->head;
+	uint16_t tail = rb->tail;
+
+	if ((rb->dma_len != 0u) || (head == tail)) return;
+
+	// send up to head, or up to the end of the array if data wraps
+	uint16_t chunk = (head > tail) ? (uint16_t)(head - tail) : (uint16_t)(UART_TX_BUFFER_SIZE - tail);
+	if (dma_start(usart_h->cfg->tx_dma_h, (uint32_t)&USART2->DR, &rb->buffer_array[tail], chunk))
+	{
+		rb->dma_len = chunk;
+	}
+}
+
+/* DMA transfer complete: release the sent chunk and chain the next one */
+static void usart2_tx_dma_complete_callback(void *callback_arg)
+{
+	usart2_handle_t *usart_h = (usart2_handle_t *)callback_arg;
+	if ((usart_h == NULL) || (usart_h->tx_buffer == NULL)) return;
+
+	tx_ring_buffer_t *rb = usart_h->tx_buffer;
+	rb->tail = (uint16_t)((rb->tail + rb->dma_len) & TX_BUFFER_MASK);
+	rb->dma_len = 0u;
+	usart2_tx_dma_kick(usart_h);
+}
+
+/* DMA transfer error: the stream stopped, drop the chunk (part may be sent) and chain the next one */
+static void usart2_tx_dma_error_callback(void *callback_arg)
+{
+	usart2_handle_t *usart_h = (usart2_handle_t *)callback_arg;
+	if ((usart_h == NULL) || (usart_h->tx_buffer == NULL)) return;
+
+	tx_ring_buffer_t *rb = usart_h->tx_buffer;
+	rb->drop_cnt += rb->dma_len;
+	usart2_tx_dma_complete_callback(callback_arg);
+}
+
 /* Configure USART registers */
 /* GPIO must be configured in advance (Mode: AF, Speed: High Speed)  */
 bool usart2_init(const usart2_cfg_t *usart_cfg, usart2_handle_t *usart_h)
@@ -44,12 +103,22 @@ bool usart2_init(const usart2_cfg_t *usart_cfg, usart2_handle_t *usart_h)
 	if (usart_cfg->pin_cfg_rx->mode != GPIO_MODE_AF) return false;									// Requires GPIO mode = AF
 	if (usart_cfg->pin_cfg_tx->mode != GPIO_MODE_AF) return false;									// Requires GPIO mode = AF
 	if((usart_h == NULL)||(usart_h->rx_buffer==NULL)||(usart_h->tx_buffer==NULL)) return false;		// invalid handle pointers
+	if(usart_cfg->tx_mode == USART2_TX_MODE_DMA)
+	{
+		// DMA stream must be initialized as memory-to-peripheral, byte size
+		if((usart_cfg->tx_dma_h == NULL)||(usart_cfg->tx_dma_h->is_initialized == false)) return false;
+		if(usart_cfg->tx_dma_h->cfg->direction != DMA_DIR_MEM_TO_PERIPH) return false;
+		if(usart_cfg->tx_dma_h->cfg->data_size != DMA_DATA_SIZE_8_BIT) return false;
+		if(!dma_register_callbacks(usart_cfg->tx_dma_h, NULL, usart2_tx_dma_complete_callback, usart_h)) return false;
+		if(!dma_register_error_callback(usart_cfg->tx_dma_h, usart2_tx_dma_error_callback)) return false;
+	}
 	if(!gpio_init_pin(usart_cfg->pin_cfg_rx)) return false;											// gpio_init failed
 	if(!gpio_init_pin(usart_cfg->pin_cfg_tx)) return false;
 
 	/* reset values in USART handle */
 	memset(usart_h->rx_buffer,0,sizeof(ring_buffer_t));
-	memset(usart_h->tx_buffer,0,sizeof(ring_buffer_t));
+	memset(usart_h->tx_buffer,0,sizeof(tx_ring_buffer_t));
+	usart_h->cfg = usart_cfg;
 	// reset overflow counters
 	usart_h->rx_buffer->drop_cnt = 0;
 	usart_h->tx_buffer->drop_cnt = 0;
@@ -79,6 +148,15 @@ bool usart2_init(const usart2_cfg_t *usart_cfg, usart2_handle_t *usart_h)
 	USART2->CR1 = USART_CR1_TE | USART_CR1_RE | USART_CR1_RXNEIE;
 	// Disable TXEIE
 	USART2->CR1 &= ~USART_CR1_TXEIE;
+	// DMA TX requests on TXE instead of the TXE interrupt
+	if(usart_cfg->tx_mode == USART2_TX_MODE_DMA)
+	{
+		USART2->CR3 |= USART_CR3_DMAT;
+	}
+	else
+	{
+		USART2->CR3 &= ~USART_CR3_DMAT;
+	}
 
 	/* NVIC Configuration */
 	// Set priority and clear any Pending USART-interrupts
@@ -98,27 +176,34 @@ size_t usart2_write(usart2_handle_t *usart_h, const uint8_t* data, const size_t
 	// check length
 	if(len == 0) return 0;
 
-	ring_buffer_t *rb = usart_h->tx_buffer;
-	size_t write_cnt;
-	for(write_cnt = 0; write_cnt < len; write_cnt++)
+	tx_ring_buffer_t *rb = usart_h->tx_buffer;
+	uint16_t head = rb->head;
+	// TX_BUFFER_MASK must be 2^n, one slot stays empty to tell full from empty
+	size_t free_space = (size_t)(TX_BUFFER_MASK - ((head - rb->tail) & TX_BUFFER_MASK));
+	size_t write_cnt = (len < free_space) ? len : free_space;
+
+	if(write_cnt < len)
 	{
-		uint16_t head = rb->head;
-		uint16_t tail = rb->tail;
-		// BUFFER_MASK must be 2^n, otherwise this wont work
-		uint16_t next_head = (head + 1u) & BUFFER_MASK;
+		// buffer is full, drop and increase drop counter
+		rb->drop_cnt += (uint16_t)(len - write_cnt);
+	}
+	if(write_cnt == 0) return 0;
 
-		if (next_head == tail)
-		{
-			// buffer is full, drop and increase drop counter
-			rb->drop_cnt += (uint16_t)(len - write_cnt);
-			break;
-		}
+	// copy in at most two blocks (up to the end of the array, then from index 0)
+	size_t first_len = UART_TX_BUFFER_SIZE - head;
+	if(first_len > write_cnt) first_len = write_cnt;
+	memcpy(&rb->buffer_array[head], data, first_len);
+	memcpy(&rb->buffer_array[0], &data[first_len], write_cnt - first_len);
+	// publish new head after the data is in place
+	rb->head = (uint16_t)((head + write_cnt) & TX_BUFFER_MASK);
 
-		rb->buffer_array[head] = data[write_cnt];
-		rb->head = next_head;
+	if((usart_h->cfg != NULL) && (usart_h->cfg->tx_mode == USART2_TX_MODE_DMA))
+	{
+		uint32_t lock = usart2_irq_save(usart_h);
+		usart2_tx_dma_kick(usart_h);
+		usart2_irq_restore(lock);
 	}
-
-	if(write_cnt)
+	else
 	{
 		USART2->CR1 |= USART_CR1_TXEIE;
 	}
@@ -126,6 +211,16 @@ size_t usart2_write(usart2_handle_t *usart_h, const uint8_t* data, const size_t
 
 }
 
+size_t usart2_tx_free_space(const usart2_handle_t *usart_h)
+{
+	// check pointers
+	if((usart_h == NULL)||(usart_h->tx_buffer == NULL)) return 0;
+
+	// one slot stays empty to tell full from empty
+	uint16_t used = (uint16_t)((usart_h->tx_buffer->head - usart_h->tx_buffer->tail) & TX_BUFFER_MASK);
+	return (size_t)(TX_BUFFER_MASK - used);
+}
+
 size_t usart2_read(usart2_handle_t *usart_h, uint8_t* output, const size_t max_len)
 {
 	// check pointers
@@ -153,6 +248,18 @@ size_t usart2_read(usart2_handle_t *usart_h, uint8_t* output, const size_t max_l
 		return read_cnt;
 }
 
+bool usart2_register_rx_callback(usart2_handle_t *usart_h, usart2_rx_callback_t callbk, void *callbk_arg)
+{
+	if (usart_h == NULL) return false;
+
+	// clear first so the ISR never pairs the new callback with the old argument
+	usart_h->rx_callback = NULL;
+	usart_h->rx_callback_arg = callbk_arg;
+	usart_h->rx_callback = callbk;
+
+	return true;
+}
+
 void usart2_irq_handler(usart2_handle_t* usart_h)
 {
 	// check pointers
@@ -210,6 +317,7 @@ void usart2_irq_handler(usart2_handle_t* usart_h)
 		{
 			usart_h->rx_buffer->buffer_array[head] = dr;
 			usart_h->rx_buffer->head = next_head;
+			if (usart_h->rx_callback != NULL) usart_h->rx_callback(usart_h->rx_callback_arg);
 		}
 
 	}
@@ -223,7 +331,7 @@ void usart2_irq_handler(usart2_handle_t* usart_h)
 		if(tail != head)
 		{
 			uint8_t out = usart_h->tx_buffer->buffer_array[tail];
-			usart_h->tx_buffer->tail = (uint16_t)((tail + 1u) & BUFFER_MASK);
+			usart_h->tx_buffer->tail = (uint16_t)((tail + 1u) & TX_BUFFER_MASK);
 			USART2->DR = out;
 		}
 		else
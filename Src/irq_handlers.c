@@ -6,11 +6,17 @@
  */
 
 #include "stm32f4xx.h"
+#include "config/project_config.h"
 #include "drivers/exti.h"
 #include "drivers/adc.h"
-#include "drivers/as5600_analog.h"
+#include "drivers/dma.h"
 #include "drivers/usart2.h"
+#include "drivers/i2c1.h"
+#include "drivers/pwm_tim1.h"
 #include "drivers/systick.h"
+#include "drivers/tim5_timebase.h"
+#include "drivers/profiler.h"
+#include "drivers/memory_section.h"
 
 /* IRQ handlers forward EXTI lines to the common dispatcher */
 void EXTI0_IRQHandler(void)      { exti_dispatch(0,0); }
@@ -21,18 +27,101 @@ void EXTI4_IRQHandler(void)      { exti_dispatch(4,4); }
 void EXTI9_5_IRQHandler(void)    { exti_dispatch(5,9); }
 void EXTI15_10_IRQHandler(void)  { exti_dispatch(10,15); }
 
-extern adc_handle_t ADC1_IN0_H;
-
-/* ADC EOC-Interrupt, update data in ADC handle */
+/* ADC1/2/3 share one vector: the driver dispatches EOC callbacks and injected sequences per instance */
+MEMORY_SECTION_RAMFUNC
 void ADC_IRQHandler(void)
 {
-	adc_irq_handler(&ADC1_IN0_H);
+	adc_shared_irq_handler();
+}
+
+extern dma_handle_t ADC1_DMA_H;
+
+/* DMA2 Stream0 ISR: ADC1 half/full transfer, hands raw windows to AS5600 via callbacks */
+void DMA2_Stream0_IRQHandler(void)
+{
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_AS5600_DMA_ISR);
+	dma_irq_handler(&ADC1_DMA_H);
+	PROFILER_SCOPE_END(PROFILER_PROBE_AS5600_DMA_ISR);
+}
+
+extern dma_handle_t USART2_TX_DMA_H;
+
+/* DMA1 Stream6 ISR: USART2 TX chunk complete, the driver chains the next chunk */
+void DMA1_Stream6_IRQHandler(void)
+{
+	dma_irq_handler(&USART2_TX_DMA_H);
+}
+
+extern dma_handle_t I2C1_RX_DMA_H;
+
+/* DMA1 Stream0 ISR: I2C1 RX data phase complete, the driver sends STOP */
+void DMA1_Stream0_IRQHandler(void)
+{
+	dma_irq_handler(&I2C1_RX_DMA_H);
+}
+
+extern i2c1_handle_t I2C1_H;
+
+/* I2C1 event ISR: START / address / byte-transfer steps of the transaction */
+void I2C1_EV_IRQHandler(void)
+{
+	i2c1_ev_irq_handler(&I2C1_H);
+}
+
+/* I2C1 error ISR: NACK, bus error, arbitration lost */
+void I2C1_ER_IRQHandler(void)
+{
+	i2c1_er_irq_handler(&I2C1_H);
+}
+
+extern pwm_tim1_handle_t PWM_H;
 
-	/* Forward ADC completion only when the driver latched a fresh sample. */
-	if (ADC1_IN0_H.adc_data_ready == true)
-	{
-		as5600_analog_adc_irq_handler();
-	}
+/* TIM1 update ISR: PWM-synchronous callback dispatch via the driver */
+void TIM1_UP_TIM10_IRQHandler(void)
+{
+	pwm_tim1_update_irq_handler(&PWM_H);
+}
+
+/* TIM1 break ISR: BKIN or software break shut the outputs down, the driver dispatches the fault callback */
+void TIM1_BRK_TIM9_IRQHandler(void)
+{
+	pwm_tim1_break_irq_handler(&PWM_H);
+}
+
+/* TIM1 commutation ISR: the preloaded 6-step pattern is active, the driver dispatches the COM callback */
+void TIM1_TRG_COM_TIM11_IRQHandler(void)
+{
+	pwm_tim1_com_irq_handler(&PWM_H);
+}
+
+#if (MOTOR_AXIS_COUNT > 1u)
+extern pwm_tim1_handle_t PWM_TIM8_H;
+
+/* TIM8 update ISR: second-axis PWM-synchronous callback dispatch */
+void TIM8_UP_TIM13_IRQHandler(void)
+{
+	pwm_tim1_update_irq_handler(&PWM_TIM8_H);
+}
+
+/* TIM8 break ISR: software break of the second-axis fault path */
+void TIM8_BRK_TIM12_IRQHandler(void)
+{
+	pwm_tim1_break_irq_handler(&PWM_TIM8_H);
+}
+
+/* TIM8 commutation ISR: unused by the second axis, keeps the vector bound to the driver */
+void TIM8_TRG_COM_TIM14_IRQHandler(void)
+{
+	pwm_tim1_com_irq_handler(&PWM_TIM8_H);
+}
+#endif
+
+extern tim5_timebase_handle_t TIMEBASE_TIM5_H;
+
+/* TIM5 ISR: timebase overflow, extends the counter to 64 bits */
+void TIM5_IRQHandler(void)
+{
+	tim5_timebase_irq_handler(&TIMEBASE_TIM5_H);
 }
 
 extern usart2_handle_t USART2_H;
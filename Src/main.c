@@ -22,57 +22,150 @@
 #include "config/app_motor_test_config.h"
 #include "config/project_config.h"
 #include "drivers/as5600_analog.h"
+#include "drivers/as5600_i2c.h"
 #include "board/board.h"
 #include "drivers/adc.h"
+#include "drivers/calibration_store.h"
+#include "drivers/command.h"
 #include "drivers/log.h"
+#include "drivers/profiler.h"
+#include "drivers/scheduler.h"
+#include "drivers/telemetry.h"
+#include "drivers/telemetry_stream.h"
+#include "drivers/timing_monitor.h"
 #include "motor/motor.h"
 #include "motor/motor_3pwm.h"
+#include "motor/motor_6step_com.h"
+#include "motor/motor_current_pi.h"
+#include "motor/motor_current_sense.h"
 #include "motor/motor_electrical_angle.h"
+#include "motor/motor_field_weakening.h"
+#include "motor/motor_lead_angle.h"
+#include "motor/motor_cogging_compensation.h"
+#include "motor/motor_flux_observer.h"
+#include "motor/motor_fault.h"
 #include "motor/motor_foc_voltage.h"
 #include "motor/motor_openloop.h"
+#include "motor/motor_position_control.h"
+#include "motor/motor_scope.h"
 #include "motor/motor_speed_feedback.h"
+#include "motor/motor_speed_autotune.h"
+#include "motor/motor_angle_linearization.h"
 #include "motor/motor_speed_pi.h"
 #include "motor/motor_speed_reference_estimator.h"
+#include "motor/motor_trajectory.h"
+#include "app/app_axis.h"
+#include "app/app_command.h"
+#include "app/app_context.h"
 
 extern usart2_handle_t USART2_H;
 
-#define APP_FAULT_REASON_SPEED_ERROR_ABS_LIMIT    1u
-
-typedef enum app_speed_profile_phase_t {
-	APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START = 0,
-	APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE,
-	APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE,
-	APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE,
-	APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID,
-	APP_SPEED_PROFILE_PHASE_RAMP_DOWN_NEGATIVE,
-	APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE,
-	APP_SPEED_PROFILE_PHASE_RAMP_UP_TO_ZERO_NEGATIVE,
-	APP_SPEED_PROFILE_PHASE_ZERO_HOLD_END,
-} app_speed_profile_phase_t;
-
-typedef struct app_context_t {
-	motor_handle_t motor_h;
-	motor_3pwm_handle_t motor_3pwm_h;
-	motor_openloop_handle_t motor_openloop_h;
-	motor_foc_voltage_handle_t motor_foc_voltage_h;
-	motor_electrical_angle_handle_t motor_electrical_angle_h;
-	motor_speed_feedback_handle_t motor_speed_feedback_h;
-	motor_speed_pi_handle_t motor_speed_pi_h;
-	motor_speed_reference_estimator_handle_t motor_speed_reference_estimator_h;
-	as5600_analog_handle_t as5600_analog_h;
-	uint32_t last_telemetry_ms;
-	uint32_t last_actuation_update_ms;
-	uint32_t last_speed_pi_update_ms;
-	uint32_t alignment_start_ms;
-	int16_t applied_uq_command_permyriad;
-	int32_t speed_control_target_mechanical_speed_mrpm;
-	int32_t current_speed_control_reference_mrpm;
-	app_speed_profile_phase_t speed_profile_phase;
-	uint32_t speed_profile_phase_start_ms;
-	uint16_t latest_logged_mechanical_angle_u16;
-	bool latest_sample_valid;
-	bool alignment_done;
-} app_context_t;
+/* Legacy control-frame types 0x01 / 0x06 (fixed and masked control set) are decoded by tools/telemetry_decode.py only. */
+/* Binary telemetry frame type for one profiler probe summary. */
+#define APP_TELEMETRY_FRAME_TYPE_PROFILE          0x02u
+/* Binary telemetry frame type for one RAM-scope sample row. */
+#define APP_TELEMETRY_FRAME_TYPE_SCOPE            0x03u
+/* Scope dump pacing: rows per main-loop pass, TX ring room kept for one text row. */
+#define APP_SCOPE_DUMP_ROWS_PER_PASS              8u
+#define APP_SCOPE_DUMP_MIN_TX_FREE_BYTES          96u
+#define APP_SCOPE_UNUSED_CHANNEL_ID               0xFFu
+/* Binary telemetry frame type for one scheduler task summary. */
+#define APP_TELEMETRY_FRAME_TYPE_SCHEDULER        0x04u
+/* Binary telemetry frame type for one timing-monitor channel histogram. */
+#define APP_TELEMETRY_FRAME_TYPE_TIMING           0x07u
+/* Binary telemetry frame type for one telemetry-stream snapshot (u16 channel mask, due channels). */
+#define APP_TELEMETRY_FRAME_TYPE_STREAM           0x08u
+/* Binary telemetry frame type for one main-loop CPU-load window. */
+#define APP_TELEMETRY_FRAME_TYPE_LOAD             0x09u
+/* Calibration records per boot at most (alignment, linearization, cogging), reserved with the bridge off. */
+#define APP_CALIBRATION_SAVES_PER_BOOT            3u
+
+/* Main-loop task table order (task_id in the K-rows). */
+typedef enum app_task_id_t {
+	APP_TASK_ANGLE_ACQUISITION = 0,
+	APP_TASK_SPEED_CONTROL,
+	APP_TASK_FAULT_CHECK,
+	APP_TASK_RUNTIME_ACTUATION,
+	APP_TASK_TELEMETRY,
+	APP_TASK_REPORT,
+	APP_TASK_LOG_DRAIN,
+	APP_TASK_COMMAND,
+	APP_TASK_COUNT,
+} app_task_id_t;
+
+/* Module configurations of one axis (kept alive for the modules that store the cfg pointer). */
+typedef struct app_axis_cfg_t {
+	motor_3pwm_cfg_t motor_3pwm;
+	motor_openloop_cfg_t motor_openloop;
+	motor_foc_voltage_cfg_t motor_foc_voltage;
+	motor_electrical_angle_cfg_t motor_electrical_angle;
+	motor_speed_feedback_cfg_t motor_speed_feedback;
+	motor_speed_pi_cfg_t motor_speed_pi;
+	motor_field_weakening_cfg_t motor_field_weakening;
+	motor_lead_angle_cfg_t motor_lead_angle;
+	motor_cogging_compensation_cfg_t motor_cogging_compensation;
+	motor_flux_observer_cfg_t motor_flux_observer;
+	motor_speed_autotune_cfg_t motor_speed_autotune;
+	motor_angle_linearization_cfg_t motor_angle_linearization;
+	motor_speed_reference_estimator_cfg_t motor_speed_reference_estimator;
+	motor_trajectory_cfg_t motor_trajectory;
+	motor_position_control_cfg_t motor_position_control;
+	motor_current_sense_cfg_t motor_current_sense;
+	motor_current_pi_cfg_t motor_current_pi;
+	motor_fault_cfg_t motor_fault;
+	motor_6step_com_cfg_t motor_6step_com;
+	as5600_analog_cfg_t as5600_analog;
+	as5600_i2c_cfg_t as5600_i2c;
+} app_axis_cfg_t;
+
+/* Calibration sector bounds from the linker script (CALIB region). */
+extern uint32_t _scalibration[];
+extern uint32_t _ecalibration[];
+
+/* Axis 1 runs voltage-mode FOC on software-started ADC3 samples; the other drives are single-axis. */
+#if (MOTOR_AXIS_COUNT > 1u) && \
+	((APP_MOTOR_TEST_TORQUE_CONTROL_MODE == APP_MOTOR_TEST_TORQUE_CONTROL_MODE_CURRENT) || \
+	 (APP_MOTOR_TEST_DRIVE_MODE == APP_MOTOR_TEST_DRIVE_MODE_6STEP_COM))
+#error "A second axis supports voltage-mode FOC only; current mode and 6-step use the single ADC2 / Hall inputs"
+#endif
+
+#if (MOTOR_AXIS_COUNT > 1u) && (APP_MOTOR_TEST_ANGLE_SENSOR_MODE == APP_MOTOR_TEST_ANGLE_SENSOR_MODE_I2C)
+#error "A second axis reads its AS5600 on ADC3; select the analog angle source"
+#endif
+
+#if (MOTOR_AXIS_COUNT > 1u) && (APP_MOTOR_TEST_SCHEDULER_IDLE_MODE != APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_BUSY)
+#error "The second axis polls its AS5600 starts (no trigger divider left); select busy idle"
+#endif
+
+_Static_assert((APP_MOTOR_TEST_ANGLE_LINEARIZATION_POINT_COUNT <= CALIBRATION_STORE_LINEARIZATION_POINTS) &&
+			   (APP_MOTOR_TEST_ANGLE_LINEARIZATION_POINT_COUNT <= AS5600_ANALOG_LINEARIZATION_MAX_POINTS),
+			   "linearization table must fit the calibration record and the sensor driver");
+
+_Static_assert((APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT <= CALIBRATION_STORE_COGGING_POINTS) &&
+			   (APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT <= MOTOR_COGGING_COMPENSATION_MAX_POINTS),
+			   "cogging table must fit the calibration record and the compensation module");
+
+/* RAM-scope sample ring (row-major, MOTOR_SCOPE_MAX_CHANNELS values per sample), sized only when enabled. */
+static int32_t app_scope_buffer[(APP_MOTOR_TEST_SCOPE_MODE == APP_MOTOR_TEST_SCOPE_MODE_ON) ?
+								(APP_MOTOR_TEST_SCOPE_SAMPLE_COUNT * MOTOR_SCOPE_MAX_CHANNELS) : 1u];
+
+/* Reference-estimator sample history per axis, kept out of the hot motor state. */
+static motor_speed_reference_estimator_history_t app_speed_reference_estimator_history[MOTOR_AXIS_COUNT];
+
+/* Board resources of one axis. */
+typedef struct app_axis_board_t {
+	pwm_tim1_handle_t *pwm_h;
+	const gpio_pin_cfg_t *enable_pin_cfg;
+	adc_handle_t *angle_adc_h;                /* AS5600 analog output. */
+} app_axis_board_t;
+
+/* Axis 0: TIM1 / MOTOR_EN / ADC1_IN0; axis 1: TIM8 / MOTOR2_EN / ADC3_IN10. */
+static const app_axis_board_t app_axis_boards[MOTOR_AXIS_COUNT] = {
+		{ .pwm_h = &PWM_H, .enable_pin_cfg = &MOTOR_EN, .angle_adc_h = &ADC1_IN0_H },
+#if (MOTOR_AXIS_COUNT > 1u)
+		{ .pwm_h = &PWM_TIM8_H, .enable_pin_cfg = &MOTOR2_EN, .angle_adc_h = &ADC3_IN10_H },
+#endif
+};
 
 int __io_putchar(int ch)
 {
@@ -82,35 +175,177 @@ int __io_putchar(int ch)
     return (w == 1u) ? ch : EOF;
 }
 
+bool app_scope_record(app_axis_t *axis)
+{
+	if ((app_scope_enabled() == false) || (axis->index != 0u)) return true;
+
+	return motor_scope_record(&axis->app->motor_scope_h);
+}
+
 /**
- * @brief Trap on one fatal application error before runtime drive is active.
+ * @brief Send the next rows of a completed scope capture, paced by TX ring room.
  *
- * @param tag Log tag.
- * @param msg Log message.
+ * One record per sample, oldest first:
+ * text O,index,count,trigger_offset,value0..valueN or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_SCOPE, 26 bytes):
+ * u16 index, u16 count, u16 trigger_offset, u8 channel_id[4], i32 value[4]
+ * (unused channels: id 0xFF, value 0).
+ *
+ * The scope re-arms after the last row unless it only captures faults.
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_us Current time in microseconds (frame timestamp).
+ * @return true while a dump is in progress, false otherwise.
  */
-static void app_fatal_trap(const char *tag, const char *msg)
+static bool app_emit_scope_dump(app_context_t *app, uint64_t now_us)
 {
-	LOGE(tag, msg);
-	while(1) {}
+	const motor_scope_cfg_t *scope_cfg = app->motor_scope_h.cfg;
+	int32_t values[MOTOR_SCOPE_MAX_CHANNELS] = {0};
+	telemetry_frame_t frame;
+
+	if (!app_scope_enabled()) return false;
+	if (!motor_scope_is_complete(&app->motor_scope_h)) return false;
+
+	for (uint32_t row = 0u; row < APP_SCOPE_DUMP_ROWS_PER_PASS; row++)
+	{
+		if (app->scope_dump_index >= app->motor_scope_h.captured_count) break;
+		if (usart2_tx_free_space(&USART2_H) < APP_SCOPE_DUMP_MIN_TX_FREE_BYTES) break;
+		if (!motor_scope_get_sample(&app->motor_scope_h, app->scope_dump_index, values)) break;
+
+		if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
+		{
+			telemetry_frame_begin(&frame, APP_TELEMETRY_FRAME_TYPE_SCOPE, (uint32_t)now_us);
+			telemetry_frame_put_u16(&frame, app->scope_dump_index);
+			telemetry_frame_put_u16(&frame, app->motor_scope_h.captured_count);
+			telemetry_frame_put_u16(&frame, app->motor_scope_h.trigger_offset);
+			for (uint8_t i = 0u; i < MOTOR_SCOPE_MAX_CHANNELS; i++)
+			{
+				telemetry_frame_put_u8(&frame, (i < scope_cfg->channel_count) ?
+										(uint8_t)scope_cfg->channels[i] : APP_SCOPE_UNUSED_CHANNEL_ID);
+			}
+			for (uint8_t i = 0u; i < MOTOR_SCOPE_MAX_CHANNELS; i++)
+			{
+				telemetry_frame_put_i32(&frame, values[i]);
+			}
+			(void)telemetry_send(&app->telemetry_h, &frame);
+		}
+		else
+		{
+			printf("O,%u,%u,%u",
+				   (unsigned)app->scope_dump_index,
+				   (unsigned)app->motor_scope_h.captured_count,
+				   (unsigned)app->motor_scope_h.trigger_offset);
+			for (uint8_t i = 0u; i < scope_cfg->channel_count; i++)
+			{
+				printf(",%ld", (long)values[i]);
+			}
+			printf("\n");
+		}
+
+		app->scope_dump_index++;
+	}
+
+	if (app->scope_dump_index < app->motor_scope_h.captured_count) return true;
+
+	/* Capture sent: start the next one (fault-only captures stay armed from boot). */
+	app->scope_dump_index = 0u;
+	if (APP_MOTOR_TEST_SCOPE_TRIGGER != APP_MOTOR_TEST_SCOPE_TRIGGER_FAULT)
+	{
+		(void)motor_scope_arm(&app->motor_scope_h);
+	}
+	else
+	{
+		(void)motor_scope_init(&app->motor_scope_h, scope_cfg);
+	}
+
+	return false;
+}
+
+/**
+ * @brief Freeze the scope on a fault and send the capture before trapping.
+ *
+ * @param app Pointer to application runtime context.
+ */
+static void app_dump_scope_blocking(app_context_t *app)
+{
+	if (!app_scope_enabled()) return;
+	if (!motor_scope_freeze(&app->motor_scope_h)) return;
+
+	while (app_emit_scope_dump(app, SYSTICK_GetTimeUs())) {}
 }
 
 /**
- * @brief Stop the powered test path and trap on one fatal runtime error.
+ * @brief Send the latched fault record of every faulted axis as one F-line each.
+ *
+ * F-line fields:
+ * F,code,detail,time_us,mechanical_angle_u16,electrical_angle_u16,
+ * velocity_filtered_mrpm,uq_command_permyriad,id_ma,iq_ma
+ *
+ * time_us is the low 32 bits of the fault timestamp. Lines follow the axis order.
  *
  * @param app Pointer to application runtime context.
+ */
+static void app_emit_fault_record(const app_context_t *app)
+{
+	motor_fault_snapshot_t snapshot = {0};
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		if (!motor_fault_get_snapshot(&app->axis[i].motor_fault_h, &snapshot)) continue;
+
+		printf("F,%u,%lu,%lu,%u,%u,%ld,%ld,%ld,%ld\n",
+			   (unsigned)snapshot.code,
+			   (unsigned long)snapshot.detail,
+			   (unsigned long)snapshot.timestamp_us,
+			   (unsigned)snapshot.mechanical_angle_u16,
+			   (unsigned)snapshot.electrical_angle_u16,
+			   (long)snapshot.filtered_mechanical_speed_mrpm,
+			   (long)snapshot.uq_command_permyriad,
+			   (long)snapshot.id_ma,
+			   (long)snapshot.iq_ma);
+	}
+}
+
+/**
+ * @brief Trap on one fatal application error before runtime drive is active.
+ *
  * @param tag Log tag.
  * @param msg Log message.
  */
-static void app_fatal_stop(app_context_t *app, const char *tag, const char *msg)
+static void app_fatal_trap(const char *tag, const char *msg)
 {
-	/* Disable the power stage before trapping on a runtime fault. */
-	gpio_write(MOTOR_EN.pin, false);
-	app->motor_h.status.is_enabled = false;
-	(void)motor_3pwm_stop(&app->motor_3pwm_h);
 	LOGE(tag, msg);
 	while(1) {}
 }
 
+void app_fatal_stop(app_context_t *app, const char *tag, const char *msg)
+{
+	/* Disable every power stage before trapping on a runtime fault. */
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		gpio_write(app->axis[i].enable_pin_cfg->pin, false);
+		app->axis[i].motor_h.status.is_enabled = false;
+		(void)motor_3pwm_stop(&app->axis[i].motor_3pwm_h);
+	}
+	(void)adc_injected_set_trigger(&CURRENT_SENSE_ADC2_H, false);
+	/* Queued diagnostics precede the fault line (main context: no producer is mid-write). */
+	while (log_drain(LOG_DEFERRED_RING_SIZE)) {}
+	LOGE(tag, msg);
+	/* The power stage is already off; send the pre-fault trace while trapped. */
+	app_dump_scope_blocking(app);
+	/* Repeat the fault record so a host that connects later still reads it. */
+	uint32_t record_time_ms = SYSTICK_GetTimeMs();
+	app_emit_fault_record(app);
+	while(1)
+	{
+		if ((SYSTICK_GetTimeMs() - record_time_ms) >= APP_MOTOR_TEST_FAULT_RECORD_PERIOD_MS)
+		{
+			record_time_ms += APP_MOTOR_TEST_FAULT_RECORD_PERIOD_MS;
+			app_emit_fault_record(app);
+		}
+	}
+}
+
 /**
  * @brief Build the shared motor runtime state for the current test.
  *
@@ -139,798 +374,1897 @@ static motor_handle_t app_build_motor_handle(void)
 			},
 			.openloop = {0},
 			.speed_pi = {0},
+			.trajectory = {0},
 	};
 
 	return motor_h;
 }
 
 /**
- * @brief Initialize the application runtime context.
+ * @brief Initialize one axis runtime context on its board resources.
  *
  * @param app Pointer to application runtime context.
+ * @param axis Pointer to axis runtime context.
+ * @param index Axis index (0 = primary).
  */
-static void app_init_context(app_context_t *app)
+static void app_init_axis_context(app_context_t *app, app_axis_t *axis, uint8_t index)
 {
-	app->motor_h = app_build_motor_handle();
-	app->motor_3pwm_h = (motor_3pwm_handle_t){0};
-	app->motor_openloop_h = (motor_openloop_handle_t){0};
-	app->motor_foc_voltage_h = (motor_foc_voltage_handle_t){0};
-	app->motor_electrical_angle_h = (motor_electrical_angle_handle_t){0};
-	app->motor_speed_feedback_h = (motor_speed_feedback_handle_t){0};
-	app->motor_speed_pi_h = (motor_speed_pi_handle_t){0};
-	app->motor_speed_reference_estimator_h = (motor_speed_reference_estimator_handle_t){0};
-	app->as5600_analog_h = (as5600_analog_handle_t){0};
-	app->last_telemetry_ms = 0u;
-	app->last_actuation_update_ms = 0u;
-	app->last_speed_pi_update_ms = 0u;
-	app->alignment_start_ms = 0u;
-	app->applied_uq_command_permyriad = 0u;
-	/* Keep this fixed peak target field for application-level compatibility. */
-	app->speed_control_target_mechanical_speed_mrpm =
-			APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM;
-	app->current_speed_control_reference_mrpm = 0;
-	app->speed_profile_phase = APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START;
-	app->speed_profile_phase_start_ms = 0u;
-	app->latest_logged_mechanical_angle_u16 = 0u;
-	app->latest_sample_valid = false;
-	app->alignment_done = false;
+	axis->app = app;
+	axis->index = index;
+	axis->pwm_h = app_axis_boards[index].pwm_h;
+	axis->enable_pin_cfg = app_axis_boards[index].enable_pin_cfg;
+	axis->angle_adc_h = app_axis_boards[index].angle_adc_h;
+	axis->motor_h = app_build_motor_handle();
+	axis->motor_3pwm_h = (motor_3pwm_handle_t){0};
+	axis->motor_openloop_h = (motor_openloop_handle_t){0};
+	axis->motor_foc_voltage_h = (motor_foc_voltage_handle_t){0};
+	axis->motor_electrical_angle_h = (motor_electrical_angle_handle_t){0};
+	axis->motor_speed_feedback_h = (motor_speed_feedback_handle_t){0};
+	axis->motor_speed_pi_h = (motor_speed_pi_handle_t){0};
+	axis->motor_field_weakening_h = (motor_field_weakening_handle_t){0};
+	axis->motor_lead_angle_h = (motor_lead_angle_handle_t){0};
+	axis->motor_cogging_compensation_h = (motor_cogging_compensation_handle_t){0};
+	axis->motor_flux_observer_h = (motor_flux_observer_handle_t){0};
+	axis->motor_speed_autotune_h = (motor_speed_autotune_handle_t){0};
+	axis->motor_angle_linearization_h = (motor_angle_linearization_handle_t){0};
+	axis->motor_speed_reference_estimator_h = (motor_speed_reference_estimator_handle_t){0};
+	axis->motor_trajectory_h = (motor_trajectory_handle_t){0};
+	axis->motor_position_control_h = (motor_position_control_handle_t){0};
+	axis->motor_current_sense_h = (motor_current_sense_handle_t){0};
+	axis->motor_current_pi_h = (motor_current_pi_handle_t){0};
+	axis->motor_fault_h = (motor_fault_handle_t){0};
+	axis->motor_6step_com_h = (motor_6step_com_handle_t){0};
+	axis->as5600_analog_h = (as5600_analog_handle_t){0};
+	axis->as5600_i2c_h = (as5600_i2c_handle_t){0};
+	axis->calibration_data = (calibration_data_t){0};
+	axis->has_stored_calibration = false;
+	axis->cogging_table_saved = false;
+	axis->observer_divergence_reported = false;
+	axis->angle_fallback_fault_code = (uint8_t)MOTOR_FAULT_CODE_NONE;
+	axis->angle_fallback_fault_detail = 0u;
+	axis->angle_fallback_active = false;
+	axis->alignment_mechanical_angle_u16 = 0u;
+	axis->alignment_start_ms = 0u;
+	axis->applied_uq_command_permyriad = 0u;
+	axis->latest_logged_mechanical_angle_u16 = 0u;
+	axis->latest_sample_valid = false;
+	axis->angle_publish_window_samples = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+	axis->alignment_done = false;
 }
 
 /**
- * @brief Return absolute value of one signed 32-bit value.
+ * @brief Initialize the application runtime context.
  *
- * @param value Signed value.
- * @return Absolute value.
+ * @param app Pointer to application runtime context.
  */
-static int32_t app_abs_i32(int32_t value)
+static void app_init_context(app_context_t *app)
 {
-	if (value < 0)
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
 	{
-		return -value;
+		app_init_axis_context(app, &app->axis[i], i);
 	}
-
-	return value;
+	app->motor_scope_h = (motor_scope_handle_t){0};
+	app->telemetry_h = (telemetry_handle_t){0};
+	app->telemetry_stream_h = (telemetry_stream_handle_t){0};
+	app->telemetry_sample_pending = false;
+	app->scheduler_h = (scheduler_handle_t){0};
+	app->timing_monitor_h = (timing_monitor_handle_t){0};
+	app->calibration_store_h = (calibration_store_handle_t){0};
+	app->scope_dump_index = 0u;
+	/* Keep this fixed peak target field for application-level compatibility. */
+	app->speed_control_target_mechanical_speed_mrpm =
+			APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM;
+	app->command_h = (command_handle_t){0};
+	app_command_init(app);
 }
 
 /**
- * @brief Return ramp duration for the profile slope in milliseconds.
+ * @brief Record the start of one control task run on its period channel.
  *
- * @return Ramp duration in milliseconds.
+ * @param app Pointer to application runtime context.
+ * @param channel Period channel of the task.
  */
-static uint32_t app_speed_profile_ramp_duration_ms(void)
+static void app_timing_record_period(app_context_t *app, timing_monitor_channel_t channel)
 {
-	int64_t ramp_duration_num = 0;
-	uint32_t ramp_duration_ms = 1u;
-
-	/* ramp_ms = peak_mrpm * 1000 / accel_mrpm_per_s, rounded up. */
-	ramp_duration_num =
-			(int64_t)APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM * 1000LL;
-	ramp_duration_ms =
-			(uint32_t)((ramp_duration_num +
-						(int64_t)APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S - 1LL) /
-					   (int64_t)APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S);
-	if (ramp_duration_ms < 1u)
-	{
-		ramp_duration_ms = 1u;
-	}
-
-	return ramp_duration_ms;
+	if (app_timing_monitor_enabled() == false) return;
+	(void)timing_monitor_record_period(&app->timing_monitor_h, channel, SYSTICK_GetTimeUs());
 }
 
 /**
- * @brief Return one profile phase duration in milliseconds.
+ * @brief Latch a deadline fault on every axis once a timing channel ran late too often in a row.
+ *
+ * detail = the late sample in us that completed the run; the log names the channel.
  *
- * @param phase Profile phase.
- * @return Phase duration in milliseconds.
+ * @param app Pointer to application runtime context.
  */
-static uint32_t app_speed_profile_phase_duration_ms(app_speed_profile_phase_t phase)
+static void app_check_timing_fault(app_context_t *app)
 {
-	if (phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START)
-	{
-		return APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE)
-	{
-		return app_speed_profile_ramp_duration_ms();
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE)
-	{
-		return APP_MOTOR_TEST_SPEED_PROFILE_PEAK_HOLD_MS;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE)
-	{
-		return app_speed_profile_ramp_duration_ms();
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID)
-	{
-		return APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_NEGATIVE)
-	{
-		return app_speed_profile_ramp_duration_ms();
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE)
-	{
-		return APP_MOTOR_TEST_SPEED_PROFILE_PEAK_HOLD_MS;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_TO_ZERO_NEGATIVE)
+	timing_monitor_channel_t channel = TIMING_MONITOR_CHANNEL_COUNT;
+	uint32_t value_us = 0u;
+
+	if (app_timing_monitor_enabled() == false) return;
+	if (!timing_monitor_get_violation(&app->timing_monitor_h, &channel, &value_us)) return;
+
+	LOG_POST2(LOG_MSG_TMON_LATE, (uint32_t)channel, value_us);
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
 	{
-		return app_speed_profile_ramp_duration_ms();
+		motor_fault_raise(&app->axis[i].motor_fault_h, MOTOR_FAULT_CODE_DEADLINE_MISSED, value_us);
 	}
-
-	return APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS;
 }
 
 /**
- * @brief Return one phase-local speed reference for elapsed phase time.
+ * @brief Stop and trap once a fault is latched on any axis (ISR checks, break input or speed error).
  *
- * @param phase Profile phase.
- * @param elapsed_phase_ms Elapsed time inside the active phase.
- * @return Profile speed reference in mrpm.
+ * The faulted power stage is already off; the other axes are stopped with the report.
+ *
+ * @param app Pointer to application runtime context.
  */
-static int32_t app_speed_profile_phase_reference_mrpm(app_speed_profile_phase_t phase,
-													   uint32_t elapsed_phase_ms)
+static void app_handle_latched_fault(app_context_t *app)
 {
-	int64_t ramp_delta_num = 0;
-	int32_t ramp_delta_mrpm = 0;
-	int32_t peak_mrpm = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM;
-
-	if ((phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START) ||
-		(phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID) ||
-		(phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_END))
-	{
-		return 0;
-	}
-
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE)
-	{
-		return peak_mrpm;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE)
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
 	{
-		return -peak_mrpm;
-	}
-
-	/* ramp_delta_mrpm = accel_mrpm_per_s * elapsed_ms / 1000. */
-	ramp_delta_num =
-			(int64_t)APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S *
-			(int64_t)elapsed_phase_ms;
-	ramp_delta_mrpm = (int32_t)(ramp_delta_num / 1000LL);
-
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE)
-	{
-		if (ramp_delta_mrpm > peak_mrpm)
-		{
-			ramp_delta_mrpm = peak_mrpm;
-		}
-		return ramp_delta_mrpm;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_NEGATIVE)
-	{
-		if (ramp_delta_mrpm > peak_mrpm)
+		if (motor_fault_is_latched(&app->axis[i].motor_fault_h))
 		{
-			ramp_delta_mrpm = peak_mrpm;
+			app_fatal_stop(app, "FAULT", "latched");
 		}
-		return -ramp_delta_mrpm;
 	}
-
-	if (ramp_delta_mrpm > peak_mrpm)
-	{
-		ramp_delta_mrpm = peak_mrpm;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE)
-	{
-		return peak_mrpm - ramp_delta_mrpm;
-	}
-
-	return -peak_mrpm + ramp_delta_mrpm;
 }
 
 /**
- * @brief Return the active profile phase target for telemetry.
+ * @brief Return whether AS5600 raw samples come from the TIM1-synchronous DMA path.
  *
- * @param phase Profile phase.
- * @return Phase target in mrpm.
+ * @return true for timer DMA acquisition, false for SysTick-scheduled software starts.
  */
-static int32_t app_speed_profile_phase_target_mrpm(app_speed_profile_phase_t phase)
+static bool app_angle_acquisition_uses_timer_dma(void)
 {
-	int32_t peak_mrpm = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM;
-
-	if ((phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START) ||
-		(phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID) ||
-		(phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_END))
-	{
-		return 0;
-	}
-
-	if ((phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE) ||
-		(phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE) ||
-		(phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE))
-	{
-		return peak_mrpm;
-	}
-
-	return -peak_mrpm;
+	return (APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE == APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_TIMER_DMA);
 }
 
 /**
- * @brief Advance one profile phase in cyclic order.
+ * @brief Rotor state for the 6-step ANGLE trigger (TIM1 COM ISR and main loop).
+ *
+ * Lock-free: latest published sample, calibrated electrical angle and the
+ * measured speed in the sensor-angle direction.
  *
- * @param phase Current profile phase.
- * @return Next profile phase.
+ * @param callback_arg Pointer to axis runtime context.
+ * @param rotor_state Pointer to output rotor state.
+ * @return true if a sample exists, false otherwise.
  */
-static app_speed_profile_phase_t app_speed_profile_next_phase(app_speed_profile_phase_t phase)
+static bool app_6step_com_get_rotor_state(void *callback_arg, motor_6step_com_rotor_state_t *rotor_state)
 {
-	if (phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START)
-	{
-		return APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_POSITIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_TO_ZERO_POSITIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_ZERO_HOLD_MID)
-	{
-		return APP_SPEED_PROFILE_PHASE_RAMP_DOWN_NEGATIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_DOWN_NEGATIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_RAMP_UP_TO_ZERO_NEGATIVE;
-	}
-	if (phase == APP_SPEED_PROFILE_PHASE_RAMP_UP_TO_ZERO_NEGATIVE)
-	{
-		return APP_SPEED_PROFILE_PHASE_ZERO_HOLD_END;
-	}
+	app_axis_t *axis = (app_axis_t *)callback_arg;
+	as5600_analog_published_sample_t latest_angle_sample = {0};
+
+	if ((axis == NULL) || (rotor_state == NULL)) return false;
+	if (!app_axis_get_latest_angle_sample(axis, &latest_angle_sample)) return false;
+
+	/* electrical = mechanical * pole_pairs + offset, speed in electrical counts per second. */
+	rotor_state->electrical_angle_u16 =
+			(uint16_t)((uint32_t)latest_angle_sample.mechanical_angle_u16 * APP_MOTOR_TEST_POLE_PAIRS +
+					   axis->motor_electrical_angle_h.electrical_offset_u16);
+	rotor_state->capture_timestamp_us = (uint32_t)latest_angle_sample.capture_timestamp_us;
+	/* No speed yet (first samples after alignment): position only, the main loop tracks the sector. */
+	rotor_state->electrical_speed_cps = (axis->motor_h.status.has_valid_mechanical_speed) ?
+			(int32_t)(((int64_t)axis->motor_h.measurements.measured_mechanical_speed_mrpm *
+					   APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN * (int64_t)APP_MOTOR_TEST_POLE_PAIRS * 65536) / 60000) :
+			0;
 
-	return APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START;
+	return true;
 }
 
 /**
- * @brief Reset the bidirectional tuning profile at one runtime timestamp.
+ * @brief Return whether the AS5600 publish window follows the measured speed.
  *
- * @param app Pointer to application runtime context.
- * @param now_ms Current time in milliseconds.
+ * @return true for the adaptive window, false for the fixed RAW_SAMPLE_COUNT window.
  */
-static void app_speed_profile_reset(app_context_t *app, uint32_t now_ms)
+static bool app_angle_publish_window_is_adaptive(void)
 {
-	if (app == NULL) return;
-
-	app->speed_profile_phase = APP_SPEED_PROFILE_PHASE_ZERO_HOLD_START;
-	app->speed_profile_phase_start_ms = now_ms;
-	app->current_speed_control_reference_mrpm = 0;
+	return (APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE == APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MODE_ADAPTIVE);
 }
 
 /**
- * @brief Update the bidirectional trapezoidal speed profile state.
+ * @brief Return the longest publish window whose angle travel stays within the budget.
  *
- * @param app Pointer to application runtime context.
- * @param now_ms Current time in milliseconds.
+ * @param abs_mechanical_speed_mrpm Absolute mechanical speed.
+ * @return Window length in raw samples, MIN..AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES
+ *         (timer DMA: rounded down to whole DMA buffer halves).
  */
-static void app_speed_profile_update(app_context_t *app, uint32_t now_ms)
+static uint16_t app_angle_publish_window_for_speed(uint32_t abs_mechanical_speed_mrpm)
 {
-	uint32_t phase_duration_ms = 0u;
-	uint32_t elapsed_phase_ms = 0u;
-
-	if (app == NULL) return;
+	uint64_t window_samples = AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES;
 
-	/* Advance phase timing before evaluating the current phase reference. */
-	while (1)
+	/* N = travel / (speed * dt), speed in counts/us = mrpm * 65536 / 60e9. */
+	if (abs_mechanical_speed_mrpm != 0u)
 	{
-		phase_duration_ms = app_speed_profile_phase_duration_ms(app->speed_profile_phase);
-		elapsed_phase_ms = now_ms - app->speed_profile_phase_start_ms;
-		if (elapsed_phase_ms < phase_duration_ms)
-		{
-			break;
-		}
+		window_samples =
+				((uint64_t)APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_TRAVEL_COUNTS * 60000000000ULL) /
+				((uint64_t)abs_mechanical_speed_mrpm * (uint64_t)APP_MOTOR_TEST_ANGLE_FULL_TURN_COUNTS *
+				 (uint64_t)APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US);
+	}
+	if (window_samples > AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES) window_samples = AS5600_ANALOG_MAX_PUBLISH_WINDOW_SAMPLES;
+	if (window_samples < APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MIN_SAMPLES) window_samples = APP_MOTOR_TEST_ANGLE_PUBLISH_WINDOW_MIN_SAMPLES;
 
-		app->speed_profile_phase_start_ms += phase_duration_ms;
-		app->speed_profile_phase = app_speed_profile_next_phase(app->speed_profile_phase);
+	/* Timer DMA hands over whole buffer halves of RAW_SAMPLE_COUNT samples. */
+	if (app_angle_acquisition_uses_timer_dma())
+	{
+		window_samples = (window_samples / APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT) *
+						 APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+		if (window_samples == 0u) window_samples = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
 	}
 
-	elapsed_phase_ms = now_ms - app->speed_profile_phase_start_ms;
-	app->current_speed_control_reference_mrpm =
-			app_speed_profile_phase_reference_mrpm(app->speed_profile_phase, elapsed_phase_ms);
+	return (uint16_t)window_samples;
 }
 
 /**
- * @brief Return whether one profile phase is a steady peak-hold phase.
+ * @brief Retune the AS5600 publish window from the measured speed.
  *
- * @param phase Profile phase.
- * @return true for positive/negative peak-hold phases, false otherwise.
- */
-static bool app_speed_profile_is_peak_hold_phase(app_speed_profile_phase_t phase)
-{
-	return ((phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_POSITIVE) ||
-			(phase == APP_SPEED_PROFILE_PHASE_PEAK_HOLD_NEGATIVE));
-}
-
-/**
- * @brief Check if the runtime speed-error fault trigger is armed.
+ * Shrinks at once when the speed rises; grows only when the window also
+ * fits at 12.5 % more speed, so the length does not toggle at a boundary.
  *
- * @param app Pointer to application runtime context.
- * @return true if speed-error fault checks are active, false otherwise.
+ * @param axis Pointer to axis runtime context.
  */
-static bool app_speed_error_fault_is_armed(const app_context_t *app)
+static void app_update_angle_publish_window(app_axis_t *axis)
 {
-	int32_t active_phase_target_mrpm = 0;
-
-	if (app == NULL) return false;
-	if (app->alignment_done == false) return false;
-	if (app->motor_h.status.has_valid_mechanical_speed == false) return false;
-
-	/* Arm only in steady peak-hold phases after the reference reaches that phase target. */
-	if (app_speed_profile_is_peak_hold_phase(app->speed_profile_phase) == false) return false;
-	active_phase_target_mrpm = app_speed_profile_phase_target_mrpm(app->speed_profile_phase);
-	if (app->current_speed_control_reference_mrpm != active_phase_target_mrpm) return false;
-
-	return true;
-}
+	uint32_t abs_speed_mrpm =
+			(uint32_t)app_abs_i32(axis->motor_h.measurements.measured_mechanical_speed_mrpm);
+	uint16_t window_samples = app_angle_publish_window_for_speed(abs_speed_mrpm);
 
-/**
- * @brief Stop runtime on large steady-state speed error.
- *
- * @param app Pointer to application runtime context.
- * @param now_ms Current runtime timestamp in milliseconds.
- */
-static void app_check_speed_error_fault(app_context_t *app, uint32_t now_ms)
-{
-	int32_t speed_error_mrpm = 0;
+	if (window_samples > axis->angle_publish_window_samples)
+	{
+		uint16_t margin_window_samples = app_angle_publish_window_for_speed(abs_speed_mrpm + (abs_speed_mrpm / 8u));
 
-	if (app == NULL) return;
-	if (app_speed_error_fault_is_armed(app) == false) return;
+		window_samples = (margin_window_samples > axis->angle_publish_window_samples) ?
+				margin_window_samples : axis->angle_publish_window_samples;
+	}
+	if (window_samples == axis->angle_publish_window_samples) return;
 
-	/* Keep the existing speed-error protection limit with one short UART fault line. */
-	speed_error_mrpm = app->motor_h.speed_pi.speed_error_mrpm;
-	if (app_abs_i32(speed_error_mrpm) > APP_MOTOR_TEST_FAULT_TRIGGER_ABS_SPEED_ERROR_MRPM)
+	if (!as5600_analog_set_publish_window(&axis->as5600_analog_h, window_samples))
 	{
-		printf("fault,%lu,%u\n",
-			   (unsigned long)now_ms,
-			   (unsigned)APP_FAULT_REASON_SPEED_ERROR_ABS_LIMIT);
-		app_fatal_stop(app, "CTRL", "speed error limit");
+		app_fatal_stop(axis->app, "AS5600", "window rejected");
 	}
+	axis->angle_publish_window_samples = window_samples;
 }
 
 /**
- * @brief Initialize the application modules for the powered test.
+ * @brief Map the configured FOC modulation stage onto the 3-PWM stage mode.
  *
- * @param app Pointer to application runtime context.
- * @param motor_3pwm_cfg Pointer to motor 3PWM configuration.
- * @param motor_openloop_cfg Pointer to motor open-loop configuration.
- * @param motor_foc_voltage_cfg Pointer to motor FOC voltage configuration.
- * @param motor_electrical_angle_cfg Pointer to electrical-angle configuration.
- * @param motor_speed_feedback_cfg Pointer to speed-feedback configuration.
- * @param motor_speed_pi_cfg Pointer to speed-PI configuration.
- * @param motor_speed_reference_estimator_cfg Pointer to reference-estimator configuration.
- * @param as5600_analog_cfg Pointer to AS5600 analog configuration.
+ * @return 3-PWM modulation mode.
  */
-static void app_init_modules(app_context_t *app,
-							 const motor_3pwm_cfg_t *motor_3pwm_cfg,
-							 const motor_openloop_cfg_t *motor_openloop_cfg,
-							 const motor_foc_voltage_cfg_t *motor_foc_voltage_cfg,
-							 const motor_electrical_angle_cfg_t *motor_electrical_angle_cfg,
-							 const motor_speed_feedback_cfg_t *motor_speed_feedback_cfg,
-							 const motor_speed_pi_cfg_t *motor_speed_pi_cfg,
-							 const motor_speed_reference_estimator_cfg_t *motor_speed_reference_estimator_cfg,
-							 const as5600_analog_cfg_t *as5600_analog_cfg)
+static motor_3pwm_modulation_t app_pwm_modulation(void)
 {
-	/* Initialize the board drivers before the application modules. */
-	board_init();
-	log_init(&USART2_H);
-
-	/* Initialize the PWM power stage used by startup alignment and runtime FOC. */
-	if (!motor_3pwm_init(&app->motor_3pwm_h, motor_3pwm_cfg))
+	if (APP_MOTOR_TEST_PWM_MODULATION == APP_MOTOR_TEST_PWM_MODULATION_SVPWM)
 	{
-		app_fatal_trap("M3PWM", "init failed");
+		return MOTOR_3PWM_MODULATION_SVPWM;
 	}
-
-	/* Initialize the open-loop helper used only for startup alignment actuation. */
-	if (!motor_openloop_init(&app->motor_openloop_h, motor_openloop_cfg))
+	if (APP_MOTOR_TEST_PWM_MODULATION == APP_MOTOR_TEST_PWM_MODULATION_DPWM)
 	{
-		app_fatal_trap("MOPEN", "init failed");
+		return MOTOR_3PWM_MODULATION_DPWM;
 	}
 
-	/* Initialize the q-only voltage FOC kernel for post-alignment runtime tests. */
-	if (!motor_foc_voltage_init(&app->motor_foc_voltage_h, motor_foc_voltage_cfg))
-	{
-		app_fatal_trap("MFOC", "init failed");
-	}
+	return MOTOR_3PWM_MODULATION_SINE;
+}
 
-	/* Initialize the measured electrical-angle helper for future sensored paths. */
-	if (!motor_electrical_angle_init(&app->motor_electrical_angle_h, motor_electrical_angle_cfg))
+/**
+ * @brief Map the configured dead-time compensation mode to the 3-PWM stage mode.
+ *
+ * @return Dead-time compensation polarity source.
+ */
+static motor_3pwm_dead_time_comp_t app_dead_time_comp(void)
+{
+	if (APP_MOTOR_TEST_DEAD_TIME_COMP_MODE == APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_COMMAND)
 	{
-		app_fatal_trap("MEANG", "init failed");
+		return MOTOR_3PWM_DEAD_TIME_COMP_COMMAND;
 	}
-
-	/* Initialize the low-latency speed-feedback path used by active speed control. */
-	if (!motor_speed_feedback_init(&app->motor_speed_feedback_h, motor_speed_feedback_cfg))
+	if (APP_MOTOR_TEST_DEAD_TIME_COMP_MODE == APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_CURRENT)
 	{
-		app_fatal_trap("MSPD", "init failed");
+		return MOTOR_3PWM_DEAD_TIME_COMP_CURRENT;
 	}
 
-	/* Initialize the active speed PI controller used by closed-loop runtime updates. */
-	if (!motor_speed_pi_init(&app->motor_speed_pi_h, motor_speed_pi_cfg))
-	{
-		app_fatal_trap("MSPI", "init failed");
-	}
+	return MOTOR_3PWM_DEAD_TIME_COMP_OFF;
+}
 
-	/* Initialize the reference speed-estimator baseline. */
-	if (!motor_speed_reference_estimator_init(&app->motor_speed_reference_estimator_h,
-											  motor_speed_reference_estimator_cfg))
+/**
+ * @brief Map the configured speed-feedback mode to the speed-feedback module mode.
+ *
+ * @return Speed-feedback estimation mode.
+ */
+static motor_speed_feedback_mode_t app_speed_feedback_mode(void)
+{
+	if (APP_MOTOR_TEST_SPEED_FEEDBACK_MODE == APP_MOTOR_TEST_SPEED_FEEDBACK_MODE_PLL)
 	{
-		app_fatal_trap("MEST", "init failed");
+		return MOTOR_SPEED_FEEDBACK_MODE_PLL;
 	}
 
-	/* Initialize the AS5600 analog acquisition helper. */
-	if (!as5600_analog_init(&app->as5600_analog_h, as5600_analog_cfg))
-	{
-		app_fatal_trap("AS5600", "init failed");
-	}
+	return MOTOR_SPEED_FEEDBACK_MODE_LPF;
 }
 
 /**
- * @brief Start the powered runtime from the startup alignment vector.
+ * @brief Arm the TIM1 -> TIM2 -> ADC1 trigger chain for timer DMA acquisition.
  *
- * @param app Pointer to application runtime context.
- * @param alignment_electrical_angle_u16 Startup electrical angle.
+ * TIM1 TRGO pulses once per PWM period at the counter peak; TIM2 divides it
+ * down to the configured raw sample period.
  */
-static void app_start_motor_test(app_context_t *app, uint16_t alignment_electrical_angle_u16)
+static void app_start_angle_acquisition_trigger(void)
 {
-	/* Preload the startup alignment vector before PWM output starts. */
-	if (!motor_openloop_apply(&app->motor_openloop_h, alignment_electrical_angle_u16))
+	/* The trigger divider must reproduce the configured raw sample period exactly. */
+	if (((uint64_t)PWM_CFG.pwm_hz * (uint64_t)APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US) !=
+		((uint64_t)ADC_TRIGGER_TIM2_CFG.events_per_trigger * 1000000ULL))
 	{
-		app_fatal_trap("MOPEN", "alignment apply failed");
+		app_fatal_trap("AS5600", "trigger period mismatch");
 	}
 
-	/* Start the PWM output before enabling the power stage. */
-	if (!motor_3pwm_start(&app->motor_3pwm_h))
+	/* Sample at the PWM counter peak, away from the phase switching edges. */
+	if (!pwm_tim1_enable_adc_trigger(&PWM_H, PWM_H.arr))
 	{
-		app_fatal_trap("M3PWM", "start failed");
+		app_fatal_trap("PWM", "adc trigger failed");
 	}
 
-	/* Enable the motor power stage and seed the application timing markers. */
-	gpio_write(MOTOR_EN.pin, true);
-	app->motor_h.status.is_enabled = true;
-	app->alignment_start_ms = SYSTICK_GetTimeMs();
-	app->last_telemetry_ms = app->alignment_start_ms;
-	app->last_actuation_update_ms = app->alignment_start_ms;
-	app->last_speed_pi_update_ms = app->alignment_start_ms;
+	if (!tim2_trigger_start(&ADC_TRIGGER_TIM2_H))
+	{
+		app_fatal_trap("TIM2", "trigger start failed");
+	}
 }
 
 /**
- * @brief Update the application state from one consumed AS5600 angle sample.
+ * @brief Load the newest calibration record if it belongs to this build.
  *
- * @param app Pointer to application runtime context.
- * @param published_sample Published AS5600 sample.
- * @param sample_consume_timestamp_us Current sample-consume timestamp.
+ * The offset only holds for the sensor direction, phase sequence and pole
+ * pairs it was measured with, any mismatch falls back to alignment. An
+ * offset measured through a linearization table also needs that table, so
+ * such a record is rejected while linearization is off. A stored cogging
+ * table only seeds the learning, it is skipped (not the record) when the
+ * compensation is off or configured with another point count.
+ *
+ * @param axis Pointer to axis runtime context.
  */
-static void app_handle_consumed_angle_sample(app_context_t *app,
-											 const as5600_analog_published_sample_t *published_sample,
-											 uint64_t sample_consume_timestamp_us)
+static void app_load_calibration(app_axis_t *axis)
 {
-	uint16_t current_angle_u16 = 0u;
+	calibration_data_t data;
 
-	if (published_sample == NULL)
+	if (!calibration_store_load(&axis->app->calibration_store_h, &data)) return;
+	if ((data.sensor_direction != (int8_t)APP_MOTOR_TEST_SENSOR_DIRECTION) ||
+		(data.phase_sequence_sign != (int8_t)APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN) ||
+		(data.pole_pairs != (uint8_t)APP_MOTOR_TEST_POLE_PAIRS))
 	{
-		app_fatal_stop(app, "AS5600", "sample null");
+		return;
 	}
-
-	current_angle_u16 = published_sample->mechanical_angle_u16;
-
-	/* Publish the latest sensor angle into the shared motor state. */
-	app->motor_h.measurements.mechanical_angle_u16 = current_angle_u16;
-	app->motor_h.status.has_valid_mechanical_angle = true;
-
-	/* Convert the measured mechanical angle into measured electrical angle. */
-	if (!motor_electrical_angle_update(&app->motor_electrical_angle_h, current_angle_u16))
+	if (data.linearization_point_count != 0u)
 	{
-		app_fatal_stop(app, "MEANG", "update failed");
+		if ((app_angle_linearization_enabled() == false) ||
+			(!as5600_analog_set_linearization(&axis->as5600_analog_h,
+											  data.linearization_counts,
+											  data.linearization_point_count)))
+		{
+			return;
+		}
 	}
 
-	/* Feed the reference estimator with the current sample-consume timestamp. */
-	if (!motor_speed_reference_estimator_update(&app->motor_speed_reference_estimator_h,
-												current_angle_u16,
-												sample_consume_timestamp_us))
+	if ((data.cogging_point_count != 0u) && (app_cogging_compensation_enabled()) &&
+		(!motor_cogging_compensation_set_table(&axis->motor_cogging_compensation_h,
+											   data.cogging_uq_permyriad,
+											   data.cogging_point_count)))
 	{
-		app_fatal_stop(app, "MEST", "update failed");
+		data.cogging_point_count = 0u;
 	}
 
-	/* Update the low-latency speed feedback using fixed publish cadence. */
-	if (!motor_speed_feedback_update(&app->motor_speed_feedback_h, current_angle_u16))
+	axis->calibration_data = data;
+	axis->has_stored_calibration = true;
+	LOG_POST2(LOG_MSG_CAL_LOADED, data.electrical_offset_u16, axis->app->calibration_store_h.latest_sequence);
+}
+
+void app_save_calibration(app_axis_t *axis, uint16_t electrical_offset_u16)
+{
+	axis->calibration_data.electrical_offset_u16 = electrical_offset_u16;
+	axis->calibration_data.alignment_mechanical_angle_u16 = axis->alignment_mechanical_angle_u16;
+	axis->calibration_data.sensor_direction = (int8_t)APP_MOTOR_TEST_SENSOR_DIRECTION;
+	axis->calibration_data.phase_sequence_sign = (int8_t)APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN;
+	axis->calibration_data.pole_pairs = (uint8_t)APP_MOTOR_TEST_POLE_PAIRS;
+
+	if (calibration_store_get_free_slot_count(&axis->app->calibration_store_h) == 0u)
 	{
-		app_fatal_stop(app, "MSPD", "update failed");
+		LOG_POST1(LOG_MSG_CAL_SAVE_SKIPPED, electrical_offset_u16);
+		return;
 	}
-
-	/* Keep the latest consumed sample for alignment and periodic telemetry. */
-	app->latest_logged_mechanical_angle_u16 = current_angle_u16;
-	app->latest_sample_valid = true;
+	if (!calibration_store_save(&axis->app->calibration_store_h, &axis->calibration_data))
+	{
+		LOG_POST1(LOG_MSG_CAL_SAVE_FAILED, electrical_offset_u16);
+		return;
+	}
+	LOG_POST2(LOG_MSG_CAL_SAVED, electrical_offset_u16, axis->app->calibration_store_h.latest_sequence);
 }
 
 /**
- * @brief Convert one full-turn uint16 angle into degrees x10 for telemetry.
+ * @brief Return whether the AS5600 of this axis is sampled through the TIM1-synchronous DMA path.
  *
- * @param angle_u16 Angle in full-turn uint16 units.
- * @return Angle in tenths of degree.
+ * The TIM2 trigger divider serves ADC1 only; further axes start their conversions in software.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @return true for timer DMA acquisition, false for SysTick-scheduled software starts.
+ */
+static bool app_axis_uses_timer_dma(const app_axis_t *axis)
+{
+	return (app_angle_acquisition_uses_timer_dma()) && (axis->index == 0u);
+}
+
+/**
+ * @brief Build the module configurations of one axis.
+ *
+ * Software-started axes sample index / MOTOR_AXIS_COUNT of a raw sample
+ * period apart, so their ADC completions do not coincide.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param axis_cfg Pointer to output axis configuration.
+ */
+static void app_build_axis_cfg(app_axis_t *axis, app_axis_cfg_t *axis_cfg)
+{
+	/* Tuning values start from the boot parameter block, so a later swap compares against them. */
+	const app_param_block_t *params = app_command_get_active_params(axis->app);
+	const uint32_t speed_feedback_sample_period_us =
+			APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US *
+			(uint32_t)APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+
+	axis_cfg->motor_3pwm = (motor_3pwm_cfg_t){
+			.pwm_h = axis->pwm_h,
+			.modulation = app_pwm_modulation(),
+			.dead_time_comp = app_dead_time_comp(),
+			.dead_time_comp_ns = APP_MOTOR_TEST_DEAD_TIME_COMP_NS,
+			.dead_time_comp_band = (APP_MOTOR_TEST_DEAD_TIME_COMP_MODE == APP_MOTOR_TEST_DEAD_TIME_COMP_MODE_CURRENT) ?
+								   APP_MOTOR_TEST_DEAD_TIME_COMP_CURRENT_BAND_MA :
+								   APP_MOTOR_TEST_DEAD_TIME_COMP_COMMAND_BAND_PERMYRIAD,
+	};
+	axis_cfg->motor_openloop = (motor_openloop_cfg_t){
+			.motor_h = &axis->motor_h,
+			.motor_3pwm_h = &axis->motor_3pwm_h,
+			.update_period_ms = APP_MOTOR_TEST_UPDATE_PERIOD_MS,
+			.phase_increment_ramp_step_u32 = APP_MOTOR_TEST_STARTUP_OPENLOOP_PHASE_INCREMENT_RAMP_STEP_U32,
+	};
+	axis_cfg->motor_foc_voltage = (motor_foc_voltage_cfg_t){
+			.motor_h = &axis->motor_h,
+			.motor_3pwm_h = &axis->motor_3pwm_h,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+	};
+	axis_cfg->motor_electrical_angle = (motor_electrical_angle_cfg_t){
+			.motor_h = &axis->motor_h,
+			.electrical_offset_u16 = 0u,
+			/* Measured speed carries the control-direction sign; undo it for sensor-angle extrapolation. */
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.max_prediction_horizon_us = APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US,
+	};
+	axis_cfg->motor_speed_feedback = (motor_speed_feedback_cfg_t){
+			.motor_h = &axis->motor_h,
+			.sample_period_us = speed_feedback_sample_period_us,
+			.filter_time_constant_ms = params->speed_feedback_filter_time_constant_ms,
+			/* Keep control-direction sign separate from sensor and phase wiring signs. */
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.mode = app_speed_feedback_mode(),
+			.pll_bandwidth_hz = APP_MOTOR_TEST_SPEED_FEEDBACK_PLL_BANDWIDTH_HZ,
+	};
+	axis_cfg->motor_speed_pi = (motor_speed_pi_cfg_t){
+			.motor_h = &axis->motor_h,
+			.kp_q15 = params->speed_pi_kp_q15,
+			.ki_per_s_q15 = params->speed_pi_ki_per_s_q15,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.output_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.current_limit_ma = app_torque_control_uses_current_loop() ? APP_MOTOR_TEST_CURRENT_LIMIT_MA : 0,
+			.ff_speed_q15 = APP_MOTOR_TEST_SPEED_PI_FF_SPEED_Q15,
+			.ff_acceleration_q15 = APP_MOTOR_TEST_SPEED_PI_FF_ACCELERATION_Q15,
+			.ff_friction_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_PERMYRIAD,
+			.ff_friction_deadband_mrpm = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_DEADBAND_MRPM,
+			.ff_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_LIMIT_PERMYRIAD,
+			.gain_table = NULL,
+			.gain_table_count = 0u,
+	};
+	/* The voltage circle is the speed-PI limit: weakening never raises the validated voltage. */
+	axis_cfg->motor_field_weakening = (motor_field_weakening_cfg_t){
+			.motor_h = &axis->motor_h,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.voltage_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.voltage_target_permyriad = (uint16_t)((APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD *
+													APP_MOTOR_TEST_FIELD_WEAKENING_VOLTAGE_TARGET_PERCENT) / 100u),
+			.max_ud_permyriad = APP_MOTOR_TEST_FIELD_WEAKENING_MAX_UD_PERMYRIAD,
+			.ki_per_s_q15 = APP_MOTOR_TEST_FIELD_WEAKENING_KI_PER_S_Q15,
+			.min_speed_mrpm = APP_MOTOR_TEST_FIELD_WEAKENING_MIN_SPEED_MRPM,
+	};
+	axis_cfg->motor_cogging_compensation = (motor_cogging_compensation_cfg_t){
+			.motor_h = &axis->motor_h,
+			.point_count = APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.learning_gain_q15 = APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_GAIN_Q15,
+			.learning_delay_us = APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_DELAY_US,
+			.max_correction_permyriad = APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_CORRECTION_PERMYRIAD,
+			.max_delta_per_step_counts = APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_DELTA_COUNTS,
+	};
+	axis_cfg->motor_flux_observer = (motor_flux_observer_cfg_t){
+			.motor_h = &axis->motor_h,
+			.update_period_us = APP_MOTOR_TEST_CURRENT_PI_UPDATE_PERIOD_US,
+			.phase_resistance_mohm = APP_MOTOR_TEST_MOTOR_PHASE_RESISTANCE_MOHM,
+			.phase_inductance_uh = APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH,
+			.flux_linkage_uwb = APP_MOTOR_TEST_MOTOR_FLUX_LINKAGE_UWB,
+			.voltage_mv_per_permyriad_q16 = APP_MOTOR_TEST_FLUX_OBSERVER_VOLTAGE_MV_PER_PERMYRIAD_Q16,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.flux_gain_per_s = APP_MOTOR_TEST_FLUX_OBSERVER_GAIN_PER_S,
+			.pll_bandwidth_hz = APP_MOTOR_TEST_FLUX_OBSERVER_PLL_BANDWIDTH_HZ,
+			.min_speed_mrpm = APP_MOTOR_TEST_FLUX_OBSERVER_MIN_SPEED_MRPM,
+			.max_pll_error_counts = (uint16_t)APP_MOTOR_TEST_FLUX_OBSERVER_MAX_PLL_ERROR_COUNTS,
+	};
+	axis_cfg->motor_lead_angle = (motor_lead_angle_cfg_t){
+			.motor_h = &axis->motor_h,
+			.mode = (APP_MOTOR_TEST_LEAD_ANGLE_MODE == APP_MOTOR_TEST_LEAD_ANGLE_MODE_TABLE) ?
+					MOTOR_LEAD_ANGLE_MODE_TABLE :
+					MOTOR_LEAD_ANGLE_MODE_MODEL,
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.point_count = APP_MOTOR_TEST_LEAD_ANGLE_POINT_COUNT,
+			.point_spacing_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_POINT_SPACING_MRPM,
+			.table_advance_counts = APP_MOTOR_TEST_LEAD_ANGLE_TABLE,
+			.electrical_time_constant_us = (APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH * 1000u) /
+										   APP_MOTOR_TEST_MOTOR_PHASE_RESISTANCE_MOHM,
+			.max_advance_counts = (uint16_t)APP_MOTOR_TEST_LEAD_ANGLE_MAX_ADVANCE_COUNTS,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.calibration_speed_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_MRPM,
+			.calibration_step_counts = (uint16_t)APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS,
+			.calibration_step_count = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNT,
+			.calibration_settle_ms = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SETTLE_TIME_MS,
+			.calibration_average_ms = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_AVERAGE_TIME_MS,
+			.calibration_speed_tolerance_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_TOLERANCE_MRPM,
+	};
+	axis_cfg->motor_speed_autotune = (motor_speed_autotune_cfg_t){
+			.motor_h = &axis->motor_h,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.step_count = APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_STEP_COUNT,
+			.step_uq_permyriad = APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_STEP_UQ_PERMYRIAD,
+			.settle_time_ms = APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_SETTLE_TIME_MS,
+			.closed_loop_speedup = APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_CLOSED_LOOP_SPEEDUP,
+			.min_delta_speed_mrpm = APP_MOTOR_TEST_SPEED_PI_AUTOTUNE_MIN_DELTA_SPEED_MRPM,
+	};
+	axis_cfg->motor_angle_linearization = (motor_angle_linearization_cfg_t){
+			.point_count = APP_MOTOR_TEST_ANGLE_LINEARIZATION_POINT_COUNT,
+			.revolution_count = APP_MOTOR_TEST_ANGLE_LINEARIZATION_REVOLUTION_COUNT,
+			.settle_time_ms = APP_MOTOR_TEST_ANGLE_LINEARIZATION_SETTLE_TIME_MS,
+			.timeout_ms = APP_MOTOR_TEST_ANGLE_LINEARIZATION_TIMEOUT_MS,
+			.min_samples_per_point = APP_MOTOR_TEST_ANGLE_LINEARIZATION_MIN_SAMPLES_PER_POINT,
+			.max_delta_per_sample_counts = APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
+	};
+	axis_cfg->motor_speed_reference_estimator = (motor_speed_reference_estimator_cfg_t){
+			.motor_h = &axis->motor_h,
+			.history = &app_speed_reference_estimator_history[axis->index],
+			.history_sample_count = APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT,
+	};
+	axis_cfg->motor_trajectory = (motor_trajectory_cfg_t){
+			.motor_h = &axis->motor_h,
+			.segments = axis->app->speed_profile_segments,
+			.segment_count = APP_SPEED_PROFILE_SEGMENT_COUNT,
+			.is_cyclic = true,
+			.update_period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u,
+			.max_acceleration_mrpm_per_s = params->profile_acceleration_mrpm_per_s,
+			.max_jerk_mrpm_per_s2 = params->profile_jerk_mrpm_per_s2,
+	};
+	axis_cfg->motor_position_control = (motor_position_control_cfg_t){
+			.motor_h = &axis->motor_h,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.kp_q15 = params->position_kp_q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_POSITION_KI_PER_S_Q15,
+			.max_speed_mrpm = params->position_max_speed_mrpm,
+			.in_position_window_counts = APP_MOTOR_TEST_POSITION_IN_POSITION_WINDOW_COUNTS,
+			.in_position_settle_ms = APP_MOTOR_TEST_POSITION_IN_POSITION_SETTLE_MS,
+	};
+	axis_cfg->motor_current_sense = (motor_current_sense_cfg_t){
+			.motor_h = &axis->motor_h,
+			.shunt_count = (uint8_t)CURRENT_SENSE_SHUNT_COUNT,
+			.ma_per_count_q16 = APP_MOTOR_TEST_CURRENT_SENSE_MA_PER_COUNT_Q16,
+			.current_sign = APP_MOTOR_TEST_CURRENT_SENSE_SIGN,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+			.calibration_sample_count = APP_MOTOR_TEST_CURRENT_SENSE_CALIBRATION_SAMPLE_COUNT,
+			.nominal_offset_counts = APP_MOTOR_TEST_CURRENT_SENSE_NOMINAL_OFFSET_COUNTS,
+			.max_offset_deviation_counts = APP_MOTOR_TEST_CURRENT_SENSE_MAX_OFFSET_DEVIATION_COUNTS,
+	};
+	axis_cfg->motor_current_pi = (motor_current_pi_cfg_t){
+			.motor_h = &axis->motor_h,
+			.kp_q15 = APP_MOTOR_TEST_CURRENT_PI_KP_Q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_CURRENT_PI_KI_PER_S_Q15,
+			.update_period_us = APP_MOTOR_TEST_CURRENT_PI_UPDATE_PERIOD_US,
+			.output_limit_permyriad = APP_MOTOR_TEST_CURRENT_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.phase_inductance_uh = APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH,
+			.bus_voltage_mv = APP_MOTOR_TEST_BUS_VOLTAGE_MV,
+			/* The voltage kernel's frame turns at phase_sequence_sign x d(theta_e)/dt; measured speed
+			 * carries the control-direction sign. */
+			.speed_direction_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN * APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+	};
+	axis_cfg->motor_fault = (motor_fault_cfg_t){
+			.motor_h = &axis->motor_h,
+			.pwm_h = axis->pwm_h,
+			.enable_pin_cfg = axis->enable_pin_cfg,
+			.get_time_us = SYSTICK_GetTimeUs,
+			.max_sample_age_us = APP_MOTOR_TEST_FAULT_MAX_SAMPLE_AGE_US,
+			.max_abs_mechanical_speed_mrpm = APP_MOTOR_TEST_FAULT_MAX_ABS_SPEED_MRPM,
+			.angle_step_margin_counts = (uint16_t)APP_MOTOR_TEST_FAULT_ANGLE_STEP_MARGIN_COUNTS,
+	};
+	axis_cfg->motor_6step_com = (motor_6step_com_cfg_t){
+			.pwm_h = axis->pwm_h,
+			.motor_3pwm_h = &axis->motor_3pwm_h,
+			.timebase_h = &TIMEBASE_TIM5_H,
+			.trigger = (APP_MOTOR_TEST_6STEP_COM_TRIGGER == APP_MOTOR_TEST_6STEP_COM_TRIGGER_HALL) ?
+					MOTOR_6STEP_COM_TRIGGER_HALL :
+					MOTOR_6STEP_COM_TRIGGER_ANGLE,
+			.lock_prio = IRQ_LOCK_PRIORITY_COMMUTATION,
+			.hall_exti_cfg = {&HALL_A_EXTI, &HALL_B_EXTI, &HALL_C_EXTI},
+			.hall_to_pattern = APP_MOTOR_TEST_6STEP_COM_HALL_TO_PATTERN,
+			.get_rotor_state = app_6step_com_get_rotor_state,
+			.rotor_state_arg = axis,
+			.min_electrical_speed_cps = (int32_t)(((int64_t)APP_MOTOR_TEST_6STEP_COM_MIN_MECHANICAL_SPEED_MRPM *
+												   APP_MOTOR_TEST_POLE_PAIRS * 65536) / 60000),
+			.max_sample_age_us = APP_MOTOR_TEST_6STEP_COM_MAX_SAMPLE_AGE_US,
+			.min_lead_us = APP_MOTOR_TEST_6STEP_COM_MIN_LEAD_US,
+	};
+	axis_cfg->as5600_analog = (as5600_analog_cfg_t){
+			.adc_h = axis->angle_adc_h,
+			.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
+			.raw_sample_period_us = APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US,
+			.raw_sample_phase_us = (APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US * axis->index) / MOTOR_AXIS_COUNT,
+			.raw_samples_per_publish = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT,
+			.wrap_correction_threshold_counts = (uint16_t)APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS,
+			.max_plausible_delta_per_publish_counts =
+					(uint16_t)APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
+			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
+					AS5600_ANALOG_DIRECTION_REVERSE :
+					AS5600_ANALOG_DIRECTION_FORWARD,
+			.acquisition_mode = app_axis_uses_timer_dma(axis) ?
+					AS5600_ANALOG_ACQUISITION_TIMER_DMA :
+					AS5600_ANALOG_ACQUISITION_SOFTWARE,
+			.dma_h = app_axis_uses_timer_dma(axis) ? &ADC1_DMA_H : NULL,
+			.adc_trigger = ADC_EXT_TRIGGER_TIM2_TRGO,
+	};
+	/* Digital source: one ANGLE read per analog publish period, so the speed feedback timing is shared. */
+	axis_cfg->as5600_i2c = (as5600_i2c_cfg_t){
+			.i2c_h = &I2C1_H,
+			.angle_register = AS5600_I2C_REGISTER_ANGLE,
+			.conf = AS5600_I2C_CONF_SF_FAST_2X | AS5600_I2C_CONF_HYST_OFF | AS5600_I2C_CONF_PM_NOMINAL,
+			.sample_period_us = APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US * APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT,
+			.sample_phase_us = APP_MOTOR_TEST_ANGLE_I2C_SAMPLE_PHASE_US,
+			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
+					AS5600_ANALOG_DIRECTION_REVERSE :
+					AS5600_ANALOG_DIRECTION_FORWARD,
+	};
+}
+
+/**
+ * @brief Initialize the motor pipeline of one axis.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param axis_cfg Pointer to axis configuration (kept by the modules).
+ */
+static void app_init_axis_modules(app_axis_t *axis, const app_axis_cfg_t *axis_cfg)
+{
+	/* Initialize the PWM power stage used by startup alignment and runtime FOC. */
+	if (!motor_3pwm_init(&axis->motor_3pwm_h, &axis_cfg->motor_3pwm))
+	{
+		app_fatal_trap("M3PWM", "init failed");
+	}
+
+	/* Hook the fault latch onto the timer break before the stage can be enabled. */
+	if (!motor_fault_init(&axis->motor_fault_h, &axis_cfg->motor_fault))
+	{
+		app_fatal_trap("FAULT", "init failed");
+	}
+
+	/* Initialize the open-loop helper used only for startup alignment actuation. */
+	if (!motor_openloop_init(&axis->motor_openloop_h, &axis_cfg->motor_openloop))
+	{
+		app_fatal_trap("MOPEN", "init failed");
+	}
+
+	/* Initialize the q-only voltage FOC kernel for post-alignment runtime tests. */
+	if (!motor_foc_voltage_init(&axis->motor_foc_voltage_h, &axis_cfg->motor_foc_voltage))
+	{
+		app_fatal_trap("MFOC", "init failed");
+	}
+
+	/* Initialize the measured electrical-angle helper for future sensored paths. */
+	if (!motor_electrical_angle_init(&axis->motor_electrical_angle_h, &axis_cfg->motor_electrical_angle))
+	{
+		app_fatal_trap("MEANG", "init failed");
+	}
+
+	/* Initialize the low-latency speed-feedback path used by active speed control. */
+	if (!motor_speed_feedback_init(&axis->motor_speed_feedback_h, &axis_cfg->motor_speed_feedback))
+	{
+		app_fatal_trap("MSPD", "init failed");
+	}
+
+	/* Initialize the active speed PI controller used by closed-loop runtime updates. */
+	if (!motor_speed_pi_init(&axis->motor_speed_pi_h, &axis_cfg->motor_speed_pi))
+	{
+		app_fatal_trap("MSPI", "init failed");
+	}
+
+	/* Initialize the optional field weakening (publishes Ud = 0 and the full Uq circle). */
+	if ((app_field_weakening_enabled()) &&
+		(!motor_field_weakening_init(&axis->motor_field_weakening_h, &axis_cfg->motor_field_weakening)))
+	{
+		app_fatal_trap("MFW", "init failed");
+	}
+
+	/* Initialize the optional phase advance (table or L / R model, no advance until the first speed step). */
+	if ((app_lead_angle_enabled()) &&
+		(!motor_lead_angle_init(&axis->motor_lead_angle_h, &axis_cfg->motor_lead_angle)))
+	{
+		app_fatal_trap("MLEAD", "init failed");
+	}
+
+	/* Initialize the optional cogging feedforward (empty table, the stored one is loaded with the calibration). */
+	if ((app_cogging_compensation_enabled()) &&
+		(!motor_cogging_compensation_init(&axis->motor_cogging_compensation_h, &axis_cfg->motor_cogging_compensation)))
+	{
+		app_fatal_trap("MCOG", "init failed");
+	}
+
+	/* Initialize the optional on-target speed-plant identification. */
+	if ((app_speed_pi_autotune_enabled()) &&
+		(!motor_speed_autotune_init(&axis->motor_speed_autotune_h, &axis_cfg->motor_speed_autotune)))
+	{
+		app_fatal_trap("MSAT", "init failed");
+	}
+
+	/* Initialize the optional constant-speed sensor linearization run. */
+	if ((app_angle_linearization_enabled()) &&
+		(!motor_angle_linearization_init(&axis->motor_angle_linearization_h, &axis_cfg->motor_angle_linearization)))
+	{
+		app_fatal_trap("ALIN", "init failed");
+	}
+
+	/* Initialize the reference speed-estimator baseline. */
+	if (!motor_speed_reference_estimator_init(&axis->motor_speed_reference_estimator_h,
+											  &axis_cfg->motor_speed_reference_estimator))
+	{
+		app_fatal_trap("MEST", "init failed");
+	}
+
+	/* Initialize the speed-reference trajectory consumed by the speed PI. */
+	if (!motor_trajectory_init(&axis->motor_trajectory_h, &axis_cfg->motor_trajectory))
+	{
+		app_fatal_trap("MTRJ", "init failed");
+	}
+
+	/* Initialize the position loop used by position reference mode. */
+	if (!motor_position_control_init(&axis->motor_position_control_h, &axis_cfg->motor_position_control))
+	{
+		app_fatal_trap("MPOS", "init failed");
+	}
+
+	/* Initialize the phase-current path used only by current-mode FOC. */
+	if (app_torque_control_uses_current_loop())
+	{
+		if (CURRENT_SENSE_ADC2_H.injected_cfg == NULL)
+		{
+			app_fatal_trap("MCUR", "adc2 injected init failed");
+		}
+
+		if (!motor_current_sense_init(&axis->motor_current_sense_h, &axis_cfg->motor_current_sense))
+		{
+			app_fatal_trap("MCUR", "init failed");
+		}
+
+		if (!motor_current_pi_init(&axis->motor_current_pi_h, &axis_cfg->motor_current_pi))
+		{
+			app_fatal_trap("MCPI", "init failed");
+		}
+
+		if ((app_flux_observer_enabled()) &&
+			(!motor_flux_observer_init(&axis->motor_flux_observer_h, &axis_cfg->motor_flux_observer)))
+		{
+			app_fatal_trap("MOBS", "init failed");
+		}
+	}
+
+	/* Initialize the optional 6-step drive (Hall EXTI lines are armed here, COM mode at start). */
+	if ((app_drive_uses_6step_com()) &&
+		(!motor_6step_com_init(&axis->motor_6step_com_h, &axis_cfg->motor_6step_com)))
+	{
+		app_fatal_trap("6STEP", "init failed");
+	}
+
+	/* Initialize the selected AS5600 angle source. */
+	if (app_angle_sensor_uses_i2c())
+	{
+		if (!as5600_i2c_init(&axis->as5600_i2c_h, &axis_cfg->as5600_i2c))
+		{
+			app_fatal_trap("AS5600", "i2c init failed");
+		}
+	}
+	else if (!as5600_analog_init(&axis->as5600_analog_h, &axis_cfg->as5600_analog))
+	{
+		app_fatal_trap("AS5600", "init failed");
+	}
+}
+
+/**
+ * @brief Initialize the telemetry stream and apply the channel parameters of one block.
+ *
+ * @param app Pointer to application runtime context.
+ * @param telemetry_stream_cfg Pointer to telemetry-stream configuration.
+ * @return true if the stream accepted the configuration and every parameter, false otherwise.
+ */
+static bool app_init_telemetry_stream(app_context_t *app, const telemetry_stream_cfg_t *telemetry_stream_cfg)
+{
+	const app_param_block_t *params = app_command_get_active_params(app);
+
+	if (!telemetry_stream_init(&app->telemetry_stream_h, telemetry_stream_cfg)) return false;
+	if (!telemetry_stream_set_mask(&app->telemetry_stream_h, params->telemetry_channel_mask)) return false;
+	for (uint8_t i = 0u; i < (uint8_t)APP_TELEMETRY_CHANNEL_COUNT; i++)
+	{
+		if (!telemetry_stream_set_decimation(&app->telemetry_stream_h, i, params->telemetry_decimation[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Publish callback: wake the angle-acquisition task (ADC EOC / DMA ISR context).
+ *
+ * @param arg Application runtime context.
+ */
+static void app_on_angle_sample_published(void *arg)
+{
+	app_context_t *app = (app_context_t *)arg;
+
+	(void)scheduler_post_event(&app->scheduler_h, APP_EVENT_ANGLE_SAMPLE);
+}
+
+/**
+ * @brief RX callback: wake the command task (USART2 ISR context).
+ *
+ * @param arg Application runtime context.
+ */
+static void app_on_command_byte_received(void *arg)
+{
+	app_context_t *app = (app_context_t *)arg;
+
+	(void)scheduler_post_event(&app->scheduler_h, APP_EVENT_COMMAND_RX);
+}
+
+/**
+ * @brief Initialize the application modules for the powered test.
+ *
+ * @param app Pointer to application runtime context.
+ * @param axis_cfgs Per-axis module configurations (MOTOR_AXIS_COUNT entries).
+ * @param motor_scope_cfg Pointer to RAM-scope configuration.
+ * @param telemetry_cfg Pointer to binary telemetry configuration.
+ * @param command_cfg Pointer to host command receiver configuration.
+ * @param scheduler_cfg Pointer to main-loop task table.
+ * @param timing_monitor_cfg Pointer to timing-monitor channel configuration.
+ * @param calibration_store_cfg Pointer to FLASH calibration store configuration.
+ */
+static void app_init_modules(app_context_t *app,
+							 const app_axis_cfg_t *axis_cfgs,
+							 const motor_scope_cfg_t *motor_scope_cfg,
+							 const telemetry_cfg_t *telemetry_cfg,
+							 const telemetry_stream_cfg_t *telemetry_stream_cfg,
+							 const command_cfg_t *command_cfg,
+							 const scheduler_cfg_t *scheduler_cfg,
+							 const timing_monitor_cfg_t *timing_monitor_cfg,
+							 const calibration_store_cfg_t *calibration_store_cfg)
+{
+	/* Initialize the board drivers before the application modules. */
+	board_init();
+	log_init(&USART2_H);
+
+	/* Driver timing assumes the selected clock profile; stop if it was not applied. */
+	if (CLOCK_H.is_initialized == false)
+	{
+		app_fatal_trap("CLK", "clock profile not applied");
+	}
+
+	/* Microsecond timestamps come from TIM5; without it the SysTick facade is not running. */
+	if (TIMEBASE_TIM5_H.is_initialized == false)
+	{
+		app_fatal_trap("TIM5", "timebase init failed");
+	}
+
+	/* Start the DWT cycle counter used by the stage probes. */
+	if (!profiler_init())
+	{
+		app_fatal_trap("PROF", "cycle counter unavailable");
+	}
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_init_axis_modules(&app->axis[i], &axis_cfgs[i]);
+	}
+
+	/* Arm the RAM scope; it records from the first control step on. */
+	if (app_scope_enabled())
+	{
+		if ((!motor_scope_init(&app->motor_scope_h, motor_scope_cfg)) ||
+			(!motor_scope_arm(&app->motor_scope_h)))
+		{
+			app_fatal_trap("SCOPE", "init failed");
+		}
+	}
+
+	/* Initialize the binary telemetry framer on the shared USART2 TX ring. */
+	if (!telemetry_init(&app->telemetry_h, telemetry_cfg))
+	{
+		app_fatal_trap("TLM", "init failed");
+	}
+
+	/* Register the telemetry channels; the boot mask and decimations come from the parameter defaults. */
+	if (!app_init_telemetry_stream(app, telemetry_stream_cfg))
+	{
+		app_fatal_trap("TLM", "stream init failed");
+	}
+
+	/* Frame host commands from the USART2 RX ring; acknowledgements share the telemetry output. */
+	if ((app_command_enabled()) && (!command_init(&app->command_h, command_cfg)))
+	{
+		app_fatal_trap("CMD", "init failed");
+	}
+
+	/* Sort the main-loop task table; releases start with the motor test. */
+	if (!scheduler_init(&app->scheduler_h, scheduler_cfg))
+	{
+		app_fatal_trap("SCHED", "init failed");
+	}
+
+	/* Event idle: the sample publishes and RX bytes release the background tasks. */
+	if (app_scheduler_event_driven())
+	{
+		for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+		{
+			if (!as5600_analog_register_publish_callback(&app->axis[i].as5600_analog_h,
+														 app_on_angle_sample_published,
+														 app))
+			{
+				app_fatal_trap("SCHED", "angle event failed");
+			}
+		}
+		if ((app_command_enabled()) &&
+			(!usart2_register_rx_callback(&USART2_H, app_on_command_byte_received, app)))
+		{
+			app_fatal_trap("SCHED", "command event failed");
+		}
+	}
+
+	/* Period and latency histograms fill from the first control release on. */
+	if ((app_timing_monitor_enabled()) && (!timing_monitor_init(&app->timing_monitor_h, timing_monitor_cfg)))
+	{
+		app_fatal_trap("TMON", "init failed");
+	}
+
+	/* Look up a stored alignment; a missing or foreign record keeps the alignment hold. */
+	if (app_calibration_store_enabled())
+	{
+		if (!calibration_store_init(&app->calibration_store_h, calibration_store_cfg))
+		{
+			app_fatal_trap("CAL", "init failed");
+		}
+		app_load_calibration(&app->axis[0]);
+		/* Sector erase (about 1 s FLASH stall) only here, before the power stage is enabled. */
+		if (!calibration_store_reserve(&app->calibration_store_h, APP_CALIBRATION_SAVES_PER_BOOT))
+		{
+			LOG_POST1(LOG_MSG_CAL_SAVE_FAILED, app->axis[0].calibration_data.electrical_offset_u16);
+		}
+	}
+
+	/* Conversions start with TIM1 once the trigger chain is armed. */
+	if ((app_angle_sensor_uses_i2c() == false) && (app_angle_acquisition_uses_timer_dma()))
+	{
+		app_start_angle_acquisition_trigger();
+	}
+}
+
+/**
+ * @brief Arm the injected phase-current conversions and calibrate the shunt offsets.
+ *
+ * Runs with PWM active and the power stage still disabled, so the samples
+ * are the zero-current amplifier outputs.
+ *
+ * @param axis Pointer to axis runtime context.
+ */
+static void app_start_current_sense(app_axis_t *axis)
+{
+	uint32_t calibration_start_ms = 0u;
+
+	/* Convert at the PWM counter peak, where all low-side switches conduct. */
+	if (!pwm_tim1_enable_adc_trigger(axis->pwm_h, axis->pwm_h->arr))
+	{
+		app_fatal_trap("PWM", "adc trigger failed");
+	}
+
+	if ((!motor_current_sense_start_calibration(&axis->motor_current_sense_h)) ||
+		(!adc_injected_set_trigger(&CURRENT_SENSE_ADC2_H, true)))
+	{
+		app_fatal_trap("MCUR", "start failed");
+	}
+
+	/* The JEOC callback averages one sequence per PWM period. */
+	calibration_start_ms = SYSTICK_GetTimeMs();
+	while (!motor_current_sense_is_calibrated(&axis->motor_current_sense_h))
+	{
+		if (axis->motor_current_sense_h.calibration_failed)
+		{
+			app_fatal_trap("MCUR", "offset out of range");
+		}
+
+		if ((SYSTICK_GetTimeMs() - calibration_start_ms) >= APP_MOTOR_TEST_CURRENT_SENSE_CALIBRATION_TIMEOUT_MS)
+		{
+			app_fatal_trap("MCUR", "calibration timeout");
+		}
+	}
+
+	LOG_POST3(LOG_MSG_MCUR_CALIBRATED,
+			  axis->motor_current_sense_h.offset_counts[0],
+			  axis->motor_current_sense_h.offset_counts[1],
+			  axis->motor_current_sense_h.offset_counts[2]);
+}
+
+/**
+ * @brief Start the powered runtime from the startup alignment vector.
+ *
+ * All axes start together: the PWM carriers are staggered by
+ * 1 / MOTOR_AXIS_COUNT of a half period, so the update interrupts (and the
+ * fast loops behind them) of two axes sit a quarter PWM period apart.
+ *
+ * @param app Pointer to application runtime context.
+ * @param alignment_electrical_angle_u16 Startup electrical angle.
+ */
+static void app_start_motor_test(app_context_t *app, uint16_t alignment_electrical_angle_u16)
+{
+	motor_3pwm_handle_t *motor_3pwm_hs[MOTOR_AXIS_COUNT];
+
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_t *axis = &app->axis[i];
+
+		/* With a stored calibration the rotor is not pulled to the alignment angle (zero vector). */
+		if (axis->has_stored_calibration)
+		{
+			axis->motor_h.targets.target_amplitude_permyriad = 0u;
+		}
+
+		/* Preload the startup alignment vector before PWM output starts. */
+		if (!motor_openloop_apply(&axis->motor_openloop_h, alignment_electrical_angle_u16))
+		{
+			app_fatal_trap("MOPEN", "alignment apply failed");
+		}
+
+		/* An active break input (driver fault, comparator) keeps the stage off from the start. */
+		if (motor_fault_is_latched(&axis->motor_fault_h))
+		{
+			app_fatal_stop(app, "FAULT", "break active at start");
+		}
+
+		motor_3pwm_hs[i] = &axis->motor_3pwm_h;
+	}
+
+	/* Start the PWM outputs before enabling the power stages. */
+	if (!motor_3pwm_start_staggered(motor_3pwm_hs, MOTOR_AXIS_COUNT, IRQ_LOCK_PRIORITY_PWM_START))
+	{
+		app_fatal_trap("M3PWM", "start failed");
+	}
+
+	/* Shunt offsets need running PWM and a disabled power stage. */
+	if (app_torque_control_uses_current_loop())
+	{
+		app_start_current_sense(&app->axis[0]);
+	}
+
+	/* Enable the motor power stages and anchor the task release grid at the alignment start. */
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_t *axis = &app->axis[i];
+
+		gpio_write(axis->enable_pin_cfg->pin, true);
+		axis->motor_h.status.is_enabled = true;
+		axis->alignment_start_ms = SYSTICK_GetTimeMs();
+	}
+	if (!scheduler_start(&app->scheduler_h, SYSTICK_GetTimeUs()))
+	{
+		app_fatal_stop(app, "SCHED", "start failed");
+	}
+}
+
+/**
+ * @brief Update the application state from one consumed AS5600 angle sample.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param published_sample Published AS5600 sample with its capture timestamp.
+ */
+static void app_handle_consumed_angle_sample(app_axis_t *axis,
+											 const as5600_analog_published_sample_t *published_sample)
+{
+	uint16_t current_angle_u16 = 0u;
+	bool reference_estimator_ok = false;
+
+	if (published_sample == NULL)
+	{
+		app_fatal_stop(axis->app, "AS5600", "sample null");
+	}
+
+	/* Once the observer took over, the sensor path is not trusted again until reset. */
+	if (axis->angle_fallback_active) return;
+
+	current_angle_u16 = published_sample->mechanical_angle_u16;
+
+	/* Publish the latest sensor angle into the shared motor state. */
+	axis->motor_h.measurements.mechanical_angle_u16 = current_angle_u16;
+	axis->motor_h.status.has_valid_mechanical_angle = true;
+
+	/* Convert the measured mechanical angle into measured electrical angle (the actuation path owns it
+	 * in PWM ISR mode, in current mode and with angle prediction). */
+	if ((app_control_loop_uses_pwm_isr() == false) &&
+		(app_torque_control_uses_current_loop() == false) &&
+		(app_angle_prediction_enabled() == false) &&
+		(!motor_electrical_angle_update(&axis->motor_electrical_angle_h, current_angle_u16)))
+	{
+		app_fatal_stop(axis->app, "MEANG", "update failed");
+	}
+
+	/* Feed the reference estimator with the sample capture instant, not the consume time. */
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_REFERENCE_ESTIMATOR);
+	reference_estimator_ok = motor_speed_reference_estimator_update(&axis->motor_speed_reference_estimator_h,
+																   current_angle_u16,
+																   published_sample->capture_timestamp_us);
+	PROFILER_SCOPE_END(PROFILER_PROBE_REFERENCE_ESTIMATOR);
+	if (!reference_estimator_ok)
+	{
+		app_fatal_stop(axis->app, "MEST", "update failed");
+	}
+
+	/* Update the low-latency speed feedback at the interval this sample reports. */
+	if ((!motor_speed_feedback_set_sample_period(&axis->motor_speed_feedback_h,
+												 published_sample->sample_period_us)) ||
+		(!motor_speed_feedback_update(&axis->motor_speed_feedback_h, current_angle_u16)))
+	{
+		app_fatal_stop(axis->app, "MSPD", "update failed");
+	}
+
+	/* The next window (not the one being filled) follows the new speed. */
+	if ((app_angle_publish_window_is_adaptive()) && (app_angle_sensor_uses_i2c() == false))
+	{
+		app_update_angle_publish_window(axis);
+	}
+
+	/* Keep the latest consumed sample for alignment and periodic telemetry. */
+	axis->latest_logged_mechanical_angle_u16 = current_angle_u16;
+	axis->latest_sample_valid = true;
+
+	/* The linearization run bins every published sample at its capture instant. */
+	if (app_angle_linearization_is_running(axis))
+	{
+		if (!motor_angle_linearization_update(&axis->motor_angle_linearization_h,
+											  current_angle_u16,
+											  published_sample->capture_timestamp_us))
+		{
+			app_fatal_stop(axis->app, "ALIN", "update failed");
+		}
+		if (app_angle_linearization_is_running(axis) == false)
+		{
+			app_axis_finish_angle_linearization(axis);
+		}
+	}
+}
+
+/**
+ * @brief Convert one full-turn uint16 angle into degrees x10 for telemetry.
+ *
+ * @param angle_u16 Angle in full-turn uint16 units.
+ * @return Angle in tenths of degree.
  */
 static uint16_t app_angle_u16_to_deg_x10(uint16_t angle_u16)
 {
-	/* deg_x10 = angle_u16 * 3600 / 65536, rounded to nearest. */
-	uint32_t deg_x10_num = ((uint32_t)angle_u16 * 3600u) + 32768u;
-	return (uint16_t)(deg_x10_num / 65536u);
+	/* deg_x10 = angle_u16 * 3600 / 65536, rounded to nearest. */
+	uint32_t deg_x10_num = ((uint32_t)angle_u16 * 3600u) + 32768u;
+	return (uint16_t)(deg_x10_num / 65536u);
+}
+
+/**
+ * @brief Emit one compact S-line telemetry record (one per telemetry release).
+ *
+ * S-line fields:
+ * S,timestamp_ms,mechanical_angle_deg_x10,velocity_filtered_mrpm,
+ * velocity_target_final_mrpm,velocity_reference_mrpm,
+ * velocity_error_mrpm,uq_command_permyriad
+ *
+ * velocity_target_final_mrpm reports the current profile phase target.
+ * velocity_reference_mrpm reports the instantaneous reference fed to the controller.
+ * Fields belong to the primary axis.
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_ms Current time in milliseconds.
+ */
+static void app_emit_text_telemetry(app_context_t *app, uint32_t now_ms)
+{
+	uint16_t mechanical_angle_deg_x10 = 0u;
+	int32_t velocity_target_final_mrpm = 0;
+	int32_t velocity_reference_mrpm = 0;
+	int32_t velocity_filtered_mrpm = 0;
+	int32_t velocity_error_mrpm = 0;
+	int32_t uq_command_permyriad = 0;
+	telemetry_stream_snapshot_t snapshot;
+
+	if (app == NULL) return;
+	if (app->axis[0].latest_sample_valid == false) return;
+	/* All fields from one control-cycle snapshot, so the row is coherent. */
+	if (!telemetry_stream_get_snapshot(&app->telemetry_stream_h, &snapshot)) return;
+
+	/* Build one compact S-line with current control and telemetry state. */
+	mechanical_angle_deg_x10 =
+			app_angle_u16_to_deg_x10((uint16_t)snapshot.values[APP_TELEMETRY_CHANNEL_ANGLE]);
+	/* Report segment target and instantaneous controller reference separately for clarity. */
+	velocity_target_final_mrpm = snapshot.values[APP_TELEMETRY_CHANNEL_SEGMENT_TARGET];
+	velocity_reference_mrpm = snapshot.values[APP_TELEMETRY_CHANNEL_REFERENCE_SPEED];
+	velocity_filtered_mrpm = snapshot.values[APP_TELEMETRY_CHANNEL_FILTERED_SPEED];
+	velocity_error_mrpm = snapshot.values[APP_TELEMETRY_CHANNEL_SPEED_ERROR];
+	uq_command_permyriad = snapshot.values[APP_TELEMETRY_CHANNEL_UQ_COMMAND];
+
+	printf("S,%lu,%u,%ld,%ld,%ld,%ld,%ld\n",
+		   (unsigned long)now_ms,
+		   (unsigned)mechanical_angle_deg_x10,
+		   (long)velocity_filtered_mrpm,
+		   (long)velocity_target_final_mrpm,
+		   (long)velocity_reference_mrpm,
+		   (long)velocity_error_mrpm,
+		   (long)uq_command_permyriad);
+}
+
+/**
+ * @brief Emit one binary telemetry-stream frame (one per new control-cycle snapshot).
+ *
+ * Stream frame payload (type APP_TELEMETRY_FRAME_TYPE_STREAM): u16 mask of the
+ * channels carried, then their values in app_telemetry_channel_id_t order
+ * (registry widths). A channel is carried when it is selected by the channel
+ * mask and due by its decimation; a cycle with none due sends nothing.
+ * Channels belong to the primary axis.
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_us Current time in microseconds (unused, frames carry the snapshot time).
+ */
+static void app_emit_binary_telemetry(app_context_t *app, uint64_t now_us)
+{
+	telemetry_frame_t frame;
+
+	(void)now_us;
+	if (app == NULL) return;
+	if (app->axis[0].latest_sample_valid == false) return;
+
+	/* Pack the due channels of the latest snapshot without stdio and queue them as one block. */
+	if (telemetry_stream_encode(&app->telemetry_stream_h, &frame))
+	{
+		(void)telemetry_send(&app->telemetry_h, &frame);
+	}
 }
 
 /**
- * @brief Run one speed-controller update at fixed cadence.
+ * @brief Emit runtime telemetry in the configured format.
  *
  * @param app Pointer to application runtime context.
- * @param speed_pi_update_period_ms PI update period in milliseconds.
  * @param now_ms Current time in milliseconds.
+ * @param now_us Current time in microseconds.
  */
-static void app_update_speed_controller(app_context_t *app,
-										uint16_t speed_pi_update_period_ms,
-										uint32_t now_ms)
+static void app_emit_telemetry(app_context_t *app, uint32_t now_ms, uint64_t now_us)
 {
-	if ((app->alignment_done == false) ||
-		(app->motor_h.status.has_valid_mechanical_speed == false))
+	if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
 	{
-		app->last_speed_pi_update_ms = now_ms;
+		app_emit_binary_telemetry(app, now_us);
 		return;
 	}
 
-	/* Update closed-loop speed control in P-only mode (Ki=0 by config). */
-	if ((now_ms - app->last_speed_pi_update_ms) >= speed_pi_update_period_ms)
+	app_emit_text_telemetry(app, now_ms);
+}
+
+/**
+ * @brief Emit the profiler probe statistics (one dump per report release).
+ *
+ * One record per probe that has samples, in cycles (SYSCLK):
+ * text P,probe_id,count,min,max,mean or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_PROFILE, 17 bytes):
+ * u8 probe_id, u32 count, u32 min, u32 max, u32 mean
+ *
+ * Statistics accumulate from boot; each record is one consistent snapshot.
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_us Current time in microseconds (frame timestamp).
+ */
+static void app_emit_profile_telemetry(app_context_t *app, uint64_t now_us)
+{
+	profiler_probe_stats_t stats;
+	telemetry_frame_t frame;
+
+	if (app == NULL) return;
+	if (PROFILER_ENABLE == 0u) return;
+
+	for (uint32_t probe_id = 0u; probe_id < (uint32_t)PROFILER_PROBE_COUNT; probe_id++)
 	{
-		/* First bidirectional validation profile: conservative symmetric 0 -> +peak -> 0 -> -peak -> 0 cycle. */
-		app_speed_profile_update(app, now_ms);
+		if (!profiler_get_stats((profiler_probe_id_t)probe_id, &stats)) continue;
+		if (stats.count == 0u) continue;
 
-		/* Use the current profile reference for the active PI update. */
-		if (!motor_speed_pi_update(&app->motor_speed_pi_h,
-								   app->current_speed_control_reference_mrpm,
-								   app->motor_h.measurements.measured_mechanical_speed_mrpm))
+		uint32_t mean_cycles = (uint32_t)(stats.sum_cycles / stats.count);
+
+		if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
+		{
+			telemetry_frame_begin(&frame, APP_TELEMETRY_FRAME_TYPE_PROFILE, (uint32_t)now_us);
+			telemetry_frame_put_u8(&frame, (uint8_t)probe_id);
+			telemetry_frame_put_u32(&frame, stats.count);
+			telemetry_frame_put_u32(&frame, stats.min_cycles);
+			telemetry_frame_put_u32(&frame, stats.max_cycles);
+			telemetry_frame_put_u32(&frame, mean_cycles);
+			(void)telemetry_send(&app->telemetry_h, &frame);
+		}
+		else
 		{
-			app_fatal_stop(app, "MSPI", "update failed");
+			printf("P,%lu,%lu,%lu,%lu,%lu\n",
+				   (unsigned long)probe_id,
+				   (unsigned long)stats.count,
+				   (unsigned long)stats.min_cycles,
+				   (unsigned long)stats.max_cycles,
+				   (unsigned long)mean_cycles);
 		}
+	}
+}
+
+/**
+ * @brief Emit the main-loop scheduler task statistics (one dump per report release).
+ *
+ * One record per task in table order (app_task_id_t):
+ * text K,task_id,runs,max_exec_us,overruns,skips,catch_ups or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_SCHEDULER, 21 bytes):
+ * u8 task_id, u32 runs, u32 max_exec_us, u32 overruns, u32 skips, u32 catch_ups
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_us Current time in microseconds (frame timestamp).
+ */
+static void app_emit_scheduler_telemetry(app_context_t *app, uint64_t now_us)
+{
+	scheduler_task_stats_t stats;
+	telemetry_frame_t frame;
+
+	for (uint8_t task_id = 0u; task_id < (uint8_t)APP_TASK_COUNT; task_id++)
+	{
+		if (!scheduler_get_task_stats(&app->scheduler_h, task_id, &stats)) continue;
 
-		app->last_speed_pi_update_ms += speed_pi_update_period_ms;
+		if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
+		{
+			telemetry_frame_begin(&frame, APP_TELEMETRY_FRAME_TYPE_SCHEDULER, (uint32_t)now_us);
+			telemetry_frame_put_u8(&frame, task_id);
+			telemetry_frame_put_u32(&frame, stats.run_count);
+			telemetry_frame_put_u32(&frame, stats.max_exec_us);
+			telemetry_frame_put_u32(&frame, stats.overrun_count);
+			telemetry_frame_put_u32(&frame, stats.skip_count);
+			telemetry_frame_put_u32(&frame, stats.catch_up_count);
+			(void)telemetry_send(&app->telemetry_h, &frame);
+		}
+		else
+		{
+			printf("K,%u,%lu,%lu,%lu,%lu,%lu\n",
+				   (unsigned)task_id,
+				   (unsigned long)stats.run_count,
+				   (unsigned long)stats.max_exec_us,
+				   (unsigned long)stats.overrun_count,
+				   (unsigned long)stats.skip_count,
+				   (unsigned long)stats.catch_up_count);
+		}
 	}
 }
 
 /**
- * @brief Advance startup alignment and post-alignment closed-loop actuation.
+ * @brief Emit the main-loop CPU load since the previous report release.
+ *
+ * Idle time is the time spent in empty passes, including the WFI sleep:
+ * text U,load_permyriad,window_us,idle_us,passes,sleeps or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_LOAD, 18 bytes):
+ * u16 load_permyriad, u32 window_us, u32 idle_us, u32 passes, u32 sleeps
  *
  * @param app Pointer to application runtime context.
- * @param actuation_update_period_ms Runtime actuation update period in milliseconds.
- * @param now_ms Current time in milliseconds.
+ * @param now_us Current time in microseconds (frame timestamp).
  */
-static void app_update_runtime_actuation(app_context_t *app,
-										 uint16_t actuation_update_period_ms,
-										 uint32_t now_ms)
+static void app_emit_load_telemetry(app_context_t *app, uint64_t now_us)
 {
-	uint16_t raw_electrical_angle_u16 = 0u;
-	uint16_t electrical_offset_u16 = 0u;
+	scheduler_load_t load;
+	telemetry_frame_t frame;
+
+	if (!scheduler_get_load(&app->scheduler_h, &load)) return;
+
+	if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
+	{
+		telemetry_frame_begin(&frame, APP_TELEMETRY_FRAME_TYPE_LOAD, (uint32_t)now_us);
+		telemetry_frame_put_u16(&frame, load.load_permyriad);
+		telemetry_frame_put_u32(&frame, load.window_us);
+		telemetry_frame_put_u32(&frame, load.idle_us);
+		telemetry_frame_put_u32(&frame, load.pass_count);
+		telemetry_frame_put_u32(&frame, load.sleep_count);
+		(void)telemetry_send(&app->telemetry_h, &frame);
+	}
+	else
+	{
+		printf("U,%u,%lu,%lu,%lu,%lu\n",
+			   (unsigned)load.load_permyriad,
+			   (unsigned long)load.window_us,
+			   (unsigned long)load.idle_us,
+			   (unsigned long)load.pass_count,
+			   (unsigned long)load.sleep_count);
+	}
+}
 
-	/* Hold the alignment vector before phase progression starts. */
-	if (app->alignment_done == false)
+/**
+ * @brief Emit the timing-monitor channel histograms (one dump per report release).
+ *
+ * One record per channel in timing_monitor_channel_t order, jitter |interval - nominal|
+ * for the period channels and the delay for the latency channel, in us:
+ * text J,channel,samples,max_us,late,missed,catch_ups,dropped,bin0..bin5 or one binary frame
+ * (type APP_TELEMETRY_FRAME_TYPE_TIMING, 45 bytes):
+ * u8 channel, u32 max_us, u32 late, u32 missed, u32 catch_ups, u32 dropped, u32 bins[6]
+ *
+ * The sample count is the sum of the bins. Dropped counts the angle samples
+ * that never reached an actuation (stale or failed conversions, overwritten publishes).
+ *
+ * @param app Pointer to application runtime context.
+ * @param now_us Current time in microseconds (frame timestamp).
+ */
+static void app_emit_timing_telemetry(app_context_t *app, uint64_t now_us)
+{
+	timing_monitor_channel_stats_t stats;
+	telemetry_frame_t frame;
+
+	if (app_timing_monitor_enabled() == false) return;
+
+	app_axis_t *axis = &app->axis[0];
+	uint32_t dropped_count = app_angle_sensor_uses_i2c() ?
+			(axis->as5600_i2c_h.dropped_publish_count +
+			 axis->as5600_i2c_h.failed_transfer_count +
+			 axis->as5600_i2c_h.timeout_count) :
+			(axis->as5600_analog_h.dropped_publish_count +
+			 axis->as5600_analog_h.stale_conversion_count);
+	(void)timing_monitor_set_dropped_count(&app->timing_monitor_h,
+										   TIMING_MONITOR_CHANNEL_SAMPLE_TO_ACTUATION,
+										   dropped_count);
+
+	for (uint8_t channel = 0u; channel < (uint8_t)TIMING_MONITOR_CHANNEL_COUNT; channel++)
 	{
-		if ((now_ms - app->alignment_start_ms) >= APP_MOTOR_TEST_ALIGNMENT_DURATION_MS)
+		if (!timing_monitor_get_stats(&app->timing_monitor_h, (timing_monitor_channel_t)channel, &stats)) continue;
+
+		if (APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY)
 		{
-			/* Wait for one valid consumed sensor sample before alignment calibration. */
-			if (app->latest_sample_valid == false)
+			telemetry_frame_begin(&frame, APP_TELEMETRY_FRAME_TYPE_TIMING, (uint32_t)now_us);
+			telemetry_frame_put_u8(&frame, channel);
+			telemetry_frame_put_u32(&frame, stats.max_us);
+			telemetry_frame_put_u32(&frame, stats.late_count);
+			telemetry_frame_put_u32(&frame, stats.missed_count);
+			telemetry_frame_put_u32(&frame, stats.catch_up_count);
+			telemetry_frame_put_u32(&frame, stats.dropped_count);
+			for (uint32_t bin = 0u; bin < TIMING_MONITOR_BIN_COUNT; bin++)
 			{
-				return;
+				telemetry_frame_put_u32(&frame, stats.bins[bin]);
 			}
-
-			/* Convert measured mechanical angle into raw electrical angle without offset. */
-			if (!motor_electrical_angle_compute_raw(&app->motor_electrical_angle_h,
-													app->latest_logged_mechanical_angle_u16,
-													&raw_electrical_angle_u16))
+			(void)telemetry_send(&app->telemetry_h, &frame);
+		}
+		else
+		{
+			printf("J,%u,%lu,%lu,%lu,%lu,%lu,%lu",
+				   (unsigned)channel,
+				   (unsigned long)stats.sample_count,
+				   (unsigned long)stats.max_us,
+				   (unsigned long)stats.late_count,
+				   (unsigned long)stats.missed_count,
+				   (unsigned long)stats.catch_up_count,
+				   (unsigned long)stats.dropped_count);
+			for (uint32_t bin = 0u; bin < TIMING_MONITOR_BIN_COUNT; bin++)
 			{
-				app_fatal_stop(app, "MEANG", "raw angle failed");
+				printf(",%lu", (unsigned long)stats.bins[bin]);
 			}
+			printf("\n");
+		}
+	}
+}
 
-			/* offset = commanded_alignment_electrical - measured_raw_electrical. */
-			electrical_offset_u16 =
-					(uint16_t)(APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16 -
-							  raw_electrical_angle_u16);
-			if (!motor_electrical_angle_set_offset(&app->motor_electrical_angle_h, electrical_offset_u16))
-			{
-				app_fatal_stop(app, "MEANG", "offset set failed");
-			}
+/**
+ * @brief Task: expand queued deferred log records in the background.
+ *
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_log_drain(void *arg, uint64_t now_us)
+{
+	(void)arg;
+	(void)now_us;
+	(void)log_drain(APP_MOTOR_TEST_LOG_DRAIN_RECORDS_PER_RELEASE);
+}
 
-			/* Publish the calibrated measured electrical angle from the same alignment sample. */
-			if (!motor_electrical_angle_update(&app->motor_electrical_angle_h, app->latest_logged_mechanical_angle_u16))
-			{
-				app_fatal_stop(app, "MEANG", "aligned update failed");
-			}
+/**
+ * @brief Service the AS5600 acquisition of one axis and consume its published sample.
+ *
+ * @param axis Pointer to axis runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_service_angle_acquisition(app_axis_t *axis, uint64_t now_us)
+{
+	as5600_analog_published_sample_t published_angle_sample = {0};
 
-			/* Start q-only FOC runtime with zero Uq before first closed-loop update is applied. */
-			if (!motor_speed_pi_reset(&app->motor_speed_pi_h))
-			{
-				app_fatal_stop(app, "MSPI", "reset failed");
-			}
-			/* Start the bidirectional tuning profile from the first zero-hold phase. */
-			app_speed_profile_reset(app, now_ms);
-			app->applied_uq_command_permyriad = 0u;
-			app->alignment_done = true;
-			app->last_actuation_update_ms = now_ms;
-			app->last_speed_pi_update_ms = now_ms;
+	bool has_published_sample = false;
+
+	if (app_angle_sensor_uses_i2c())
+	{
+		/* Start the next I2C angle read when its slot is due (completion runs in the ISR). */
+		if (!as5600_i2c_service(&axis->as5600_i2c_h, now_us))
+		{
+			app_fatal_stop(axis->app, "AS5600", "i2c update failed");
+		}
+		has_published_sample = as5600_i2c_consume_published_sample(&axis->as5600_i2c_h, &published_angle_sample);
+	}
+	else
+	{
+		/* Service SysTick-driven AS5600 raw-sample scheduling (no-op in timer DMA mode). */
+		if (!as5600_analog_service(&axis->as5600_analog_h, now_us))
+		{
+			app_fatal_stop(axis->app, "AS5600", "update failed");
 		}
+		has_published_sample = as5600_analog_consume_published_sample(&axis->as5600_analog_h, &published_angle_sample);
+	}
 
-		return;
+	/* Consume one fixed-period published AS5600 mechanical-angle sample. */
+	if (has_published_sample)
+	{
+		app_handle_consumed_angle_sample(axis, &published_angle_sample);
 	}
+}
+
+/**
+ * @brief Task: service the AS5600 acquisition and consume published samples of every axis.
+ *
+ * Background task (every pass, or on APP_EVENT_ANGLE_SAMPLE in event idle):
+ * published samples are handled without waiting for the next 1 ms release.
+ *
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_angle_acquisition(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
 
-	/* After alignment, apply q-only sensored voltage actuation with controller-driven Uq. */
-	if ((now_ms - app->last_actuation_update_ms) >= actuation_update_period_ms)
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
 	{
-		/* Use the current limited speed-controller output as the applied q-axis command. */
-		app->applied_uq_command_permyriad =
-				(int16_t)app->motor_h.speed_pi.speed_control_uq_command_permyriad;
+		app_service_angle_acquisition(&app->axis[i], now_us);
+	}
+}
 
-		if (!motor_foc_voltage_apply_dq(&app->motor_foc_voltage_h,
-										0,
-										app->applied_uq_command_permyriad))
-		{
-			app_fatal_stop(app, "MFOC", "apply failed");
-		}
+/**
+ * @brief Task: closed-loop speed controller step of every axis.
+ *
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_speed_control(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
 
-		app->last_actuation_update_ms += actuation_update_period_ms;
+	(void)now_us;
+	app_timing_record_period(app, TIMING_MONITOR_CHANNEL_SPEED_PERIOD);
+	/* Control-step boundary: staged parameters and the next streamed point take effect here. */
+	app_command_apply_pending_params(app);
+	if (app_command_get_active_params(app)->reference_mode == (uint8_t)APP_REFERENCE_MODE_STREAM)
+	{
+		app_command_reference_stream_next(app);
+	}
+	if ((app_command_get_active_params(app)->reference_mode == (uint8_t)APP_REFERENCE_MODE_POSITION) &&
+		(app->position_move.is_pending))
+	{
+		app_command_start_position_move(app);
+	}
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_update_speed_controller(&app->axis[i]);
 	}
 }
 
 /**
- * @brief Emit one compact S-line telemetry record at fixed period.
+ * @brief Task: steady-state speed-error protection and latched-fault report.
  *
- * S-line fields:
- * S,timestamp_ms,mechanical_angle_deg_x10,velocity_filtered_mrpm,
- * velocity_target_final_mrpm,velocity_reference_mrpm,
- * velocity_error_mrpm,uq_command_permyriad
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_fault_check(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
+
+	(void)now_us;
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_check_speed_error_fault(&app->axis[i]);
+	}
+	app_check_timing_fault(app);
+	app_handle_latched_fault(app);
+}
+
+/**
+ * @brief Task: alignment sequencing and superloop FOC actuation of every axis.
  *
- * velocity_target_final_mrpm reports the current profile phase target.
- * velocity_reference_mrpm reports the instantaneous reference fed to the controller.
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_runtime_actuation(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
+	uint32_t now_ms = SYSTICK_GetTimeMs();
+
+	app_timing_record_period(app, TIMING_MONITOR_CHANNEL_ACTUATION_PERIOD);
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_axis_update_runtime_actuation(&app->axis[i], now_ms);
+	}
+	/* Superloop: this pass ends the control cycle (speed step and actuation both written). An ISR
+	 * actuation path rewrites uq, angle and currents itself, so it samples at the end of its next cycle. */
+	if ((app_control_loop_uses_pwm_isr() == false) && (app_torque_control_uses_current_loop() == false))
+	{
+		(void)telemetry_stream_sample(&app->telemetry_stream_h, (uint32_t)now_us);
+	}
+	else
+	{
+		app->telemetry_sample_pending = true;
+	}
+}
+
+/**
+ * @brief Task: runtime telemetry, replaced by the scope rows while a capture is sent.
  *
- * @param app Pointer to application runtime context.
- * @param now_ms Current time in milliseconds.
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
  */
-static void app_emit_telemetry(app_context_t *app, uint32_t now_ms)
+static void app_task_telemetry(void *arg, uint64_t now_us)
 {
-	uint16_t mechanical_angle_deg_x10 = 0u;
-	int32_t velocity_target_final_mrpm = 0;
-	int32_t velocity_reference_mrpm = 0;
-	int32_t velocity_filtered_mrpm = 0;
-	int32_t velocity_error_mrpm = 0;
+	app_context_t *app = (app_context_t *)arg;
 
-	if (app == NULL) return;
-	if (app->latest_sample_valid == false) return;
-	if ((now_ms - app->last_telemetry_ms) < APP_MOTOR_TEST_TELEMETRY_PERIOD_MS) return;
+	PROFILER_SCOPE_BEGIN(PROFILER_PROBE_TELEMETRY);
+	if (!app_emit_scope_dump(app, now_us))
+	{
+		app_emit_telemetry(app, SYSTICK_GetTimeMs(), now_us);
+	}
+	PROFILER_SCOPE_END(PROFILER_PROBE_TELEMETRY);
+}
 
-	/* Build one compact S-line with current control and telemetry state. */
-	mechanical_angle_deg_x10 =
-			app_angle_u16_to_deg_x10(app->latest_logged_mechanical_angle_u16);
-	/* Report phase target and instantaneous controller reference separately for clarity. */
-	velocity_target_final_mrpm = app_speed_profile_phase_target_mrpm(app->speed_profile_phase);
-	velocity_reference_mrpm = app->current_speed_control_reference_mrpm;
-	velocity_filtered_mrpm = app->motor_h.speed_feedback.filtered_mechanical_speed_mrpm;
-	velocity_error_mrpm = app->motor_h.speed_pi.speed_error_mrpm;
+/**
+ * @brief Task: slow profiler, scheduler statistics and CPU-load report.
+ *
+ * @param arg Application runtime context.
+ * @param now_us Pass start time in microseconds.
+ */
+static void app_task_report(void *arg, uint64_t now_us)
+{
+	app_context_t *app = (app_context_t *)arg;
 
-	printf("S,%lu,%u,%ld,%ld,%ld,%ld,%ld\n",
-		   (unsigned long)now_ms,
-		   (unsigned)mechanical_angle_deg_x10,
-		   (long)velocity_filtered_mrpm,
-		   (long)velocity_target_final_mrpm,
-		   (long)velocity_reference_mrpm,
-		   (long)velocity_error_mrpm,
-		   (long)app->applied_uq_command_permyriad);
-	app->last_telemetry_ms += APP_MOTOR_TEST_TELEMETRY_PERIOD_MS;
+	app_emit_profile_telemetry(app, now_us);
+	app_emit_scheduler_telemetry(app, now_us);
+	app_emit_load_telemetry(app, now_us);
+	app_emit_timing_telemetry(app, now_us);
 }
 
 int main(void)
 {
-	app_context_t app = {0};
-	as5600_analog_published_sample_t published_angle_sample = {0};
-	const uint32_t speed_feedback_sample_period_us =
-			APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US *
-			(uint32_t)APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
-	const motor_3pwm_cfg_t motor_3pwm_cfg = {
-			.pwm_h = &PWM_H,
+	/* Static storage: the context and the axis configurations stay off the main stack. */
+	static app_context_t app;
+	static app_axis_cfg_t axis_cfgs[MOTOR_AXIS_COUNT];
+	/* The scope, telemetry and calibration record follow the primary axis. */
+	const motor_scope_cfg_t motor_scope_cfg = {
+			.motor_h = &app.axis[0].motor_h,
+			.motor_3pwm_h = &app.axis[0].motor_3pwm_h,
+			.sample_buffer = app_scope_buffer,
+			.sample_capacity = APP_MOTOR_TEST_SCOPE_SAMPLE_COUNT,
+			.pre_trigger_samples = APP_MOTOR_TEST_SCOPE_PRE_TRIGGER_SAMPLES,
+			.decimation = APP_MOTOR_TEST_SCOPE_DECIMATION,
+			.channel_count = MOTOR_SCOPE_MAX_CHANNELS,
+			.channels = {
+					APP_MOTOR_TEST_SCOPE_CHANNEL_0,
+					APP_MOTOR_TEST_SCOPE_CHANNEL_1,
+					APP_MOTOR_TEST_SCOPE_CHANNEL_2,
+					APP_MOTOR_TEST_SCOPE_CHANNEL_3,
+			},
+			.trigger_mode = (APP_MOTOR_TEST_SCOPE_TRIGGER == APP_MOTOR_TEST_SCOPE_TRIGGER_SPEED_ERROR) ?
+					MOTOR_SCOPE_TRIGGER_ABS_LEVEL :
+					MOTOR_SCOPE_TRIGGER_EXTERNAL,
+			.trigger_channel_index = APP_MOTOR_TEST_SCOPE_LEVEL_CHANNEL_INDEX,
+			.trigger_level = APP_MOTOR_TEST_SCOPE_SPEED_ERROR_TRIGGER_MRPM,
 	};
-	const motor_openloop_cfg_t motor_openloop_cfg = {
-			.motor_h = &app.motor_h,
-			.motor_3pwm_h = &app.motor_3pwm_h,
-			.update_period_ms = APP_MOTOR_TEST_UPDATE_PERIOD_MS,
-			.phase_increment_ramp_step_u32 = APP_MOTOR_TEST_STARTUP_OPENLOOP_PHASE_INCREMENT_RAMP_STEP_U32,
+	const telemetry_cfg_t telemetry_cfg = {
+			.usart_h = &USART2_H,
 	};
-	const motor_foc_voltage_cfg_t motor_foc_voltage_cfg = {
-			.motor_h = &app.motor_h,
-			.motor_3pwm_h = &app.motor_3pwm_h,
-			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+	/* Registry in app_telemetry_channel_id_t order; every channel at unity scale. */
+	const app_axis_t *telemetry_axis = &app.axis[0];
+	const telemetry_stream_channel_t telemetry_channels[APP_TELEMETRY_CHANNEL_COUNT] = {
+			[APP_TELEMETRY_CHANNEL_ANGLE] = {
+					"angle", &telemetry_axis->latest_logged_mechanical_angle_u16,
+					TELEMETRY_STREAM_TYPE_U16, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_FILTERED_SPEED] = {
+					"filtered_mrpm", &telemetry_axis->motor_h.speed_feedback.filtered_mechanical_speed_mrpm,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_REFERENCE_SPEED] = {
+					"reference_mrpm", &telemetry_axis->motor_h.trajectory.reference_mechanical_speed_mrpm,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_UQ_COMMAND] = {
+					"uq_permyriad", &telemetry_axis->applied_uq_command_permyriad,
+					TELEMETRY_STREAM_TYPE_I16, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_TRAJECTORY_STEP] = {
+					"step", &telemetry_axis->motor_h.trajectory.step_index,
+					TELEMETRY_STREAM_TYPE_U8, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_SEGMENT_TARGET] = {
+					"target_mrpm", &telemetry_axis->motor_h.trajectory.segment_target_mechanical_speed_mrpm,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_SPEED_ERROR] = {
+					"error_mrpm", &telemetry_axis->motor_h.speed_pi.speed_error_mrpm,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_RAW_SPEED] = {
+					"raw_mrpm", &telemetry_axis->motor_h.speed_feedback.raw_mechanical_speed_mrpm,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_SPEED_INTEGRATOR] = {
+					"integrator_permyriad", &telemetry_axis->motor_h.speed_pi.integrator_term_permyriad,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_SPEED_FEEDFORWARD] = {
+					"feedforward_permyriad", &telemetry_axis->motor_h.speed_pi.feedforward_term_permyriad,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_ID] = {
+					"id_ma", &telemetry_axis->motor_h.current.id_ma,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_IQ] = {
+					"iq_ma", &telemetry_axis->motor_h.current.iq_ma,
+					TELEMETRY_STREAM_TYPE_I32, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
+			[APP_TELEMETRY_CHANNEL_ELECTRICAL_ANGLE] = {
+					"electrical_angle", &telemetry_axis->motor_h.measurements.electrical_angle_u16,
+					TELEMETRY_STREAM_TYPE_U16, TELEMETRY_STREAM_SCALE_UNITY_Q16,
+			},
 	};
-	const motor_electrical_angle_cfg_t motor_electrical_angle_cfg = {
-			.motor_h = &app.motor_h,
-			.electrical_offset_u16 = 0u,
+	const telemetry_stream_cfg_t telemetry_stream_cfg = {
+			.channels = telemetry_channels,
+			.channel_count = (uint8_t)APP_TELEMETRY_CHANNEL_COUNT,
+			.frame_type = APP_TELEMETRY_FRAME_TYPE_STREAM,
 	};
-	const motor_speed_feedback_cfg_t motor_speed_feedback_cfg = {
-			.motor_h = &app.motor_h,
-			.sample_period_us = speed_feedback_sample_period_us,
-			.filter_time_constant_ms = APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
-			/* Keep control-direction sign separate from sensor and phase wiring signs. */
-			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+	const command_cfg_t command_cfg = {
+			.usart_h = &USART2_H,
 	};
-	const motor_speed_pi_cfg_t motor_speed_pi_cfg = {
-			.motor_h = &app.motor_h,
-			.kp_q15 = APP_MOTOR_TEST_SPEED_PI_KP_Q15,
-			.ki_per_s_q15 = APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15,
-			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
-			.output_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+	/* Task table in app_task_id_t order; equal periods run in priority order within one pass. */
+	const scheduler_task_cfg_t app_tasks[APP_TASK_COUNT] = {
+			[APP_TASK_ANGLE_ACQUISITION] = {
+					.fn = app_task_angle_acquisition, .arg = &app,
+					.period_us = 0u, .phase_us = 0u, .deadline_us = 0u,
+					.priority = 0u, .miss_policy = SCHEDULER_MISS_SKIP,
+					.event_mask = app_scheduler_event_driven() ? APP_EVENT_ANGLE_SAMPLE : 0u,
+			},
+			[APP_TASK_SPEED_CONTROL] = {
+					.fn = app_task_speed_control, .arg = &app,
+					.period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_PHASE_US,
+					.deadline_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_DEADLINE_US,
+					.priority = 1u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_FAULT_CHECK] = {
+					.fn = app_task_fault_check, .arg = &app,
+					.period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_PHASE_US,
+					.deadline_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_DEADLINE_US,
+					.priority = 2u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_RUNTIME_ACTUATION] = {
+					.fn = app_task_runtime_actuation, .arg = &app,
+					.period_us = APP_MOTOR_TEST_UPDATE_PERIOD_MS * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_PHASE_US,
+					.deadline_us = APP_MOTOR_TEST_SCHEDULER_CONTROL_DEADLINE_US,
+					.priority = 3u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_TELEMETRY] = {
+					.fn = app_task_telemetry, .arg = &app,
+					.period_us = ((APP_MOTOR_TEST_TELEMETRY_FORMAT == APP_MOTOR_TEST_TELEMETRY_FORMAT_BINARY) ?
+								  APP_MOTOR_TEST_BINARY_TELEMETRY_PERIOD_MS :
+								  APP_MOTOR_TEST_TELEMETRY_PERIOD_MS) * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_TELEMETRY_PHASE_US,
+					.deadline_us = 0u,
+					.priority = 4u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_REPORT] = {
+					.fn = app_task_report, .arg = &app,
+					.period_us = APP_MOTOR_TEST_PROFILE_DUMP_PERIOD_MS * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_REPORT_PHASE_US,
+					.deadline_us = 0u,
+					.priority = 5u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_LOG_DRAIN] = {
+					.fn = app_task_log_drain, .arg = &app,
+					.period_us = APP_MOTOR_TEST_LOG_DRAIN_PERIOD_MS * 1000u,
+					.phase_us = APP_MOTOR_TEST_SCHEDULER_LOG_DRAIN_PHASE_US,
+					.deadline_us = 0u,
+					.priority = 6u, .miss_policy = SCHEDULER_MISS_SKIP,
+			},
+			[APP_TASK_COMMAND] = {
+					.fn = app_command_task, .arg = &app,
+					.period_us = 0u, .phase_us = 0u, .deadline_us = 0u,
+					.priority = 7u, .miss_policy = SCHEDULER_MISS_SKIP,
+					.event_mask = app_scheduler_event_driven() ? APP_EVENT_COMMAND_RX : 0u,
+			},
 	};
-	const motor_speed_reference_estimator_cfg_t motor_speed_reference_estimator_cfg = {
-			.motor_h = &app.motor_h,
-			.history_sample_count = APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT,
+	const calibration_store_cfg_t calibration_store_cfg = {
+			.base_address = (uint32_t)_scalibration,
+			.size_bytes = (uint32_t)((uintptr_t)_ecalibration - (uintptr_t)_scalibration),
+			.sector = APP_MOTOR_TEST_CALIBRATION_STORE_FLASH_SECTOR,
 	};
-	const as5600_analog_cfg_t as5600_analog_cfg = {
-			.adc_h = &ADC1_IN0_H,
-			.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
-			.raw_sample_period_us = APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US,
-			.raw_samples_per_publish = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT,
-			.wrap_correction_threshold_counts = (uint16_t)APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS,
-			.max_plausible_delta_per_publish_counts =
-					(uint16_t)APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
-			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
-					AS5600_ANALOG_DIRECTION_REVERSE :
-					AS5600_ANALOG_DIRECTION_FORWARD,
+	const timing_monitor_cfg_t timing_monitor_cfg = {
+			.channels = {
+					[TIMING_MONITOR_CHANNEL_SPEED_PERIOD] = {
+							.nominal_period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u,
+							.bin_width_us = APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_BIN_US,
+							.late_limit_us = APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_LATE_US,
+							.fault_late_count = APP_MOTOR_TEST_TIMING_MONITOR_FAULT_LATE_COUNT,
+					},
+					[TIMING_MONITOR_CHANNEL_ACTUATION_PERIOD] = {
+							.nominal_period_us = APP_MOTOR_TEST_UPDATE_PERIOD_MS * 1000u,
+							.bin_width_us = APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_BIN_US,
+							.late_limit_us = APP_MOTOR_TEST_TIMING_MONITOR_PERIOD_LATE_US,
+							.fault_late_count = APP_MOTOR_TEST_TIMING_MONITOR_FAULT_LATE_COUNT,
+					},
+					[TIMING_MONITOR_CHANNEL_SAMPLE_TO_ACTUATION] = {
+							.nominal_period_us = 0u,
+							.bin_width_us = APP_MOTOR_TEST_TIMING_MONITOR_LATENCY_BIN_US,
+							.late_limit_us = APP_MOTOR_TEST_TIMING_MONITOR_LATENCY_LATE_US,
+							.fault_late_count = APP_MOTOR_TEST_TIMING_MONITOR_FAULT_LATE_COUNT,
+					},
+			},
+	};
+	const scheduler_cfg_t scheduler_cfg = {
+			.tasks = app_tasks,
+			.task_count = (uint8_t)APP_TASK_COUNT,
+			.get_time_us = SYSTICK_GetTimeUs,
+			.idle_wfi = (APP_MOTOR_TEST_SCHEDULER_IDLE_MODE != APP_MOTOR_TEST_SCHEDULER_IDLE_MODE_BUSY),
 	};
 	app_init_context(&app);
+	for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
+	{
+		app_build_axis_cfg(&app.axis[i], &axis_cfgs[i]);
+	}
 	app_init_modules(&app,
-					 &motor_3pwm_cfg,
-					 &motor_openloop_cfg,
-					 &motor_foc_voltage_cfg,
-					 &motor_electrical_angle_cfg,
-					 &motor_speed_feedback_cfg,
-					 &motor_speed_pi_cfg,
-					 &motor_speed_reference_estimator_cfg,
-					 &as5600_analog_cfg);
-	app_start_motor_test(&app, APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16);
-
-	/* Loop forever */
-	while(1)
+					 axis_cfgs,
+					 &motor_scope_cfg,
+					 &telemetry_cfg,
+					 &telemetry_stream_cfg,
+					 &command_cfg,
+					 &scheduler_cfg,
+					 &timing_monitor_cfg,
+					 &calibration_store_cfg);
+
+	/* Hook the current loop onto the ADC2 injected sequence before the offset calibration starts. */
+	if ((app_torque_control_uses_current_loop()) &&
+		(!adc_injected_register_callback(&CURRENT_SENSE_ADC2_H, app_axis_current_loop_callback, &app.axis[0])))
 	{
-		uint32_t now_ms = SYSTICK_GetTimeMs();
-		uint64_t now_us = SYSTICK_GetTimeUs();
+		app_fatal_trap("MCUR", "callback register failed");
+	}
 
-		/* Service SysTick-driven AS5600 raw-sample scheduling. */
-		if (!as5600_analog_service(&app.as5600_analog_h, now_us))
-		{
-			app_fatal_stop(&app, "AS5600", "update failed");
-		}
+	app_start_motor_test(&app, APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16);
 
-		/* Consume one fixed-period published AS5600 mechanical-angle sample. */
-		if (as5600_analog_consume_published_sample(&app.as5600_analog_h, &published_angle_sample))
+	/* Hook each axis fast loop onto the update event of its own timer when PWM ISR mode is selected. */
+	if (app_control_loop_uses_pwm_isr())
+	{
+		for (uint8_t i = 0u; i < MOTOR_AXIS_COUNT; i++)
 		{
-			app_handle_consumed_angle_sample(&app, &published_angle_sample, now_us);
+			if ((!pwm_tim1_register_update_callback(app.axis[i].pwm_h, app_axis_fast_loop_callback, &app.axis[i])) ||
+				(!pwm_tim1_enable_update_irq(app.axis[i].pwm_h, APP_MOTOR_TEST_FAST_LOOP_PWM_DIVIDER)))
+			{
+				app_fatal_stop(&app, "PWM", "fast loop start failed");
+			}
 		}
+	}
 
-		/* Run closed-loop speed controller updates at fixed control cadence. */
-		app_update_speed_controller(&app, APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS, now_ms);
-
-		/* Keep speed-error protection active without verbose fault dump machinery. */
-		app_check_speed_error_fault(&app, now_ms);
-
-		/* Advance alignment and apply q-only FOC actuation with controller-driven Uq. */
-		app_update_runtime_actuation(&app,
-									 APP_MOTOR_TEST_UPDATE_PERIOD_MS,
-									 now_ms);
-
-		/* Emit lightweight runtime telemetry at fixed low rate. */
-		app_emit_telemetry(&app, now_ms);
+	/* Loop forever: every periodic job is released by the task table. */
+	while(1)
+	{
+		(void)scheduler_run_pass(&app.scheduler_h);
 	}
 }
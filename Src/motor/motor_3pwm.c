@@ -5,26 +5,98 @@
  */
 
 #include "motor/motor_3pwm.h"
+#include "drivers/memory_section.h"
 #include <stddef.h>
 
 /**
- * @brief Apply one duty value in permyriad units to one PWM channel.
+ * @brief Convert one duty value in permyriad units to compare ticks.
  *
- * @param pwm_h Pointer to PWM handle.
- * @param ch PWM channel number (1..3).
+ * Same result as ARR * duty / 10000 (floor): the Q32 factor overshoots by
+ * less than 2^-32 per permyriad, far below the 1/10000 tick resolution.
+ *
+ * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
  * @param duty_permyriad Duty in permyriad units (0..10000).
+ * @return Duty in timer ticks (0..ARR).
+ */
+static uint16_t motor_3pwm_permyriad_to_ticks(const motor_3pwm_handle_t *motor_3pwm_h,
+											  uint16_t duty_permyriad)
+{
+	return (uint16_t)(((uint64_t)duty_permyriad * motor_3pwm_h->ticks_per_permyriad_q32) >> 32);
+}
+
+/**
+ * @brief Add the dead-time offset of one phase to its compare value.
+ *
+ * @param duty_ticks Duty in timer ticks (0..arr).
+ * @param arr TIM1 ARR.
+ * @param comp_ticks Dead-time offset in ticks.
+ * @param polarity Current polarity (-1 / 0 / +1).
+ * @return Compensated duty in timer ticks (0..arr).
+ */
+MEMORY_SECTION_RAMFUNC
+static uint16_t motor_3pwm_compensate_ticks(uint16_t duty_ticks,
+											uint16_t arr,
+											uint16_t comp_ticks,
+											int8_t polarity)
+{
+	/* A phase held at a rail does not switch: no dead time to compensate. */
+	if ((duty_ticks == 0u) || (duty_ticks >= arr)) return duty_ticks;
+
+	int32_t ticks = (int32_t)duty_ticks + ((int32_t)polarity * (int32_t)comp_ticks);
+	if (ticks < 0) return 0u;
+	if (ticks > (int32_t)arr) return arr;
+	return (uint16_t)ticks;
+}
+
+/**
+ * @brief Write three compare values after dead-time compensation.
+ *
+ * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
+ * @param phase_a_duty_ticks Phase A duty in ticks (0..ARR).
+ * @param phase_b_duty_ticks Phase B duty in ticks (0..ARR).
+ * @param phase_c_duty_ticks Phase C duty in ticks (0..ARR).
  * @return true if duty update succeeded, false otherwise.
  */
-static bool motor_3pwm_set_pwm_permyriad(pwm_tim1_handle_t *pwm_h,
-									 uint8_t ch,
-									 uint16_t duty_permyriad)
+MEMORY_SECTION_RAMFUNC
+static bool motor_3pwm_write_ticks(motor_3pwm_handle_t *motor_3pwm_h,
+								   uint16_t phase_a_duty_ticks,
+								   uint16_t phase_b_duty_ticks,
+								   uint16_t phase_c_duty_ticks)
 {
-	if (pwm_h == NULL) return false;
-	if ((ch < 1u) || (ch > 3u)) return false;
-	if (duty_permyriad > 10000u) return false;
+	pwm_tim1_handle_t *pwm_h = motor_3pwm_h->cfg->pwm_h;
+	uint16_t comp_ticks = motor_3pwm_h->dead_time_comp_ticks;
 
-	uint16_t duty_ticks = (uint16_t)(((uint32_t)pwm_h->arr * (uint32_t)duty_permyriad) / 10000u);
-	return pwm_tim1_set_duty(pwm_h, ch, duty_ticks);
+	if (comp_ticks != 0u)
+	{
+		phase_a_duty_ticks = motor_3pwm_compensate_ticks(phase_a_duty_ticks, pwm_h->arr, comp_ticks,
+														 motor_3pwm_h->phase_a_polarity);
+		phase_b_duty_ticks = motor_3pwm_compensate_ticks(phase_b_duty_ticks, pwm_h->arr, comp_ticks,
+														 motor_3pwm_h->phase_b_polarity);
+		phase_c_duty_ticks = motor_3pwm_compensate_ticks(phase_c_duty_ticks, pwm_h->arr, comp_ticks,
+														 motor_3pwm_h->phase_c_polarity);
+	}
+
+	if (!pwm_tim1_set_duty_abc(pwm_h, phase_a_duty_ticks, phase_b_duty_ticks, phase_c_duty_ticks)) return false;
+
+	motor_3pwm_h->phase_a_duty_ticks = phase_a_duty_ticks;
+	motor_3pwm_h->phase_b_duty_ticks = phase_b_duty_ticks;
+	motor_3pwm_h->phase_c_duty_ticks = phase_c_duty_ticks;
+	return true;
+}
+
+/**
+ * @brief Map one polarity source value to -1 / 0 / +1 with a zero-crossing band.
+ *
+ * @param value Polarity source value.
+ * @param band Non-negative band treated as zero.
+ * @return Polarity.
+ */
+MEMORY_SECTION_RAMFUNC
+static int8_t motor_3pwm_polarity(int32_t value, int32_t band)
+{
+	if (value > band) return 1;
+	if (value < -band) return -1;
+	return 0;
 }
 
 bool motor_3pwm_init(motor_3pwm_handle_t *motor_3pwm_h,
@@ -32,11 +104,36 @@ bool motor_3pwm_init(motor_3pwm_handle_t *motor_3pwm_h,
 {
 	if ((motor_3pwm_h == NULL) || (motor_3pwm_cfg == NULL)) return false;
 	if (motor_3pwm_cfg->pwm_h == NULL) return false;
+	if (motor_3pwm_cfg->modulation > MOTOR_3PWM_MODULATION_DPWM) return false;
+	if (motor_3pwm_cfg->dead_time_comp > MOTOR_3PWM_DEAD_TIME_COMP_CURRENT) return false;
+	if (motor_3pwm_cfg->dead_time_comp_band < 0) return false;
+
+	/* Compare offset = dead time / 2: center-aligned, one dead time per period spread over two edges. */
+	const pwm_tim1_handle_t *pwm_h = motor_3pwm_cfg->pwm_h;
+	uint32_t dead_time_comp_ticks = 0u;
+	if (motor_3pwm_cfg->dead_time_comp != MOTOR_3PWM_DEAD_TIME_COMP_OFF)
+	{
+		if ((pwm_h->cfg == NULL) || (pwm_h->arr == 0u)) return false;
+		uint32_t dead_time_ns = (motor_3pwm_cfg->dead_time_comp_ns != 0u) ? motor_3pwm_cfg->dead_time_comp_ns :
+																			 pwm_h->dead_time_ns;
+		uint64_t counter_clk_hz = (uint64_t)pwm_h->cfg->tim_clk_hz / ((uint64_t)pwm_h->psc + 1u);
+		dead_time_comp_ticks = (uint32_t)((((uint64_t)dead_time_ns * counter_clk_hz) + 1000000000u) / 2000000000u);
+		/* A quarter of the half period is far beyond any real dead time: reject the configuration. */
+		if (dead_time_comp_ticks > ((uint32_t)pwm_h->arr / 4u)) return false;
+	}
 
 	motor_3pwm_h->cfg = motor_3pwm_cfg;
 	motor_3pwm_h->phase_a_duty_permyriad = 0u;
 	motor_3pwm_h->phase_b_duty_permyriad = 0u;
 	motor_3pwm_h->phase_c_duty_permyriad = 0u;
+	motor_3pwm_h->phase_a_duty_ticks = 0u;
+	motor_3pwm_h->phase_b_duty_ticks = 0u;
+	motor_3pwm_h->phase_c_duty_ticks = 0u;
+	motor_3pwm_h->dead_time_comp_ticks = (uint16_t)dead_time_comp_ticks;
+	motor_3pwm_h->ticks_per_permyriad_q32 = (((uint64_t)pwm_h->arr << 32) / 10000u) + 1u;
+	motor_3pwm_h->phase_a_polarity = 0;
+	motor_3pwm_h->phase_b_polarity = 0;
+	motor_3pwm_h->phase_c_polarity = 0;
 	motor_3pwm_h->is_initialized = true;
 	motor_3pwm_h->is_started = false;
 
@@ -56,6 +153,34 @@ bool motor_3pwm_start(motor_3pwm_handle_t *motor_3pwm_h)
 	return true;
 }
 
+bool motor_3pwm_start_staggered(motor_3pwm_handle_t *const motor_3pwm_hs[], uint8_t count, uint32_t lock_prio)
+{
+	pwm_tim1_handle_t *pwm_hs[PWM_TIM1_INSTANCE_COUNT];
+	uint8_t i = 0u;
+
+	if (motor_3pwm_hs == NULL) return false;
+	if ((count == 0u) || (count > PWM_TIM1_INSTANCE_COUNT)) return false;
+
+	for (i = 0u; i < count; i++)
+	{
+		const motor_3pwm_handle_t *motor_3pwm_h = motor_3pwm_hs[i];
+
+		if (motor_3pwm_h == NULL) return false;
+		if ((motor_3pwm_h->cfg == NULL) || (motor_3pwm_h->cfg->pwm_h == NULL)) return false;
+		if (motor_3pwm_h->is_initialized == false) return false;
+		if (motor_3pwm_h->is_started == true) return false;
+		pwm_hs[i] = motor_3pwm_h->cfg->pwm_h;
+	}
+
+	if (!pwm_tim1_start_staggered(pwm_hs, count, lock_prio)) return false;
+
+	for (i = 0u; i < count; i++)
+	{
+		motor_3pwm_hs[i]->is_started = true;
+	}
+	return true;
+}
+
 bool motor_3pwm_stop(motor_3pwm_handle_t *motor_3pwm_h)
 {
 	if (motor_3pwm_h == NULL) return false;
@@ -81,9 +206,13 @@ bool motor_3pwm_set_duty_abc(motor_3pwm_handle_t *motor_3pwm_h,
 	if (phase_b_duty_permyriad > 10000u) return false;
 	if (phase_c_duty_permyriad > 10000u) return false;
 
-	if (!motor_3pwm_set_pwm_permyriad(motor_3pwm_h->cfg->pwm_h, 1u, phase_a_duty_permyriad)) return false;
-	if (!motor_3pwm_set_pwm_permyriad(motor_3pwm_h->cfg->pwm_h, 2u, phase_b_duty_permyriad)) return false;
-	if (!motor_3pwm_set_pwm_permyriad(motor_3pwm_h->cfg->pwm_h, 3u, phase_c_duty_permyriad)) return false;
+	if (!motor_3pwm_write_ticks(motor_3pwm_h,
+								motor_3pwm_permyriad_to_ticks(motor_3pwm_h, phase_a_duty_permyriad),
+								motor_3pwm_permyriad_to_ticks(motor_3pwm_h, phase_b_duty_permyriad),
+								motor_3pwm_permyriad_to_ticks(motor_3pwm_h, phase_c_duty_permyriad)))
+	{
+		return false;
+	}
 
 	motor_3pwm_h->phase_a_duty_permyriad = phase_a_duty_permyriad;
 	motor_3pwm_h->phase_b_duty_permyriad = phase_b_duty_permyriad;
@@ -91,7 +220,91 @@ bool motor_3pwm_set_duty_abc(motor_3pwm_handle_t *motor_3pwm_h,
 	return true;
 }
 
+MEMORY_SECTION_RAMFUNC
+bool motor_3pwm_set_duty_ticks_abc(motor_3pwm_handle_t *motor_3pwm_h,
+								   uint16_t phase_a_duty_ticks,
+								   uint16_t phase_b_duty_ticks,
+								   uint16_t phase_c_duty_ticks)
+{
+	if (motor_3pwm_h == NULL) return false;
+	if ((motor_3pwm_h->cfg == NULL) || (motor_3pwm_h->cfg->pwm_h == NULL)) return false;
+	if (motor_3pwm_h->is_initialized == false) return false;
+
+	pwm_tim1_handle_t *pwm_h = motor_3pwm_h->cfg->pwm_h;
+	if ((phase_a_duty_ticks > pwm_h->arr) ||
+		(phase_b_duty_ticks > pwm_h->arr) ||
+		(phase_c_duty_ticks > pwm_h->arr))
+	{
+		return false;
+	}
+
+	return motor_3pwm_write_ticks(motor_3pwm_h, phase_a_duty_ticks, phase_b_duty_ticks, phase_c_duty_ticks);
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_3pwm_set_dead_time_polarity(motor_3pwm_handle_t *motor_3pwm_h,
+									   int32_t phase_a,
+									   int32_t phase_b,
+									   int32_t phase_c)
+{
+	if ((motor_3pwm_h == NULL) || (motor_3pwm_h->cfg == NULL)) return false;
+	if (motor_3pwm_h->is_initialized == false) return false;
+	if (motor_3pwm_h->cfg->dead_time_comp == MOTOR_3PWM_DEAD_TIME_COMP_OFF) return true;
+
+	int32_t band = motor_3pwm_h->cfg->dead_time_comp_band;
+	motor_3pwm_h->phase_a_polarity = motor_3pwm_polarity(phase_a, band);
+	motor_3pwm_h->phase_b_polarity = motor_3pwm_polarity(phase_b, band);
+	motor_3pwm_h->phase_c_polarity = motor_3pwm_polarity(phase_c, band);
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_3pwm_apply_zero_sequence(motor_3pwm_modulation_t modulation,
+									int32_t rail,
+									int32_t *phase_a,
+									int32_t *phase_b,
+									int32_t *phase_c)
+{
+	if ((phase_a == NULL) || (phase_b == NULL) || (phase_c == NULL)) return false;
+	if (rail <= 0) return false;
+	if (modulation == MOTOR_3PWM_MODULATION_SINE) return true;
+
+	int32_t max_phase = *phase_a;
+	int32_t min_phase = *phase_a;
+	if (*phase_b > max_phase) max_phase = *phase_b;
+	if (*phase_b < min_phase) min_phase = *phase_b;
+	if (*phase_c > max_phase) max_phase = *phase_c;
+	if (*phase_c < min_phase) min_phase = *phase_c;
+
+	int32_t offset = 0;
+	if (modulation == MOTOR_3PWM_MODULATION_SVPWM)
+	{
+		/* Center the min/max envelope on the PWM midpoint. */
+		offset = -((max_phase + min_phase) >> 1);
+	}
+	else if (modulation == MOTOR_3PWM_MODULATION_DPWM)
+	{
+		/* Clamp the phase with the largest magnitude to its rail; it stops switching. */
+		offset = ((max_phase + min_phase) >= 0) ? (rail - max_phase) : (-rail - min_phase);
+	}
+	else
+	{
+		return false;
+	}
+
+	*phase_a += offset;
+	*phase_b += offset;
+	*phase_c += offset;
+	return true;
+}
+
 bool motor_3pwm_set_neutral(motor_3pwm_handle_t *motor_3pwm_h)
 {
+	if (motor_3pwm_h == NULL) return false;
+
+	/* Restart compensation from the next polarity update. */
+	motor_3pwm_h->phase_a_polarity = 0;
+	motor_3pwm_h->phase_b_polarity = 0;
+	motor_3pwm_h->phase_c_polarity = 0;
 	return motor_3pwm_set_duty_abc(motor_3pwm_h, 0u, 0u, 0u);
 }
@@ -159,20 +159,23 @@ motor_6step_phase_map_t motor_6step_get_phase_map(const motor_6step_handle_t *mo
 		return phase_map;
 	}
 
-	if ((motor_h->current_step < MOTOR_6STEP_STEP_1) ||
-		(motor_h->current_step > MOTOR_6STEP_STEP_6))
+	return motor_6step_get_step_phase_map(motor_h->current_step, motor_h->cfg->dir);
+}
+
+motor_6step_phase_map_t motor_6step_get_step_phase_map(motor_6step_step_t step, motor_6step_dir_t dir)
+{
+	if ((step < MOTOR_6STEP_STEP_1) || (step > MOTOR_6STEP_STEP_6))
 	{
-		return phase_map;
+		return motor_6step_phase_map_default();
 	}
 
 	/* Convert step enum to zero-based table index. */
-	uint32_t step_idx = (uint32_t)motor_h->current_step - 1u;
+	uint32_t step_idx = (uint32_t)step - 1u;
 
 	/* Select commutation table according to configured direction. */
-	if (motor_h->cfg->dir == MOTOR_6STEP_DIR_CCW)
+	if (dir == MOTOR_6STEP_DIR_CCW)
 	{
 		return MOTOR_6STEP_PHASE_TABLE_CCW[step_idx];
 	}
 	return MOTOR_6STEP_PHASE_TABLE_CW[step_idx];
 }
-
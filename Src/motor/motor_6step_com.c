@@ -0,0 +1,414 @@
+/**
+ * @file motor_6step_com.c
+ * @brief Hardware-timed 6-step commutation on TIM1 COM events.
+ *
+ */
+
+#include "motor/motor_6step_com.h"
+#include "motor/motor_6step.h"
+#include "drivers/irq_lock.h"
+#include <stddef.h>
+
+/* Upper edge of pattern 0 (120 deg + 30 deg) in full-turn uint16 units. */
+#define MOTOR_6STEP_COM_PATTERN0_UPPER_U16	27307u
+/* Torque vector offset from the rotor angle: +90 deg (positive command) / -90 deg. */
+#define MOTOR_6STEP_COM_Q_AXIS_POS_U16		16384u
+#define MOTOR_6STEP_COM_Q_AXIS_NEG_U16		49152u
+#define MOTOR_6STEP_COM_US_PER_S			1000000u
+
+/**
+ * @brief Sector offset of one pattern start from the pattern 0 upper edge.
+ *
+ * Pattern i covers offsets [start(i), start(i + 1)) with offset = upper edge - vector angle.
+ *
+ * @param pattern Pattern index (0..6, 6 = full turn).
+ * @return Offset in full-turn uint16 counts.
+ */
+static uint32_t motor_6step_com_pattern_start(uint32_t pattern)
+{
+	return ((pattern << 16) + (MOTOR_6STEP_COM_PATTERN_COUNT - 1u)) / MOTOR_6STEP_COM_PATTERN_COUNT;
+}
+
+/**
+ * @brief Map one TIM1 channel mode to a motor_6step phase state.
+ *
+ * @param phase_state Phase state of the pattern.
+ * @return TIM1 channel mode.
+ */
+static pwm_tim1_channel_mode_t motor_6step_com_channel_mode(motor_6step_phase_state_t phase_state)
+{
+	if (phase_state == MOTOR_6STEP_PHASE_HIGH) return PWM_TIM1_CHANNEL_PWM;
+	if (phase_state == MOTOR_6STEP_PHASE_LOW) return PWM_TIM1_CHANNEL_LOW;
+	return PWM_TIM1_CHANNEL_OFF;
+}
+
+/**
+ * @brief Preload one pattern; it becomes active with the next COM event.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @param pattern Pattern index (0..5).
+ * @return true if preloaded, false otherwise.
+ */
+static bool motor_6step_com_preload(motor_6step_com_handle_t *motor_6step_com_h, uint8_t pattern)
+{
+	motor_6step_phase_map_t phase_map =
+			motor_6step_get_step_phase_map((motor_6step_step_t)(pattern + 1u), MOTOR_6STEP_DIR_CW);
+
+	if (!pwm_tim1_preload_channel_modes(motor_6step_com_h->cfg->pwm_h,
+										motor_6step_com_channel_mode(phase_map.phase_a),
+										motor_6step_com_channel_mode(phase_map.phase_b),
+										motor_6step_com_channel_mode(phase_map.phase_c)))
+	{
+		return false;
+	}
+
+	motor_6step_com_h->pending_pattern = pattern;
+	return true;
+}
+
+/**
+ * @brief Commit the preloaded pattern now (software COM), dropping an armed compare.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ */
+static void motor_6step_com_commit_now(motor_6step_com_handle_t *motor_6step_com_h)
+{
+	if (motor_6step_com_h->cfg->trigger == MOTOR_6STEP_COM_TRIGGER_ANGLE)
+	{
+		tim5_timebase_disarm_trigger();
+		motor_6step_com_h->is_schedule_armed = false;
+	}
+
+	(void)pwm_tim1_generate_com(motor_6step_com_h->cfg->pwm_h);
+}
+
+/**
+ * @brief Read the Hall code and map it to the pattern of the current command sign.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @return Pattern index, or MOTOR_6STEP_COM_PATTERN_NONE for an invalid code.
+ */
+static uint8_t motor_6step_com_read_hall_pattern(const motor_6step_com_handle_t *motor_6step_com_h)
+{
+	const motor_6step_com_cfg_t *cfg = motor_6step_com_h->cfg;
+	uint32_t hall_code = 0u;
+
+	for (uint32_t i = 0u; i < 3u; i++)
+	{
+		if (gpio_read(cfg->hall_exti_cfg[i]->gpio_cfg->pin)) hall_code |= (1u << i);
+	}
+
+	uint8_t pattern = cfg->hall_to_pattern[hall_code];
+	if (pattern >= MOTOR_6STEP_COM_PATTERN_COUNT) return MOTOR_6STEP_COM_PATTERN_NONE;
+
+	/* Negative torque: opposite vector, three patterns on. */
+	if (motor_6step_com_h->command_permyriad < 0)
+	{
+		pattern = (uint8_t)((pattern + 3u) % MOTOR_6STEP_COM_PATTERN_COUNT);
+	}
+
+	return pattern;
+}
+
+/**
+ * @brief HALL trigger: commit the pattern of the current Hall code if it changed.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ * @param is_edge true from the Hall EXTI, false from the service (counts a resync).
+ */
+static void motor_6step_com_update_hall(motor_6step_com_handle_t *motor_6step_com_h, bool is_edge)
+{
+	uint8_t pattern = motor_6step_com_read_hall_pattern(motor_6step_com_h);
+
+	if (pattern == MOTOR_6STEP_COM_PATTERN_NONE)
+	{
+		if (is_edge) motor_6step_com_h->hall_invalid_cnt++;
+		return;
+	}
+	if ((pattern == motor_6step_com_h->active_pattern) || (pattern == motor_6step_com_h->pending_pattern)) return;
+	if (!motor_6step_com_preload(motor_6step_com_h, pattern)) return;
+
+	if (!is_edge) motor_6step_com_h->resync_com_cnt++;
+	motor_6step_com_commit_now(motor_6step_com_h);
+}
+
+/**
+ * @brief ANGLE trigger: check the active pattern and arm the next commutation.
+ *
+ * The latest sample is extrapolated to now. The next pattern in the direction
+ * of motion is preloaded and the TIM5 compare set to the sector boundary;
+ * TRGO then fires COM in hardware. A pattern one sector behind the active one
+ * is extrapolation error at the boundary just committed, not a lost sector.
+ *
+ * @param motor_6step_com_h Pointer to 6-step COM handle.
+ */
+static void motor_6step_com_update_angle(motor_6step_com_handle_t *motor_6step_com_h)
+{
+	const motor_6step_com_cfg_t *cfg = motor_6step_com_h->cfg;
+	motor_6step_com_rotor_state_t rotor_state = {0};
+
+	if (!cfg->get_rotor_state(cfg->rotor_state_arg, &rotor_state)) return;
+
+	uint32_t now_us = tim5_timebase_now32();
+	uint32_t sample_age_us = now_us - rotor_state.capture_timestamp_us;
+	int32_t speed_cps = rotor_state.electrical_speed_cps;
+	uint32_t abs_speed_cps = (speed_cps < 0) ? (0u - (uint32_t)speed_cps) : (uint32_t)speed_cps;
+	bool is_schedulable = (sample_age_us <= cfg->max_sample_age_us) &&
+						  (abs_speed_cps >= (uint32_t)cfg->min_electrical_speed_cps);
+
+	uint16_t electrical_angle_u16 = rotor_state.electrical_angle_u16;
+	if (is_schedulable)
+	{
+		electrical_angle_u16 = (uint16_t)(electrical_angle_u16 +
+				(int32_t)(((int64_t)speed_cps * sample_age_us) / (int64_t)MOTOR_6STEP_COM_US_PER_S));
+	}
+
+	uint16_t vector_angle_u16 = (uint16_t)(electrical_angle_u16 +
+			((motor_6step_com_h->command_permyriad < 0) ? MOTOR_6STEP_COM_Q_AXIS_NEG_U16 : MOTOR_6STEP_COM_Q_AXIS_POS_U16));
+	uint16_t offset_u16 = (uint16_t)(MOTOR_6STEP_COM_PATTERN0_UPPER_U16 - vector_angle_u16);
+	uint8_t pattern = (uint8_t)(((uint32_t)offset_u16 * MOTOR_6STEP_COM_PATTERN_COUNT) >> 16);
+	uint8_t active = motor_6step_com_h->active_pattern;
+
+	/* Rising angle walks the patterns down (5 -> 4 -> ...), falling angle up. */
+	uint8_t step_back = (speed_cps >= 0) ? 1u : (MOTOR_6STEP_COM_PATTERN_COUNT - 1u);
+	bool is_behind = is_schedulable && (active != MOTOR_6STEP_COM_PATTERN_NONE) &&
+					 (pattern == (uint8_t)((active + step_back) % MOTOR_6STEP_COM_PATTERN_COUNT));
+
+	if ((pattern != active) && !is_behind)
+	{
+		/* Lost sector, sign change or start: commit the current pattern, its COM ISR re-arms. */
+		if (pattern == motor_6step_com_h->pending_pattern) return;
+		if (!motor_6step_com_preload(motor_6step_com_h, pattern)) return;
+		motor_6step_com_h->resync_com_cnt++;
+		motor_6step_com_commit_now(motor_6step_com_h);
+		return;
+	}
+
+	if (!is_schedulable)
+	{
+		/* Slow or stale: the service tracks the sector. */
+		tim5_timebase_disarm_trigger();
+		motor_6step_com_h->is_schedule_armed = false;
+		return;
+	}
+	if (motor_6step_com_h->is_schedule_armed) return;
+
+	/* Distance from now to the exit edge of the active pattern. */
+	uint8_t next = (uint8_t)((active + MOTOR_6STEP_COM_PATTERN_COUNT - step_back) % MOTOR_6STEP_COM_PATTERN_COUNT);
+	uint32_t distance_u16 = (speed_cps >= 0) ?
+			(uint32_t)(uint16_t)(offset_u16 - (uint16_t)motor_6step_com_pattern_start(active)) + 1u :
+			(uint32_t)(uint16_t)((uint16_t)motor_6step_com_pattern_start(active + 1u) - offset_u16);
+	uint32_t lead_us = (uint32_t)(((uint64_t)distance_u16 * MOTOR_6STEP_COM_US_PER_S) / abs_speed_cps);
+
+	if (!motor_6step_com_preload(motor_6step_com_h, next)) return;
+
+	if (lead_us < cfg->min_lead_us)
+	{
+		motor_6step_com_h->late_com_cnt++;
+		motor_6step_com_commit_now(motor_6step_com_h);
+		return;
+	}
+
+	uint32_t target_us = now_us + lead_us;
+	tim5_timebase_arm_trigger(target_us);
+	motor_6step_com_h->is_schedule_armed = true;
+	motor_6step_com_h->scheduled_com_cnt++;
+
+	/* The target may have passed during the write: no match will come. */
+	if (!tim5_timebase_is_trigger_fired() && ((int32_t)(tim5_timebase_now32() - target_us) >= 0))
+	{
+		motor_6step_com_h->late_com_cnt++;
+		motor_6step_com_commit_now(motor_6step_com_h);
+	}
+}
+
+/**
+ * @brief TIM1 COM callback: the pending pattern is active (COM ISR).
+ *
+ * @param callback_arg Pointer to 6-step COM handle.
+ */
+static void motor_6step_com_com_callback(void *callback_arg)
+{
+	motor_6step_com_handle_t *motor_6step_com_h = (motor_6step_com_handle_t *)callback_arg;
+
+	motor_6step_com_h->active_pattern = motor_6step_com_h->pending_pattern;
+	motor_6step_com_h->is_schedule_armed = false;
+
+	if ((motor_6step_com_h->is_running) && (motor_6step_com_h->cfg->trigger == MOTOR_6STEP_COM_TRIGGER_ANGLE))
+	{
+		motor_6step_com_update_angle(motor_6step_com_h);
+	}
+}
+
+/**
+ * @brief Hall edge callback (EXTI ISR).
+ *
+ * @param callback_arg Pointer to 6-step COM handle.
+ */
+static void motor_6step_com_hall_callback(void *callback_arg)
+{
+	motor_6step_com_handle_t *motor_6step_com_h = (motor_6step_com_handle_t *)callback_arg;
+
+	if (motor_6step_com_h->is_running == false) return;
+	motor_6step_com_update_hall(motor_6step_com_h, true);
+}
+
+bool motor_6step_com_init(motor_6step_com_handle_t *motor_6step_com_h,
+						  const motor_6step_com_cfg_t *motor_6step_com_cfg)
+{
+	if ((motor_6step_com_h == NULL) || (motor_6step_com_cfg == NULL)) return false;
+	if ((motor_6step_com_cfg->pwm_h == NULL) || (motor_6step_com_cfg->motor_3pwm_h == NULL)) return false;
+	if (motor_6step_com_cfg->lock_prio == 0u) return false;
+
+	if (motor_6step_com_cfg->trigger == MOTOR_6STEP_COM_TRIGGER_HALL)
+	{
+		for (uint32_t i = 0u; i < 3u; i++)
+		{
+			if ((motor_6step_com_cfg->hall_exti_cfg[i] == NULL) ||
+				(motor_6step_com_cfg->hall_exti_cfg[i]->gpio_cfg == NULL)) return false;
+		}
+		for (uint32_t code = 0u; code < 8u; code++)
+		{
+			uint8_t pattern = motor_6step_com_cfg->hall_to_pattern[code];
+			if ((pattern >= MOTOR_6STEP_COM_PATTERN_COUNT) && (pattern != MOTOR_6STEP_COM_PATTERN_NONE)) return false;
+		}
+	}
+	else if (motor_6step_com_cfg->trigger == MOTOR_6STEP_COM_TRIGGER_ANGLE)
+	{
+		if ((motor_6step_com_cfg->timebase_h == NULL) || (motor_6step_com_cfg->get_rotor_state == NULL)) return false;
+		if (motor_6step_com_cfg->min_electrical_speed_cps <= 0) return false;
+	}
+	else
+	{
+		return false;
+	}
+
+	motor_6step_com_h->cfg = motor_6step_com_cfg;
+	motor_6step_com_h->command_permyriad = 0;
+	motor_6step_com_h->pending_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+	motor_6step_com_h->active_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+	motor_6step_com_h->is_schedule_armed = false;
+	motor_6step_com_h->scheduled_com_cnt = 0u;
+	motor_6step_com_h->late_com_cnt = 0u;
+	motor_6step_com_h->resync_com_cnt = 0u;
+	motor_6step_com_h->hall_invalid_cnt = 0u;
+	motor_6step_com_h->is_running = false;
+
+	/* Callbacks first: exti_init() unmasks the line. */
+	if (motor_6step_com_cfg->trigger == MOTOR_6STEP_COM_TRIGGER_HALL)
+	{
+		for (uint32_t i = 0u; i < 3u; i++)
+		{
+			const exti_cfg_t *hall_cfg = motor_6step_com_cfg->hall_exti_cfg[i];
+
+			if (!exti_register(hall_cfg->gpio_cfg->pin.pin, motor_6step_com_hall_callback, motor_6step_com_h)) return false;
+			if (!exti_init(hall_cfg)) return false;
+		}
+	}
+
+	motor_6step_com_h->is_initialized = true;
+	return true;
+}
+
+bool motor_6step_com_start(motor_6step_com_handle_t *motor_6step_com_h)
+{
+	if ((motor_6step_com_h == NULL) || (motor_6step_com_h->is_initialized == false)) return false;
+	if (motor_6step_com_h->is_running) return true;
+
+	const motor_6step_com_cfg_t *cfg = motor_6step_com_h->cfg;
+	pwm_tim1_com_trigger_t com_trigger = PWM_TIM1_COM_TRIGGER_SOFTWARE;
+
+	if (cfg->motor_3pwm_h->is_started == false) return false;
+
+	if (cfg->trigger == MOTOR_6STEP_COM_TRIGGER_ANGLE)
+	{
+		/* TIM5 TRGO -> TIM1 ITR0 */
+		if (!tim5_timebase_enable_trigger_output(cfg->timebase_h)) return false;
+		com_trigger = PWM_TIM1_COM_TRIGGER_ITR0;
+	}
+
+	motor_6step_com_h->pending_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+	motor_6step_com_h->active_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+	motor_6step_com_h->is_schedule_armed = false;
+
+	if (!pwm_tim1_register_com_callback(cfg->pwm_h, motor_6step_com_com_callback, motor_6step_com_h)) return false;
+	if (!pwm_tim1_enable_commutation(cfg->pwm_h, com_trigger)) return false;
+	motor_6step_com_h->is_running = true;
+
+	/* First pattern from the current position; the COM ISR picks it up after the unlock. */
+	uint32_t lock = irq_lock_raise(cfg->lock_prio);
+	if (cfg->trigger == MOTOR_6STEP_COM_TRIGGER_HALL)
+	{
+		motor_6step_com_update_hall(motor_6step_com_h, false);
+	}
+	else
+	{
+		motor_6step_com_update_angle(motor_6step_com_h);
+	}
+	irq_lock_restore(lock);
+
+	if (motor_6step_com_h->pending_pattern == MOTOR_6STEP_COM_PATTERN_NONE)
+	{
+		(void)motor_6step_com_stop(motor_6step_com_h);
+		return false;
+	}
+
+	return true;
+}
+
+bool motor_6step_com_stop(motor_6step_com_handle_t *motor_6step_com_h)
+{
+	if ((motor_6step_com_h == NULL) || (motor_6step_com_h->is_initialized == false)) return false;
+
+	const motor_6step_com_cfg_t *cfg = motor_6step_com_h->cfg;
+
+	motor_6step_com_h->is_running = false;
+	if (cfg->trigger == MOTOR_6STEP_COM_TRIGGER_ANGLE)
+	{
+		tim5_timebase_disarm_trigger();
+	}
+	motor_6step_com_h->is_schedule_armed = false;
+
+	(void)pwm_tim1_disable_commutation(cfg->pwm_h);
+	motor_6step_com_h->pending_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+	motor_6step_com_h->active_pattern = MOTOR_6STEP_COM_PATTERN_NONE;
+
+	return motor_3pwm_set_neutral(cfg->motor_3pwm_h);
+}
+
+bool motor_6step_com_set_command(motor_6step_com_handle_t *motor_6step_com_h, int16_t command_permyriad)
+{
+	if ((motor_6step_com_h == NULL) || (motor_6step_com_h->is_initialized == false)) return false;
+
+	if (command_permyriad > MOTOR_6STEP_COM_MAX_COMMAND_PERMYRIAD) command_permyriad = MOTOR_6STEP_COM_MAX_COMMAND_PERMYRIAD;
+	if (command_permyriad < -MOTOR_6STEP_COM_MAX_COMMAND_PERMYRIAD) command_permyriad = -MOTOR_6STEP_COM_MAX_COMMAND_PERMYRIAD;
+
+	/* A sign change moves the pattern by three; motor_6step_com_service() commits it. */
+	motor_6step_com_h->command_permyriad = command_permyriad;
+
+	/* Same compare on all channels: only the PWM phase of the pattern uses it. */
+	uint16_t duty_permyriad = (uint16_t)((command_permyriad < 0) ? -command_permyriad : command_permyriad);
+	return motor_3pwm_set_duty_abc(motor_6step_com_h->cfg->motor_3pwm_h, duty_permyriad, duty_permyriad, duty_permyriad);
+}
+
+bool motor_6step_com_service(motor_6step_com_handle_t *motor_6step_com_h)
+{
+	if ((motor_6step_com_h == NULL) || (motor_6step_com_h->is_initialized == false)) return false;
+	if (motor_6step_com_h->is_running == false) return false;
+
+	const motor_6step_com_cfg_t *cfg = motor_6step_com_h->cfg;
+
+	/* Same priority as the COM ISR and the Hall lines: pattern state stays consistent. */
+	uint32_t lock = irq_lock_raise(cfg->lock_prio);
+	if (cfg->trigger == MOTOR_6STEP_COM_TRIGGER_HALL)
+	{
+		motor_6step_com_update_hall(motor_6step_com_h, false);
+	}
+	else
+	{
+		motor_6step_com_update_angle(motor_6step_com_h);
+	}
+	irq_lock_restore(lock);
+
+	return true;
+}
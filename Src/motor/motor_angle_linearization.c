@@ -0,0 +1,239 @@
+/**
+ * @file motor_angle_linearization.c
+ * @brief Constant-speed calibration of the periodic angle-sensor error.
+ *
+ *  Notes:
+ *  - bin means are taken in Q8 counts / Q8 us before the ideal line is
+ *    applied, which keeps every product inside int64 for long recordings.
+ *  - the last sample closes the recording and only defines the line, the
+ *    bins cover exactly revolution_count turns (first sample included).
+ */
+
+#include "motor/motor_angle_linearization.h"
+#include <stddef.h>
+
+#define MOTOR_ANGLE_LINEARIZATION_FULL_TURN_COUNTS    65536LL
+#define MOTOR_ANGLE_LINEARIZATION_Q8_SCALE            256LL
+
+/**
+ * @brief Divide one signed value by a positive divisor and round to nearest.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded quotient.
+ */
+static int64_t motor_angle_linearization_divide_round_i64(int64_t numerator, int64_t denominator)
+{
+	if (numerator >= 0) return (numerator + (denominator / 2LL)) / denominator;
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+
+/**
+ * @brief Clear the per-bin sums and begin recording at one sample.
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param mechanical_angle_u16 First recorded angle.
+ * @param capture_timestamp_us First recorded capture instant.
+ */
+static void motor_angle_linearization_begin_recording(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+													  uint16_t mechanical_angle_u16,
+													  uint64_t capture_timestamp_us)
+{
+	for (uint8_t k = 0u; k < MOTOR_ANGLE_LINEARIZATION_MAX_POINTS; k++)
+	{
+		motor_angle_linearization_h->bin_sample_count[k] = 0u;
+		motor_angle_linearization_h->bin_angle_sum_counts[k] = 0;
+		motor_angle_linearization_h->bin_elapsed_sum_us[k] = 0;
+	}
+	motor_angle_linearization_h->start_timestamp_us = capture_timestamp_us;
+	motor_angle_linearization_h->last_angle_u16 = mechanical_angle_u16;
+	motor_angle_linearization_h->unwrapped_angle_counts = 0;
+	motor_angle_linearization_h->recorded_sample_count = 0u;
+	motor_angle_linearization_h->state = MOTOR_ANGLE_LINEARIZATION_STATE_RECORDING;
+}
+
+/**
+ * @brief Add one sample to the bin of its nearest table point.
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param mechanical_angle_u16 Measured angle.
+ * @param elapsed_us Time since the first recorded sample.
+ */
+static void motor_angle_linearization_accumulate(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+												 uint16_t mechanical_angle_u16,
+												 int64_t elapsed_us)
+{
+	uint8_t shift = motor_angle_linearization_h->point_shift;
+	uint16_t half_segment_counts = (uint16_t)(1u << (shift - 1u));
+	/* Nearest point: round the angle to the grid, 65535 + half wraps onto point 0. */
+	uint8_t k = (uint8_t)((uint16_t)(mechanical_angle_u16 + half_segment_counts) >> shift);
+
+	motor_angle_linearization_h->bin_sample_count[k]++;
+	motor_angle_linearization_h->bin_angle_sum_counts[k] += (int64_t)motor_angle_linearization_h->unwrapped_angle_counts;
+	motor_angle_linearization_h->bin_elapsed_sum_us[k] += elapsed_us;
+	motor_angle_linearization_h->recorded_sample_count++;
+}
+
+/**
+ * @brief Fit the ideal line and build the zero-mean correction table.
+ *
+ * @param motor_angle_linearization_h Pointer to calibration handle.
+ * @param end_elapsed_us Time of the closing sample.
+ * @return true if every bin has enough samples, false otherwise.
+ */
+static bool motor_angle_linearization_finish(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+											 int64_t end_elapsed_us)
+{
+	const motor_angle_linearization_cfg_t *cfg = motor_angle_linearization_h->cfg;
+	int64_t end_angle_counts = (int64_t)motor_angle_linearization_h->unwrapped_angle_counts;
+	int64_t error_q8[MOTOR_ANGLE_LINEARIZATION_MAX_POINTS];
+	int64_t error_sum_q8 = 0;
+	int64_t error_min_q8 = INT64_MAX;
+	int64_t error_max_q8 = INT64_MIN;
+
+	if (end_elapsed_us <= 0) return false;
+
+	for (uint8_t k = 0u; k < cfg->point_count; k++)
+	{
+		int64_t count = (int64_t)motor_angle_linearization_h->bin_sample_count[k];
+
+		if (count < (int64_t)cfg->min_samples_per_point) return false;
+
+		/* error = mean(angle) - mean(t) * angle_end / t_end, both means in Q8. */
+		int64_t mean_angle_q8 = motor_angle_linearization_divide_round_i64(
+				motor_angle_linearization_h->bin_angle_sum_counts[k] * MOTOR_ANGLE_LINEARIZATION_Q8_SCALE, count);
+		int64_t mean_elapsed_q8 = motor_angle_linearization_divide_round_i64(
+				motor_angle_linearization_h->bin_elapsed_sum_us[k] * MOTOR_ANGLE_LINEARIZATION_Q8_SCALE, count);
+		int64_t ideal_angle_q8 = motor_angle_linearization_divide_round_i64(mean_elapsed_q8 * end_angle_counts,
+																		   end_elapsed_us);
+
+		error_q8[k] = mean_angle_q8 - ideal_angle_q8;
+		error_sum_q8 += error_q8[k];
+		if (error_q8[k] < error_min_q8) error_min_q8 = error_q8[k];
+		if (error_q8[k] > error_max_q8) error_max_q8 = error_q8[k];
+	}
+
+	/* Zero mean: the line offset is arbitrary, only the periodic part is sensor error. */
+	int64_t error_mean_q8 = motor_angle_linearization_divide_round_i64(error_sum_q8, (int64_t)cfg->point_count);
+
+	for (uint8_t k = 0u; k < cfg->point_count; k++)
+	{
+		int64_t correction_counts = motor_angle_linearization_divide_round_i64(error_mean_q8 - error_q8[k],
+																			   MOTOR_ANGLE_LINEARIZATION_Q8_SCALE);
+
+		if (correction_counts > (int64_t)INT16_MAX) correction_counts = INT16_MAX;
+		if (correction_counts < (int64_t)INT16_MIN) correction_counts = INT16_MIN;
+		motor_angle_linearization_h->correction_counts[k] = (int16_t)correction_counts;
+	}
+	for (uint8_t k = cfg->point_count; k < MOTOR_ANGLE_LINEARIZATION_MAX_POINTS; k++)
+	{
+		motor_angle_linearization_h->correction_counts[k] = 0;
+	}
+
+	int64_t peak_to_peak_counts = (error_max_q8 - error_min_q8) / MOTOR_ANGLE_LINEARIZATION_Q8_SCALE;
+	motor_angle_linearization_h->peak_to_peak_error_counts =
+			(peak_to_peak_counts > (int64_t)UINT16_MAX) ? UINT16_MAX : (uint16_t)peak_to_peak_counts;
+
+	return true;
+}
+
+bool motor_angle_linearization_init(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									const motor_angle_linearization_cfg_t *motor_angle_linearization_cfg)
+{
+	uint8_t shift = 16u;
+
+	if ((motor_angle_linearization_h == NULL) || (motor_angle_linearization_cfg == NULL)) return false;
+	if ((motor_angle_linearization_cfg->point_count < 2u) ||
+		(motor_angle_linearization_cfg->point_count > MOTOR_ANGLE_LINEARIZATION_MAX_POINTS)) return false;
+	if ((motor_angle_linearization_cfg->point_count & (uint8_t)(motor_angle_linearization_cfg->point_count - 1u)) != 0u)
+	{
+		return false;
+	}
+	if (motor_angle_linearization_cfg->revolution_count == 0u) return false;
+	if ((motor_angle_linearization_cfg->timeout_ms == 0u) || (motor_angle_linearization_cfg->min_samples_per_point == 0u)) return false;
+	if (motor_angle_linearization_cfg->max_delta_per_sample_counts == 0u) return false;
+
+	for (uint8_t n = motor_angle_linearization_cfg->point_count; n > 1u; n = (uint8_t)(n >> 1))
+	{
+		shift--;
+	}
+
+	motor_angle_linearization_h->cfg = motor_angle_linearization_cfg;
+	motor_angle_linearization_h->point_shift = shift;
+	motor_angle_linearization_h->state = MOTOR_ANGLE_LINEARIZATION_STATE_IDLE;
+	motor_angle_linearization_h->peak_to_peak_error_counts = 0u;
+	motor_angle_linearization_h->recorded_sample_count = 0u;
+	for (uint8_t k = 0u; k < MOTOR_ANGLE_LINEARIZATION_MAX_POINTS; k++)
+	{
+		motor_angle_linearization_h->correction_counts[k] = 0;
+	}
+	motor_angle_linearization_h->is_initialized = true;
+
+	return true;
+}
+
+bool motor_angle_linearization_start(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									 uint64_t now_us)
+{
+	if ((motor_angle_linearization_h == NULL) || (motor_angle_linearization_h->is_initialized == false)) return false;
+
+	motor_angle_linearization_h->start_timestamp_us = now_us;
+	motor_angle_linearization_h->state = MOTOR_ANGLE_LINEARIZATION_STATE_SETTLING;
+
+	return true;
+}
+
+bool motor_angle_linearization_update(motor_angle_linearization_handle_t *motor_angle_linearization_h,
+									  uint16_t mechanical_angle_u16,
+									  uint64_t capture_timestamp_us)
+{
+	if ((motor_angle_linearization_h == NULL) || (motor_angle_linearization_h->is_initialized == false)) return false;
+
+	const motor_angle_linearization_cfg_t *cfg = motor_angle_linearization_h->cfg;
+
+	if (motor_angle_linearization_h->state == MOTOR_ANGLE_LINEARIZATION_STATE_SETTLING)
+	{
+		/* The speed loop needs settle_time_ms to hold the constant speed. */
+		if (capture_timestamp_us >= (motor_angle_linearization_h->start_timestamp_us + ((uint64_t)cfg->settle_time_ms * 1000u)))
+		{
+			motor_angle_linearization_begin_recording(motor_angle_linearization_h, mechanical_angle_u16, capture_timestamp_us);
+			motor_angle_linearization_accumulate(motor_angle_linearization_h, mechanical_angle_u16, 0);
+		}
+		return true;
+	}
+	if (motor_angle_linearization_h->state != MOTOR_ANGLE_LINEARIZATION_STATE_RECORDING) return true;
+
+	int64_t elapsed_us = (capture_timestamp_us > motor_angle_linearization_h->start_timestamp_us) ?
+			(int64_t)(capture_timestamp_us - motor_angle_linearization_h->start_timestamp_us) : 0;
+	int32_t delta_counts = (int32_t)(int16_t)(uint16_t)(mechanical_angle_u16 - motor_angle_linearization_h->last_angle_u16);
+
+	/* A plausibility-gate fallback or a stall spoils the line fit. */
+	if (((delta_counts < 0) ? -delta_counts : delta_counts) > (int32_t)cfg->max_delta_per_sample_counts)
+	{
+		motor_angle_linearization_h->state = MOTOR_ANGLE_LINEARIZATION_STATE_FAILED;
+		return true;
+	}
+	if (elapsed_us > ((int64_t)cfg->timeout_ms * 1000LL))
+	{
+		motor_angle_linearization_h->state = MOTOR_ANGLE_LINEARIZATION_STATE_FAILED;
+		return true;
+	}
+
+	motor_angle_linearization_h->last_angle_u16 = mechanical_angle_u16;
+	motor_angle_linearization_h->unwrapped_angle_counts += delta_counts;
+
+	/* Either rotation direction: the recording closes after revolution_count full turns. */
+	int32_t travelled_counts = (motor_angle_linearization_h->unwrapped_angle_counts < 0) ?
+			-motor_angle_linearization_h->unwrapped_angle_counts : motor_angle_linearization_h->unwrapped_angle_counts;
+	if ((int64_t)travelled_counts >= ((int64_t)cfg->revolution_count * MOTOR_ANGLE_LINEARIZATION_FULL_TURN_COUNTS))
+	{
+		motor_angle_linearization_h->state = motor_angle_linearization_finish(motor_angle_linearization_h, elapsed_us) ?
+				MOTOR_ANGLE_LINEARIZATION_STATE_DONE : MOTOR_ANGLE_LINEARIZATION_STATE_FAILED;
+		return true;
+	}
+
+	motor_angle_linearization_accumulate(motor_angle_linearization_h, mechanical_angle_u16, elapsed_us);
+
+	return true;
+}
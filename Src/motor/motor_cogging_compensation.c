@@ -0,0 +1,304 @@
+/**
+ * @file motor_cogging_compensation.c
+ * @brief Angle-indexed Uq feedforward against cogging torque, learned online (voltage-mode FOC).
+ *
+ *  Notes:
+ *  - learning and apply use the same linear interpolation: a residual at
+ *    one angle is shared between its two table points with the weights
+ *    the apply step reads them with, so the table converges to the
+ *    interpolated shape of the ripple.
+ *  - the actuation path only reads the table: one point is one aligned
+ *    word, a learning step between two reads moves the result by one
+ *    update at most.
+ */
+
+#include "motor/motor_cogging_compensation.h"
+#include "drivers/memory_section.h"
+#include <stddef.h>
+
+#define MOTOR_COGGING_COMPENSATION_TURN_COUNTS      65536u
+#define MOTOR_COGGING_COMPENSATION_Q8_SHIFT         8
+#define MOTOR_COGGING_COMPENSATION_Q15_TO_Q8_SHIFT  7
+#define MOTOR_COGGING_COMPENSATION_US_PER_MS        1000LL
+
+/**
+ * @brief Divide one signed integer and round to nearest integer.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded signed integer quotient.
+ */
+static int64_t motor_cogging_compensation_divide_round_nearest(int64_t numerator,
+															   int64_t denominator)
+{
+	if (numerator >= 0)
+	{
+		return (numerator + (denominator / 2LL)) / denominator;
+	}
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+
+/**
+ * @brief Convert one Q8 permyriad value to permyriad (round to nearest).
+ *
+ * @param value_q8 Value in permyriad Q8.
+ * @return Rounded permyriad.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_cogging_compensation_q8_to_permyriad(int64_t value_q8)
+{
+	if (value_q8 >= 0)
+	{
+		return (int32_t)((value_q8 + (1LL << (MOTOR_COGGING_COMPENSATION_Q8_SHIFT - 1))) >>
+						 MOTOR_COGGING_COMPENSATION_Q8_SHIFT);
+	}
+
+	return -(int32_t)((-value_q8 + (1LL << (MOTOR_COGGING_COMPENSATION_Q8_SHIFT - 1))) >>
+					  MOTOR_COGGING_COMPENSATION_Q8_SHIFT);
+}
+
+/**
+ * @brief Add one weighted step to one table point within the correction clamp.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ * @param index Table point.
+ * @param step_q8 Step in permyriad Q8.
+ */
+static void motor_cogging_compensation_add_step(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+												uint8_t index,
+												int64_t step_q8)
+{
+	const int64_t limit_q8 =
+			(int64_t)motor_cogging_compensation_h->cfg->max_correction_permyriad << MOTOR_COGGING_COMPENSATION_Q8_SHIFT;
+	int64_t value_q8 = (int64_t)motor_cogging_compensation_h->correction_q8[index] + step_q8;
+
+	if (value_q8 > limit_q8) value_q8 = limit_q8;
+	if (value_q8 < -limit_q8) value_q8 = -limit_q8;
+	motor_cogging_compensation_h->correction_q8[index] = (int32_t)value_q8;
+}
+
+/**
+ * @brief Remove the table mean (the average torque belongs to the PI).
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ */
+static void motor_cogging_compensation_remove_mean(motor_cogging_compensation_handle_t *motor_cogging_compensation_h)
+{
+	const uint8_t count = motor_cogging_compensation_h->cfg->point_count;
+	int64_t sum_q8 = 0;
+
+	for (uint8_t k = 0u; k < count; k++)
+	{
+		sum_q8 += motor_cogging_compensation_h->correction_q8[k];
+	}
+
+	int32_t mean_q8 = (int32_t)motor_cogging_compensation_divide_round_nearest(sum_q8, (int64_t)count);
+	for (uint8_t k = 0u; k < count; k++)
+	{
+		motor_cogging_compensation_h->correction_q8[k] -= mean_q8;
+	}
+}
+
+/**
+ * @brief Forget the current turn; the next step seeds a new one.
+ *
+ * @param motor_cogging_compensation_h Pointer to cogging-compensation handle.
+ */
+static void motor_cogging_compensation_reset_turn(motor_cogging_compensation_handle_t *motor_cogging_compensation_h)
+{
+	motor_cogging_compensation_h->has_previous_angle = false;
+	motor_cogging_compensation_h->turn_travel_counts = 0u;
+	motor_cogging_compensation_h->turn_uq_sum_permyriad = 0;
+	motor_cogging_compensation_h->turn_sample_count = 0u;
+	motor_cogging_compensation_h->has_turn_mean = false;
+}
+
+bool motor_cogging_compensation_init(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									 const motor_cogging_compensation_cfg_t *motor_cogging_compensation_cfg)
+{
+	if ((motor_cogging_compensation_h == NULL) || (motor_cogging_compensation_cfg == NULL)) return false;
+	if (motor_cogging_compensation_cfg->motor_h == NULL) return false;
+	if ((motor_cogging_compensation_cfg->point_count < 2u) ||
+		(motor_cogging_compensation_cfg->point_count > MOTOR_COGGING_COMPENSATION_MAX_POINTS) ||
+		((motor_cogging_compensation_cfg->point_count & (motor_cogging_compensation_cfg->point_count - 1u)) != 0u))
+	{
+		return false;
+	}
+	if (motor_cogging_compensation_cfg->update_period_ms == 0u) return false;
+	if ((motor_cogging_compensation_cfg->learning_gain_q15 <= 0) ||
+		(motor_cogging_compensation_cfg->learning_gain_q15 > 32768)) return false;
+	if (motor_cogging_compensation_cfg->max_correction_permyriad > (uint16_t)INT16_MAX) return false;
+	if (motor_cogging_compensation_cfg->max_delta_per_step_counts == 0u) return false;
+
+	uint8_t point_shift = 16u;
+	for (uint8_t count = motor_cogging_compensation_cfg->point_count; count > 1u; count >>= 1)
+	{
+		point_shift--;
+	}
+
+	motor_cogging_compensation_h->cfg = motor_cogging_compensation_cfg;
+	motor_cogging_compensation_h->motor_h = motor_cogging_compensation_cfg->motor_h;
+	motor_cogging_compensation_h->point_shift = point_shift;
+	for (uint8_t k = 0u; k < MOTOR_COGGING_COMPENSATION_MAX_POINTS; k++)
+	{
+		motor_cogging_compensation_h->correction_q8[k] = 0;
+	}
+	motor_cogging_compensation_reset_turn(motor_cogging_compensation_h);
+	motor_cogging_compensation_h->turn_mean_uq_permyriad = 0;
+	motor_cogging_compensation_h->learned_revolution_count = 0u;
+	motor_cogging_compensation_h->is_initialized = true;
+	motor_cogging_compensation_h->motor_h->cogging.uq_correction_permyriad = 0;
+
+	return true;
+}
+
+bool motor_cogging_compensation_learn(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									  uint16_t mechanical_angle_u16,
+									  int32_t uq_command_permyriad)
+{
+	if ((motor_cogging_compensation_h == NULL) || (motor_cogging_compensation_h->cfg == NULL)) return false;
+	if (motor_cogging_compensation_h->is_initialized == false) return false;
+
+	const motor_cogging_compensation_cfg_t *cfg = motor_cogging_compensation_h->cfg;
+
+	if (motor_cogging_compensation_h->has_previous_angle == false)
+	{
+		motor_cogging_compensation_h->previous_angle_u16 = mechanical_angle_u16;
+		motor_cogging_compensation_h->has_previous_angle = true;
+		return true;
+	}
+
+	int32_t delta_counts =
+			(int32_t)(int16_t)(uint16_t)(mechanical_angle_u16 - motor_cogging_compensation_h->previous_angle_u16);
+	uint32_t abs_delta_counts = (delta_counts >= 0) ? (uint32_t)delta_counts : (uint32_t)(-delta_counts);
+	motor_cogging_compensation_h->previous_angle_u16 = mechanical_angle_u16;
+
+	/* A sample jump (sensor glitch, stall release) breaks the turn accounting. */
+	if (abs_delta_counts > (uint32_t)cfg->max_delta_per_step_counts)
+	{
+		motor_cogging_compensation_reset_turn(motor_cogging_compensation_h);
+		return true;
+	}
+
+	motor_cogging_compensation_h->turn_travel_counts += abs_delta_counts;
+	motor_cogging_compensation_h->turn_uq_sum_permyriad += (int64_t)uq_command_permyriad;
+	motor_cogging_compensation_h->turn_sample_count++;
+
+	if (motor_cogging_compensation_h->has_turn_mean)
+	{
+		/* Credit the residual to the angle of learning_delay_us ago: delay = step * delay / period. */
+		int32_t delay_counts =
+				(int32_t)motor_cogging_compensation_divide_round_nearest(
+						(int64_t)delta_counts * (int64_t)cfg->learning_delay_us,
+						(int64_t)cfg->update_period_ms * MOTOR_COGGING_COMPENSATION_US_PER_MS);
+		uint16_t learn_angle_u16 = (uint16_t)((int32_t)mechanical_angle_u16 - delay_counts);
+		const uint8_t shift = motor_cogging_compensation_h->point_shift;
+		const uint32_t segment_counts = 1UL << shift;
+		uint8_t lower = (uint8_t)(learn_angle_u16 >> shift);
+		uint8_t upper = (uint8_t)((lower + 1u) & (cfg->point_count - 1u));
+		uint32_t offset_counts = (uint32_t)learn_angle_u16 & (segment_counts - 1u);
+
+		/* step_q8 = gain * residual, shared like the interpolation reads it back. */
+		int64_t step_q8 = ((int64_t)(uq_command_permyriad - motor_cogging_compensation_h->turn_mean_uq_permyriad) *
+						   (int64_t)cfg->learning_gain_q15) >> MOTOR_COGGING_COMPENSATION_Q15_TO_Q8_SHIFT;
+		motor_cogging_compensation_add_step(motor_cogging_compensation_h, lower,
+											(step_q8 * (int64_t)(segment_counts - offset_counts)) >> shift);
+		motor_cogging_compensation_add_step(motor_cogging_compensation_h, upper,
+											(step_q8 * (int64_t)offset_counts) >> shift);
+	}
+
+	/* One full turn: its mean PI command becomes the baseline of the next turn. */
+	if (motor_cogging_compensation_h->turn_travel_counts >= MOTOR_COGGING_COMPENSATION_TURN_COUNTS)
+	{
+		if (motor_cogging_compensation_h->has_turn_mean)
+		{
+			motor_cogging_compensation_remove_mean(motor_cogging_compensation_h);
+			motor_cogging_compensation_h->learned_revolution_count++;
+		}
+		motor_cogging_compensation_h->turn_mean_uq_permyriad =
+				(int32_t)motor_cogging_compensation_divide_round_nearest(
+						motor_cogging_compensation_h->turn_uq_sum_permyriad,
+						(int64_t)motor_cogging_compensation_h->turn_sample_count);
+		motor_cogging_compensation_h->has_turn_mean = true;
+		motor_cogging_compensation_h->turn_travel_counts -= MOTOR_COGGING_COMPENSATION_TURN_COUNTS;
+		motor_cogging_compensation_h->turn_uq_sum_permyriad = 0;
+		motor_cogging_compensation_h->turn_sample_count = 0u;
+	}
+
+	return true;
+}
+
+bool motor_cogging_compensation_learn_stop(motor_cogging_compensation_handle_t *motor_cogging_compensation_h)
+{
+	if ((motor_cogging_compensation_h == NULL) || (motor_cogging_compensation_h->is_initialized == false)) return false;
+
+	motor_cogging_compensation_reset_turn(motor_cogging_compensation_h);
+
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_cogging_compensation_apply(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+									  uint16_t mechanical_angle_u16)
+{
+	if ((motor_cogging_compensation_h == NULL) || (motor_cogging_compensation_h->cfg == NULL)) return false;
+	if (motor_cogging_compensation_h->is_initialized == false) return false;
+
+	const uint8_t shift = motor_cogging_compensation_h->point_shift;
+	const uint32_t segment_counts = 1UL << shift;
+	uint8_t lower = (uint8_t)(mechanical_angle_u16 >> shift);
+	uint8_t upper = (uint8_t)((lower + 1u) & (motor_cogging_compensation_h->cfg->point_count - 1u));
+	uint32_t offset_counts = (uint32_t)mechanical_angle_u16 & (segment_counts - 1u);
+
+	/* Linear interpolation between the two table points around the angle (wraps at one turn). */
+	int64_t correction_q8 =
+			(((int64_t)motor_cogging_compensation_h->correction_q8[lower] * (int64_t)(segment_counts - offset_counts)) +
+			 ((int64_t)motor_cogging_compensation_h->correction_q8[upper] * (int64_t)offset_counts)) >> shift;
+	motor_cogging_compensation_h->motor_h->cogging.uq_correction_permyriad =
+			motor_cogging_compensation_q8_to_permyriad(correction_q8);
+
+	return true;
+}
+
+bool motor_cogging_compensation_set_table(motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+										  const int16_t *correction_permyriad,
+										  uint8_t point_count)
+{
+	if ((motor_cogging_compensation_h == NULL) || (correction_permyriad == NULL)) return false;
+	if ((motor_cogging_compensation_h->cfg == NULL) || (motor_cogging_compensation_h->is_initialized == false)) return false;
+	if (point_count != motor_cogging_compensation_h->cfg->point_count) return false;
+
+	const int32_t limit = (int32_t)motor_cogging_compensation_h->cfg->max_correction_permyriad;
+	for (uint8_t k = 0u; k < point_count; k++)
+	{
+		if ((correction_permyriad[k] > limit) || (correction_permyriad[k] < -limit)) return false;
+	}
+
+	for (uint8_t k = 0u; k < point_count; k++)
+	{
+		motor_cogging_compensation_h->correction_q8[k] =
+				(int32_t)correction_permyriad[k] * (1 << MOTOR_COGGING_COMPENSATION_Q8_SHIFT);
+	}
+	motor_cogging_compensation_reset_turn(motor_cogging_compensation_h);
+	motor_cogging_compensation_h->learned_revolution_count = 0u;
+
+	return true;
+}
+
+bool motor_cogging_compensation_get_table(const motor_cogging_compensation_handle_t *motor_cogging_compensation_h,
+										  int16_t *correction_permyriad,
+										  uint8_t capacity)
+{
+	if ((motor_cogging_compensation_h == NULL) || (correction_permyriad == NULL)) return false;
+	if ((motor_cogging_compensation_h->cfg == NULL) || (motor_cogging_compensation_h->is_initialized == false)) return false;
+	if (capacity < motor_cogging_compensation_h->cfg->point_count) return false;
+
+	for (uint8_t k = 0u; k < motor_cogging_compensation_h->cfg->point_count; k++)
+	{
+		correction_permyriad[k] =
+				(int16_t)motor_cogging_compensation_q8_to_permyriad(motor_cogging_compensation_h->correction_q8[k]);
+	}
+
+	return true;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file motor_current_pi.c
+ * @brief Digital d/q current PI controllers with cross-coupling decoupling.
+ *
+ */
+
+#include "motor/motor_current_pi.h"
+#include "drivers/memory_section.h"
+#include <stddef.h>
+
+#define MOTOR_CURRENT_PI_Q15_SHIFT           15
+#define MOTOR_CURRENT_PI_US_PER_SECOND       1000000LL
+/* we * L * i in permyriad of Vbus/2 = mrpm * pp * L_uH * i_mA * (2*pi/60000) * 2e-2 / Vbus_mV, factor in Q48. */
+#define MOTOR_CURRENT_PI_DECOUPLING_K_Q48    589519813LL
+#define MOTOR_CURRENT_PI_DECOUPLING_SHIFT    24
+
+/**
+ * @brief Divide one signed integer and round to nearest integer.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded signed integer quotient.
+ */
+MEMORY_SECTION_RAMFUNC
+static int64_t motor_current_pi_divide_round_nearest(int64_t numerator,
+													 int64_t denominator)
+{
+	if (numerator >= 0)
+	{
+		return (numerator + (denominator / 2LL)) / denominator;
+	}
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+
+/**
+ * @brief Clamp one signed integer into one symmetric range.
+ *
+ * @param value Input value.
+ * @param limit Positive magnitude limit.
+ * @return Clamped value.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_current_pi_clamp_i32(int64_t value, int32_t limit)
+{
+	if (value > (int64_t)limit) return limit;
+	if (value < -(int64_t)limit) return -limit;
+	return (int32_t)value;
+}
+
+/**
+ * @brief Run one axis PI step with feedforward and conditional integration.
+ *
+ * @param motor_current_pi_h Pointer to current PI handle.
+ * @param error_ma Current error in mA.
+ * @param feedforward_permyriad Decoupling term in permyriad.
+ * @param integrator_q15 Pointer to the axis integrator (Q15 permyriad).
+ * @return Limited voltage command in permyriad.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_current_pi_axis_update(const motor_current_pi_handle_t *motor_current_pi_h,
+											int32_t error_ma,
+											int32_t feedforward_permyriad,
+											int32_t *integrator_q15)
+{
+	const int32_t output_limit = (int32_t)motor_current_pi_h->cfg->output_limit_permyriad;
+	const int64_t integrator_limit_q15 = (int64_t)output_limit << MOTOR_CURRENT_PI_Q15_SHIFT;
+	int64_t proportional_q15 = (int64_t)motor_current_pi_h->cfg->kp_q15 * (int64_t)error_ma;
+	int64_t integrator_candidate_q15 = (int64_t)*integrator_q15 +
+									   ((int64_t)motor_current_pi_h->ki_dt_q15 * (int64_t)error_ma);
+	int64_t output_candidate_permyriad =
+			((proportional_q15 + integrator_candidate_q15) >> MOTOR_CURRENT_PI_Q15_SHIFT) +
+			(int64_t)feedforward_permyriad;
+
+	/* Hold the integrator while the output saturates in the direction of the error. */
+	if (((output_candidate_permyriad > (int64_t)output_limit) && (error_ma > 0)) ||
+		((output_candidate_permyriad < (int64_t)(-output_limit)) && (error_ma < 0)))
+	{
+		integrator_candidate_q15 = (int64_t)*integrator_q15;
+		output_candidate_permyriad =
+				((proportional_q15 + integrator_candidate_q15) >> MOTOR_CURRENT_PI_Q15_SHIFT) +
+				(int64_t)feedforward_permyriad;
+	}
+
+	if (integrator_candidate_q15 > integrator_limit_q15) integrator_candidate_q15 = integrator_limit_q15;
+	if (integrator_candidate_q15 < -integrator_limit_q15) integrator_candidate_q15 = -integrator_limit_q15;
+	*integrator_q15 = (int32_t)integrator_candidate_q15;
+
+	return motor_current_pi_clamp_i32(output_candidate_permyriad, output_limit);
+}
+
+bool motor_current_pi_init(motor_current_pi_handle_t *motor_current_pi_h,
+						   const motor_current_pi_cfg_t *motor_current_pi_cfg)
+{
+	if ((motor_current_pi_h == NULL) || (motor_current_pi_cfg == NULL)) return false;
+	if (motor_current_pi_cfg->motor_h == NULL) return false;
+	if (motor_current_pi_cfg->update_period_us == 0u) return false;
+	if (motor_current_pi_cfg->output_limit_permyriad == 0u) return false;
+	if (motor_current_pi_cfg->bus_voltage_mv == 0u) return false;
+	if ((motor_current_pi_cfg->speed_direction_sign != 1) &&
+		(motor_current_pi_cfg->speed_direction_sign != -1))
+	{
+		return false;
+	}
+	if ((motor_current_pi_cfg->kp_q15 < 0) || (motor_current_pi_cfg->ki_per_s_q15 < 0)) return false;
+
+	motor_handle_t *motor_h = motor_current_pi_cfg->motor_h;
+
+	/* Convert continuous-time Ki into one fixed-period discrete gain. */
+	motor_current_pi_h->ki_dt_q15 =
+			(int32_t)motor_current_pi_divide_round_nearest(
+					(int64_t)motor_current_pi_cfg->ki_per_s_q15 *
+					(int64_t)motor_current_pi_cfg->update_period_us,
+					MOTOR_CURRENT_PI_US_PER_SECOND);
+
+	/* Fold pole pairs, inductance and bus scaling into one constant (no runtime division). */
+	motor_current_pi_h->decoupling_scale_q48 =
+			motor_current_pi_divide_round_nearest(
+					MOTOR_CURRENT_PI_DECOUPLING_K_Q48 *
+					(int64_t)motor_h->limits.pole_pairs *
+					(int64_t)motor_current_pi_cfg->phase_inductance_uh,
+					(int64_t)motor_current_pi_cfg->bus_voltage_mv);
+
+	motor_current_pi_h->cfg = motor_current_pi_cfg;
+	motor_current_pi_h->motor_h = motor_h;
+	motor_current_pi_h->is_initialized = true;
+
+	return motor_current_pi_reset(motor_current_pi_h);
+}
+
+bool motor_current_pi_reset(motor_current_pi_handle_t *motor_current_pi_h)
+{
+	if (motor_current_pi_h == NULL) return false;
+	if ((motor_current_pi_h->cfg == NULL) || (motor_current_pi_h->motor_h == NULL)) return false;
+	if (motor_current_pi_h->is_initialized == false) return false;
+
+	motor_current_pi_h->id_integrator_q15 = 0;
+	motor_current_pi_h->iq_integrator_q15 = 0;
+	motor_current_pi_h->motor_h->current_pi = (motor_current_pi_state_t){0};
+
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_current_pi_update(motor_current_pi_handle_t *motor_current_pi_h,
+							 int32_t id_reference_ma,
+							 int32_t iq_reference_ma)
+{
+	if (motor_current_pi_h == NULL) return false;
+	if ((motor_current_pi_h->cfg == NULL) || (motor_current_pi_h->motor_h == NULL)) return false;
+	if (motor_current_pi_h->is_initialized == false) return false;
+
+	motor_handle_t *motor_h = motor_current_pi_h->motor_h;
+	int32_t id_ma = motor_h->current.id_ma;
+	int32_t iq_ma = motor_h->current.iq_ma;
+	int32_t ud_feedforward_permyriad = 0;
+	int32_t uq_feedforward_permyriad = 0;
+
+	/* Decoupling: ud += -we*L*iq, uq += +we*L*id with we as the d/q frame rate. */
+	if (motor_h->status.has_valid_mechanical_speed)
+	{
+		int64_t frame_speed_mrpm = (int64_t)motor_h->measurements.measured_mechanical_speed_mrpm *
+								   (int64_t)motor_current_pi_h->cfg->speed_direction_sign;
+		int64_t omega_l_q24 = (frame_speed_mrpm * motor_current_pi_h->decoupling_scale_q48) >>
+							  MOTOR_CURRENT_PI_DECOUPLING_SHIFT;
+
+		ud_feedforward_permyriad = (int32_t)(-((omega_l_q24 * (int64_t)iq_ma) >> MOTOR_CURRENT_PI_DECOUPLING_SHIFT));
+		uq_feedforward_permyriad = (int32_t)((omega_l_q24 * (int64_t)id_ma) >> MOTOR_CURRENT_PI_DECOUPLING_SHIFT);
+	}
+
+	int32_t ud_command_permyriad = motor_current_pi_axis_update(motor_current_pi_h,
+																id_reference_ma - id_ma,
+																ud_feedforward_permyriad,
+																&motor_current_pi_h->id_integrator_q15);
+	int32_t uq_command_permyriad = motor_current_pi_axis_update(motor_current_pi_h,
+																iq_reference_ma - iq_ma,
+																uq_feedforward_permyriad,
+																&motor_current_pi_h->iq_integrator_q15);
+
+	/* Publish references and limited voltage commands. */
+	motor_h->current_pi.id_reference_ma = id_reference_ma;
+	motor_h->current_pi.iq_reference_ma = iq_reference_ma;
+	motor_h->current_pi.ud_command_permyriad = ud_command_permyriad;
+	motor_h->current_pi.uq_command_permyriad = uq_command_permyriad;
+
+	return true;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file motor_current_sense.c
+ * @brief Phase-current reconstruction from low-side shunt samples.
+ *
+ */
+
+#include "motor/motor_current_sense.h"
+#include "motor/motor_sincos.h"
+#include <stddef.h>
+
+#define MOTOR_CURRENT_SENSE_ONE_THIRD_Q31        715827883LL	/* round(1 / 3 * 2^31) */
+#define MOTOR_CURRENT_SENSE_INV_SQRT3_Q31        1239850262LL	/* round(1 / sqrt(3) * 2^31) */
+#define MOTOR_CURRENT_SENSE_Q15_ROUND            16384
+
+/**
+ * @brief Convert one raw shunt reading into signed phase current.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @param raw_counts Raw ADC reading.
+ * @param channel Shunt channel index.
+ * @return Phase current in mA.
+ */
+static int32_t motor_current_sense_counts_to_ma(const motor_current_sense_handle_t *motor_current_sense_h,
+												uint16_t raw_counts,
+												uint8_t channel)
+{
+	int32_t delta_counts = ((int32_t)raw_counts - (int32_t)motor_current_sense_h->offset_counts[channel]) *
+						   (int32_t)motor_current_sense_h->cfg->current_sign;
+
+	return (int32_t)(((int64_t)delta_counts * (int64_t)motor_current_sense_h->cfg->ma_per_count_q16) >> 16);
+}
+
+/**
+ * @brief Accumulate one calibration sequence and finish the offsets on the last one.
+ *
+ * @param motor_current_sense_h Pointer to current-sense handle.
+ * @param samples Raw ADC results.
+ */
+static void motor_current_sense_accumulate_calibration(motor_current_sense_handle_t *motor_current_sense_h,
+													   const uint16_t *samples)
+{
+	const motor_current_sense_cfg_t *cfg = motor_current_sense_h->cfg;
+
+	for (uint8_t i = 0u; i < cfg->shunt_count; i++)
+	{
+		motor_current_sense_h->calibration_sum_counts[i] += samples[i];
+	}
+
+	if (--motor_current_sense_h->calibration_remaining != 0u) return;
+
+	/* Rounded mean per channel, accepted only inside the expected mid-rail window. */
+	bool offsets_ok = true;
+	for (uint8_t i = 0u; i < cfg->shunt_count; i++)
+	{
+		uint32_t offset = (motor_current_sense_h->calibration_sum_counts[i] +
+						   ((uint32_t)cfg->calibration_sample_count / 2u)) /
+						  (uint32_t)cfg->calibration_sample_count;
+		int32_t deviation = (int32_t)offset - (int32_t)cfg->nominal_offset_counts;
+
+		if ((deviation > (int32_t)cfg->max_offset_deviation_counts) ||
+			(deviation < -(int32_t)cfg->max_offset_deviation_counts))
+		{
+			offsets_ok = false;
+		}
+		motor_current_sense_h->offset_counts[i] = (uint16_t)offset;
+	}
+
+	motor_current_sense_h->calibration_failed = !offsets_ok;
+	motor_current_sense_h->is_calibrated = offsets_ok;
+}
+
+bool motor_current_sense_init(motor_current_sense_handle_t *motor_current_sense_h,
+							  const motor_current_sense_cfg_t *motor_current_sense_cfg)
+{
+	if ((motor_current_sense_h == NULL) || (motor_current_sense_cfg == NULL)) return false;
+	if (motor_current_sense_cfg->motor_h == NULL) return false;
+	if ((motor_current_sense_cfg->shunt_count != 2u) && (motor_current_sense_cfg->shunt_count != 3u)) return false;
+	if (motor_current_sense_cfg->ma_per_count_q16 <= 0) return false;
+	if ((motor_current_sense_cfg->current_sign != 1) && (motor_current_sense_cfg->current_sign != -1)) return false;
+	if ((motor_current_sense_cfg->phase_sequence_sign != 1) &&
+		(motor_current_sense_cfg->phase_sequence_sign != -1))
+	{
+		return false;
+	}
+	/* 12-bit sums over at most 65535 sequences stay inside uint32. */
+	if (motor_current_sense_cfg->calibration_sample_count == 0u) return false;
+
+	motor_current_sense_h->cfg = motor_current_sense_cfg;
+	motor_current_sense_h->motor_h = motor_current_sense_cfg->motor_h;
+	motor_current_sense_h->calibration_remaining = 0u;
+	motor_current_sense_h->is_calibrated = false;
+	motor_current_sense_h->calibration_failed = false;
+	for (uint8_t i = 0u; i < MOTOR_CURRENT_SENSE_MAX_SHUNTS; i++)
+	{
+		motor_current_sense_h->offset_counts[i] = motor_current_sense_cfg->nominal_offset_counts;
+		motor_current_sense_h->calibration_sum_counts[i] = 0u;
+	}
+	motor_current_sense_h->is_initialized = true;
+
+	motor_current_sense_h->motor_h->current = (motor_current_state_t){0};
+
+	return true;
+}
+
+bool motor_current_sense_start_calibration(motor_current_sense_handle_t *motor_current_sense_h)
+{
+	if (motor_current_sense_h == NULL) return false;
+	if ((motor_current_sense_h->cfg == NULL) || (motor_current_sense_h->is_initialized == false)) return false;
+
+	/* Stop the ISR side first, then clear the sums and arm the new run. */
+	motor_current_sense_h->calibration_remaining = 0u;
+	motor_current_sense_h->is_calibrated = false;
+	motor_current_sense_h->calibration_failed = false;
+	for (uint8_t i = 0u; i < MOTOR_CURRENT_SENSE_MAX_SHUNTS; i++)
+	{
+		motor_current_sense_h->calibration_sum_counts[i] = 0u;
+	}
+	motor_current_sense_h->calibration_remaining = motor_current_sense_h->cfg->calibration_sample_count;
+
+	return true;
+}
+
+bool motor_current_sense_is_calibrated(const motor_current_sense_handle_t *motor_current_sense_h)
+{
+	if (motor_current_sense_h == NULL) return false;
+
+	return motor_current_sense_h->is_calibrated;
+}
+
+bool motor_current_sense_process(motor_current_sense_handle_t *motor_current_sense_h,
+								 const uint16_t *samples,
+								 uint8_t sample_count)
+{
+	if ((motor_current_sense_h == NULL) || (samples == NULL)) return false;
+	if ((motor_current_sense_h->cfg == NULL) || (motor_current_sense_h->is_initialized == false)) return false;
+	if (sample_count != motor_current_sense_h->cfg->shunt_count) return false;
+
+	if (motor_current_sense_h->calibration_remaining != 0u)
+	{
+		motor_current_sense_accumulate_calibration(motor_current_sense_h, samples);
+		return false;
+	}
+	if (motor_current_sense_h->is_calibrated == false) return false;
+
+	motor_current_state_t *current = &motor_current_sense_h->motor_h->current;
+	int32_t phase_a_ma = motor_current_sense_counts_to_ma(motor_current_sense_h, samples[0], 0u);
+	int32_t phase_b_ma = motor_current_sense_counts_to_ma(motor_current_sense_h, samples[1], 1u);
+	int32_t phase_c_ma = 0;
+	int32_t alpha_ma = 0;
+	int32_t beta_ma = 0;
+
+	if (motor_current_sense_h->cfg->shunt_count == 3u)
+	{
+		/* Three shunts: alpha = (2a - b - c) / 3 rejects the common-mode error, beta = (b - c) / sqrt(3). */
+		phase_c_ma = motor_current_sense_counts_to_ma(motor_current_sense_h, samples[2], 2u);
+		alpha_ma = (int32_t)(((int64_t)((2 * phase_a_ma) - phase_b_ma - phase_c_ma) *
+							  MOTOR_CURRENT_SENSE_ONE_THIRD_Q31) >> 31);
+		beta_ma = (int32_t)(((int64_t)(phase_b_ma - phase_c_ma) * MOTOR_CURRENT_SENSE_INV_SQRT3_Q31) >> 31);
+	}
+	else
+	{
+		/* Two shunts: c = -a - b, so alpha = a and beta = (a + 2b) / sqrt(3). */
+		phase_c_ma = -phase_a_ma - phase_b_ma;
+		alpha_ma = phase_a_ma;
+		beta_ma = (int32_t)(((int64_t)(phase_a_ma + (2 * phase_b_ma)) * MOTOR_CURRENT_SENSE_INV_SQRT3_Q31) >> 31);
+	}
+
+	current->phase_a_ma = phase_a_ma;
+	current->phase_b_ma = phase_b_ma;
+	current->phase_c_ma = phase_c_ma;
+	current->alpha_ma = alpha_ma;
+	current->beta_ma = beta_ma;
+
+	return true;
+}
+
+bool motor_current_sense_update_dq(motor_current_sense_handle_t *motor_current_sense_h)
+{
+	if (motor_current_sense_h == NULL) return false;
+	if ((motor_current_sense_h->cfg == NULL) || (motor_current_sense_h->is_initialized == false)) return false;
+
+	motor_handle_t *motor_h = motor_current_sense_h->motor_h;
+	if (motor_h->status.has_valid_electrical_angle == false) return false;
+
+	/* Park in the inverse-Park basis of motor_foc_voltage (alpha = sin-axis, beta = cos-axis):
+	 * that rotation is its own inverse, so id = a*sin + b*cos, iq' = a*cos - b*sin. */
+	motor_sincos_q15_t sincos_theta = motor_sincos_get_q15(motor_h->measurements.electrical_angle_u16);
+	int32_t alpha_ma = motor_h->current.alpha_ma;
+	int32_t beta_ma = motor_h->current.beta_ma;
+	int64_t id_scaled = ((int64_t)alpha_ma * sincos_theta.sin_q15) + ((int64_t)beta_ma * sincos_theta.cos_q15);
+	int64_t iq_scaled = ((int64_t)alpha_ma * sincos_theta.cos_q15) - ((int64_t)beta_ma * sincos_theta.sin_q15);
+
+	/* Undo the q-axis handedness applied on the voltage side. */
+	motor_h->current.id_ma = (int32_t)((id_scaled + MOTOR_CURRENT_SENSE_Q15_ROUND) >> 15);
+	motor_h->current.iq_ma = (int32_t)((iq_scaled + MOTOR_CURRENT_SENSE_Q15_ROUND) >> 15) *
+							 (int32_t)motor_current_sense_h->cfg->phase_sequence_sign;
+
+	return true;
+}
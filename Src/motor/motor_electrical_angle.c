@@ -7,17 +7,26 @@
 #include "motor/motor_electrical_angle.h"
 #include <stddef.h>
 
+/* 65536 * 2^32 / (60e6 us/min * 1000 mrpm/rpm): full-turn counts per mrpm*us in Q32. */
+#define MOTOR_ELECTRICAL_ANGLE_COUNTS_PER_MRPM_US_Q32  4691u
+
 bool motor_electrical_angle_init(motor_electrical_angle_handle_t *motor_electrical_angle_h,
 								 const motor_electrical_angle_cfg_t *motor_electrical_angle_cfg)
 {
 	if ((motor_electrical_angle_h == NULL) || (motor_electrical_angle_cfg == NULL)) return false;
 	if (motor_electrical_angle_cfg->motor_h == NULL) return false;
 	if (motor_electrical_angle_cfg->motor_h->limits.pole_pairs == 0u) return false;
+	if ((motor_electrical_angle_cfg->speed_direction_sign != 1) &&
+		(motor_electrical_angle_cfg->speed_direction_sign != -1)) return false;
 
 	/* Reset the measured electrical-angle helper state. */
 	motor_electrical_angle_h->cfg = motor_electrical_angle_cfg;
 	motor_electrical_angle_h->motor_h = motor_electrical_angle_cfg->motor_h;
 	motor_electrical_angle_h->electrical_offset_u16 = motor_electrical_angle_cfg->electrical_offset_u16;
+	motor_electrical_angle_h->electrical_counts_per_mrpm_us_q32 =
+			MOTOR_ELECTRICAL_ANGLE_COUNTS_PER_MRPM_US_Q32 *
+			(uint32_t)motor_electrical_angle_cfg->motor_h->limits.pole_pairs;
+	motor_electrical_angle_h->last_prediction_counts = 0;
 	motor_electrical_angle_h->is_initialized = true;
 
 	return true;
@@ -52,6 +61,40 @@ bool motor_electrical_angle_update(motor_electrical_angle_handle_t *motor_electr
 	return true;
 }
 
+bool motor_electrical_angle_update_predicted(motor_electrical_angle_handle_t *motor_electrical_angle_h,
+											 uint16_t mechanical_angle_u16,
+											 uint32_t prediction_horizon_us)
+{
+	int32_t prediction_counts = 0;
+
+	if (!motor_electrical_angle_update(motor_electrical_angle_h, mechanical_angle_u16)) return false;
+
+	motor_handle_t *motor_h = motor_electrical_angle_h->motor_h;
+	if (motor_h->status.has_valid_mechanical_speed == true)
+	{
+		if (prediction_horizon_us > motor_electrical_angle_h->cfg->max_prediction_horizon_us)
+		{
+			prediction_horizon_us = motor_electrical_angle_h->cfg->max_prediction_horizon_us;
+		}
+
+		/* delta_e = speed_mrpm * horizon_us * pole_pairs * 65536 / 60e9 (sensor direction). */
+		int64_t speed_mrpm =
+				(int64_t)motor_h->measurements.measured_mechanical_speed_mrpm *
+				(int64_t)motor_electrical_angle_h->cfg->speed_direction_sign;
+		int64_t prediction_num =
+				speed_mrpm * (int64_t)prediction_horizon_us *
+				(int64_t)motor_electrical_angle_h->electrical_counts_per_mrpm_us_q32;
+		prediction_counts = (int32_t)((prediction_num + (1LL << 31)) >> 32);
+	}
+
+	/* Advance the published angle; uint16 wraparound keeps it on the full turn. */
+	motor_h->measurements.electrical_angle_u16 =
+			(uint16_t)((int32_t)motor_h->measurements.electrical_angle_u16 + prediction_counts);
+	motor_electrical_angle_h->last_prediction_counts = prediction_counts;
+
+	return true;
+}
+
 bool motor_electrical_angle_compute_raw(motor_electrical_angle_handle_t *motor_electrical_angle_h,
 										uint16_t mechanical_angle_u16,
 										uint16_t *electrical_angle_u16)
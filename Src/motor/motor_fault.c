@@ -0,0 +1,263 @@
+/**
+ * @file motor_fault.c
+ * @brief Latched motor fault with hardware shutdown and one snapshot record.
+ *
+ */
+
+#include "motor/motor_fault.h"
+#include <stddef.h>
+
+/* Milli-rpm x microseconds per turn: 1 rpm = 1 turn / 60e6 us. */
+#define MOTOR_FAULT_MRPM_US_PER_TURN    60000000000ull
+
+/**
+ * @brief Claim the latch for one code (first caller wins, any priority).
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param code Fault code.
+ * @return true if this call latched the fault, false if one was already latched.
+ */
+static bool motor_fault_try_latch(motor_fault_handle_t *motor_fault_h, motor_fault_code_t code)
+{
+	do
+	{
+		if (__LDREXW(&motor_fault_h->latched_code) != (uint32_t)MOTOR_FAULT_CODE_NONE)
+		{
+			__CLREX();
+			return false;
+		}
+	} while (__STREXW((uint32_t)code, &motor_fault_h->latched_code) != 0u);
+
+	return true;
+}
+
+/**
+ * @brief Record the shared motor state for the fault that just latched.
+ *
+ * @param motor_fault_h Pointer to fault handle.
+ * @param code Fault code.
+ * @param detail Code-specific value.
+ */
+static void motor_fault_take_snapshot(motor_fault_handle_t *motor_fault_h,
+									  motor_fault_code_t code,
+									  uint32_t detail)
+{
+	const motor_handle_t *motor_h = motor_fault_h->cfg->motor_h;
+	motor_fault_snapshot_t *snapshot = &motor_fault_h->snapshot;
+
+	snapshot->code = code;
+	snapshot->detail = detail;
+	snapshot->timestamp_us = motor_fault_h->cfg->get_time_us();
+	snapshot->mechanical_angle_u16 = motor_h->measurements.mechanical_angle_u16;
+	snapshot->electrical_angle_u16 = motor_h->measurements.electrical_angle_u16;
+	snapshot->filtered_mechanical_speed_mrpm = motor_h->speed_feedback.filtered_mechanical_speed_mrpm;
+	snapshot->uq_command_permyriad = motor_h->speed_pi.speed_control_uq_command_permyriad;
+	snapshot->id_ma = motor_h->current.id_ma;
+	snapshot->iq_ma = motor_h->current.iq_ma;
+
+	/* Record contents must be visible before the valid flag. */
+	__DMB();
+	motor_fault_h->snapshot_valid = true;
+}
+
+/**
+ * @brief TIM1 break callback (BKIN or software break, fault priority).
+ *
+ * @param callback_arg Pointer to fault handle.
+ */
+static void motor_fault_break_callback(void *callback_arg)
+{
+	motor_fault_raise((motor_fault_handle_t *)callback_arg, MOTOR_FAULT_CODE_BREAK_INPUT, 0u);
+}
+
+bool motor_fault_init(motor_fault_handle_t *motor_fault_h, const motor_fault_cfg_t *motor_fault_cfg)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_cfg == NULL)) return false;
+	if ((motor_fault_cfg->motor_h == NULL) || (motor_fault_cfg->pwm_h == NULL)) return false;
+	if (motor_fault_cfg->get_time_us == NULL) return false;
+	if (motor_fault_cfg->max_abs_mechanical_speed_mrpm < 0) return false;
+
+	motor_fault_h->cfg = motor_fault_cfg;
+	motor_fault_h->latched_code = (uint32_t)MOTOR_FAULT_CODE_NONE;
+	motor_fault_h->snapshot_valid = false;
+	motor_fault_h->snapshot = (motor_fault_snapshot_t){0};
+	/* counts/us = mrpm * 65536 / 60e9, kept in Q16 so one step check is a 32x32 multiply. */
+	motor_fault_h->max_step_counts_per_us_q16 =
+			(uint32_t)(((uint64_t)motor_fault_cfg->max_abs_mechanical_speed_mrpm << 32) / MOTOR_FAULT_MRPM_US_PER_TURN);
+	motor_fault_h->angle_history_reset_request = false;
+	motor_fault_h->has_angle_history = false;
+	motor_fault_h->last_mechanical_angle_u16 = 0u;
+	motor_fault_h->last_capture_timestamp_us = 0u;
+	motor_fault_h->is_initialized = true;
+
+	if (!pwm_tim1_register_break_callback(motor_fault_cfg->pwm_h, motor_fault_break_callback, motor_fault_h))
+	{
+		motor_fault_h->is_initialized = false;
+		return false;
+	}
+
+	/* A break before the callback existed is still a fault. */
+	if (motor_fault_cfg->pwm_h->break_latched)
+	{
+		motor_fault_raise(motor_fault_h, MOTOR_FAULT_CODE_BREAK_INPUT, 0u);
+	}
+
+	return true;
+}
+
+void motor_fault_raise(motor_fault_handle_t *motor_fault_h, motor_fault_code_t code, uint32_t detail)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_h->is_initialized == false)) return;
+	if ((code == MOTOR_FAULT_CODE_NONE) || (code >= MOTOR_FAULT_CODE_COUNT)) return;
+
+	const motor_fault_cfg_t *cfg = motor_fault_h->cfg;
+
+	/* Claim the code first: the software break below preempts this context with BREAK_INPUT. */
+	bool is_first_fault = motor_fault_try_latch(motor_fault_h, code);
+
+	/* Shut down before the snapshot: driver enable, then MOE through the break path. */
+	if (cfg->enable_pin_cfg != NULL)
+	{
+		gpio_write(cfg->enable_pin_cfg->pin, false);
+	}
+	if (cfg->pwm_h->break_latched == false)
+	{
+		(void)pwm_tim1_trigger_break(cfg->pwm_h);
+	}
+	cfg->motor_h->status.is_enabled = false;
+
+	if (is_first_fault)
+	{
+		motor_fault_take_snapshot(motor_fault_h, code, detail);
+	}
+}
+
+bool motor_fault_classify_angle_sample(motor_fault_handle_t *motor_fault_h,
+									   uint16_t mechanical_angle_u16,
+									   uint64_t capture_timestamp_us,
+									   uint64_t now_us,
+									   motor_fault_code_t *code,
+									   uint32_t *detail)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_h->is_initialized == false)) return false;
+	if ((code == NULL) || (detail == NULL)) return false;
+
+	const motor_fault_cfg_t *cfg = motor_fault_h->cfg;
+
+	*code = MOTOR_FAULT_CODE_NONE;
+	*detail = 0u;
+
+	if (motor_fault_h->angle_history_reset_request)
+	{
+		motor_fault_h->angle_history_reset_request = false;
+		motor_fault_h->has_angle_history = false;
+	}
+
+	/* Starvation: the acquisition stopped publishing (stalled bus, trigger lost, ...). */
+	uint64_t sample_age_us = (now_us > capture_timestamp_us) ? (now_us - capture_timestamp_us) : 0u;
+	if ((cfg->max_sample_age_us != 0u) && (sample_age_us > cfg->max_sample_age_us))
+	{
+		*code = MOTOR_FAULT_CODE_SAMPLE_STARVATION;
+		*detail = (sample_age_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)sample_age_us;
+		return false;
+	}
+
+	/* The same sample is seen by several control steps; only a new capture is step-checked. */
+	if ((motor_fault_h->has_angle_history) && (capture_timestamp_us == motor_fault_h->last_capture_timestamp_us))
+	{
+		return true;
+	}
+
+	if ((motor_fault_h->has_angle_history) && (motor_fault_h->max_step_counts_per_us_q16 != 0u))
+	{
+		uint64_t spacing_us = capture_timestamp_us - motor_fault_h->last_capture_timestamp_us;
+		int32_t step_counts = (int32_t)(int16_t)(uint16_t)(mechanical_angle_u16 - motor_fault_h->last_mechanical_angle_u16);
+		uint32_t abs_step_counts = (step_counts < 0) ? (uint32_t)(-step_counts) : (uint32_t)step_counts;
+		uint64_t allowed_counts = cfg->angle_step_margin_counts;
+
+		if (spacing_us > UINT32_MAX) spacing_us = UINT32_MAX;
+		allowed_counts += ((uint64_t)motor_fault_h->max_step_counts_per_us_q16 * spacing_us) >> 16;
+
+		/* Beyond half a turn the wrapped step is ambiguous: no verdict on such spacings. */
+		if ((allowed_counts < 32768u) && (abs_step_counts > allowed_counts))
+		{
+			*code = MOTOR_FAULT_CODE_ANGLE_IMPLAUSIBLE;
+			*detail = abs_step_counts;
+			return false;
+		}
+	}
+
+	motor_fault_h->last_mechanical_angle_u16 = mechanical_angle_u16;
+	motor_fault_h->last_capture_timestamp_us = capture_timestamp_us;
+	motor_fault_h->has_angle_history = true;
+
+	return true;
+}
+
+bool motor_fault_check_angle_sample(motor_fault_handle_t *motor_fault_h,
+									uint16_t mechanical_angle_u16,
+									uint64_t capture_timestamp_us,
+									uint64_t now_us)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_h->is_initialized == false)) return false;
+	if (motor_fault_h->latched_code != (uint32_t)MOTOR_FAULT_CODE_NONE) return false;
+
+	motor_fault_code_t code;
+	uint32_t detail;
+
+	if (motor_fault_classify_angle_sample(motor_fault_h, mechanical_angle_u16, capture_timestamp_us, now_us, &code, &detail))
+	{
+		return true;
+	}
+
+	if (code != MOTOR_FAULT_CODE_NONE)
+	{
+		motor_fault_raise(motor_fault_h, code, detail);
+	}
+	return false;
+}
+
+bool motor_fault_check_speed(motor_fault_handle_t *motor_fault_h)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_h->is_initialized == false)) return false;
+	if (motor_fault_h->latched_code != (uint32_t)MOTOR_FAULT_CODE_NONE) return false;
+
+	const motor_fault_cfg_t *cfg = motor_fault_h->cfg;
+	int32_t speed_mrpm = cfg->motor_h->speed_feedback.filtered_mechanical_speed_mrpm;
+	uint32_t abs_speed_mrpm = (speed_mrpm < 0) ? (0u - (uint32_t)speed_mrpm) : (uint32_t)speed_mrpm;
+
+	if ((cfg->max_abs_mechanical_speed_mrpm != 0) &&
+		(abs_speed_mrpm > (uint32_t)cfg->max_abs_mechanical_speed_mrpm))
+	{
+		motor_fault_raise(motor_fault_h, MOTOR_FAULT_CODE_OVER_SPEED, abs_speed_mrpm);
+		return false;
+	}
+
+	return true;
+}
+
+bool motor_fault_reset_angle_history(motor_fault_handle_t *motor_fault_h)
+{
+	if ((motor_fault_h == NULL) || (motor_fault_h->is_initialized == false)) return false;
+
+	motor_fault_h->angle_history_reset_request = true;
+	return true;
+}
+
+bool motor_fault_is_latched(const motor_fault_handle_t *motor_fault_h)
+{
+	if (motor_fault_h == NULL) return false;
+
+	return (motor_fault_h->latched_code != (uint32_t)MOTOR_FAULT_CODE_NONE);
+}
+
+bool motor_fault_get_snapshot(const motor_fault_handle_t *motor_fault_h, motor_fault_snapshot_t *snapshot)
+{
+	if ((motor_fault_h == NULL) || (snapshot == NULL)) return false;
+	if (motor_fault_h->snapshot_valid == false) return false;
+
+	/* Written once by the latching context; the flag orders the read after it. */
+	__DMB();
+	*snapshot = motor_fault_h->snapshot;
+	return true;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file motor_field_weakening.c
+ * @brief Voltage-magnitude field weakening with a negative Ud reference (voltage-mode FOC).
+ *
+ */
+
+#include "motor/motor_field_weakening.h"
+#include "motor/motor_sine_3pwm.h"
+#include <stddef.h>
+
+#define MOTOR_FIELD_WEAKENING_Q15_SHIFT         15
+#define MOTOR_FIELD_WEAKENING_MS_PER_SECOND     1000LL
+
+/**
+ * @brief Divide one signed integer and round to nearest integer.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded signed integer quotient.
+ */
+static int64_t motor_field_weakening_divide_round_nearest(int64_t numerator,
+														  int64_t denominator)
+{
+	if (numerator >= 0)
+	{
+		return (numerator + (denominator / 2LL)) / denominator;
+	}
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+
+/**
+ * @brief Integer square root (floor).
+ *
+ * @param value Radicand.
+ * @return floor(sqrt(value)).
+ */
+static uint32_t motor_field_weakening_isqrt_u32(uint32_t value)
+{
+	uint32_t result = 0u;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > value) bit >>= 2;
+	while (bit != 0u)
+	{
+		if (value >= (result + bit))
+		{
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		}
+		else
+		{
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Publish one Ud command, the Uq left on the circle and the vector magnitude.
+ *
+ * @param motor_field_weakening_h Pointer to field-weakening handle.
+ * @param ud_command_permyriad Ud command (<= 0).
+ * @param voltage_magnitude_permyriad |(Ud, Uq)| the command was derived from.
+ */
+static void motor_field_weakening_publish(motor_field_weakening_handle_t *motor_field_weakening_h,
+										  int32_t ud_command_permyriad,
+										  int32_t voltage_magnitude_permyriad)
+{
+	const uint32_t limit = motor_field_weakening_h->cfg->voltage_limit_permyriad;
+	motor_handle_t *motor_h = motor_field_weakening_h->motor_h;
+
+	motor_h->field_weakening.ud_command_permyriad = ud_command_permyriad;
+	motor_h->field_weakening.uq_limit_permyriad =
+			(int32_t)motor_field_weakening_isqrt_u32((limit * limit) -
+													 (uint32_t)(ud_command_permyriad * ud_command_permyriad));
+	motor_h->field_weakening.voltage_magnitude_permyriad = voltage_magnitude_permyriad;
+}
+
+bool motor_field_weakening_init(motor_field_weakening_handle_t *motor_field_weakening_h,
+								const motor_field_weakening_cfg_t *motor_field_weakening_cfg)
+{
+	if ((motor_field_weakening_h == NULL) || (motor_field_weakening_cfg == NULL)) return false;
+	if (motor_field_weakening_cfg->motor_h == NULL) return false;
+	if (motor_field_weakening_cfg->update_period_ms == 0u) return false;
+	if (motor_field_weakening_cfg->voltage_limit_permyriad == 0u) return false;
+	if (motor_field_weakening_cfg->voltage_limit_permyriad > MOTOR_SINE_3PWM_MAX_AMPLITUDE_PERMYRIAD) return false;
+	if (motor_field_weakening_cfg->voltage_target_permyriad >= motor_field_weakening_cfg->voltage_limit_permyriad)
+	{
+		return false;
+	}
+	if (motor_field_weakening_cfg->max_ud_permyriad >= motor_field_weakening_cfg->voltage_limit_permyriad)
+	{
+		return false;
+	}
+	if (motor_field_weakening_cfg->ki_per_s_q15 < 0) return false;
+
+	/* Convert continuous-time Ki into one fixed-period discrete gain. */
+	motor_field_weakening_h->cfg = motor_field_weakening_cfg;
+	motor_field_weakening_h->motor_h = motor_field_weakening_cfg->motor_h;
+	motor_field_weakening_h->ki_dt_q15 =
+			(int32_t)motor_field_weakening_divide_round_nearest(
+					(int64_t)motor_field_weakening_cfg->ki_per_s_q15 *
+					(int64_t)motor_field_weakening_cfg->update_period_ms,
+					MOTOR_FIELD_WEAKENING_MS_PER_SECOND);
+	motor_field_weakening_h->is_initialized = true;
+
+	return motor_field_weakening_reset(motor_field_weakening_h);
+}
+
+bool motor_field_weakening_reset(motor_field_weakening_handle_t *motor_field_weakening_h)
+{
+	if (motor_field_weakening_h == NULL) return false;
+	if ((motor_field_weakening_h->cfg == NULL) || (motor_field_weakening_h->motor_h == NULL)) return false;
+	if (motor_field_weakening_h->is_initialized == false) return false;
+
+	motor_field_weakening_h->ud_integrator_q15 = 0;
+	motor_field_weakening_publish(motor_field_weakening_h, 0, 0);
+
+	return true;
+}
+
+bool motor_field_weakening_update(motor_field_weakening_handle_t *motor_field_weakening_h,
+								  int32_t uq_command_permyriad,
+								  int32_t measured_mechanical_speed_mrpm)
+{
+	if (motor_field_weakening_h == NULL) return false;
+	if ((motor_field_weakening_h->cfg == NULL) || (motor_field_weakening_h->motor_h == NULL)) return false;
+	if (motor_field_weakening_h->is_initialized == false) return false;
+
+	const motor_field_weakening_cfg_t *cfg = motor_field_weakening_h->cfg;
+	const int32_t voltage_limit = (int32_t)cfg->voltage_limit_permyriad;
+	const int64_t min_ud_q15 = -((int64_t)cfg->max_ud_permyriad << MOTOR_FIELD_WEAKENING_Q15_SHIFT);
+	int32_t ud_permyriad = motor_field_weakening_h->motor_h->field_weakening.ud_command_permyriad;
+	uint32_t speed_mrpm = (measured_mechanical_speed_mrpm >= 0) ?
+						  (uint32_t)measured_mechanical_speed_mrpm :
+						  (uint32_t)(-(int64_t)measured_mechanical_speed_mrpm);
+
+	if (uq_command_permyriad > voltage_limit) uq_command_permyriad = voltage_limit;
+	if (uq_command_permyriad < -voltage_limit) uq_command_permyriad = -voltage_limit;
+
+	/* |U| of the command the stage applies this step (Ud from the previous step). */
+	int32_t voltage_magnitude_permyriad =
+			(int32_t)motor_field_weakening_isqrt_u32((uint32_t)(ud_permyriad * ud_permyriad) +
+													 (uint32_t)(uq_command_permyriad * uq_command_permyriad));
+
+	/* Above target: Ud deeper (more negative); below target or too slow: Ud back towards 0. */
+	int32_t voltage_error_permyriad = (speed_mrpm < cfg->min_speed_mrpm) ?
+									  (int32_t)cfg->voltage_target_permyriad :
+									  ((int32_t)cfg->voltage_target_permyriad - voltage_magnitude_permyriad);
+	int64_t integrator_q15 = (int64_t)motor_field_weakening_h->ud_integrator_q15 +
+							 ((int64_t)motor_field_weakening_h->ki_dt_q15 * (int64_t)voltage_error_permyriad);
+
+	if (integrator_q15 > 0) integrator_q15 = 0;
+	if (integrator_q15 < min_ud_q15) integrator_q15 = min_ud_q15;
+	motor_field_weakening_h->ud_integrator_q15 = (int32_t)integrator_q15;
+
+	/* Round towards zero so the command returns exactly to 0 with the integrator. */
+	ud_permyriad = -(int32_t)((-integrator_q15) >> MOTOR_FIELD_WEAKENING_Q15_SHIFT);
+	motor_field_weakening_publish(motor_field_weakening_h, ud_permyriad, voltage_magnitude_permyriad);
+
+	return true;
+}
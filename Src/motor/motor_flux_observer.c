@@ -0,0 +1,266 @@
+/**
+ * @file motor_flux_observer.c
+ * @brief Sensorless rotor-angle and speed estimate from the phase voltages and currents (current mode).
+ *
+ *  Notes:
+ *  - units keep every step integer: R[mOhm] * i[mA] = uV, uV * us = pWb,
+ *    L[uH] * i[mA] = nWb; the flux length runs on 2^18 pWb (about 0.26 uWb)
+ *    so lambda^2 stays inside int64 with a precomputed reciprocal.
+ *  - the flux angle uses a 16-step CORDIC (about 0.01 deg), no division
+ *    and no table larger than 16 words.
+ */
+
+#include "motor/motor_flux_observer.h"
+#include "motor/motor_sincos.h"
+#include "drivers/memory_section.h"
+#include <stddef.h>
+
+#define MOTOR_FLUX_OBSERVER_PWB_PER_UWB          1000000LL
+#define MOTOR_FLUX_OBSERVER_PWB_PER_NWB          1000LL
+#define MOTOR_FLUX_OBSERVER_LENGTH_SHIFT         18
+#define MOTOR_FLUX_OBSERVER_CORDIC_SHIFT         10
+#define MOTOR_FLUX_OBSERVER_CORDIC_STEPS         16u
+#define MOTOR_FLUX_OBSERVER_HALF_TURN_Q20        (1UL << 19)
+#define MOTOR_FLUX_OBSERVER_TURN_MASK_Q20        ((1UL << 20) - 1u)
+#define MOTOR_FLUX_OBSERVER_Q15_ONE              32768
+#define MOTOR_FLUX_OBSERVER_Q24_SHIFT            24
+#define MOTOR_FLUX_OBSERVER_TWO_PI_Q24           105414357LL
+#define MOTOR_FLUX_OBSERVER_US_PER_S             1000000LL
+#define MOTOR_FLUX_OBSERVER_MRPM_PER_RPS_US      60000000000LL   /* 60000 mrpm/rps * 1e6 us/s */
+#define MOTOR_FLUX_OBSERVER_ERROR_FILTER_SHIFT   5               /* 32 samples (1.6 ms at 20 kHz). */
+
+/* atan(2^-i) in 2^20 counts per turn. */
+static const uint32_t motor_flux_observer_cordic_atan_q20[MOTOR_FLUX_OBSERVER_CORDIC_STEPS] = {
+		131072u, 77376u, 40884u, 20753u, 10417u, 5213u, 2607u, 1304u,
+		652u, 326u, 163u, 81u, 41u, 20u, 10u, 5u,
+};
+
+/**
+ * @brief Angle of one vector in the project basis (alpha = sin-axis, beta = cos-axis).
+ *
+ * @param alpha Alpha component.
+ * @param beta Beta component.
+ * @return Angle in 2^20 counts per turn.
+ */
+MEMORY_SECTION_RAMFUNC
+static uint32_t motor_flux_observer_angle_q20(int32_t alpha, int32_t beta)
+{
+	/* atan2(alpha, beta): rotate the vector onto +beta and sum the rotations. */
+	int32_t x = beta;
+	int32_t y = alpha;
+	uint32_t angle_q20 = 0u;
+
+	if (x < 0)
+	{
+		x = -x;
+		y = -y;
+		angle_q20 = MOTOR_FLUX_OBSERVER_HALF_TURN_Q20;
+	}
+
+	for (uint8_t i = 0u; i < MOTOR_FLUX_OBSERVER_CORDIC_STEPS; i++)
+	{
+		int32_t x_shifted = x >> i;
+		int32_t y_shifted = y >> i;
+
+		if (y > 0)
+		{
+			x += y_shifted;
+			y -= x_shifted;
+			angle_q20 += motor_flux_observer_cordic_atan_q20[i];
+		}
+		else
+		{
+			x -= y_shifted;
+			y += x_shifted;
+			angle_q20 -= motor_flux_observer_cordic_atan_q20[i];
+		}
+	}
+
+	return angle_q20 & MOTOR_FLUX_OBSERVER_TURN_MASK_Q20;
+}
+
+bool motor_flux_observer_init(motor_flux_observer_handle_t *motor_flux_observer_h,
+							  const motor_flux_observer_cfg_t *motor_flux_observer_cfg)
+{
+	if ((motor_flux_observer_h == NULL) || (motor_flux_observer_cfg == NULL)) return false;
+	if (motor_flux_observer_cfg->motor_h == NULL) return false;
+	if (motor_flux_observer_cfg->motor_h->limits.pole_pairs == 0u) return false;
+	if (motor_flux_observer_cfg->update_period_us == 0u) return false;
+	if ((motor_flux_observer_cfg->phase_inductance_uh == 0u) || (motor_flux_observer_cfg->flux_linkage_uwb == 0u)) return false;
+	if (motor_flux_observer_cfg->voltage_mv_per_permyriad_q16 <= 0) return false;
+	if ((motor_flux_observer_cfg->phase_sequence_sign != 1) && (motor_flux_observer_cfg->phase_sequence_sign != -1)) return false;
+	if ((motor_flux_observer_cfg->speed_direction_sign != 1) && (motor_flux_observer_cfg->speed_direction_sign != -1)) return false;
+	if ((motor_flux_observer_cfg->pll_bandwidth_hz == 0u) || (motor_flux_observer_cfg->max_pll_error_counts == 0u)) return false;
+
+	/* k * dt <= 1 keeps the length correction from overshooting in one step. */
+	int64_t flux_gain_q15 = ((int64_t)motor_flux_observer_cfg->flux_gain_per_s *
+							 (int64_t)motor_flux_observer_cfg->update_period_us * MOTOR_FLUX_OBSERVER_Q15_ONE) /
+							MOTOR_FLUX_OBSERVER_US_PER_S;
+	if ((flux_gain_q15 <= 0) || (flux_gain_q15 > MOTOR_FLUX_OBSERVER_Q15_ONE)) return false;
+
+	int64_t flux_linkage_units = ((int64_t)motor_flux_observer_cfg->flux_linkage_uwb * MOTOR_FLUX_OBSERVER_PWB_PER_UWB) >>
+								 MOTOR_FLUX_OBSERVER_LENGTH_SHIFT;
+	if (flux_linkage_units == 0) return false;
+
+	/* wn * dt; the critically damped PLL uses kp = 2 wn dt, ki = (wn dt)^2 per step. */
+	int64_t wn_dt_q24 = (MOTOR_FLUX_OBSERVER_TWO_PI_Q24 *
+						 (int64_t)motor_flux_observer_cfg->pll_bandwidth_hz *
+						 (int64_t)motor_flux_observer_cfg->update_period_us) / MOTOR_FLUX_OBSERVER_US_PER_S;
+	if ((wn_dt_q24 == 0) || (wn_dt_q24 > (1LL << (MOTOR_FLUX_OBSERVER_Q24_SHIFT - 2)))) return false;
+
+	motor_flux_observer_h->cfg = motor_flux_observer_cfg;
+	motor_flux_observer_h->motor_h = motor_flux_observer_cfg->motor_h;
+	motor_flux_observer_h->flux_linkage_sq = flux_linkage_units * flux_linkage_units;
+	motor_flux_observer_h->flux_linkage_sq_recip_q46 = (1LL << 46) / motor_flux_observer_h->flux_linkage_sq;
+	motor_flux_observer_h->flux_gain_q15 = (int32_t)flux_gain_q15;
+	motor_flux_observer_h->pll_kp_q24 = (int32_t)(2LL * wn_dt_q24);
+	motor_flux_observer_h->pll_ki_q24 = (int32_t)((wn_dt_q24 * wn_dt_q24) >> MOTOR_FLUX_OBSERVER_Q24_SHIFT);
+	motor_flux_observer_h->speed_mrpm_per_step_q32 =
+			MOTOR_FLUX_OBSERVER_MRPM_PER_RPS_US /
+			((int64_t)motor_flux_observer_cfg->update_period_us *
+			 (int64_t)motor_flux_observer_cfg->motor_h->limits.pole_pairs);
+	motor_flux_observer_h->is_initialized = true;
+
+	return motor_flux_observer_reset(motor_flux_observer_h, 0u);
+}
+
+bool motor_flux_observer_reset(motor_flux_observer_handle_t *motor_flux_observer_h,
+							   uint16_t electrical_angle_u16)
+{
+	if ((motor_flux_observer_h == NULL) || (motor_flux_observer_h->cfg == NULL)) return false;
+	if (motor_flux_observer_h->is_initialized == false) return false;
+
+	/* Start on the magnet flux of the known angle; the current term is added back by eta = x - L i. */
+	const motor_current_state_t *current = &motor_flux_observer_h->motor_h->current;
+	const int64_t flux_linkage_pwb = (int64_t)motor_flux_observer_h->cfg->flux_linkage_uwb * MOTOR_FLUX_OBSERVER_PWB_PER_UWB;
+	const int64_t inductance_pwb_per_ma = (int64_t)motor_flux_observer_h->cfg->phase_inductance_uh * MOTOR_FLUX_OBSERVER_PWB_PER_NWB;
+	motor_sincos_q15_t sincos_theta = motor_sincos_get_q15(electrical_angle_u16);
+
+	motor_flux_observer_h->flux_alpha_pwb = ((flux_linkage_pwb * sincos_theta.sin_q15) / MOTOR_SINCOS_Q15_MAX) +
+											(inductance_pwb_per_ma * current->alpha_ma);
+	motor_flux_observer_h->flux_beta_pwb = ((flux_linkage_pwb * sincos_theta.cos_q15) / MOTOR_SINCOS_Q15_MAX) +
+										   (inductance_pwb_per_ma * current->beta_ma);
+	motor_flux_observer_h->voltage_alpha_uv = 0;
+	motor_flux_observer_h->voltage_beta_uv = 0;
+	motor_flux_observer_h->pll_angle_u32 = (uint32_t)electrical_angle_u16 << 16;
+	motor_flux_observer_h->pll_speed_per_step = 0;
+	/* Not locked until the filtered PLL error has settled. */
+	motor_flux_observer_h->pll_error_filtered_q8 = (uint32_t)UINT16_MAX << 8;
+
+	motor_flux_observer_state_t *state = &motor_flux_observer_h->motor_h->flux_observer;
+	state->electrical_angle_u16 = electrical_angle_u16;
+	state->mechanical_speed_mrpm = 0;
+	state->sensor_divergence_counts = 0;
+	state->is_valid = false;
+
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_flux_observer_set_voltage(motor_flux_observer_handle_t *motor_flux_observer_h,
+									 int32_t ud_permyriad,
+									 int32_t uq_permyriad,
+									 uint16_t applied_electrical_angle_u16)
+{
+	if ((motor_flux_observer_h == NULL) || (motor_flux_observer_h->cfg == NULL)) return false;
+	if (motor_flux_observer_h->is_initialized == false) return false;
+
+	const motor_flux_observer_cfg_t *cfg = motor_flux_observer_h->cfg;
+	motor_sincos_q15_t sincos_theta = motor_sincos_get_q15(applied_electrical_angle_u16);
+	int32_t uq_signed_permyriad = uq_permyriad * (int32_t)cfg->phase_sequence_sign;
+
+	/* Inverse Park of motor_foc_voltage (alpha = ud sin + uq cos, beta = ud cos - uq sin), permyriad x 2^15. */
+	int64_t alpha_scaled = ((int64_t)ud_permyriad * sincos_theta.sin_q15) + ((int64_t)uq_signed_permyriad * sincos_theta.cos_q15);
+	int64_t beta_scaled = ((int64_t)ud_permyriad * sincos_theta.cos_q15) - ((int64_t)uq_signed_permyriad * sincos_theta.sin_q15);
+	const int64_t uv_per_permyriad_q16 = (int64_t)cfg->voltage_mv_per_permyriad_q16 * 1000LL;
+
+	motor_flux_observer_h->voltage_alpha_uv = (int32_t)((alpha_scaled * uv_per_permyriad_q16) >> 31);
+	motor_flux_observer_h->voltage_beta_uv = (int32_t)((beta_scaled * uv_per_permyriad_q16) >> 31);
+
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+bool motor_flux_observer_update(motor_flux_observer_handle_t *motor_flux_observer_h)
+{
+	if ((motor_flux_observer_h == NULL) || (motor_flux_observer_h->cfg == NULL)) return false;
+	if (motor_flux_observer_h->is_initialized == false) return false;
+
+	const motor_flux_observer_cfg_t *cfg = motor_flux_observer_h->cfg;
+	motor_handle_t *motor_h = motor_flux_observer_h->motor_h;
+	const int32_t alpha_ma = motor_h->current.alpha_ma;
+	const int32_t beta_ma = motor_h->current.beta_ma;
+	const int64_t inductance_pwb_per_ma = (int64_t)cfg->phase_inductance_uh * MOTOR_FLUX_OBSERVER_PWB_PER_NWB;
+
+	/* Rotor flux eta = x - L i of the state before this step. */
+	int64_t eta_alpha_pwb = motor_flux_observer_h->flux_alpha_pwb - (inductance_pwb_per_ma * alpha_ma);
+	int64_t eta_beta_pwb = motor_flux_observer_h->flux_beta_pwb - (inductance_pwb_per_ma * beta_ma);
+
+	/* Relative length error (lambda^2 - |eta|^2) / lambda^2 in Q15, clamped to [-2, 1]. */
+	int64_t eta_alpha_units = eta_alpha_pwb >> MOTOR_FLUX_OBSERVER_LENGTH_SHIFT;
+	int64_t eta_beta_units = eta_beta_pwb >> MOTOR_FLUX_OBSERVER_LENGTH_SHIFT;
+	int64_t length_error = motor_flux_observer_h->flux_linkage_sq -
+						   ((eta_alpha_units * eta_alpha_units) + (eta_beta_units * eta_beta_units));
+	int64_t length_error_q15 = (length_error * motor_flux_observer_h->flux_linkage_sq_recip_q46) >> 31;
+	if (length_error_q15 > MOTOR_FLUX_OBSERVER_Q15_ONE) length_error_q15 = MOTOR_FLUX_OBSERVER_Q15_ONE;
+	if (length_error_q15 < -2 * MOTOR_FLUX_OBSERVER_Q15_ONE) length_error_q15 = -2 * MOTOR_FLUX_OBSERVER_Q15_ONE;
+
+	/* x += (v - R i) dt + k dt * error * eta. */
+	const int64_t gain_error_q30 = length_error_q15 * (int64_t)motor_flux_observer_h->flux_gain_q15;
+	int64_t emf_alpha_uv = (int64_t)motor_flux_observer_h->voltage_alpha_uv - ((int64_t)cfg->phase_resistance_mohm * alpha_ma);
+	int64_t emf_beta_uv = (int64_t)motor_flux_observer_h->voltage_beta_uv - ((int64_t)cfg->phase_resistance_mohm * beta_ma);
+
+	motor_flux_observer_h->flux_alpha_pwb += (emf_alpha_uv * (int64_t)cfg->update_period_us) +
+											 (((eta_alpha_pwb >> 15) * gain_error_q30) >> 15);
+	motor_flux_observer_h->flux_beta_pwb += (emf_beta_uv * (int64_t)cfg->update_period_us) +
+											(((eta_beta_pwb >> 15) * gain_error_q30) >> 15);
+
+	/* Angle of the new rotor flux. */
+	eta_alpha_pwb = motor_flux_observer_h->flux_alpha_pwb - (inductance_pwb_per_ma * alpha_ma);
+	eta_beta_pwb = motor_flux_observer_h->flux_beta_pwb - (inductance_pwb_per_ma * beta_ma);
+	uint32_t flux_angle_q20 = motor_flux_observer_angle_q20((int32_t)(eta_alpha_pwb >> MOTOR_FLUX_OBSERVER_CORDIC_SHIFT),
+															(int32_t)(eta_beta_pwb >> MOTOR_FLUX_OBSERVER_CORDIC_SHIFT));
+
+	/* Type-2 PLL on the flux angle (2^32 per turn). */
+	int32_t pll_error = (int32_t)((flux_angle_q20 << 12) - motor_flux_observer_h->pll_angle_u32);
+	motor_flux_observer_h->pll_speed_per_step +=
+			(int32_t)(((int64_t)pll_error * motor_flux_observer_h->pll_ki_q24) >> MOTOR_FLUX_OBSERVER_Q24_SHIFT);
+	motor_flux_observer_h->pll_angle_u32 +=
+			(uint32_t)(motor_flux_observer_h->pll_speed_per_step +
+					   (int32_t)(((int64_t)pll_error * motor_flux_observer_h->pll_kp_q24) >> MOTOR_FLUX_OBSERVER_Q24_SHIFT));
+
+	/* |error| in counts Q8 (2^24 per turn), first-order filter. */
+	int32_t abs_error_q8 = (pll_error < 0) ? -(pll_error >> 8) : (pll_error >> 8);
+	int32_t filtered_q8 = (int32_t)motor_flux_observer_h->pll_error_filtered_q8;
+	filtered_q8 += (abs_error_q8 - filtered_q8) >> MOTOR_FLUX_OBSERVER_ERROR_FILTER_SHIFT;
+	motor_flux_observer_h->pll_error_filtered_q8 = (uint32_t)filtered_q8;
+
+	/* Publish: PLL angle, control-positive mechanical speed, divergence from the measured angle. */
+	motor_flux_observer_state_t *state = &motor_h->flux_observer;
+	int32_t speed_mrpm = (int32_t)((((int64_t)motor_flux_observer_h->pll_speed_per_step *
+									 motor_flux_observer_h->speed_mrpm_per_step_q32) + (1LL << 31)) >> 32) *
+						 (int32_t)cfg->speed_direction_sign;
+	uint32_t abs_speed_mrpm = (speed_mrpm < 0) ? (0u - (uint32_t)speed_mrpm) : (uint32_t)speed_mrpm;
+
+	state->electrical_angle_u16 = (uint16_t)(motor_flux_observer_h->pll_angle_u32 >> 16);
+	state->mechanical_speed_mrpm = speed_mrpm;
+	state->sensor_divergence_counts =
+			(int32_t)(int16_t)(uint16_t)(state->electrical_angle_u16 - motor_h->measurements.electrical_angle_u16);
+	state->is_valid = (abs_speed_mrpm >= cfg->min_speed_mrpm) &&
+					  (motor_flux_observer_h->pll_error_filtered_q8 <= ((uint32_t)cfg->max_pll_error_counts << 8));
+
+	return true;
+}
+
+MEMORY_SECTION_RAMFUNC
+uint16_t motor_flux_observer_predict_angle(const motor_flux_observer_handle_t *motor_flux_observer_h,
+										   uint32_t horizon_us)
+{
+	if ((motor_flux_observer_h == NULL) || (motor_flux_observer_h->is_initialized == false)) return 0u;
+
+	/* angle + speed per step * horizon / period. */
+	int64_t advance_u32 = ((int64_t)motor_flux_observer_h->pll_speed_per_step * (int64_t)horizon_us) /
+						  (int64_t)motor_flux_observer_h->cfg->update_period_us;
+
+	return (uint16_t)((motor_flux_observer_h->pll_angle_u32 + (uint32_t)advance_u32) >> 16);
+}
@@ -6,44 +6,240 @@
 
 #include "motor/motor_foc_voltage.h"
 #include "motor/motor_sine_3pwm.h"
+#include "motor/motor_sincos.h"
+#include "drivers/memory_section.h"
+#include "stm32f4xx.h"	/* CMSIS SIMD intrinsics (__PKHBT, __SMLAD, __SMUSDX) */
 #include <stddef.h>
 
-#define MOTOR_FOC_VOLTAGE_Q_AXIS_SHIFT_90         16384u
-#define MOTOR_FOC_VOLTAGE_Q15_MAX                 32767u
+#define MOTOR_FOC_VOLTAGE_Q15_MAX                 32767
 #define MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX           10000
-#define MOTOR_FOC_VOLTAGE_SQRT3_X10000            17321
+#define MOTOR_FOC_VOLTAGE_SQRT3_HALF_Q31          1859775393	/* round(sqrt(3) / 2 * 2^31) */
+#define MOTOR_FOC_VOLTAGE_TWO_OVER_SQRT3_Q30      1239850262	/* round(2 / sqrt(3) * 2^30) */
+#define MOTOR_FOC_VOLTAGE_TICK_SCALE_SHIFT        40u
+#define MOTOR_FOC_VOLTAGE_INV_Q15_MAX_F32         (1.0f / 32767.0f)
+#define MOTOR_FOC_VOLTAGE_SQRT3_HALF_F32          0.866025404f
+#define MOTOR_FOC_VOLTAGE_TWO_OVER_SQRT3_F32      1.154700538f
 
+#if (MOTOR_FOC_VOLTAGE_KERNEL == MOTOR_KERNEL_FIXED)
 /**
- * @brief Divide one signed value with nearest-integer rounding.
+ * @brief Clamp one signed value to one symmetric limit.
+ *
+ * @param value Signed value.
+ * @param limit Positive magnitude limit.
+ * @return Clamped signed value.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_foc_voltage_clamp_signed(int32_t value, int32_t limit)
+{
+	if (value > limit) return limit;
+	if (value < -limit) return -limit;
+	return value;
+}
+
+/**
+ * @brief Convert one scaled phase command into one centered duty in timer ticks.
+ *
+ * ticks = floor((arr * 2^39 + phase_scaled * duty_tick_scale) / 2^40), i.e.
+ * arr * (1/2 + phase_permyriad / 20000) without a runtime division.
+ *
+ * @param motor_foc_voltage_h Pointer to FOC voltage handle.
+ * @param phase_scaled Phase command in permyriad x 32767 units.
+ * @return Duty in timer ticks (0..arr).
+ */
+MEMORY_SECTION_RAMFUNC
+static uint16_t motor_foc_voltage_phase_to_ticks(const motor_foc_voltage_handle_t *motor_foc_voltage_h,
+												 int32_t phase_scaled)
+{
+	int64_t ticks_scaled = ((int64_t)motor_foc_voltage_h->duty_arr << (MOTOR_FOC_VOLTAGE_TICK_SCALE_SHIFT - 1u)) +
+						   ((int64_t)phase_scaled * (int64_t)motor_foc_voltage_h->duty_tick_scale);
+	int32_t ticks = (int32_t)(ticks_scaled >> MOTOR_FOC_VOLTAGE_TICK_SCALE_SHIFT);
+
+	if (ticks < 0) return 0u;
+	if (ticks > (int32_t)motor_foc_voltage_h->duty_arr) return motor_foc_voltage_h->duty_arr;
+	return (uint16_t)ticks;
+}
+#endif
+
+/**
+ * @brief Feed the dead-time compensation with the polarity source of its configuration.
  *
- * @param num Signed numerator.
- * @param den Positive denominator.
- * @return Rounded signed quotient.
+ * COMMAND uses the phase commands before the zero-sequence offset (the
+ * phase current follows the line-to-neutral voltage).
+ *
+ * @param motor_foc_voltage_h Pointer to FOC voltage handle.
+ * @param phase_a_permyriad Phase A command in permyriad.
+ * @param phase_b_permyriad Phase B command in permyriad.
+ * @param phase_c_permyriad Phase C command in permyriad.
  */
-static int32_t motor_foc_voltage_div_round_signed(int64_t num, int32_t den)
+MEMORY_SECTION_RAMFUNC
+static void motor_foc_voltage_update_dead_time_polarity(motor_foc_voltage_handle_t *motor_foc_voltage_h,
+														int32_t phase_a_permyriad,
+														int32_t phase_b_permyriad,
+														int32_t phase_c_permyriad)
 {
-	if (num >= 0)
+	motor_3pwm_dead_time_comp_t dead_time_comp = motor_foc_voltage_h->motor_3pwm_h->cfg->dead_time_comp;
+
+	if (dead_time_comp == MOTOR_3PWM_DEAD_TIME_COMP_CURRENT)
 	{
-		return (int32_t)((num + (den / 2)) / den);
+		const motor_current_state_t *current = &motor_foc_voltage_h->motor_h->current;
+		(void)motor_3pwm_set_dead_time_polarity(motor_foc_voltage_h->motor_3pwm_h,
+												current->phase_a_ma,
+												current->phase_b_ma,
+												current->phase_c_ma);
+	}
+	else if (dead_time_comp == MOTOR_3PWM_DEAD_TIME_COMP_COMMAND)
+	{
+		(void)motor_3pwm_set_dead_time_polarity(motor_foc_voltage_h->motor_3pwm_h,
+												phase_a_permyriad,
+												phase_b_permyriad,
+												phase_c_permyriad);
 	}
-
-	return (int32_t)((num - (den / 2)) / den);
 }
 
+#if (MOTOR_FOC_VOLTAGE_KERNEL == MOTOR_KERNEL_FLOAT32)
 /**
- * @brief Clamp one signed value to one symmetric limit.
+ * @brief Clamp one float value to one symmetric limit.
  *
- * @param value Signed value.
+ * @param value Value.
  * @param limit Positive magnitude limit.
- * @return Clamped signed value.
+ * @return Clamped value.
  */
-static int32_t motor_foc_voltage_clamp_signed(int32_t value, int32_t limit)
+MEMORY_SECTION_RAMFUNC
+static float motor_foc_voltage_clamp_signed_f32(float value, float limit)
 {
 	if (value > limit) return limit;
 	if (value < -limit) return -limit;
 	return value;
 }
 
+/**
+ * @brief Convert one phase command into one centered duty in timer ticks (float kernel).
+ *
+ * @param motor_foc_voltage_h Pointer to FOC voltage handle.
+ * @param phase_permyriad Phase command in permyriad.
+ * @return Duty in timer ticks (0..arr), truncated like the fixed kernel.
+ */
+MEMORY_SECTION_RAMFUNC
+static uint16_t motor_foc_voltage_phase_to_ticks_f32(const motor_foc_voltage_handle_t *motor_foc_voltage_h,
+													 float phase_permyriad)
+{
+	float ticks = motor_foc_voltage_h->duty_center_ticks_f32 +
+				  (phase_permyriad * motor_foc_voltage_h->duty_ticks_per_permyriad_f32);
+
+	if (ticks <= 0.0f) return 0u;
+	if (ticks >= (float)motor_foc_voltage_h->duty_arr) return motor_foc_voltage_h->duty_arr;
+	return (uint16_t)ticks;
+}
+
+/**
+ * @brief Shift three phase commands by the zero-sequence offset of one modulation (float kernel).
+ *
+ * Same offsets as motor_3pwm_apply_zero_sequence().
+ *
+ * @param modulation SVPWM or DPWM.
+ * @param rail Phase command limit.
+ * @param phase_a Phase A command, shifted in place.
+ * @param phase_b Phase B command, shifted in place.
+ * @param phase_c Phase C command, shifted in place.
+ */
+MEMORY_SECTION_RAMFUNC
+static void motor_foc_voltage_apply_zero_sequence_f32(motor_3pwm_modulation_t modulation,
+													  float rail,
+													  float *phase_a,
+													  float *phase_b,
+													  float *phase_c)
+{
+	float max_phase = *phase_a;
+	float min_phase = *phase_a;
+	if (*phase_b > max_phase) max_phase = *phase_b;
+	if (*phase_b < min_phase) min_phase = *phase_b;
+	if (*phase_c > max_phase) max_phase = *phase_c;
+	if (*phase_c < min_phase) min_phase = *phase_c;
+
+	float offset = 0.0f;
+	if (modulation == MOTOR_3PWM_MODULATION_SVPWM)
+	{
+		offset = -0.5f * (max_phase + min_phase);
+	}
+	else if (modulation == MOTOR_3PWM_MODULATION_DPWM)
+	{
+		offset = ((max_phase + min_phase) >= 0.0f) ? (rail - max_phase) : (-rail - min_phase);
+	}
+
+	*phase_a += offset;
+	*phase_b += offset;
+	*phase_c += offset;
+}
+
+/**
+ * @brief Inverse Park / Clarke, zero sequence and CCR ticks in single-precision float.
+ *
+ * @param motor_foc_voltage_h Pointer to FOC voltage handle.
+ * @param ud_permyriad D-axis voltage request in permyriad units.
+ * @param uq_signed_permyriad Q-axis voltage request with the phase-sequence sign applied.
+ * @param sincos_theta Sine/cosine of the applied electrical angle.
+ * @param duty_a_ticks Output phase A duty in timer ticks.
+ * @param duty_b_ticks Output phase B duty in timer ticks.
+ * @param duty_c_ticks Output phase C duty in timer ticks.
+ */
+MEMORY_SECTION_RAMFUNC
+static void motor_foc_voltage_synthesize_f32(motor_foc_voltage_handle_t *motor_foc_voltage_h,
+											 int32_t ud_permyriad,
+											 int32_t uq_signed_permyriad,
+											 motor_sincos_q15_t sincos_theta,
+											 uint16_t *duty_a_ticks,
+											 uint16_t *duty_b_ticks,
+											 uint16_t *duty_c_ticks)
+{
+	const float sin_theta = (float)sincos_theta.sin_q15 * MOTOR_FOC_VOLTAGE_INV_Q15_MAX_F32;
+	const float cos_theta = (float)sincos_theta.cos_q15 * MOTOR_FOC_VOLTAGE_INV_Q15_MAX_F32;
+	const float ud = (float)ud_permyriad;
+	const float uq = (float)uq_signed_permyriad;
+	const float phase_limit = (float)motor_foc_voltage_h->motor_h->limits.max_amplitude_permyriad;
+	motor_3pwm_modulation_t modulation = motor_foc_voltage_h->motor_3pwm_h->cfg->modulation;
+
+	/* Inverse Park in project basis (alpha=sin-axis, beta=cos-axis), as in the fixed kernel. */
+	float alpha = (ud * sin_theta) + (uq * cos_theta);
+	float beta = (ud * cos_theta) - (uq * sin_theta);
+	float phase_a = 0.0f;
+	float phase_b = 0.0f;
+	float phase_c = 0.0f;
+
+	if (modulation == MOTOR_3PWM_MODULATION_SINE)
+	{
+		float beta_sqrt3_half = beta * MOTOR_FOC_VOLTAGE_SQRT3_HALF_F32;
+		phase_a = alpha;
+		phase_b = beta_sqrt3_half - (0.5f * alpha);
+		phase_c = -beta_sqrt3_half - (0.5f * alpha);
+		motor_foc_voltage_update_dead_time_polarity(motor_foc_voltage_h,
+													(int32_t)phase_a,
+													(int32_t)phase_b,
+													(int32_t)phase_c);
+	}
+	else
+	{
+		/* 10000 permyriad maps to the linear limit; beta * 2/sqrt(3) * sqrt(3)/2 is plain beta. */
+		float alpha_svm = alpha * MOTOR_FOC_VOLTAGE_TWO_OVER_SQRT3_F32;
+		phase_a = alpha_svm;
+		phase_b = beta - (0.5f * alpha_svm);
+		phase_c = -beta - (0.5f * alpha_svm);
+		/* Polarity from the phase commands before the common-mode offset shifts them. */
+		motor_foc_voltage_update_dead_time_polarity(motor_foc_voltage_h,
+													(int32_t)phase_a,
+													(int32_t)phase_b,
+													(int32_t)phase_c);
+		motor_foc_voltage_apply_zero_sequence_f32(modulation, phase_limit, &phase_a, &phase_b, &phase_c);
+	}
+
+	*duty_a_ticks = motor_foc_voltage_phase_to_ticks_f32(motor_foc_voltage_h,
+														 motor_foc_voltage_clamp_signed_f32(phase_a, phase_limit));
+	*duty_b_ticks = motor_foc_voltage_phase_to_ticks_f32(motor_foc_voltage_h,
+														 motor_foc_voltage_clamp_signed_f32(phase_b, phase_limit));
+	*duty_c_ticks = motor_foc_voltage_phase_to_ticks_f32(motor_foc_voltage_h,
+														 motor_foc_voltage_clamp_signed_f32(phase_c, phase_limit));
+}
+#endif
+
 bool motor_foc_voltage_init(motor_foc_voltage_handle_t *motor_foc_voltage_h,
 							const motor_foc_voltage_cfg_t *motor_foc_voltage_cfg)
 {
@@ -58,11 +254,26 @@ bool motor_foc_voltage_init(motor_foc_voltage_handle_t *motor_foc_voltage_h,
 	motor_foc_voltage_h->cfg = motor_foc_voltage_cfg;
 	motor_foc_voltage_h->motor_h = motor_foc_voltage_cfg->motor_h;
 	motor_foc_voltage_h->motor_3pwm_h = motor_foc_voltage_cfg->motor_3pwm_h;
+
+	/* Precompute the ARR scale once: duty_tick_scale = round(arr * 2^40 / (2 * 10000 * 32767)). */
+	const motor_3pwm_cfg_t *motor_3pwm_cfg = motor_foc_voltage_cfg->motor_3pwm_h->cfg;
+	if ((motor_3pwm_cfg == NULL) || (motor_3pwm_cfg->pwm_h == NULL)) return false;
+	if (motor_3pwm_cfg->pwm_h->arr == 0u) return false;
+	int64_t tick_scale_den = 2 * (int64_t)MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX * (int64_t)MOTOR_FOC_VOLTAGE_Q15_MAX;
+	motor_foc_voltage_h->duty_arr = motor_3pwm_cfg->pwm_h->arr;
+	motor_foc_voltage_h->duty_tick_scale = (int32_t)((((int64_t)motor_foc_voltage_h->duty_arr << MOTOR_FOC_VOLTAGE_TICK_SCALE_SHIFT) +
+													  (tick_scale_den / 2)) / tick_scale_den);
+#if (MOTOR_FOC_VOLTAGE_KERNEL == MOTOR_KERNEL_FLOAT32)
+	motor_foc_voltage_h->duty_center_ticks_f32 = 0.5f * (float)motor_foc_voltage_h->duty_arr;
+	motor_foc_voltage_h->duty_ticks_per_permyriad_f32 =
+			(float)motor_foc_voltage_h->duty_arr / (2.0f * (float)MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
+#endif
 	motor_foc_voltage_h->is_initialized = true;
 
 	return true;
 }
 
+MEMORY_SECTION_RAMFUNC
 bool motor_foc_voltage_apply_dq(motor_foc_voltage_handle_t *motor_foc_voltage_h,
 								int16_t ud_permyriad,
 								int16_t uq_permyriad)
@@ -91,62 +302,97 @@ bool motor_foc_voltage_apply_dq(motor_foc_voltage_handle_t *motor_foc_voltage_h,
 		return false;
 	}
 
-	/* Read electrical angle sine/cosine basis for direct inverse Park conversion. */
-	uint16_t electrical_angle_u16 = motor_h->measurements.electrical_angle_u16;
-	int32_t sin_theta_q15 =
-			(int32_t)motor_sine_3pwm_get_phase_q15(electrical_angle_u16);
-	int32_t cos_theta_q15 =
-			(int32_t)motor_sine_3pwm_get_phase_q15((uint16_t)(electrical_angle_u16 + MOTOR_FOC_VOLTAGE_Q_AXIS_SHIFT_90));
+	/* Read electrical angle sine/cosine basis for direct inverse Park conversion (one combined lookup). */
+	/* The phase advance (0 unless the lead-angle module runs) turns the vector ahead of the rotor. */
+	motor_sincos_q15_t sincos_theta = motor_sincos_get_q15((uint16_t)((int32_t)motor_h->measurements.electrical_angle_u16 +
+																	  motor_h->lead_angle.advance_counts));
 
 	/* Keep q-axis handedness configurable for phase sequence/wiring differences. */
 	int32_t uq_signed_permyriad = (int32_t)uq_permyriad *
 								  (int32_t)motor_foc_voltage_h->cfg->phase_sequence_sign;
-	int32_t ud_signed_permyriad = (int32_t)ud_permyriad;
+
+	uint16_t duty_a_ticks = 0u;
+	uint16_t duty_b_ticks = 0u;
+	uint16_t duty_c_ticks = 0u;
+
+#if (MOTOR_FOC_VOLTAGE_KERNEL == MOTOR_KERNEL_FLOAT32)
+	motor_foc_voltage_synthesize_f32(motor_foc_voltage_h,
+									 (int32_t)ud_permyriad,
+									 uq_signed_permyriad,
+									 sincos_theta,
+									 &duty_a_ticks,
+									 &duty_b_ticks,
+									 &duty_c_ticks);
+#else
+	/* Pack (Ud, Uq) and (sin, cos) as signed halfword pairs for the dual 16x16 MAC instructions. */
+	uint32_t udq_packed = __PKHBT((uint32_t)(uint16_t)ud_permyriad, (uint32_t)(uint16_t)uq_signed_permyriad, 16);
+	uint32_t sincos_packed = __PKHBT((uint32_t)(uint16_t)sincos_theta.sin_q15, (uint32_t)(uint16_t)sincos_theta.cos_q15, 16);
 
 	/* Inverse Park in project basis (alpha=sin-axis, beta=cos-axis) to match existing sine modulation convention. */
 	/* This keeps Ud=0 q-only runtime behavior consistent with the previously verified rotation direction. */
-	int32_t alpha_permyriad = motor_foc_voltage_div_round_signed(
-			((int64_t)ud_signed_permyriad * (int64_t)sin_theta_q15) +
-			((int64_t)uq_signed_permyriad * (int64_t)cos_theta_q15),
-			MOTOR_FOC_VOLTAGE_Q15_MAX);
-	int32_t beta_permyriad = motor_foc_voltage_div_round_signed(
-			((int64_t)ud_signed_permyriad * (int64_t)cos_theta_q15) -
-			((int64_t)uq_signed_permyriad * (int64_t)sin_theta_q15),
-			MOTOR_FOC_VOLTAGE_Q15_MAX);
-
-	/* Inverse Clarke: convert (alpha,beta) into three phase commands in permyriad units. */
-	int32_t phase_a_permyriad = alpha_permyriad;
-	int32_t phase_b_permyriad = motor_foc_voltage_div_round_signed(
-			(-(int64_t)alpha_permyriad * MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX) +
-			((int64_t)beta_permyriad * MOTOR_FOC_VOLTAGE_SQRT3_X10000),
-			2 * MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
-	int32_t phase_c_permyriad = motor_foc_voltage_div_round_signed(
-			(-(int64_t)alpha_permyriad * MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX) -
-			((int64_t)beta_permyriad * MOTOR_FOC_VOLTAGE_SQRT3_X10000),
-			2 * MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
+	/* alpha/beta stay scaled by 32767 (permyriad x Q15); no rounding division at this point. */
+	int32_t alpha_scaled = (int32_t)__SMLAD(udq_packed, sincos_packed, 0u);	/* ud*sin + uq*cos */
+	int32_t beta_scaled = (int32_t)__SMUSDX(udq_packed, sincos_packed);		/* ud*cos - uq*sin */
+
+	int32_t phase_a_scaled = 0;
+	int32_t phase_b_scaled = 0;
+	int32_t phase_c_scaled = 0;
+	int32_t phase_limit_scaled = (int32_t)motor_h->limits.max_amplitude_permyriad * MOTOR_FOC_VOLTAGE_Q15_MAX;
+	motor_3pwm_modulation_t modulation = motor_foc_voltage_h->motor_3pwm_h->cfg->modulation;
+
+	if (modulation == MOTOR_3PWM_MODULATION_SINE)
+	{
+		/* Inverse Clarke: a = alpha, b/c = -alpha/2 +/- beta*sqrt(3)/2 (one 32x32->64 multiply). */
+		int32_t half_alpha_scaled = alpha_scaled >> 1;
+		int32_t beta_sqrt3_half_scaled = (int32_t)(((int64_t)beta_scaled * MOTOR_FOC_VOLTAGE_SQRT3_HALF_Q31) >> 31);
+		phase_a_scaled = alpha_scaled;
+		phase_b_scaled = beta_sqrt3_half_scaled - half_alpha_scaled;
+		phase_c_scaled = -beta_sqrt3_half_scaled - half_alpha_scaled;
+		/* >> 15 converts the permyriad x 32767 scale to permyriad for the band check. */
+		motor_foc_voltage_update_dead_time_polarity(motor_foc_voltage_h,
+													phase_a_scaled >> 15,
+													phase_b_scaled >> 15,
+													phase_c_scaled >> 15);
+	}
+	else
+	{
+		/* Zero-sequence modes: 10000 permyriad maps to the linear limit (2/sqrt(3) of the sine peak). */
+		/* Scaling alpha/beta by 2/sqrt(3) first leaves beta*sqrt(3)/2 as plain beta. */
+		int32_t alpha_svm_scaled = (int32_t)(((int64_t)alpha_scaled * MOTOR_FOC_VOLTAGE_TWO_OVER_SQRT3_Q30) >> 30);
+		int32_t half_alpha_svm_scaled = alpha_svm_scaled >> 1;
+		phase_a_scaled = alpha_svm_scaled;
+		phase_b_scaled = beta_scaled - half_alpha_svm_scaled;
+		phase_c_scaled = -beta_scaled - half_alpha_svm_scaled;
+		/* Polarity from the phase commands before the common-mode offset shifts them. */
+		motor_foc_voltage_update_dead_time_polarity(motor_foc_voltage_h,
+													phase_a_scaled >> 15,
+													phase_b_scaled >> 15,
+													phase_c_scaled >> 15);
+
+		/* Midpoint centring / rail clamping keeps line-to-line voltages, the duty limit is the rail. */
+		(void)motor_3pwm_apply_zero_sequence(modulation,
+											 phase_limit_scaled,
+											 &phase_a_scaled,
+											 &phase_b_scaled,
+											 &phase_c_scaled);
+	}
 
 	/* Clamp phase commands to motor amplitude limit before duty synthesis. */
-	int32_t phase_limit = (int32_t)motor_h->limits.max_amplitude_permyriad;
-	phase_a_permyriad = motor_foc_voltage_clamp_signed(phase_a_permyriad, phase_limit);
-	phase_b_permyriad = motor_foc_voltage_clamp_signed(phase_b_permyriad, phase_limit);
-	phase_c_permyriad = motor_foc_voltage_clamp_signed(phase_c_permyriad, phase_limit);
-
-	/* Convert permyriad phase commands into Q15-like normalized phase commands. */
-	int16_t phase_a_q15 = (int16_t)motor_foc_voltage_div_round_signed(
-			(int64_t)phase_a_permyriad * MOTOR_FOC_VOLTAGE_Q15_MAX,
-			MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
-	int16_t phase_b_q15 = (int16_t)motor_foc_voltage_div_round_signed(
-			(int64_t)phase_b_permyriad * MOTOR_FOC_VOLTAGE_Q15_MAX,
-			MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
-	int16_t phase_c_q15 = (int16_t)motor_foc_voltage_div_round_signed(
-			(int64_t)phase_c_permyriad * MOTOR_FOC_VOLTAGE_Q15_MAX,
-			MOTOR_FOC_VOLTAGE_PERMYRIAD_MAX);
-
-	/* Apply direct phase commands without the previous sqrt/angle-search path. */
-	if (!motor_sine_3pwm_apply_phase_q15(motor_foc_voltage_h->motor_3pwm_h,
-										 phase_a_q15,
-										 phase_b_q15,
-										 phase_c_q15))
+	phase_a_scaled = motor_foc_voltage_clamp_signed(phase_a_scaled, phase_limit_scaled);
+	phase_b_scaled = motor_foc_voltage_clamp_signed(phase_b_scaled, phase_limit_scaled);
+	phase_c_scaled = motor_foc_voltage_clamp_signed(phase_c_scaled, phase_limit_scaled);
+
+	/* Centered duty ticks: arr/2 + phase * arr / (2 * 10000 * 32767) with the init-time ARR scale. */
+	duty_a_ticks = motor_foc_voltage_phase_to_ticks(motor_foc_voltage_h, phase_a_scaled);
+	duty_b_ticks = motor_foc_voltage_phase_to_ticks(motor_foc_voltage_h, phase_b_scaled);
+	duty_c_ticks = motor_foc_voltage_phase_to_ticks(motor_foc_voltage_h, phase_c_scaled);
+#endif
+
+	/* Write the three compare values directly, skipping the permyriad/Q15 round trips. */
+	if (!motor_3pwm_set_duty_ticks_abc(motor_foc_voltage_h->motor_3pwm_h,
+									   duty_a_ticks,
+									   duty_b_ticks,
+									   duty_c_ticks))
 	{
 		return false;
 	}
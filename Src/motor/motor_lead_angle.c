@@ -0,0 +1,328 @@
+/**
+ * @file motor_lead_angle.c
+ * @brief Speed-dependent phase advance of the voltage vector (voltage-mode FOC).
+ *
+ */
+
+#include "motor/motor_lead_angle.h"
+#include "motor/motor_sincos.h"
+#include <stddef.h>
+
+#define MOTOR_LEAD_ANGLE_QUARTER_TURN_COUNTS    16384u
+#define MOTOR_LEAD_ANGLE_ATAN_ITERATIONS        14u
+#define MOTOR_LEAD_ANGLE_Q16_SHIFT              16
+/* round(2 * pi * 2^16): rad per turn in Q16. */
+#define MOTOR_LEAD_ANGLE_TWO_PI_Q16             411775LL
+#define MOTOR_LEAD_ANGLE_MRPM_PER_TURN_PER_S    60000LL
+#define MOTOR_LEAD_ANGLE_US_PER_SECOND          1000000LL
+
+/**
+ * @brief Convert one mechanical speed into electrical angular speed.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param abs_speed_mrpm |mechanical speed| in mrpm.
+ * @return omega_e in rad/s, Q16.
+ */
+static int64_t motor_lead_angle_electrical_speed_q16(const motor_lead_angle_handle_t *motor_lead_angle_h,
+													 uint32_t abs_speed_mrpm)
+{
+	return ((int64_t)abs_speed_mrpm *
+			(int64_t)motor_lead_angle_h->motor_h->limits.pole_pairs *
+			MOTOR_LEAD_ANGLE_TWO_PI_Q16) / MOTOR_LEAD_ANGLE_MRPM_PER_TURN_PER_S;
+}
+
+/**
+ * @brief Arctangent of one non-negative ratio by bisection on the sine/cosine kernel.
+ *
+ * Runs at init and at the end of a calibration only.
+ *
+ * @param ratio_q16 Ratio in Q16 (>= 0).
+ * @return atan(ratio) in full-turn counts (0..quarter turn).
+ */
+static uint16_t motor_lead_angle_atan_counts(int64_t ratio_q16)
+{
+	uint32_t low = 0u;
+	uint32_t high = MOTOR_LEAD_ANGLE_QUARTER_TURN_COUNTS;
+
+	for (uint8_t i = 0u; i < MOTOR_LEAD_ANGLE_ATAN_ITERATIONS; i++)
+	{
+		uint32_t middle = (low + high) / 2u;
+		motor_sincos_q15_t sincos = motor_sincos_get_q15((uint16_t)middle);
+
+		/* tan(middle) < ratio <=> sin * 2^16 < ratio * cos (cos >= 0 on the quarter turn). */
+		if (((int64_t)sincos.sin_q15 << MOTOR_LEAD_ANGLE_Q16_SHIFT) < (ratio_q16 * (int64_t)sincos.cos_q15))
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return (uint16_t)high;
+}
+
+/**
+ * @brief Publish one advance, signed with the rotation direction of one speed.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @param advance_counts |advance| in electrical counts.
+ * @param speed_mrpm Signed mechanical speed the advance belongs to.
+ */
+static void motor_lead_angle_publish(motor_lead_angle_handle_t *motor_lead_angle_h,
+									 uint16_t advance_counts,
+									 int32_t speed_mrpm)
+{
+	int64_t angle_speed_mrpm = (int64_t)speed_mrpm * (int64_t)motor_lead_angle_h->cfg->speed_direction_sign;
+
+	motor_lead_angle_h->motor_h->lead_angle.advance_counts =
+			(angle_speed_mrpm >= 0) ? (int32_t)advance_counts : -(int32_t)advance_counts;
+}
+
+/**
+ * @brief Set the advance of one calibration step.
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ */
+static void motor_lead_angle_calibration_apply_step(motor_lead_angle_handle_t *motor_lead_angle_h)
+{
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+
+	motor_lead_angle_h->calibration_state = MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING;
+	motor_lead_angle_h->calibration_elapsed_ms = 0u;
+	motor_lead_angle_publish(motor_lead_angle_h,
+							 (uint16_t)(motor_lead_angle_h->calibration_step_index * cfg->calibration_step_counts),
+							 cfg->calibration_speed_mrpm);
+}
+
+/**
+ * @brief Convert the best advance into tau at the calibration speed and install the model table.
+ *
+ * tau = tan(advance) / omega_e; no advance gives tau = 0 (table of zeros).
+ *
+ * @param motor_lead_angle_h Pointer to lead-angle handle.
+ * @return true if the table was refilled, false otherwise.
+ */
+static bool motor_lead_angle_calibration_finish(motor_lead_angle_handle_t *motor_lead_angle_h)
+{
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+	uint16_t best_advance_counts =
+			(uint16_t)(motor_lead_angle_h->calibration_best_step_index * cfg->calibration_step_counts);
+	uint32_t abs_speed_mrpm = (cfg->calibration_speed_mrpm >= 0) ?
+							  (uint32_t)cfg->calibration_speed_mrpm :
+							  (uint32_t)(-(int64_t)cfg->calibration_speed_mrpm);
+	int64_t electrical_speed_q16 = motor_lead_angle_electrical_speed_q16(motor_lead_angle_h, abs_speed_mrpm);
+	motor_sincos_q15_t sincos = motor_sincos_get_q15(best_advance_counts);
+	uint32_t time_constant_us = 0u;
+
+	/* tau_us = sin * 1e6 * 2^16 / (cos * omega_e_q16), rounded. */
+	if ((best_advance_counts != 0u) && (electrical_speed_q16 > 0) && (sincos.cos_q15 > 0))
+	{
+		int64_t numerator = ((int64_t)sincos.sin_q15 * MOTOR_LEAD_ANGLE_US_PER_SECOND) << MOTOR_LEAD_ANGLE_Q16_SHIFT;
+		int64_t denominator = (int64_t)sincos.cos_q15 * electrical_speed_q16;
+		time_constant_us = (uint32_t)((numerator + (denominator / 2)) / denominator);
+	}
+
+	return motor_lead_angle_set_time_constant(motor_lead_angle_h, time_constant_us);
+}
+
+bool motor_lead_angle_init(motor_lead_angle_handle_t *motor_lead_angle_h,
+						   const motor_lead_angle_cfg_t *motor_lead_angle_cfg)
+{
+	if ((motor_lead_angle_h == NULL) || (motor_lead_angle_cfg == NULL)) return false;
+	if (motor_lead_angle_cfg->motor_h == NULL) return false;
+	if (motor_lead_angle_cfg->motor_h->limits.pole_pairs == 0u) return false;
+	if ((motor_lead_angle_cfg->speed_direction_sign != 1) &&
+		(motor_lead_angle_cfg->speed_direction_sign != -1)) return false;
+	if ((motor_lead_angle_cfg->point_count < 2u) ||
+		(motor_lead_angle_cfg->point_count > MOTOR_LEAD_ANGLE_MAX_POINTS))
+	{
+		return false;
+	}
+	if (motor_lead_angle_cfg->point_spacing_mrpm == 0u) return false;
+	if (motor_lead_angle_cfg->max_advance_counts >= MOTOR_LEAD_ANGLE_QUARTER_TURN_COUNTS) return false;
+	if (motor_lead_angle_cfg->update_period_ms == 0u) return false;
+	if ((motor_lead_angle_cfg->mode != MOTOR_LEAD_ANGLE_MODE_TABLE) &&
+		(motor_lead_angle_cfg->mode != MOTOR_LEAD_ANGLE_MODE_MODEL))
+	{
+		return false;
+	}
+
+	motor_lead_angle_h->cfg = motor_lead_angle_cfg;
+	motor_lead_angle_h->motor_h = motor_lead_angle_cfg->motor_h;
+	motor_lead_angle_h->calibration_state = MOTOR_LEAD_ANGLE_CALIBRATION_STATE_IDLE;
+	motor_lead_angle_h->is_initialized = true;
+	motor_lead_angle_h->motor_h->lead_angle.advance_counts = 0;
+
+	if (motor_lead_angle_cfg->mode == MOTOR_LEAD_ANGLE_MODE_MODEL)
+	{
+		return motor_lead_angle_set_time_constant(motor_lead_angle_h, motor_lead_angle_cfg->electrical_time_constant_us);
+	}
+
+	/* Configured table, clamped like the model. */
+	for (uint8_t k = 0u; k < motor_lead_angle_cfg->point_count; k++)
+	{
+		uint16_t advance_counts = motor_lead_angle_cfg->table_advance_counts[k];
+		motor_lead_angle_h->advance_counts[k] = (advance_counts > motor_lead_angle_cfg->max_advance_counts) ?
+												motor_lead_angle_cfg->max_advance_counts : advance_counts;
+	}
+	motor_lead_angle_h->electrical_time_constant_us = 0u;
+
+	return true;
+}
+
+bool motor_lead_angle_update(motor_lead_angle_handle_t *motor_lead_angle_h,
+							 int32_t measured_mechanical_speed_mrpm)
+{
+	if (motor_lead_angle_h == NULL) return false;
+	if ((motor_lead_angle_h->cfg == NULL) || (motor_lead_angle_h->motor_h == NULL)) return false;
+	if (motor_lead_angle_h->is_initialized == false) return false;
+
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+	if (motor_lead_angle_h->motor_h->status.has_valid_mechanical_speed == false)
+	{
+		measured_mechanical_speed_mrpm = 0;
+	}
+	uint32_t abs_speed_mrpm = (measured_mechanical_speed_mrpm >= 0) ?
+							  (uint32_t)measured_mechanical_speed_mrpm :
+							  (uint32_t)(-(int64_t)measured_mechanical_speed_mrpm);
+
+	/* Linear interpolation between the two neighbouring points, last point held above the table. */
+	uint32_t index = abs_speed_mrpm / cfg->point_spacing_mrpm;
+	uint16_t advance_counts = motor_lead_angle_h->advance_counts[cfg->point_count - 1u];
+	if (index < (uint32_t)(cfg->point_count - 1u))
+	{
+		int32_t lower_counts = (int32_t)motor_lead_angle_h->advance_counts[index];
+		int32_t upper_counts = (int32_t)motor_lead_angle_h->advance_counts[index + 1u];
+		uint32_t remainder_mrpm = abs_speed_mrpm - (index * cfg->point_spacing_mrpm);
+		advance_counts = (uint16_t)(lower_counts +
+									(int32_t)(((int64_t)(upper_counts - lower_counts) * (int64_t)remainder_mrpm) /
+											  (int64_t)cfg->point_spacing_mrpm));
+	}
+
+	motor_lead_angle_publish(motor_lead_angle_h, advance_counts, measured_mechanical_speed_mrpm);
+
+	return true;
+}
+
+bool motor_lead_angle_set_time_constant(motor_lead_angle_handle_t *motor_lead_angle_h,
+										uint32_t electrical_time_constant_us)
+{
+	if (motor_lead_angle_h == NULL) return false;
+	if ((motor_lead_angle_h->cfg == NULL) || (motor_lead_angle_h->motor_h == NULL)) return false;
+	if (motor_lead_angle_h->is_initialized == false) return false;
+
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+
+	/* advance_k = atan(omega_e(k * spacing) * tau), clamped to max_advance_counts. */
+	for (uint8_t k = 0u; k < cfg->point_count; k++)
+	{
+		int64_t electrical_speed_q16 =
+				motor_lead_angle_electrical_speed_q16(motor_lead_angle_h, (uint32_t)k * cfg->point_spacing_mrpm);
+		int64_t ratio_q16 = (electrical_speed_q16 * (int64_t)electrical_time_constant_us) /
+							MOTOR_LEAD_ANGLE_US_PER_SECOND;
+		uint16_t advance_counts = motor_lead_angle_atan_counts(ratio_q16);
+
+		motor_lead_angle_h->advance_counts[k] = (advance_counts > cfg->max_advance_counts) ?
+												cfg->max_advance_counts : advance_counts;
+	}
+	motor_lead_angle_h->electrical_time_constant_us = electrical_time_constant_us;
+
+	return true;
+}
+
+bool motor_lead_angle_calibration_start(motor_lead_angle_handle_t *motor_lead_angle_h)
+{
+	if (motor_lead_angle_h == NULL) return false;
+	if ((motor_lead_angle_h->cfg == NULL) || (motor_lead_angle_h->motor_h == NULL)) return false;
+	if (motor_lead_angle_h->is_initialized == false) return false;
+
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+	if (cfg->calibration_speed_mrpm == 0) return false;
+	if ((cfg->calibration_step_count < 2u) || (cfg->calibration_step_counts == 0u)) return false;
+	if (((uint32_t)(cfg->calibration_step_count - 1u) * cfg->calibration_step_counts) > cfg->max_advance_counts)
+	{
+		return false;
+	}
+	if (cfg->calibration_average_ms == 0u) return false;
+
+	motor_lead_angle_h->calibration_step_index = 0u;
+	motor_lead_angle_h->calibration_best_step_index = 0u;
+	motor_lead_angle_h->calibration_best_mean_uq_permyriad = UINT32_MAX;
+	motor_lead_angle_h->calibration_zero_mean_uq_permyriad = 0u;
+	motor_lead_angle_calibration_apply_step(motor_lead_angle_h);
+
+	return true;
+}
+
+bool motor_lead_angle_calibration_update(motor_lead_angle_handle_t *motor_lead_angle_h,
+										 int32_t uq_command_permyriad,
+										 int32_t measured_mechanical_speed_mrpm)
+{
+	if (motor_lead_angle_h == NULL) return false;
+	if ((motor_lead_angle_h->cfg == NULL) || (motor_lead_angle_h->motor_h == NULL)) return false;
+	if (motor_lead_angle_h->is_initialized == false) return false;
+
+	const motor_lead_angle_cfg_t *cfg = motor_lead_angle_h->cfg;
+	motor_lead_angle_calibration_state_t state = motor_lead_angle_h->calibration_state;
+	if ((state != MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING) &&
+		(state != MOTOR_LEAD_ANGLE_CALIBRATION_STATE_AVERAGING))
+	{
+		return true;
+	}
+
+	motor_lead_angle_h->calibration_elapsed_ms = (uint16_t)(motor_lead_angle_h->calibration_elapsed_ms +
+															  cfg->update_period_ms);
+	if (state == MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING)
+	{
+		if (motor_lead_angle_h->calibration_elapsed_ms >= cfg->calibration_settle_ms)
+		{
+			motor_lead_angle_h->calibration_state = MOTOR_LEAD_ANGLE_CALIBRATION_STATE_AVERAGING;
+			motor_lead_angle_h->calibration_elapsed_ms = 0u;
+			motor_lead_angle_h->calibration_sample_count = 0u;
+			motor_lead_angle_h->calibration_abs_uq_sum = 0u;
+		}
+		return true;
+	}
+
+	/* Mean |Uq| compares advances only at the same speed: a step the loop cannot hold fails the run. */
+	int64_t speed_error_mrpm = (int64_t)measured_mechanical_speed_mrpm - (int64_t)cfg->calibration_speed_mrpm;
+	if ((speed_error_mrpm > (int64_t)cfg->calibration_speed_tolerance_mrpm) ||
+		(speed_error_mrpm < -(int64_t)cfg->calibration_speed_tolerance_mrpm))
+	{
+		motor_lead_angle_h->calibration_state = MOTOR_LEAD_ANGLE_CALIBRATION_STATE_FAILED;
+		motor_lead_angle_h->motor_h->lead_angle.advance_counts = 0;
+		return true;
+	}
+
+	motor_lead_angle_h->calibration_abs_uq_sum += (uint64_t)((uq_command_permyriad >= 0) ?
+															 (int64_t)uq_command_permyriad :
+															 -(int64_t)uq_command_permyriad);
+	motor_lead_angle_h->calibration_sample_count++;
+	if (motor_lead_angle_h->calibration_elapsed_ms < cfg->calibration_average_ms) return true;
+
+	uint32_t mean_uq_permyriad = (uint32_t)(motor_lead_angle_h->calibration_abs_uq_sum /
+											motor_lead_angle_h->calibration_sample_count);
+	if (motor_lead_angle_h->calibration_step_index == 0u)
+	{
+		motor_lead_angle_h->calibration_zero_mean_uq_permyriad = mean_uq_permyriad;
+	}
+	if (mean_uq_permyriad < motor_lead_angle_h->calibration_best_mean_uq_permyriad)
+	{
+		motor_lead_angle_h->calibration_best_mean_uq_permyriad = mean_uq_permyriad;
+		motor_lead_angle_h->calibration_best_step_index = motor_lead_angle_h->calibration_step_index;
+	}
+
+	motor_lead_angle_h->calibration_step_index++;
+	if (motor_lead_angle_h->calibration_step_index < cfg->calibration_step_count)
+	{
+		motor_lead_angle_calibration_apply_step(motor_lead_angle_h);
+		return true;
+	}
+
+	if (!motor_lead_angle_calibration_finish(motor_lead_angle_h)) return false;
+	motor_lead_angle_h->calibration_state = MOTOR_LEAD_ANGLE_CALIBRATION_STATE_DONE;
+
+	return motor_lead_angle_update(motor_lead_angle_h, measured_mechanical_speed_mrpm);
+}
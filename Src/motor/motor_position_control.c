@@ -0,0 +1,380 @@
+/**
+ * @file motor_position_control.c
+ * @brief Cascaded position loop on the multi-turn mechanical angle.
+ *
+ *  Notes:
+ *  - 1 mrpm for 1 us moves 1024 / 937500000 counts (65536 / (60000 x 10^6));
+ *    the reference keeps the sub-count remainder, so it does not drift
+ *    against the integrated trajectory speed.
+ *  - an S-curve or trapezoid ramp covers (v0 + v1) / 2 x T: the move
+ *    distance is two ramps plus the cruise hold, searched over the cruise
+ *    speed with the ramp times motor_trajectory plans.
+ *  - output = FF + P + I, limited to the speed limit; I is held while the
+ *    output is saturated in the direction it would grow (as the speed PI).
+ */
+
+#include "motor/motor_position_control.h"
+#include <stddef.h>
+
+#define MOTOR_POSITION_CONTROL_Q15_SCALE            32768LL
+#define MOTOR_POSITION_CONTROL_MS_PER_SECOND        1000LL
+#define MOTOR_POSITION_CONTROL_US_PER_MS            1000u
+#define MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_NUM   1024LL
+#define MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN   937500000LL
+#define MOTOR_POSITION_CONTROL_SPEED_SEARCH_STEPS   32u
+
+/**
+ * @brief Divide one signed integer and round to nearest integer.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded signed integer quotient.
+ */
+static int64_t motor_position_control_divide_round_nearest(int64_t numerator, int64_t denominator)
+{
+	if (numerator >= 0)
+	{
+		return (numerator + (denominator / 2LL)) / denominator;
+	}
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+
+/**
+ * @brief Clamp one signed value into a signed 32-bit range.
+ *
+ * @param value Value to clamp.
+ * @param min_value Lower bound.
+ * @param max_value Upper bound.
+ * @return Clamped value.
+ */
+static int32_t motor_position_control_clamp_i32(int64_t value, int32_t min_value, int32_t max_value)
+{
+	if (value < (int64_t)min_value) return min_value;
+	if (value > (int64_t)max_value) return max_value;
+
+	return (int32_t)value;
+}
+
+/**
+ * @brief Convert the integral gain into its per-update form.
+ *
+ * @param ki_per_s_q15 Integral gain in Q15 per second.
+ * @param update_period_ms Update period.
+ * @return Integral gain per update in Q15.
+ */
+static int32_t motor_position_control_discretize_ki(int32_t ki_per_s_q15, uint16_t update_period_ms)
+{
+	return motor_position_control_clamp_i32(
+			motor_position_control_divide_round_nearest((int64_t)ki_per_s_q15 * (int64_t)update_period_ms,
+														MOTOR_POSITION_CONTROL_MS_PER_SECOND),
+			0,
+			INT32_MAX);
+}
+
+/**
+ * @brief Return the distance of one trajectory ramp.
+ *
+ * @param start_speed_mrpm Speed at ramp start.
+ * @param end_speed_mrpm Speed at ramp end.
+ * @param max_acceleration_mrpm_per_s Acceleration limit.
+ * @param max_jerk_mrpm_per_s2 Jerk limit, 0 = trapezoid.
+ * @return Signed distance in counts.
+ */
+static int64_t motor_position_control_ramp_counts(int64_t start_speed_mrpm,
+												  int64_t end_speed_mrpm,
+												  uint32_t max_acceleration_mrpm_per_s,
+												  uint32_t max_jerk_mrpm_per_s2)
+{
+	int64_t step_mrpm = end_speed_mrpm - start_speed_mrpm;
+	uint64_t step_abs_mrpm = (step_mrpm >= 0) ? (uint64_t)step_mrpm : (uint64_t)(-step_mrpm);
+	uint32_t ramp_time_us = motor_trajectory_get_ramp_time_us(
+			(step_abs_mrpm > (uint64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)step_abs_mrpm,
+			max_acceleration_mrpm_per_s,
+			max_jerk_mrpm_per_s2);
+	int64_t speed_sum_mrpm = start_speed_mrpm + end_speed_mrpm;
+
+	/* (v0 + v1) / 2 x T, split into ms and us so the product stays within 64 bits. */
+	return ((speed_sum_mrpm * (int64_t)(ramp_time_us / MOTOR_POSITION_CONTROL_US_PER_MS) *
+			 (MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_NUM / 2LL)) /
+			(MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN / (int64_t)MOTOR_POSITION_CONTROL_US_PER_MS)) +
+		   ((speed_sum_mrpm * (int64_t)(ramp_time_us % MOTOR_POSITION_CONTROL_US_PER_MS) *
+			 (MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_NUM / 2LL)) /
+			MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN);
+}
+
+/**
+ * @brief Return the distance of a move without cruise hold (ramp to the cruise speed, ramp to zero).
+ *
+ * @param start_speed_mrpm Reference speed at the move start, positive towards the target.
+ * @param cruise_speed_mrpm Cruise speed, >= 0.
+ * @param max_acceleration_mrpm_per_s Acceleration limit.
+ * @param max_jerk_mrpm_per_s2 Jerk limit, 0 = trapezoid.
+ * @return Distance in counts, positive towards the target.
+ */
+static int64_t motor_position_control_move_ramp_counts(int64_t start_speed_mrpm,
+													   int64_t cruise_speed_mrpm,
+													   uint32_t max_acceleration_mrpm_per_s,
+													   uint32_t max_jerk_mrpm_per_s2)
+{
+	return motor_position_control_ramp_counts(start_speed_mrpm,
+											  cruise_speed_mrpm,
+											  max_acceleration_mrpm_per_s,
+											  max_jerk_mrpm_per_s2) +
+		   motor_position_control_ramp_counts(cruise_speed_mrpm,
+											  0,
+											  max_acceleration_mrpm_per_s,
+											  max_jerk_mrpm_per_s2);
+}
+
+bool motor_position_control_init(motor_position_control_handle_t *motor_position_control_h,
+								 const motor_position_control_cfg_t *motor_position_control_cfg)
+{
+	if ((motor_position_control_h == NULL) || (motor_position_control_cfg == NULL)) return false;
+	if (motor_position_control_cfg->motor_h == NULL) return false;
+	if (motor_position_control_cfg->update_period_ms == 0u) return false;
+	if ((motor_position_control_cfg->control_direction_sign != 1) &&
+		(motor_position_control_cfg->control_direction_sign != -1)) return false;
+	if ((motor_position_control_cfg->kp_q15 < 0) || (motor_position_control_cfg->ki_per_s_q15 < 0)) return false;
+	if (motor_position_control_cfg->max_speed_mrpm <= 0) return false;
+
+	*motor_position_control_h = (motor_position_control_handle_t){0};
+	motor_position_control_h->cfg = motor_position_control_cfg;
+	motor_position_control_h->motor_h = motor_position_control_cfg->motor_h;
+	motor_position_control_h->kp_q15 = motor_position_control_cfg->kp_q15;
+	motor_position_control_h->ki_dt_q15 = motor_position_control_discretize_ki(motor_position_control_cfg->ki_per_s_q15,
+																			   motor_position_control_cfg->update_period_ms);
+	motor_position_control_h->max_speed_mrpm = motor_position_control_cfg->max_speed_mrpm;
+	/* At least one update inside the window, rounded up to whole update periods. */
+	uint32_t settle_update_count = ((uint32_t)motor_position_control_cfg->in_position_settle_ms +
+									motor_position_control_cfg->update_period_ms - 1u) /
+								   motor_position_control_cfg->update_period_ms;
+	motor_position_control_h->settle_update_count = (settle_update_count == 0u) ? 1u : (uint16_t)settle_update_count;
+	motor_position_control_h->is_initialized = true;
+
+	return motor_position_control_reset(motor_position_control_h);
+}
+
+bool motor_position_control_reset(motor_position_control_handle_t *motor_position_control_h)
+{
+	if ((motor_position_control_h == NULL) || (motor_position_control_h->is_initialized == false)) return false;
+
+	motor_position_control_h->integrator_term_mrpm = 0;
+	motor_position_control_h->reference_remainder = 0;
+	motor_position_control_h->settle_count = 0u;
+	motor_position_control_h->is_referenced = false;
+	motor_position_control_h->is_move_active = false;
+	motor_position_control_h->motor_h->position_control = (motor_position_control_state_t){0};
+
+	return true;
+}
+
+bool motor_position_control_move_to(motor_position_control_handle_t *motor_position_control_h,
+									int32_t target_position_counts,
+									int32_t reference_speed_mrpm,
+									uint32_t max_acceleration_mrpm_per_s,
+									uint32_t max_jerk_mrpm_per_s2,
+									motor_trajectory_profile_t *profile)
+{
+	if ((motor_position_control_h == NULL) || (motor_position_control_h->is_initialized == false)) return false;
+	if ((profile == NULL) || (max_acceleration_mrpm_per_s == 0u)) return false;
+	if (motor_position_control_h->is_referenced == false) return false;
+
+	motor_position_control_state_t *state = &motor_position_control_h->motor_h->position_control;
+	int64_t distance_counts = (int64_t)(int32_t)((uint32_t)target_position_counts -
+												 (uint32_t)state->reference_position_counts);
+	int64_t direction = (distance_counts >= 0) ? 1 : -1;
+	int64_t distance_abs_counts = direction * distance_counts;
+	int64_t start_speed_mrpm = direction * (int64_t)reference_speed_mrpm;
+	int64_t cruise_speed_mrpm = (int64_t)motor_position_control_h->max_speed_mrpm;
+	uint64_t hold_ms = 0u;
+
+	/* Highest cruise speed whose two ramps fit the distance (bisection on an increasing distance). */
+	if (motor_position_control_move_ramp_counts(start_speed_mrpm, cruise_speed_mrpm,
+												max_acceleration_mrpm_per_s, max_jerk_mrpm_per_s2) > distance_abs_counts)
+	{
+		int64_t low_mrpm = 0;
+		int64_t high_mrpm = cruise_speed_mrpm;
+
+		for (uint32_t i = 0u; (i < MOTOR_POSITION_CONTROL_SPEED_SEARCH_STEPS) && ((high_mrpm - low_mrpm) > 1); i++)
+		{
+			int64_t mid_mrpm = low_mrpm + ((high_mrpm - low_mrpm) / 2);
+
+			if (motor_position_control_move_ramp_counts(start_speed_mrpm, mid_mrpm,
+														max_acceleration_mrpm_per_s, max_jerk_mrpm_per_s2) > distance_abs_counts)
+			{
+				high_mrpm = mid_mrpm;
+			}
+			else
+			{
+				low_mrpm = mid_mrpm;
+			}
+		}
+		cruise_speed_mrpm = low_mrpm;
+	}
+
+	/* Cruise the rest: counts per ms at V are V x 1024 / 937500. */
+	int64_t remaining_counts = distance_abs_counts -
+							   motor_position_control_move_ramp_counts(start_speed_mrpm, cruise_speed_mrpm,
+																	   max_acceleration_mrpm_per_s, max_jerk_mrpm_per_s2);
+	if ((cruise_speed_mrpm > 0) && (remaining_counts > 0))
+	{
+		hold_ms = (uint64_t)((remaining_counts * (MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN /
+												  (int64_t)MOTOR_POSITION_CONTROL_US_PER_MS)) /
+							 (cruise_speed_mrpm * MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_NUM));
+		if (hold_ms > (uint64_t)UINT32_MAX) hold_ms = UINT32_MAX;
+	}
+
+	motor_position_control_h->move_segments[0] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = (int32_t)(direction * cruise_speed_mrpm),
+			.hold_ms = (uint32_t)hold_ms,
+	};
+	motor_position_control_h->move_segments[1] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0,
+	};
+	*profile = (motor_trajectory_profile_t){
+			.segments = motor_position_control_h->move_segments,
+			.segment_count = MOTOR_POSITION_CONTROL_MOVE_SEGMENT_COUNT,
+			.is_cyclic = false,
+			.max_acceleration_mrpm_per_s = max_acceleration_mrpm_per_s,
+			.max_jerk_mrpm_per_s2 = max_jerk_mrpm_per_s2,
+	};
+
+	state->target_position_counts = target_position_counts;
+	state->is_in_position = false;
+	motor_position_control_h->settle_count = 0u;
+	motor_position_control_h->is_move_active = true;
+
+	return true;
+}
+
+bool motor_position_control_update(motor_position_control_handle_t *motor_position_control_h,
+								   int32_t reference_speed_mrpm,
+								   bool is_reference_finished,
+								   int32_t measured_position_counts,
+								   bool *in_position_reached)
+{
+	if (in_position_reached != NULL) *in_position_reached = false;
+	if ((motor_position_control_h == NULL) || (motor_position_control_h->is_initialized == false)) return false;
+
+	const motor_position_control_cfg_t *cfg = motor_position_control_h->cfg;
+	motor_position_control_state_t *state = &motor_position_control_h->motor_h->position_control;
+	const int32_t speed_limit = motor_position_control_h->max_speed_mrpm;
+
+	/* Control-positive, wrap-safe (no signed overflow at INT32_MIN). */
+	if (cfg->control_direction_sign < 0)
+	{
+		measured_position_counts = (int32_t)(0u - (uint32_t)measured_position_counts);
+	}
+	state->measured_position_counts = measured_position_counts;
+
+	if (motor_position_control_h->is_referenced == false)
+	{
+		/* First update after reset: hold the measured position. */
+		state->reference_position_counts = measured_position_counts;
+		state->target_position_counts = measured_position_counts;
+		motor_position_control_h->reference_remainder = 0;
+		motor_position_control_h->is_referenced = true;
+	}
+	else
+	{
+		/* Integrate the trajectory speed over one period, keeping the sub-count remainder. */
+		int64_t reference_step = motor_position_control_h->reference_remainder +
+								 ((int64_t)reference_speed_mrpm * (int64_t)cfg->update_period_ms *
+								  (int64_t)MOTOR_POSITION_CONTROL_US_PER_MS * MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_NUM);
+		int64_t step_counts = reference_step / MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN;
+
+		motor_position_control_h->reference_remainder = reference_step -
+														(step_counts * MOTOR_POSITION_CONTROL_COUNTS_PER_MRPM_US_DEN);
+		state->reference_position_counts = (int32_t)((uint32_t)state->reference_position_counts + (uint32_t)step_counts);
+	}
+
+	if (motor_position_control_h->is_move_active == false)
+	{
+		/* No move: the reference is where the trajectory (stopping) takes it. */
+		state->target_position_counts = state->reference_position_counts;
+	}
+	else if (is_reference_finished)
+	{
+		/* Table finished: the residual of the plan steps into the reference, P closes it. */
+		state->reference_position_counts = state->target_position_counts;
+		motor_position_control_h->reference_remainder = 0;
+		motor_position_control_h->is_move_active = false;
+	}
+
+	int32_t error_counts = (int32_t)((uint32_t)state->reference_position_counts - (uint32_t)measured_position_counts);
+	int64_t proportional_mrpm = motor_position_control_divide_round_nearest(
+			(int64_t)motor_position_control_h->kp_q15 * (int64_t)error_counts, MOTOR_POSITION_CONTROL_Q15_SCALE);
+	int64_t integrator_step_mrpm = motor_position_control_divide_round_nearest(
+			(int64_t)motor_position_control_h->ki_dt_q15 * (int64_t)error_counts, MOTOR_POSITION_CONTROL_Q15_SCALE);
+	int64_t integrator_candidate_mrpm = (int64_t)motor_position_control_h->integrator_term_mrpm + integrator_step_mrpm;
+	int64_t output_mrpm = (int64_t)reference_speed_mrpm + proportional_mrpm + integrator_candidate_mrpm;
+
+	/* Conditional integration: no growth into a saturated output. */
+	if (((output_mrpm > (int64_t)speed_limit) && (integrator_step_mrpm > 0)) ||
+		((output_mrpm < -(int64_t)speed_limit) && (integrator_step_mrpm < 0)))
+	{
+		integrator_candidate_mrpm = (int64_t)motor_position_control_h->integrator_term_mrpm;
+		output_mrpm = (int64_t)reference_speed_mrpm + proportional_mrpm + integrator_candidate_mrpm;
+	}
+	motor_position_control_h->integrator_term_mrpm =
+			motor_position_control_clamp_i32(integrator_candidate_mrpm, -speed_limit, speed_limit);
+
+	state->position_error_counts = error_counts;
+	state->speed_command_mrpm = motor_position_control_clamp_i32(output_mrpm, -speed_limit, speed_limit);
+
+	/* In position: move finished and the error stayed inside the window for the settle time. */
+	uint32_t error_abs_counts = (error_counts >= 0) ? (uint32_t)error_counts : (0u - (uint32_t)error_counts);
+	if ((motor_position_control_h->is_move_active == false) &&
+		(is_reference_finished) &&
+		(error_abs_counts <= cfg->in_position_window_counts))
+	{
+		if (motor_position_control_h->settle_count < motor_position_control_h->settle_update_count)
+		{
+			motor_position_control_h->settle_count++;
+		}
+		if ((motor_position_control_h->settle_count >= motor_position_control_h->settle_update_count) &&
+			(state->is_in_position == false))
+		{
+			state->is_in_position = true;
+			if (in_position_reached != NULL) *in_position_reached = true;
+		}
+	}
+	else
+	{
+		motor_position_control_h->settle_count = 0u;
+		state->is_in_position = false;
+	}
+
+	return true;
+}
+
+bool motor_position_control_set_gains(motor_position_control_handle_t *motor_position_control_h,
+									  int32_t kp_q15,
+									  int32_t ki_per_s_q15)
+{
+	if ((motor_position_control_h == NULL) || (motor_position_control_h->is_initialized == false)) return false;
+	if ((kp_q15 < 0) || (ki_per_s_q15 < 0)) return false;
+
+	/* The integrator is in mrpm, so the new gains take over without a bump. */
+	motor_position_control_h->kp_q15 = kp_q15;
+	motor_position_control_h->ki_dt_q15 = motor_position_control_discretize_ki(ki_per_s_q15,
+																			   motor_position_control_h->cfg->update_period_ms);
+
+	return true;
+}
+
+bool motor_position_control_set_max_speed(motor_position_control_handle_t *motor_position_control_h,
+										  int32_t max_speed_mrpm)
+{
+	if ((motor_position_control_h == NULL) || (motor_position_control_h->is_initialized == false)) return false;
+	if (max_speed_mrpm <= 0) return false;
+
+	motor_position_control_h->max_speed_mrpm = max_speed_mrpm;
+	motor_position_control_h->integrator_term_mrpm =
+			motor_position_control_clamp_i32((int64_t)motor_position_control_h->integrator_term_mrpm,
+											 -max_speed_mrpm,
+											 max_speed_mrpm);
+
+	return true;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file motor_scope.c
+ * @brief Triggered in-RAM capture of motor control signals.
+ *
+ */
+
+#include "motor/motor_scope.h"
+#include <stddef.h>
+
+/**
+ * @brief Read one selectable signal from the shared motor state.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ * @param channel Signal identifier.
+ * @return Signal value (0 for unavailable duty channels).
+ */
+static int32_t motor_scope_read_channel(const motor_scope_handle_t *motor_scope_h,
+										motor_scope_channel_t channel)
+{
+	const motor_handle_t *motor_h = motor_scope_h->cfg->motor_h;
+	const motor_3pwm_handle_t *motor_3pwm_h = motor_scope_h->cfg->motor_3pwm_h;
+
+	switch (channel)
+	{
+		case MOTOR_SCOPE_CHANNEL_MECHANICAL_ANGLE: return (int32_t)motor_h->measurements.mechanical_angle_u16;
+		case MOTOR_SCOPE_CHANNEL_ELECTRICAL_ANGLE: return (int32_t)motor_h->measurements.electrical_angle_u16;
+		case MOTOR_SCOPE_CHANNEL_RAW_SPEED:        return motor_h->speed_feedback.raw_mechanical_speed_mrpm;
+		case MOTOR_SCOPE_CHANNEL_FILTERED_SPEED:   return motor_h->speed_feedback.filtered_mechanical_speed_mrpm;
+		case MOTOR_SCOPE_CHANNEL_TARGET_SPEED:     return motor_h->targets.target_mechanical_speed_mrpm;
+		case MOTOR_SCOPE_CHANNEL_SPEED_ERROR:      return motor_h->speed_pi.speed_error_mrpm;
+		case MOTOR_SCOPE_CHANNEL_SPEED_INTEGRATOR: return motor_h->speed_pi.integrator_term_permyriad;
+		case MOTOR_SCOPE_CHANNEL_UQ_COMMAND:       return motor_h->speed_pi.speed_control_uq_command_permyriad;
+		case MOTOR_SCOPE_CHANNEL_ID:               return motor_h->current.id_ma;
+		case MOTOR_SCOPE_CHANNEL_IQ:               return motor_h->current.iq_ma;
+		case MOTOR_SCOPE_CHANNEL_DUTY_A:           return (motor_3pwm_h != NULL) ? (int32_t)motor_3pwm_h->phase_a_duty_ticks : 0;
+		case MOTOR_SCOPE_CHANNEL_DUTY_B:           return (motor_3pwm_h != NULL) ? (int32_t)motor_3pwm_h->phase_b_duty_ticks : 0;
+		case MOTOR_SCOPE_CHANNEL_DUTY_C:           return (motor_3pwm_h != NULL) ? (int32_t)motor_3pwm_h->phase_c_duty_ticks : 0;
+		case MOTOR_SCOPE_CHANNEL_REFERENCE_SPEED:  return motor_h->trajectory.reference_mechanical_speed_mrpm;
+		case MOTOR_SCOPE_CHANNEL_REFERENCE_ACCELERATION:
+			return motor_h->trajectory.reference_mechanical_acceleration_mrpm_per_s;
+		case MOTOR_SCOPE_CHANNEL_SPEED_FEEDFORWARD: return motor_h->speed_pi.feedforward_term_permyriad;
+		default:                                   return 0;
+	}
+}
+
+/**
+ * @brief Freeze the ring and derive the time-ordered capture window.
+ *
+ * @param motor_scope_h Pointer to scope handle.
+ */
+static void motor_scope_complete(motor_scope_handle_t *motor_scope_h)
+{
+	uint32_t capacity = motor_scope_h->cfg->sample_capacity;
+	uint32_t captured = (motor_scope_h->recorded_count < capacity) ? motor_scope_h->recorded_count : capacity;
+	uint32_t oldest_sample = motor_scope_h->recorded_count - captured;
+
+	motor_scope_h->captured_count = (uint16_t)captured;
+	motor_scope_h->trigger_offset = (uint16_t)(motor_scope_h->trigger_sample - oldest_sample);
+	motor_scope_h->state = MOTOR_SCOPE_STATE_COMPLETE;
+}
+
+bool motor_scope_init(motor_scope_handle_t *motor_scope_h, const motor_scope_cfg_t *motor_scope_cfg)
+{
+	if ((motor_scope_h == NULL) || (motor_scope_cfg == NULL)) return false;
+	if ((motor_scope_cfg->motor_h == NULL) || (motor_scope_cfg->sample_buffer == NULL)) return false;
+	if (motor_scope_cfg->sample_capacity < 2u) return false;
+	if ((motor_scope_cfg->sample_capacity & (motor_scope_cfg->sample_capacity - 1u)) != 0u) return false;
+	if (motor_scope_cfg->pre_trigger_samples >= motor_scope_cfg->sample_capacity) return false;
+	if (motor_scope_cfg->decimation == 0u) return false;
+	if ((motor_scope_cfg->channel_count == 0u) || (motor_scope_cfg->channel_count > MOTOR_SCOPE_MAX_CHANNELS)) return false;
+	for (uint8_t i = 0u; i < motor_scope_cfg->channel_count; i++)
+	{
+		if ((uint32_t)motor_scope_cfg->channels[i] >= (uint32_t)MOTOR_SCOPE_CHANNEL_COUNT) return false;
+	}
+	if (motor_scope_cfg->trigger_mode == MOTOR_SCOPE_TRIGGER_ABS_LEVEL)
+	{
+		if (motor_scope_cfg->trigger_channel_index >= motor_scope_cfg->channel_count) return false;
+		if (motor_scope_cfg->trigger_level <= 0) return false;
+	}
+
+	motor_scope_h->cfg = motor_scope_cfg;
+	motor_scope_h->state = MOTOR_SCOPE_STATE_IDLE;
+	motor_scope_h->recorded_count = 0u;
+	motor_scope_h->trigger_sample = 0u;
+	motor_scope_h->post_trigger_remaining = 0u;
+	motor_scope_h->decimation_count = 0u;
+	motor_scope_h->captured_count = 0u;
+	motor_scope_h->trigger_offset = 0u;
+	motor_scope_h->is_initialized = true;
+
+	return true;
+}
+
+bool motor_scope_arm(motor_scope_handle_t *motor_scope_h)
+{
+	if ((motor_scope_h == NULL) || (motor_scope_h->is_initialized == false)) return false;
+
+	motor_scope_h->recorded_count = 0u;
+	motor_scope_h->trigger_sample = 0u;
+	motor_scope_h->post_trigger_remaining = 0u;
+	motor_scope_h->decimation_count = 0u;
+	motor_scope_h->captured_count = 0u;
+	motor_scope_h->trigger_offset = 0u;
+	motor_scope_h->state = MOTOR_SCOPE_STATE_ARMED;
+
+	return true;
+}
+
+bool motor_scope_record(motor_scope_handle_t *motor_scope_h)
+{
+	if ((motor_scope_h == NULL) || (motor_scope_h->is_initialized == false)) return false;
+	if ((motor_scope_h->state != MOTOR_SCOPE_STATE_ARMED) &&
+		(motor_scope_h->state != MOTOR_SCOPE_STATE_TRIGGERED))
+	{
+		return true;
+	}
+
+	const motor_scope_cfg_t *cfg = motor_scope_h->cfg;
+	if (++motor_scope_h->decimation_count < cfg->decimation) return true;
+	motor_scope_h->decimation_count = 0u;
+
+	/* Overwrite the oldest row; the ring index is the recorded count modulo capacity. */
+	uint32_t row = motor_scope_h->recorded_count & ((uint32_t)cfg->sample_capacity - 1u);
+	int32_t *values = &cfg->sample_buffer[row * cfg->channel_count];
+	for (uint8_t i = 0u; i < cfg->channel_count; i++)
+	{
+		values[i] = motor_scope_read_channel(motor_scope_h, cfg->channels[i]);
+	}
+	motor_scope_h->recorded_count++;
+
+	if (motor_scope_h->state == MOTOR_SCOPE_STATE_ARMED)
+	{
+		if (cfg->trigger_mode != MOTOR_SCOPE_TRIGGER_ABS_LEVEL) return true;
+
+		int32_t level_value = values[cfg->trigger_channel_index];
+		if ((level_value < cfg->trigger_level) && (level_value > -cfg->trigger_level)) return true;
+
+		/* The sample that crossed the level is the trigger sample. */
+		motor_scope_h->trigger_sample = motor_scope_h->recorded_count - 1u;
+		motor_scope_h->post_trigger_remaining = (uint16_t)(cfg->sample_capacity - cfg->pre_trigger_samples);
+		motor_scope_h->state = MOTOR_SCOPE_STATE_TRIGGERED;
+	}
+
+	if (--motor_scope_h->post_trigger_remaining == 0u)
+	{
+		motor_scope_complete(motor_scope_h);
+	}
+
+	return true;
+}
+
+bool motor_scope_trigger(motor_scope_handle_t *motor_scope_h)
+{
+	if ((motor_scope_h == NULL) || (motor_scope_h->is_initialized == false)) return false;
+	if (motor_scope_h->state != MOTOR_SCOPE_STATE_ARMED) return false;
+
+	motor_scope_h->trigger_sample = motor_scope_h->recorded_count;
+	motor_scope_h->post_trigger_remaining =
+			(uint16_t)(motor_scope_h->cfg->sample_capacity - motor_scope_h->cfg->pre_trigger_samples);
+	motor_scope_h->state = MOTOR_SCOPE_STATE_TRIGGERED;
+
+	return true;
+}
+
+bool motor_scope_freeze(motor_scope_handle_t *motor_scope_h)
+{
+	if ((motor_scope_h == NULL) || (motor_scope_h->is_initialized == false)) return false;
+
+	if (motor_scope_h->state == MOTOR_SCOPE_STATE_ARMED)
+	{
+		/* Untriggered freeze: the trigger marks the end of the capture. */
+		motor_scope_h->trigger_sample = motor_scope_h->recorded_count;
+		motor_scope_complete(motor_scope_h);
+	}
+	else if (motor_scope_h->state == MOTOR_SCOPE_STATE_TRIGGERED)
+	{
+		motor_scope_complete(motor_scope_h);
+	}
+
+	return (motor_scope_h->state == MOTOR_SCOPE_STATE_COMPLETE) && (motor_scope_h->captured_count != 0u);
+}
+
+bool motor_scope_is_complete(const motor_scope_handle_t *motor_scope_h)
+{
+	if (motor_scope_h == NULL) return false;
+
+	return (motor_scope_h->state == MOTOR_SCOPE_STATE_COMPLETE);
+}
+
+bool motor_scope_get_sample(const motor_scope_handle_t *motor_scope_h,
+							uint16_t sample_index,
+							int32_t *values)
+{
+	if ((motor_scope_h == NULL) || (values == NULL)) return false;
+	if (motor_scope_h->state != MOTOR_SCOPE_STATE_COMPLETE) return false;
+	if (sample_index >= motor_scope_h->captured_count) return false;
+
+	const motor_scope_cfg_t *cfg = motor_scope_h->cfg;
+	uint32_t sample = motor_scope_h->recorded_count - motor_scope_h->captured_count + sample_index;
+	uint32_t row = sample & ((uint32_t)cfg->sample_capacity - 1u);
+	for (uint8_t i = 0u; i < cfg->channel_count; i++)
+	{
+		values[i] = cfg->sample_buffer[(row * cfg->channel_count) + i];
+	}
+
+	return true;
+}
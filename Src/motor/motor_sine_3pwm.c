@@ -5,73 +5,30 @@
  */
 
 #include "motor/motor_sine_3pwm.h"
+#include "motor/motor_sincos.h"
 #include <stddef.h>
 
-#define MOTOR_SINE_3PWM_LUT_SIZE          256u
-#define MOTOR_SINE_3PWM_INDEX_SHIFT       8u
 #define MOTOR_SINE_3PWM_PHASE_SHIFT_120   21845u
 #define MOTOR_SINE_3PWM_PHASE_SHIFT_240   43690u
-#define MOTOR_SINE_3PWM_LUT_MAX           32767
+#define MOTOR_SINE_3PWM_Q15_MAX           MOTOR_SINCOS_Q15_MAX
 #define MOTOR_SINE_3PWM_DUTY_CENTER       5000
 #define MOTOR_SINE_3PWM_DUTY_MAX          10000
-#define MOTOR_SINE_3PWM_DUTY_SCALE_DENOM  (2 * MOTOR_SINE_3PWM_LUT_MAX)
+#define MOTOR_SINE_3PWM_DUTY_SCALE_DENOM  (2 * MOTOR_SINE_3PWM_Q15_MAX)
 
 /**
- * @brief Full-wave sine lookup table in signed Q15-like units.
- *
- * One electrical revolution is stored across 256 samples.
- */
-static const int16_t motor_sine_3pwm_lut[MOTOR_SINE_3PWM_LUT_SIZE] = {
-	     0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
-	  6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
-	 12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
-	 18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
-	 23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
-	 27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
-	 30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
-	 32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
-	 32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
-	 32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
-	 30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
-	 27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
-	 23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
-	 18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
-	 12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
-	  6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
-	     0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
-	 -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
-	-12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
-	-18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
-	-23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
-	-27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
-	-30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
-	-32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
-	-32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
-	-32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
-	-30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
-	-27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
-	-23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
-	-18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
-	-12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
-	 -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
-};
-
-/**
- * @brief Read one sine-table sample from one full-turn electrical angle.
+ * @brief Read one interpolated sine sample from one full-turn electrical angle.
  *
  * @param electrical_angle_u16 Electrical angle in full-turn uint16 units.
  * @return Signed Q15-like sine sample.
  */
-static int16_t motor_sine_3pwm_lut_get(uint16_t electrical_angle_u16)
+static int16_t motor_sine_3pwm_sin_get(uint16_t electrical_angle_u16)
 {
-	/* index = electrical_angle_u16 / 256 for the 256-point full-wave LUT. */
-	uint16_t index = electrical_angle_u16 >> MOTOR_SINE_3PWM_INDEX_SHIFT;
-	return motor_sine_3pwm_lut[index];
+	return motor_sincos_get_q15(electrical_angle_u16).sin_q15;
 }
 
 int16_t motor_sine_3pwm_get_phase_q15(uint16_t electrical_angle_u16)
 {
-	return motor_sine_3pwm_lut_get(electrical_angle_u16);
+	return motor_sine_3pwm_sin_get(electrical_angle_u16);
 }
 
 /**
@@ -82,8 +39,8 @@ int16_t motor_sine_3pwm_get_phase_q15(uint16_t electrical_angle_u16)
  */
 static int16_t motor_sine_3pwm_clamp_q15(int32_t phase_q15)
 {
-	if (phase_q15 > MOTOR_SINE_3PWM_LUT_MAX) return MOTOR_SINE_3PWM_LUT_MAX;
-	if (phase_q15 < -MOTOR_SINE_3PWM_LUT_MAX) return (int16_t)(-MOTOR_SINE_3PWM_LUT_MAX);
+	if (phase_q15 > MOTOR_SINE_3PWM_Q15_MAX) return MOTOR_SINE_3PWM_Q15_MAX;
+	if (phase_q15 < -MOTOR_SINE_3PWM_Q15_MAX) return (int16_t)(-MOTOR_SINE_3PWM_Q15_MAX);
 	return (int16_t)phase_q15;
 }
 
@@ -104,11 +61,11 @@ static uint16_t motor_sine_3pwm_phase_to_duty_permyriad(int16_t phase_q15,
 	/* Round the signed duty offset to the nearest permyriad step. */
 	if (scaled >= 0)
 	{
-		offset = (scaled + MOTOR_SINE_3PWM_LUT_MAX) / MOTOR_SINE_3PWM_DUTY_SCALE_DENOM;
+		offset = (scaled + MOTOR_SINE_3PWM_Q15_MAX) / MOTOR_SINE_3PWM_DUTY_SCALE_DENOM;
 	}
 	else
 	{
-		offset = (scaled - MOTOR_SINE_3PWM_LUT_MAX) / MOTOR_SINE_3PWM_DUTY_SCALE_DENOM;
+		offset = (scaled - MOTOR_SINE_3PWM_Q15_MAX) / MOTOR_SINE_3PWM_DUTY_SCALE_DENOM;
 	}
 
 	int32_t duty_permyriad = MOTOR_SINE_3PWM_DUTY_CENTER + offset;
@@ -124,6 +81,33 @@ static uint16_t motor_sine_3pwm_phase_to_duty_permyriad(int16_t phase_q15,
 	return (uint16_t)duty_permyriad;
 }
 
+/**
+ * @brief Feed the dead-time compensation with the phase command polarity.
+ *
+ * Open-loop and direct phase commands have no current feedback, so both
+ * COMMAND and CURRENT configurations use the command sign here.
+ *
+ * @param motor_3pwm_h Pointer to 3-PWM motor stage handle.
+ * @param phase_a_q15 Phase A sample.
+ * @param phase_b_q15 Phase B sample.
+ * @param phase_c_q15 Phase C sample.
+ * @param amplitude_permyriad Amplitude applied to the samples.
+ */
+static void motor_sine_3pwm_update_dead_time_polarity(motor_3pwm_handle_t *motor_3pwm_h,
+													  int16_t phase_a_q15,
+													  int16_t phase_b_q15,
+													  int16_t phase_c_q15,
+													  uint16_t amplitude_permyriad)
+{
+	if ((motor_3pwm_h->cfg == NULL) || (motor_3pwm_h->cfg->dead_time_comp == MOTOR_3PWM_DEAD_TIME_COMP_OFF)) return;
+
+	/* Permyriad phase voltage for the band check (Q15 ~ >> 15). */
+	(void)motor_3pwm_set_dead_time_polarity(motor_3pwm_h,
+											((int32_t)phase_a_q15 * (int32_t)amplitude_permyriad) >> 15,
+											((int32_t)phase_b_q15 * (int32_t)amplitude_permyriad) >> 15,
+											((int32_t)phase_c_q15 * (int32_t)amplitude_permyriad) >> 15);
+}
+
 bool motor_sine_3pwm_apply(motor_3pwm_handle_t *motor_3pwm_h,
 						   uint16_t electrical_angle_u16,
 						   uint16_t amplitude_permyriad)
@@ -136,13 +120,17 @@ bool motor_sine_3pwm_apply(motor_3pwm_handle_t *motor_3pwm_h,
 	uint16_t angle_b_u16 = (uint16_t)(electrical_angle_u16 + MOTOR_SINE_3PWM_PHASE_SHIFT_120);
 	uint16_t angle_c_u16 = (uint16_t)(electrical_angle_u16 + MOTOR_SINE_3PWM_PHASE_SHIFT_240);
 
+	int16_t phase_a_q15 = motor_sine_3pwm_sin_get(angle_a_u16);
+	int16_t phase_b_q15 = motor_sine_3pwm_sin_get(angle_b_u16);
+	int16_t phase_c_q15 = motor_sine_3pwm_sin_get(angle_c_u16);
+
+	motor_sine_3pwm_update_dead_time_polarity(motor_3pwm_h, phase_a_q15, phase_b_q15, phase_c_q15,
+											  amplitude_permyriad);
+
 	/* Convert the three phase samples into centered PWM duties. */
-	uint16_t duty_a = motor_sine_3pwm_phase_to_duty_permyriad(
-			motor_sine_3pwm_lut_get(angle_a_u16), amplitude_permyriad);
-	uint16_t duty_b = motor_sine_3pwm_phase_to_duty_permyriad(
-			motor_sine_3pwm_lut_get(angle_b_u16), amplitude_permyriad);
-	uint16_t duty_c = motor_sine_3pwm_phase_to_duty_permyriad(
-			motor_sine_3pwm_lut_get(angle_c_u16), amplitude_permyriad);
+	uint16_t duty_a = motor_sine_3pwm_phase_to_duty_permyriad(phase_a_q15, amplitude_permyriad);
+	uint16_t duty_b = motor_sine_3pwm_phase_to_duty_permyriad(phase_b_q15, amplitude_permyriad);
+	uint16_t duty_c = motor_sine_3pwm_phase_to_duty_permyriad(phase_c_q15, amplitude_permyriad);
 
 	return motor_3pwm_set_duty_abc(motor_3pwm_h, duty_a, duty_b, duty_c);
 }
@@ -159,6 +147,12 @@ bool motor_sine_3pwm_apply_phase_q15(motor_3pwm_handle_t *motor_3pwm_h,
 	int16_t phase_b_q15_clamped = motor_sine_3pwm_clamp_q15((int32_t)phase_b_q15);
 	int16_t phase_c_q15_clamped = motor_sine_3pwm_clamp_q15((int32_t)phase_c_q15);
 
+	motor_sine_3pwm_update_dead_time_polarity(motor_3pwm_h,
+											  phase_a_q15_clamped,
+											  phase_b_q15_clamped,
+											  phase_c_q15_clamped,
+											  MOTOR_SINE_3PWM_MAX_AMPLITUDE_PERMYRIAD);
+
 	/* Convert normalized phase commands directly into centered duties. */
 	uint16_t duty_a = motor_sine_3pwm_phase_to_duty_permyriad(
 			phase_a_q15_clamped,
@@ -0,0 +1,183 @@
+/**
+ * @file motor_speed_autotune.c
+ * @brief On-target step identification of the speed plant and PI gain synthesis.
+ *
+ *  Notes:
+ *  - per step with n updates of dt: area = (v_final * n - sum(v)) * dt, which
+ *    only needs two running sums instead of a sample buffer.
+ *  - gains: Kp_q15 = speedup * du * 2^15 / dv, Ki_q15 = Kp_q15 * 1e6 / tau_us.
+ */
+
+#include "motor/motor_speed_autotune.h"
+#include <stddef.h>
+
+#define MOTOR_SPEED_AUTOTUNE_Q15_SCALE      32768LL
+#define MOTOR_SPEED_AUTOTUNE_US_PER_S       1000000LL
+
+/**
+ * @brief Saturate a signed 64-bit value to the non-negative int32 range.
+ *
+ * @param value Input value.
+ * @return Saturated value.
+ */
+static int32_t motor_speed_autotune_sat_positive_i32(int64_t value)
+{
+	if (value < 0) return 0;
+	if (value > (int64_t)INT32_MAX) return INT32_MAX;
+
+	return (int32_t)value;
+}
+
+/**
+ * @brief Start accumulating one step from its start speed.
+ *
+ * @param motor_speed_autotune_h Pointer to autotune handle.
+ * @param start_speed_mrpm Speed at the step instant.
+ */
+static void motor_speed_autotune_begin_step(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+											int32_t start_speed_mrpm)
+{
+	motor_speed_autotune_h->step_tick = 0u;
+	motor_speed_autotune_h->step_start_speed_mrpm = start_speed_mrpm;
+	motor_speed_autotune_h->speed_sum_mrpm = 0;
+	motor_speed_autotune_h->tail_speed_sum_mrpm = 0;
+	motor_speed_autotune_h->tail_tick_count = 0u;
+}
+
+/**
+ * @brief Identify the model of the finished step and store its gain point.
+ *
+ * @param motor_speed_autotune_h Pointer to autotune handle.
+ * @param final_speed_mrpm Output settled speed of the step.
+ * @return true if the step moved the speed enough and the point is valid, false otherwise.
+ */
+static bool motor_speed_autotune_finish_step(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+											 int32_t *final_speed_mrpm)
+{
+	const motor_speed_autotune_cfg_t *cfg = motor_speed_autotune_h->cfg;
+	uint8_t index = motor_speed_autotune_h->step_index;
+	int64_t final_mrpm = motor_speed_autotune_h->tail_speed_sum_mrpm / (int64_t)motor_speed_autotune_h->tail_tick_count;
+	int64_t delta_mrpm = final_mrpm - (int64_t)motor_speed_autotune_h->step_start_speed_mrpm;
+	int64_t dt_us = (int64_t)cfg->update_period_ms * 1000LL;
+
+	*final_speed_mrpm = (int32_t)final_mrpm;
+	if (delta_mrpm < (int64_t)cfg->min_delta_speed_mrpm) return false;
+
+	int64_t area_mrpm_us =
+			((final_mrpm * (int64_t)motor_speed_autotune_h->step_tick) - motor_speed_autotune_h->speed_sum_mrpm) * dt_us;
+	/* The first sample of a step still shows the previous command: remove that one update. */
+	int64_t tau_us = (area_mrpm_us / delta_mrpm) - dt_us;
+
+	/* A response faster than one update cannot be resolved: use the sample period. */
+	if (tau_us < dt_us) tau_us = dt_us;
+
+	int64_t kp_q15 = ((int64_t)cfg->closed_loop_speedup * (int64_t)cfg->step_uq_permyriad *
+					  MOTOR_SPEED_AUTOTUNE_Q15_SCALE) / delta_mrpm;
+	int64_t ki_per_s_q15 = (kp_q15 * MOTOR_SPEED_AUTOTUNE_US_PER_S) / tau_us;
+	int64_t point_speed_mrpm = ((int64_t)motor_speed_autotune_h->step_start_speed_mrpm + final_mrpm) / 2LL;
+
+	if (point_speed_mrpm < 0) point_speed_mrpm = 0;
+	/* Gain points must ascend in speed (a stalled or reversing step breaks the staircase). */
+	if ((index > 0u) && ((uint32_t)point_speed_mrpm <= motor_speed_autotune_h->points[index - 1u].speed_mrpm))
+	{
+		return false;
+	}
+
+	motor_speed_autotune_h->plant_gain_mrpm_per_permyriad_q8[index] =
+			motor_speed_autotune_sat_positive_i32((delta_mrpm * 256LL) / (int64_t)cfg->step_uq_permyriad);
+	motor_speed_autotune_h->plant_time_constant_us[index] =
+			(uint32_t)motor_speed_autotune_sat_positive_i32(tau_us);
+	motor_speed_autotune_h->points[index].speed_mrpm = (uint32_t)point_speed_mrpm;
+	motor_speed_autotune_h->points[index].kp_q15 = motor_speed_autotune_sat_positive_i32(kp_q15);
+	motor_speed_autotune_h->points[index].ki_per_s_q15 = motor_speed_autotune_sat_positive_i32(ki_per_s_q15);
+	motor_speed_autotune_h->point_count = (uint8_t)(index + 1u);
+
+	return true;
+}
+
+bool motor_speed_autotune_init(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+							   const motor_speed_autotune_cfg_t *motor_speed_autotune_cfg)
+{
+	if ((motor_speed_autotune_h == NULL) || (motor_speed_autotune_cfg == NULL)) return false;
+	if (motor_speed_autotune_cfg->motor_h == NULL) return false;
+	if ((motor_speed_autotune_cfg->step_count == 0u) ||
+		(motor_speed_autotune_cfg->step_count > MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS)) return false;
+	if ((motor_speed_autotune_cfg->update_period_ms == 0u) || (motor_speed_autotune_cfg->step_uq_permyriad == 0u)) return false;
+	if (motor_speed_autotune_cfg->closed_loop_speedup == 0u) return false;
+	if (motor_speed_autotune_cfg->min_delta_speed_mrpm == 0u) return false;
+	/* The tail average needs at least four updates per step. */
+	if ((motor_speed_autotune_cfg->settle_time_ms / motor_speed_autotune_cfg->update_period_ms) < 4u) return false;
+
+	motor_speed_autotune_h->cfg = motor_speed_autotune_cfg;
+	motor_speed_autotune_h->motor_h = motor_speed_autotune_cfg->motor_h;
+	motor_speed_autotune_h->settle_ticks =
+			(uint32_t)motor_speed_autotune_cfg->settle_time_ms / (uint32_t)motor_speed_autotune_cfg->update_period_ms;
+	motor_speed_autotune_h->state = MOTOR_SPEED_AUTOTUNE_STATE_IDLE;
+	motor_speed_autotune_h->point_count = 0u;
+	motor_speed_autotune_h->is_initialized = true;
+
+	return true;
+}
+
+bool motor_speed_autotune_start(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+								int32_t measured_mechanical_speed_mrpm)
+{
+	if ((motor_speed_autotune_h == NULL) || (motor_speed_autotune_h->is_initialized == false)) return false;
+
+	motor_speed_autotune_h->step_index = 0u;
+	motor_speed_autotune_h->point_count = 0u;
+	motor_speed_autotune_begin_step(motor_speed_autotune_h, measured_mechanical_speed_mrpm);
+	motor_speed_autotune_h->state = MOTOR_SPEED_AUTOTUNE_STATE_RUNNING;
+
+	return true;
+}
+
+bool motor_speed_autotune_update(motor_speed_autotune_handle_t *motor_speed_autotune_h,
+								 int32_t measured_mechanical_speed_mrpm,
+								 int32_t *uq_command_permyriad)
+{
+	if ((motor_speed_autotune_h == NULL) || (uq_command_permyriad == NULL)) return false;
+	if (motor_speed_autotune_h->is_initialized == false) return false;
+
+	const motor_speed_autotune_cfg_t *cfg = motor_speed_autotune_h->cfg;
+
+	if (motor_speed_autotune_h->state != MOTOR_SPEED_AUTOTUNE_STATE_RUNNING)
+	{
+		*uq_command_permyriad = 0;
+		return true;
+	}
+
+	/* Accumulate this sample, the last quarter of the step is the settled window. */
+	motor_speed_autotune_h->step_tick++;
+	motor_speed_autotune_h->speed_sum_mrpm += (int64_t)measured_mechanical_speed_mrpm;
+	if (motor_speed_autotune_h->step_tick > (motor_speed_autotune_h->settle_ticks - (motor_speed_autotune_h->settle_ticks / 4u)))
+	{
+		motor_speed_autotune_h->tail_speed_sum_mrpm += (int64_t)measured_mechanical_speed_mrpm;
+		motor_speed_autotune_h->tail_tick_count++;
+	}
+
+	if (motor_speed_autotune_h->step_tick >= motor_speed_autotune_h->settle_ticks)
+	{
+		int32_t final_speed_mrpm = 0;
+
+		if (!motor_speed_autotune_finish_step(motor_speed_autotune_h, &final_speed_mrpm))
+		{
+			motor_speed_autotune_h->state = MOTOR_SPEED_AUTOTUNE_STATE_FAILED;
+			*uq_command_permyriad = 0;
+			return true;
+		}
+
+		motor_speed_autotune_h->step_index++;
+		if (motor_speed_autotune_h->step_index >= cfg->step_count)
+		{
+			motor_speed_autotune_h->state = MOTOR_SPEED_AUTOTUNE_STATE_DONE;
+			*uq_command_permyriad = 0;
+			return true;
+		}
+		motor_speed_autotune_begin_step(motor_speed_autotune_h, final_speed_mrpm);
+	}
+
+	*uq_command_permyriad = (int32_t)(motor_speed_autotune_h->step_index + 1u) * (int32_t)cfg->step_uq_permyriad;
+
+	return true;
+}
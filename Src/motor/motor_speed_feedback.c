@@ -11,7 +11,12 @@
 #define MOTOR_SPEED_FEEDBACK_MRPM_PER_RPM                1000LL
 #define MOTOR_SPEED_FEEDBACK_US_PER_MINUTE               60000000LL
 #define MOTOR_SPEED_FEEDBACK_Q15_SCALE                   32768LL
+/* 4 * pi * 2^32 / 1e6 scaled by 1000: kp_q32 = bw_hz * dt_us * this / 1000. */
+#define MOTOR_SPEED_FEEDBACK_FOUR_PI_Q32_PER_MHZ_X1000   53972556ULL
+#define MOTOR_SPEED_FEEDBACK_MRPM_PER_TURN_PER_US        (MOTOR_SPEED_FEEDBACK_US_PER_MINUTE * MOTOR_SPEED_FEEDBACK_MRPM_PER_RPM)
+#define MOTOR_SPEED_FEEDBACK_INV_Q15_SCALE_F32           (1.0f / 32768.0f)
 
+#if (MOTOR_SPEED_FEEDBACK_KERNEL == MOTOR_KERNEL_FIXED)
 /**
  * @brief Divide one signed integer and round to nearest integer.
  *
@@ -29,22 +34,120 @@ static int64_t motor_speed_feedback_divide_round_nearest(int64_t numerator,
 
 	return (numerator - (denominator / 2LL)) / denominator;
 }
+#else
+/**
+ * @brief Round one float value to nearest integer (ties away from zero).
+ *
+ * @param value Value within int32 range.
+ * @return Rounded value.
+ */
+static int64_t motor_speed_feedback_round_f32(float value)
+{
+	return (value >= 0.0f) ? (int64_t)(value + 0.5f) : (int64_t)(value - 0.5f);
+}
+#endif
 
-bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedback_h,
-							   const motor_speed_feedback_cfg_t *motor_speed_feedback_cfg)
+/**
+ * @brief Multiply by one Q32 factor and round to nearest.
+ *
+ * @param value Signed value.
+ * @param factor_q32 Unsigned Q32 factor.
+ * @return Rounded value * factor / 2^32.
+ */
+static int64_t motor_speed_feedback_mul_q32(int64_t value, uint32_t factor_q32)
 {
-	if ((motor_speed_feedback_h == NULL) || (motor_speed_feedback_cfg == NULL)) return false;
-	if (motor_speed_feedback_cfg->motor_h == NULL) return false;
-	if (motor_speed_feedback_cfg->sample_period_us == 0u) return false;
-	if ((motor_speed_feedback_cfg->control_direction_sign != 1) &&
-		(motor_speed_feedback_cfg->control_direction_sign != -1)) return false;
+	return ((value * (int64_t)factor_q32) + (1LL << 31)) >> 32;
+}
 
-	motor_handle_t *motor_h = motor_speed_feedback_cfg->motor_h;
-	uint64_t sample_period_us = motor_speed_feedback_cfg->sample_period_us;
+/**
+ * @brief Saturate one signed 64-bit value into int32 range.
+ *
+ * @param value Signed value.
+ * @return Saturated value.
+ */
+static int32_t motor_speed_feedback_saturate_i32(int64_t value)
+{
+	if (value > (int64_t)INT32_MAX) return INT32_MAX;
+	if (value < (int64_t)INT32_MIN) return INT32_MIN;
+	return (int32_t)value;
+}
+
+/**
+ * @brief Reset the PLL observer onto one measured angle at zero speed.
+ *
+ * @param motor_speed_feedback_h Pointer to speed-feedback handle.
+ * @param mechanical_angle_u16 Measured mechanical angle in full-turn uint16 units.
+ */
+static void motor_speed_feedback_reset_pll(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+										   uint16_t mechanical_angle_u16)
+{
+	motor_speed_feedback_h->pll_angle_q32 = (uint32_t)mechanical_angle_u16 << 16;
+	motor_speed_feedback_h->pll_sample_angle_q32 = motor_speed_feedback_h->pll_angle_q32;
+	motor_speed_feedback_h->pll_speed_integrator_q32 = 0;
+	motor_speed_feedback_h->pll_speed_q32 = 0;
+	motor_speed_feedback_h->motor_h->speed_feedback.observer_mechanical_angle_u16 = mechanical_angle_u16;
+	motor_speed_feedback_h->motor_h->speed_feedback.observer_angle_error_counts = 0;
+}
+
+/**
+ * @brief Run one PLL observer step on one measured angle sample.
+ *
+ * @param motor_speed_feedback_h Pointer to speed-feedback handle.
+ * @param mechanical_angle_u16 Measured mechanical angle in full-turn uint16 units.
+ * @return Observer speed in mrpm (sensor direction).
+ */
+static int64_t motor_speed_feedback_update_pll(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+											   uint16_t mechanical_angle_u16)
+{
+	motor_handle_t *motor_h = motor_speed_feedback_h->motor_h;
+
+	/* e = wrap(theta_meas - theta_pred) in full-turn Q32, signed shortest path. */
+	int32_t angle_error_q32 =
+			(int32_t)(((uint32_t)mechanical_angle_u16 << 16) - motor_speed_feedback_h->pll_angle_q32);
+
+	/* PI on the angle error: integrator carries the speed, the P path adds damping. */
+	motor_speed_feedback_h->pll_speed_integrator_q32 =
+			motor_speed_feedback_saturate_i32(
+					(int64_t)motor_speed_feedback_h->pll_speed_integrator_q32 +
+					motor_speed_feedback_mul_q32(angle_error_q32, motor_speed_feedback_h->pll_ki_q32));
+	motor_speed_feedback_h->pll_speed_q32 =
+			motor_speed_feedback_saturate_i32(
+					(int64_t)motor_speed_feedback_h->pll_speed_integrator_q32 +
+					motor_speed_feedback_mul_q32(angle_error_q32, motor_speed_feedback_h->pll_kp_q32));
+
+	/* The predicted angle is the smoothed angle at this sample; advance it by one step. */
+	motor_speed_feedback_h->pll_sample_angle_q32 = motor_speed_feedback_h->pll_angle_q32;
+	motor_speed_feedback_h->pll_angle_q32 += (uint32_t)motor_speed_feedback_h->pll_speed_q32;
+
+	motor_h->speed_feedback.observer_mechanical_angle_u16 =
+			(uint16_t)((motor_speed_feedback_h->pll_sample_angle_q32 + 0x8000u) >> 16);
+	motor_h->speed_feedback.observer_angle_error_counts = (int32_t)(((int64_t)angle_error_q32 + 0x8000) >> 16);
+
+	/* mrpm = step_q32 * (60e9 / dt_us) / 2^32. */
+	return motor_speed_feedback_mul_q32(motor_speed_feedback_h->pll_speed_q32,
+										motor_speed_feedback_h->pll_mrpm_scale_q32);
+}
+
+/**
+ * @brief Derive the LPF coefficient (active tau) and PLL gains for one sample period.
+ *
+ * @param motor_speed_feedback_h Pointer to speed-feedback handle (gains written on success only).
+ * @param motor_speed_feedback_cfg Pointer to speed-feedback configuration.
+ * @param sample_period_us Time between two angle samples.
+ * @return true if the gains are representable, false otherwise.
+ */
+static bool motor_speed_feedback_derive_gains(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+											  const motor_speed_feedback_cfg_t *motor_speed_feedback_cfg,
+											  uint32_t sample_period_us)
+{
 	uint64_t filter_time_constant_us =
-			(uint64_t)motor_speed_feedback_cfg->filter_time_constant_ms * 1000u;
-	uint64_t filter_coeff_den = filter_time_constant_us + sample_period_us;
+			(uint64_t)motor_speed_feedback_h->filter_time_constant_ms * 1000u;
+	uint64_t filter_coeff_den = filter_time_constant_us + (uint64_t)sample_period_us;
 	uint64_t filter_coeff_q15_u64 = 0u;
+	uint64_t pll_kp_q32 = 0u;
+	uint64_t pll_mrpm_scale_q32 = 0u;
+
+	if (sample_period_us == 0u) return false;
 
 	/* Derive k = dt / (tau + dt) in Q15 for the first-order low-pass filter. */
 	if (filter_time_constant_us == 0u)
@@ -54,7 +157,7 @@ bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedba
 	else
 	{
 		filter_coeff_q15_u64 =
-				((sample_period_us * (uint64_t)MOTOR_SPEED_FEEDBACK_Q15_SCALE) +
+				(((uint64_t)sample_period_us * (uint64_t)MOTOR_SPEED_FEEDBACK_Q15_SCALE) +
 				 (filter_coeff_den / 2u)) / filter_coeff_den;
 		if (filter_coeff_q15_u64 == 0u)
 		{
@@ -62,12 +165,63 @@ bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedba
 		}
 	}
 
+	/* Derive the PLL gains for a critically damped loop: kp = 2*wn*dt, ki = (wn*dt)^2. */
+	if (motor_speed_feedback_cfg->mode == MOTOR_SPEED_FEEDBACK_MODE_PLL)
+	{
+		if (motor_speed_feedback_cfg->pll_bandwidth_hz == 0u) return false;
+
+		pll_kp_q32 = (((uint64_t)motor_speed_feedback_cfg->pll_bandwidth_hz * (uint64_t)sample_period_us *
+					   MOTOR_SPEED_FEEDBACK_FOUR_PI_Q32_PER_MHZ_X1000) + 500u) / 1000u;
+		pll_mrpm_scale_q32 = (uint64_t)MOTOR_SPEED_FEEDBACK_MRPM_PER_TURN_PER_US / sample_period_us;
+
+		/* kp >= 1 means the loop is too fast for the sample rate (discrete instability). */
+		if ((pll_kp_q32 == 0u) || (pll_kp_q32 > (uint64_t)UINT32_MAX)) return false;
+		if (pll_mrpm_scale_q32 > (uint64_t)UINT32_MAX) return false;
+	}
+
+	motor_speed_feedback_h->sample_period_us = sample_period_us;
+	motor_speed_feedback_h->filter_coeff_q15 = (uint16_t)filter_coeff_q15_u64;
+	motor_speed_feedback_h->pll_kp_q32 = (uint32_t)pll_kp_q32;
+	motor_speed_feedback_h->pll_ki_q32 = (uint32_t)(((pll_kp_q32 / 2u) * (pll_kp_q32 / 2u)) >> 32);
+	motor_speed_feedback_h->pll_mrpm_scale_q32 = (uint32_t)pll_mrpm_scale_q32;
+#if (MOTOR_SPEED_FEEDBACK_KERNEL == MOTOR_KERNEL_FLOAT32)
+	motor_speed_feedback_h->raw_mrpm_per_count_f32 =
+			(float)MOTOR_SPEED_FEEDBACK_MRPM_PER_TURN_PER_US /
+			((float)MOTOR_SPEED_FEEDBACK_MECHANICAL_TURN_COUNTS_U16 * (float)sample_period_us);
+	motor_speed_feedback_h->filter_coeff_f32 =
+			(float)filter_coeff_q15_u64 * MOTOR_SPEED_FEEDBACK_INV_Q15_SCALE_F32;
+#endif
+
+	return true;
+}
+
+bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+							   const motor_speed_feedback_cfg_t *motor_speed_feedback_cfg)
+{
+	if ((motor_speed_feedback_h == NULL) || (motor_speed_feedback_cfg == NULL)) return false;
+	if (motor_speed_feedback_cfg->motor_h == NULL) return false;
+	if (motor_speed_feedback_cfg->sample_period_us == 0u) return false;
+	if ((motor_speed_feedback_cfg->control_direction_sign != 1) &&
+		(motor_speed_feedback_cfg->control_direction_sign != -1)) return false;
+	if ((motor_speed_feedback_cfg->mode != MOTOR_SPEED_FEEDBACK_MODE_LPF) &&
+		(motor_speed_feedback_cfg->mode != MOTOR_SPEED_FEEDBACK_MODE_PLL)) return false;
+
+	motor_handle_t *motor_h = motor_speed_feedback_cfg->motor_h;
+
+	motor_speed_feedback_h->filter_time_constant_ms = motor_speed_feedback_cfg->filter_time_constant_ms;
+	if (!motor_speed_feedback_derive_gains(motor_speed_feedback_h,
+										   motor_speed_feedback_cfg,
+										   motor_speed_feedback_cfg->sample_period_us))
+	{
+		return false;
+	}
+
 	/* Reset feedback runtime state and shared outputs. */
 	motor_speed_feedback_h->cfg = motor_speed_feedback_cfg;
 	motor_speed_feedback_h->motor_h = motor_h;
-	motor_speed_feedback_h->filter_coeff_q15 = (uint16_t)filter_coeff_q15_u64;
 	motor_speed_feedback_h->previous_mechanical_angle_u16 = 0u;
 	motor_speed_feedback_h->has_previous_mechanical_angle = false;
+	motor_speed_feedback_reset_pll(motor_speed_feedback_h, 0u);
 	motor_speed_feedback_h->is_initialized = true;
 
 	motor_h->speed_feedback.raw_mechanical_speed_mrpm = 0;
@@ -78,6 +232,63 @@ bool motor_speed_feedback_init(motor_speed_feedback_handle_t *motor_speed_feedba
 	return true;
 }
 
+bool motor_speed_feedback_set_sample_period(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+											uint32_t sample_period_us)
+{
+	if ((motor_speed_feedback_h == NULL) || (motor_speed_feedback_h->cfg == NULL)) return false;
+	if (motor_speed_feedback_h->is_initialized == false) return false;
+	if (sample_period_us == 0u) return false;
+
+	uint32_t previous_sample_period_us = motor_speed_feedback_h->sample_period_us;
+
+	if (sample_period_us == previous_sample_period_us) return true;
+	if (!motor_speed_feedback_derive_gains(motor_speed_feedback_h,
+										   motor_speed_feedback_h->cfg,
+										   sample_period_us))
+	{
+		return false;
+	}
+
+	/* The PLL speed is an angle step per sample: rescale it and redo the prediction with the new step. */
+	if ((motor_speed_feedback_h->cfg->mode == MOTOR_SPEED_FEEDBACK_MODE_PLL) &&
+		(motor_speed_feedback_h->has_previous_mechanical_angle == true))
+	{
+		motor_speed_feedback_h->pll_speed_integrator_q32 =
+				motor_speed_feedback_saturate_i32(
+						((int64_t)motor_speed_feedback_h->pll_speed_integrator_q32 * (int64_t)sample_period_us) /
+						(int64_t)previous_sample_period_us);
+		motor_speed_feedback_h->pll_speed_q32 =
+				motor_speed_feedback_saturate_i32(
+						((int64_t)motor_speed_feedback_h->pll_speed_q32 * (int64_t)sample_period_us) /
+						(int64_t)previous_sample_period_us);
+		motor_speed_feedback_h->pll_angle_q32 =
+				motor_speed_feedback_h->pll_sample_angle_q32 + (uint32_t)motor_speed_feedback_h->pll_speed_q32;
+	}
+
+	return true;
+}
+
+bool motor_speed_feedback_set_filter_time_constant(motor_speed_feedback_handle_t *motor_speed_feedback_h,
+													uint16_t filter_time_constant_ms)
+{
+	if ((motor_speed_feedback_h == NULL) || (motor_speed_feedback_h->cfg == NULL)) return false;
+	if (motor_speed_feedback_h->is_initialized == false) return false;
+
+	uint16_t previous_filter_time_constant_ms = motor_speed_feedback_h->filter_time_constant_ms;
+
+	/* Only the LPF coefficient depends on tau; filter state is kept, so the output stays continuous. */
+	motor_speed_feedback_h->filter_time_constant_ms = filter_time_constant_ms;
+	if (!motor_speed_feedback_derive_gains(motor_speed_feedback_h,
+										   motor_speed_feedback_h->cfg,
+										   motor_speed_feedback_h->sample_period_us))
+	{
+		motor_speed_feedback_h->filter_time_constant_ms = previous_filter_time_constant_ms;
+		return false;
+	}
+
+	return true;
+}
+
 bool motor_speed_feedback_update(motor_speed_feedback_handle_t *motor_speed_feedback_h,
 								 uint16_t mechanical_angle_u16)
 {
@@ -87,7 +298,6 @@ bool motor_speed_feedback_update(motor_speed_feedback_handle_t *motor_speed_feed
 
 	motor_handle_t *motor_h = motor_speed_feedback_h->motor_h;
 	int32_t mechanical_angle_delta_counts = 0;
-	int64_t raw_mechanical_speed_num = 0;
 	int64_t raw_mechanical_speed_mrpm = 0;
 	int64_t filter_error_mrpm = 0;
 	int64_t filter_step_mrpm = 0;
@@ -98,6 +308,11 @@ bool motor_speed_feedback_update(motor_speed_feedback_handle_t *motor_speed_feed
 	{
 		motor_speed_feedback_h->previous_mechanical_angle_u16 = mechanical_angle_u16;
 		motor_speed_feedback_h->has_previous_mechanical_angle = true;
+		if (motor_speed_feedback_h->cfg->mode == MOTOR_SPEED_FEEDBACK_MODE_PLL)
+		{
+			/* Lock the observer onto the first sample at zero speed. */
+			motor_speed_feedback_reset_pll(motor_speed_feedback_h, mechanical_angle_u16);
+		}
 		motor_h->speed_feedback.raw_mechanical_speed_mrpm = 0;
 		motor_h->speed_feedback.filtered_mechanical_speed_mrpm = 0;
 		motor_h->measurements.measured_mechanical_speed_mrpm = 0;
@@ -112,7 +327,12 @@ bool motor_speed_feedback_update(motor_speed_feedback_handle_t *motor_speed_feed
 	motor_speed_feedback_h->previous_mechanical_angle_u16 = mechanical_angle_u16;
 
 	/* raw_mrpm = delta_counts * 60e6 * 1000 / (65536 * sample_period_us). */
-	raw_mechanical_speed_num =
+#if (MOTOR_SPEED_FEEDBACK_KERNEL == MOTOR_KERNEL_FLOAT32)
+	raw_mechanical_speed_mrpm =
+			motor_speed_feedback_round_f32((float)mechanical_angle_delta_counts *
+										   motor_speed_feedback_h->raw_mrpm_per_count_f32);
+#else
+	int64_t raw_mechanical_speed_num =
 			(int64_t)mechanical_angle_delta_counts *
 			(int64_t)MOTOR_SPEED_FEEDBACK_US_PER_MINUTE *
 			(int64_t)MOTOR_SPEED_FEEDBACK_MRPM_PER_RPM;
@@ -120,21 +340,37 @@ bool motor_speed_feedback_update(motor_speed_feedback_handle_t *motor_speed_feed
 			motor_speed_feedback_divide_round_nearest(
 					raw_mechanical_speed_num,
 					(int64_t)MOTOR_SPEED_FEEDBACK_MECHANICAL_TURN_COUNTS_U16 *
-					(int64_t)motor_speed_feedback_h->cfg->sample_period_us);
+					(int64_t)motor_speed_feedback_h->sample_period_us);
+#endif
 
 	/* Apply the project control-direction sign before publishing and filtering speed. */
 	raw_mechanical_speed_mrpm *= (int64_t)motor_speed_feedback_h->cfg->control_direction_sign;
 
-	/* Apply y += k * (x - y) with fixed-point Q15 coefficient k. */
-	filter_error_mrpm =
-			raw_mechanical_speed_mrpm -
-			(int64_t)motor_h->speed_feedback.filtered_mechanical_speed_mrpm;
-	filter_step_mrpm =
-			motor_speed_feedback_divide_round_nearest(
-					filter_error_mrpm * (int64_t)motor_speed_feedback_h->filter_coeff_q15,
-					(int64_t)MOTOR_SPEED_FEEDBACK_Q15_SCALE);
-	filtered_mechanical_speed_mrpm =
-			(int64_t)motor_h->speed_feedback.filtered_mechanical_speed_mrpm + filter_step_mrpm;
+	if (motor_speed_feedback_h->cfg->mode == MOTOR_SPEED_FEEDBACK_MODE_PLL)
+	{
+		/* The PLL observer replaces the LPF; raw speed stays published for comparison. */
+		filtered_mechanical_speed_mrpm =
+				motor_speed_feedback_update_pll(motor_speed_feedback_h, mechanical_angle_u16) *
+				(int64_t)motor_speed_feedback_h->cfg->control_direction_sign;
+	}
+	else
+	{
+		/* Apply y += k * (x - y) with fixed-point Q15 coefficient k. */
+		filter_error_mrpm =
+				raw_mechanical_speed_mrpm -
+				(int64_t)motor_h->speed_feedback.filtered_mechanical_speed_mrpm;
+#if (MOTOR_SPEED_FEEDBACK_KERNEL == MOTOR_KERNEL_FLOAT32)
+		filter_step_mrpm =
+				motor_speed_feedback_round_f32((float)filter_error_mrpm * motor_speed_feedback_h->filter_coeff_f32);
+#else
+		filter_step_mrpm =
+				motor_speed_feedback_divide_round_nearest(
+						filter_error_mrpm * (int64_t)motor_speed_feedback_h->filter_coeff_q15,
+						(int64_t)MOTOR_SPEED_FEEDBACK_Q15_SCALE);
+#endif
+		filtered_mechanical_speed_mrpm =
+				(int64_t)motor_h->speed_feedback.filtered_mechanical_speed_mrpm + filter_step_mrpm;
+	}
 
 	/* Publish raw and filtered speed in shared motor state. */
 	motor_h->speed_feedback.raw_mechanical_speed_mrpm = (int32_t)raw_mechanical_speed_mrpm;
@@ -2,13 +2,28 @@
  * @file motor_speed_pi.c
  * @brief Digital PI controller for mechanical speed.
  *
+ *  Notes:
+ *  - output = P + I + FF; FF is limited to its own budget first, so a large
+ *    feedforward never takes the whole output range away from P + I.
+ *  - the integrator range is shifted by FF: I stays within the authority
+ *    that is left once feedforward is applied, which keeps windup bounded
+ *    at reversals when FF changes sign.
+ *  - MOTOR_SPEED_PI_KERNEL = MOTOR_KERNEL_FLOAT32 computes the P, I, FF and
+ *    Iq terms and the gain interpolation in float; the integrator and every
+ *    published term stay integer permyriad, rounded like the fixed kernel.
  */
 
 #include "motor/motor_speed_pi.h"
+#include "motor/motor_kernel.h"
+#include "drivers/memory_section.h"
 #include <stddef.h>
 
 #define MOTOR_SPEED_PI_Q15_SCALE             32768LL
 #define MOTOR_SPEED_PI_MS_PER_SECOND         1000LL
+#define MOTOR_SPEED_PI_PERMYRIAD_SCALE       10000LL
+#define MOTOR_SPEED_PI_INV_Q15_SCALE_F32     (1.0f / 32768.0f)
+#define MOTOR_SPEED_PI_INV_PERMYRIAD_F32     (1.0f / 10000.0f)
+#define MOTOR_SPEED_PI_TERM_LIMIT_F32        1073741824.0f	/* 2^30, far beyond any output limit */
 
 /**
  * @brief Divide one signed integer and round to nearest integer.
@@ -17,6 +32,7 @@
  * @param denominator Positive denominator.
  * @return Rounded signed integer quotient.
  */
+MEMORY_SECTION_RAMFUNC
 static int64_t motor_speed_pi_divide_round_nearest(int64_t numerator,
 												   int64_t denominator)
 {
@@ -28,6 +44,49 @@ static int64_t motor_speed_pi_divide_round_nearest(int64_t numerator,
 	return (numerator - (denominator / 2LL)) / denominator;
 }
 
+#if (MOTOR_SPEED_PI_KERNEL == MOTOR_KERNEL_FLOAT32)
+/**
+ * @brief Round one float term to nearest integer (ties away from zero) within +/-2^30.
+ *
+ * @param value Term value.
+ * @return Rounded term, the same rounding as the fixed kernel's divisions.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_speed_pi_round_f32(float value)
+{
+	if (value > MOTOR_SPEED_PI_TERM_LIMIT_F32) value = MOTOR_SPEED_PI_TERM_LIMIT_F32;
+	if (value < -MOTOR_SPEED_PI_TERM_LIMIT_F32) value = -MOTOR_SPEED_PI_TERM_LIMIT_F32;
+	return (value >= 0.0f) ? (int32_t)(value + 0.5f) : (int32_t)(value - 0.5f);
+}
+
+/**
+ * @brief Scale one value by one Q15 gain and round (float kernel).
+ *
+ * @param gain_q15 Gain in Q15.
+ * @param value Signed value.
+ * @return Rounded gain * value / 2^15.
+ */
+MEMORY_SECTION_RAMFUNC
+static int64_t motor_speed_pi_mul_q15(int32_t gain_q15, int32_t value)
+{
+	return (int64_t)motor_speed_pi_round_f32((float)gain_q15 * (float)value * MOTOR_SPEED_PI_INV_Q15_SCALE_F32);
+}
+#else
+/**
+ * @brief Scale one value by one Q15 gain and round.
+ *
+ * @param gain_q15 Gain in Q15.
+ * @param value Signed value.
+ * @return Rounded gain * value / 2^15.
+ */
+MEMORY_SECTION_RAMFUNC
+static int64_t motor_speed_pi_mul_q15(int32_t gain_q15, int32_t value)
+{
+	return motor_speed_pi_divide_round_nearest((int64_t)gain_q15 * (int64_t)value,
+											   (int64_t)MOTOR_SPEED_PI_Q15_SCALE);
+}
+#endif
+
 /**
  * @brief Clamp one signed integer into an inclusive range.
  *
@@ -36,6 +95,7 @@ static int64_t motor_speed_pi_divide_round_nearest(int64_t numerator,
  * @param maximum Maximum allowed value.
  * @return Clamped value.
  */
+MEMORY_SECTION_RAMFUNC
 static int32_t motor_speed_pi_clamp_i32(int64_t value,
 										int32_t minimum,
 										int32_t maximum)
@@ -53,6 +113,157 @@ static int32_t motor_speed_pi_clamp_i32(int64_t value,
 	return (int32_t)value;
 }
 
+/**
+ * @brief Compute the limited feedforward term from the reference.
+ *
+ * @param cfg Pointer to speed PI configuration.
+ * @param target_mechanical_speed_mrpm Reference speed in mrpm.
+ * @param target_mechanical_acceleration_mrpm_per_s Reference acceleration in mrpm/s.
+ * @return Feedforward in permyriad within +/-ff_limit_permyriad.
+ */
+MEMORY_SECTION_RAMFUNC
+static int32_t motor_speed_pi_feedforward(const motor_speed_pi_cfg_t *cfg,
+										  int32_t target_mechanical_speed_mrpm,
+										  int32_t target_mechanical_acceleration_mrpm_per_s)
+{
+	const int32_t ff_limit = (int32_t)cfg->ff_limit_permyriad;
+	int64_t feedforward_permyriad = 0;
+
+	if (ff_limit == 0) return 0;
+
+#if (MOTOR_SPEED_PI_KERNEL == MOTOR_KERNEL_FLOAT32)
+	feedforward_permyriad =
+			(int64_t)motor_speed_pi_round_f32(
+					(((float)cfg->ff_speed_q15 * (float)target_mechanical_speed_mrpm) +
+					 ((float)cfg->ff_acceleration_q15 * (float)target_mechanical_acceleration_mrpm_per_s)) *
+					MOTOR_SPEED_PI_INV_Q15_SCALE_F32);
+#else
+	feedforward_permyriad =
+			motor_speed_pi_divide_round_nearest(
+					((int64_t)cfg->ff_speed_q15 * (int64_t)target_mechanical_speed_mrpm) +
+					((int64_t)cfg->ff_acceleration_q15 * (int64_t)target_mechanical_acceleration_mrpm_per_s),
+					(int64_t)MOTOR_SPEED_PI_Q15_SCALE);
+#endif
+
+	if (target_mechanical_speed_mrpm > (int32_t)cfg->ff_friction_deadband_mrpm)
+	{
+		feedforward_permyriad += (int64_t)cfg->ff_friction_permyriad;
+	}
+	else if (target_mechanical_speed_mrpm < -(int32_t)cfg->ff_friction_deadband_mrpm)
+	{
+		feedforward_permyriad -= (int64_t)cfg->ff_friction_permyriad;
+	}
+
+	return motor_speed_pi_clamp_i32(feedforward_permyriad, -ff_limit, ff_limit);
+}
+
+/**
+ * @brief Convert continuous-time Ki into one fixed-period discrete gain.
+ *
+ * @param ki_per_s_q15 Integral gain in Q15 per second.
+ * @param update_period_ms Update period in milliseconds.
+ * @return Discrete integral gain in Q15.
+ */
+static int32_t motor_speed_pi_discretize_ki(int32_t ki_per_s_q15, uint16_t update_period_ms)
+{
+	return (int32_t)motor_speed_pi_divide_round_nearest((int64_t)ki_per_s_q15 * (int64_t)update_period_ms,
+														(int64_t)MOTOR_SPEED_PI_MS_PER_SECOND);
+}
+
+/**
+ * @brief Interpolate Kp and discrete Ki at one |speed|.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param measured_mechanical_speed_mrpm Measured speed in mrpm.
+ * @param kp_q15 Output proportional gain.
+ * @param ki_dt_q15 Output discrete integral gain.
+ */
+MEMORY_SECTION_RAMFUNC
+static void motor_speed_pi_scheduled_gains(const motor_speed_pi_handle_t *motor_speed_pi_h,
+										   int32_t measured_mechanical_speed_mrpm,
+										   int32_t *kp_q15,
+										   int32_t *ki_dt_q15)
+{
+	uint8_t count = motor_speed_pi_h->gain_point_count;
+	uint32_t speed_mrpm = (measured_mechanical_speed_mrpm >= 0) ?
+						  (uint32_t)measured_mechanical_speed_mrpm :
+						  (uint32_t)(-(int64_t)measured_mechanical_speed_mrpm);
+	uint8_t upper = 1u;
+
+	if (count == 0u)
+	{
+		*kp_q15 = motor_speed_pi_h->cfg->kp_q15;
+		*ki_dt_q15 = motor_speed_pi_h->ki_dt_q15;
+		return;
+	}
+	if ((count == 1u) || (speed_mrpm <= motor_speed_pi_h->gain_speed_mrpm[0]))
+	{
+		*kp_q15 = motor_speed_pi_h->gain_kp_q15[0];
+		*ki_dt_q15 = motor_speed_pi_h->gain_ki_dt_q15[0];
+		return;
+	}
+	if (speed_mrpm >= motor_speed_pi_h->gain_speed_mrpm[count - 1u])
+	{
+		*kp_q15 = motor_speed_pi_h->gain_kp_q15[count - 1u];
+		*ki_dt_q15 = motor_speed_pi_h->gain_ki_dt_q15[count - 1u];
+		return;
+	}
+
+	while (speed_mrpm > motor_speed_pi_h->gain_speed_mrpm[upper]) upper++;
+
+#if (MOTOR_SPEED_PI_KERNEL == MOTOR_KERNEL_FLOAT32)
+	/* One reciprocal for both gains instead of two int64 divisions. */
+	float fraction = (float)(speed_mrpm - motor_speed_pi_h->gain_speed_mrpm[upper - 1u]) /
+					 (float)(motor_speed_pi_h->gain_speed_mrpm[upper] - motor_speed_pi_h->gain_speed_mrpm[upper - 1u]);
+
+	*kp_q15 = motor_speed_pi_h->gain_kp_q15[upper - 1u] +
+			  motor_speed_pi_round_f32((float)(motor_speed_pi_h->gain_kp_q15[upper] -
+											   motor_speed_pi_h->gain_kp_q15[upper - 1u]) * fraction);
+	*ki_dt_q15 = motor_speed_pi_h->gain_ki_dt_q15[upper - 1u] +
+				 motor_speed_pi_round_f32((float)(motor_speed_pi_h->gain_ki_dt_q15[upper] -
+												  motor_speed_pi_h->gain_ki_dt_q15[upper - 1u]) * fraction);
+#else
+	int64_t span_mrpm = (int64_t)motor_speed_pi_h->gain_speed_mrpm[upper] -
+						(int64_t)motor_speed_pi_h->gain_speed_mrpm[upper - 1u];
+	int64_t offset_mrpm = (int64_t)speed_mrpm - (int64_t)motor_speed_pi_h->gain_speed_mrpm[upper - 1u];
+
+	*kp_q15 = motor_speed_pi_h->gain_kp_q15[upper - 1u] +
+			  (int32_t)motor_speed_pi_divide_round_nearest(
+					  ((int64_t)motor_speed_pi_h->gain_kp_q15[upper] -
+					   (int64_t)motor_speed_pi_h->gain_kp_q15[upper - 1u]) * offset_mrpm,
+					  span_mrpm);
+	*ki_dt_q15 = motor_speed_pi_h->gain_ki_dt_q15[upper - 1u] +
+				 (int32_t)motor_speed_pi_divide_round_nearest(
+						 ((int64_t)motor_speed_pi_h->gain_ki_dt_q15[upper] -
+						  (int64_t)motor_speed_pi_h->gain_ki_dt_q15[upper - 1u]) * offset_mrpm,
+						 span_mrpm);
+#endif
+}
+
+/**
+ * @brief Publish one limited command and its current-mode Iq reference.
+ *
+ * @param motor_speed_pi_h Pointer to speed PI handle.
+ * @param uq_command_permyriad Limited command in permyriad.
+ */
+MEMORY_SECTION_RAMFUNC
+static void motor_speed_pi_publish_command(motor_speed_pi_handle_t *motor_speed_pi_h, int32_t uq_command_permyriad)
+{
+	motor_handle_t *motor_h = motor_speed_pi_h->motor_h;
+
+	motor_h->speed_pi.speed_control_uq_command_permyriad = uq_command_permyriad;
+#if (MOTOR_SPEED_PI_KERNEL == MOTOR_KERNEL_FLOAT32)
+	motor_h->speed_pi.speed_control_iq_reference_ma =
+			motor_speed_pi_round_f32((float)uq_command_permyriad * (float)motor_speed_pi_h->cfg->current_limit_ma *
+									 MOTOR_SPEED_PI_INV_PERMYRIAD_F32);
+#else
+	motor_h->speed_pi.speed_control_iq_reference_ma =
+			(int32_t)motor_speed_pi_divide_round_nearest(
+					(int64_t)uq_command_permyriad * (int64_t)motor_speed_pi_h->cfg->current_limit_ma,
+					MOTOR_SPEED_PI_PERMYRIAD_SCALE);
+#endif
+}
+
 bool motor_speed_pi_init(motor_speed_pi_handle_t *motor_speed_pi_h,
 						 const motor_speed_pi_cfg_t *motor_speed_pi_cfg)
 {
@@ -60,24 +271,34 @@ bool motor_speed_pi_init(motor_speed_pi_handle_t *motor_speed_pi_h,
 	if (motor_speed_pi_cfg->motor_h == NULL) return false;
 	if (motor_speed_pi_cfg->update_period_ms == 0u) return false;
 	if (motor_speed_pi_cfg->output_limit_permyriad == 0u) return false;
+	if (motor_speed_pi_cfg->current_limit_ma < 0) return false;
+	if (motor_speed_pi_cfg->ff_limit_permyriad > motor_speed_pi_cfg->output_limit_permyriad) return false;
 
 	motor_handle_t *motor_h = motor_speed_pi_cfg->motor_h;
-	int64_t ki_dt_q15 =
-			motor_speed_pi_divide_round_nearest(
-					(int64_t)motor_speed_pi_cfg->ki_per_s_q15 *
-					(int64_t)motor_speed_pi_cfg->update_period_ms,
-					(int64_t)MOTOR_SPEED_PI_MS_PER_SECOND);
 
 	/* Convert continuous-time Ki into one fixed-period discrete gain. */
 	motor_speed_pi_h->cfg = motor_speed_pi_cfg;
 	motor_speed_pi_h->motor_h = motor_h;
-	motor_speed_pi_h->ki_dt_q15 = (int32_t)ki_dt_q15;
+	motor_speed_pi_h->ki_dt_q15 = motor_speed_pi_discretize_ki(motor_speed_pi_cfg->ki_per_s_q15,
+															   motor_speed_pi_cfg->update_period_ms);
 	motor_speed_pi_h->integrator_term_permyriad = 0;
+	motor_speed_pi_h->output_limit_permyriad = motor_speed_pi_cfg->output_limit_permyriad;
+	motor_speed_pi_h->gain_point_count = 0u;
 	motor_speed_pi_h->is_initialized = true;
 
+	if (!motor_speed_pi_set_gain_table(motor_speed_pi_h,
+									   motor_speed_pi_cfg->gain_table,
+									   motor_speed_pi_cfg->gain_table_count))
+	{
+		motor_speed_pi_h->is_initialized = false;
+		return false;
+	}
+
 	motor_h->speed_pi.speed_error_mrpm = 0;
 	motor_h->speed_pi.integrator_term_permyriad = 0;
+	motor_h->speed_pi.feedforward_term_permyriad = 0;
 	motor_h->speed_pi.speed_control_uq_command_permyriad = 0;
+	motor_h->speed_pi.speed_control_iq_reference_ma = 0;
 
 	return true;
 }
@@ -90,15 +311,20 @@ bool motor_speed_pi_reset(motor_speed_pi_handle_t *motor_speed_pi_h)
 
 	/* Reset the PI runtime state and published control command. */
 	motor_speed_pi_h->integrator_term_permyriad = 0;
+	motor_speed_pi_h->output_limit_permyriad = motor_speed_pi_h->cfg->output_limit_permyriad;
 	motor_speed_pi_h->motor_h->speed_pi.speed_error_mrpm = 0;
 	motor_speed_pi_h->motor_h->speed_pi.integrator_term_permyriad = 0;
+	motor_speed_pi_h->motor_h->speed_pi.feedforward_term_permyriad = 0;
 	motor_speed_pi_h->motor_h->speed_pi.speed_control_uq_command_permyriad = 0;
+	motor_speed_pi_h->motor_h->speed_pi.speed_control_iq_reference_ma = 0;
 
 	return true;
 }
 
+MEMORY_SECTION_RAMFUNC
 bool motor_speed_pi_update(motor_speed_pi_handle_t *motor_speed_pi_h,
 						   int32_t target_mechanical_speed_mrpm,
+						   int32_t target_mechanical_acceleration_mrpm_per_s,
 						   int32_t measured_mechanical_speed_mrpm)
 {
 	if (motor_speed_pi_h == NULL) return false;
@@ -106,34 +332,43 @@ bool motor_speed_pi_update(motor_speed_pi_handle_t *motor_speed_pi_h,
 	if (motor_speed_pi_h->is_initialized == false) return false;
 
 	motor_handle_t *motor_h = motor_speed_pi_h->motor_h;
-	const int32_t output_limit = (int32_t)motor_speed_pi_h->cfg->output_limit_permyriad;
+	const int32_t output_limit = (int32_t)motor_speed_pi_h->output_limit_permyriad;
 	int32_t speed_error_mrpm =
 			target_mechanical_speed_mrpm - measured_mechanical_speed_mrpm;
-	int64_t proportional_term_permyriad =
-			motor_speed_pi_divide_round_nearest(
-					(int64_t)motor_speed_pi_h->cfg->kp_q15 * (int64_t)speed_error_mrpm,
-					(int64_t)MOTOR_SPEED_PI_Q15_SCALE);
-	int64_t integrator_step_permyriad =
-			motor_speed_pi_divide_round_nearest(
-					(int64_t)motor_speed_pi_h->ki_dt_q15 * (int64_t)speed_error_mrpm,
-					(int64_t)MOTOR_SPEED_PI_Q15_SCALE);
+	int32_t kp_q15 = 0;
+	int32_t ki_dt_q15 = 0;
+
+	motor_speed_pi_scheduled_gains(motor_speed_pi_h, measured_mechanical_speed_mrpm, &kp_q15, &ki_dt_q15);
+
+	/* A runtime limit below the feedforward budget (field weakening) also bounds the feedforward. */
+	int32_t feedforward_permyriad =
+			motor_speed_pi_clamp_i32(motor_speed_pi_feedforward(motor_speed_pi_h->cfg,
+																target_mechanical_speed_mrpm,
+																target_mechanical_acceleration_mrpm_per_s),
+									 -output_limit, output_limit);
+	/* Integrator authority left after feedforward: I + FF and I alone stay within the output limit. */
+	int32_t integrator_max_permyriad = (feedforward_permyriad > 0) ? (output_limit - feedforward_permyriad) : output_limit;
+	int32_t integrator_min_permyriad = (feedforward_permyriad < 0) ? (-output_limit - feedforward_permyriad) : -output_limit;
+	int64_t proportional_term_permyriad = motor_speed_pi_mul_q15(kp_q15, speed_error_mrpm);
+	int64_t integrator_step_permyriad = motor_speed_pi_mul_q15(ki_dt_q15, speed_error_mrpm);
 	int64_t integrator_candidate_permyriad =
 			(int64_t)motor_speed_pi_h->integrator_term_permyriad +
 			integrator_step_permyriad;
 	int64_t output_candidate_permyriad =
-			proportional_term_permyriad + integrator_candidate_permyriad;
+			proportional_term_permyriad + integrator_candidate_permyriad + (int64_t)feedforward_permyriad;
 
 	/* Apply conditional integration when saturation would grow in the same direction as error. */
 	if (((output_candidate_permyriad > (int64_t)output_limit) && (speed_error_mrpm > 0)) ||
 		((output_candidate_permyriad < (int64_t)(-output_limit)) && (speed_error_mrpm < 0)))
 	{
 		integrator_candidate_permyriad = (int64_t)motor_speed_pi_h->integrator_term_permyriad;
-		output_candidate_permyriad = proportional_term_permyriad + integrator_candidate_permyriad;
+		output_candidate_permyriad =
+				proportional_term_permyriad + integrator_candidate_permyriad + (int64_t)feedforward_permyriad;
 	}
 
 	/* Keep integrator clamping separate from final output clamping for clean anti-windup state. */
 	int32_t clamped_integrator_permyriad =
-			motor_speed_pi_clamp_i32(integrator_candidate_permyriad, -output_limit, output_limit);
+			motor_speed_pi_clamp_i32(integrator_candidate_permyriad, integrator_min_permyriad, integrator_max_permyriad);
 	int32_t speed_control_uq_command_permyriad =
 			motor_speed_pi_clamp_i32(output_candidate_permyriad, -output_limit, output_limit);
 
@@ -141,7 +376,98 @@ bool motor_speed_pi_update(motor_speed_pi_handle_t *motor_speed_pi_h,
 	motor_speed_pi_h->integrator_term_permyriad = clamped_integrator_permyriad;
 	motor_h->speed_pi.speed_error_mrpm = speed_error_mrpm;
 	motor_h->speed_pi.integrator_term_permyriad = clamped_integrator_permyriad;
-	motor_h->speed_pi.speed_control_uq_command_permyriad = speed_control_uq_command_permyriad;
+	motor_h->speed_pi.feedforward_term_permyriad = feedforward_permyriad;
+	motor_speed_pi_publish_command(motor_speed_pi_h, speed_control_uq_command_permyriad);
+
+	return true;
+}
+
+bool motor_speed_pi_set_gain_table(motor_speed_pi_handle_t *motor_speed_pi_h,
+								   const motor_speed_pi_gain_point_t *gain_table,
+								   uint8_t gain_table_count)
+{
+	if ((motor_speed_pi_h == NULL) || (motor_speed_pi_h->is_initialized == false)) return false;
+	if (gain_table_count > MOTOR_SPEED_PI_GAIN_TABLE_MAX_POINTS) return false;
+	if ((gain_table_count != 0u) && (gain_table == NULL)) return false;
+	for (uint8_t i = 0u; i < gain_table_count; i++)
+	{
+		if ((gain_table[i].kp_q15 < 0) || (gain_table[i].ki_per_s_q15 < 0)) return false;
+		if ((i > 0u) && (gain_table[i].speed_mrpm <= gain_table[i - 1u].speed_mrpm)) return false;
+	}
+
+	for (uint8_t i = 0u; i < gain_table_count; i++)
+	{
+		motor_speed_pi_h->gain_speed_mrpm[i] = gain_table[i].speed_mrpm;
+		motor_speed_pi_h->gain_kp_q15[i] = gain_table[i].kp_q15;
+		motor_speed_pi_h->gain_ki_dt_q15[i] = motor_speed_pi_discretize_ki(gain_table[i].ki_per_s_q15,
+																		   motor_speed_pi_h->cfg->update_period_ms);
+	}
+	motor_speed_pi_h->gain_point_count = gain_table_count;
+
+	return true;
+}
+
+bool motor_speed_pi_scale_gain_table(motor_speed_pi_handle_t *motor_speed_pi_h,
+									 int32_t kp_num,
+									 int32_t kp_den,
+									 int32_t ki_num,
+									 int32_t ki_den)
+{
+	if ((motor_speed_pi_h == NULL) || (motor_speed_pi_h->is_initialized == false)) return false;
+	if ((kp_num < 0) || (kp_den <= 0) || (ki_num < 0) || (ki_den <= 0)) return false;
+
+	/* Discrete Ki is linear in Ki, so it scales in place. */
+	for (uint8_t i = 0u; i < motor_speed_pi_h->gain_point_count; i++)
+	{
+		motor_speed_pi_h->gain_kp_q15[i] = motor_speed_pi_clamp_i32(
+				motor_speed_pi_divide_round_nearest((int64_t)motor_speed_pi_h->gain_kp_q15[i] * (int64_t)kp_num,
+													(int64_t)kp_den),
+				0, INT32_MAX);
+		motor_speed_pi_h->gain_ki_dt_q15[i] = motor_speed_pi_clamp_i32(
+				motor_speed_pi_divide_round_nearest((int64_t)motor_speed_pi_h->gain_ki_dt_q15[i] * (int64_t)ki_num,
+													(int64_t)ki_den),
+				0, INT32_MAX);
+	}
+
+	return true;
+}
+
+bool motor_speed_pi_set_manual_output(motor_speed_pi_handle_t *motor_speed_pi_h,
+									  int32_t uq_command_permyriad)
+{
+	if ((motor_speed_pi_h == NULL) || (motor_speed_pi_h->is_initialized == false)) return false;
+
+	const int32_t output_limit = (int32_t)motor_speed_pi_h->output_limit_permyriad;
+	int32_t command_permyriad = motor_speed_pi_clamp_i32((int64_t)uq_command_permyriad, -output_limit, output_limit);
+
+	/* Track the command in the integrator so closed-loop control resumes bumplessly. */
+	motor_speed_pi_h->integrator_term_permyriad = command_permyriad;
+	motor_speed_pi_h->motor_h->speed_pi.speed_error_mrpm = 0;
+	motor_speed_pi_h->motor_h->speed_pi.integrator_term_permyriad = command_permyriad;
+	motor_speed_pi_h->motor_h->speed_pi.feedforward_term_permyriad = 0;
+	motor_speed_pi_publish_command(motor_speed_pi_h, command_permyriad);
+
+	return true;
+}
+
+bool motor_speed_pi_set_output_limit(motor_speed_pi_handle_t *motor_speed_pi_h,
+									 uint16_t output_limit_permyriad)
+{
+	if ((motor_speed_pi_h == NULL) || (motor_speed_pi_h->is_initialized == false)) return false;
+
+	/* Never above the configured limit, never zero (the loop keeps some authority). */
+	if (output_limit_permyriad > motor_speed_pi_h->cfg->output_limit_permyriad)
+	{
+		output_limit_permyriad = motor_speed_pi_h->cfg->output_limit_permyriad;
+	}
+	if (output_limit_permyriad == 0u) output_limit_permyriad = 1u;
+
+	/* Pull the integrator inside the new limit at once: no wound-up state when the limit shrinks. */
+	const int32_t output_limit = (int32_t)output_limit_permyriad;
+	motor_speed_pi_h->output_limit_permyriad = output_limit_permyriad;
+	motor_speed_pi_h->integrator_term_permyriad =
+			motor_speed_pi_clamp_i32((int64_t)motor_speed_pi_h->integrator_term_permyriad, -output_limit, output_limit);
+	motor_speed_pi_h->motor_h->speed_pi.integrator_term_permyriad = motor_speed_pi_h->integrator_term_permyriad;
 
 	return true;
 }
@@ -6,15 +6,30 @@
  * samples. It is meant for comparison and diagnostic baseline work during
  * open-loop and future closed-loop evaluation, not as the intended fast
  * primary control-loop speed feedback path.
+ *
+ * The least-squares slope uses incremental integer sums relative to the
+ * oldest retained sample: each update drops the oldest point, shifts the
+ * origin to the next oldest point and adds the newest one (O(1), no double).
+ * The sums are exact, so the result matches the former double-precision
+ * full-window pass within +/-1 mrpm (final normalization and rounding only).
+ * MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL = MOTOR_KERNEL_FLOAT32 replaces that
+ * last normalization and int64 division with one float division of the
+ * exact sums (relative error about 1e-7 of the speed).
+ * History timestamps and angles are wrapping 32-bit values: every window
+ * term is a difference to the origin, taken in modulo 2^32 arithmetic.
  */
 
 #include "motor/motor_speed_reference_estimator.h"
+#include "motor/motor_kernel.h"
 #include <stddef.h>
 
-#define MOTOR_SPEED_ESTIMATOR_MECHANICAL_TURN_COUNTS_U16  65536LL
-#define MOTOR_SPEED_ESTIMATOR_MRPM_PER_RPM                1000LL
-#define MOTOR_SPEED_ESTIMATOR_US_PER_MINUTE               60000000LL
-#define MOTOR_SPEED_ESTIMATOR_REGRESSION_DENOM_EPSILON    1e-12
+/* counts/us -> mrpm = 60e6 us/min * 1000 mrpm/rpm / 65536 counts/turn, reduced to 58593750 / 64. */
+#define MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_NUM              58593750LL
+#define MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_DEN              64LL
+/* Normalize the slope fraction below this denominator so numerator * scale fits int64. */
+#define MOTOR_SPEED_ESTIMATOR_DENOM_NORMALIZE_LIMIT       (1LL << 31)
+#define MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_F32              (58593750.0f / 64.0f)
+#define MOTOR_SPEED_ESTIMATOR_SPEED_LIMIT_F32             2147483520.0f	/* largest float below 2^31 */
 
 /**
  * @brief Compute signed shortest-path delta between two uint16 full-turn angles.
@@ -29,12 +44,63 @@ static int32_t motor_speed_reference_estimator_angle_delta_u16(uint16_t current_
 	return (int32_t)((int16_t)((uint16_t)(current_mechanical_angle_u16 - previous_mechanical_angle_u16)));
 }
 
+#if (MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL == MOTOR_KERNEL_FIXED)
+/**
+ * @brief Divide one signed integer and round to nearest integer.
+ *
+ * @param numerator Signed numerator.
+ * @param denominator Positive denominator.
+ * @return Rounded signed quotient.
+ */
+static int64_t motor_speed_reference_estimator_divide_round_nearest(int64_t numerator,
+																	int64_t denominator)
+{
+	if (numerator >= 0)
+	{
+		return (numerator + (denominator / 2LL)) / denominator;
+	}
+
+	return (numerator - (denominator / 2LL)) / denominator;
+}
+#endif
+
+/**
+ * @brief Shift the regression origin by one (dx, dy) step with exact integer sums.
+ *
+ * With x' = x - dx and y' = y - dy over n points:
+ * sum_xx' = sum_xx - 2 dx sum_x + n dx^2
+ * sum_xy' = sum_xy - dx sum_y - dy sum_x + n dx dy
+ * sum_x'  = sum_x - n dx, sum_y' = sum_y - n dy
+ *
+ * @param state Pointer to reference-estimator state.
+ * @param delta_x_us Origin shift in microseconds.
+ * @param delta_y_counts Origin shift in unwrapped angle counts.
+ */
+static void motor_speed_reference_estimator_shift_origin(motor_speed_reference_estimator_state_t *state,
+														 int64_t delta_x_us,
+														 int64_t delta_y_counts)
+{
+	int64_t point_count = (int64_t)state->regression_point_count;
+
+	state->regression_sum_xx_us2 += (point_count * delta_x_us * delta_x_us) -
+									(2LL * delta_x_us * state->regression_sum_x_us);
+	state->regression_sum_xy_us_counts += (point_count * delta_x_us * delta_y_counts) -
+										  (delta_x_us * state->regression_sum_y_counts) -
+										  (delta_y_counts * state->regression_sum_x_us);
+	state->regression_sum_x_us -= point_count * delta_x_us;
+	state->regression_sum_y_counts -= point_count * delta_y_counts;
+}
+
 bool motor_speed_reference_estimator_init(
 		motor_speed_reference_estimator_handle_t *motor_speed_reference_estimator_h,
 		const motor_speed_reference_estimator_cfg_t *motor_speed_reference_estimator_cfg)
 {
 	if ((motor_speed_reference_estimator_h == NULL) || (motor_speed_reference_estimator_cfg == NULL)) return false;
-	if (motor_speed_reference_estimator_cfg->motor_h == NULL) return false;
+	if ((motor_speed_reference_estimator_cfg->motor_h == NULL) ||
+		(motor_speed_reference_estimator_cfg->history == NULL))
+	{
+		return false;
+	}
 	if (motor_speed_reference_estimator_cfg->history_sample_count == 0u) return false;
 	if (motor_speed_reference_estimator_cfg->history_sample_count > MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES) return false;
 
@@ -43,10 +109,11 @@ bool motor_speed_reference_estimator_init(
 	/* Reset the sliding reference window state and the published speed output. */
 	motor_speed_reference_estimator_h->cfg = motor_speed_reference_estimator_cfg;
 	motor_speed_reference_estimator_h->motor_h = motor_h;
+	motor_speed_reference_estimator_h->history = motor_speed_reference_estimator_cfg->history;
 	for (uint16_t i = 0u; i < MOTOR_SPEED_ESTIMATOR_HISTORY_BUFFER_SIZE; i++)
 	{
-		motor_h->speed_reference_estimator.sample_timestamp_history_us[i] = 0u;
-		motor_h->speed_reference_estimator.cumulative_unwrapped_angle_history_counts[i] = 0;
+		motor_speed_reference_estimator_h->history->sample_timestamp_us[i] = 0u;
+		motor_speed_reference_estimator_h->history->cumulative_unwrapped_angle_counts[i] = 0u;
 	}
 
 	motor_h->speed_reference_estimator.history_write_index = 0u;
@@ -56,7 +123,13 @@ bool motor_speed_reference_estimator_init(
 	motor_h->speed_reference_estimator.has_previous_raw_mechanical_angle = false;
 	motor_h->speed_reference_estimator.last_mechanical_angle_delta_counts = 0;
 	motor_h->speed_reference_estimator.last_elapsed_time_us = 0u;
-	motor_h->speed_reference_estimator.cumulative_unwrapped_mechanical_angle_counts = 0;
+	motor_h->speed_reference_estimator.cumulative_unwrapped_mechanical_angle_counts = 0u;
+	motor_h->speed_reference_estimator.regression_origin_index = 0u;
+	motor_h->speed_reference_estimator.regression_point_count = 0u;
+	motor_h->speed_reference_estimator.regression_sum_x_us = 0;
+	motor_h->speed_reference_estimator.regression_sum_y_counts = 0;
+	motor_h->speed_reference_estimator.regression_sum_xx_us2 = 0;
+	motor_h->speed_reference_estimator.regression_sum_xy_us_counts = 0;
 	motor_h->measurements.measured_mechanical_speed_mrpm = 0;
 	motor_h->status.has_valid_mechanical_speed = false;
 	motor_speed_reference_estimator_h->is_initialized = true;
@@ -70,7 +143,12 @@ bool motor_speed_reference_estimator_update(
 		uint64_t sample_timestamp_us)
 {
 	if (motor_speed_reference_estimator_h == NULL) return false;
-	if ((motor_speed_reference_estimator_h->cfg == NULL) || (motor_speed_reference_estimator_h->motor_h == NULL)) return false;
+	if ((motor_speed_reference_estimator_h->cfg == NULL) ||
+		(motor_speed_reference_estimator_h->motor_h == NULL) ||
+		(motor_speed_reference_estimator_h->history == NULL))
+	{
+		return false;
+	}
 	if (motor_speed_reference_estimator_h->is_initialized == false) return false;
 	if (motor_speed_reference_estimator_h->cfg->history_sample_count == 0u) return false;
 	if (motor_speed_reference_estimator_h->cfg->history_sample_count > MOTOR_SPEED_ESTIMATOR_MAX_HISTORY_SAMPLES) return false;
@@ -78,6 +156,8 @@ bool motor_speed_reference_estimator_update(
 	motor_handle_t *motor_h = motor_speed_reference_estimator_h->motor_h;
 	motor_speed_reference_estimator_state_t *motor_speed_reference_estimator_state =
 			&motor_h->speed_reference_estimator;
+	motor_speed_reference_estimator_history_t *history = motor_speed_reference_estimator_h->history;
+	uint32_t sample_timestamp_u32 = (uint32_t)sample_timestamp_us;
 	uint16_t history_buffer_size =
 			(uint16_t)(motor_speed_reference_estimator_h->cfg->history_sample_count + 1u);
 	uint16_t write_index = motor_speed_reference_estimator_state->history_write_index;
@@ -92,7 +172,7 @@ bool motor_speed_reference_estimator_update(
 	{
 		motor_speed_reference_estimator_state->previous_raw_mechanical_angle_u16 = mechanical_angle_u16;
 		motor_speed_reference_estimator_state->has_previous_raw_mechanical_angle = true;
-		motor_speed_reference_estimator_state->cumulative_unwrapped_mechanical_angle_counts = 0;
+		motor_speed_reference_estimator_state->cumulative_unwrapped_mechanical_angle_counts = 0u;
 	}
 	else
 	{
@@ -102,14 +182,34 @@ bool motor_speed_reference_estimator_update(
 				motor_speed_reference_estimator_state->previous_raw_mechanical_angle_u16);
 		motor_speed_reference_estimator_state->previous_raw_mechanical_angle_u16 = mechanical_angle_u16;
 		motor_speed_reference_estimator_state->cumulative_unwrapped_mechanical_angle_counts +=
-				(int64_t)mechanical_angle_delta_counts;
+				(uint32_t)mechanical_angle_delta_counts;
 	}
 	motor_speed_reference_estimator_state->last_mechanical_angle_delta_counts = mechanical_angle_delta_counts;
 
+	/* Drop the oldest point once the window is full; it is the origin, so its sum terms are zero. */
+	if (motor_speed_reference_estimator_state->history_valid_count >= history_buffer_size)
+	{
+		uint16_t removed_origin_index = motor_speed_reference_estimator_state->regression_origin_index;
+		uint16_t next_origin_index = (uint16_t)((removed_origin_index + 1u) % history_buffer_size);
+
+		motor_speed_reference_estimator_state->regression_point_count--;
+		motor_speed_reference_estimator_shift_origin(
+				motor_speed_reference_estimator_state,
+				(int64_t)(uint32_t)(history->sample_timestamp_us[next_origin_index] -
+									history->sample_timestamp_us[removed_origin_index]),
+				(int64_t)(int32_t)(history->cumulative_unwrapped_angle_counts[next_origin_index] -
+								   history->cumulative_unwrapped_angle_counts[removed_origin_index]));
+		motor_speed_reference_estimator_state->regression_origin_index = next_origin_index;
+	}
+
 	/* Store the newest sample in the sliding history buffer. */
-	motor_speed_reference_estimator_state->sample_timestamp_history_us[write_index] = sample_timestamp_us;
-	motor_speed_reference_estimator_state->cumulative_unwrapped_angle_history_counts[write_index] =
+	history->sample_timestamp_us[write_index] = sample_timestamp_u32;
+	history->cumulative_unwrapped_angle_counts[write_index] =
 			motor_speed_reference_estimator_state->cumulative_unwrapped_mechanical_angle_counts;
+	if (motor_speed_reference_estimator_state->history_valid_count == 0u)
+	{
+		motor_speed_reference_estimator_state->regression_origin_index = write_index;
+	}
 	if (motor_speed_reference_estimator_state->history_valid_count < history_buffer_size)
 	{
 		motor_speed_reference_estimator_state->history_valid_count++;
@@ -119,6 +219,18 @@ bool motor_speed_reference_estimator_update(
 	motor_speed_reference_estimator_state->last_window_point_count =
 			motor_speed_reference_estimator_state->history_valid_count;
 
+	/* Add the newest point relative to the current origin (oldest retained sample). */
+	uint16_t origin_index = motor_speed_reference_estimator_state->regression_origin_index;
+	int64_t local_x_us = (int64_t)(uint32_t)(sample_timestamp_u32 - history->sample_timestamp_us[origin_index]);
+	int64_t local_y_counts = (int64_t)(int32_t)(
+			motor_speed_reference_estimator_state->cumulative_unwrapped_mechanical_angle_counts -
+			history->cumulative_unwrapped_angle_counts[origin_index]);
+	motor_speed_reference_estimator_state->regression_point_count++;
+	motor_speed_reference_estimator_state->regression_sum_x_us += local_x_us;
+	motor_speed_reference_estimator_state->regression_sum_y_counts += local_y_counts;
+	motor_speed_reference_estimator_state->regression_sum_xx_us2 += local_x_us * local_x_us;
+	motor_speed_reference_estimator_state->regression_sum_xy_us_counts += local_x_us * local_y_counts;
+
 	/* Wait until the full reference window is available before publishing speed. */
 	if (motor_speed_reference_estimator_state->history_valid_count < history_buffer_size)
 	{
@@ -128,66 +240,63 @@ bool motor_speed_reference_estimator_update(
 		return true;
 	}
 
-	uint16_t oldest_index = motor_speed_reference_estimator_state->history_write_index;
-	uint16_t newest_index = (uint16_t)((motor_speed_reference_estimator_state->history_write_index +
-										history_buffer_size - 1u) % history_buffer_size);
-	uint64_t oldest_timestamp_us =
-			motor_speed_reference_estimator_state->sample_timestamp_history_us[oldest_index];
-	uint64_t newest_timestamp_us =
-			motor_speed_reference_estimator_state->sample_timestamp_history_us[newest_index];
-	int64_t oldest_cumulative_unwrapped_counts =
-			motor_speed_reference_estimator_state->cumulative_unwrapped_angle_history_counts[oldest_index];
-	double point_count_f64 = (double)history_buffer_size;
-	double regression_sum_x = 0.0;
-	double regression_sum_y = 0.0;
-	double regression_sum_xx = 0.0;
-	double regression_sum_xy = 0.0;
-
-	/* Rebuild one local regression window with the oldest sample as the origin. */
-	for (uint16_t point_offset = 0u; point_offset < history_buffer_size; point_offset++)
-	{
-		uint16_t sample_index = (uint16_t)((oldest_index + point_offset) % history_buffer_size);
-		uint64_t local_x_us =
-				motor_speed_reference_estimator_state->sample_timestamp_history_us[sample_index] -
-				oldest_timestamp_us;
-		int64_t local_y_counts =
-				motor_speed_reference_estimator_state->cumulative_unwrapped_angle_history_counts[sample_index] -
-				oldest_cumulative_unwrapped_counts;
-		double local_x_f64 = (double)local_x_us;
-		double local_y_f64 = (double)local_y_counts;
-
-		regression_sum_x += local_x_f64;
-		regression_sum_y += local_y_f64;
-		regression_sum_xx += local_x_f64 * local_x_f64;
-		regression_sum_xy += local_x_f64 * local_y_f64;
-	}
-
 	/* Track the real active window span from the current oldest and newest timestamps. */
-	motor_speed_reference_estimator_state->last_elapsed_time_us = newest_timestamp_us - oldest_timestamp_us;
-	double regression_denom_f64 =
-			(point_count_f64 * regression_sum_xx) - (regression_sum_x * regression_sum_x);
+	motor_speed_reference_estimator_state->last_elapsed_time_us = (uint32_t)local_x_us;
+
+	int64_t point_count = (int64_t)motor_speed_reference_estimator_state->regression_point_count;
+	int64_t regression_sum_x = motor_speed_reference_estimator_state->regression_sum_x_us;
+	int64_t regression_sum_y = motor_speed_reference_estimator_state->regression_sum_y_counts;
+	int64_t regression_num =
+			(point_count * motor_speed_reference_estimator_state->regression_sum_xy_us_counts) -
+			(regression_sum_x * regression_sum_y);
+	int64_t regression_denom =
+			(point_count * motor_speed_reference_estimator_state->regression_sum_xx_us2) -
+			(regression_sum_x * regression_sum_x);
 	if ((motor_speed_reference_estimator_state->last_elapsed_time_us == 0u) ||
-		(regression_denom_f64 <= MOTOR_SPEED_ESTIMATOR_REGRESSION_DENOM_EPSILON))
+		(regression_denom <= 0))
 	{
 		motor_h->measurements.measured_mechanical_speed_mrpm = 0;
 		motor_h->status.has_valid_mechanical_speed = false;
 		return true;
 	}
 
-	/* slope = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x^2). */
-	double slope_counts_per_us =
-			((point_count_f64 * regression_sum_xy) - (regression_sum_x * regression_sum_y)) /
-			regression_denom_f64;
+#if (MOTOR_SPEED_REFERENCE_ESTIMATOR_KERNEL == MOTOR_KERNEL_FLOAT32)
+	/* slope = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x^2), both differences exact in int64. */
+	float estimated_mechanical_speed_mrpm_f32 =
+			((float)regression_num / (float)regression_denom) * MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_F32;
+	if (estimated_mechanical_speed_mrpm_f32 > MOTOR_SPEED_ESTIMATOR_SPEED_LIMIT_F32)
+	{
+		estimated_mechanical_speed_mrpm_f32 = MOTOR_SPEED_ESTIMATOR_SPEED_LIMIT_F32;
+	}
+	if (estimated_mechanical_speed_mrpm_f32 < -MOTOR_SPEED_ESTIMATOR_SPEED_LIMIT_F32)
+	{
+		estimated_mechanical_speed_mrpm_f32 = -MOTOR_SPEED_ESTIMATOR_SPEED_LIMIT_F32;
+	}
+	int32_t estimated_mechanical_speed_mrpm = (estimated_mechanical_speed_mrpm_f32 >= 0.0f) ?
+											  (int32_t)(estimated_mechanical_speed_mrpm_f32 + 0.5f) :
+											  (int32_t)(estimated_mechanical_speed_mrpm_f32 - 0.5f);
+#else
+	/* slope = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x^2), normalized to keep num * scale in int64. */
+	while (regression_denom >= MOTOR_SPEED_ESTIMATOR_DENOM_NORMALIZE_LIMIT)
+	{
+		regression_denom /= 2LL;
+		regression_num /= 2LL;
+	}
+
+	/* Saturate implausible slopes instead of overflowing the scaled numerator. */
+	const int64_t regression_num_limit = INT64_MAX / MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_NUM;
+	if (regression_num > regression_num_limit) regression_num = regression_num_limit;
+	if (regression_num < -regression_num_limit) regression_num = -regression_num_limit;
 
 	/* Convert counts/us slope into signed milli-rpm. */
-	double estimated_mechanical_speed_mrpm_f64 =
-			(slope_counts_per_us * (double)MOTOR_SPEED_ESTIMATOR_US_PER_MINUTE *
-			 (double)MOTOR_SPEED_ESTIMATOR_MRPM_PER_RPM) /
-			(double)MOTOR_SPEED_ESTIMATOR_MECHANICAL_TURN_COUNTS_U16;
-	int32_t estimated_mechanical_speed_mrpm =
-			(int32_t)((estimated_mechanical_speed_mrpm_f64 >= 0.0) ?
-					  (estimated_mechanical_speed_mrpm_f64 + 0.5) :
-					  (estimated_mechanical_speed_mrpm_f64 - 0.5));
+	int64_t estimated_mechanical_speed_mrpm_i64 =
+			motor_speed_reference_estimator_divide_round_nearest(
+					regression_num * MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_NUM,
+					regression_denom * MOTOR_SPEED_ESTIMATOR_MRPM_SCALE_DEN);
+	if (estimated_mechanical_speed_mrpm_i64 > INT32_MAX) estimated_mechanical_speed_mrpm_i64 = INT32_MAX;
+	if (estimated_mechanical_speed_mrpm_i64 < -INT32_MAX) estimated_mechanical_speed_mrpm_i64 = -INT32_MAX;
+	int32_t estimated_mechanical_speed_mrpm = (int32_t)estimated_mechanical_speed_mrpm_i64;
+#endif
 
 	/* Store the newest signed mechanical speed estimate in milli-rpm. */
 	motor_h->measurements.measured_mechanical_speed_mrpm = estimated_mechanical_speed_mrpm;
@@ -195,3 +304,25 @@ bool motor_speed_reference_estimator_update(
 
 	return true;
 }
+
+bool motor_speed_reference_estimator_get_position(
+		const motor_speed_reference_estimator_handle_t *motor_speed_reference_estimator_h,
+		int32_t *position_counts)
+{
+	if ((motor_speed_reference_estimator_h == NULL) || (position_counts == NULL)) return false;
+	if (motor_speed_reference_estimator_h->is_initialized == false) return false;
+
+	const motor_speed_reference_estimator_state_t *state =
+			&motor_speed_reference_estimator_h->motor_h->speed_reference_estimator;
+
+	if (state->has_previous_raw_mechanical_angle == false) return false;
+
+	/* The low 16 bits of the cumulative count are (latest - first) raw angle: add the first raw angle back. */
+	uint16_t first_raw_mechanical_angle_u16 =
+			(uint16_t)(state->previous_raw_mechanical_angle_u16 -
+					   (uint16_t)state->cumulative_unwrapped_mechanical_angle_counts);
+	*position_counts = (int32_t)(state->cumulative_unwrapped_mechanical_angle_counts +
+								 (uint32_t)first_raw_mechanical_angle_u16);
+
+	return true;
+}
@@ -0,0 +1,386 @@
+/**
+ * @file motor_trajectory.c
+ * @brief Jerk-limited S-curve speed trajectory implementation.
+ *
+ * Each ramp is planned once when its segment starts:
+ * - |dv| >= A^2 / J: Ap = A, Tj = A / J, Ta = |dv| / A - Tj
+ * - |dv| <  A^2 / J: Ap = sqrt(|dv| * J), Tj = Ap / J, Ta = 0
+ * - J = 0:           Ap = A, Tj = 0, Ta = |dv| / A
+ *
+ * The reference is then evaluated in closed form from the elapsed ramp time,
+ * the jerk-down interval is written relative to the segment target, so the
+ * ramp lands exactly on it regardless of the integer rounding of the plan.
+ *
+ *  Notes:
+ *  - time advances by update_period_us per update (one control tick), so the
+ *    reference stays consistent with the loop that consumes it.
+ *  - products are split with intermediate 1e6 divisions to stay in int64.
+ */
+
+#include "motor/motor_trajectory.h"
+#include <stddef.h>
+
+#define MOTOR_TRAJECTORY_US_PER_S     1000000LL
+
+/**
+ * @brief Integer square root (floor).
+ *
+ * @param value Radicand.
+ * @return floor(sqrt(value)).
+ */
+static uint64_t motor_trajectory_isqrt_u64(uint64_t value)
+{
+	uint64_t result = 0u;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > value) bit >>= 2;
+	while (bit != 0u)
+	{
+		if (value >= (result + bit))
+		{
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		}
+		else
+		{
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Saturate a signed 64-bit value to int32.
+ *
+ * @param value Input value.
+ * @return Saturated value.
+ */
+static int32_t motor_trajectory_sat_i32(int64_t value)
+{
+	if (value > (int64_t)INT32_MAX) return INT32_MAX;
+	if (value < (int64_t)INT32_MIN) return INT32_MIN;
+
+	return (int32_t)value;
+}
+
+/**
+ * @brief Return the step index (2 * segment + holding) of the handle.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @return Step index.
+ */
+static uint8_t motor_trajectory_step_of(const motor_trajectory_handle_t *motor_trajectory_h)
+{
+	return (uint8_t)((motor_trajectory_h->segment_index * 2u) + (motor_trajectory_h->is_holding ? 1u : 0u));
+}
+
+/**
+ * @brief Plan one ramp: peak acceleration, jerk and constant-acceleration intervals.
+ *
+ * @param delta_abs_mrpm |target - start| speed.
+ * @param accel Acceleration limit in mrpm/s (> 0).
+ * @param jerk Jerk limit in mrpm/s^2, 0 = trapezoid.
+ * @param peak_accel Output reached acceleration Ap.
+ * @param jerk_time_us Output Tj.
+ * @param constant_time_us Output Ta (2 * Tj + Ta <= UINT32_MAX).
+ */
+static void motor_trajectory_plan_ramp(uint64_t delta_abs_mrpm,
+									   uint64_t accel,
+									   uint64_t jerk,
+									   uint64_t *peak_accel,
+									   uint64_t *jerk_time_us,
+									   uint64_t *constant_time_us)
+{
+	uint64_t jerk_us = 0u;
+	uint64_t constant_us = 0u;
+
+	if ((jerk != 0u) && (delta_abs_mrpm < ((accel * accel) / jerk)))
+	{
+		/* Short ramp: acceleration never reaches the limit (triangular acceleration). */
+		accel = motor_trajectory_isqrt_u64(delta_abs_mrpm * jerk);
+		if (accel == 0u) accel = 1u;
+	}
+
+	if (jerk != 0u)
+	{
+		jerk_us = (accel * (uint64_t)MOTOR_TRAJECTORY_US_PER_S) / jerk;
+	}
+	/* |dv| = Ap * (Tj + Ta): the constant part covers what the jerk intervals do not. */
+	uint64_t accel_time_us = (delta_abs_mrpm * (uint64_t)MOTOR_TRAJECTORY_US_PER_S) / accel;
+	if (accel_time_us > jerk_us) constant_us = accel_time_us - jerk_us;
+	if (delta_abs_mrpm == 0u)
+	{
+		jerk_us = 0u;
+		constant_us = 0u;
+	}
+
+	uint64_t ramp_time_us = (2u * jerk_us) + constant_us;
+	if (ramp_time_us > (uint64_t)UINT32_MAX)
+	{
+		/* Degenerate table (tiny limits): cap the plan, the landing stays exact. */
+		ramp_time_us = UINT32_MAX;
+		if (jerk_us > (ramp_time_us / 2u)) jerk_us = ramp_time_us / 2u;
+		constant_us = ramp_time_us - (2u * jerk_us);
+	}
+
+	*peak_accel = accel;
+	*jerk_time_us = jerk_us;
+	*constant_time_us = constant_us;
+}
+
+/**
+ * @brief Plan the ramp of one segment from its start speed.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ * @param segment_index Segment to enter.
+ * @param start_speed_mrpm Reference speed at segment entry.
+ */
+static void motor_trajectory_enter_segment(motor_trajectory_handle_t *motor_trajectory_h,
+										   uint8_t segment_index,
+										   int32_t start_speed_mrpm)
+{
+	const motor_trajectory_profile_t *profile = &motor_trajectory_h->profile;
+	const motor_trajectory_segment_t *segment = &profile->segments[segment_index];
+	int64_t delta_mrpm = (int64_t)segment->target_mechanical_speed_mrpm - (int64_t)start_speed_mrpm;
+	uint64_t delta_abs_mrpm = (delta_mrpm >= 0) ? (uint64_t)delta_mrpm : (uint64_t)(-delta_mrpm);
+	uint64_t accel = (segment->max_acceleration_mrpm_per_s != 0u) ?
+					 (uint64_t)segment->max_acceleration_mrpm_per_s :
+					 (uint64_t)profile->max_acceleration_mrpm_per_s;
+	uint64_t jerk = (uint64_t)profile->max_jerk_mrpm_per_s2;
+	uint64_t jerk_time_us = 0u;
+	uint64_t constant_time_us = 0u;
+
+	motor_trajectory_plan_ramp(delta_abs_mrpm, accel, jerk, &accel, &jerk_time_us, &constant_time_us);
+	uint64_t ramp_time_us = (2u * jerk_time_us) + constant_time_us;
+
+	motor_trajectory_h->segment_index = segment_index;
+	motor_trajectory_h->ramp_start_speed_mrpm = start_speed_mrpm;
+	motor_trajectory_h->ramp_sign = (delta_mrpm >= 0) ? 1 : -1;
+	motor_trajectory_h->ramp_jerk_mrpm_per_s2 = (uint32_t)jerk;
+	motor_trajectory_h->ramp_peak_acceleration_mrpm_per_s = (uint32_t)accel;
+	motor_trajectory_h->ramp_jerk_time_us = (uint32_t)jerk_time_us;
+	motor_trajectory_h->ramp_constant_time_us = (uint32_t)constant_time_us;
+	motor_trajectory_h->ramp_time_us = (uint32_t)ramp_time_us;
+	motor_trajectory_h->segment_elapsed_us = 0u;
+	motor_trajectory_h->is_holding = (ramp_time_us == 0u);
+}
+
+/**
+ * @brief Evaluate and publish reference speed and acceleration at the elapsed time.
+ *
+ * @param motor_trajectory_h Pointer to trajectory handle.
+ */
+static void motor_trajectory_publish(motor_trajectory_handle_t *motor_trajectory_h)
+{
+	const motor_trajectory_segment_t *segment = &motor_trajectory_h->profile.segments[motor_trajectory_h->segment_index];
+	motor_trajectory_state_t *state = &motor_trajectory_h->motor_h->trajectory;
+	int64_t target_mrpm = (int64_t)segment->target_mechanical_speed_mrpm;
+	int64_t sign = (int64_t)motor_trajectory_h->ramp_sign;
+	int64_t jerk = (int64_t)motor_trajectory_h->ramp_jerk_mrpm_per_s2;
+	int64_t peak_accel = (int64_t)motor_trajectory_h->ramp_peak_acceleration_mrpm_per_s;
+	int64_t jerk_time_us = (int64_t)motor_trajectory_h->ramp_jerk_time_us;
+	int64_t ramp_time_us = (int64_t)motor_trajectory_h->ramp_time_us;
+	int64_t t_us = (int64_t)motor_trajectory_h->segment_elapsed_us;
+	int64_t speed_mrpm = target_mrpm;
+	int64_t accel = 0;
+
+	if (motor_trajectory_h->is_holding == false)
+	{
+		if (t_us < jerk_time_us)
+		{
+			/* Jerk-up: a = J t, v = v0 + J t^2 / 2. */
+			accel = (jerk * t_us) / MOTOR_TRAJECTORY_US_PER_S;
+			speed_mrpm = (int64_t)motor_trajectory_h->ramp_start_speed_mrpm +
+						 (sign * ((accel * t_us) / (2LL * MOTOR_TRAJECTORY_US_PER_S)));
+		}
+		else if (t_us < (ramp_time_us - jerk_time_us))
+		{
+			/* Constant acceleration: v = v0 + Ap Tj / 2 + Ap (t - Tj). */
+			accel = peak_accel;
+			speed_mrpm = (int64_t)motor_trajectory_h->ramp_start_speed_mrpm +
+						 (sign * (((peak_accel * jerk_time_us) / (2LL * MOTOR_TRAJECTORY_US_PER_S)) +
+								  ((peak_accel * (t_us - jerk_time_us)) / MOTOR_TRAJECTORY_US_PER_S)));
+		}
+		else
+		{
+			/* Jerk-down relative to the target: tau = T - t, v = target - J tau^2 / 2. */
+			int64_t tau_us = ramp_time_us - t_us;
+
+			accel = (jerk * tau_us) / MOTOR_TRAJECTORY_US_PER_S;
+			speed_mrpm = target_mrpm - (sign * ((accel * tau_us) / (2LL * MOTOR_TRAJECTORY_US_PER_S)));
+		}
+	}
+
+	state->reference_mechanical_speed_mrpm = motor_trajectory_sat_i32(speed_mrpm);
+	state->reference_mechanical_acceleration_mrpm_per_s = motor_trajectory_sat_i32(sign * accel);
+	state->segment_target_mechanical_speed_mrpm = segment->target_mechanical_speed_mrpm;
+	state->step_index = motor_trajectory_step_of(motor_trajectory_h);
+	state->is_holding = motor_trajectory_h->is_holding;
+}
+
+/**
+ * @brief Check one segment table and its limits.
+ *
+ * @param profile Pointer to profile.
+ * @return true if the profile can be planned, false otherwise.
+ */
+static bool motor_trajectory_profile_is_valid(const motor_trajectory_profile_t *profile)
+{
+	if ((profile == NULL) || (profile->segments == NULL)) return false;
+	/* Step index 2 * segment + 1 must fit in uint8 (and stay below MOTOR_TRAJECTORY_STEP_EXTERNAL). */
+	if ((profile->segment_count == 0u) || (profile->segment_count > 127u)) return false;
+	if (profile->max_acceleration_mrpm_per_s == 0u) return false;
+
+	return true;
+}
+
+bool motor_trajectory_init(motor_trajectory_handle_t *motor_trajectory_h,
+						   const motor_trajectory_cfg_t *motor_trajectory_cfg)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_cfg == NULL)) return false;
+	if (motor_trajectory_cfg->motor_h == NULL) return false;
+	if (motor_trajectory_cfg->update_period_us == 0u) return false;
+
+	const motor_trajectory_profile_t profile = {
+			.segments = motor_trajectory_cfg->segments,
+			.segment_count = motor_trajectory_cfg->segment_count,
+			.is_cyclic = motor_trajectory_cfg->is_cyclic,
+			.max_acceleration_mrpm_per_s = motor_trajectory_cfg->max_acceleration_mrpm_per_s,
+			.max_jerk_mrpm_per_s2 = motor_trajectory_cfg->max_jerk_mrpm_per_s2,
+	};
+
+	if (!motor_trajectory_profile_is_valid(&profile)) return false;
+
+	motor_trajectory_h->cfg = motor_trajectory_cfg;
+	motor_trajectory_h->motor_h = motor_trajectory_cfg->motor_h;
+	motor_trajectory_h->profile = profile;
+	motor_trajectory_h->is_initialized = true;
+
+	return motor_trajectory_reset(motor_trajectory_h, 0);
+}
+
+bool motor_trajectory_reset(motor_trajectory_handle_t *motor_trajectory_h, int32_t initial_speed_mrpm)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_h->is_initialized == false)) return false;
+
+	motor_trajectory_h->is_finished = false;
+	motor_trajectory_h->is_external = false;
+	motor_trajectory_enter_segment(motor_trajectory_h, 0u, initial_speed_mrpm);
+	motor_trajectory_publish(motor_trajectory_h);
+
+	return true;
+}
+
+bool motor_trajectory_set_profile(motor_trajectory_handle_t *motor_trajectory_h,
+								  const motor_trajectory_profile_t *profile)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_h->is_initialized == false)) return false;
+	if (!motor_trajectory_profile_is_valid(profile)) return false;
+
+	/* Restart from the reference just published, so the speed reference stays continuous. */
+	motor_trajectory_h->profile = *profile;
+	return motor_trajectory_reset(motor_trajectory_h,
+								  motor_trajectory_h->motor_h->trajectory.reference_mechanical_speed_mrpm);
+}
+
+bool motor_trajectory_set_external_reference(motor_trajectory_handle_t *motor_trajectory_h,
+											 int32_t reference_mechanical_speed_mrpm,
+											 int32_t reference_mechanical_acceleration_mrpm_per_s)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_h->is_initialized == false)) return false;
+
+	motor_trajectory_state_t *state = &motor_trajectory_h->motor_h->trajectory;
+
+	/* Never settled on a target: steady-state checks keyed on is_holding stay disarmed. */
+	motor_trajectory_h->is_external = true;
+	state->reference_mechanical_speed_mrpm = reference_mechanical_speed_mrpm;
+	state->reference_mechanical_acceleration_mrpm_per_s = reference_mechanical_acceleration_mrpm_per_s;
+	state->segment_target_mechanical_speed_mrpm = reference_mechanical_speed_mrpm;
+	state->step_index = MOTOR_TRAJECTORY_STEP_EXTERNAL;
+	state->is_holding = false;
+
+	return true;
+}
+
+bool motor_trajectory_update(motor_trajectory_handle_t *motor_trajectory_h, bool *step_changed)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_h->is_initialized == false)) return false;
+
+	const motor_trajectory_cfg_t *cfg = motor_trajectory_h->cfg;
+	const motor_trajectory_profile_t *profile = &motor_trajectory_h->profile;
+	uint8_t previous_step = motor_trajectory_h->motor_h->trajectory.step_index;
+
+	if (motor_trajectory_h->is_external)
+	{
+		/* Back from external points: replan segment 0 from the last external reference. */
+		motor_trajectory_h->is_external = false;
+		motor_trajectory_h->is_finished = false;
+		motor_trajectory_enter_segment(motor_trajectory_h,
+									   0u,
+									   motor_trajectory_h->motor_h->trajectory.reference_mechanical_speed_mrpm);
+	}
+	else if (motor_trajectory_h->is_finished == false)
+	{
+		uint64_t elapsed_us = (uint64_t)motor_trajectory_h->segment_elapsed_us + (uint64_t)cfg->update_period_us;
+		uint64_t segment_time_us = (uint64_t)motor_trajectory_h->ramp_time_us +
+								   ((uint64_t)profile->segments[motor_trajectory_h->segment_index].hold_ms * 1000u);
+
+		motor_trajectory_h->segment_elapsed_us = (elapsed_us > (uint64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed_us;
+		if (elapsed_us >= (uint64_t)motor_trajectory_h->ramp_time_us) motor_trajectory_h->is_holding = true;
+
+		if (elapsed_us >= segment_time_us)
+		{
+			uint8_t next_index = (uint8_t)(motor_trajectory_h->segment_index + 1u);
+
+			if (next_index >= profile->segment_count)
+			{
+				next_index = 0u;
+				if (profile->is_cyclic == false) motor_trajectory_h->is_finished = true;
+			}
+			if (motor_trajectory_h->is_finished == false)
+			{
+				/* The next ramp starts from the target just held, so the reference stays continuous. */
+				motor_trajectory_enter_segment(motor_trajectory_h,
+											   next_index,
+											   profile->segments[motor_trajectory_h->segment_index].target_mechanical_speed_mrpm);
+			}
+		}
+	}
+
+	motor_trajectory_publish(motor_trajectory_h);
+	if (step_changed != NULL)
+	{
+		*step_changed = (motor_trajectory_step_of(motor_trajectory_h) != previous_step);
+	}
+
+	return true;
+}
+
+uint8_t motor_trajectory_get_step(const motor_trajectory_handle_t *motor_trajectory_h)
+{
+	if ((motor_trajectory_h == NULL) || (motor_trajectory_h->is_initialized == false)) return 0u;
+
+	return motor_trajectory_h->motor_h->trajectory.step_index;
+}
+
+uint32_t motor_trajectory_get_ramp_time_us(uint32_t speed_step_mrpm,
+										   uint32_t max_acceleration_mrpm_per_s,
+										   uint32_t max_jerk_mrpm_per_s2)
+{
+	uint64_t peak_accel = 0u;
+	uint64_t jerk_time_us = 0u;
+	uint64_t constant_time_us = 0u;
+
+	if (max_acceleration_mrpm_per_s == 0u) return 0u;
+
+	motor_trajectory_plan_ramp((uint64_t)speed_step_mrpm,
+							   (uint64_t)max_acceleration_mrpm_per_s,
+							   (uint64_t)max_jerk_mrpm_per_s2,
+							   &peak_accel,
+							   &jerk_time_us,
+							   &constant_time_us);
+
+	return (uint32_t)((2u * jerk_time_us) + constant_time_us);
+}
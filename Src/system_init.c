@@ -7,6 +7,7 @@
  *
  * This file is intentionally minimal:
  * - Enable FPU when the build uses hardware floating point.
+ * - Select automatic, lazy FP context stacking for exception entry.
  * - Ensure the vector table base address is correctly set.
  * - Leave clock configuration to a dedicated function called from main().
  */
@@ -16,6 +17,16 @@ void SystemInit(void)
 #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
     /* Enable full access to CP10 and CP11 (FPU). */
     SCB->CPACR |= (0xFu << 20);
+
+    /*
+     * ASPEN: an ISR that executes FP instructions gets S0-S15/FPSCR saved in
+     * its exception frame (float32 kernels in the PWM and ADC callbacks are
+     * preempt-safe). LSPEN: the frame only reserves the space and the
+     * registers are stored on the first FP instruction of the handler, so
+     * integer-only ISRs keep the short entry latency.
+     * Both are reset defaults; set explicitly so the ISR timing is defined here.
+     */
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
     __DSB();
     __ISB();
 #endif
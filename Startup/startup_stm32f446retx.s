@@ -41,6 +41,16 @@ defined in linker script */
 .word _sbss
 /* end address for the .bss section. defined in linker script */
 .word _ebss
+/* load, start and end address of the .ramfunc / .fastdata SRAM fast path. defined in linker script */
+.word _siramfunc
+.word _sramfunc
+.word _eramfunc
+.word _sifastdata
+.word _sfastdata
+.word _efastdata
+/* start and end address of the SRAM vector table copy. defined in linker script */
+.word _sram_vector
+.word _eram_vector
 
 /**
  * @brief  This is the code that gets called when the processor first
@@ -77,6 +87,62 @@ LoopCopyDataInit:
   cmp r4, r1
   bcc CopyDataInit
 
+/* Copy the code executed from SRAM (.ramfunc) from flash */
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  movs r3, #0
+  b LoopCopyRamFuncInit
+
+CopyRamFuncInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamFuncInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamFuncInit
+
+/* Copy the tables used by the SRAM code (.fastdata) from flash */
+  ldr r0, =_sfastdata
+  ldr r1, =_efastdata
+  ldr r2, =_sifastdata
+  movs r3, #0
+  b LoopCopyFastDataInit
+
+CopyFastDataInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyFastDataInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyFastDataInit
+
+/* Copy the vector table to SRAM and move SCB->VTOR to the copy */
+  ldr r0, =_sram_vector
+  ldr r1, =_eram_vector
+  ldr r2, =g_pfnVectors
+  movs r3, #0
+  b LoopCopyVectorInit
+
+CopyVectorInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyVectorInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyVectorInit
+
+  ldr r1, =0xE000ED08   /* SCB->VTOR */
+  str r0, [r1]
+  dsb
+  isb
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss
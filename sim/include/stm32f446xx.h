@@ -0,0 +1 @@
+#include "stm32f4xx.h"
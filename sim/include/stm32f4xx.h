@@ -0,0 +1,102 @@
+#ifndef SIM_STM32F4XX_H
+#define SIM_STM32F4XX_H
+/**
+ * @file stm32f4xx.h
+ * @brief Host stand-in for the CMSIS device header (software-in-the-loop build only).
+ *
+ * Declares the register block types the driver headers name in their
+ * configuration structs and implements the Cortex-M4 intrinsics used by the
+ * motor kernels in portable C, with the same results as the DSP instructions.
+ * No register is accessed: the driver layer is replaced by sim_hal.c.
+ */
+
+#include <stdint.h>
+
+#define __IO		volatile
+#define __NVIC_PRIO_BITS	4u
+
+typedef enum {
+	NonMaskableInt_IRQn = -14,
+	SysTick_IRQn = -1,
+	ADC_IRQn = 18,
+	TIM1_BRK_TIM9_IRQn = 24,
+	TIM1_UP_TIM10_IRQn = 25,
+	TIM1_TRG_COM_TIM11_IRQn = 26,
+	TIM8_BRK_TIM12_IRQn = 43,
+	TIM8_UP_TIM13_IRQn = 44,
+	TIM8_TRG_COM_TIM14_IRQn = 45,
+	DMA2_Stream0_IRQn = 56,
+} IRQn_Type;
+
+typedef struct { __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2]; } GPIO_TypeDef;
+typedef struct { __IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR, SQR1, SQR2, SQR3,
+                 JSQR, JDR1, JDR2, JDR3, JDR4, DR; } ADC_TypeDef;
+typedef struct { __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2,
+                 CCR3, CCR4, BDTR, DCR, DMAR, OR; } TIM_TypeDef;
+typedef struct { __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+typedef struct { __IO uint32_t LISR, HISR, LIFCR, HIFCR; } DMA_TypeDef;
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+
+/* TIM5 free-running microsecond counter, read by the inline timebase accessors (kept by sim_hal.c). */
+extern TIM_TypeDef SIM_TIM5;
+#define TIM5		(&SIM_TIM5)
+#define TIM_SR_UIF	(1u << 0)
+#define TIM_SR_CC1IF	(1u << 1)
+
+/* Interrupt masking: the simulation runs interrupt callbacks synchronously from its time loop. */
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline uint32_t __get_PRIMASK(void) { return 0u; }
+static inline uint32_t __get_BASEPRI(void) { return 0u; }
+static inline void __set_BASEPRI(uint32_t basepri) { (void)basepri; }
+static inline void __set_BASEPRI_MAX(uint32_t basepri) { (void)basepri; }
+static inline void __DSB(void) {}
+static inline void __ISB(void) {}
+static inline void __DMB(void) {}
+static inline void __NOP(void) {}
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+	return (value == 0u) ? 32u : (uint32_t)__builtin_clz(value);
+}
+
+static inline int32_t __SSAT(int32_t value, uint32_t bits)
+{
+	const int32_t max = (int32_t)((1u << (bits - 1u)) - 1u);
+	const int32_t min = -max - 1;
+
+	return (value > max) ? max : ((value < min) ? min : value);
+}
+
+static inline uint32_t __USAT(int32_t value, uint32_t bits)
+{
+	const int32_t max = (int32_t)((1u << bits) - 1u);
+
+	return (uint32_t)((value > max) ? max : ((value < 0) ? 0 : value));
+}
+
+/* Pack halfwords: bottom of op1, top of (op2 << shift). */
+static inline uint32_t __PKHBT(uint32_t op1, uint32_t op2, uint32_t shift)
+{
+	return (op1 & 0x0000FFFFu) | ((op2 << shift) & 0xFFFF0000u);
+}
+
+/* Dual signed 16 x 16 multiply, products added to the accumulator. */
+static inline uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t acc)
+{
+	int32_t p_lo = (int32_t)(int16_t)op1 * (int32_t)(int16_t)op2;
+	int32_t p_hi = (int32_t)(int16_t)(op1 >> 16) * (int32_t)(int16_t)(op2 >> 16);
+
+	return (uint32_t)((int32_t)acc + p_lo + p_hi);
+}
+
+/* Dual signed 16 x 16 multiply with exchanged op2 halves, difference of the products. */
+static inline uint32_t __SMUSDX(uint32_t op1, uint32_t op2)
+{
+	int32_t p_lo = (int32_t)(int16_t)op1 * (int32_t)(int16_t)(op2 >> 16);
+	int32_t p_hi = (int32_t)(int16_t)(op1 >> 16) * (int32_t)(int16_t)op2;
+
+	return (uint32_t)(p_lo - p_hi);
+}
+
+#endif /* SIM_STM32F4XX_H */
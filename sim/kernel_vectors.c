@@ -0,0 +1,824 @@
+/**
+ * @file kernel_vectors.c
+ * @brief Golden-vector check of the fixed-point control kernels (host build).
+ *
+ * Drives the unchanged firmware kernels with deterministic input sequences
+ * (seeded xorshift plus edge cases: angle wrap, saturation, sign changes)
+ * and compares every output with the vectors recorded from the reference
+ * implementation in sim/vectors/kernel_vectors.txt:
+ *
+ *   foc_sine / foc_svpwm / foc_dpwm   motor_foc_voltage_apply_dq(), CCR ticks per phase
+ *   foc_svpwm_dtc                     SVPWM with command-polarity dead-time compensation, ticks and polarity
+ *   speed_pi / speed_pi_sched         motor_speed_pi_update(), fixed gains / gain table
+ *   feedback_lpf / feedback_pll       motor_speed_feedback_update()
+ *   as5600_bootstrap                  first publish of a window (window average of the raw codes)
+ *   as5600_window                     continuous publish path (continuity gate, retained average)
+ *
+ * The stateful kernels run their vectors as one sequence from reset, so a
+ * vector index also fixes the state it was recorded in. as5600_bootstrap
+ * re-initializes the handle before every window, so each of its vectors is
+ * one as5600_analog_finalize_window_average_angle_u16() result through the
+ * public ADC EOC path.
+ *
+ * Each kernel declares its tolerance (0 = bit-exact, the default for all of
+ * them); --tolerance overrides one for an optimized variant that is allowed
+ * to differ. The check also reports the host time per call (harness included).
+ *
+ *   kernel_vectors --check vectors/kernel_vectors.txt [--tolerance foc_svpwm=1]
+ *   (make KERNEL=float32 vectors runs the float32 variants with their 1-LSB bounds)
+ *   kernel_vectors --record vectors/kernel_vectors.txt
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config/app_motor_test_config.h"
+#include "drivers/as5600_analog.h"
+#include "motor/motor.h"
+#include "motor/motor_3pwm.h"
+#include "motor/motor_foc_voltage.h"
+#include "motor/motor_sine_3pwm.h"
+#include "motor/motor_speed_feedback.h"
+#include "motor/motor_speed_pi.h"
+#include "sim_hal.h"
+
+#define KV_MAX_INPUTS                   8u
+#define KV_MAX_OUTPUTS                  8u
+#define KV_LINE_MAX                     256u
+/* Center-aligned TIM1 at 180 MHz, 20 kHz: ARR = f_tim / (2 * f_pwm). */
+#define KV_PWM_ARR                      4500u
+#define KV_FOC_VECTOR_COUNT             512u
+/* Dead-time compensation vectors: 500 ns -> 45 ticks at 180 MHz, firmware zero-crossing band. */
+#define KV_DEAD_TIME_COMP_NS            500u
+#define KV_SPEED_PI_VECTOR_COUNT        1024u
+#define KV_FEEDBACK_VECTOR_COUNT        1024u
+#define KV_AS5600_VECTOR_COUNT          512u
+#define KV_AS5600_WINDOW_SAMPLES        APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT
+#define KV_AS5600_SAMPLE_PERIOD_US      APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US
+/* Timing: repeat each kernel's sequence until this much host time has passed. */
+#define KV_TIMING_MIN_NS                50000000ull
+
+#if (KV_AS5600_WINDOW_SAMPLES > KV_MAX_INPUTS)
+#error "AS5600 publish window exceeds the vector input slots"
+#endif
+
+/**
+ * @brief One kernel under test.
+ *
+ */
+typedef struct {
+	const char *name;
+	uint8_t input_count;
+	uint8_t output_count;
+	uint32_t vector_count;
+	int64_t tolerance;                  /* Max |actual - recorded| per output, 0 = bit-exact. */
+	void (*reset)(void);                /* Fresh kernel state and input generator. */
+	void (*generate)(uint32_t index, int64_t *inputs);
+	void (*step)(const int64_t *inputs, int64_t *outputs);
+	int64_t *inputs;                    /* vector_count * input_count, generated */
+	int64_t *recorded;                  /* vector_count * output_count, from the vector file */
+	uint8_t *has_recorded;
+} kv_kernel_t;
+
+/**
+ * @brief Check result of one kernel.
+ *
+ */
+typedef struct {
+	uint32_t mismatch_count;
+	uint32_t missing_count;
+	uint32_t input_drift_count;         /* Generated inputs differ from the recorded ones. */
+	int64_t max_abs_diff;
+	uint32_t first_mismatch_index;
+	double ns_per_call;
+} kv_result_t;
+
+static uint32_t kv_rng_state;
+
+static motor_handle_t kv_motor_h;
+static pwm_tim1_cfg_t kv_pwm_cfg;
+static pwm_tim1_handle_t kv_pwm_h;
+static motor_3pwm_cfg_t kv_motor_3pwm_cfg;
+static motor_3pwm_handle_t kv_motor_3pwm_h;
+static motor_foc_voltage_cfg_t kv_motor_foc_voltage_cfg;
+static motor_foc_voltage_handle_t kv_motor_foc_voltage_h;
+static motor_speed_pi_cfg_t kv_motor_speed_pi_cfg;
+static motor_speed_pi_handle_t kv_motor_speed_pi_h;
+static motor_speed_feedback_cfg_t kv_motor_speed_feedback_cfg;
+static motor_speed_feedback_handle_t kv_motor_speed_feedback_h;
+static adc_handle_t kv_adc_h;
+static as5600_analog_cfg_t kv_as5600_analog_cfg;
+static as5600_analog_handle_t kv_as5600_analog_h;
+
+/* Generator state of the sequence kernels. */
+static int32_t kv_reference_mrpm;
+static int32_t kv_error_mrpm;
+static uint32_t kv_angle_q16;           /* Feedback: true angle, 1/65536 count */
+static int32_t kv_speed_q16;            /* Feedback: angle counts per sample, Q16 */
+static int32_t kv_as5600_code;          /* AS5600: noiseless code of the window center */
+static int32_t kv_as5600_step;
+
+/* AS5600: raw codes of the window being converted and the simulated clock. */
+static const int64_t *kv_as5600_codes;
+static uint8_t kv_as5600_code_index;
+static uint64_t kv_now_us;
+
+/* PI gain schedule: low-speed gains raised, high-speed gains lowered. */
+static const motor_speed_pi_gain_point_t kv_speed_pi_gain_table[] = {
+		{ .speed_mrpm = 0u,       .kp_q15 = 4000, .ki_per_s_q15 = 9000 },
+		{ .speed_mrpm = 60000u,   .kp_q15 = 2700, .ki_per_s_q15 = 6000 },
+		{ .speed_mrpm = 300000u,  .kp_q15 = 1800, .ki_per_s_q15 = 3000 },
+};
+
+static void kv_fatal(const char *msg)
+{
+	fprintf(stderr, "KV: %s\n", msg);
+	exit(2);
+}
+
+static void kv_seed(uint32_t seed)
+{
+	kv_rng_state = (seed != 0u) ? seed : 1u;
+}
+
+/**
+ * @brief Return the next xorshift32 value (reproducible per seed, host independent).
+ *
+ * @return Pseudo-random 32-bit value.
+ */
+static uint32_t kv_rand(void)
+{
+	kv_rng_state ^= kv_rng_state << 13;
+	kv_rng_state ^= kv_rng_state >> 17;
+	kv_rng_state ^= kv_rng_state << 5;
+	return kv_rng_state;
+}
+
+/**
+ * @brief Return one uniform value in [min, max].
+ *
+ */
+static int32_t kv_rand_range(int32_t min, int32_t max)
+{
+	return min + (int32_t)(kv_rand() % (uint32_t)(max - min + 1));
+}
+
+/* ---- motor_foc_voltage_apply_dq() ---- */
+
+static void kv_foc_reset(motor_3pwm_modulation_t modulation, motor_3pwm_dead_time_comp_t dead_time_comp)
+{
+	kv_motor_h = (motor_handle_t){
+			.limits = { .max_amplitude_permyriad = MOTOR_SINE_3PWM_MAX_AMPLITUDE_PERMYRIAD },
+			.status = { .is_initialized = true, .has_valid_electrical_angle = true },
+	};
+	kv_pwm_cfg = (pwm_tim1_cfg_t){ .tim_clk_hz = 180000000u };
+	kv_pwm_h = (pwm_tim1_handle_t){ .cfg = &kv_pwm_cfg, .arr = KV_PWM_ARR };
+	kv_motor_3pwm_cfg = (motor_3pwm_cfg_t){
+			.pwm_h = &kv_pwm_h,
+			.modulation = modulation,
+			.dead_time_comp = dead_time_comp,
+			.dead_time_comp_ns = KV_DEAD_TIME_COMP_NS,
+			.dead_time_comp_band = APP_MOTOR_TEST_DEAD_TIME_COMP_COMMAND_BAND_PERMYRIAD,
+	};
+	kv_motor_foc_voltage_cfg = (motor_foc_voltage_cfg_t){
+			.motor_h = &kv_motor_h,
+			.motor_3pwm_h = &kv_motor_3pwm_h,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+	};
+	sim_hal_reset();
+	if ((!motor_3pwm_init(&kv_motor_3pwm_h, &kv_motor_3pwm_cfg)) ||
+		(!motor_foc_voltage_init(&kv_motor_foc_voltage_h, &kv_motor_foc_voltage_cfg)) ||
+		(!motor_3pwm_start(&kv_motor_3pwm_h)))
+	{
+		kv_fatal("foc init failed");
+	}
+	kv_seed(0x464f4321u);
+}
+
+static void kv_foc_sine_reset(void) { kv_foc_reset(MOTOR_3PWM_MODULATION_SINE, MOTOR_3PWM_DEAD_TIME_COMP_OFF); }
+static void kv_foc_svpwm_reset(void) { kv_foc_reset(MOTOR_3PWM_MODULATION_SVPWM, MOTOR_3PWM_DEAD_TIME_COMP_OFF); }
+static void kv_foc_dpwm_reset(void) { kv_foc_reset(MOTOR_3PWM_MODULATION_DPWM, MOTOR_3PWM_DEAD_TIME_COMP_OFF); }
+static void kv_foc_svpwm_dtc_reset(void)
+{
+	kv_foc_reset(MOTOR_3PWM_MODULATION_SVPWM, MOTOR_3PWM_DEAD_TIME_COMP_COMMAND);
+}
+
+/**
+ * @brief Inputs: electrical angle, Ud, Uq (permyriad).
+ *
+ * 0..63: full-turn sweep at +Uq; 64..127: the same sweep at -Uq and Ud;
+ * 128..143: int16 extremes and zero; then uniform random inside and beyond
+ * the 10000 permyriad modulation limit.
+ */
+static void kv_foc_generate(uint32_t index, int64_t *inputs)
+{
+	static const int16_t extremes[][2] = {
+			{ 0, 0 }, { 0, 10000 }, { 0, -10000 }, { 10000, 0 }, { -10000, 0 },
+			{ 7071, 7071 }, { -7071, 7071 }, { 32767, 32767 }, { -32768, -32768 },
+			{ 32767, -32768 }, { 0, 32767 }, { 0, -32768 }, { 1, -1 }, { -1, 1 },
+			{ 11547, 0 }, { 0, 11547 },
+	};
+
+	if (index < 64u)
+	{
+		inputs[0] = (int64_t)(index * 1024u);
+		inputs[1] = 0;
+		inputs[2] = 5000;
+	}
+	else if (index < 128u)
+	{
+		inputs[0] = (int64_t)(((index - 64u) * 1024u) + 511u);
+		inputs[1] = 2500;
+		inputs[2] = -8000;
+	}
+	else if (index < (128u + (sizeof(extremes) / sizeof(extremes[0]))))
+	{
+		inputs[0] = (int64_t)((index * 40503u) & 0xFFFFu);
+		inputs[1] = extremes[index - 128u][0];
+		inputs[2] = extremes[index - 128u][1];
+	}
+	else
+	{
+		inputs[0] = (int64_t)(kv_rand() & 0xFFFFu);
+		inputs[1] = kv_rand_range(-6000, 6000);
+		inputs[2] = kv_rand_range(-13000, 13000);
+	}
+}
+
+/**
+ * @brief Outputs: return value, phase A/B/C CCR ticks.
+ *
+ */
+static void kv_foc_step(const int64_t *inputs, int64_t *outputs)
+{
+	kv_motor_h.measurements.electrical_angle_u16 = (uint16_t)inputs[0];
+	outputs[0] = motor_foc_voltage_apply_dq(&kv_motor_foc_voltage_h, (int16_t)inputs[1], (int16_t)inputs[2]);
+	outputs[1] = kv_motor_3pwm_h.phase_a_duty_ticks;
+	outputs[2] = kv_motor_3pwm_h.phase_b_duty_ticks;
+	outputs[3] = kv_motor_3pwm_h.phase_c_duty_ticks;
+}
+
+/**
+ * @brief Outputs: as kv_foc_step(), then the phase A/B/C dead-time polarity.
+ *
+ * The polarity comes from the phase commands before the zero sequence, so
+ * the compensated ticks follow the line-to-line command, not the offset.
+ */
+static void kv_foc_dtc_step(const int64_t *inputs, int64_t *outputs)
+{
+	kv_foc_step(inputs, outputs);
+	outputs[4] = kv_motor_3pwm_h.phase_a_polarity;
+	outputs[5] = kv_motor_3pwm_h.phase_b_polarity;
+	outputs[6] = kv_motor_3pwm_h.phase_c_polarity;
+}
+
+/* ---- motor_speed_pi_update() ---- */
+
+static void kv_speed_pi_reset_common(const motor_speed_pi_gain_point_t *gain_table, uint8_t gain_table_count)
+{
+	kv_motor_h = (motor_handle_t){ .status = { .is_initialized = true } };
+	/* Firmware gains and limits, feedforward terms enabled so their saturation paths are covered. */
+	kv_motor_speed_pi_cfg = (motor_speed_pi_cfg_t){
+			.motor_h = &kv_motor_h,
+			.kp_q15 = APP_MOTOR_TEST_SPEED_PI_KP_Q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.output_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.current_limit_ma = 0,
+			.ff_speed_q15 = 700,
+			.ff_acceleration_q15 = 40,
+			.ff_friction_permyriad = 300u,
+			.ff_friction_deadband_mrpm = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_DEADBAND_MRPM,
+			.ff_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_LIMIT_PERMYRIAD,
+			.gain_table = gain_table,
+			.gain_table_count = gain_table_count,
+	};
+	if (!motor_speed_pi_init(&kv_motor_speed_pi_h, &kv_motor_speed_pi_cfg)) kv_fatal("speed_pi init failed");
+	kv_seed(0x50493135u);
+	kv_reference_mrpm = 0;
+	kv_error_mrpm = 0;
+}
+
+static void kv_speed_pi_reset(void)
+{
+	kv_speed_pi_reset_common(NULL, 0u);
+}
+
+static void kv_speed_pi_sched_reset(void)
+{
+	kv_speed_pi_reset_common(kv_speed_pi_gain_table,
+							 (uint8_t)(sizeof(kv_speed_pi_gain_table) / sizeof(kv_speed_pi_gain_table[0])));
+}
+
+/**
+ * @brief Inputs: reference speed, reference acceleration, measured speed.
+ *
+ * Reference ramps through +/-400 rpm with holds; the tracking error is a
+ * random walk with occasional steps large enough to saturate the output
+ * and wind the integrator into its clamp, then recover.
+ */
+static void kv_speed_pi_generate(uint32_t index, int64_t *inputs)
+{
+	int32_t acceleration_mrpm_per_s = 0;
+	uint32_t phase = index % 512u;
+
+	if (phase < 128u) acceleration_mrpm_per_s = 3000000;
+	else if ((phase >= 192u) && (phase < 448u)) acceleration_mrpm_per_s = -3000000;
+	else if (phase >= 448u) acceleration_mrpm_per_s = 3000000;
+	kv_reference_mrpm += acceleration_mrpm_per_s / 1000;
+
+	kv_error_mrpm += kv_rand_range(-2000, 2000);
+	if ((kv_rand() % 97u) == 0u) kv_error_mrpm += kv_rand_range(-400000, 400000);
+	kv_error_mrpm -= kv_error_mrpm / 16;
+
+	inputs[0] = kv_reference_mrpm;
+	inputs[1] = acceleration_mrpm_per_s;
+	inputs[2] = (int64_t)kv_reference_mrpm - kv_error_mrpm;
+}
+
+/**
+ * @brief Outputs: return value, Uq command, integrator, feedforward term, speed error.
+ *
+ */
+static void kv_speed_pi_step(const int64_t *inputs, int64_t *outputs)
+{
+	outputs[0] = motor_speed_pi_update(&kv_motor_speed_pi_h, (int32_t)inputs[0], (int32_t)inputs[1],
+									   (int32_t)inputs[2]);
+	outputs[1] = kv_motor_h.speed_pi.speed_control_uq_command_permyriad;
+	outputs[2] = kv_motor_h.speed_pi.integrator_term_permyriad;
+	outputs[3] = kv_motor_h.speed_pi.feedforward_term_permyriad;
+	outputs[4] = kv_motor_h.speed_pi.speed_error_mrpm;
+}
+
+/* ---- motor_speed_feedback_update() ---- */
+
+static void kv_feedback_reset(motor_speed_feedback_mode_t mode)
+{
+	kv_motor_h = (motor_handle_t){ .status = { .is_initialized = true } };
+	kv_motor_speed_feedback_cfg = (motor_speed_feedback_cfg_t){
+			.motor_h = &kv_motor_h,
+			.sample_period_us = KV_AS5600_SAMPLE_PERIOD_US * KV_AS5600_WINDOW_SAMPLES,
+			.filter_time_constant_ms = APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.mode = mode,
+			.pll_bandwidth_hz = APP_MOTOR_TEST_SPEED_FEEDBACK_PLL_BANDWIDTH_HZ,
+	};
+	if (!motor_speed_feedback_init(&kv_motor_speed_feedback_h, &kv_motor_speed_feedback_cfg))
+	{
+		kv_fatal("speed_feedback init failed");
+	}
+	kv_seed(0x53504446u);
+	kv_angle_q16 = 0xFFF00000u;         /* Starts just below the wrap */
+	kv_speed_q16 = 0;
+}
+
+static void kv_feedback_lpf_reset(void) { kv_feedback_reset(MOTOR_SPEED_FEEDBACK_MODE_LPF); }
+static void kv_feedback_pll_reset(void) { kv_feedback_reset(MOTOR_SPEED_FEEDBACK_MODE_PLL); }
+
+/**
+ * @brief Inputs: measured mechanical angle, sample period.
+ *
+ * The true speed follows a random walk through both directions (several
+ * wraps per sequence), the measured angle adds +/-8 counts of noise and a
+ * rare glitch; every 128 samples the publish window length changes.
+ */
+static void kv_feedback_generate(uint32_t index, int64_t *inputs)
+{
+	static const uint32_t sample_periods_us[] = { 500u, 300u, 1000u, 500u, 200u, 800u, 500u, 1600u };
+
+	kv_speed_q16 += kv_rand_range(-1500000, 1500000);
+	if (kv_speed_q16 > 60000000) kv_speed_q16 = 60000000;
+	if (kv_speed_q16 < -60000000) kv_speed_q16 = -60000000;
+	kv_angle_q16 += (uint32_t)kv_speed_q16;
+
+	int32_t noise_counts = kv_rand_range(-8, 8);
+	if ((kv_rand() % 211u) == 0u) noise_counts += kv_rand_range(-4000, 4000);
+
+	inputs[0] = (int64_t)(uint16_t)((kv_angle_q16 >> 16) + (uint32_t)noise_counts);
+	inputs[1] = sample_periods_us[(index / 128u) % (sizeof(sample_periods_us) / sizeof(sample_periods_us[0]))];
+}
+
+/**
+ * @brief Outputs: return value, raw / filtered / measured speed, observer angle and error.
+ *
+ */
+static void kv_feedback_step(const int64_t *inputs, int64_t *outputs)
+{
+	bool is_ok = motor_speed_feedback_set_sample_period(&kv_motor_speed_feedback_h, (uint32_t)inputs[1]);
+
+	is_ok = motor_speed_feedback_update(&kv_motor_speed_feedback_h, (uint16_t)inputs[0]) && is_ok;
+	outputs[0] = is_ok;
+	outputs[1] = kv_motor_h.speed_feedback.raw_mechanical_speed_mrpm;
+	outputs[2] = kv_motor_h.speed_feedback.filtered_mechanical_speed_mrpm;
+	outputs[3] = kv_motor_h.measurements.measured_mechanical_speed_mrpm;
+	outputs[4] = kv_motor_h.speed_feedback.observer_mechanical_angle_u16;
+	outputs[5] = kv_motor_h.speed_feedback.observer_angle_error_counts;
+}
+
+/* ---- AS5600 publish window ---- */
+
+/**
+ * @brief ADC source of the window being converted (sim_hal_adc_source_t).
+ *
+ */
+static uint16_t kv_as5600_sample_adc(void *arg)
+{
+	(void)arg;
+	return (uint16_t)kv_as5600_codes[kv_as5600_code_index++];
+}
+
+static void kv_as5600_init_handle(void)
+{
+	sim_hal_reset();
+	sim_hal_set_time_us(kv_now_us);
+	kv_adc_h = (adc_handle_t){0};
+	if ((!sim_hal_attach_adc(&kv_adc_h, kv_as5600_sample_adc, NULL, 0u)) ||
+		(!as5600_analog_init(&kv_as5600_analog_h, &kv_as5600_analog_cfg)))
+	{
+		kv_fatal("as5600 init failed");
+	}
+}
+
+static void kv_as5600_reset(void)
+{
+	kv_as5600_analog_cfg = (as5600_analog_cfg_t){
+			.adc_h = &kv_adc_h,
+			.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
+			.raw_sample_period_us = KV_AS5600_SAMPLE_PERIOD_US,
+			.raw_sample_phase_us = 0u,
+			.raw_samples_per_publish = KV_AS5600_WINDOW_SAMPLES,
+			.wrap_correction_threshold_counts = (uint16_t)APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS,
+			.max_plausible_delta_per_publish_counts =
+					(uint16_t)APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
+			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
+					AS5600_ANALOG_DIRECTION_REVERSE :
+					AS5600_ANALOG_DIRECTION_FORWARD,
+			.acquisition_mode = AS5600_ANALOG_ACQUISITION_SOFTWARE,
+			.dma_h = NULL,
+			.adc_trigger = ADC_EXT_TRIGGER_TIM2_TRGO,
+	};
+	kv_now_us = 0u;
+	kv_as5600_init_handle();
+	kv_seed(0x41533536u);
+	kv_as5600_code = 4000;              /* Starts just below the wrap */
+	kv_as5600_step = 0;
+}
+
+/**
+ * @brief Inputs: the raw ADC codes of one publish window.
+ *
+ * The window center moves with a random-walk speed across the 0 / full-scale
+ * wrap in both directions; codes carry +/-6 counts of noise, are clipped at
+ * the rails like the analog output and some windows hold one outlier.
+ */
+static void kv_as5600_generate(uint32_t index, int64_t *inputs)
+{
+	const int32_t full_scale = (int32_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE;
+
+	(void)index;
+	kv_as5600_step += kv_rand_range(-3, 3);
+	if (kv_as5600_step > 40) kv_as5600_step = 40;
+	if (kv_as5600_step < -40) kv_as5600_step = -40;
+
+	for (uint8_t i = 0u; i < KV_AS5600_WINDOW_SAMPLES; i++)
+	{
+		kv_as5600_code += kv_as5600_step / 4;
+		kv_as5600_code = ((kv_as5600_code % (full_scale + 1)) + (full_scale + 1)) % (full_scale + 1);
+
+		int32_t code = kv_as5600_code + kv_rand_range(-6, 6);
+		if ((kv_rand() % 53u) == 0u) code += kv_rand_range(-1500, 1500);
+		if (code < 0) code = ((kv_rand() & 1u) != 0u) ? 0 : code + full_scale + 1;
+		if (code > full_scale) code = ((kv_rand() & 1u) != 0u) ? full_scale : code - full_scale - 1;
+		inputs[i] = code;
+	}
+}
+
+/**
+ * @brief Convert one window through the software-mode EOC path.
+ *
+ * Outputs: published flag, published angle, window-center timestamp offset
+ * from the last raw sample, reported sample period.
+ */
+static void kv_as5600_convert_window(const int64_t *inputs, int64_t *outputs)
+{
+	as5600_analog_published_sample_t published_sample = {0};
+	uint64_t last_sample_us = 0u;
+
+	kv_as5600_codes = inputs;
+	kv_as5600_code_index = 0u;
+	for (uint8_t i = 0u; i < KV_AS5600_WINDOW_SAMPLES; i++)
+	{
+		/* SWSTART samples the source, the next service delivers the EOC. */
+		(void)as5600_analog_service(&kv_as5600_analog_h, kv_now_us);
+		last_sample_us = kv_now_us;
+		(void)sim_hal_service();
+		kv_now_us += KV_AS5600_SAMPLE_PERIOD_US;
+		sim_hal_set_time_us(kv_now_us);
+	}
+
+	bool has_sample = as5600_analog_consume_published_sample(&kv_as5600_analog_h, &published_sample);
+	outputs[0] = has_sample;
+	outputs[1] = has_sample ? published_sample.mechanical_angle_u16 : -1;
+	outputs[2] = has_sample ? (int64_t)(last_sample_us - published_sample.capture_timestamp_us) : -1;
+	outputs[3] = has_sample ? (int64_t)published_sample.sample_period_us : -1;
+}
+
+static void kv_as5600_bootstrap_step(const int64_t *inputs, int64_t *outputs)
+{
+	/* No published anchor: the window publishes its wrap-safe average. */
+	kv_as5600_init_handle();
+	kv_as5600_convert_window(inputs, outputs);
+}
+
+static void kv_as5600_window_step(const int64_t *inputs, int64_t *outputs)
+{
+	kv_as5600_convert_window(inputs, outputs);
+}
+
+static kv_kernel_t kv_kernels[] = {
+		{ .name = "foc_sine", .input_count = 3u, .output_count = 4u, .vector_count = KV_FOC_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_foc_sine_reset, .generate = kv_foc_generate, .step = kv_foc_step },
+		{ .name = "foc_svpwm", .input_count = 3u, .output_count = 4u, .vector_count = KV_FOC_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_foc_svpwm_reset, .generate = kv_foc_generate, .step = kv_foc_step },
+		{ .name = "foc_dpwm", .input_count = 3u, .output_count = 4u, .vector_count = KV_FOC_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_foc_dpwm_reset, .generate = kv_foc_generate, .step = kv_foc_step },
+		{ .name = "foc_svpwm_dtc", .input_count = 3u, .output_count = 7u, .vector_count = KV_FOC_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_foc_svpwm_dtc_reset, .generate = kv_foc_generate, .step = kv_foc_dtc_step },
+		{ .name = "speed_pi", .input_count = 3u, .output_count = 5u, .vector_count = KV_SPEED_PI_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_speed_pi_reset, .generate = kv_speed_pi_generate, .step = kv_speed_pi_step },
+		{ .name = "speed_pi_sched", .input_count = 3u, .output_count = 5u, .vector_count = KV_SPEED_PI_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_speed_pi_sched_reset, .generate = kv_speed_pi_generate,
+		  .step = kv_speed_pi_step },
+		{ .name = "feedback_lpf", .input_count = 2u, .output_count = 6u, .vector_count = KV_FEEDBACK_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_feedback_lpf_reset, .generate = kv_feedback_generate,
+		  .step = kv_feedback_step },
+		{ .name = "feedback_pll", .input_count = 2u, .output_count = 6u, .vector_count = KV_FEEDBACK_VECTOR_COUNT,
+		  .tolerance = 0, .reset = kv_feedback_pll_reset, .generate = kv_feedback_generate,
+		  .step = kv_feedback_step },
+		{ .name = "as5600_bootstrap", .input_count = KV_AS5600_WINDOW_SAMPLES, .output_count = 4u,
+		  .vector_count = KV_AS5600_VECTOR_COUNT, .tolerance = 0, .reset = kv_as5600_reset,
+		  .generate = kv_as5600_generate, .step = kv_as5600_bootstrap_step },
+		{ .name = "as5600_window", .input_count = KV_AS5600_WINDOW_SAMPLES, .output_count = 4u,
+		  .vector_count = KV_AS5600_VECTOR_COUNT, .tolerance = 0, .reset = kv_as5600_reset,
+		  .generate = kv_as5600_generate, .step = kv_as5600_window_step },
+};
+
+#define KV_KERNEL_COUNT     (sizeof(kv_kernels) / sizeof(kv_kernels[0]))
+
+static kv_kernel_t *kv_find_kernel(const char *name)
+{
+	for (size_t k = 0u; k < KV_KERNEL_COUNT; k++)
+	{
+		if (strcmp(kv_kernels[k].name, name) == 0) return &kv_kernels[k];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Generate the input sequence of one kernel (the generator runs from its reset state).
+ *
+ */
+static void kv_generate_inputs(kv_kernel_t *kernel)
+{
+	kernel->inputs = calloc((size_t)kernel->vector_count * kernel->input_count, sizeof(int64_t));
+	kernel->recorded = calloc((size_t)kernel->vector_count * kernel->output_count, sizeof(int64_t));
+	kernel->has_recorded = calloc(kernel->vector_count, 1u);
+	if ((kernel->inputs == NULL) || (kernel->recorded == NULL) || (kernel->has_recorded == NULL))
+	{
+		kv_fatal("out of memory");
+	}
+
+	kernel->reset();
+	for (uint32_t i = 0u; i < kernel->vector_count; i++)
+	{
+		kernel->generate(i, &kernel->inputs[(size_t)i * kernel->input_count]);
+	}
+}
+
+static double kv_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * @brief Record the reference outputs of every kernel.
+ *
+ */
+static void kv_record(const char *path)
+{
+	FILE *file = fopen(path, "w");
+	int64_t outputs[KV_MAX_OUTPUTS];
+
+	if (file == NULL) kv_fatal("cannot open vector file for writing");
+	fprintf(file, "# Golden vectors of the fixed-point kernels, recorded by sim/kernel_vectors.\n"
+				  "# kernel index inputs... | outputs...  (see sim/kernel_vectors.c for the fields)\n");
+	for (size_t k = 0u; k < KV_KERNEL_COUNT; k++)
+	{
+		kv_kernel_t *kernel = &kv_kernels[k];
+
+		kernel->reset();
+		for (uint32_t i = 0u; i < kernel->vector_count; i++)
+		{
+			const int64_t *inputs = &kernel->inputs[(size_t)i * kernel->input_count];
+
+			kernel->step(inputs, outputs);
+			fprintf(file, "%s %u", kernel->name, (unsigned)i);
+			for (uint8_t n = 0u; n < kernel->input_count; n++) fprintf(file, " %lld", (long long)inputs[n]);
+			fprintf(file, " |");
+			for (uint8_t n = 0u; n < kernel->output_count; n++) fprintf(file, " %lld", (long long)outputs[n]);
+			fprintf(file, "\n");
+		}
+		printf("KV %s recorded=%u\n", kernel->name, (unsigned)kernel->vector_count);
+	}
+	fclose(file);
+}
+
+/**
+ * @brief Load the recorded outputs; count vectors whose inputs no longer match the generator.
+ *
+ */
+static void kv_load(const char *path, kv_result_t results[])
+{
+	FILE *file = fopen(path, "r");
+	char line[KV_LINE_MAX];
+	unsigned line_number = 0u;
+
+	if (file == NULL) kv_fatal("cannot open vector file");
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		char *save = NULL;
+		char *token = strtok_r(line, " \t\r\n", &save);
+
+		line_number++;
+		if ((token == NULL) || (token[0] == '#')) continue;
+
+		kv_kernel_t *kernel = kv_find_kernel(token);
+		token = strtok_r(NULL, " \t\r\n", &save);
+		if ((kernel == NULL) || (token == NULL))
+		{
+			fprintf(stderr, "KV: %s:%u: unknown kernel or missing index\n", path, line_number);
+			exit(2);
+		}
+		uint32_t index = (uint32_t)strtoul(token, NULL, 10);
+		if (index >= kernel->vector_count) continue;
+
+		kv_result_t *result = &results[kernel - kv_kernels];
+		const int64_t *inputs = &kernel->inputs[(size_t)index * kernel->input_count];
+		bool has_drift = false;
+		for (uint8_t n = 0u; n < kernel->input_count; n++)
+		{
+			token = strtok_r(NULL, " \t\r\n", &save);
+			if ((token == NULL) || (strtoll(token, NULL, 10) != inputs[n])) has_drift = true;
+		}
+		token = strtok_r(NULL, " \t\r\n", &save);
+		if ((token == NULL) || (strcmp(token, "|") != 0)) has_drift = true;
+
+		int64_t *recorded = &kernel->recorded[(size_t)index * kernel->output_count];
+		for (uint8_t n = 0u; (n < kernel->output_count) && (has_drift == false); n++)
+		{
+			token = strtok_r(NULL, " \t\r\n", &save);
+			if (token == NULL) has_drift = true;
+			else recorded[n] = strtoll(token, NULL, 10);
+		}
+		if (has_drift) result->input_drift_count++;
+		else kernel->has_recorded[index] = 1u;
+	}
+	fclose(file);
+}
+
+/**
+ * @brief Run one kernel against its recorded outputs, then time its sequence.
+ *
+ */
+static void kv_check_kernel(kv_kernel_t *kernel, kv_result_t *result)
+{
+	int64_t outputs[KV_MAX_OUTPUTS];
+
+	kernel->reset();
+	for (uint32_t i = 0u; i < kernel->vector_count; i++)
+	{
+		const int64_t *recorded = &kernel->recorded[(size_t)i * kernel->output_count];
+		bool is_mismatch = false;
+
+		kernel->step(&kernel->inputs[(size_t)i * kernel->input_count], outputs);
+		if (kernel->has_recorded[i] == 0u)
+		{
+			result->missing_count++;
+			continue;
+		}
+		for (uint8_t n = 0u; n < kernel->output_count; n++)
+		{
+			int64_t diff = llabs(outputs[n] - recorded[n]);
+
+			if (diff > result->max_abs_diff) result->max_abs_diff = diff;
+			if (diff > kernel->tolerance) is_mismatch = true;
+		}
+		if (is_mismatch)
+		{
+			if (result->mismatch_count == 0u) result->first_mismatch_index = i;
+			result->mismatch_count++;
+		}
+	}
+
+	uint64_t call_count = 0u;
+	double start_ns = kv_now_ns();
+	double elapsed_ns = 0.0;
+	do
+	{
+		kernel->reset();
+		for (uint32_t i = 0u; i < kernel->vector_count; i++)
+		{
+			kernel->step(&kernel->inputs[(size_t)i * kernel->input_count], outputs);
+		}
+		call_count += kernel->vector_count;
+		elapsed_ns = kv_now_ns() - start_ns;
+	} while (elapsed_ns < (double)KV_TIMING_MIN_NS);
+	result->ns_per_call = elapsed_ns / (double)call_count;
+}
+
+static void kv_usage(const char *program)
+{
+	fprintf(stderr,
+			"usage: %s --check FILE [--tolerance KERNEL=N]... [--kernel NAME]\n"
+			"       %s --record FILE\n",
+			program, program);
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	const char *check_path = NULL;
+	const char *record_path = NULL;
+	const char *only_kernel = NULL;
+	kv_result_t results[KV_KERNEL_COUNT] = {0};
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *key = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (value == NULL) kv_usage(argv[0]);
+		i++;
+		if (strcmp(key, "--check") == 0) check_path = value;
+		else if (strcmp(key, "--record") == 0) record_path = value;
+		else if (strcmp(key, "--kernel") == 0) only_kernel = value;
+		else if (strcmp(key, "--tolerance") == 0)
+		{
+			char name[64];
+			long long tolerance = 0;
+			kv_kernel_t *kernel = NULL;
+
+			if ((sscanf(value, "%63[^=]=%lld", name, &tolerance) != 2) || (tolerance < 0) ||
+				((kernel = kv_find_kernel(name)) == NULL))
+			{
+				kv_usage(argv[0]);
+			}
+			kernel->tolerance = tolerance;
+		}
+		else kv_usage(argv[0]);
+	}
+	if ((check_path == NULL) == (record_path == NULL)) kv_usage(argv[0]);
+	if ((only_kernel != NULL) && (kv_find_kernel(only_kernel) == NULL)) kv_usage(argv[0]);
+
+	for (size_t k = 0u; k < KV_KERNEL_COUNT; k++)
+	{
+		kv_generate_inputs(&kv_kernels[k]);
+	}
+
+	if (record_path != NULL)
+	{
+		kv_record(record_path);
+		return 0;
+	}
+
+	kv_load(check_path, results);
+
+	bool has_failed = false;
+	for (size_t k = 0u; k < KV_KERNEL_COUNT; k++)
+	{
+		kv_kernel_t *kernel = &kv_kernels[k];
+		kv_result_t *result = &results[k];
+
+		if ((only_kernel != NULL) && (strcmp(kernel->name, only_kernel) != 0)) continue;
+		kv_check_kernel(kernel, result);
+
+		bool has_passed = (result->mismatch_count == 0u) && (result->missing_count == 0u) &&
+						  (result->input_drift_count == 0u);
+		printf("KV %-16s vectors=%u mismatches=%u missing=%u input_drift=%u max_abs_diff=%lld tolerance=%lld "
+			   "ns_per_call=%.1f %s",
+			   kernel->name, (unsigned)kernel->vector_count, (unsigned)result->mismatch_count,
+			   (unsigned)result->missing_count, (unsigned)result->input_drift_count,
+			   (long long)result->max_abs_diff, (long long)kernel->tolerance, result->ns_per_call,
+			   has_passed ? "PASS" : "FAIL");
+		if (result->mismatch_count != 0u) printf(" first_mismatch=%u", (unsigned)result->first_mismatch_index);
+		printf("\n");
+		has_failed = has_failed || (has_passed == false);
+	}
+	printf("KV result=%s\n", has_failed ? "FAIL" : "PASS");
+	return has_failed ? 1 : 0;
+}
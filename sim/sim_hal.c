@@ -0,0 +1,286 @@
+/**
+ * @file sim_hal.c
+ * @brief Host replacement of the driver layer below the motor modules (SIL build).
+ *
+ * Implements the driver entry points the motor modules and as5600_analog
+ * call (pwm_tim1_*, adc_*, dma_register_callbacks, SYSTICK_*) on top of the
+ * simulated time, so those modules link unchanged.
+ */
+
+#include "sim_hal.h"
+#include "drivers/systick.h"
+#include <stddef.h>
+
+#define SIM_HAL_MAX_PWM		PWM_TIM1_INSTANCE_COUNT
+#define SIM_HAL_MAX_ADC		2u
+
+typedef struct {
+	const pwm_tim1_handle_t *pwm_h;
+	uint16_t duty_ticks[3];
+	bool is_running;
+} sim_hal_pwm_t;
+
+typedef struct {
+	adc_handle_t *adc_h;
+	sim_hal_adc_source_t source;
+	void *source_arg;
+	bool conversion_pending;
+	uint16_t pending_value;
+	/* TIM2-triggered DMA path */
+	uint32_t trigger_period_us;
+	uint64_t next_trigger_us;
+	dma_handle_t *dma_h;
+	volatile uint16_t *dma_buffer;
+	uint16_t dma_length;
+	uint16_t dma_index;
+} sim_hal_adc_t;
+
+TIM_TypeDef SIM_TIM5;
+
+static uint64_t sim_hal_now_us;
+static sim_hal_pwm_t sim_hal_pwm[SIM_HAL_MAX_PWM];
+static sim_hal_adc_t sim_hal_adc[SIM_HAL_MAX_ADC];
+
+static sim_hal_pwm_t *sim_hal_find_pwm(const pwm_tim1_handle_t *pwm_h, bool create)
+{
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_PWM; i++)
+	{
+		if (sim_hal_pwm[i].pwm_h == pwm_h) return &sim_hal_pwm[i];
+	}
+	if (create == false) return NULL;
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_PWM; i++)
+	{
+		if (sim_hal_pwm[i].pwm_h == NULL)
+		{
+			sim_hal_pwm[i].pwm_h = pwm_h;
+			return &sim_hal_pwm[i];
+		}
+	}
+	return NULL;
+}
+
+static sim_hal_adc_t *sim_hal_find_adc(const adc_handle_t *adc_h)
+{
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_ADC; i++)
+	{
+		if ((sim_hal_adc[i].adc_h != NULL) && (sim_hal_adc[i].adc_h == adc_h)) return &sim_hal_adc[i];
+	}
+	return NULL;
+}
+
+void sim_hal_reset(void)
+{
+	sim_hal_now_us = 0u;
+	SIM_TIM5.CNT = 0u;
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_PWM; i++)
+	{
+		sim_hal_pwm[i] = (sim_hal_pwm_t){0};
+	}
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_ADC; i++)
+	{
+		sim_hal_adc[i] = (sim_hal_adc_t){0};
+	}
+}
+
+void sim_hal_set_time_us(uint64_t now_us)
+{
+	if (now_us > sim_hal_now_us) sim_hal_now_us = now_us;
+	SIM_TIM5.CNT = (uint32_t)sim_hal_now_us;
+}
+
+bool sim_hal_attach_adc(adc_handle_t *adc_h, sim_hal_adc_source_t source, void *source_arg,
+						uint32_t trigger_period_us)
+{
+	if ((adc_h == NULL) || (source == NULL)) return false;
+
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_ADC; i++)
+	{
+		if ((sim_hal_adc[i].adc_h == NULL) || (sim_hal_adc[i].adc_h == adc_h))
+		{
+			sim_hal_adc[i] = (sim_hal_adc_t){
+					.adc_h = adc_h,
+					.source = source,
+					.source_arg = source_arg,
+					.trigger_period_us = trigger_period_us,
+			};
+			return true;
+		}
+	}
+	return false;
+}
+
+bool sim_hal_service(void)
+{
+	bool has_completed = false;
+
+	for (uint8_t i = 0u; i < SIM_HAL_MAX_ADC; i++)
+	{
+		sim_hal_adc_t *adc = &sim_hal_adc[i];
+
+		if (adc->adc_h == NULL) continue;
+
+		/* Software start: the EOC interrupt of the conversion started in the last pass. */
+		if (adc->conversion_pending)
+		{
+			adc->conversion_pending = false;
+			has_completed = true;
+			adc->adc_h->last_reading = adc->pending_value;
+			adc->adc_h->adc_data_ready = true;
+			if (adc->adc_h->eoc_callback != NULL)
+			{
+				adc->adc_h->eoc_callback(adc->adc_h->eoc_callback_arg);
+			}
+		}
+
+		/* Triggered DMA: one conversion per trigger edge, HT / TC at the buffer halves. */
+		if ((adc->dma_buffer == NULL) || (adc->trigger_period_us == 0u)) continue;
+		while (sim_hal_now_us >= adc->next_trigger_us)
+		{
+			adc->dma_buffer[adc->dma_index++] = adc->source(adc->source_arg);
+			adc->next_trigger_us += adc->trigger_period_us;
+			has_completed = true;
+			if ((adc->dma_index == (adc->dma_length / 2u)) && (adc->dma_h->half_transfer_callback != NULL))
+			{
+				adc->dma_h->half_transfer_callback(adc->dma_h->callback_arg);
+			}
+			if (adc->dma_index >= adc->dma_length)
+			{
+				adc->dma_index = 0u;
+				if (adc->dma_h->transfer_complete_callback != NULL)
+				{
+					adc->dma_h->transfer_complete_callback(adc->dma_h->callback_arg);
+				}
+			}
+		}
+	}
+	return has_completed;
+}
+
+bool sim_hal_get_pwm_duty(const pwm_tim1_handle_t *pwm_h, double duty[3])
+{
+	const sim_hal_pwm_t *pwm = sim_hal_find_pwm(pwm_h, false);
+
+	if ((pwm == NULL) || (duty == NULL) || (pwm_h->arr == 0u)) return false;
+
+	for (uint8_t ch = 0u; ch < 3u; ch++)
+	{
+		duty[ch] = (double)pwm->duty_ticks[ch] / (double)pwm_h->arr;
+	}
+	return pwm->is_running;
+}
+
+/* ---- driver entry points used by the motor modules ---- */
+
+uint64_t SYSTICK_GetTimeUs(void)
+{
+	return sim_hal_now_us;
+}
+
+uint32_t SYSTICK_GetTimeMs(void)
+{
+	return (uint32_t)(sim_hal_now_us / 1000u);
+}
+
+bool pwm_tim1_set_duty(pwm_tim1_handle_t *pwm_h, uint8_t ch, uint16_t duty)
+{
+	sim_hal_pwm_t *pwm = sim_hal_find_pwm(pwm_h, true);
+
+	if ((pwm == NULL) || (ch < 1u) || (ch > 3u)) return false;
+	pwm->duty_ticks[ch - 1u] = (duty > pwm_h->arr) ? pwm_h->arr : duty;
+	return true;
+}
+
+bool pwm_tim1_set_duty_abc(pwm_tim1_handle_t *pwm_h, uint16_t duty_a, uint16_t duty_b, uint16_t duty_c)
+{
+	/* One control step writes all phases before the plant advances: already grouped. */
+	return (pwm_tim1_set_duty(pwm_h, 1u, duty_a) &&
+			pwm_tim1_set_duty(pwm_h, 2u, duty_b) &&
+			pwm_tim1_set_duty(pwm_h, 3u, duty_c));
+}
+
+bool pwm_tim1_start(pwm_tim1_handle_t *pwm_h)
+{
+	sim_hal_pwm_t *pwm = sim_hal_find_pwm(pwm_h, true);
+
+	if (pwm == NULL) return false;
+	pwm->is_running = true;
+	return true;
+}
+
+bool pwm_tim1_stop(pwm_tim1_handle_t *pwm_h)
+{
+	sim_hal_pwm_t *pwm = sim_hal_find_pwm(pwm_h, true);
+
+	if (pwm == NULL) return false;
+	pwm->is_running = false;
+	return true;
+}
+
+bool pwm_tim1_start_staggered(pwm_tim1_handle_t *const pwm_hs[], uint8_t count, uint32_t lock_prio)
+{
+	(void)lock_prio;
+	for (uint8_t i = 0u; i < count; i++)
+	{
+		if (!pwm_tim1_start(pwm_hs[i])) return false;
+	}
+	return true;
+}
+
+void adc_start(adc_handle_t *adc_h)
+{
+	sim_hal_adc_t *adc = sim_hal_find_adc(adc_h);
+
+	if (adc == NULL) return;
+	/* Sample at the start; the result is delivered by the next sim_hal_service() (EOC). */
+	adc->pending_value = adc->source(adc->source_arg);
+	adc->conversion_pending = true;
+}
+
+bool adc_read(adc_handle_t *adc_h, uint16_t *value)
+{
+	if ((adc_h == NULL) || (value == NULL)) return false;
+	if (adc_h->adc_data_ready == false) return false;
+
+	*value = adc_h->last_reading;
+	adc_h->adc_data_ready = false;
+	return true;
+}
+
+bool adc_register_callback(adc_handle_t *adc_h, adc_callback_t callback, void *callback_arg)
+{
+	if (adc_h == NULL) return false;
+
+	adc_h->eoc_callback = callback;
+	adc_h->eoc_callback_arg = callback_arg;
+	return true;
+}
+
+bool adc_start_dma_triggered(adc_handle_t *adc_h, dma_handle_t *dma_h, adc_ext_trigger_t trigger,
+							 volatile uint16_t *buffer, uint16_t length)
+{
+	sim_hal_adc_t *adc = sim_hal_find_adc(adc_h);
+
+	(void)trigger;
+	if ((adc == NULL) || (dma_h == NULL) || (buffer == NULL) || (length < 2u)) return false;
+	if (adc->trigger_period_us == 0u) return false;
+
+	adc->dma_h = dma_h;
+	adc->dma_buffer = buffer;
+	adc->dma_length = length;
+	adc->dma_index = 0u;
+	adc->next_trigger_us = sim_hal_now_us + adc->trigger_period_us;
+	return true;
+}
+
+bool dma_register_callbacks(dma_handle_t *dma_h,
+							dma_callback_t half_transfer_callbk,
+							dma_callback_t transfer_complete_callbk,
+							void *callbk_arg)
+{
+	if (dma_h == NULL) return false;
+
+	dma_h->half_transfer_callback = half_transfer_callbk;
+	dma_h->transfer_complete_callback = transfer_complete_callbk;
+	dma_h->callback_arg = callbk_arg;
+	return true;
+}
@@ -0,0 +1,73 @@
+#ifndef SIM_SIM_HAL_H
+#define SIM_SIM_HAL_H
+
+/**
+ * @file sim_hal.h
+ * @brief Host replacement of the driver layer below the motor modules (SIL build).
+ *
+ * Responsibilities:
+ * - Simulated microsecond timebase behind SYSTICK_GetTimeUs() / SYSTICK_GetTimeMs()
+ * - PWM compare values written by the 3-PWM stage, read back as phase duties
+ * - ADC regular conversions sampled from a plant callback: software starts
+ *   complete at the next sim_hal_service() (EOC callback), the TIM2-triggered
+ *   DMA path fills the circular buffer at the trigger period (HT / TC callbacks)
+ *
+ * @note Interrupt callbacks run from sim_hal_service(), between main-loop
+ *       passes, so they never preempt module code half-way.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "drivers/adc.h"
+#include "drivers/dma.h"
+#include "drivers/pwm_tim1.h"
+
+/**
+ * @brief Plant sample source of one ADC channel.
+ *
+ * @param source_arg User context (sensor model).
+ * @return Conversion result in ADC counts.
+ */
+typedef uint16_t (*sim_hal_adc_source_t)(void *source_arg);
+
+/**
+ * @brief Reset time, PWM and ADC state.
+ */
+void sim_hal_reset(void);
+
+/**
+ * @brief Set the simulated time (monotonic).
+ *
+ * @param now_us Time in microseconds.
+ */
+void sim_hal_set_time_us(uint64_t now_us);
+
+/**
+ * @brief Attach the plant sample source to one ADC handle.
+ *
+ * @param adc_h ADC handle the modules convert on.
+ * @param source Sample callback, evaluated at the conversion start (sampling instant).
+ * @param source_arg User context passed to the callback.
+ * @param trigger_period_us Hardware trigger period for the DMA path (0 = software starts only).
+ * @return true if attached, false if parameters invalid or no slot left.
+ */
+bool sim_hal_attach_adc(adc_handle_t *adc_h, sim_hal_adc_source_t source, void *source_arg,
+						uint32_t trigger_period_us);
+
+/**
+ * @brief Complete pending conversions and DMA transfers up to the current time.
+ *
+ * @return true if an EOC or DMA callback ran (new data may be published).
+ */
+bool sim_hal_service(void);
+
+/**
+ * @brief Read the phase duties written by the PWM stage.
+ *
+ * @param pwm_h PWM handle.
+ * @param duty Output duty fractions (0..1) of CH1..CH3.
+ * @return true if the outputs run (pwm_tim1_start()), false if stopped or unknown.
+ */
+bool sim_hal_get_pwm_duty(const pwm_tim1_handle_t *pwm_h, double duty[3]);
+
+#endif /* SIM_SIM_HAL_H */
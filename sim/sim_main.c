@@ -0,0 +1,1225 @@
+/**
+ * @file sim_main.c
+ * @brief Software-in-the-loop run of the speed-control chain against the plant model.
+ *
+ * Links the unchanged firmware modules (AS5600 analog acquisition, electrical
+ * angle, speed feedback, reference estimator, trajectory, speed PI, FOC
+ * voltage kernel, 3-PWM stage) against sim_hal.c and drives them like the
+ * superloop actuation in app_axis.c: alignment hold, offset calibration from
+ * the first sample after the hold, then the 1 ms speed step on the default
+ * profile.
+ *
+ * One run prints one result line:
+ *
+ *   SIL key=value ...
+ *
+ * with the tracking error of the reference against the true rotor speed,
+ * the feedback error of the measured speed, PI saturation and the run time.
+ * With --observer 1 the flux observer runs on the plant phase currents and
+ * one more line reports its divergence from the sensor angle:
+ *
+ *   MOBS key=value ...
+ *
+ * --sensor-fail-s S stops the AS5600 samples S seconds after the alignment;
+ * the angle and speed then come from the observer (FALLBACK mode).
+ * --move COUNTS runs position mode instead of the profile: hold, move by
+ * COUNTS, then back to the start once in position, reported as
+ *
+ *   POS key=value ...
+ *
+ * with the settle times of both moves, the following error the loop saw and
+ * the overshoot and end error of the true rotor position.
+ * Options override the app_motor_test_config.h values so sweeps need no
+ * rebuild (tools/sil_sweep.py):
+ *
+ *   sil_sim --kp 2700 --ki 6000 --tau-ms 30 --accel 300000 --trace run.csv
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config/app_motor_test_config.h"
+#include "drivers/as5600_analog.h"
+#include "motor/motor.h"
+#include "motor/motor_3pwm.h"
+#include "motor/motor_electrical_angle.h"
+#include "motor/motor_field_weakening.h"
+#include "motor/motor_lead_angle.h"
+#include "motor/motor_cogging_compensation.h"
+#include "motor/motor_flux_observer.h"
+#include "motor/motor_foc_voltage.h"
+#include "motor/motor_openloop.h"
+#include "motor/motor_position_control.h"
+#include "motor/motor_speed_feedback.h"
+#include "motor/motor_speed_pi.h"
+#include "motor/motor_speed_reference_estimator.h"
+#include "motor/motor_trajectory.h"
+#include "sim_hal.h"
+#include "sim_plant.h"
+
+#define SIM_PWM_FREQUENCY_HZ            20000u
+#define SIM_PWM_PERIOD_US               (1000000u / SIM_PWM_FREQUENCY_HZ)
+/* Center-aligned TIM1 at 180 MHz: ARR = f_tim / (2 * f_pwm). */
+#define SIM_PWM_ARR                     4500u
+#define SIM_PROFILE_SEGMENT_COUNT       5u
+#define SIM_DEG_TO_RAD                  (3.14159265358979323846 / 180.0)
+#define SIM_RAD_TO_COUNTS               (65536.0 / (2.0 * 3.14159265358979323846))
+
+/**
+ * @brief Run options (defaults from app_motor_test_config.h).
+ *
+ */
+typedef struct {
+	uint32_t kp_q15;
+	uint32_t ki_per_s_q15;
+	uint32_t output_limit_permyriad;
+	uint32_t filter_time_constant_ms;
+	motor_speed_feedback_mode_t feedback_mode;
+	uint32_t pll_bandwidth_hz;
+	int32_t peak_speed_mrpm;
+	uint32_t acceleration_mrpm_per_s;
+	uint32_t jerk_mrpm_per_s2;
+	uint32_t zero_hold_ms;
+	uint32_t peak_hold_ms;
+	motor_3pwm_modulation_t modulation;
+	as5600_analog_acquisition_t acquisition;
+	bool field_weakening;
+	uint32_t field_weakening_max_ud_permyriad;
+	uint8_t lead_angle_mode;            /* APP_MOTOR_TEST_LEAD_ANGLE_MODE_* */
+	uint32_t lead_angle_time_constant_us;
+	bool lead_angle_calibration;
+	bool cogging_compensation;
+	uint32_t cogging_learning_delay_us;
+	int32_t cogging_learning_gain_q15;
+	bool flux_observer;
+	uint32_t flux_observer_gain_per_s;
+	uint16_t flux_observer_pll_bandwidth_hz;
+	double sensor_fail_s;               /* < 0: the sensor never fails. */
+	int32_t position_move_counts;       /* 0: speed profile; else position mode, move out and back. */
+	int32_t position_kp_q15;
+	int32_t position_max_speed_mrpm;
+	double duration_s;
+	double settle_s;                    /* Excluded from the metrics after the alignment. */
+	uint32_t step_us;
+	const char *trace_path;
+	sim_plant_cfg_t plant;
+	sim_sensor_cfg_t sensor;
+} sim_options_t;
+
+/**
+ * @brief Accumulated run metrics.
+ *
+ */
+typedef struct {
+	uint64_t sample_count;
+	double tracking_error_sq_sum;
+	double tracking_error_max;
+	double feedback_error_sq_sum;
+	uint64_t saturated_count;
+	uint64_t over_fault_limit_count;
+	double abs_iq_max;
+	/* Flux observer, while valid and the sensor still runs. */
+	uint64_t observer_sample_count;
+	uint64_t observer_valid_count;
+	double observer_divergence_sq_sum;
+	double observer_divergence_max;
+} sim_metrics_t;
+
+/**
+ * @brief Position-mode run state and metrics (--move).
+ *
+ */
+typedef struct {
+	uint8_t move_index;                 /* Moves planned so far: 0 hold, 1 out, 2 back. */
+	bool is_moving;                     /* Planned move not yet reported in position. */
+	bool is_next_move_due;
+	uint64_t move_start_us;
+	double move_direction;              /* Sign of the planned move (overshoot side). */
+	double move_ms[2];                  /* Move start -> in position, < 0 if never reached. */
+	double start_true_counts;           /* True position at the anchoring step. */
+	int32_t start_position_counts;      /* Measured position at the anchoring step. */
+	int32_t max_following_error_counts;
+	double max_overshoot_counts;
+} sim_position_run_t;
+
+static motor_handle_t sim_motor_h;
+static motor_3pwm_cfg_t sim_motor_3pwm_cfg;
+static motor_3pwm_handle_t sim_motor_3pwm_h;
+static motor_openloop_cfg_t sim_motor_openloop_cfg;
+static motor_openloop_handle_t sim_motor_openloop_h;
+static motor_foc_voltage_cfg_t sim_motor_foc_voltage_cfg;
+static motor_foc_voltage_handle_t sim_motor_foc_voltage_h;
+static motor_electrical_angle_cfg_t sim_motor_electrical_angle_cfg;
+static motor_electrical_angle_handle_t sim_motor_electrical_angle_h;
+static motor_speed_feedback_cfg_t sim_motor_speed_feedback_cfg;
+static motor_speed_feedback_handle_t sim_motor_speed_feedback_h;
+static motor_speed_pi_cfg_t sim_motor_speed_pi_cfg;
+static motor_speed_pi_handle_t sim_motor_speed_pi_h;
+static motor_field_weakening_cfg_t sim_motor_field_weakening_cfg;
+static motor_field_weakening_handle_t sim_motor_field_weakening_h;
+static motor_lead_angle_cfg_t sim_motor_lead_angle_cfg;
+static motor_lead_angle_handle_t sim_motor_lead_angle_h;
+static motor_cogging_compensation_cfg_t sim_motor_cogging_compensation_cfg;
+static motor_cogging_compensation_handle_t sim_motor_cogging_compensation_h;
+static motor_flux_observer_cfg_t sim_motor_flux_observer_cfg;
+static motor_flux_observer_handle_t sim_motor_flux_observer_h;
+static motor_speed_reference_estimator_history_t sim_speed_reference_estimator_history;
+static motor_speed_reference_estimator_cfg_t sim_motor_speed_reference_estimator_cfg;
+static motor_speed_reference_estimator_handle_t sim_motor_speed_reference_estimator_h;
+static motor_trajectory_segment_t sim_profile_segments[SIM_PROFILE_SEGMENT_COUNT];
+static motor_trajectory_cfg_t sim_motor_trajectory_cfg;
+static motor_trajectory_handle_t sim_motor_trajectory_h;
+static motor_trajectory_segment_t sim_position_hold_segment;
+static motor_position_control_cfg_t sim_motor_position_control_cfg;
+static motor_position_control_handle_t sim_motor_position_control_h;
+static as5600_analog_cfg_t sim_as5600_analog_cfg;
+static as5600_analog_handle_t sim_as5600_analog_h;
+static pwm_tim1_handle_t sim_pwm_h;
+static adc_handle_t sim_adc_h;
+static dma_handle_t sim_adc_dma_h;
+static sim_plant_t sim_plant;
+static sim_sensor_t sim_sensor;
+
+/**
+ * @brief Abort the run on one setup or module error.
+ *
+ * @param tag Module tag.
+ * @param msg Error message.
+ */
+static void sim_fatal(const char *tag, const char *msg)
+{
+	fprintf(stderr, "%s: %s\n", tag, msg);
+	exit(2);
+}
+
+static void sim_usage(const char *program)
+{
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  controller: --kp Q15 --ki Q15 --limit PERMYRIAD\n"
+			"  feedback:   --feedback lpf|pll --tau-ms MS --pll-bw HZ\n"
+			"  profile:    --peak MRPM --accel MRPM_PER_S --jerk MRPM_PER_S2 --zero-hold MS --peak-hold MS\n"
+			"  stage:      --modulation sine|svpwm|dpwm --acquisition software|dma\n"
+			"  weakening:  --fw 0|1 --fw-max-ud PERMYRIAD\n"
+			"  lead:       --lead off|table|model --lead-tau-us US --lead-cal 0|1\n"
+			"  cogging:    --cog 0|1 --cog-delay-us US --cog-gain Q15\n"
+			"  observer:   --observer 0|1 --observer-gain PER_S --observer-bw HZ --sensor-fail-s S\n"
+			"  position:   --move COUNTS --position-kp Q15 --position-max-speed MRPM\n"
+			"  plant:      --load MNM --inertia KGM2 --flux WB --resistance OHM --inductance H\n"
+			"              --coulomb MNM --viscous NMS --phase-order 1|-1 --rotor-offset DEG\n"
+			"              --cogging MNM --cogging-periods N\n"
+			"  sensor:     --noise COUNTS_RMS --inl1 DEG --inl2 DEG --sensor-dir 1|-1 --seed N\n"
+			"  run:        --duration S --settle S --dt-us US --trace FILE.csv\n",
+			program);
+	exit(2);
+}
+
+/**
+ * @brief Fill the defaults: firmware configuration plus the nominal bench motor.
+ *
+ * @param options Pointer to run options.
+ */
+static void sim_default_options(sim_options_t *options)
+{
+	*options = (sim_options_t){
+			.kp_q15 = APP_MOTOR_TEST_SPEED_PI_KP_Q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_SPEED_PI_KI_PER_S_Q15,
+			.output_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_OUTPUT_LIMIT_PERMYRIAD,
+			.filter_time_constant_ms = APP_MOTOR_TEST_SPEED_FEEDBACK_FILTER_TIME_CONSTANT_MS,
+			.feedback_mode = (APP_MOTOR_TEST_SPEED_FEEDBACK_MODE == APP_MOTOR_TEST_SPEED_FEEDBACK_MODE_PLL) ?
+					MOTOR_SPEED_FEEDBACK_MODE_PLL : MOTOR_SPEED_FEEDBACK_MODE_LPF,
+			.pll_bandwidth_hz = APP_MOTOR_TEST_SPEED_FEEDBACK_PLL_BANDWIDTH_HZ,
+			.peak_speed_mrpm = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM,
+			.acceleration_mrpm_per_s = APP_MOTOR_TEST_SPEED_PROFILE_ACCELERATION_MRPM_PER_S,
+			.jerk_mrpm_per_s2 = APP_MOTOR_TEST_SPEED_PROFILE_JERK_MRPM_PER_S2,
+			.zero_hold_ms = APP_MOTOR_TEST_SPEED_PROFILE_ZERO_HOLD_MS,
+			.peak_hold_ms = APP_MOTOR_TEST_SPEED_PROFILE_PEAK_HOLD_MS,
+			.modulation = (motor_3pwm_modulation_t)APP_MOTOR_TEST_PWM_MODULATION,
+			.acquisition = (APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE == APP_MOTOR_TEST_ANGLE_ACQUISITION_MODE_TIMER_DMA) ?
+					AS5600_ANALOG_ACQUISITION_TIMER_DMA : AS5600_ANALOG_ACQUISITION_SOFTWARE,
+			.field_weakening = (APP_MOTOR_TEST_FIELD_WEAKENING_MODE == APP_MOTOR_TEST_FIELD_WEAKENING_MODE_ON),
+			.field_weakening_max_ud_permyriad = APP_MOTOR_TEST_FIELD_WEAKENING_MAX_UD_PERMYRIAD,
+			.lead_angle_mode = APP_MOTOR_TEST_LEAD_ANGLE_MODE,
+			.lead_angle_time_constant_us = (APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH * 1000u) /
+										   APP_MOTOR_TEST_MOTOR_PHASE_RESISTANCE_MOHM,
+			.lead_angle_calibration =
+					(APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE == APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_MODE_ON),
+			.cogging_compensation =
+					(APP_MOTOR_TEST_COGGING_COMPENSATION_MODE == APP_MOTOR_TEST_COGGING_COMPENSATION_MODE_ON),
+			.cogging_learning_delay_us = APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_DELAY_US,
+			.cogging_learning_gain_q15 = APP_MOTOR_TEST_COGGING_COMPENSATION_LEARNING_GAIN_Q15,
+			/* Voltage-mode SIL: the observer reads the plant currents since the sim has no current sense. */
+			.flux_observer = false,
+			.flux_observer_gain_per_s = APP_MOTOR_TEST_FLUX_OBSERVER_GAIN_PER_S,
+			.flux_observer_pll_bandwidth_hz = APP_MOTOR_TEST_FLUX_OBSERVER_PLL_BANDWIDTH_HZ,
+			.sensor_fail_s = -1.0,
+			.position_move_counts = 0,
+			.position_kp_q15 = APP_MOTOR_TEST_POSITION_KP_Q15,
+			.position_max_speed_mrpm = APP_MOTOR_TEST_POSITION_MAX_SPEED_MRPM,
+			/* One full profile cycle (about 10.6 s at the default ramps) after the alignment hold. */
+			.duration_s = 12.0,
+			.settle_s = 0.0,
+			/* One PWM period: the average-value inverter model needs no finer step (L / R = 1 ms). */
+			.step_us = SIM_PWM_PERIOD_US,
+			.trace_path = NULL,
+			/* Gimbal-class outrunner on the SimpleFOC Mini: R and L as configured for the current PI. */
+			.plant = {
+					.phase_resistance_ohm = 1.0,
+					.phase_inductance_h = APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH * 1e-6,
+					.flux_linkage_wb = 0.005,
+					.pole_pairs = APP_MOTOR_TEST_POLE_PAIRS,
+					/* Rotor plus a small test disk. */
+					.inertia_kgm2 = 1e-4,
+					.viscous_friction_nms = 1e-5,
+					.coulomb_friction_nm = 2e-3,
+					.load_torque_nm = 0.0,
+					.cogging_torque_nm = 0.0,
+					.cogging_periods_per_turn = 6u,
+					.bus_voltage_v = APP_MOTOR_TEST_BUS_VOLTAGE_MV * 1e-3,
+					/* Physical wiring the configured phase-sequence and sensor signs compensate. */
+					.phase_order = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+					.rotor_offset_rad = 0.7,
+					.initial_mechanical_angle_rad = 0.3,
+			},
+			.sensor = {
+					.direction = APP_MOTOR_TEST_SENSOR_DIRECTION,
+					.mount_offset_rad = 1.9,
+					.noise_rms_counts = 2.0,
+					.inl_first_harmonic_rad = 0.0,
+					.inl_second_harmonic_rad = 0.0,
+					.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
+					.noise_seed = 1u,
+			},
+	};
+}
+
+/**
+ * @brief Parse the command line into the run options.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @param options Pointer to run options (defaults filled).
+ */
+static void sim_parse_options(int argc, char **argv, sim_options_t *options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char *key = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if ((strcmp(key, "-h") == 0) || (strcmp(key, "--help") == 0) || (value == NULL)) sim_usage(argv[0]);
+		i++;
+
+		if (strcmp(key, "--kp") == 0) options->kp_q15 = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--ki") == 0) options->ki_per_s_q15 = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--limit") == 0) options->output_limit_permyriad = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--tau-ms") == 0) options->filter_time_constant_ms = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--pll-bw") == 0) options->pll_bandwidth_hz = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--feedback") == 0)
+		{
+			if (strcmp(value, "lpf") == 0) options->feedback_mode = MOTOR_SPEED_FEEDBACK_MODE_LPF;
+			else if (strcmp(value, "pll") == 0) options->feedback_mode = MOTOR_SPEED_FEEDBACK_MODE_PLL;
+			else sim_usage(argv[0]);
+		}
+		else if (strcmp(key, "--peak") == 0) options->peak_speed_mrpm = (int32_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--accel") == 0) options->acceleration_mrpm_per_s = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--jerk") == 0) options->jerk_mrpm_per_s2 = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--zero-hold") == 0) options->zero_hold_ms = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--peak-hold") == 0) options->peak_hold_ms = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--modulation") == 0)
+		{
+			if (strcmp(value, "sine") == 0) options->modulation = MOTOR_3PWM_MODULATION_SINE;
+			else if (strcmp(value, "svpwm") == 0) options->modulation = MOTOR_3PWM_MODULATION_SVPWM;
+			else if (strcmp(value, "dpwm") == 0) options->modulation = MOTOR_3PWM_MODULATION_DPWM;
+			else sim_usage(argv[0]);
+		}
+		else if (strcmp(key, "--acquisition") == 0)
+		{
+			if (strcmp(value, "software") == 0) options->acquisition = AS5600_ANALOG_ACQUISITION_SOFTWARE;
+			else if (strcmp(value, "dma") == 0) options->acquisition = AS5600_ANALOG_ACQUISITION_TIMER_DMA;
+			else sim_usage(argv[0]);
+		}
+		else if (strcmp(key, "--fw") == 0) options->field_weakening = (strtol(value, NULL, 0) != 0);
+		else if (strcmp(key, "--fw-max-ud") == 0)
+		{
+			options->field_weakening_max_ud_permyriad = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--lead") == 0)
+		{
+			if (strcmp(value, "off") == 0) options->lead_angle_mode = APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF;
+			else if (strcmp(value, "table") == 0) options->lead_angle_mode = APP_MOTOR_TEST_LEAD_ANGLE_MODE_TABLE;
+			else if (strcmp(value, "model") == 0) options->lead_angle_mode = APP_MOTOR_TEST_LEAD_ANGLE_MODE_MODEL;
+			else sim_usage(argv[0]);
+		}
+		else if (strcmp(key, "--lead-tau-us") == 0)
+		{
+			options->lead_angle_time_constant_us = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--lead-cal") == 0) options->lead_angle_calibration = (strtol(value, NULL, 0) != 0);
+		else if (strcmp(key, "--cog") == 0) options->cogging_compensation = (strtol(value, NULL, 0) != 0);
+		else if (strcmp(key, "--cog-delay-us") == 0)
+		{
+			options->cogging_learning_delay_us = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--cog-gain") == 0) options->cogging_learning_gain_q15 = (int32_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--observer") == 0) options->flux_observer = (strtol(value, NULL, 0) != 0);
+		else if (strcmp(key, "--observer-gain") == 0)
+		{
+			options->flux_observer_gain_per_s = (uint32_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--observer-bw") == 0)
+		{
+			options->flux_observer_pll_bandwidth_hz = (uint16_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--sensor-fail-s") == 0) options->sensor_fail_s = strtod(value, NULL);
+		else if (strcmp(key, "--move") == 0) options->position_move_counts = (int32_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--position-kp") == 0) options->position_kp_q15 = (int32_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--position-max-speed") == 0)
+		{
+			options->position_max_speed_mrpm = (int32_t)strtol(value, NULL, 0);
+		}
+		else if (strcmp(key, "--load") == 0) options->plant.load_torque_nm = strtod(value, NULL) * 1e-3;
+		else if (strcmp(key, "--inertia") == 0) options->plant.inertia_kgm2 = strtod(value, NULL);
+		else if (strcmp(key, "--flux") == 0) options->plant.flux_linkage_wb = strtod(value, NULL);
+		else if (strcmp(key, "--resistance") == 0) options->plant.phase_resistance_ohm = strtod(value, NULL);
+		else if (strcmp(key, "--inductance") == 0) options->plant.phase_inductance_h = strtod(value, NULL);
+		else if (strcmp(key, "--coulomb") == 0) options->plant.coulomb_friction_nm = strtod(value, NULL) * 1e-3;
+		else if (strcmp(key, "--viscous") == 0) options->plant.viscous_friction_nms = strtod(value, NULL);
+		else if (strcmp(key, "--cogging") == 0) options->plant.cogging_torque_nm = strtod(value, NULL) * 1e-3;
+		else if (strcmp(key, "--cogging-periods") == 0)
+		{
+			options->plant.cogging_periods_per_turn = (uint16_t)strtoul(value, NULL, 0);
+		}
+		else if (strcmp(key, "--phase-order") == 0) options->plant.phase_order = (int8_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--rotor-offset") == 0) options->plant.rotor_offset_rad = strtod(value, NULL) * SIM_DEG_TO_RAD;
+		else if (strcmp(key, "--noise") == 0) options->sensor.noise_rms_counts = strtod(value, NULL);
+		else if (strcmp(key, "--inl1") == 0) options->sensor.inl_first_harmonic_rad = strtod(value, NULL) * SIM_DEG_TO_RAD;
+		else if (strcmp(key, "--inl2") == 0) options->sensor.inl_second_harmonic_rad = strtod(value, NULL) * SIM_DEG_TO_RAD;
+		else if (strcmp(key, "--sensor-dir") == 0) options->sensor.direction = (int8_t)strtol(value, NULL, 0);
+		else if (strcmp(key, "--seed") == 0) options->sensor.noise_seed = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--duration") == 0) options->duration_s = strtod(value, NULL);
+		else if (strcmp(key, "--settle") == 0) options->settle_s = strtod(value, NULL);
+		else if (strcmp(key, "--dt-us") == 0) options->step_us = (uint32_t)strtoul(value, NULL, 0);
+		else if (strcmp(key, "--trace") == 0) options->trace_path = value;
+		else sim_usage(argv[0]);
+	}
+
+	/* Raw ADC slots and PWM update events must fall on step boundaries. */
+	if ((options->lead_angle_calibration) && (options->lead_angle_mode == APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF))
+	{
+		sim_fatal("SIM", "--lead-cal needs --lead table|model");
+	}
+	if ((options->position_move_counts != 0) && (options->lead_angle_calibration))
+	{
+		sim_fatal("SIM", "--move starts after the alignment; run --lead-cal separately");
+	}
+	if ((options->sensor_fail_s >= 0.0) && (options->flux_observer == false))
+	{
+		sim_fatal("SIM", "--sensor-fail-s needs --observer 1");
+	}
+	if ((options->flux_observer) && (options->step_us != SIM_PWM_PERIOD_US))
+	{
+		sim_fatal("SIM", "--observer runs once per PWM period; keep --dt-us at the PWM period");
+	}
+	if ((options->step_us == 0u) || ((APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US % options->step_us) != 0u) ||
+		(((SIM_PWM_PERIOD_US % options->step_us) != 0u) && ((options->step_us % SIM_PWM_PERIOD_US) != 0u)))
+	{
+		sim_fatal("SIM", "--dt-us must divide the ADC sample period and divide or be a multiple of the PWM period");
+	}
+}
+
+/**
+ * @brief Build the module configurations the way app_build_axis_cfg() does and initialize them.
+ *
+ * @param options Pointer to run options.
+ */
+static void sim_init_modules(const sim_options_t *options)
+{
+	const uint32_t speed_feedback_sample_period_us =
+			APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US * (uint32_t)APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT;
+
+	sim_motor_h = (motor_handle_t){
+			.targets = {
+					.target_mechanical_speed_mrpm = 0,
+					.target_amplitude_permyriad = APP_MOTOR_TEST_ALIGNMENT_AMPLITUDE_PERMYRIAD,
+			},
+			.limits = {
+					.pole_pairs = APP_MOTOR_TEST_POLE_PAIRS,
+					.max_target_mechanical_speed_mrpm = 0,
+					.max_amplitude_permyriad = APP_MOTOR_TEST_MAX_AMPLITUDE_PERMYRIAD,
+			},
+			.status = {
+					.mode = MOTOR_MODE_INACTIVE,
+					.is_initialized = true,
+			},
+	};
+	sim_pwm_h = (pwm_tim1_handle_t){ .arr = SIM_PWM_ARR };
+	sim_adc_h = (adc_handle_t){0};
+	sim_adc_dma_h = (dma_handle_t){ .is_initialized = true };
+
+	sim_profile_segments[0] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = options->zero_hold_ms };
+	sim_profile_segments[1] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = options->peak_speed_mrpm, .hold_ms = options->peak_hold_ms };
+	sim_profile_segments[2] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = options->zero_hold_ms };
+	sim_profile_segments[3] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = -options->peak_speed_mrpm, .hold_ms = options->peak_hold_ms };
+	sim_profile_segments[4] = (motor_trajectory_segment_t){
+			.target_mechanical_speed_mrpm = 0, .hold_ms = options->zero_hold_ms };
+
+	sim_motor_3pwm_cfg = (motor_3pwm_cfg_t){
+			.pwm_h = &sim_pwm_h,
+			.modulation = options->modulation,
+			.dead_time_comp = MOTOR_3PWM_DEAD_TIME_COMP_OFF,
+	};
+	sim_motor_openloop_cfg = (motor_openloop_cfg_t){
+			.motor_h = &sim_motor_h,
+			.motor_3pwm_h = &sim_motor_3pwm_h,
+			.update_period_ms = APP_MOTOR_TEST_UPDATE_PERIOD_MS,
+			.phase_increment_ramp_step_u32 = APP_MOTOR_TEST_STARTUP_OPENLOOP_PHASE_INCREMENT_RAMP_STEP_U32,
+	};
+	sim_motor_foc_voltage_cfg = (motor_foc_voltage_cfg_t){
+			.motor_h = &sim_motor_h,
+			.motor_3pwm_h = &sim_motor_3pwm_h,
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+	};
+	sim_motor_electrical_angle_cfg = (motor_electrical_angle_cfg_t){
+			.motor_h = &sim_motor_h,
+			.electrical_offset_u16 = 0u,
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.max_prediction_horizon_us = APP_MOTOR_TEST_ANGLE_PREDICTION_MAX_HORIZON_US,
+	};
+	sim_motor_speed_feedback_cfg = (motor_speed_feedback_cfg_t){
+			.motor_h = &sim_motor_h,
+			.sample_period_us = speed_feedback_sample_period_us,
+			.filter_time_constant_ms = options->filter_time_constant_ms,
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.mode = options->feedback_mode,
+			.pll_bandwidth_hz = options->pll_bandwidth_hz,
+	};
+	sim_motor_speed_pi_cfg = (motor_speed_pi_cfg_t){
+			.motor_h = &sim_motor_h,
+			.kp_q15 = options->kp_q15,
+			.ki_per_s_q15 = options->ki_per_s_q15,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.output_limit_permyriad = options->output_limit_permyriad,
+			.current_limit_ma = 0,
+			.ff_speed_q15 = APP_MOTOR_TEST_SPEED_PI_FF_SPEED_Q15,
+			.ff_acceleration_q15 = APP_MOTOR_TEST_SPEED_PI_FF_ACCELERATION_Q15,
+			.ff_friction_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_PERMYRIAD,
+			.ff_friction_deadband_mrpm = APP_MOTOR_TEST_SPEED_PI_FF_FRICTION_DEADBAND_MRPM,
+			.ff_limit_permyriad = APP_MOTOR_TEST_SPEED_PI_FF_LIMIT_PERMYRIAD,
+			.gain_table = NULL,
+			.gain_table_count = 0u,
+	};
+	sim_motor_field_weakening_cfg = (motor_field_weakening_cfg_t){
+			.motor_h = &sim_motor_h,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.voltage_limit_permyriad = options->output_limit_permyriad,
+			.voltage_target_permyriad = (uint16_t)((options->output_limit_permyriad *
+													APP_MOTOR_TEST_FIELD_WEAKENING_VOLTAGE_TARGET_PERCENT) / 100u),
+			.max_ud_permyriad = options->field_weakening_max_ud_permyriad,
+			.ki_per_s_q15 = APP_MOTOR_TEST_FIELD_WEAKENING_KI_PER_S_Q15,
+			.min_speed_mrpm = APP_MOTOR_TEST_FIELD_WEAKENING_MIN_SPEED_MRPM,
+	};
+	sim_motor_lead_angle_cfg = (motor_lead_angle_cfg_t){
+			.motor_h = &sim_motor_h,
+			.mode = (options->lead_angle_mode == APP_MOTOR_TEST_LEAD_ANGLE_MODE_TABLE) ?
+					MOTOR_LEAD_ANGLE_MODE_TABLE : MOTOR_LEAD_ANGLE_MODE_MODEL,
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.point_count = APP_MOTOR_TEST_LEAD_ANGLE_POINT_COUNT,
+			.point_spacing_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_POINT_SPACING_MRPM,
+			.table_advance_counts = APP_MOTOR_TEST_LEAD_ANGLE_TABLE,
+			.electrical_time_constant_us = options->lead_angle_time_constant_us,
+			.max_advance_counts = APP_MOTOR_TEST_LEAD_ANGLE_MAX_ADVANCE_COUNTS,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.calibration_speed_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_MRPM,
+			.calibration_step_counts = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS,
+			.calibration_step_count = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNT,
+			.calibration_settle_ms = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SETTLE_TIME_MS,
+			.calibration_average_ms = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_AVERAGE_TIME_MS,
+			.calibration_speed_tolerance_mrpm = APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_TOLERANCE_MRPM,
+	};
+	sim_motor_cogging_compensation_cfg = (motor_cogging_compensation_cfg_t){
+			.motor_h = &sim_motor_h,
+			.point_count = APP_MOTOR_TEST_COGGING_COMPENSATION_POINT_COUNT,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.learning_gain_q15 = options->cogging_learning_gain_q15,
+			.learning_delay_us = options->cogging_learning_delay_us,
+			.max_correction_permyriad = APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_CORRECTION_PERMYRIAD,
+			.max_delta_per_step_counts = APP_MOTOR_TEST_COGGING_COMPENSATION_MAX_DELTA_COUNTS,
+	};
+	/* Phase voltage per permyriad as APP_MOTOR_TEST_FLUX_OBSERVER_VOLTAGE_MV_PER_PERMYRIAD_Q16, for the chosen stage. */
+	sim_motor_flux_observer_cfg = (motor_flux_observer_cfg_t){
+			.motor_h = &sim_motor_h,
+			.update_period_us = SIM_PWM_PERIOD_US,
+			.phase_resistance_mohm = APP_MOTOR_TEST_MOTOR_PHASE_RESISTANCE_MOHM,
+			.phase_inductance_uh = APP_MOTOR_TEST_MOTOR_PHASE_INDUCTANCE_UH,
+			.flux_linkage_uwb = APP_MOTOR_TEST_MOTOR_FLUX_LINKAGE_UWB,
+			.voltage_mv_per_permyriad_q16 = (options->modulation == MOTOR_3PWM_MODULATION_SINE) ?
+					(int32_t)((APP_MOTOR_TEST_BUS_VOLTAGE_MV * 65536u) / 20000u) :
+					(int32_t)((APP_MOTOR_TEST_BUS_VOLTAGE_MV * 75674u) / 20000u),
+			.phase_sequence_sign = APP_MOTOR_TEST_PHASE_SEQUENCE_SIGN,
+			.speed_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.flux_gain_per_s = options->flux_observer_gain_per_s,
+			.pll_bandwidth_hz = options->flux_observer_pll_bandwidth_hz,
+			.min_speed_mrpm = APP_MOTOR_TEST_FLUX_OBSERVER_MIN_SPEED_MRPM,
+			.max_pll_error_counts = APP_MOTOR_TEST_FLUX_OBSERVER_MAX_PLL_ERROR_COUNTS,
+	};
+	sim_motor_speed_reference_estimator_cfg = (motor_speed_reference_estimator_cfg_t){
+			.motor_h = &sim_motor_h,
+			.history = &sim_speed_reference_estimator_history,
+			.history_sample_count = APP_MOTOR_TEST_SPEED_REFERENCE_ESTIMATOR_HISTORY_SAMPLE_COUNT,
+	};
+	sim_motor_trajectory_cfg = (motor_trajectory_cfg_t){
+			.motor_h = &sim_motor_h,
+			.segments = sim_profile_segments,
+			.segment_count = SIM_PROFILE_SEGMENT_COUNT,
+			.is_cyclic = true,
+			.update_period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u,
+			.max_acceleration_mrpm_per_s = options->acceleration_mrpm_per_s,
+			.max_jerk_mrpm_per_s2 = options->jerk_mrpm_per_s2,
+	};
+	sim_position_hold_segment = (motor_trajectory_segment_t){ .target_mechanical_speed_mrpm = 0 };
+	sim_motor_position_control_cfg = (motor_position_control_cfg_t){
+			.motor_h = &sim_motor_h,
+			.update_period_ms = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS,
+			.control_direction_sign = APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN,
+			.kp_q15 = options->position_kp_q15,
+			.ki_per_s_q15 = APP_MOTOR_TEST_POSITION_KI_PER_S_Q15,
+			.max_speed_mrpm = options->position_max_speed_mrpm,
+			.in_position_window_counts = APP_MOTOR_TEST_POSITION_IN_POSITION_WINDOW_COUNTS,
+			.in_position_settle_ms = APP_MOTOR_TEST_POSITION_IN_POSITION_SETTLE_MS,
+	};
+	sim_as5600_analog_cfg = (as5600_analog_cfg_t){
+			.adc_h = &sim_adc_h,
+			.adc_full_scale = (uint16_t)APP_MOTOR_TEST_AS5600_ADC_FULL_SCALE,
+			.raw_sample_period_us = APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US,
+			.raw_sample_phase_us = 0u,
+			.raw_samples_per_publish = APP_MOTOR_TEST_ANGLE_PUBLISH_RAW_SAMPLE_COUNT,
+			.wrap_correction_threshold_counts = (uint16_t)APP_MOTOR_TEST_ANGLE_HALF_TURN_COUNTS,
+			.max_plausible_delta_per_publish_counts =
+					(uint16_t)APP_MOTOR_TEST_ANGLE_MAX_PLAUSIBLE_DELTA_PER_PUBLISH_COUNTS,
+			.mechanical_angle_direction = (APP_MOTOR_TEST_SENSOR_DIRECTION < 0) ?
+					AS5600_ANALOG_DIRECTION_REVERSE :
+					AS5600_ANALOG_DIRECTION_FORWARD,
+			.acquisition_mode = options->acquisition,
+			.dma_h = (options->acquisition == AS5600_ANALOG_ACQUISITION_TIMER_DMA) ? &sim_adc_dma_h : NULL,
+			.adc_trigger = ADC_EXT_TRIGGER_TIM2_TRGO,
+	};
+
+	if ((!sim_plant_init(&sim_plant, &options->plant)) ||
+		(!sim_sensor_init(&sim_sensor, &options->sensor, &sim_plant)))
+	{
+		sim_fatal("PLANT", "invalid plant or sensor parameters");
+	}
+	sim_hal_reset();
+	if (!sim_hal_attach_adc(&sim_adc_h, sim_sensor_sample_adc, &sim_sensor,
+							(options->acquisition == AS5600_ANALOG_ACQUISITION_TIMER_DMA) ?
+							APP_MOTOR_TEST_ANGLE_ADC_SAMPLE_PERIOD_US : 0u))
+	{
+		sim_fatal("HAL", "adc attach failed");
+	}
+
+	if (!motor_3pwm_init(&sim_motor_3pwm_h, &sim_motor_3pwm_cfg)) sim_fatal("M3PWM", "init failed");
+	if (!motor_openloop_init(&sim_motor_openloop_h, &sim_motor_openloop_cfg)) sim_fatal("MOPEN", "init failed");
+	if (!motor_foc_voltage_init(&sim_motor_foc_voltage_h, &sim_motor_foc_voltage_cfg)) sim_fatal("MFOC", "init failed");
+	if (!motor_electrical_angle_init(&sim_motor_electrical_angle_h, &sim_motor_electrical_angle_cfg))
+	{
+		sim_fatal("MEANG", "init failed");
+	}
+	if (!motor_speed_feedback_init(&sim_motor_speed_feedback_h, &sim_motor_speed_feedback_cfg))
+	{
+		sim_fatal("MSPD", "init failed");
+	}
+	if (!motor_speed_pi_init(&sim_motor_speed_pi_h, &sim_motor_speed_pi_cfg)) sim_fatal("MSPI", "init failed");
+	if ((options->field_weakening) &&
+		(!motor_field_weakening_init(&sim_motor_field_weakening_h, &sim_motor_field_weakening_cfg)))
+	{
+		sim_fatal("MFW", "init failed");
+	}
+	if ((options->lead_angle_mode != APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF) &&
+		(!motor_lead_angle_init(&sim_motor_lead_angle_h, &sim_motor_lead_angle_cfg)))
+	{
+		sim_fatal("MLEAD", "init failed");
+	}
+	if ((options->cogging_compensation) &&
+		(!motor_cogging_compensation_init(&sim_motor_cogging_compensation_h, &sim_motor_cogging_compensation_cfg)))
+	{
+		sim_fatal("MCOG", "init failed");
+	}
+	if ((options->flux_observer) && (!motor_flux_observer_init(&sim_motor_flux_observer_h, &sim_motor_flux_observer_cfg)))
+	{
+		sim_fatal("MOBS", "init failed");
+	}
+	if (!motor_speed_reference_estimator_init(&sim_motor_speed_reference_estimator_h,
+											  &sim_motor_speed_reference_estimator_cfg))
+	{
+		sim_fatal("MEST", "init failed");
+	}
+	if (!motor_trajectory_init(&sim_motor_trajectory_h, &sim_motor_trajectory_cfg)) sim_fatal("MTRJ", "init failed");
+	if ((options->position_move_counts != 0) &&
+		(!motor_position_control_init(&sim_motor_position_control_h, &sim_motor_position_control_cfg)))
+	{
+		sim_fatal("MPOS", "init failed");
+	}
+	if (!as5600_analog_init(&sim_as5600_analog_h, &sim_as5600_analog_cfg)) sim_fatal("AS5600", "init failed");
+}
+
+/**
+ * @brief Feed one consumed sample through the chain app_handle_consumed_angle_sample() runs.
+ *
+ * @param published_sample Published AS5600 sample.
+ */
+static void sim_handle_consumed_angle_sample(const as5600_analog_published_sample_t *published_sample)
+{
+	uint16_t current_angle_u16 = published_sample->mechanical_angle_u16;
+
+	sim_motor_h.measurements.mechanical_angle_u16 = current_angle_u16;
+	sim_motor_h.status.has_valid_mechanical_angle = true;
+
+	if (!motor_electrical_angle_update(&sim_motor_electrical_angle_h, current_angle_u16))
+	{
+		sim_fatal("MEANG", "update failed");
+	}
+	if (!motor_speed_reference_estimator_update(&sim_motor_speed_reference_estimator_h,
+												current_angle_u16,
+												published_sample->capture_timestamp_us))
+	{
+		sim_fatal("MEST", "update failed");
+	}
+	if ((!motor_speed_feedback_set_sample_period(&sim_motor_speed_feedback_h, published_sample->sample_period_us)) ||
+		(!motor_speed_feedback_update(&sim_motor_speed_feedback_h, current_angle_u16)))
+	{
+		sim_fatal("MSPD", "update failed");
+	}
+}
+
+/**
+ * @brief Calibrate the electrical offset from the latest sample and start the profile (alignment end).
+ *
+ * @param latest_angle_u16 Latest consumed mechanical angle.
+ */
+static void sim_finish_alignment(const sim_options_t *options, uint16_t latest_angle_u16)
+{
+	uint16_t raw_electrical_angle_u16 = 0u;
+
+	if (!motor_electrical_angle_compute_raw(&sim_motor_electrical_angle_h, latest_angle_u16, &raw_electrical_angle_u16))
+	{
+		sim_fatal("MEANG", "raw angle failed");
+	}
+	if ((!motor_electrical_angle_set_offset(&sim_motor_electrical_angle_h,
+											(uint16_t)(APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16 -
+													   raw_electrical_angle_u16))) ||
+		(!motor_electrical_angle_update(&sim_motor_electrical_angle_h, latest_angle_u16)))
+	{
+		sim_fatal("MEANG", "offset set failed");
+	}
+	if (!motor_speed_pi_reset(&sim_motor_speed_pi_h)) sim_fatal("MSPI", "reset failed");
+	if ((options->field_weakening) && (!motor_field_weakening_reset(&sim_motor_field_weakening_h)))
+	{
+		sim_fatal("MFW", "reset failed");
+	}
+	if (!motor_trajectory_reset(&sim_motor_trajectory_h, 0)) sim_fatal("MTRJ", "reset failed");
+	/* Position mode holds on a one-segment stop table until the first move (app_build_reference_profile()). */
+	if (options->position_move_counts != 0)
+	{
+		const motor_trajectory_profile_t hold_profile = {
+				.segments = &sim_position_hold_segment,
+				.segment_count = 1u,
+				.is_cyclic = false,
+				.max_acceleration_mrpm_per_s = options->acceleration_mrpm_per_s,
+				.max_jerk_mrpm_per_s2 = options->jerk_mrpm_per_s2,
+		};
+
+		if ((!motor_trajectory_set_profile(&sim_motor_trajectory_h, &hold_profile)) ||
+			(!motor_position_control_reset(&sim_motor_position_control_h)))
+		{
+			sim_fatal("MPOS", "reset failed");
+		}
+	}
+	if ((options->flux_observer) &&
+		(!motor_flux_observer_reset(&sim_motor_flux_observer_h, sim_motor_h.measurements.electrical_angle_u16)))
+	{
+		sim_fatal("MOBS", "reset failed");
+	}
+	if ((options->lead_angle_calibration) && (!motor_lead_angle_calibration_start(&sim_motor_lead_angle_h)))
+	{
+		sim_fatal("MLEAD", "calibration start failed");
+	}
+}
+
+/**
+ * @brief Return whether the lead-angle calibration holds the speed reference.
+ *
+ * @return true while the sweep settles or averages, false otherwise.
+ */
+static bool sim_lead_angle_calibration_is_running(void)
+{
+	return (sim_motor_lead_angle_h.calibration_state == MOTOR_LEAD_ANGLE_CALIBRATION_STATE_SETTLING) ||
+		   (sim_motor_lead_angle_h.calibration_state == MOTOR_LEAD_ANGLE_CALIBRATION_STATE_AVERAGING);
+}
+
+/**
+ * @brief Run one calibration speed step at the held speed; report and start the profile when it ends.
+ */
+static void sim_run_lead_angle_calibration(void)
+{
+	if (!motor_speed_pi_update(&sim_motor_speed_pi_h,
+							   APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_SPEED_MRPM,
+							   0,
+							   sim_motor_h.measurements.measured_mechanical_speed_mrpm))
+	{
+		sim_fatal("MSPI", "update failed");
+	}
+	if (!motor_lead_angle_calibration_update(&sim_motor_lead_angle_h,
+											 sim_motor_h.speed_pi.speed_control_uq_command_permyriad,
+											 sim_motor_h.measurements.measured_mechanical_speed_mrpm))
+	{
+		sim_fatal("MLEAD", "calibration update failed");
+	}
+	if (sim_lead_angle_calibration_is_running()) return;
+
+	if (sim_motor_lead_angle_h.calibration_state != MOTOR_LEAD_ANGLE_CALIBRATION_STATE_DONE)
+	{
+		sim_fatal("MLEAD", "calibration failed");
+	}
+	printf("LEAD advance_counts=%u tau_us=%lu mean_uq_permyriad=%lu zero_advance_uq_permyriad=%lu\n",
+		   (unsigned)(sim_motor_lead_angle_h.calibration_best_step_index * APP_MOTOR_TEST_LEAD_ANGLE_CALIBRATION_STEP_COUNTS),
+		   (unsigned long)sim_motor_lead_angle_h.electrical_time_constant_us,
+		   (unsigned long)sim_motor_lead_angle_h.calibration_best_mean_uq_permyriad,
+		   (unsigned long)sim_motor_lead_angle_h.calibration_zero_mean_uq_permyriad);
+	if (!motor_trajectory_reset(&sim_motor_trajectory_h, sim_motor_h.measurements.measured_mechanical_speed_mrpm))
+	{
+		sim_fatal("MTRJ", "reset failed");
+	}
+}
+
+/**
+ * @brief Plan the next move of the --move run before the trajectory step (app_start_position_move()).
+ *
+ * First move: by --move from the anchored position; second: back to it once the first is in position.
+ *
+ * @param options Pointer to run options.
+ * @param run Pointer to position run state.
+ * @param now_us Current time.
+ */
+static void sim_start_position_move(const sim_options_t *options, sim_position_run_t *run, uint64_t now_us)
+{
+	motor_trajectory_profile_t profile = {0};
+	int32_t target_counts = run->start_position_counts;
+
+	if (sim_motor_position_control_h.is_referenced == false) return;
+	if ((run->move_index != 0u) && (run->is_next_move_due == false)) return;
+	if (run->move_index >= 2u) return;
+
+	if (run->move_index == 0u)
+	{
+		target_counts = (int32_t)((uint32_t)run->start_position_counts + (uint32_t)options->position_move_counts);
+	}
+	if ((!motor_position_control_move_to(&sim_motor_position_control_h,
+										 target_counts,
+										 sim_motor_h.trajectory.reference_mechanical_speed_mrpm,
+										 options->acceleration_mrpm_per_s,
+										 options->jerk_mrpm_per_s2,
+										 &profile)) ||
+		(!motor_trajectory_set_profile(&sim_motor_trajectory_h, &profile)))
+	{
+		sim_fatal("MPOS", "move rejected");
+	}
+	run->move_start_us = now_us;
+	run->move_direction = ((run->move_index == 0u) == (options->position_move_counts > 0)) ? 1.0 : -1.0;
+	run->move_ms[run->move_index] = -1.0;
+	run->move_index++;
+	run->is_moving = true;
+	run->is_next_move_due = false;
+}
+
+/**
+ * @brief Run one position-loop step after the trajectory step and update the --move metrics.
+ *
+ * @param run Pointer to position run state.
+ * @param now_us Current time.
+ * @param true_counts True rotor position, control-positive counts.
+ * @return Speed reference for the speed PI.
+ */
+static int32_t sim_update_position_controller(sim_position_run_t *run, uint64_t now_us, double true_counts)
+{
+	const motor_position_control_state_t *state = &sim_motor_h.position_control;
+	int32_t measured_position_counts = 0;
+	bool in_position_reached = false;
+	bool was_referenced = sim_motor_position_control_h.is_referenced;
+
+	if ((!motor_speed_reference_estimator_get_position(&sim_motor_speed_reference_estimator_h,
+													   &measured_position_counts)) ||
+		(!motor_position_control_update(&sim_motor_position_control_h,
+										sim_motor_h.trajectory.reference_mechanical_speed_mrpm,
+										sim_motor_trajectory_h.is_finished,
+										measured_position_counts,
+										&in_position_reached)))
+	{
+		sim_fatal("MPOS", "update failed");
+	}
+	if (was_referenced == false)
+	{
+		run->start_position_counts = state->measured_position_counts;
+		run->start_true_counts = true_counts;
+	}
+
+	if (run->is_moving)
+	{
+		int32_t following_error_counts = abs(state->position_error_counts);
+
+		if (following_error_counts > run->max_following_error_counts)
+		{
+			run->max_following_error_counts = following_error_counts;
+		}
+	}
+	if (run->move_index != 0u)
+	{
+		double target_offset_counts = (double)(int32_t)((uint32_t)state->target_position_counts -
+														(uint32_t)run->start_position_counts);
+		double overshoot_counts = run->move_direction * ((true_counts - run->start_true_counts) - target_offset_counts);
+
+		if (overshoot_counts > run->max_overshoot_counts)
+		{
+			run->max_overshoot_counts = overshoot_counts;
+		}
+	}
+	if ((in_position_reached) && (run->is_moving))
+	{
+		run->move_ms[run->move_index - 1u] = (double)(now_us - run->move_start_us) * 1e-3;
+		run->is_moving = false;
+		run->is_next_move_due = (run->move_index < 2u);
+	}
+
+	return state->speed_command_mrpm;
+}
+
+/**
+ * @brief Publish the plant phase currents in the firmware alpha/beta basis (motor_current_sense output).
+ *
+ * CH1 is phase A; with phase_order -1 CH2 / CH3 see C / B, which negates beta.
+ */
+static void sim_publish_phase_currents(void)
+{
+	const sim_plant_cfg_t *cfg = sim_plant.cfg;
+	double electrical_angle = (sim_plant.mechanical_angle_rad * cfg->pole_pairs) + cfg->rotor_offset_rad;
+	double cos_e = cos(electrical_angle);
+	double sin_e = sin(electrical_angle);
+	double alpha_a = (sim_plant.id_a * cos_e) - (sim_plant.iq_a * sin_e);
+	double beta_a = ((sim_plant.id_a * sin_e) + (sim_plant.iq_a * cos_e)) * cfg->phase_order;
+
+	sim_motor_h.current.alpha_ma = (int32_t)lround(alpha_a * 1e3);
+	sim_motor_h.current.beta_ma = (int32_t)lround(beta_a * 1e3);
+}
+
+/**
+ * @brief Latch the voltage of the actuation just applied (as app_apply_foc_actuation() does in current mode).
+ *
+ * @param options Pointer to run options.
+ * @param ud_permyriad D-axis command.
+ * @param uq_permyriad Q-axis command.
+ */
+static void sim_latch_observer_voltage(const sim_options_t *options, int32_t ud_permyriad, int32_t uq_permyriad)
+{
+	if (options->flux_observer == false) return;
+
+	uint16_t applied_angle_u16 = (uint16_t)((int32_t)sim_motor_h.measurements.electrical_angle_u16 +
+											sim_motor_h.lead_angle.advance_counts);
+	if (!motor_flux_observer_set_voltage(&sim_motor_flux_observer_h, ud_permyriad, uq_permyriad, applied_angle_u16))
+	{
+		sim_fatal("MOBS", "set voltage failed");
+	}
+}
+
+static double sim_wall_time_s(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + ((double)now.tv_nsec * 1e-9);
+}
+
+int main(int argc, char **argv)
+{
+	sim_options_t options;
+	sim_metrics_t metrics = {0};
+	FILE *trace = NULL;
+	double duty[3] = {0.5, 0.5, 0.5};
+	bool is_driven = false;
+	bool alignment_done = false;
+	bool has_sample = false;
+	uint16_t latest_angle_u16 = 0u;
+	bool observer_fallback_active = false;
+	sim_position_run_t position_run = { .move_ms = {-1.0, -1.0} };
+	/* True speed in the control-positive direction the reference and the measurement use. */
+	const double control_speed_sign = (double)(APP_MOTOR_TEST_CONTROL_DIRECTION_SIGN * APP_MOTOR_TEST_SENSOR_DIRECTION);
+
+	sim_default_options(&options);
+	sim_parse_options(argc, argv, &options);
+	sim_init_modules(&options);
+
+	if (options.trace_path != NULL)
+	{
+		trace = fopen(options.trace_path, "w");
+		if (trace == NULL) sim_fatal("SIM", "cannot open trace file");
+		fprintf(trace, "t_ms,reference_mrpm,true_mrpm,measured_mrpm,ud_permyriad,uq_permyriad,iq_ma,id_ma\n");
+	}
+
+	/* Alignment vector, then the outputs; the stage is enabled from the first step. */
+	if (!motor_openloop_apply(&sim_motor_openloop_h, APP_MOTOR_TEST_ALIGNMENT_ELECTRICAL_ANGLE_U16))
+	{
+		sim_fatal("MOPEN", "alignment apply failed");
+	}
+	if (!motor_3pwm_start(&sim_motor_3pwm_h)) sim_fatal("M3PWM", "start failed");
+
+	const double step_s = options.step_us * 1e-6;
+	const uint64_t alignment_end_us = (uint64_t)APP_MOTOR_TEST_ALIGNMENT_DURATION_MS * 1000u;
+	const uint64_t end_us = alignment_end_us + (uint64_t)(options.duration_s * 1e6);
+	const uint64_t metrics_start_us = alignment_end_us + (uint64_t)(options.settle_s * 1e6);
+	const uint64_t sensor_fail_us = (options.sensor_fail_s >= 0.0) ?
+			(alignment_end_us + (uint64_t)(options.sensor_fail_s * 1e6)) : UINT64_MAX;
+	const uint32_t control_period_us = APP_MOTOR_TEST_SPEED_PI_UPDATE_PERIOD_MS * 1000u;
+	uint64_t now_us = 0u;
+	uint64_t step_count = 0u;
+	double wall_start_s = sim_wall_time_s();
+
+	while (now_us < end_us)
+	{
+		/* Duties written during the last PWM period take effect at the update event (CCR preload). */
+		if ((now_us % SIM_PWM_PERIOD_US) == 0u)
+		{
+			is_driven = sim_hal_get_pwm_duty(&sim_pwm_h, duty);
+		}
+		sim_plant_step(&sim_plant, duty, is_driven, step_s);
+		now_us += options.step_us;
+		step_count++;
+		sim_hal_set_time_us(now_us);
+		bool has_adc_data = sim_hal_service();
+
+		/* Current-loop order: sample the currents, integrate the voltage of the period that just ended. */
+		if ((options.flux_observer) && (alignment_done) && ((now_us % SIM_PWM_PERIOD_US) == 0u))
+		{
+			sim_publish_phase_currents();
+			if (!motor_flux_observer_update(&sim_motor_flux_observer_h)) sim_fatal("MOBS", "update failed");
+
+			const motor_flux_observer_state_t *observer = &sim_motor_h.flux_observer;
+			if ((observer_fallback_active == false) && (now_us >= sensor_fail_us))
+			{
+				if (observer->is_valid == false)
+				{
+					printf("MOBS sensor lost below the valid range at t_s=%.3f\n",
+						   (double)(now_us - alignment_end_us) * 1e-6);
+					break;
+				}
+				observer_fallback_active = true;
+			}
+			if (observer_fallback_active)
+			{
+				if (observer->is_valid == false)
+				{
+					printf("MOBS estimate lost at t_s=%.3f\n", (double)(now_us - alignment_end_us) * 1e-6);
+					break;
+				}
+				sim_motor_h.measurements.electrical_angle_u16 = observer->electrical_angle_u16;
+			}
+			else if (now_us >= metrics_start_us)
+			{
+				double divergence = (double)observer->sensor_divergence_counts;
+
+				metrics.observer_sample_count++;
+				if (observer->is_valid)
+				{
+					metrics.observer_valid_count++;
+					metrics.observer_divergence_sq_sum += divergence * divergence;
+					if (fabs(divergence) > metrics.observer_divergence_max) metrics.observer_divergence_max = fabs(divergence);
+				}
+			}
+		}
+
+		(void)as5600_analog_service(&sim_as5600_analog_h, now_us);
+		/* Samples are published from the EOC / DMA callbacks only; a failed sensor publishes none. */
+		as5600_analog_published_sample_t published_sample;
+		if ((has_adc_data) && (as5600_analog_consume_published_sample(&sim_as5600_analog_h, &published_sample)) &&
+			(observer_fallback_active == false))
+		{
+			sim_handle_consumed_angle_sample(&published_sample);
+			latest_angle_u16 = published_sample.mechanical_angle_u16;
+			has_sample = true;
+		}
+
+		if ((now_us % control_period_us) != 0u) continue;
+
+		if (alignment_done == false)
+		{
+			if ((now_us < alignment_end_us) || (has_sample == false)) continue;
+			sim_finish_alignment(&options, latest_angle_u16);
+			alignment_done = true;
+		}
+
+		/* The sweep holds its speed first; the profile (and the metrics) start when it is done. */
+		if (sim_lead_angle_calibration_is_running())
+		{
+			sim_run_lead_angle_calibration();
+			if (!motor_foc_voltage_apply_dq(&sim_motor_foc_voltage_h, 0,
+											(int16_t)sim_motor_h.speed_pi.speed_control_uq_command_permyriad))
+			{
+				sim_fatal("MFOC", "apply failed");
+			}
+			sim_latch_observer_voltage(&options, 0, sim_motor_h.speed_pi.speed_control_uq_command_permyriad);
+			continue;
+		}
+
+		/* Fallback: the observer speed replaces the sensor speed (app_update_speed_feedback()). */
+		if (observer_fallback_active)
+		{
+			sim_motor_h.measurements.measured_mechanical_speed_mrpm = sim_motor_h.flux_observer.mechanical_speed_mrpm;
+			sim_motor_h.speed_feedback.filtered_mechanical_speed_mrpm = sim_motor_h.flux_observer.mechanical_speed_mrpm;
+		}
+
+		bool step_changed = false;
+		int32_t speed_reference_mrpm = 0;
+		if (options.position_move_counts != 0) sim_start_position_move(&options, &position_run, now_us);
+		if (!motor_trajectory_update(&sim_motor_trajectory_h, &step_changed)) sim_fatal("MTRJ", "update failed");
+		speed_reference_mrpm = sim_motor_h.trajectory.reference_mechanical_speed_mrpm;
+		/* In fallback the position is unknown: trajectory speed only (app_update_position_controller()). */
+		if ((options.position_move_counts != 0) && (observer_fallback_active == false))
+		{
+			double true_counts = control_speed_sign * options.sensor.direction * sim_plant.mechanical_angle_rad *
+								 SIM_RAD_TO_COUNTS;
+
+			speed_reference_mrpm = sim_update_position_controller(&position_run, now_us, true_counts);
+		}
+		if (!motor_speed_pi_update(&sim_motor_speed_pi_h,
+								   speed_reference_mrpm,
+								   sim_motor_h.trajectory.reference_mechanical_acceleration_mrpm_per_s,
+								   sim_motor_h.measurements.measured_mechanical_speed_mrpm))
+		{
+			sim_fatal("MSPI", "update failed");
+		}
+		int16_t uq_permyriad = (int16_t)sim_motor_h.speed_pi.speed_control_uq_command_permyriad;
+		if (options.field_weakening)
+		{
+			if ((!motor_field_weakening_update(&sim_motor_field_weakening_h, uq_permyriad,
+											   sim_motor_h.measurements.measured_mechanical_speed_mrpm)) ||
+				(!motor_speed_pi_set_output_limit(&sim_motor_speed_pi_h,
+												  (uint16_t)sim_motor_h.field_weakening.uq_limit_permyriad)))
+			{
+				sim_fatal("MFW", "update failed");
+			}
+		}
+		if ((options.lead_angle_mode != APP_MOTOR_TEST_LEAD_ANGLE_MODE_OFF) &&
+			(!motor_lead_angle_update(&sim_motor_lead_angle_h, sim_motor_h.measurements.measured_mechanical_speed_mrpm)))
+		{
+			sim_fatal("MLEAD", "update failed");
+		}
+		if (options.cogging_compensation)
+		{
+			/* Learn while a non-zero target is held (app_speed_error_fault_is_armed()), then add the feedforward. */
+			bool is_steady = (sim_motor_h.trajectory.is_holding) &&
+							 (sim_motor_h.trajectory.segment_target_mechanical_speed_mrpm != 0);
+			bool cogging_ok = is_steady ?
+					motor_cogging_compensation_learn(&sim_motor_cogging_compensation_h,
+													 sim_motor_h.measurements.mechanical_angle_u16,
+													 sim_motor_h.speed_pi.speed_control_uq_command_permyriad) :
+					motor_cogging_compensation_learn_stop(&sim_motor_cogging_compensation_h);
+			if ((!cogging_ok) ||
+				(!motor_cogging_compensation_apply(&sim_motor_cogging_compensation_h,
+												   sim_motor_h.measurements.mechanical_angle_u16)))
+			{
+				sim_fatal("MCOG", "update failed");
+			}
+			int32_t limit_permyriad = (int32_t)sim_motor_speed_pi_h.output_limit_permyriad;
+			int32_t applied_permyriad = (int32_t)uq_permyriad + sim_motor_h.cogging.uq_correction_permyriad;
+			if (applied_permyriad > limit_permyriad) applied_permyriad = limit_permyriad;
+			if (applied_permyriad < -limit_permyriad) applied_permyriad = -limit_permyriad;
+			uq_permyriad = (int16_t)applied_permyriad;
+		}
+		if (!motor_foc_voltage_apply_dq(&sim_motor_foc_voltage_h,
+										(int16_t)sim_motor_h.field_weakening.ud_command_permyriad,
+										uq_permyriad))
+		{
+			sim_fatal("MFOC", "apply failed");
+		}
+		sim_latch_observer_voltage(&options, sim_motor_h.field_weakening.ud_command_permyriad, uq_permyriad);
+
+		double true_mrpm = control_speed_sign * options.sensor.direction * sim_plant_get_speed_mrpm(&sim_plant);
+		double reference_mrpm = (double)sim_motor_h.trajectory.reference_mechanical_speed_mrpm;
+		double measured_mrpm = (double)sim_motor_h.measurements.measured_mechanical_speed_mrpm;
+
+		if (now_us >= metrics_start_us)
+		{
+			double tracking_error = reference_mrpm - true_mrpm;
+			double feedback_error = measured_mrpm - true_mrpm;
+
+			metrics.sample_count++;
+			metrics.tracking_error_sq_sum += tracking_error * tracking_error;
+			metrics.feedback_error_sq_sum += feedback_error * feedback_error;
+			if (fabs(tracking_error) > metrics.tracking_error_max) metrics.tracking_error_max = fabs(tracking_error);
+			if (abs(uq_permyriad) >= (int)sim_motor_speed_pi_h.output_limit_permyriad) metrics.saturated_count++;
+			if (fabs(reference_mrpm - measured_mrpm) > APP_MOTOR_TEST_FAULT_TRIGGER_ABS_SPEED_ERROR_MRPM)
+			{
+				metrics.over_fault_limit_count++;
+			}
+			if (fabs(sim_plant.iq_a) > metrics.abs_iq_max) metrics.abs_iq_max = fabs(sim_plant.iq_a);
+		}
+		if (trace != NULL)
+		{
+			fprintf(trace, "%.3f,%.0f,%.0f,%.0f,%ld,%d,%.0f,%.0f\n",
+					(double)(now_us - alignment_end_us) * 1e-3, reference_mrpm, true_mrpm, measured_mrpm,
+					(long)sim_motor_h.field_weakening.ud_command_permyriad, uq_permyriad,
+					sim_plant.iq_a * 1e3, sim_plant.id_a * 1e3);
+		}
+	}
+
+	double wall_s = sim_wall_time_s() - wall_start_s;
+	double sample_count = (metrics.sample_count != 0u) ? (double)metrics.sample_count : 1.0;
+
+	if (trace != NULL) fclose(trace);
+	printf("SIL rms_tracking_error_mrpm=%.0f max_tracking_error_mrpm=%.0f rms_feedback_error_mrpm=%.0f "
+		   "saturation_fraction=%.4f fault_limit_ms=%llu max_abs_iq_ma=%.0f "
+		   "sim_s=%.3f wall_s=%.3f speedup=%.0f steps=%llu\n",
+		   sqrt(metrics.tracking_error_sq_sum / sample_count),
+		   metrics.tracking_error_max,
+		   sqrt(metrics.feedback_error_sq_sum / sample_count),
+		   (double)metrics.saturated_count / sample_count,
+		   (unsigned long long)metrics.over_fault_limit_count,
+		   metrics.abs_iq_max * 1e3,
+		   (double)now_us * 1e-6,
+		   wall_s,
+		   (wall_s > 0.0) ? ((double)now_us * 1e-6) / wall_s : 0.0,
+		   (unsigned long long)step_count);
+	if (options.flux_observer)
+	{
+		double observer_valid_count = (metrics.observer_valid_count != 0u) ? (double)metrics.observer_valid_count : 1.0;
+
+		printf("MOBS rms_divergence_counts=%.0f max_divergence_counts=%.0f valid_fraction=%.4f fallback=%d\n",
+			   sqrt(metrics.observer_divergence_sq_sum / observer_valid_count),
+			   metrics.observer_divergence_max,
+			   (metrics.observer_sample_count != 0u) ?
+					   ((double)metrics.observer_valid_count / (double)metrics.observer_sample_count) : 0.0,
+			   observer_fallback_active ? 1 : 0);
+	}
+	if (options.position_move_counts != 0)
+	{
+		double true_offset_counts = (control_speed_sign * options.sensor.direction * sim_plant.mechanical_angle_rad *
+									 SIM_RAD_TO_COUNTS) - position_run.start_true_counts;
+		double target_offset_counts = (double)(int32_t)((uint32_t)sim_motor_h.position_control.target_position_counts -
+														(uint32_t)position_run.start_position_counts);
+
+		printf("POS move_counts=%ld out_ms=%.0f back_ms=%.0f max_following_error_counts=%ld "
+			   "max_overshoot_counts=%.0f final_error_counts=%.0f\n",
+			   (long)options.position_move_counts,
+			   position_run.move_ms[0],
+			   position_run.move_ms[1],
+			   (long)position_run.max_following_error_counts,
+			   position_run.max_overshoot_counts,
+			   target_offset_counts - true_offset_counts);
+	}
+	return 0;
+}
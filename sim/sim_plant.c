@@ -0,0 +1,154 @@
+/**
+ * @file sim_plant.c
+ * @brief BLDC / PMSM plant and AS5600 analog-output model for the SIL build.
+ */
+
+#include "sim_plant.h"
+#include <math.h>
+#include <stddef.h>
+
+#define SIM_PLANT_TWO_PI                    6.283185307179586
+#define SIM_PLANT_SQRT3                     1.7320508075688772
+/* Coulomb friction smoothing speed (rad/s): avoids chattering around standstill. */
+#define SIM_PLANT_COULOMB_SMOOTHING_RAD_S   0.5
+#define SIM_PLANT_RAD_S_TO_MRPM             (60000.0 / SIM_PLANT_TWO_PI)
+
+bool sim_plant_init(sim_plant_t *plant, const sim_plant_cfg_t *cfg)
+{
+	if ((plant == NULL) || (cfg == NULL)) return false;
+	if ((cfg->phase_resistance_ohm <= 0.0) || (cfg->phase_inductance_h <= 0.0)) return false;
+	if ((cfg->inertia_kgm2 <= 0.0) || (cfg->pole_pairs == 0u) || (cfg->bus_voltage_v <= 0.0)) return false;
+	if ((cfg->phase_order != 1) && (cfg->phase_order != -1)) return false;
+
+	*plant = (sim_plant_t){
+			.cfg = cfg,
+			.mechanical_angle_rad = cfg->initial_mechanical_angle_rad,
+	};
+	return true;
+}
+
+void sim_plant_step(sim_plant_t *plant, const double duty[3], bool is_driven, double step_s)
+{
+	const sim_plant_cfg_t *cfg = plant->cfg;
+	const double electrical_speed = plant->mechanical_speed_rad_s * cfg->pole_pairs;
+	const double electrical_angle = (plant->mechanical_angle_rad * cfg->pole_pairs) + cfg->rotor_offset_rad;
+	const double cos_e = cos(electrical_angle);
+	const double sin_e = sin(electrical_angle);
+
+	if (is_driven)
+	{
+		/* Phase legs to motor terminals; the star point floats, so only the differential part acts. */
+		double va = duty[0] * cfg->bus_voltage_v;
+		double vb = ((cfg->phase_order > 0) ? duty[1] : duty[2]) * cfg->bus_voltage_v;
+		double vc = ((cfg->phase_order > 0) ? duty[2] : duty[1]) * cfg->bus_voltage_v;
+		double v_alpha = ((2.0 * va) - vb - vc) / 3.0;
+		double v_beta = (vb - vc) / SIM_PLANT_SQRT3;
+		double vd = (v_alpha * cos_e) + (v_beta * sin_e);
+		double vq = (-v_alpha * sin_e) + (v_beta * cos_e);
+		double did = (vd - (cfg->phase_resistance_ohm * plant->id_a) +
+					  (electrical_speed * cfg->phase_inductance_h * plant->iq_a)) / cfg->phase_inductance_h;
+		double diq = (vq - (cfg->phase_resistance_ohm * plant->iq_a) -
+					  (electrical_speed * cfg->phase_inductance_h * plant->id_a) -
+					  (electrical_speed * cfg->flux_linkage_wb)) / cfg->phase_inductance_h;
+
+		plant->id_a += did * step_s;
+		plant->iq_a += diq * step_s;
+	}
+	else
+	{
+		/* Open phases: the winding current commutates through the body diodes within a few us. */
+		plant->id_a = 0.0;
+		plant->iq_a = 0.0;
+	}
+
+	plant->electromagnetic_torque_nm = 1.5 * cfg->pole_pairs * cfg->flux_linkage_wb * plant->iq_a;
+
+	/* Coulomb term smoothed as w / (|w| + w_c): sign-like, no chattering, no libm call. */
+	double friction_nm = (cfg->viscous_friction_nms * plant->mechanical_speed_rad_s) +
+						 (cfg->coulomb_friction_nm * plant->mechanical_speed_rad_s /
+						  (fabs(plant->mechanical_speed_rad_s) + SIM_PLANT_COULOMB_SMOOTHING_RAD_S));
+	double cogging_nm = cfg->cogging_torque_nm * sin(plant->mechanical_angle_rad * cfg->cogging_periods_per_turn);
+	double acceleration = (plant->electromagnetic_torque_nm - friction_nm - cogging_nm - cfg->load_torque_nm) /
+						  cfg->inertia_kgm2;
+
+	plant->mechanical_speed_rad_s += acceleration * step_s;
+	plant->mechanical_angle_rad += plant->mechanical_speed_rad_s * step_s;
+}
+
+double sim_plant_get_speed_mrpm(const sim_plant_t *plant)
+{
+	return plant->mechanical_speed_rad_s * SIM_PLANT_RAD_S_TO_MRPM;
+}
+
+bool sim_sensor_init(sim_sensor_t *sensor, const sim_sensor_cfg_t *cfg, const sim_plant_t *plant)
+{
+	if ((sensor == NULL) || (cfg == NULL) || (plant == NULL)) return false;
+	if ((cfg->direction != 1) && (cfg->direction != -1)) return false;
+	if ((cfg->adc_full_scale == 0u) || (cfg->noise_rms_counts < 0.0)) return false;
+
+	*sensor = (sim_sensor_t){
+			.cfg = cfg,
+			.plant = plant,
+			.noise_state = (cfg->noise_seed != 0u) ? cfg->noise_seed : 1u,
+	};
+	return true;
+}
+
+/**
+ * @brief Return the next uniform sample in (0, 1] (xorshift32, reproducible per seed).
+ *
+ * @param sensor Pointer to sensor state.
+ * @return Uniform sample.
+ */
+static double sim_sensor_uniform(sim_sensor_t *sensor)
+{
+	sensor->noise_state ^= sensor->noise_state << 13;
+	sensor->noise_state ^= sensor->noise_state >> 17;
+	sensor->noise_state ^= sensor->noise_state << 5;
+
+	return ((double)sensor->noise_state + 1.0) / 4294967296.0;
+}
+
+/**
+ * @brief Return the next standard normal sample (Box-Muller, pairs cached).
+ *
+ * @param sensor Pointer to sensor state.
+ * @return Normal sample with zero mean and unit variance.
+ */
+static double sim_sensor_gaussian(sim_sensor_t *sensor)
+{
+	if (sensor->has_spare_noise)
+	{
+		sensor->has_spare_noise = false;
+		return sensor->spare_noise;
+	}
+
+	double radius = sqrt(-2.0 * log(sim_sensor_uniform(sensor)));
+	double phase = SIM_PLANT_TWO_PI * sim_sensor_uniform(sensor);
+
+	sensor->spare_noise = radius * sin(phase);
+	sensor->has_spare_noise = true;
+	return radius * cos(phase);
+}
+
+uint16_t sim_sensor_sample_adc(void *sensor_arg)
+{
+	sim_sensor_t *sensor = (sim_sensor_t *)sensor_arg;
+	const sim_sensor_cfg_t *cfg = sensor->cfg;
+	const double shaft_angle = sensor->plant->mechanical_angle_rad;
+
+	/* Magnet angle seen by the chip, plus the position-dependent nonlinearity of the output. */
+	double angle = (cfg->direction * shaft_angle) + cfg->mount_offset_rad;
+	angle += (cfg->inl_first_harmonic_rad * sin(shaft_angle)) +
+			 (cfg->inl_second_harmonic_rad * sin(2.0 * shaft_angle));
+	angle = fmod(angle, SIM_PLANT_TWO_PI);
+	if (angle < 0.0) angle += SIM_PLANT_TWO_PI;
+
+	double code = ((angle / SIM_PLANT_TWO_PI) * cfg->adc_full_scale) +
+				  (cfg->noise_rms_counts * sim_sensor_gaussian(sensor));
+
+	/* Rail clipping and ADC quantization (noise across the wrap clips like the analog output does). */
+	if (code < 0.0) code = 0.0;
+	if (code > cfg->adc_full_scale) code = cfg->adc_full_scale;
+	return (uint16_t)lround(code);
+}
@@ -0,0 +1,132 @@
+#ifndef SIM_SIM_PLANT_H
+#define SIM_SIM_PLANT_H
+
+/**
+ * @file sim_plant.h
+ * @brief BLDC / PMSM plant and AS5600 analog-output model for the SIL build.
+ *
+ * Responsibilities:
+ * - dq-frame PMSM electrical model driven by the three PWM duties
+ *   (average-value inverter, floating neutral)
+ * - rigid-rotor mechanics with viscous, Coulomb, cogging and load torque
+ * - AS5600 analog output: mounting offset, direction, INL harmonics,
+ *   Gaussian noise and ADC quantization
+ *
+ * Model (theta_e = pole_pairs * theta_m + rotor_offset):
+ *   L did/dt = vd - R id + w_e L iq
+ *   L diq/dt = vq - R iq - w_e L id - w_e lambda
+ *   J dw/dt  = 1.5 p lambda iq - B w - Tc w / (|w| + w_c) - T_cog sin(N theta_m) - T_load
+ *
+ * @note Fixed-step explicit Euler; keep step_us well below L / R.
+ * @note Stopped PWM outputs (pwm_tim1_stop) open the phases: currents decay to zero.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Plant parameters (SI units).
+ *
+ */
+typedef struct {
+	double phase_resistance_ohm;
+	double phase_inductance_h;          /* Ld = Lq (surface magnets) */
+	double flux_linkage_wb;             /* Peak phase flux linkage lambda */
+	uint8_t pole_pairs;
+	double inertia_kgm2;
+	double viscous_friction_nms;        /* Torque per rad/s */
+	double coulomb_friction_nm;
+	double load_torque_nm;              /* Constant load opposing positive speed */
+	double cogging_torque_nm;           /* Amplitude of the angle-periodic detent torque */
+	uint16_t cogging_periods_per_turn;  /* Detent periods per mechanical turn N */
+	double bus_voltage_v;
+	int8_t phase_order;                 /* +1: CH1..CH3 = A, B, C; -1: CH2 / CH3 wired to C / B */
+	double rotor_offset_rad;            /* Electrical angle of the rotor d-axis at theta_m = 0 */
+	double initial_mechanical_angle_rad;
+} sim_plant_cfg_t;
+
+/**
+ * @brief AS5600 analog-output sensor model parameters.
+ *
+ */
+typedef struct {
+	int8_t direction;                   /* +1: output rises with theta_m, -1: falls */
+	double mount_offset_rad;
+	double noise_rms_counts;            /* Gaussian noise at the ADC input (ADC counts) */
+	double inl_first_harmonic_rad;      /* Eccentricity (1x per turn) */
+	double inl_second_harmonic_rad;     /* Magnet / axial misalignment (2x per turn) */
+	uint16_t adc_full_scale;            /* Code of a full turn (4095 for 12-bit rail-to-rail) */
+	uint32_t noise_seed;
+} sim_sensor_cfg_t;
+
+/**
+ * @brief Plant state.
+ *
+ */
+typedef struct {
+	const sim_plant_cfg_t *cfg;
+	double id_a;
+	double iq_a;
+	double mechanical_speed_rad_s;
+	double mechanical_angle_rad;        /* Unwrapped */
+	double electromagnetic_torque_nm;
+} sim_plant_t;
+
+/**
+ * @brief Sensor model state.
+ *
+ */
+typedef struct {
+	const sim_sensor_cfg_t *cfg;
+	const sim_plant_t *plant;
+	uint32_t noise_state;
+	bool has_spare_noise;
+	double spare_noise;
+} sim_sensor_t;
+
+/**
+ * @brief Initialize the plant at rest.
+ *
+ * @param plant Pointer to plant state.
+ * @param cfg Pointer to plant parameters.
+ * @return true if initialized, false if parameters invalid.
+ */
+bool sim_plant_init(sim_plant_t *plant, const sim_plant_cfg_t *cfg);
+
+/**
+ * @brief Advance the plant by one fixed step.
+ *
+ * @param plant Pointer to plant state.
+ * @param duty Phase duty fractions (0..1) of PWM CH1..CH3.
+ * @param is_driven false while the PWM outputs are stopped (phases open).
+ * @param step_s Step length in seconds.
+ */
+void sim_plant_step(sim_plant_t *plant, const double duty[3], bool is_driven, double step_s);
+
+/**
+ * @brief Return the mechanical speed in milli-rpm (positive = increasing theta_m).
+ *
+ * @param plant Pointer to plant state.
+ * @return Mechanical speed in mrpm.
+ */
+double sim_plant_get_speed_mrpm(const sim_plant_t *plant);
+
+/**
+ * @brief Initialize the sensor model on one plant.
+ *
+ * @param sensor Pointer to sensor state.
+ * @param cfg Pointer to sensor parameters.
+ * @param plant Pointer to the plant the magnet sits on.
+ * @return true if initialized, false if parameters invalid.
+ */
+bool sim_sensor_init(sim_sensor_t *sensor, const sim_sensor_cfg_t *cfg, const sim_plant_t *plant);
+
+/**
+ * @brief Sample the sensor output as one ADC conversion (sim_hal_adc_source_t).
+ *
+ * @param sensor_arg Pointer to sensor state.
+ * @return ADC code 0..adc_full_scale.
+ */
+uint16_t sim_sensor_sample_adc(void *sensor_arg);
+
+#endif /* SIM_SIM_PLANT_H */
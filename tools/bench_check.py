@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Collect and compare kernel cycle counts from the Bench firmware.
+
+The Bench build configuration (Src/bench/bench_main.c) prints one report
+per pass on USART2:
+
+    BB,sysclk_hz,iterations,overhead_cycles
+    B,kernel,calls,min,avg,max,failed
+    BE,kernel_count
+
+Without --baseline the last complete report is printed as a table. With
+--baseline the avg and max cycles of every kernel are compared against a
+saved report; the exit status is 1 if a kernel got slower than the
+tolerance, failed calls or disappeared from the report.
+
+Usage:
+    bench_check.py --port /dev/ttyACM0 --save bench_baseline.txt
+    bench_check.py --port /dev/ttyACM0 --baseline bench_baseline.txt --tolerance 5
+    bench_check.py capture.txt --baseline bench_baseline.txt
+"""
+
+import argparse
+import sys
+
+FIELDS = ("calls", "min", "avg", "max", "failed")
+
+
+def parse_report(lines):
+    """Return (header, {kernel: {field: value}}) of the last complete report, or None."""
+    report = None
+    last_complete = None
+    for line in lines:
+        fields = line.strip().split(",")
+        if fields[0] == "BB" and len(fields) == 4:
+            report = ({"sysclk_hz": int(fields[1]), "iterations": int(fields[2]),
+                       "overhead": int(fields[3])}, {})
+        elif fields[0] == "B" and len(fields) == 7 and report is not None:
+            report[1][fields[1]] = dict(zip(FIELDS, (int(value) for value in fields[2:])))
+        elif fields[0] == "BE" and len(fields) == 2 and report is not None:
+            if int(fields[1]) == len(report[1]):
+                last_complete = report
+            report = None
+    return last_complete
+
+
+def read_port(port_name, baud, timeout_s):
+    try:
+        import serial
+    except ImportError:
+        sys.exit("--port requires pyserial")
+    lines = []
+    with serial.Serial(port_name, baud, timeout=timeout_s) as port:
+        while True:
+            raw = port.readline()
+            if not raw:
+                break
+            line = raw.decode("ascii", errors="replace").strip()
+            lines.append(line)
+            if line.startswith("BE,") and parse_report(lines) is not None:
+                break
+    return lines
+
+
+def print_report(report):
+    header, kernels = report
+    print("sysclk %d Hz, %d calls per kernel, overhead %d cycles"
+          % (header["sysclk_hz"], header["iterations"], header["overhead"]))
+    print("  %-28s %8s %8s %8s %8s %7s" % ("kernel", "calls", "min", "avg", "max", "failed"))
+    for name, stats in kernels.items():
+        print("  %-28s %8d %8d %8d %8d %7d"
+              % (name, stats["calls"], stats["min"], stats["avg"], stats["max"], stats["failed"]))
+
+
+def compare(report, baseline, tolerance_percent):
+    """Print one line per kernel and return the number of regressions."""
+    regressions = 0
+    kernels = report[1]
+    if report[0]["sysclk_hz"] != baseline[0]["sysclk_hz"]:
+        print("warning: sysclk %d Hz, baseline %d Hz" % (report[0]["sysclk_hz"], baseline[0]["sysclk_hz"]))
+    print("  %-28s %8s %8s %7s %8s %8s %7s" % ("kernel", "avg", "base", "delta", "max", "base", "delta"))
+    for name, reference in baseline[1].items():
+        stats = kernels.get(name)
+        if stats is None:
+            print("  %-28s missing" % name)
+            regressions += 1
+            continue
+        verdict = []
+        deltas = []
+        for field in ("avg", "max"):
+            limit = reference[field] * (1.0 + tolerance_percent / 100.0)
+            delta = 100.0 * (stats[field] - reference[field]) / max(reference[field], 1)
+            deltas.append((stats[field], reference[field], delta))
+            if stats[field] > limit:
+                verdict.append("%s slower" % field)
+        if stats["failed"] != 0:
+            verdict.append("%d failed calls" % stats["failed"])
+        if verdict:
+            regressions += 1
+        print("  %-28s %8d %8d %+6.1f%% %8d %8d %+6.1f%%  %s"
+              % ((name,) + deltas[0] + deltas[1] + ("REGRESSION: " + ", ".join(verdict) if verdict else "ok",)))
+    for name in kernels:
+        if name not in baseline[1]:
+            print("  %-28s new (not in baseline)" % name)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="captured Bench output (default: read --port)")
+    parser.add_argument("--port", help="serial port to read from (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=230400)
+    parser.add_argument("--timeout", type=float, default=15.0, help="seconds without a line before giving up")
+    parser.add_argument("--save", help="write the raw report lines to this file (new baseline)")
+    parser.add_argument("--baseline", help="saved report to compare against")
+    parser.add_argument("--tolerance", type=float, default=10.0, help="allowed avg / max increase in percent")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, errors="replace") as capture:
+            lines = capture.read().splitlines()
+    elif args.port:
+        lines = read_port(args.port, args.baud, args.timeout)
+    else:
+        sys.exit("give a capture file or --port")
+
+    report = parse_report(lines)
+    if report is None:
+        sys.exit("no complete BB..BE report found")
+
+    if args.save:
+        with open(args.save, "w") as output:
+            header, kernels = report
+            output.write("BB,%d,%d,%d\n" % (header["sysclk_hz"], header["iterations"], header["overhead"]))
+            for name, stats in kernels.items():
+                output.write("B,%s,%s\n" % (name, ",".join(str(stats[field]) for field in FIELDS)))
+            output.write("BE,%d\n" % len(kernels))
+
+    if not args.baseline:
+        print_report(report)
+        return
+
+    with open(args.baseline) as baseline_file:
+        baseline = parse_report(baseline_file.read().splitlines())
+    if baseline is None:
+        sys.exit("baseline %s holds no complete report" % args.baseline)
+    regressions = compare(report, baseline, args.tolerance)
+    if regressions:
+        print("%d kernel(s) regressed (tolerance %.1f%%)" % (regressions, args.tolerance))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
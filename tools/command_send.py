@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Encode host command frames for the USART2 command channel.
+
+Frame layout (little-endian):
+
+    sync 0x5A | type u8 | seq u8 | payload_length u8 | payload | crc16 u16
+
+The CRC is CRC-16/CCITT-FALSE over type..payload (sync excluded), as for the
+telemetry frames. Every command is acknowledged by an A-row (text) or a
+type 0x05 frame (binary, see tools/telemetry_decode.py):
+
+    A,command_type,command_seq,status,stream_free
+
+Commands:
+
+    speed  SETPOINT_MRPM            type 0x01: ramp to one speed and hold (commits at once)
+    stream FILE|-                   type 0x02: reference points, "speed_mrpm acceleration_mrpm_per_s" per line
+    set    PARAM VALUE [PARAM VALUE...]  type 0x03: stage parameters in the shadow block
+    apply                           type 0x04: commit the staged block at the next speed step
+    discard                         type 0x05: drop the staged changes
+    move    TARGET_COUNTS           type 0x06: position move to a multi-turn target (65536 counts/turn)
+    move-by DELTA_COUNTS            type 0x07: position move relative to the current target
+
+Status: 0 ok, 1 unknown command, 2 bad length, 3 unknown parameter,
+4 value out of range, 5 stream full (resend after stream_free grows).
+
+Usage:
+    command_send.py --port /dev/ttyACM0 set kp 9000 ki 60000 apply
+    command_send.py --port /dev/ttyACM0 speed 300000
+    command_send.py --port /dev/ttyACM0 move-by 65536
+    command_send.py --output cmd.bin stream points.txt   (raw frames, no pyserial needed)
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_SYNC = 0x5A
+FRAME_MAX_PAYLOAD = 64
+
+COMMAND_SET_SPEED = 0x01
+COMMAND_STREAM_REFERENCE = 0x02
+COMMAND_SET_PARAM = 0x03
+COMMAND_APPLY = 0x04
+COMMAND_DISCARD = 0x05
+COMMAND_MOVE_TO = 0x06
+COMMAND_MOVE_RELATIVE = 0x07
+
+REFERENCE_POINT_SIZE = 8
+REFERENCE_POINTS_PER_FRAME = FRAME_MAX_PAYLOAD // REFERENCE_POINT_SIZE
+
+# app_param_id_t in Src/app/app_command.c
+PARAM_ID = {
+    "kp": 0,            # speed PI kp, Q15
+    "ki": 1,            # speed PI ki, Q15 per second
+    "tau": 2,           # speed feedback LPF time constant, ms
+    "peak": 3,          # profile peak speed, mrpm
+    "peak_hold": 4,     # profile hold at +/- peak, ms
+    "zero_hold": 5,     # profile hold at zero, ms
+    "accel": 6,         # profile acceleration limit, mrpm/s
+    "jerk": 7,          # profile jerk limit, mrpm/s^2 (0 = trapezoid)
+    "mask": 8,          # telemetry channel mask, bit = channel id (0x1F = control set)
+    "mode": 9,          # reference: 0 profile, 1 setpoint, 2 stream, 3 position
+    "decimation": 10,   # (channel id << 16) | control cycles per sample, e.g. 0x00000002
+    "pos_kp": 11,       # position loop kp, Q15 mrpm per count
+    "pos_speed": 12,    # position move cruise speed and speed-command limit, mrpm
+}
+
+
+def crc16_ccitt_false(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_frame(command_type, sequence, payload=b""):
+    if len(payload) > FRAME_MAX_PAYLOAD:
+        raise ValueError("payload too long: %d bytes" % len(payload))
+    body = struct.pack("<BBB", command_type, sequence & 0xFF, len(payload)) + payload
+    return bytes((FRAME_SYNC,)) + body + struct.pack("<H", crc16_ccitt_false(body))
+
+
+def parse_int(text):
+    return int(text, 0)
+
+
+def read_points(path):
+    source = sys.stdin if path == "-" else open(path)
+    points = []
+    with source:
+        for line in source:
+            fields = line.split("#", 1)[0].split()
+            if fields:
+                points.append((parse_int(fields[0]), parse_int(fields[1]) if len(fields) > 1 else 0))
+    return points
+
+
+def build_frames(args):
+    """Yield (command_type, payload) for the command line."""
+    if args.command == "speed":
+        yield COMMAND_SET_SPEED, struct.pack("<i", parse_int(args.values[0]))
+    elif args.command == "move":
+        yield COMMAND_MOVE_TO, struct.pack("<i", parse_int(args.values[0]))
+    elif args.command == "move-by":
+        yield COMMAND_MOVE_RELATIVE, struct.pack("<i", parse_int(args.values[0]))
+    elif args.command == "stream":
+        points = read_points(args.values[0])
+        for start in range(0, len(points), REFERENCE_POINTS_PER_FRAME):
+            chunk = points[start:start + REFERENCE_POINTS_PER_FRAME]
+            yield COMMAND_STREAM_REFERENCE, b"".join(struct.pack("<ii", s, a) for s, a in chunk)
+    elif args.command == "set":
+        values = list(args.values)
+        apply_after = bool(values) and values[-1] == "apply"
+        if apply_after:
+            values.pop()
+        if (len(values) % 2) != 0:
+            sys.exit("set expects PARAM VALUE pairs")
+        for name, value in zip(values[0::2], values[1::2]):
+            param_id = PARAM_ID.get(name)
+            if param_id is None:
+                param_id = parse_int(name)
+            yield COMMAND_SET_PARAM, struct.pack("<Bi", param_id, parse_int(value))
+        if apply_after:
+            yield COMMAND_APPLY, b""
+    elif args.command == "apply":
+        yield COMMAND_APPLY, b""
+    elif args.command == "discard":
+        yield COMMAND_DISCARD, b""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("command", choices=("speed", "stream", "set", "apply", "discard", "move", "move-by"))
+    parser.add_argument("values", nargs="*")
+    parser.add_argument("--port", help="serial port to send to (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=230400)
+    parser.add_argument("--output", help="write raw frames to a file instead ('-' = stdout)")
+    parser.add_argument("--seq", type=int, default=0, help="first sequence number")
+    args = parser.parse_args()
+
+    if args.command in ("speed", "stream", "move", "move-by") and len(args.values) != 1:
+        sys.exit("%s expects one argument" % args.command)
+
+    data = b"".join(encode_frame(command_type, args.seq + i, payload)
+                    for i, (command_type, payload) in enumerate(build_frames(args)))
+
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--port requires pyserial")
+        with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+            port.write(data)
+    elif args.output and args.output != "-":
+        with open(args.output, "wb") as output:
+            output.write(data)
+    else:
+        sys.stdout.buffer.write(data)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Expand deferred T-lines into L-lines using the firmware message table.
+
+The firmware built with LOG_DEFERRED_EXPAND_ON_TARGET=0 sends deferred log
+records as
+
+    T,time_us,msg_id,arg0,...
+
+and this tool rewrites them to the log_printf format
+
+    L,time_ms,level,tag,message
+
+with the levels, tags and formats parsed from Inc/config/log_messages.h
+(row index = msg_id). All other lines are passed through unchanged.
+
+Usage:
+    log_decode.py capture.txt > run.log
+    log_decode.py --port /dev/ttyACM0 > run.log   (requires pyserial)
+"""
+
+import argparse
+import os
+import re
+import sys
+
+DEFAULT_TABLE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             "..", "Inc", "config", "log_messages.h")
+ROW_PATTERN = re.compile(r'X\(\s*(\w+)\s*,\s*LOG_LEVEL_(\w+)\s*,\s*"([^"]*)"\s*,\s*"([^"]*)"\s*\)')
+LEVEL_CHAR = {"INFO": "I", "WARN": "W", "ERROR": "E"}
+
+
+def load_table(path):
+    with open(path, "r") as table_file:
+        rows = ROW_PATTERN.findall(table_file.read())
+    if not rows:
+        sys.exit("no LOG_MESSAGE_TABLE rows in %s" % path)
+    return [(LEVEL_CHAR.get(level, "?"), tag, fmt) for _name, level, tag, fmt in rows]
+
+
+def expand_format(fmt, args):
+    values = iter(args)
+
+    def convert(match):
+        value = next(values, 0)
+        if match.group(1) == "ld":
+            return "%d" % value
+        if match.group(1) == "lu":
+            return "%d" % (value & 0xFFFFFFFF)
+        return "%x" % (value & 0xFFFFFFFF)
+
+    return re.sub(r"%(ld|lu|lx)", convert, fmt)
+
+
+def decode_line(line, table):
+    fields = line.split(",")
+    if (fields[0] != "T") or (len(fields) < 3):
+        return line
+    try:
+        time_us = int(fields[1])
+        msg_id = int(fields[2])
+        args = [int(field) for field in fields[3:]]
+    except ValueError:
+        return line
+    if msg_id >= len(table):
+        return "L,%d,?,LOG,unknown msg_id=%d" % (time_us // 1000, msg_id)
+    level, tag, fmt = table[msg_id]
+    return "L,%d,%s,%s,%s" % (time_us // 1000, level, tag, expand_format(fmt, args))
+
+
+def open_source(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--port requires pyserial")
+        return serial.Serial(args.port, args.baud, timeout=0.5)
+    if args.input == "-":
+        return sys.stdin.buffer
+    return open(args.input, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="capture file (default: stdin)")
+    parser.add_argument("--port", help="read from serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=230400)
+    parser.add_argument("--table", default=DEFAULT_TABLE, help="path to log_messages.h")
+    args = parser.parse_args()
+
+    table = load_table(args.table)
+    source = open_source(args)
+    try:
+        pending = b""
+        while True:
+            chunk = source.read(4096)
+            if not chunk:
+                if args.port:
+                    continue
+                break
+            pending += chunk
+            *lines, pending = pending.split(b"\n")
+            for raw in lines:
+                line = raw.decode("ascii", errors="replace").rstrip("\r")
+                print(decode_line(line, table))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        source.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""Report RAM and stack use from a GNU ld map file and GCC stack-usage output.
+
+Build with (STM32CubeIDE: C/C++ Build > Settings):
+
+    compiler: -fstack-usage -fcallgraph-info=su   (writes .su / .ci per object)
+    linker:   -Wl,-Map=BLDC.map                   (CubeIDE default)
+
+RAM part (from the map file):
+
+    section  address  size       every output section linked into SRAM
+    top input sections by size   (.bss.<symbol>, .data.<symbol>, ... with -fdata-sections)
+
+Stack part (from the .su / .ci files next to the objects):
+
+    largest frames               function, frame bytes, qualifier (static / dynamic / bounded)
+    worst-case call chains       per root function (no direct caller: main,
+                                 IRQ handlers, scheduler tasks and callbacks
+                                 reached through function pointers)
+
+Indirect calls are not followed, so a task or callback shows up as its own
+root. Worst-case stack = main chain + deepest task / callback chain + one
+chain per preemption level that can nest on top (see irq_priority_config.h).
+
+Usage:
+    memory_report.py Debug/BLDC.map --objects Debug [--top 20]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RAM_START = 0x20000000
+RAM_END = 0x20020000
+
+OUTPUT_SECTION = re.compile(r"^(\.[\w.]+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+OUTPUT_SECTION_NAME_ONLY = re.compile(r"^(\.[\w.]+)\s*$")
+INPUT_SECTION = re.compile(r"^ (\.[\w.]+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)")
+INPUT_SECTION_NAME_ONLY = re.compile(r"^ (\.[\w.]+|COMMON)\s*$")
+ADDRESS_SIZE_OBJECT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)")
+ADDRESS_SIZE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(\s|$)")
+SYMBOL_ASSIGNMENT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+(_Min_Stack_Size|_Min_Heap_Size)\s*=")
+
+CI_NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+CI_EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+CI_FRAME = re.compile(r"\\n(\d+) bytes \((\w+)")
+
+
+def is_ram(address):
+    return RAM_START <= address < RAM_END
+
+
+def parse_map(path):
+    """Return (output sections, input sections, reserved sizes) placed in SRAM."""
+    outputs = []
+    inputs = []
+    reserved = {}
+    pending_output = None
+    pending_input = None
+    current_output = None
+    in_memory_map = False
+
+    with open(path, errors="replace") as map_file:
+        for line in map_file:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            match = SYMBOL_ASSIGNMENT.match(line)
+            if match:
+                reserved[match.group(2)] = int(match.group(1), 16)
+                continue
+
+            # Output section header, possibly with address / size on the next line.
+            match = OUTPUT_SECTION.match(line)
+            if match:
+                current_output = match.group(1)
+                address, size = int(match.group(2), 16), int(match.group(3), 16)
+                if is_ram(address):
+                    outputs.append((current_output, address, size))
+                continue
+            match = OUTPUT_SECTION_NAME_ONLY.match(line)
+            if match:
+                pending_output = match.group(1)
+                continue
+            if pending_output is not None:
+                match = ADDRESS_SIZE.match(line)
+                pending_name, pending_output = pending_output, None
+                if match:
+                    current_output = pending_name
+                    address, size = int(match.group(1), 16), int(match.group(2), 16)
+                    if is_ram(address):
+                        outputs.append((current_output, address, size))
+                    continue
+
+            # Input section, long names wrap address / size / object onto the next line.
+            match = INPUT_SECTION.match(line)
+            if match:
+                address, size = int(match.group(2), 16), int(match.group(3), 16)
+                if is_ram(address) and size:
+                    inputs.append((match.group(1), size, match.group(4), current_output))
+                continue
+            match = INPUT_SECTION_NAME_ONLY.match(line)
+            if match:
+                pending_input = match.group(1)
+                continue
+            if pending_input is not None:
+                match = ADDRESS_SIZE_OBJECT.match(line)
+                pending_name, pending_input = pending_input, None
+                if match:
+                    address, size = int(match.group(1), 16), int(match.group(2), 16)
+                    if is_ram(address) and size:
+                        inputs.append((pending_name, size, match.group(3), current_output))
+
+    return outputs, inputs, reserved
+
+
+def find_files(root, suffix):
+    for directory, _, names in os.walk(root):
+        for name in names:
+            if name.endswith(suffix):
+                yield os.path.join(directory, name)
+
+
+def parse_stack_usage(root):
+    """Return {function: (bytes, qualifier)} from the .su files."""
+    frames = {}
+    for path in find_files(root, ".su"):
+        with open(path) as su_file:
+            for line in su_file:
+                fields = line.rstrip("\n").split("\t")
+                if len(fields) != 3:
+                    continue
+                function = fields[0].rsplit(":", 1)[-1]
+                frames[function] = (int(fields[1]), fields[2])
+    return frames
+
+
+def parse_call_graph(root):
+    """Return ({function: frame bytes}, {caller: set(callees)}) from the .ci files."""
+    frames = {}
+    calls = {}
+    for path in find_files(root, ".ci"):
+        with open(path) as ci_file:
+            text = ci_file.read()
+        for title, label in CI_NODE.findall(text):
+            match = CI_FRAME.search(label)
+            if match:
+                frames[title] = int(match.group(1))
+            else:
+                frames.setdefault(title, 0)
+        for source, target in CI_EDGE.findall(text):
+            calls.setdefault(source, set()).add(target)
+    return frames, calls
+
+
+def worst_chain(function, frames, calls, cache, active):
+    """Deepest stack chain below function (recursion is reported, not followed)."""
+    if function in cache:
+        return cache[function]
+    if function in active:
+        return 0, [function + " (recursion)"]
+    active.add(function)
+    best_depth, best_path = 0, []
+    for callee in calls.get(function, ()):
+        depth, path = worst_chain(callee, frames, calls, cache, active)
+        if depth > best_depth:
+            best_depth, best_path = depth, path
+    active.discard(function)
+    cache[function] = (frames.get(function, 0) + best_depth, [function] + best_path)
+    return cache[function]
+
+
+def report_ram(map_path, top):
+    outputs, inputs, reserved = parse_map(map_path)
+    total = 0
+    print("RAM sections (%s):" % map_path)
+    for name, address, size in outputs:
+        if size == 0:
+            continue
+        print("  %-20s 0x%08x %8d" % (name, address, size))
+        total += size
+    print("  %-20s %10s %8d of %d" % ("total", "", total, RAM_END - RAM_START))
+    for name in ("_Min_Stack_Size", "_Min_Heap_Size"):
+        if name in reserved:
+            print("  %-20s %10s %8d (reserved in ._user_heap_stack)" % (name, "", reserved[name]))
+
+    print("\nLargest RAM input sections:")
+    for name, size, obj, output in sorted(inputs, key=lambda item: -item[1])[:top]:
+        print("  %8d  %-12s %-48s %s" % (size, output or "", name, os.path.basename(obj)))
+
+
+def report_stack(objects_root, top):
+    frames = parse_stack_usage(objects_root)
+    if not frames:
+        print("\nno .su files below %s (build with -fstack-usage)" % objects_root)
+        return
+    print("\nLargest stack frames:")
+    for function, (size, qualifier) in sorted(frames.items(), key=lambda item: -item[1][0])[:top]:
+        print("  %8d  %-8s %s" % (size, qualifier, function))
+
+    graph_frames, calls = parse_call_graph(objects_root)
+    if not calls:
+        print("\nno .ci files below %s (build with -fcallgraph-info=su for call chains)" % objects_root)
+        return
+    called = set()
+    for callees in calls.values():
+        called.update(callees)
+    roots = [function for function in graph_frames if function not in called and function in calls]
+    cache = {}
+    chains = sorted((worst_chain(root, graph_frames, calls, cache, set()) for root in roots),
+                    key=lambda item: -item[0])
+    print("\nWorst-case call chains (direct calls only):")
+    for depth, path in chains[:top]:
+        # Static functions are titled "file.c:function" in the .ci files.
+        print("  %8d  %s" % (depth, " > ".join(step.rsplit(":", 1)[-1] for step in path)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="GNU ld map file (-Wl,-Map=...)")
+    parser.add_argument("--objects", help="build directory with the .su / .ci files")
+    parser.add_argument("--top", type=int, default=20, help="rows per table")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.map):
+        sys.exit("map file not found: %s" % args.map)
+    report_ram(args.map, args.top)
+    if args.objects:
+        report_stack(args.objects, args.top)
+
+
+if __name__ == "__main__":
+    main()
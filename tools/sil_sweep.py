@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Run parameter sweeps on the software-in-the-loop simulator.
+
+Each grid point is one sil_sim run (sim/build/sil_sim, build with
+`make -C sim`); the simulator prints one result line
+
+    SIL rms_tracking_error_mrpm=... max_tracking_error_mrpm=... ...
+
+which is collected with the swept values into one CSV row. Every --param
+adds one axis of the grid (comma-separated values, sil_sim option names
+without the dashes); --set passes fixed options. The best points by
+--rank are printed at the end.
+
+Usage:
+    sil_sweep.py --param kp=1800,2700,4000 --param ki=3000,6000,12000 -o gains.csv
+    sil_sweep.py --param tau-ms=10,20,30,50 --set feedback=lpf --set noise=4 -o tau.csv
+    sil_sweep.py --param accel=150000,300000,600000 --param jerk=0,3000000 --rank max_tracking_error_mrpm
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+DEFAULT_SIM = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "sim", "build", "sil_sim")
+
+
+def parse_axis(text):
+    """Return (name, [values]) of one name=v1,v2,... argument."""
+    name, sep, values = text.partition("=")
+    if not sep or not name or not values:
+        sys.exit("expected name=value[,value...]: %s" % text)
+    return name.lstrip("-"), values.split(",")
+
+
+def parse_result(output):
+    """Return the key=value fields of the SIL line, or None."""
+    for line in output.splitlines():
+        fields = line.split()
+        if fields and fields[0] == "SIL":
+            return dict(field.split("=", 1) for field in fields[1:])
+    return None
+
+
+def run_point(sim, point, fixed):
+    command = [sim]
+    for name, value in list(fixed) + list(point):
+        command += ["--" + name, value]
+    completed = subprocess.run(command, capture_output=True, text=True)
+    result = parse_result(completed.stdout)
+    if completed.returncode != 0 or result is None:
+        return point, {"error": (completed.stderr.strip() or "no SIL line").replace("\n", " ")}
+    return point, result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--param", action="append", default=[], help="swept option: name=v1,v2,...")
+    parser.add_argument("--set", action="append", default=[], help="fixed option: name=value")
+    parser.add_argument("--sim", default=DEFAULT_SIM, help="simulator binary (default: sim/build/sil_sim)")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="parallel runs")
+    parser.add_argument("--rank", default="rms_tracking_error_mrpm", help="metric to sort the summary by")
+    parser.add_argument("--top", type=int, default=5, help="points printed in the summary")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.sim):
+        sys.exit("%s not found; build it with `make -C sim`" % args.sim)
+
+    axes = [parse_axis(text) for text in args.param]
+    fixed = [(name, values[0]) for name, values in (parse_axis(text) for text in args.set)]
+    names = [name for name, _ in axes]
+    points = [list(zip(names, combination)) for combination in itertools.product(*(values for _, values in axes))]
+
+    with ThreadPoolExecutor(max_workers=max(args.jobs, 1)) as pool:
+        results = list(pool.map(lambda point: run_point(args.sim, point, fixed), points))
+
+    metric_names = []
+    for _, result in results:
+        for key in result:
+            if key not in metric_names:
+                metric_names.append(key)
+
+    output = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(output)
+    writer.writerow(names + metric_names)
+    for point, result in results:
+        writer.writerow([value for _, value in point] + [result.get(key, "") for key in metric_names])
+    if args.output:
+        output.close()
+
+    ranked = [(float(result[args.rank]), point) for point, result in results if args.rank in result]
+    failed = len(results) - len(ranked)
+    ranked.sort(key=lambda entry: entry[0])
+    print("%d points, %d failed; best by %s:" % (len(results), failed, args.rank), file=sys.stderr)
+    for value, point in ranked[:args.top]:
+        print("  %12.0f  %s" % (value, " ".join("%s=%s" % item for item in point)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+"""Decode binary runtime telemetry frames into S-line compatible CSV.
+
+Frame layout (little-endian):
+
+    sync 0xA5 | type u8 | seq u8 | timestamp_us u32 | payload | crc16 u16
+
+The CRC is CRC-16/CCITT-FALSE over type..payload (sync excluded).
+
+Control frame (type 0x01, 13-byte payload, older firmware):
+
+    angle_u16 u16 | filtered_mrpm i32 | reference_mrpm i32 | uq_permyriad i16 | step u8
+
+Profile frame (type 0x02, 17-byte payload, cycles at SYSCLK):
+
+    probe_id u8 | count u32 | min u32 | max u32 | mean u32
+
+Scope frame (type 0x03, 26-byte payload, one RAM-scope sample per frame):
+
+    index u16 | count u16 | trigger_offset u16 | channel_id u8[4] | value i32[4]
+
+Scheduler frame (type 0x04, 21-byte payload, one main-loop task per frame):
+
+    task_id u8 | runs u32 | max_exec_us u32 | overruns u32 | skips u32 | catch_ups u32
+
+Command acknowledgement (type 0x05, 5-byte payload, see tools/command_send.py):
+
+    command_type u8 | command_seq u8 | status u8 | stream_free u16
+
+Masked control frame (type 0x06, older firmware with a channel mask other than 0x1F):
+
+    mask u8 | control fields of the set mask bits, in bit order
+    (bit 0 angle, 1 filtered, 2 reference, 3 uq, 4 step)
+
+Timing frame (type 0x07, 45-byte payload, one timing-monitor channel per frame):
+
+    channel u8 | max_us u32 | late u32 | missed u32 | catch_ups u32 | dropped u32 | bins u32[6]
+
+Stream frame (type 0x08, one control-cycle snapshot, channels selected and due):
+
+    mask u16 | values of the set mask bits in channel id order (STREAM_CHANNELS widths)
+    (ids 0..4 as the control frame, 5 target, 6 error, 7 raw, 8 integrator,
+    9 feedforward, 10 id, 11 iq, 12 electrical angle)
+
+Load frame (type 0x09, 18-byte payload, main-loop CPU load since the previous report):
+
+    load_permyriad u16 | window_us u32 | idle_us u32 | passes u32 | sleeps u32
+
+Output rows follow the firmware text format:
+
+    S,timestamp_ms,mechanical_angle_deg_x10,velocity_filtered_mrpm,
+    velocity_target_final_mrpm,velocity_reference_mrpm,velocity_error_mrpm,
+    uq_command_permyriad
+    P,probe_id,count,min_cycles,max_cycles,mean_cycles
+    O,index,count,trigger_offset,value0,...   (unused channels, id 0xFF, dropped)
+    K,task_id,runs,max_exec_us,overruns,skips,catch_ups
+    A,command_type,command_seq,status,stream_free
+    J,channel,samples,max_us,late,missed,catch_ups,dropped,bin0..bin5
+    U,load_permyriad,window_us,idle_us,passes,sleeps
+    T,timestamp_ms,raw_mrpm,integrator_permyriad,feedforward_permyriad,
+    id_ma,iq_ma,electrical_angle_u16   (stream frames carrying ids 7..12)
+
+The segment target is rebuilt from the trajectory step and --peak-mrpm (step
+0xFF = streamed reference points: target = reference), the speed error as
+reference - filtered, unless a stream frame carries them (ids 5, 6). Masked
+control and stream frames leave the fields they do not carry (and the values
+derived from them) empty; a stream frame without ids 0..6 prints no S-row. Text lines (boot logs, faults) that are
+interleaved with the frames are skipped by resynchronizing on sync + CRC.
+
+Usage:
+    telemetry_decode.py capture.bin > run.csv
+    telemetry_decode.py --port /dev/ttyACM0 > run.csv   (requires pyserial)
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+HEADER_SIZE = 7
+CRC_SIZE = 2
+
+FRAME_TYPE_CONTROL = 0x01
+FRAME_TYPE_PROFILE = 0x02
+FRAME_TYPE_SCOPE = 0x03
+FRAME_TYPE_SCHEDULER = 0x04
+FRAME_TYPE_COMMAND_ACK = 0x05
+FRAME_TYPE_CONTROL_MASKED = 0x06
+FRAME_TYPE_TIMING = 0x07
+FRAME_TYPE_STREAM = 0x08
+FRAME_TYPE_LOAD = 0x09
+TIMING_BIN_COUNT = 6
+SCOPE_UNUSED_CHANNEL_ID = 0xFF
+PAYLOAD_SIZE = {
+    FRAME_TYPE_CONTROL: 13,
+    FRAME_TYPE_PROFILE: 17,
+    FRAME_TYPE_SCOPE: 26,
+    FRAME_TYPE_SCHEDULER: 21,
+    FRAME_TYPE_COMMAND_ACK: 5,
+    FRAME_TYPE_TIMING: 45,
+    FRAME_TYPE_LOAD: 18,
+}
+
+# Control fields in channel mask bit order: (name, struct format)
+CONTROL_CHANNELS = (
+    ("angle_u16", "H"),
+    ("filtered", "i"),
+    ("reference", "i"),
+    ("uq", "h"),
+    ("step", "B"),
+)
+CONTROL_CHANNEL_ALL = 0x1F
+# Telemetry-stream registry (app_telemetry_channel_id_t in Inc/app/app_context.h): (name, struct format)
+STREAM_CHANNELS = CONTROL_CHANNELS + (
+    ("target", "i"),
+    ("error", "i"),
+    ("raw", "i"),
+    ("integrator", "i"),
+    ("feedforward", "i"),
+    ("id", "i"),
+    ("iq", "i"),
+    ("electrical_angle_u16", "H"),
+)
+STREAM_CHANNEL_ALL = (1 << len(STREAM_CHANNELS)) - 1
+STREAM_S_ROW_CHANNELS = 0x7F
+STREAM_T_ROW_NAMES = ("raw", "integrator", "feedforward", "id", "iq", "electrical_angle_u16")
+TRAJECTORY_STEP_EXTERNAL = 0xFF
+
+# Trajectory step (2 * segment + holding) of the default app_speed_profile_segments table in app_command.c
+PHASE_TARGET_SIGN = (0, 0, 1, 1, 0, 0, -1, -1, 0, 0)
+
+
+def crc16_ccitt_false(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class FrameDecoder:
+    """Incremental frame parser with sync/CRC resynchronization."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.last_sequence = None
+        self.frames = 0
+        self.resyncs = 0
+        self.lost_frames = 0
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        while True:
+            start = self.buffer.find(bytes((FRAME_SYNC,)))
+            if start < 0:
+                self.buffer.clear()
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < 2:
+                return
+
+            frame_type = self.buffer[1]
+            if frame_type == FRAME_TYPE_CONTROL_MASKED:
+                if len(self.buffer) <= HEADER_SIZE:
+                    return
+                payload_size = masked_payload_size(self.buffer[HEADER_SIZE])
+            elif frame_type == FRAME_TYPE_STREAM:
+                if len(self.buffer) < HEADER_SIZE + 2:
+                    return
+                (mask,) = struct.unpack_from("<H", self.buffer, HEADER_SIZE)
+                payload_size = stream_payload_size(mask)
+            else:
+                payload_size = PAYLOAD_SIZE.get(frame_type)
+            if payload_size is None:
+                del self.buffer[0]
+                continue
+
+            frame_size = HEADER_SIZE + payload_size + CRC_SIZE
+            if len(self.buffer) < frame_size:
+                return
+
+            frame = bytes(self.buffer[:frame_size])
+            (crc,) = struct.unpack_from("<H", frame, frame_size - CRC_SIZE)
+            if crc16_ccitt_false(frame[1:frame_size - CRC_SIZE]) != crc:
+                # Sync byte inside text or payload data: shift by one byte.
+                self.resyncs += 1
+                del self.buffer[0]
+                continue
+
+            del self.buffer[:frame_size]
+            yield self._accept(frame)
+
+    def _accept(self, frame):
+        frame_type, sequence, timestamp_us = struct.unpack_from("<BBI", frame, 1)
+        if self.last_sequence is not None:
+            self.lost_frames += (sequence - self.last_sequence - 1) & 0xFF
+        self.last_sequence = sequence
+        self.frames += 1
+        return frame_type, timestamp_us, frame[HEADER_SIZE:-CRC_SIZE]
+
+
+def masked_payload_size(mask):
+    if (mask == 0) or (mask & ~CONTROL_CHANNEL_ALL):
+        return None
+    formats = "".join(fmt for bit, (_, fmt) in enumerate(CONTROL_CHANNELS) if mask & (1 << bit))
+    return 1 + struct.calcsize("<" + formats)
+
+
+def stream_payload_size(mask):
+    if (mask == 0) or (mask & ~STREAM_CHANNEL_ALL):
+        return None
+    formats = "".join(fmt for bit, (_, fmt) in enumerate(STREAM_CHANNELS) if mask & (1 << bit))
+    return 2 + struct.calcsize("<" + formats)
+
+
+def unpack_channels(channels, payload, mask):
+    fields = {}
+    offset = 0
+    for bit, (name, fmt) in enumerate(channels):
+        if mask & (1 << bit):
+            (fields[name],) = struct.unpack_from("<" + fmt, payload, offset)
+            offset += struct.calcsize("<" + fmt)
+    return fields
+
+
+def field(value):
+    return "" if value is None else "%d" % value
+
+
+def format_control_row(timestamp_us, payload, peak_mrpm, mask=CONTROL_CHANNEL_ALL):
+    return format_s_row(timestamp_us, unpack_channels(CONTROL_CHANNELS, payload, mask), peak_mrpm)
+
+
+def format_s_row(timestamp_us, fields, peak_mrpm):
+    angle_u16 = fields.get("angle_u16")
+    filtered = fields.get("filtered")
+    reference = fields.get("reference")
+    phase = fields.get("step")
+    angle_deg_x10 = None if angle_u16 is None else (angle_u16 * 3600 + 32768) // 65536
+    if "target" in fields:
+        target = fields["target"]
+    elif phase == TRAJECTORY_STEP_EXTERNAL:
+        target = reference
+    elif phase is not None:
+        target = (PHASE_TARGET_SIGN[phase] if phase < len(PHASE_TARGET_SIGN) else 0) * peak_mrpm
+    else:
+        target = None
+    if "error" in fields:
+        error = fields["error"]
+    else:
+        error = None if (reference is None or filtered is None) else reference - filtered
+    return "S,%d,%s,%s,%s,%s,%s,%s" % (
+        timestamp_us // 1000, field(angle_deg_x10), field(filtered), field(target),
+        field(reference), field(error), field(fields.get("uq")))
+
+
+def format_stream_rows(timestamp_us, payload, peak_mrpm):
+    (mask,) = struct.unpack_from("<H", payload)
+    fields = unpack_channels(STREAM_CHANNELS, payload[2:], mask)
+    rows = []
+    if mask & STREAM_S_ROW_CHANNELS:
+        rows.append(format_s_row(timestamp_us, fields, peak_mrpm))
+    if mask & ~STREAM_S_ROW_CHANNELS:
+        rows.append("T,%d," % (timestamp_us // 1000) +
+                    ",".join(field(fields.get(name)) for name in STREAM_T_ROW_NAMES))
+    return rows
+
+
+def format_profile_row(payload):
+    probe_id, count, min_cycles, max_cycles, mean_cycles = struct.unpack("<BIIII", payload)
+    return "P,%d,%d,%d,%d,%d" % (probe_id, count, min_cycles, max_cycles, mean_cycles)
+
+
+def format_scope_row(payload):
+    fields = struct.unpack("<HHH4B4i", payload)
+    index, count, trigger_offset = fields[0:3]
+    values = [value for channel_id, value in zip(fields[3:7], fields[7:11])
+              if channel_id != SCOPE_UNUSED_CHANNEL_ID]
+    return "O,%d,%d,%d," % (index, count, trigger_offset) + ",".join("%d" % v for v in values)
+
+
+def format_scheduler_row(payload):
+    return "K,%d,%d,%d,%d,%d,%d" % struct.unpack("<BIIIII", payload)
+
+
+def format_command_ack_row(payload):
+    return "A,%d,%d,%d,%d" % struct.unpack("<BBBH", payload)
+
+
+def format_timing_row(payload):
+    fields = struct.unpack("<B5I%dI" % TIMING_BIN_COUNT, payload)
+    bins = fields[6:]
+    # The sample count is not sent: it is the sum of the bins.
+    return "J,%d,%d,%d,%d,%d,%d,%d," % ((fields[0], sum(bins)) + fields[1:6]) + \
+        ",".join("%d" % b for b in bins)
+
+
+def format_load_row(payload):
+    return "U,%d,%d,%d,%d,%d" % struct.unpack("<HIIII", payload)
+
+
+def open_source(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--port requires pyserial")
+        return serial.Serial(args.port, args.baud, timeout=0.5)
+    if args.input == "-":
+        return sys.stdin.buffer
+    return open(args.input, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="capture file (default: stdin)")
+    parser.add_argument("--port", help="read from serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=230400)
+    parser.add_argument("--peak-mrpm", type=int, default=500000,
+                        help="APP_MOTOR_TEST_SPEED_PROFILE_PEAK_MECHANICAL_SPEED_MRPM")
+    args = parser.parse_args()
+
+    decoder = FrameDecoder()
+    source = open_source(args)
+    try:
+        while True:
+            chunk = source.read(4096)
+            if not chunk:
+                if args.port:
+                    continue
+                break
+            for frame_type, timestamp_us, payload in decoder.feed(chunk):
+                if frame_type == FRAME_TYPE_CONTROL:
+                    print(format_control_row(timestamp_us, payload, args.peak_mrpm))
+                elif frame_type == FRAME_TYPE_PROFILE:
+                    print(format_profile_row(payload))
+                elif frame_type == FRAME_TYPE_SCOPE:
+                    print(format_scope_row(payload))
+                elif frame_type == FRAME_TYPE_SCHEDULER:
+                    print(format_scheduler_row(payload))
+                elif frame_type == FRAME_TYPE_COMMAND_ACK:
+                    print(format_command_ack_row(payload))
+                elif frame_type == FRAME_TYPE_CONTROL_MASKED:
+                    print(format_control_row(timestamp_us, payload[1:], args.peak_mrpm, payload[0]))
+                elif frame_type == FRAME_TYPE_TIMING:
+                    print(format_timing_row(payload))
+                elif frame_type == FRAME_TYPE_LOAD:
+                    print(format_load_row(payload))
+                elif frame_type == FRAME_TYPE_STREAM:
+                    for row in format_stream_rows(timestamp_us, payload, args.peak_mrpm):
+                        print(row)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        source.close()
+
+    print("frames=%d lost=%d resyncs=%d" % (decoder.frames, decoder.lost_frames, decoder.resyncs),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()